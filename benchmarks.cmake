@@ -0,0 +1,32 @@
+
+dbot_add_benchmark(
+    NAME    rigid_body_renderer
+    SOURCES source/dbot/rigid_body_renderer_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    kinect_image_model
+    SOURCES source/dbot/model/kinect_image_model_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    rao_blackwell_coordinate_particle_filter
+    SOURCES source/dbot/filter/rao_blackwell_coordinate_particle_filter_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    gaussian_tracker
+    SOURCES source/dbot/tracker/gaussian_tracker_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+if(DBOT_BUILD_GPU)
+    dbot_add_benchmark(
+        NAME    kinect_image_model_gpu
+        SOURCES source/dbot/gpu/kinect_image_model_gpu_benchmark.cpp
+        LIBS    ${dbot_LIBRARIES})
+
+    dbot_add_benchmark(
+        NAME    cuda_likelihood_evaluator
+        SOURCES source/dbot/gpu/cuda_likelihood_evaluator_benchmark.cpp
+        LIBS    ${dbot_LIBRARIES})
+endif(DBOT_BUILD_GPU)
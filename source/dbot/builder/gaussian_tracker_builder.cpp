@@ -21,9 +21,16 @@
  *
  */
 
+#include <dbot/default_shader_provider.hpp>
+#include <dbot/geometry_registry.hpp>
 #include <dbot/simple_wavefront_object_loader.hpp>
+#include <dbot/builder/rb_sensor_builder.h>
 #include <dbot/builder/gaussian_tracker_builder.hpp>
 
+#ifdef DBOT_BUILD_GPU
+#include <dbot/gpu/rigid_body_renderer_gpu.hpp>
+#endif
+
 namespace dbot
 {
 GaussianTrackerBuilder::GaussianTrackerBuilder(
@@ -46,6 +53,29 @@ GaussianTrackerBuilder::build()
         param_.moving_average_update_rate,
         param_.center_object_frame);
 
+    // batches pay off if they are rendered in one pass or in parallel
+    tracker->batch_render_sigma_points(
+        param_.use_gpu || param_.thread_count != 1, param_.ut_alpha);
+
+    if (param_.use_active_pixels)
+    {
+        // the silhouette of a single pose is rendered on the CPU
+        auto silhouette_renderer = std::make_shared<RigidBodyRenderer>(
+            object_model->vertices(),
+            object_model->triangle_indices(),
+            camera_data_->camera_matrix(),
+            camera_data_->resolution().height,
+            camera_data_->resolution().width);
+
+        auto active_pixels =
+            std::make_shared<ActivePixelSet>(camera_data_->resolution().height,
+                                             camera_data_->resolution().width,
+                                             param_.active_pixel_margin,
+                                             param_.background_pixel_stride);
+
+        tracker->active_pixels(active_pixels, silhouette_renderer);
+    }
+
     return tracker;
 }
 
@@ -87,8 +117,12 @@ auto GaussianTrackerBuilder::create_sensor(
 
     auto renderer = create_renderer(object_model);
 
-    auto pixel_sensor = PixelModel(
-        renderer, param.bg_depth, param.fg_noise_std, param.bg_noise_std);
+    // the state is dynamic sized, its dimension sizes the sigma point store
+    auto pixel_sensor = PixelModel(renderer,
+                                   param.bg_depth,
+                                   param.fg_noise_std,
+                                   param.bg_noise_std,
+                                   object_model->count_parts() * 12);
 
     auto tail_sensor =
         TailModel(param.uniform_tail_min, param.uniform_tail_max);
@@ -103,12 +137,27 @@ std::shared_ptr<ObjectModel>
 GaussianTrackerBuilder::create_object_model(
     const ObjectResourceIdentifier& ori) const
 {
-    auto object_model = std::make_shared<ObjectModel>(
-        std::shared_ptr<ObjectModelLoader>(
-            new SimpleWavefrontObjectModelLoader(ori)),
-        param_.center_object_frame);
-
-    return object_model;
+    // trackers of copies of the same object share its model
+    return GeometryRegistry::instance().object_model(
+        ori,
+        param_.center_object_frame,
+        [&]()
+        {
+            auto loader =
+                std::make_shared<SimpleWavefrontObjectModelLoader>(ori);
+
+            // the parts are loaded and centered concurrently
+            std::shared_ptr<ThreadPool> thread_pool;
+            if (param_.thread_count != 1)
+            {
+                thread_pool =
+                    std::make_shared<ThreadPool>(param_.thread_count);
+                loader->thread_pool(thread_pool);
+            }
+
+            return std::make_shared<ObjectModel>(
+                loader, param_.center_object_frame, thread_pool);
+        });
 }
 
 auto GaussianTrackerBuilder::create_object_transition(
@@ -126,12 +175,38 @@ std::shared_ptr<RigidBodyRenderer>
 GaussianTrackerBuilder::create_renderer(
     const std::shared_ptr<ObjectModel>& object_model) const
 {
+    if (param_.use_gpu)
+    {
+#ifdef DBOT_BUILD_GPU
+        // one pass renders all sigma points of the unscented transform
+        const int state_dim = object_model->count_parts() * 12;
+        const int sigma_point_count = 2 * state_dim + 1;
+
+        return std::make_shared<RigidBodyRendererGPU>(
+            object_model->vertices(),
+            object_model->triangle_indices(),
+            std::make_shared<DefaultShaderProvider>(),
+            camera_data_->camera_matrix(),
+            camera_data_->resolution().height,
+            camera_data_->resolution().width,
+            sigma_point_count);
+#else
+        throw NoGpuSupportException();
+#endif
+    }
+
+    std::shared_ptr<ThreadPool> thread_pool;
+    if (param_.thread_count != 1)
+    {
+        thread_pool = std::make_shared<ThreadPool>(param_.thread_count);
+    }
+
     std::shared_ptr<RigidBodyRenderer> renderer(
-        new RigidBodyRenderer(object_model->vertices(),
-                              object_model->triangle_indices(),
+        new RigidBodyRenderer(object_model->flat_mesh(),
                               camera_data_->camera_matrix(),
                               camera_data_->resolution().height,
-                              camera_data_->resolution().width));
+                              camera_data_->resolution().width,
+                              thread_pool));
 
     return renderer;
 }
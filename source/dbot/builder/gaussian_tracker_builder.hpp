@@ -58,6 +58,19 @@ public:
         double ut_alpha;
         double moving_average_update_rate;
         bool center_object_frame;
+        /// renders all sigma points of an update in one ObjectRasterizer
+        /// pass instead of one after another on the CPU
+        bool use_gpu = false;
+        /// number of threads loading the object parts and rendering the
+        /// sigma points on the CPU, zero selects the number of hardware
+        /// threads
+        int thread_count = 1;
+        /// evaluates only the pixels within active_pixel_margin pixels of
+        /// the silhouette of the mean pose and one out of every
+        /// background_pixel_stride background pixels, see ActivePixelSet
+        bool use_active_pixels = false;
+        int active_pixel_margin = 10;
+        int background_pixel_stride = 50;
 
         struct Observation
         {
@@ -119,7 +132,11 @@ protected:
         const Parameters::Observation& param) const;
 
     /**
-     * \brief Creates an object model renderer
+     * \brief Creates an object model renderer, which renders on the GPU if
+     *        use_gpu is set
+     *
+     * \throws NoGpuSupportException if compile with DBOT_BUILD_GPU=OFF and
+     *         attempting to build a tracker with GPU support
      */
     std::shared_ptr<RigidBodyRenderer> create_renderer(
         const std::shared_ptr<ObjectModel>& object_model) const;
@@ -0,0 +1,106 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file multi_camera_sensor_builder.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <thread>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <dbot/builder/rb_sensor_builder.h>
+#include <dbot/model/multi_camera_sensor.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Builds a MultiCameraSensor with one sensor per camera, each of them
+ *        built from the same parameters as by RbSensorBuilder.
+ *
+ * The CPU sensors evaluate the cameras concurrently and share the
+ * thread_count among them. The GPU sensors are evaluated one camera after
+ * the other.
+ */
+template <typename State>
+class MultiCameraSensorBuilder : public RbSensorBuilder<State>
+{
+public:
+    typedef RbSensorBuilder<State> Base;
+    typedef typename Base::Model Model;
+    typedef typename Base::Parameters Parameters;
+
+    struct Camera
+    {
+        std::shared_ptr<CameraData> camera_data;
+
+        /// transform of points in the frame of the first camera into the
+        /// frame of this camera
+        Eigen::Affine3d extrinsic = Eigen::Affine3d::Identity();
+    };
+
+public:
+    /**
+     * \param cameras  the cameras, the states are expressed in the frame of
+     *                 the first one
+     */
+    MultiCameraSensorBuilder(const std::shared_ptr<ObjectModel>& object_model,
+                             const std::vector<Camera>& cameras,
+                             const Parameters& params)
+        : Base(object_model, cameras.at(0).camera_data, params),
+          cameras_(cameras)
+    {
+    }
+
+    std::shared_ptr<Model> build() const
+    {
+        const bool parallel = !this->params_.use_gpu && cameras_.size() > 1;
+
+        Parameters params = this->params_;
+        if (parallel)
+        {
+            const int thread_count =
+                params.thread_count > 0
+                    ? params.thread_count
+                    : int(std::max(1u, std::thread::hardware_concurrency()));
+            params.thread_count =
+                std::max(1, thread_count / int(cameras_.size()));
+        }
+
+        std::vector<typename MultiCameraSensor<State>::Camera> cameras;
+        for (const Camera& camera : cameras_)
+        {
+            typename MultiCameraSensor<State>::Camera sensor_camera;
+            sensor_camera.sensor =
+                Base(this->object_model_, camera.camera_data, params).build();
+            sensor_camera.extrinsic = camera.extrinsic;
+            sensor_camera.n_rows = camera.camera_data->resolution().height;
+            sensor_camera.n_cols = camera.camera_data->resolution().width;
+            cameras.push_back(sensor_camera);
+        }
+
+        return std::make_shared<MultiCameraSensor<State>>(
+            cameras, params.delta_time, parallel);
+    }
+
+private:
+    std::vector<Camera> cameras_;
+};
+}
@@ -36,25 +36,13 @@
 
 #include <Eigen/Dense>
 
+#include <dbot/traits.hpp>
+#include <dbot/model/batch_transition.hpp>
 #include <dbot/builder/transition_function_builder.hpp>
 #include <fl/model/transition/linear_transition.hpp>
 
 namespace dbot
 {
-template <typename State>
-struct ObjectStateTrait
-{
-    enum
-    {
-        NoiseDim = State::SizeAtCompileTime != -1 ? State::SizeAtCompileTime / 2
-                                                  : Eigen::Dynamic,
-        InputDim = Eigen::Dynamic
-    };
-
-    typedef Eigen::Matrix<typename State::Scalar, NoiseDim, 1> Noise;
-    typedef Eigen::Matrix<typename State::Scalar, InputDim, 1> Input;
-};
-
 template <typename State>
 class ObjectTransitionBuilder
     : public TransitionFunctionBuilder<
@@ -67,7 +55,8 @@ public:
                                         typename ObjectStateTrait<State>::Noise,
                                         typename ObjectStateTrait<State>::Input>
         Model;
-    typedef fl::LinearTransition<
+    // the particle filter propagates all particles at once
+    typedef LinearBatchTransition<
         State,
         typename ObjectStateTrait<State>::Noise,
         typename ObjectStateTrait<State>::Input> DerivedModel;
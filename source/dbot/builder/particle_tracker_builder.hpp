@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <exception>
 
 #include <dbot/object_model_loader.hpp>
@@ -42,6 +43,9 @@ namespace dbot
 
 /**
  * \brief Represents an Rbc Particle filter based tracker builder
+ *
+ * \tparam Tracker  ParticleTracker, or FixedParticleTracker for a fixed
+ *                  number of parts
  */
 template <typename Tracker>
 class ParticleTrackerBuilder
@@ -72,6 +76,34 @@ public:
         double moving_average_update_rate;
         double max_kl_divergence;
         bool center_object_frame;
+
+        /// number of threads sampling and propagating the particles, 0
+        /// selects the number of hardware threads
+        int thread_count = 1;
+
+        /// seed of the particle noise
+        std::uint64_t seed = 0;
+
+        ResamplingScheme resampling_scheme = ResamplingScheme::Multinomial;
+
+        /// adapts the number of particles per frame to the KLD bound within
+        /// [min_sample_count, max_sample_count]. The sensor has to be built
+        /// for at least max_sample_count particles.
+        bool adaptive_sample_count = false;
+        int min_sample_count = 10;
+        int max_sample_count = 1000;
+        double kld_error = 0.05;
+        double kld_quantile = 2.33;
+
+        /// KLD histogram bin sizes of the position (m) and the orientation
+        /// (rad) of each part. Velocities are not binned.
+        double kld_position_bin_size = 0.005;
+        double kld_orientation_bin_size = 0.02;
+
+        /// refines the mean pose of each step by aligning the rendered
+        /// object with the observed depths, see DepthAlignment. Disabled
+        /// with zero iterations.
+        DepthAlignment::Parameters depth_alignment;
     };
 
 public:
@@ -94,16 +126,22 @@ public:
     /**
      * \brief Builds the Rbc PF tracker
      */
-    std::shared_ptr<ParticleTracker> build()
+    std::shared_ptr<Tracker> build()
     {
         auto filter = create_filter(object_model_, params_.max_kl_divergence);
 
-        auto tracker = std::make_shared<ParticleTracker>(
+        auto tracker = std::make_shared<Tracker>(
             filter,
             object_model_,
             params_.evaluation_count,
             params_.moving_average_update_rate,
-            params_.center_object_frame);        
+            params_.center_object_frame);
+
+        if (params_.depth_alignment.iterations > 0)
+        {
+            tracker->depth_alignment(sensor_builder_->create_depth_alignment(
+                params_.depth_alignment));
+        }
 
         return tracker;
     }
@@ -129,10 +167,44 @@ public:
         auto filter = std::shared_ptr<Filter>(new Filter(transition,
                                                          sensor,
                                                          sampling_blocks,
-                                                         max_kl_divergence));
+                                                         max_kl_divergence,
+                                                         params_.thread_count,
+                                                         params_.seed));
+        filter->resampling_scheme(params_.resampling_scheme);
+
+        if (params_.adaptive_sample_count)
+        {
+            filter->kld_sampling(
+                create_kld_sampling(object_model->count_parts()));
+        }
+
         return filter;
     }
 
+    /**
+     * \brief Creates the adaptive particle count parameters of a state
+     *        consisting of \a parts rigid bodies
+     */
+    virtual typename Filter::KldSampling create_kld_sampling(int parts) const
+    {
+        typename Filter::KldSampling kld;
+        kld.min_sample_count = params_.min_sample_count;
+        kld.max_sample_count = params_.max_sample_count;
+        kld.error = params_.kld_error;
+        kld.quantile = params_.kld_quantile;
+
+        kld.bin_sizes.setZero(parts * State::BodySize);
+        for (int i = 0; i < parts; ++i)
+        {
+            kld.bin_sizes.segment(i * State::BodySize, 3)
+                .setConstant(params_.kld_position_bin_size);
+            kld.bin_sizes.segment(i * State::BodySize + 3, 3)
+                .setConstant(params_.kld_orientation_bin_size);
+        }
+
+        return kld;
+    }
+
     /**
      * \brief Creates a sampling block definition used by the coordinate
      *        particle filter
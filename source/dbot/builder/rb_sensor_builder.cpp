@@ -36,4 +36,7 @@
 namespace dbot
 {
 template class RbSensorBuilder<osr::FreeFloatingRigidBodiesState<>>;
+template class RbSensorBuilder<osr::FreeFloatingRigidBodiesState<1>>;
+template class RbSensorBuilder<osr::FreeFloatingRigidBodiesState<2>>;
+template class RbSensorBuilder<osr::FreeFloatingRigidBodiesState<3>>;
 }
@@ -37,15 +37,23 @@
 #include <ros/package.h>
 
 #include <dbot/camera_data.hpp>
+#include <dbot/depth_alignment.hpp>
+#include <dbot/mesh_levels.hpp>
+#include <dbot/geometry_registry.hpp>
+#include <dbot/gpu_memory_planner.hpp>
+#include <dbot/launch_tuning_cache.hpp>
 #include <dbot/object_model.hpp>
 #include <dbot/file_shader_provider.hpp>
 #include <dbot/default_shader_provider.hpp>
 #include <dbot/rigid_body_renderer.hpp>
 #include <dbot/model/rao_blackwell_sensor.hpp>
 #include <dbot/model/kinect_image_model.hpp>
+#include <dbot/model/occlusion_encoding.hpp>
 
 namespace dbot
 {
+class BatchEvaluationService;
+
 /**
  * \brief The NoGpuSupportException class
  */
@@ -78,10 +86,36 @@ public:
             double tail_weight;
             double model_sigma;
             double sigma_factor;
+
+            /// bound of the per-pixel log likelihood error of the tabulated
+            /// pixel model, 0 evaluates the model exactly
+            double max_approximation_error = 0;
         };
 
         /* -- Kinect image observation model parameters -- */
         bool use_gpu;
+        /// renders with the CudaRasterizer instead of OpenGL, which does
+        /// not require a display. Only effective if use_gpu is set.
+        bool use_cuda_rasterizer = false;
+        /// weighs with OpenGL compute shaders instead of CUDA, which runs on
+        /// GPUs of any vendor, see KinectImageModelGL. Only effective if
+        /// use_gpu is set.
+        bool use_gl_compute = false;
+        /// number of GPUs the states are distributed over by the CUDA
+        /// rasterizer backend, 0 selects all GPUs
+        int device_count = 1;
+        /// size of the region of interest each pose is rendered into by
+        /// OpenGL, 0 renders the full image
+        int tile_rows = 0;
+        int tile_cols = 0;
+        /// file the number of threads tuned for the GPU, driver and
+        /// resolution is kept in across runs, see LaunchTuningCache. Empty
+        /// does not tune. Only effective with the OpenGL renderer.
+        std::string launch_tuning_file;
+        /// evaluates the states together with those of the other trackers
+        /// sharing this service, see KinectImageModelBatched. Only effective
+        /// if use_gpu is set.
+        std::shared_ptr<BatchEvaluationService> batch_service;
         Occlusion occlusion;
         Kinect kinect;
         double delta_time;
@@ -90,6 +124,45 @@ public:
         std::string vertex_shader_file;
         std::string fragment_shader_file;
         std::string geometry_shader_file;
+        /// compute shader of use_gl_compute, "none" takes the default one
+        std::string compute_shader_file = "none";
+
+        /// evaluates all but the last sampling block of the coordinate
+        /// particle filter on images downsampled by this factor, see
+        /// PyramidSensor. 1 evaluates all blocks at full resolution. Not
+        /// effective with a batch_service.
+        int pyramid_factor = 1;
+
+        /// number of successively decimated meshes the renderers choose from
+        /// by the projected size of the object at its mean pose, see
+        /// MeshLevels. 1 always renders the full mesh. Only effective with
+        /// the CPU and the OpenGL renderers.
+        int lod_levels = 1;
+        /// largest projected error of a selected level of detail in pixels
+        double lod_tolerance = 1.0;
+
+        /// stops evaluating a particle once its log likelihood provably
+        /// stays more than this margin below the best particle, see
+        /// KinectImageModel::rejection_margin(). 0 evaluates all pixels.
+        /// Not effective with multiple GPUs or a batch_service.
+        double rejection_margin = 0;
+
+        /// storage format of the occlusion probabilities of the particles,
+        /// Half and Logit8 take a half and a quarter of the memory. Not
+        /// effective with a batch_service.
+        OcclusionPrecision occlusion_precision = OcclusionPrecision::Single;
+
+        /* -- CPU model parameters -- */
+        /// number of threads evaluating particles, 0 selects the number of
+        /// hardware threads
+        int thread_count = 1;
+        /// evaluates the pixel model in single precision, see
+        /// KinectImageModel. The GPU models always do.
+        bool single_precision = false;
+        /// warps the renderings of the previous frame to nearby poses
+        /// instead of rendering them, see KinectImageModel::depth_reuse().
+        /// Only effective with objects of a single part.
+        DepthReuse depth_reuse;
     };
 
     typedef RbSensor<State> Model;
@@ -101,6 +174,19 @@ public:
 
     virtual std::shared_ptr<Model> build() const;
 
+    /**
+     * \brief The image models of build() which allocate their poses on the
+     *        GPU, e.g. both levels of a pyramid. The sensor is built for the
+     *        smallest number of poses planned for its requests, see
+     *        GpuMemoryPlanner. Empty for the CPU model and for the backends
+     *        managing their memory otherwise, i.e. OpenGL compute shaders,
+     *        several GPUs and a batch_service.
+     *
+     * \param name  name of the tracker in the report of the plan
+     */
+    std::vector<GpuMemoryPlanner::Request> memory_requests(
+        const std::string& name) const;
+
 public:
     /* GPU model factor functions */
     virtual std::shared_ptr<Model> create_gpu_based_model() const;
@@ -118,9 +204,28 @@ public:
 
     virtual std::shared_ptr<RigidBodyRenderer> create_renderer() const;
 
+    /**
+     * \brief Creates the refinement of the tracked poses on the
+     *        observations of the full resolution
+     */
+    virtual std::shared_ptr<DepthAlignment> create_depth_alignment(
+        const DepthAlignment::Parameters& parameters) const;
+
+protected:
+    /** \brief Camera of the pyramid level built by this builder */
+    Eigen::Matrix3d camera_matrix() const;
+    int n_rows() const;
+    int n_cols() const;
+
+    /** \brief Levels of detail of the object model, see lod_levels */
+    std::shared_ptr<const MeshLevels> create_mesh_levels() const;
+
 protected:
     std::shared_ptr<ObjectModel> object_model_;
     std::shared_ptr<CameraData> camera_data_;
     Parameters params_;
+
+    // downsampling factor of the pyramid level built by this builder
+    int level_factor_;
 };
 }
@@ -31,9 +31,17 @@
 
 #include <dbot/builder/rb_sensor_builder.h>
 #include <dbot/model/kinect_image_model.hpp>
+#include <dbot/model/pyramid_sensor.hpp>
 
 #ifdef DBOT_BUILD_GPU
 #include <dbot/gpu/kinect_image_model_gpu.hpp>
+#include <dbot/gpu/kinect_image_model_cuda.hpp>
+#include <dbot/gpu/kinect_image_model_multi_gpu.hpp>
+#include <dbot/gpu/kinect_image_model_batched.hpp>
+#endif
+
+#ifdef DBOT_BUILD_GL
+#include <dbot/gpu/kinect_image_model_gl.hpp>
 #endif
 
 
@@ -44,7 +52,10 @@ RbSensorBuilder<State>::RbSensorBuilder(
     const std::shared_ptr<ObjectModel>& object_model,
     const std::shared_ptr<CameraData>& camera_data,
     const Parameters& params)
-    : object_model_(object_model), camera_data_(camera_data), params_(params)
+    : object_model_(object_model),
+      camera_data_(camera_data),
+      params_(params),
+      level_factor_(1)
 {
 }
 
@@ -62,19 +73,199 @@ auto RbSensorBuilder<State>::build() const -> std::shared_ptr<Model>
         sensor = create_cpu_based_model();
     }
 
+    if (params_.pyramid_factor > 1 && level_factor_ == 1 &&
+        !(params_.use_gpu && params_.batch_service))
+    {
+        auto coarse_builder = *this;
+        coarse_builder.level_factor_ = params_.pyramid_factor;
+        coarse_builder.params_.tile_rows /= params_.pyramid_factor;
+        coarse_builder.params_.tile_cols /= params_.pyramid_factor;
+
+        sensor = std::make_shared<PyramidSensor<State>>(sensor,
+                                                        coarse_builder.build(),
+                                                        params_.pyramid_factor,
+                                                        n_rows(),
+                                                        n_cols(),
+                                                        params_.delta_time);
+    }
+
     return sensor;
 }
 
+template <typename State>
+auto RbSensorBuilder<State>::memory_requests(const std::string& name) const
+    -> std::vector<GpuMemoryPlanner::Request>
+{
+    std::vector<GpuMemoryPlanner::Request> requests;
+    if (!params_.use_gpu || params_.use_gl_compute || params_.batch_service ||
+        (params_.use_cuda_rasterizer && params_.device_count != 1))
+    {
+        return requests;
+    }
+
+    GpuMemoryPlanner::Request request;
+    request.name = level_factor_ == 1
+                       ? name
+                       : name + " at 1/" + std::to_string(level_factor_);
+    request.renderer = params_.use_cuda_rasterizer
+                           ? GpuMemoryPlanner::Renderer::Cuda
+                           : GpuMemoryPlanner::Renderer::OpenGL;
+    request.n_rows = n_rows();
+    request.n_cols = n_cols();
+    if (!params_.use_cuda_rasterizer)
+    {
+        request.tile_rows = params_.tile_rows;
+        request.tile_cols = params_.tile_cols;
+    }
+    request.max_poses = params_.sample_count;
+    request.part_count = object_model_->count_parts();
+    for (int i = 0; i < object_model_->count_parts(); ++i)
+    {
+        request.vertex_count += object_model_->vertices()[i].size();
+        request.triangle_count += object_model_->triangle_indices()[i].size();
+    }
+    request.occlusion_bytes = occlusion_bytes(params_.occlusion_precision);
+    requests.push_back(request);
+
+    if (params_.pyramid_factor > 1 && level_factor_ == 1)
+    {
+        auto coarse_builder = *this;
+        coarse_builder.level_factor_ = params_.pyramid_factor;
+        coarse_builder.params_.tile_rows /= params_.pyramid_factor;
+        coarse_builder.params_.tile_cols /= params_.pyramid_factor;
+
+        auto coarse_requests = coarse_builder.memory_requests(name);
+        requests.insert(
+            requests.end(), coarse_requests.begin(), coarse_requests.end());
+    }
+
+    return requests;
+}
+
+template <typename State>
+Eigen::Matrix3d RbSensorBuilder<State>::camera_matrix() const
+{
+    return PyramidSensor<State>::downsample(camera_data_->camera_matrix(),
+                                            level_factor_);
+}
+
+template <typename State>
+int RbSensorBuilder<State>::n_rows() const
+{
+    return camera_data_->resolution().height / level_factor_;
+}
+
+template <typename State>
+int RbSensorBuilder<State>::n_cols() const
+{
+    return camera_data_->resolution().width / level_factor_;
+}
+
 template <typename State>
 auto RbSensorBuilder<State>::create_gpu_based_model() const
     -> std::shared_ptr<Model>
 {
+    if (params_.use_gl_compute)
+    {
+#ifdef DBOT_BUILD_GL
+        auto sensor = std::make_shared<dbot::KinectImageModelGL<State>>(
+            camera_matrix(),
+            n_rows(),
+            n_cols(),
+            params_.sample_count,
+            object_model_->vertices(),
+            object_model_->triangle_indices(),
+            create_shader_provider(),
+            params_.occlusion.initial_occlusion_prob,
+            params_.delta_time,
+            params_.occlusion.p_occluded_visible,
+            params_.occlusion.p_occluded_occluded,
+            params_.kinect.tail_weight,
+            params_.kinect.model_sigma,
+            params_.kinect.sigma_factor,
+            6.0f,
+            -log(0.5f));
+
+        if (params_.lod_levels > 1)
+        {
+            sensor->levels_of_detail(create_mesh_levels(),
+                                     params_.lod_tolerance);
+        }
+
+        return sensor;
+#else
+        throw NoGpuSupportException();
+#endif
+    }
+
 #ifdef DBOT_BUILD_GPU
-    auto sensor =
-        std::shared_ptr<Model>(new dbot::KinectImageModelGPU<State>(
-            camera_data_->camera_matrix(),
-            camera_data_->resolution().height,
-            camera_data_->resolution().width,
+    if (params_.batch_service)
+    {
+        return std::shared_ptr<Model>(new dbot::KinectImageModelBatched<State>(
+            params_.batch_service,
+            params_.sample_count,
+            object_model_->vertices(),
+            object_model_->triangle_indices(),
+            params_.delta_time));
+    }
+
+    if (params_.use_cuda_rasterizer && params_.device_count != 1)
+    {
+        std::vector<int> devices;
+        for (int i = 0; i < params_.device_count; ++i) devices.push_back(i);
+
+        return std::shared_ptr<Model>(
+            new dbot::KinectImageModelMultiGPU<State>(
+                camera_matrix(),
+                n_rows(),
+                n_cols(),
+                params_.sample_count,
+                object_model_->vertices(),
+                object_model_->triangle_indices(),
+                devices,
+                params_.occlusion.initial_occlusion_prob,
+                params_.delta_time,
+                params_.occlusion.p_occluded_visible,
+                params_.occlusion.p_occluded_occluded,
+                params_.kinect.tail_weight,
+                params_.kinect.model_sigma,
+                params_.kinect.sigma_factor,
+                6.0f,
+                -log(0.5f),
+                params_.kinect.max_approximation_error,
+                params_.occlusion_precision));
+    }
+
+    if (params_.use_cuda_rasterizer)
+    {
+        auto sensor = std::make_shared<dbot::KinectImageModelCuda<State>>(
+            camera_matrix(),
+            n_rows(),
+            n_cols(),
+            params_.sample_count,
+            object_model_->vertices(),
+            object_model_->triangle_indices(),
+            params_.occlusion.initial_occlusion_prob,
+            params_.delta_time,
+            params_.occlusion.p_occluded_visible,
+            params_.occlusion.p_occluded_occluded,
+            params_.kinect.tail_weight,
+            params_.kinect.model_sigma,
+            params_.kinect.sigma_factor,
+            6.0f,
+            -log(0.5f),
+            params_.kinect.max_approximation_error,
+            params_.occlusion_precision);
+        sensor->rejection_margin(params_.rejection_margin);
+
+        return sensor;
+    }
+
+    auto sensor = std::shared_ptr<dbot::KinectImageModelGPU<State>>(
+        new dbot::KinectImageModelGPU<State>(
+            camera_matrix(),
+            n_rows(),
+            n_cols(),
             params_.sample_count,
             object_model_->vertices(),
             object_model_->triangle_indices(),
@@ -87,7 +278,24 @@ auto RbSensorBuilder<State>::create_gpu_based_model() const
             params_.occlusion.p_occluded_occluded,
             params_.kinect.tail_weight,
             params_.kinect.model_sigma,
-            params_.kinect.sigma_factor));
+            params_.kinect.sigma_factor,
+            6.0f,
+            -log(0.5f),
+            params_.kinect.max_approximation_error,
+            params_.tile_rows,
+            params_.tile_cols,
+            params_.occlusion_precision));
+
+    if (!params_.launch_tuning_file.empty())
+    {
+        sensor->launch_tuning(
+            std::make_shared<LaunchTuningCache>(params_.launch_tuning_file));
+    }
+    if (params_.lod_levels > 1)
+    {
+        sensor->levels_of_detail(create_mesh_levels(), params_.lod_tolerance);
+    }
+    sensor->rejection_margin(params_.rejection_margin);
 
     return sensor;
 #else
@@ -104,7 +312,8 @@ auto RbSensorBuilder<State>::create_shader_provider() const
         return std::shared_ptr<ShaderProvider>(
             new FileShaderProvider(params_.fragment_shader_file,
                                    params_.vertex_shader_file,
-                                   params_.geometry_shader_file));
+                                   params_.geometry_shader_file,
+                                   params_.compute_shader_file));
     }
 
     return std::shared_ptr<ShaderProvider>(new DefaultShaderProvider());
@@ -118,16 +327,46 @@ auto RbSensorBuilder<State>::create_cpu_based_model() const
     auto occlusion_process = create_occlusion_process();
     auto renderer = create_renderer();
 
-    auto sensor = std::shared_ptr<Model>(
-        new dbot::KinectImageModel<fl::Real, State>(
-            camera_data_->camera_matrix(),
-            camera_data_->resolution().height,
-            camera_data_->resolution().width,
+    // the states of a fixed number of parts are of fixed size
+    enum
+    {
+        BodyCount = ObjectStateTrait<State>::BodyCount
+    };
+
+    if (params_.single_precision)
+    {
+        auto sensor = std::make_shared<
+            dbot::KinectImageModel<float, State, BodyCount>>(
+            camera_matrix(),
+            n_rows(),
+            n_cols(),
             renderer,
             pixel_model,
             occlusion_process,
             params_.occlusion.initial_occlusion_prob,
-            params_.delta_time));
+            params_.delta_time,
+            params_.thread_count);
+        sensor->rejection_margin(params_.rejection_margin);
+        sensor->occlusion_precision(params_.occlusion_precision);
+        sensor->depth_reuse(params_.depth_reuse);
+
+        return sensor;
+    }
+
+    auto sensor = std::make_shared<
+        dbot::KinectImageModel<fl::Real, State, BodyCount>>(
+        camera_matrix(),
+        n_rows(),
+        n_cols(),
+        renderer,
+        pixel_model,
+        occlusion_process,
+        params_.occlusion.initial_occlusion_prob,
+        params_.delta_time,
+        params_.thread_count);
+    sensor->rejection_margin(params_.rejection_margin);
+    sensor->occlusion_precision(params_.occlusion_precision);
+    sensor->depth_reuse(params_.depth_reuse);
 
     return sensor;
 }
@@ -140,6 +379,8 @@ auto RbSensorBuilder<State>::create_pixel_model() const
         new KinectPixelModel(params_.kinect.tail_weight,
                                         params_.kinect.model_sigma,
                                         params_.kinect.sigma_factor));
+    kinect_pixel_sensor->approximate(params_.kinect.max_approximation_error);
+
     return kinect_pixel_sensor;
 }
 
@@ -158,9 +399,32 @@ template <typename State>
 auto RbSensorBuilder<State>::create_renderer() const
     -> std::shared_ptr<RigidBodyRenderer>
 {
-    std::shared_ptr<RigidBodyRenderer> renderer(new RigidBodyRenderer(
-        object_model_->vertices(), object_model_->triangle_indices()));
+    std::shared_ptr<RigidBodyRenderer> renderer(
+        new RigidBodyRenderer(object_model_->flat_mesh()));
+
+    if (params_.lod_levels > 1)
+    {
+        renderer->levels_of_detail(create_mesh_levels(), params_.lod_tolerance);
+    }
 
     return renderer;
 }
+
+template <typename State>
+auto RbSensorBuilder<State>::create_depth_alignment(
+    const DepthAlignment::Parameters& parameters) const
+    -> std::shared_ptr<DepthAlignment>
+{
+    return std::make_shared<DepthAlignment>(
+        create_renderer(), camera_matrix(), n_rows(), n_cols(), parameters);
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_mesh_levels() const
+    -> std::shared_ptr<const MeshLevels>
+{
+    // the levels are shared by all sensors of the same model
+    return GeometryRegistry::instance().mesh_levels(*object_model_,
+                                                    params_.lod_levels);
+}
 }
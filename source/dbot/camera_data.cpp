@@ -41,6 +41,11 @@ Eigen::VectorXd CameraData::depth_image_vector() const
    return data_provider_->depth_image_vector();
 }
 
+DepthImageView CameraData::depth_image_view() const
+{
+    return data_provider_->depth_image_view();
+}
+
 std::string CameraData::frame_id() const
 {
     return data_provider_->frame_id();
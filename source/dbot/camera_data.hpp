@@ -23,6 +23,8 @@
 #include <string>
 #include <Eigen/Dense>
 
+#include <dbot/depth_image_view.hpp>
+
 namespace dbot
 {
 
@@ -65,6 +67,12 @@ public:
      */
     Eigen::VectorXd depth_image_vector() const;
 
+    /**
+     * \brief returns an obtained depth image as a float view in row major
+     *        order, see CameraDataProvider::depth_image_view()
+     */
+    DepthImageView depth_image_view() const;
+
     /**
      * \brief Returns the frame_id name of the camera
      */
@@ -23,6 +23,7 @@
 #include <Eigen/Dense>
 
 #include <dbot/camera_data.hpp>
+#include <dbot/depth_image_view.hpp>
 
 namespace dbot
 {
@@ -48,6 +49,22 @@ public:
      */
     virtual Eigen::VectorXd depth_image_vector() const = 0;
 
+    /**
+     * \brief returns an obtained depth image as a float view in row major
+     *        order. Providers which receive float frames should return a view
+     *        of the frame itself. By default, the depth image vector is
+     *        converted.
+     */
+    virtual DepthImageView depth_image_view() const
+    {
+        const int factor = downsampling_factor();
+        const CameraData::Resolution resolution = native_resolution();
+
+        return DepthImageView::copy(depth_image_vector(),
+                                    resolution.height / factor,
+                                    resolution.width / factor);
+    }
+
     /**
      * \brief Obtains the camera matrix
      */
@@ -38,18 +38,208 @@ DefaultShaderProvider::DefaultShaderProvider()
           /* vertex shader */
           "#version 330                                                     \n"
           "                                                                 \n"
-          " // tell OpenGL which buffer corresponds to which input          \n"
+          "// tell OpenGL which buffer corresponds to which input           \n"
           "layout(location = 0) in vec3 vertexPosition_modelspace;          \n"
           "out float depth;                                                 \n"
-          "uniform mat4 MV;                                                 \n"
+          "uniform mat4 V;                                                  \n"
           "uniform mat4 P;                                                  \n"
           "                                                                 \n"
+          "// default poses of all objects followed by the pose deltas of   \n"
+          "// all instances, each stored as the three rows of a 3 x 4 matrix\n"
+          "uniform samplerBuffer poses;                                     \n"
+          "uniform int object_index;                                        \n"
+          "uniform int nr_objects;                                          \n"
+          "                                                                 \n"
+          "// arrangement of the instances in the framebuffer               \n"
+          "uniform int nr_poses_per_row;                                    \n"
+          "uniform int nr_poses_per_column;                                 \n"
+          "uniform vec2 tile_scale;                                         \n"
+          "                                                                 \n"
+          "mat4 get_pose(int index) {                                       \n"
+          "    return transpose(mat4(texelFetch(poses, 3 * index),          \n"
+          "                          texelFetch(poses, 3 * index + 1),      \n"
+          "                          texelFetch(poses, 3 * index + 2),      \n"
+          "                          vec4(0, 0, 0, 1)));                    \n"
+          "}                                                                \n"
+          "                                                                 \n"
           "void main() {                                                    \n"
+          "    int delta = nr_objects * (gl_InstanceID + 1) + object_index; \n"
+          "    mat4 model = get_pose(object_index) * get_pose(delta);       \n"
+          "                                                                 \n"
           "    // makes it homogenous                                       \n"
           "    vec4 v = vec4(vertexPosition_modelspace, 1);                 \n"
-          "    vec4 tmp_position  = MV * v;                                 \n"
+          "    vec4 tmp_position  = V * model * v;                          \n"
           "    depth = tmp_position.z;                                      \n"
-          "    gl_Position = P * tmp_position;                              \n"
+          "    vec4 position = P * tmp_position;                            \n"
+          "                                                                 \n"
+          "    // clip to the tile of this instance                         \n"
+          "    gl_ClipDistance[0] = position.w + position.x;                \n"
+          "    gl_ClipDistance[1] = position.w - position.x;                \n"
+          "    gl_ClipDistance[2] = position.w + position.y;                \n"
+          "    gl_ClipDistance[3] = position.w - position.y;                \n"
+          "                                                                 \n"
+          "    // map the viewport onto the tile of this instance           \n"
+          "    int col = gl_InstanceID % nr_poses_per_row;                  \n"
+          "    int row = gl_InstanceID / nr_poses_per_row;                  \n"
+          "    vec2 tile = vec2(col, nr_poses_per_column - 1 - row);        \n"
+          "    vec2 offset = 2.0 * tile * tile_scale - 1.0;                 \n"
+          "                                                                 \n"
+          "    gl_Position = vec4((position.xy + position.w) * tile_scale   \n"
+          "                       + position.w * offset,                    \n"
+          "                       position.zw);                             \n"
+          "}                                                                \n",
+          /* geometry shader */
+          "",
+          /* compute shader, see GLLikelihoodEvaluator */
+          "#version 430                                                     \n"
+          "                                                                 \n"
+          "// each work group weighs one pose                               \n"
+          "layout(local_size_x = 128) in;                                   \n"
+          "                                                                 \n"
+          "// rendered depths of all poses, see ObjectRasterizer            \n"
+          "uniform sampler2D depths;                                        \n"
+          "                                                                 \n"
+          "layout(std430, binding = 0) readonly buffer Observations {       \n"
+          "    float observations[];                                        \n"
+          "};                                                               \n"
+          "layout(std430, binding = 1) readonly buffer OcclusionIndices {   \n"
+          "    int occlusion_indices[];                                     \n"
+          "};                                                               \n"
+          "layout(std430, binding = 2) readonly buffer Occlusions {         \n"
+          "    float occlusions[];                                          \n"
+          "};                                                               \n"
+          "layout(std430, binding = 3) writeonly buffer NewOcclusions {     \n"
+          "    float new_occlusions[];                                      \n"
+          "};                                                               \n"
+          "layout(std430, binding = 4) writeonly buffer LogLikelihoods {    \n"
+          "    float log_likelihoods[];                                     \n"
+          "};                                                               \n"
+          "                                                                 \n"
+          "uniform int nr_rows;                                             \n"
+          "uniform int nr_cols;                                             \n"
+          "uniform int nr_poses;                                            \n"
+          "uniform int nr_poses_per_row;                                    \n"
+          "uniform int nr_poses_per_column;                                 \n"
+          "uniform bool update_occlusions;                                  \n"
+          "                                                                 \n"
+          "// occlusion transition since the last update,                   \n"
+          "// p -> scale * p + offset                                       \n"
+          "uniform float occlusion_scale;                                   \n"
+          "uniform float occlusion_offset;                                  \n"
+          "                                                                 \n"
+          "// constants of the pixel model                                  \n"
+          "uniform float model_sigma;                                       \n"
+          "uniform float sigma_factor;                                      \n"
+          "uniform float tail_weight_div_max_depth;                         \n"
+          "uniform float one_minus_tail_weight;                             \n"
+          "uniform float exponential_rate;                                  \n"
+          "                                                                 \n"
+          "const float one_div_sqrt_of_two = 0.70710678;                    \n"
+          "const float one_div_sqrt_of_two_pi = 0.39894228;                 \n"
+          "                                                                 \n"
+          "shared float partial_sums[128];                                  \n"
+          "                                                                 \n"
+          "// GLSL has no erf, Abramowitz and Stegun 7.1.26 is exact to     \n"
+          "// 1.5e-7                                                        \n"
+          "float erf_approximation(float x) {                               \n"
+          "    float t = 1.0 / (1.0 + 0.3275911 * abs(x));                  \n"
+          "    float p = t * (0.254829592 + t * (-0.284496736               \n"
+          "              + t * (1.421413741 + t * (-1.453152027             \n"
+          "              + t * 1.061405429))));                             \n"
+          "    return sign(x) * (1.0 - p * exp(-x * x));                    \n"
+          "}                                                                \n"
+          "                                                                 \n"
+          "// density of the observation if the object is visible           \n"
+          "float visible_density(float observation, float prediction,       \n"
+          "                      float sigma) {                             \n"
+          "    float error = prediction - observation;                      \n"
+          "    return tail_weight_div_max_depth                             \n"
+          "           + one_minus_tail_weight * one_div_sqrt_of_two_pi      \n"
+          "             / sigma                                             \n"
+          "             * exp(-error * error / (2.0 * sigma * sigma));      \n"
+          "}                                                                \n"
+          "                                                                 \n"
+          "// density of the observation if the object is occluded          \n"
+          "float occluded_density(float observation, float prediction,      \n"
+          "                       float sigma) {                            \n"
+          "    float rate_sigma_sq = exponential_rate * sigma * sigma;      \n"
+          "    float error = prediction - observation;                      \n"
+          "    return tail_weight_div_max_depth                             \n"
+          "           + one_minus_tail_weight * exponential_rate            \n"
+          "             * exp(0.5 * exponential_rate                        \n"
+          "                   * (2.0 * error + rate_sigma_sq))              \n"
+          "             * (1.0 + erf_approximation((error + rate_sigma_sq)  \n"
+          "                                        * one_div_sqrt_of_two    \n"
+          "                                        / sigma))                \n"
+          "             / (2.0 * (exp(prediction * exponential_rate)        \n"
+          "                       - 1.0));                                  \n"
+          "}                                                                \n"
+          "                                                                 \n"
+          "// density of the observation if the object is not in the line   \n"
+          "// of sight                                                      \n"
+          "float background_density(float observation, float sigma) {       \n"
+          "    return tail_weight_div_max_depth                             \n"
+          "           + one_minus_tail_weight * exponential_rate            \n"
+          "             * exp(0.5 * exponential_rate                        \n"
+          "                   * (-2.0 * observation                         \n"
+          "                      + exponential_rate * sigma * sigma));      \n"
+          "}                                                                \n"
+          "                                                                 \n"
+          "void main() {                                                    \n"
+          "    int pose = int(gl_WorkGroupID.x                              \n"
+          "                   + gl_WorkGroupID.y * gl_NumWorkGroups.x);     \n"
+          "    if (pose >= nr_poses) return;                                \n"
+          "                                                                 \n"
+          "    int thread = int(gl_LocalInvocationID.x);                    \n"
+          "    int nr_pixels = nr_rows * nr_cols;                           \n"
+          "                                                                 \n"
+          "    // the origin of the texture is in the lower left corner     \n"
+          "    int pose_x = (pose % nr_poses_per_row) * nr_cols;            \n"
+          "    int pose_y = nr_poses_per_column * nr_rows - 1               \n"
+          "                 - (pose / nr_poses_per_row) * nr_rows;          \n"
+          "                                                                 \n"
+          "    int ancestor = occlusion_indices[pose] * nr_pixels;          \n"
+          "    int slot = pose * nr_pixels;                                 \n"
+          "                                                                 \n"
+          "    float sum = 0.0;                                             \n"
+          "    for (int pixel = thread; pixel < nr_pixels; pixel += 128) {  \n"
+          "        ivec2 texel = ivec2(pose_x + pixel % nr_cols,            \n"
+          "                            pose_y - pixel / nr_cols);           \n"
+          "        float depth = texelFetch(depths, texel, 0).r;            \n"
+          "        float obsrv = observations[pixel];                       \n"
+          "        float p = occlusions[ancestor + pixel];                  \n"
+          "        p = occlusion_scale * p + occlusion_offset;              \n"
+          "                                                                 \n"
+          "        // the occlusions of the other pixels are only propagated\n"
+          "        if (depth != 0.0 && !isnan(obsrv)) {                     \n"
+          "            float sigma = model_sigma                            \n"
+          "                          + sigma_factor * obsrv * obsrv;        \n"
+          "            float visible = visible_density(obsrv, depth, sigma) \n"
+          "                            * (1.0 - p);                         \n"
+          "            float occluded = occluded_density(obsrv, depth, sigma)\n"
+          "                             * p;                                \n"
+          "                                                                 \n"
+          "            sum += log((visible + occluded)                      \n"
+          "                       / background_density(obsrv, sigma));      \n"
+          "            p = 1.0 - visible / (visible + occluded);            \n"
+          "        }                                                        \n"
+          "                                                                 \n"
+          "        if (update_occlusions) new_occlusions[slot + pixel] = p; \n"
+          "    }                                                            \n"
+          "                                                                 \n"
+          "    partial_sums[thread] = sum;                                  \n"
+          "    memoryBarrierShared();                                       \n"
+          "    barrier();                                                   \n"
+          "                                                                 \n"
+          "    for (int stride = 64; stride > 0; stride /= 2) {             \n"
+          "        if (thread < stride) {                                   \n"
+          "            partial_sums[thread] += partial_sums[thread + stride];\n"
+          "        }                                                        \n"
+          "        memoryBarrierShared();                                   \n"
+          "        barrier();                                               \n"
+          "    }                                                            \n"
+          "                                                                 \n"
+          "    if (thread == 0) log_likelihoods[pose] = partial_sums[0];    \n"
           "}                                                                \n")
 {
 }
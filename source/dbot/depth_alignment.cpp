@@ -0,0 +1,181 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_alignment.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cmath>
+#include <cassert>
+
+#include <dbot/depth_alignment.hpp>
+
+namespace dbot
+{
+DepthAlignment::DepthAlignment(
+    const std::shared_ptr<RigidBodyRenderer>& renderer,
+    const Eigen::Matrix3d& camera_matrix,
+    int n_rows,
+    int n_cols,
+    const Parameters& parameters)
+    : renderer_(renderer),
+      camera_matrix_(camera_matrix),
+      camera_matrix_inverse_(camera_matrix.inverse()),
+      n_rows_(n_rows),
+      n_cols_(n_cols),
+      parameters_(parameters)
+{
+}
+
+int DepthAlignment::align(const DepthImageView& image,
+                          std::vector<Eigen::Matrix3d>& rotations,
+                          std::vector<Eigen::Vector3d>& translations)
+{
+    assert(image.rows() == n_rows_ && image.cols() == n_cols_);
+
+    int aligned = 0;
+    for (int part = 0; part < int(rotations.size()); part++)
+    {
+        int count = 0;
+        for (int i = 0; i < parameters_.iterations; i++)
+        {
+            renderer_->Render(part,
+                              rotations,
+                              translations,
+                              camera_matrix_,
+                              n_rows_,
+                              n_cols_,
+                              intersect_indices_,
+                              depth_,
+                              render_buffer_);
+
+            Eigen::Matrix<double, 6, 6> hessian;
+            Eigen::Matrix<double, 6, 1> gradient;
+            count = accumulate(image, hessian, gradient);
+            if (count < parameters_.min_pixels) break;
+
+            // the damping keeps the motions the observation does not
+            // constrain at zero, e.g. sliding along a plane
+            hessian.diagonal().array() += 1e-6 * count;
+
+            // rotation about the camera origin followed by a translation,
+            // both in the camera frame
+            const Eigen::Matrix<double, 6, 1> step =
+                hessian.ldlt().solve(-gradient);
+            if (!step.allFinite()) break;
+
+            const Eigen::Vector3d omega = step.head<3>();
+            const double angle = omega.norm();
+            const Eigen::Matrix3d delta_rotation =
+                angle > 0 ? Eigen::AngleAxisd(angle, omega / angle)
+                                .toRotationMatrix()
+                          : Eigen::Matrix3d::Identity();
+
+            rotations[part] = delta_rotation * rotations[part];
+            translations[part] =
+                delta_rotation * translations[part] + step.tail<3>();
+
+            if (step.lpNorm<Eigen::Infinity>() < parameters_.min_step) break;
+        }
+        aligned += count;
+    }
+
+    return aligned;
+}
+
+int DepthAlignment::accumulate(const DepthImageView& image,
+                               Eigen::Matrix<double, 6, 6>& hessian,
+                               Eigen::Matrix<double, 6, 1>& gradient) const
+{
+    hessian.setZero();
+    gradient.setZero();
+
+    const double max_difference = parameters_.max_depth_difference;
+
+    int count = 0;
+    for (size_t i = 0; i < intersect_indices_.size(); i++)
+    {
+        const int pixel = intersect_indices_[i];
+        const int row = pixel / n_cols_;
+        const int col = pixel % n_cols_;
+        if (row == 0 || col == 0 || row + 1 == n_rows_ || col + 1 == n_cols_)
+        {
+            continue;
+        }
+
+        const double observed_depth = image(pixel);
+        if (!(std::fabs(observed_depth - depth_[i]) <= max_difference))
+        {
+            continue;
+        }
+
+        // the normal of the observed surface from the central differences,
+        // skipped across depth discontinuities
+        Eigen::Vector3d left, right, up, down;
+        if (!observed_point(image, row, col - 1, left) ||
+            !observed_point(image, row, col + 1, right) ||
+            !observed_point(image, row - 1, col, up) ||
+            !observed_point(image, row + 1, col, down))
+        {
+            continue;
+        }
+        if (std::fabs(left(2) - right(2)) > max_difference ||
+            std::fabs(up(2) - down(2)) > max_difference)
+        {
+            continue;
+        }
+
+        Eigen::Vector3d normal = (right - left).cross(down - up);
+        const double length = normal.norm();
+        if (!(length > 0)) continue;
+        normal /= length;
+
+        const Eigen::Vector3d observed =
+            back_project(row, col, observed_depth);
+        const Eigen::Vector3d rendered = back_project(row, col, depth_[i]);
+
+        Eigen::Matrix<double, 6, 1> jacobian;
+        jacobian.head<3>() = rendered.cross(normal);
+        jacobian.tail<3>() = normal;
+        const double residual = (rendered - observed).dot(normal);
+
+        hessian.selfadjointView<Eigen::Lower>().rankUpdate(jacobian);
+        gradient += residual * jacobian;
+        count++;
+    }
+    hessian.triangularView<Eigen::StrictlyUpper>() = hessian.transpose();
+
+    return count;
+}
+
+bool DepthAlignment::observed_point(const DepthImageView& image,
+                                    int row,
+                                    int col,
+                                    Eigen::Vector3d& point) const
+{
+    const double depth = image(row * n_cols_ + col);
+    if (!std::isfinite(depth)) return false;
+
+    point = back_project(row, col, depth);
+    return true;
+}
+
+Eigen::Vector3d DepthAlignment::back_project(int row,
+                                             int col,
+                                             double depth) const
+{
+    return depth * (camera_matrix_inverse_ * Eigen::Vector3d(col, row, 1));
+}
+}
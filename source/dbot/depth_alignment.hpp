@@ -0,0 +1,128 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_alignment.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/depth_image_view.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Refines the poses of the parts of an object by aligning their
+ *        rendered depths with the observed ones.
+ *
+ * Each iteration renders a part at its current pose and pairs every covered
+ * pixel with the observed point of the same pixel (projective association).
+ * A Gauss-Newton step then minimizes the point-to-plane distances of the
+ * rendered points to the observed surface, whose normals are estimated from
+ * the neighbouring observed pixels. Pixels whose observed depth differs too
+ * much from the rendered one, e.g. occluders or the background, are ignored.
+ *
+ * The parts are aligned independently of each other on their own
+ * silhouettes.
+ */
+class DepthAlignment
+{
+public:
+    struct Parameters
+    {
+        /// Gauss-Newton iterations per part and call, each rendering the
+        /// part once. 0 disables the refinement.
+        int iterations = 0;
+
+        /// pixels whose observed depth differs more than this from the
+        /// rendered one in meters are not aligned
+        double max_depth_difference = 0.02;
+
+        /// a part covering fewer aligned pixels keeps its pose
+        int min_pixels = 100;
+
+        /// the iterations of a part stop once the step moves it by less
+        /// than this in meters (or radians)
+        double min_step = 1e-5;
+    };
+
+public:
+    /**
+     * \param renderer  renderer of the object model the poses refer to
+     */
+    DepthAlignment(const std::shared_ptr<RigidBodyRenderer>& renderer,
+                   const Eigen::Matrix3d& camera_matrix,
+                   int n_rows,
+                   int n_cols,
+                   const Parameters& parameters);
+
+    /**
+     * \brief Aligns the parts at the poses in \a rotations and
+     *        \a translations in the camera frame with the observation
+     *        \a image of n_rows x n_cols pixels
+     *
+     * \return the number of pixels aligned in the last iteration of all
+     *         parts
+     */
+    int align(const DepthImageView& image,
+              std::vector<Eigen::Matrix3d>& rotations,
+              std::vector<Eigen::Vector3d>& translations);
+
+    const Parameters& parameters() const { return parameters_; }
+    int n_rows() const { return n_rows_; }
+    int n_cols() const { return n_cols_; }
+
+private:
+    /**
+     * \brief Accumulates the normal equations of the point-to-plane errors
+     *        of the rendered pixels
+     * \return the number of aligned pixels
+     */
+    int accumulate(const DepthImageView& image,
+                   Eigen::Matrix<double, 6, 6>& hessian,
+                   Eigen::Matrix<double, 6, 1>& gradient) const;
+
+    /**
+     * \brief Back-projects the observed depth at \a row, \a col
+     * \return false if the depth is missing
+     */
+    bool observed_point(const DepthImageView& image,
+                        int row,
+                        int col,
+                        Eigen::Vector3d& point) const;
+
+    /** \brief Point at \a depth on the ray of the pixel \a row, \a col */
+    Eigen::Vector3d back_project(int row, int col, double depth) const;
+
+private:
+    std::shared_ptr<RigidBodyRenderer> renderer_;
+    Eigen::Matrix3d camera_matrix_;
+    Eigen::Matrix3d camera_matrix_inverse_;
+    int n_rows_;
+    int n_cols_;
+    Parameters parameters_;
+
+    // reused between calls
+    RigidBodyRenderer::Buffer render_buffer_;
+    std::vector<int> intersect_indices_;
+    std::vector<float> depth_;
+};
+}
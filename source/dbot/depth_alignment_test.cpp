@@ -0,0 +1,88 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_alignment_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <dbot/depth_alignment.hpp>
+#include <dbot/synthetic_scene.hpp>
+
+class DepthAlignmentTests : public ::testing::Test
+{
+protected:
+    DepthAlignmentTests()
+        : object_model_(std::make_shared<dbot::SyntheticObjectLoader>(1, 24),
+                        false),
+          poses_(dbot::SyntheticCameraDataProvider::poses(1)),
+          camera_(2, object_model_, poses_)
+    {
+    }
+
+    dbot::DepthAlignment create_alignment(int iterations) const
+    {
+        dbot::DepthAlignment::Parameters parameters;
+        parameters.iterations = iterations;
+
+        const auto image = camera_.depth_image_view();
+        return dbot::DepthAlignment(
+            std::make_shared<dbot::RigidBodyRenderer>(
+                object_model_.flat_mesh()),
+            camera_.camera_matrix(),
+            image.rows(),
+            image.cols(),
+            parameters);
+    }
+
+    dbot::ObjectModel object_model_;
+    std::vector<dbot::RigidBodyRenderer::Affine> poses_;
+    dbot::SyntheticCameraDataProvider camera_;
+};
+
+TEST_F(DepthAlignmentTests, converges_to_the_observed_pose)
+{
+    auto alignment = create_alignment(10);
+
+    std::vector<Eigen::Matrix3d> rotations = {poses_[0].rotation()};
+    std::vector<Eigen::Vector3d> translations = {
+        poses_[0].translation() + Eigen::Vector3d(0.004, -0.003, 0.006)};
+
+    EXPECT_GT(alignment.align(camera_.depth_image_view(),
+                              rotations,
+                              translations),
+              100);
+    EXPECT_LT((translations[0] - poses_[0].translation()).norm(), 2e-4);
+}
+
+TEST_F(DepthAlignmentTests, keeps_the_pose_without_overlap)
+{
+    auto alignment = create_alignment(3);
+
+    // in front of the wall, far from the observed object
+    std::vector<Eigen::Matrix3d> rotations = {poses_[0].rotation()};
+    std::vector<Eigen::Vector3d> translations = {Eigen::Vector3d(0.3, 0.2, 1.)};
+    const Eigen::Vector3d initial = translations[0];
+
+    EXPECT_EQ(alignment.align(camera_.depth_image_view(),
+                              rotations,
+                              translations),
+              0);
+    EXPECT_EQ(translations[0], initial);
+}
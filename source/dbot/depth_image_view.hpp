@@ -0,0 +1,91 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_image_view.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Read-only view of a float depth image in row major order.
+ *
+ * The view does not copy the depths, it merely points to them. The buffer may
+ * be owned by the view through \a owner, e.g. a driver frame which is
+ * released once the last view is gone, or by the caller, who then has to keep
+ * it alive as long as the view is in use. Missing measurements are NaN.
+ */
+class DepthImageView
+{
+public:
+    typedef Eigen::Map<const Eigen::VectorXf> Vector;
+
+public:
+    DepthImageView() : data_(nullptr), rows_(0), cols_(0) {}
+
+    /**
+     * \param data the rows x cols depths in row major order
+     * \param owner optional owner of the buffer kept alive by the view
+     */
+    DepthImageView(const float* data,
+                   int rows,
+                   int cols,
+                   const std::shared_ptr<const void>& owner = nullptr)
+        : data_(data), rows_(rows), cols_(cols), owner_(owner)
+    {
+    }
+
+    /**
+     * \brief Converts the row major depths into a view owning a float copy
+     */
+    template <typename Derived>
+    static DepthImageView copy(const Eigen::DenseBase<Derived>& image,
+                               int rows,
+                               int cols)
+    {
+        auto buffer = std::make_shared<std::vector<float>>(image.size());
+        for (int i = 0; i < image.size(); ++i)
+        {
+            (*buffer)[i] = float(image(i));
+        }
+
+        return DepthImageView(buffer->data(), rows, cols, buffer);
+    }
+
+    const float* data() const { return data_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int size() const { return rows_ * cols_; }
+    bool empty() const { return data_ == nullptr; }
+
+    float operator()(int pixel) const { return data_[pixel]; }
+
+    /** \return the depths as an Eigen vector without copying them */
+    Vector vector() const { return Vector(data_, size()); }
+
+private:
+    const float* data_;
+    int rows_;
+    int cols_;
+    std::shared_ptr<const void> owner_;
+};
+}
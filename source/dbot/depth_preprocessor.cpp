@@ -0,0 +1,251 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_preprocessor.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <dbot/depth_preprocessor.hpp>
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \brief Minimum of two depths ignoring missing ones, same as the vectorized
+ *        version in DepthPreprocessor::pool()
+ */
+inline float min_depth(float a, float x)
+{
+    return a != a ? x : (x < a ? x : a);
+}
+}
+
+DepthPreprocessor::DepthPreprocessor(int downsampling_factor,
+                                     Pooling pooling,
+                                     float max_depth,
+                                     float depth_scale)
+    : factor_(std::max(1, downsampling_factor)),
+      pooling_(pooling),
+      max_depth_(max_depth),
+      depth_scale_(depth_scale)
+{
+}
+
+void DepthPreprocessor::process(const std::uint16_t* raw,
+                                int rows,
+                                int cols,
+                                std::vector<float>& depth) const
+{
+    process_blocks(raw, rows, cols, depth);
+}
+
+void DepthPreprocessor::process(const float* input,
+                                int rows,
+                                int cols,
+                                std::vector<float>& depth) const
+{
+    process_blocks(input, rows, cols, depth);
+}
+
+template <typename Input>
+void DepthPreprocessor::process_blocks(const Input* input,
+                                       int rows,
+                                       int cols,
+                                       std::vector<float>& depth) const
+{
+    const int out_rows = rows / factor_;
+    const int out_cols = cols / factor_;
+    const int block_rows = pooling_ == Pooling::Subsample ? 1 : factor_;
+
+    std::vector<float> block(block_rows * cols);
+    depth.resize(out_rows * out_cols);
+    for (int row = 0; row < out_rows; ++row)
+    {
+        for (int k = 0; k < block_rows; ++k)
+        {
+            convert(input + (row * factor_ + k) * cols, cols, &block[k * cols]);
+        }
+        pool(block.data(), cols, &depth[row * out_cols]);
+    }
+}
+
+void DepthPreprocessor::convert(const std::uint16_t* raw,
+                                int count,
+                                float* depth) const
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    int j = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(depth_scale_);
+    const __m128 max_depth = _mm_set1_ps(max_depth_);
+    const __m128 missing = _mm_set1_ps(nan);
+
+    for (; j + 8 <= count; j += 8)
+    {
+        const __m128i values =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + j));
+        const __m128i halves[2] = {_mm_unpacklo_epi16(values, zero),
+                                   _mm_unpackhi_epi16(values, zero)};
+
+        for (int h = 0; h < 2; ++h)
+        {
+            const __m128 valid =
+                _mm_castsi128_ps(_mm_cmpgt_epi32(halves[h], zero));
+            const __m128 meters = _mm_min_ps(
+                max_depth, _mm_mul_ps(_mm_cvtepi32_ps(halves[h]), scale));
+
+            _mm_storeu_ps(depth + j + 4 * h,
+                          _mm_or_ps(_mm_and_ps(valid, meters),
+                                    _mm_andnot_ps(valid, missing)));
+        }
+    }
+#endif
+
+    for (; j < count; ++j)
+    {
+        const float meters = float(raw[j]) * depth_scale_;
+        const float clamped = max_depth_ < meters ? max_depth_ : meters;
+        depth[j] = raw[j] == 0 ? nan : clamped;
+    }
+}
+
+void DepthPreprocessor::convert(const float* input,
+                                int count,
+                                float* depth) const
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float infinity = std::numeric_limits<float>::infinity();
+    int j = 0;
+
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max_depth = _mm_set1_ps(max_depth_);
+    const __m128 upper = _mm_set1_ps(infinity);
+    const __m128 missing = _mm_set1_ps(nan);
+
+    for (; j + 4 <= count; j += 4)
+    {
+        const __m128 values = _mm_loadu_ps(input + j);
+        const __m128 valid = _mm_and_ps(_mm_cmpgt_ps(values, zero),
+                                        _mm_cmplt_ps(values, upper));
+        const __m128 meters = _mm_min_ps(max_depth, values);
+
+        _mm_storeu_ps(depth + j,
+                      _mm_or_ps(_mm_and_ps(valid, meters),
+                                _mm_andnot_ps(valid, missing)));
+    }
+#endif
+
+    for (; j < count; ++j)
+    {
+        const float value = input[j];
+        const float clamped = max_depth_ < value ? max_depth_ : value;
+        depth[j] = value > 0.f && value < infinity ? clamped : nan;
+    }
+}
+
+void DepthPreprocessor::pool(float* block, int cols, float* depth) const
+{
+    const int out_cols = cols / factor_;
+
+    if (pooling_ == Pooling::Subsample)
+    {
+        for (int col = 0; col < out_cols; ++col)
+        {
+            depth[col] = block[col * factor_];
+        }
+        return;
+    }
+
+    if (pooling_ == Pooling::Median)
+    {
+        std::vector<float> values;
+        values.reserve(factor_ * factor_);
+        for (int col = 0; col < out_cols; ++col)
+        {
+            values.clear();
+            for (int k = 0; k < factor_; ++k)
+            {
+                const float* row = block + k * cols + col * factor_;
+                for (int i = 0; i < factor_; ++i)
+                {
+                    if (row[i] == row[i]) values.push_back(row[i]);
+                }
+            }
+
+            if (values.empty())
+            {
+                depth[col] = std::numeric_limits<float>::quiet_NaN();
+                continue;
+            }
+
+            auto median = values.begin() + (values.size() - 1) / 2;
+            std::nth_element(values.begin(), median, values.end());
+            depth[col] = *median;
+        }
+        return;
+    }
+
+    // reduce the rows of the block into its first row
+    for (int k = 1; k < factor_; ++k)
+    {
+        float* accumulator = block;
+        const float* row = block + k * cols;
+        int j = 0;
+
+#if defined(__SSE2__)
+        for (; j + 4 <= cols; j += 4)
+        {
+            const __m128 a = _mm_loadu_ps(accumulator + j);
+            const __m128 x = _mm_loadu_ps(row + j);
+            const __m128 a_missing = _mm_cmpunord_ps(a, a);
+            const __m128 closest = _mm_min_ps(x, a);
+
+            _mm_storeu_ps(accumulator + j,
+                          _mm_or_ps(_mm_and_ps(a_missing, x),
+                                    _mm_andnot_ps(a_missing, closest)));
+        }
+#endif
+
+        for (; j < cols; ++j)
+        {
+            accumulator[j] = min_depth(accumulator[j], row[j]);
+        }
+    }
+
+    for (int col = 0; col < out_cols; ++col)
+    {
+        const float* values = block + col * factor_;
+
+        float closest = values[0];
+        for (int i = 1; i < factor_; ++i)
+        {
+            closest = min_depth(closest, values[i]);
+        }
+        depth[col] = closest;
+    }
+}
+}
@@ -0,0 +1,114 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_preprocessor.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace dbot
+{
+/**
+ * \brief Converts raw sensor depth images into the float images in meters
+ *        the sensors evaluate.
+ *
+ * Raw depths are scaled to meters, where a raw depth of zero marks a
+ * missing measurement and becomes NaN. Depths beyond the maximum depth of
+ * the pixel model are clamped to it. The image is then downsampled by pooling
+ * blocks of downsampling_factor x downsampling_factor pixels, ignoring
+ * missing measurements. A block without any measurement is NaN.
+ *
+ * The conversion and the min pooling are vectorized where SSE2 is available.
+ * The vectorized and the scalar loops yield identical results.
+ */
+class DepthPreprocessor
+{
+public:
+    enum class Pooling
+    {
+        /// the top left pixel of each block
+        Subsample,
+        /// the closest depth of each block, which keeps thin foreground
+        /// structures
+        Min,
+        /// the lower median depth of each block, which suppresses outliers
+        Median
+    };
+
+public:
+    /**
+     * \param downsampling_factor the edge length of the pooled blocks
+     * \param pooling the reduction of the depths of a block
+     * \param max_depth the maximum depth of the pixel model in meters
+     * \param depth_scale meters per raw depth unit
+     */
+    explicit DepthPreprocessor(int downsampling_factor,
+                               Pooling pooling = Pooling::Min,
+                               float max_depth = 6.0f,
+                               float depth_scale = 0.001f);
+
+    /**
+     * \brief Converts the rows x cols raw depths in row major order into
+     *        \a depth of size rows / factor x cols / factor
+     */
+    void process(const std::uint16_t* raw,
+                 int rows,
+                 int cols,
+                 std::vector<float>& depth) const;
+
+    /**
+     * \brief Pools and clamps the rows x cols depths in meters. NaN and
+     *        infinite depths are missing measurements.
+     */
+    void process(const float* input,
+                 int rows,
+                 int cols,
+                 std::vector<float>& depth) const;
+
+    int downsampling_factor() const { return factor_; }
+    Pooling pooling() const { return pooling_; }
+    float max_depth() const { return max_depth_; }
+
+private:
+    /** \brief Converts and pools the image block row by block row */
+    template <typename Input>
+    void process_blocks(const Input* input,
+                        int rows,
+                        int cols,
+                        std::vector<float>& depth) const;
+
+    /** \brief Converts \a count raw depths into meters */
+    void convert(const std::uint16_t* raw, int count, float* depth) const;
+
+    /** \brief Sanitizes \a count depths in meters */
+    void convert(const float* input, int count, float* depth) const;
+
+    /**
+     * \brief Pools the factor consecutive rows of \a block, each of width
+     *        \a cols, into one output row
+     */
+    void pool(float* block, int cols, float* depth) const;
+
+private:
+    int factor_;
+    Pooling pooling_;
+    float max_depth_;
+    float depth_scale_;
+};
+}
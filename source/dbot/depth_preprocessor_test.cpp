@@ -0,0 +1,112 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_preprocessor_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstdint>
+
+#include <dbot/depth_preprocessor.hpp>
+
+using dbot::DepthPreprocessor;
+
+typedef DepthPreprocessor::Pooling Pooling;
+
+TEST(DepthPreprocessorTests, converts_millimeters_and_masks_missing_depths)
+{
+    // wider than a vector register to cover the vectorized and scalar loops
+    std::vector<std::uint16_t> raw = {
+        0, 500, 1000, 7000, 1500, 0, 2000, 2500, 3000, 0, 6000};
+
+    DepthPreprocessor preprocessor(1, Pooling::Subsample);
+    std::vector<float> depth;
+    preprocessor.process(raw.data(), 1, int(raw.size()), depth);
+
+    ASSERT_EQ(depth.size(), raw.size());
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        if (raw[i] == 0)
+        {
+            EXPECT_TRUE(std::isnan(depth[i]));
+        }
+        else
+        {
+            EXPECT_FLOAT_EQ(depth[i], std::min(6.f, raw[i] * 0.001f));
+        }
+    }
+}
+
+TEST(DepthPreprocessorTests, pooling_ignores_missing_depths)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    // two 2 x 2 blocks, the second one without any measurement
+    std::vector<float> input = {3.f, 1.f, nan, nan,
+                                nan, 2.f, nan, nan};
+
+    std::vector<float> depth;
+    DepthPreprocessor(2, Pooling::Min).process(input.data(), 2, 4, depth);
+    ASSERT_EQ(depth.size(), 2);
+    EXPECT_FLOAT_EQ(depth[0], 1.f);
+    EXPECT_TRUE(std::isnan(depth[1]));
+
+    DepthPreprocessor(2, Pooling::Median).process(input.data(), 2, 4, depth);
+    EXPECT_FLOAT_EQ(depth[0], 2.f);
+    EXPECT_TRUE(std::isnan(depth[1]));
+
+    DepthPreprocessor(2, Pooling::Subsample).process(input.data(), 2, 4, depth);
+    EXPECT_FLOAT_EQ(depth[0], 3.f);
+}
+
+TEST(DepthPreprocessorTests, min_pooling_matches_brute_force)
+{
+    const int rows = 12;
+    const int cols = 18;
+    const int factor = 3;
+
+    std::vector<float> input(rows * cols);
+    for (int i = 0; i < rows * cols; ++i)
+    {
+        input[i] = i % 7 == 0 ? std::numeric_limits<float>::quiet_NaN()
+                              : float((i * 37) % 101) / 10.f;
+    }
+
+    std::vector<float> depth;
+    DepthPreprocessor(factor, Pooling::Min, 8.f)
+        .process(input.data(), rows, cols, depth);
+
+    for (int row = 0; row < rows / factor; ++row)
+    {
+        for (int col = 0; col < cols / factor; ++col)
+        {
+            float expected = std::numeric_limits<float>::infinity();
+            for (int i = 0; i < factor * factor; ++i)
+            {
+                const float value = input[(row * factor + i / factor) * cols +
+                                          col * factor + i % factor];
+                if (value > 0) expected = std::min(expected, value);
+            }
+            expected = std::min(expected, 8.f);
+
+            EXPECT_FLOAT_EQ(depth[row * (cols / factor) + col], expected);
+        }
+    }
+}
@@ -0,0 +1,167 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_recording.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <dbot/depth_recording.hpp>
+
+namespace dbot
+{
+void DepthRecording::encode(const Affine& pose, double* values)
+{
+    const Eigen::Quaterniond q(pose.rotation());
+
+    Eigen::Map<Eigen::Vector3d> position(values);
+    Eigen::Map<Eigen::Vector4d> orientation(values + 3);
+    position = pose.translation();
+    orientation = q.coeffs();
+}
+
+auto DepthRecording::decode(const double* values) -> Affine
+{
+    Eigen::Quaterniond q;
+    q.coeffs() = Eigen::Map<const Eigen::Vector4d>(values + 3);
+
+    Affine pose = Affine::Identity();
+    pose.linear() = q.normalized().toRotationMatrix();
+    pose.translation() = Eigen::Map<const Eigen::Vector3d>(values);
+    return pose;
+}
+
+DepthRecordingWriter::DepthRecordingWriter(
+    const std::string& path,
+    const Eigen::Matrix3d& camera_matrix,
+    const CameraData::Resolution& resolution,
+    const std::vector<Affine>& initial_poses,
+    double depth_scale)
+    : path_(path), file_(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file_)
+    {
+        throw InvalidDepthRecordingException(path, "cannot create the file");
+    }
+
+    std::memset(&header_, 0, sizeof(header_));
+    std::strncpy(header_.magic, DepthRecording::magic(), 8);
+    header_.version = DepthRecording::Version;
+    header_.rows = resolution.height;
+    header_.cols = resolution.width;
+    header_.part_count = initial_poses.size();
+    header_.frame_count = 0;
+    header_.depth_scale = depth_scale;
+    Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> camera(
+        header_.camera_matrix);
+    camera = camera_matrix;
+
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    write_poses(initial_poses);
+
+    raw_.resize(std::size_t(header_.rows) * header_.cols);
+}
+
+DepthRecordingWriter::~DepthRecordingWriter()
+{
+    close();
+}
+
+void DepthRecordingWriter::write(double time,
+                                 const std::uint16_t* depth,
+                                 const std::vector<Affine>& ground_truth)
+{
+    if (!file_.is_open())
+    {
+        throw InvalidDepthRecordingException(path_, "the file is closed");
+    }
+    if (!ground_truth.empty() && ground_truth.size() != header_.part_count)
+    {
+        throw InvalidDepthRecordingException(
+            path_, "the ground truth does not match the part count");
+    }
+
+    // unknown ground truth poses are written as NaN
+    file_.write(reinterpret_cast<const char*>(&time), sizeof(time));
+    write_poses(ground_truth);
+
+    const std::size_t depth_size = raw_.size() * sizeof(std::uint16_t);
+    file_.write(reinterpret_cast<const char*>(depth), depth_size);
+
+    const std::size_t padding = DepthRecording::frame_size(header_) -
+                                sizeof(double) -
+                                DepthRecording::poses_size(header_) -
+                                depth_size;
+    const char zeros[8] = {};
+    file_.write(zeros, padding);
+
+    if (!file_)
+    {
+        throw InvalidDepthRecordingException(path_, "cannot write a frame");
+    }
+    header_.frame_count++;
+}
+
+void DepthRecordingWriter::write(double time,
+                                 const DepthImageView& depth,
+                                 const std::vector<Affine>& ground_truth)
+{
+    if (std::size_t(depth.size()) != raw_.size())
+    {
+        throw InvalidDepthRecordingException(
+            path_, "the frame does not match the recorded resolution");
+    }
+
+    const double max_raw = std::numeric_limits<std::uint16_t>::max();
+    for (int i = 0; i < depth.size(); ++i)
+    {
+        const double raw = std::round(depth(i) / header_.depth_scale);
+        raw_[i] = std::isfinite(raw) && raw > 0.
+                      ? std::uint16_t(std::min(raw, max_raw))
+                      : 0;
+    }
+
+    write(time, raw_.data(), ground_truth);
+}
+
+void DepthRecordingWriter::close()
+{
+    if (!file_.is_open()) return;
+
+    file_.seekp(offsetof(DepthRecording::Header, frame_count));
+    file_.write(reinterpret_cast<const char*>(&header_.frame_count),
+                sizeof(header_.frame_count));
+    file_.close();
+}
+
+void DepthRecordingWriter::write_poses(const std::vector<Affine>& poses)
+{
+    std::vector<double> values(header_.part_count * DepthRecording::PoseSize,
+                               std::numeric_limits<double>::quiet_NaN());
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+        DepthRecording::encode(poses[i],
+                               &values[i * DepthRecording::PoseSize]);
+    }
+
+    file_.write(reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(double));
+}
+}
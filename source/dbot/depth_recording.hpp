@@ -0,0 +1,177 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_recording.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <fl/exception/exception.hpp>
+
+#include <dbot/camera_data.hpp>
+#include <dbot/depth_image_view.hpp>
+
+namespace dbot
+{
+class InvalidDepthRecordingException : public fl::Exception
+{
+public:
+    InvalidDepthRecordingException(const std::string& path,
+                                   const std::string& reason)
+        : Exception()
+    {
+        info("File", path);
+        info("Reason", reason);
+    }
+
+    virtual std::string name() const noexcept
+    {
+        return "dbot::InvalidDepthRecordingException";
+    }
+};
+
+/**
+ * \brief Layout of a recorded depth stream.
+ *
+ * A recording consists of the header, the initial poses of the object parts
+ * and the frames, all in host byte order. Each frame holds its time stamp,
+ * the ground truth poses of the parts and the raw depths in row major order,
+ * where zero is a missing measurement. Frames have a fixed size, hence a
+ * memory mapped recording is accessed at random without an index.
+ *
+ * A pose is stored as 7 doubles, the position followed by the orientation
+ * quaternion (x, y, z, w) in the camera frame. Missing ground truth poses
+ * are NaN.
+ */
+struct DepthRecording
+{
+    typedef Eigen::Transform<double, 3, Eigen::Affine> Affine;
+
+    enum
+    {
+        Version = 1,
+        PoseSize = 7
+    };
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t rows;
+        std::uint32_t cols;
+        std::uint32_t part_count;
+        std::uint64_t frame_count;
+        /// meters per raw depth unit
+        double depth_scale;
+        /// camera matrix of the recorded resolution in row major order
+        double camera_matrix[9];
+    };
+
+    static const char* magic() { return "DBOTREC"; }
+
+    static std::size_t poses_size(const Header& header)
+    {
+        return header.part_count * PoseSize * sizeof(double);
+    }
+
+    /** \brief Size of a frame including the padding to 8 bytes */
+    static std::size_t frame_size(const Header& header)
+    {
+        const std::size_t size =
+            sizeof(double) + poses_size(header) +
+            std::size_t(header.rows) * header.cols * sizeof(std::uint16_t);
+        return (size + 7) / 8 * 8;
+    }
+
+    /** \brief Offset of frame \a index from the beginning of the file */
+    static std::size_t frame_offset(const Header& header, std::size_t index)
+    {
+        return sizeof(Header) + poses_size(header) +
+               index * frame_size(header);
+    }
+
+    static void encode(const Affine& pose, double* values);
+    static Affine decode(const double* values);
+};
+
+static_assert(sizeof(DepthRecording::Header) == 112,
+              "the recording header must not be padded");
+
+/**
+ * \brief Writes a DepthRecording frame by frame. The frame count of the
+ *        header is only valid once the writer has been closed.
+ */
+class DepthRecordingWriter
+{
+public:
+    typedef DepthRecording::Affine Affine;
+
+public:
+    /**
+     * \param camera_matrix the camera matrix of the recorded resolution
+     * \param initial_poses the poses the trackers are initialized with
+     * \param depth_scale meters per raw depth unit
+     *
+     * \throws InvalidDepthRecordingException if the file cannot be created
+     */
+    DepthRecordingWriter(const std::string& path,
+                         const Eigen::Matrix3d& camera_matrix,
+                         const CameraData::Resolution& resolution,
+                         const std::vector<Affine>& initial_poses,
+                         double depth_scale = 0.001);
+
+    ~DepthRecordingWriter();
+
+    /**
+     * \brief Appends a frame of raw depths
+     *
+     * \param ground_truth the poses of the parts, may be empty if unknown
+     */
+    void write(double time,
+               const std::uint16_t* depth,
+               const std::vector<Affine>& ground_truth);
+
+    /**
+     * \brief Appends a frame of depths in meters, which are quantized to the
+     *        depth scale. NaN and infinite depths are missing measurements.
+     */
+    void write(double time,
+               const DepthImageView& depth,
+               const std::vector<Affine>& ground_truth);
+
+    /** \brief Writes the frame count into the header and closes the file */
+    void close();
+
+    int frame_count() const { return header_.frame_count; }
+
+private:
+    void write_poses(const std::vector<Affine>& poses);
+
+private:
+    std::string path_;
+    std::ofstream file_;
+    DepthRecording::Header header_;
+    std::vector<std::uint16_t> raw_;
+};
+}
@@ -27,10 +27,12 @@ namespace dbot
 {
 FileShaderProvider::FileShaderProvider(const std::string& fragment_shader_file,
                                        const std::string& vertex_shader_file,
-                                       const std::string& geometry_shader_file)
+                                       const std::string& geometry_shader_file,
+                                       const std::string& compute_shader_file)
     : SimpleShaderProvider(load_file_content(fragment_shader_file),
                            load_file_content(vertex_shader_file),
-                           load_file_content(geometry_shader_file))
+                           load_file_content(geometry_shader_file),
+                           load_file_content(compute_shader_file))
 {
 }
 
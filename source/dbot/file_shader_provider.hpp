@@ -52,10 +52,14 @@ public:
      * \param geometry_shader_file
      *          Optional geometry shader file. if no geometry shader is given,
      *          set the argument to "none"
+     * \param compute_shader_file
+     *          Optional compute shader file, "none" selects the default
+     *          compute shader
      */
     FileShaderProvider(const std::string& fragment_shader_file,
                        const std::string& vertex_shader_file,
-                       const std::string& geometry_shader_file = "none");
+                       const std::string& geometry_shader_file = "none",
+                       const std::string& compute_shader_file = "none");
 
 protected:
     /**
@@ -75,3 +75,25 @@ TEST(FileShaderProviderTests, with_geometry_shaders)
     EXPECT_TRUE(shader_provider.has_geometry_shader());
 }
 
+
+TEST(FileShaderProviderTests, with_compute_shaders)
+{
+    std::string fragment_shader_file = write_temp_file("fragment shader code");
+    std::string vertex_shader_file = write_temp_file("vertex shader code");
+    std::string compute_shader_file = write_temp_file("compute shader code");
+
+    dbot::FileShaderProvider without_compute_shader(fragment_shader_file,
+                                                    vertex_shader_file);
+    EXPECT_FALSE(without_compute_shader.has_compute_shader());
+
+    dbot::FileShaderProvider shader_provider(fragment_shader_file,
+                                             vertex_shader_file,
+                                             "none",
+                                             compute_shader_file);
+
+    EXPECT_EQ(shader_provider.compute_shader().compare("compute shader code"),
+              0);
+
+    EXPECT_TRUE(shader_provider.has_compute_shader());
+    EXPECT_FALSE(shader_provider.has_geometry_shader());
+}
@@ -24,19 +24,28 @@
 
 #pragma once
 
+#include <cmath>
 #include <vector>
 #include <limits>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
 
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
-#include <fl/distribution/gaussian.hpp>
 #include <fl/distribution/discrete_distribution.hpp>
 #include <fl/util/profiling.hpp>
 
 #include <dbot/traits.hpp>
+#include <dbot/philox.hpp>
+#include <dbot/thread_pool.hpp>
+#include <dbot/snapshot.hpp>
+#include <dbot/instrumentation.hpp>
+#include <dbot/filter/resampling.hpp>
+#include <dbot/model/batch_transition.hpp>
 #include <dbot/model/rao_blackwell_sensor.hpp>
 
 namespace dbot
@@ -57,16 +66,69 @@ public:
 
     typedef fl::DiscreteDistribution<State> Belief;
 
+    typedef dbot::BatchTransition<State, Noise, Input> BatchTransition;
+    typedef typename BatchTransition::Matrix Matrix;
+
+    /**
+     * \brief Parameters of the adaptive particle count
+     *
+     * After each filter step the number of particles is chosen such that,
+     * with probability 1 - delta, the KL divergence between the particle
+     * approximation and the true posterior stays below \a error (Fox, 2003).
+     * The bound depends on the number k of histogram bins occupied by the
+     * particles,
+     *
+     * \f$ n = \frac{k-1}{2\epsilon} \left(1 - \frac{2}{9(k-1)} +
+     *        \sqrt{\frac{2}{9(k-1)}} z_{1-\delta}\right)^3 \f$
+     *
+     * and it is clamped to [\a min_sample_count, \a max_sample_count].
+     */
+    struct KldSampling
+    {
+        int min_sample_count;
+        int max_sample_count;
+
+        /// KL divergence bound epsilon
+        fl::Real error;
+
+        /// upper 1 - delta quantile of the standard normal distribution
+        fl::Real quantile;
+
+        /// histogram bin size of each state coordinate, coordinates with a
+        /// bin size of zero are not binned
+        Eigen::Matrix<fl::Real, -1, 1> bin_sizes;
+    };
+
 public:
     /// constructor and destructor *********************************************
+    /**
+     * \param thread_count  Number of threads sampling and propagating the
+     *                      particles. Zero selects the number of hardware
+     *                      threads.
+     * \param seed          Seed of the noise. The noise of each particle is
+     *                      drawn from its own counter based stream, hence
+     *                      the results are reproducible for a given seed
+     *                      regardless of the thread count.
+     */
     RaoBlackwellCoordinateParticleFilter(
         const std::shared_ptr<Transition> transition,
         const std::shared_ptr<Sensor> sensor,
         const std::vector<std::vector<int>>& sampling_blocks,
-        const fl::Real& max_kl_divergence = 0)
+        const fl::Real& max_kl_divergence = 0,
+        const int thread_count = 1,
+        const std::uint64_t seed = 0)
         : sensor_(sensor),
           transition_(transition),
-          max_kl_divergence_(max_kl_divergence)
+          batch_transition_(
+              std::dynamic_pointer_cast<BatchTransition>(transition)),
+          max_kl_divergence_(max_kl_divergence),
+          resampling_scheme_(ResamplingScheme::Multinomial),
+          kld_sampling_enabled_(false),
+          thread_pool_(std::make_shared<ThreadPool>(thread_count)),
+          noise_key_(Philox::key(seed)),
+          frame_(0),
+          resampling_count_(0),
+          noise_scale_(1)
     {
         sampling_blocks_ = sampling_blocks;
 
@@ -89,70 +151,189 @@ public:
     void filter(const Observation& observation, const Input& input)
     {
         sensor_->set_observation(observation);
+        filter(input);
+    }
 
-        loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
+    /**
+     * \brief Filters the float depth image without converting it, see
+     *        RbSensor::set_observation()
+     */
+    void filter(const DepthImageView& observation, const Input& input)
+    {
+        sensor_->set_observation(observation);
+        filter(input);
+    }
+
+    /**
+     * \brief Filters the observation which has been set on the sensor
+     */
+    void filter(const Input& input)
+    {
+        // the buffers keep their memory between steps of the same size
+        loglikes_.setZero(belief_.size());
+        noises_.resize(belief_.size());
+        for (Noise& noise : noises_)
+        {
+            noise.setZero(transition_->noise_dimension());
+        }
         old_particles_ = belief_.locations();
         for (size_t i_block = 0; i_block < sampling_blocks_.size(); i_block++)
         {
-            // add noise of this block -----------------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+            // add noise of this block and propagate using partial noise ------
             {
-                for (size_t i = 0; i < sampling_blocks_[i_block].size(); i++)
+                ScopedStageTimer timer(instrumentation_.get(),
+                                       Stage::Propagate);
+                if (batch_transition_)
                 {
-                    noises_[i_sampl](sampling_blocks_[i_block][i]) =
-                        unit_gaussian_.sample()(0);
+                    propagate_batches(sampling_blocks_[i_block], input);
+                }
+                else
+                {
+                    thread_pool_->parallel_for(
+                        belief_.size(),
+                        [&](int i_sampl, int)
+                        {
+                            sample_noise(i_sampl, sampling_blocks_[i_block]);
+                            belief_.location(i_sampl) = transition_->state(
+                                old_particles_[i_sampl],
+                                noises_[i_sampl],
+                                input);
+                        },
+                        16);
                 }
-            }
-
-            // propagate using partial noise -----------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
-            {
-                belief_.location(i_sampl) = transition_->state(
-                    old_particles_[i_sampl], noises_[i_sampl], input);
             }
 
             // compute likelihood ----------------------------------------------
+            // the stages reported by the sensor are not part of Weigh
             bool update = (i_block == sampling_blocks_.size() - 1);
-            RealArray new_loglikes = sensor_->loglikes(
-                belief_.locations(), indices_, update);
+            {
+                ScopedStageTimer timer(instrumentation_.get(), Stage::Weigh);
+                sensor_->loglikes(
+                    belief_.locations(), indices_, update, new_loglikes_);
+            }
 
             // update the weights and resample if necessary --------------------
-            belief_.delta_log_prob_mass(new_loglikes - loglikes_);
-            loglikes_ = new_loglikes;
+            delta_loglikes_ = new_loglikes_ - loglikes_;
+            belief_.delta_log_prob_mass(delta_loglikes_);
+            loglikes_.swap(new_loglikes_);
 
             if (belief_.kl_given_uniform() > max_kl_divergence_)
             {
                 resample(belief_.size());
             }
         }
+
+        if (kld_sampling_enabled_)
+        {
+            const size_t sample_count = kld_sample_count();
+            if (sample_count != belief_.size()) resample(sample_count);
+        }
+
+        if (instrumentation_ && instrumentation_->recording())
+        {
+            instrumentation_->effective_sample_size(effective_sample_size());
+        }
+
+        ++frame_;
+    }
+
+    /**
+     * \return Number of particles required by the KLD bound for the current
+     *         belief, see KldSampling
+     */
+    size_t kld_sample_count()
+    {
+        const KldSampling& kld = kld_sampling_;
+
+        // hash of the occupied bin of each particle
+        bins_.resize(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            const State& state = belief_.location(i);
+
+            std::uint64_t hash = 14695981039346656037ull;
+            for (int j = 0; j < kld.bin_sizes.size(); ++j)
+            {
+                if (kld.bin_sizes(j) <= 0) continue;
+
+                const std::int64_t bin =
+                    std::int64_t(std::floor(state(j) / kld.bin_sizes(j)));
+                hash = (hash ^ std::uint64_t(bin)) * 1099511628211ull;
+            }
+            bins_[i] = hash;
+        }
+        std::sort(bins_.begin(), bins_.end());
+        const int k = std::unique(bins_.begin(), bins_.end()) - bins_.begin();
+
+        fl::Real count = kld.min_sample_count;
+        if (k > 1)
+        {
+            const fl::Real a = 2. / (9. * (k - 1));
+            const fl::Real b = 1 - a + std::sqrt(a) * kld.quantile;
+            count = (k - 1) / (2 * kld.error) * b * b * b;
+        }
+
+        return size_t(std::max<fl::Real>(
+            kld.min_sample_count,
+            std::min<fl::Real>(kld.max_sample_count, std::ceil(count))));
+    }
+
+    /**
+     * \return 1 / sum w_i^2 of the particle weights, between 1 for a single
+     *         particle holding all of the weight and the number of particles
+     *         for uniform weights
+     */
+    fl::Real effective_sample_size() const
+    {
+        fl::Real sum = 0;
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            const fl::Real weight = belief_.prob_mass(i);
+            sum += weight * weight;
+        }
+
+        return sum > 0 ? 1 / sum : 0;
     }
 
     void resample(const size_t& sample_count)
     {
-        IntArray indices(sample_count);
-        std::vector<Noise> noises(sample_count);
-        StateArray next_samples(sample_count);
-        RealArray loglikes(sample_count);
+        ScopedStageTimer timer(instrumentation_.get(), Stage::Resample);
+        if (instrumentation_ && instrumentation_->recording())
+        {
+            instrumentation_->count_resample();
+        }
 
-        Belief new_belief(sample_count);
+        sample_ancestors(sample_count);
+
+        // gather the particle buffers through the ancestor indices into
+        // the spare buffers which are kept to avoid reallocations
+        next_particles_.resize(sample_count);
+        next_indices_.resize(sample_count);
+        next_noises_.resize(sample_count);
+        next_old_particles_.resize(sample_count);
+        next_loglikes_.resize(sample_count);
 
         for (size_t i = 0; i < sample_count; i++)
         {
-            int index;
-            new_belief.location(i) = belief_.sample(index);
+            const int index = ancestors_[i];
+
+            next_particles_[i] = belief_.location(index);
+            next_indices_[i] = indices_[index];
+            next_noises_[i] = noises_[index];
+            next_old_particles_[i] = old_particles_[index];
+            next_loglikes_[i] = loglikes_[index];
+        }
 
-            indices[i] = indices_[index];
-            noises[i] = noises_[index];
-            next_samples[i] = old_particles_[index];
-            loglikes[i] = loglikes_[index];
+        belief_.set_uniform(sample_count);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            belief_.location(i) = next_particles_[i];
         }
-        belief_ = new_belief;
-        indices_ = indices;
-        noises_ = noises;
-        old_particles_ = next_samples;
-        loglikes_ = loglikes;
+
+        indices_.swap(next_indices_);
+        noises_.swap(next_noises_);
+        old_particles_.swap(next_old_particles_);
+        loglikes_.swap(next_loglikes_);
     }
 
     /// accessors **************************************************************
@@ -161,8 +342,52 @@ public:
         return sampling_blocks_;
     }
 
+    ResamplingScheme resampling_scheme() const { return resampling_scheme_; }
+
+    /**
+     * \return Ancestor of each particle in the last resampling step
+     */
+    const IntArray& ancestors() const { return ancestors_; }
+
     /// mutators ***************************************************************
     Belief& belief() { return belief_; }
+
+    void resampling_scheme(ResamplingScheme scheme)
+    {
+        resampling_scheme_ = scheme;
+    }
+
+    /**
+     * \brief Sets the time of the next steps relative to the step the
+     *        transition has been designed for, e.g. 2 after a dropped frame.
+     *        The noise of the particles grows with the square root of
+     *        \a scale, as the spread of a random walk does.
+     */
+    void time_scale(fl::Real scale) { noise_scale_ = std::sqrt(scale); }
+
+    /**
+     * \brief Enables the adaptive particle count. The sensor has to support
+     *        up to \a kld.max_sample_count particles.
+     */
+    void kld_sampling(const KldSampling& kld)
+    {
+        kld_sampling_ = kld;
+        kld_sampling_enabled_ = true;
+    }
+
+    void disable_kld_sampling() { kld_sampling_enabled_ = false; }
+
+    /**
+     * \brief Sets the instrumentation of the filter steps, which is passed
+     *        on to the sensor
+     */
+    void instrumentation(
+        const std::shared_ptr<Instrumentation>& instrumentation)
+    {
+        instrumentation_ = instrumentation;
+        sensor_->instrumentation(instrumentation);
+    }
+
     void set_particles(const std::vector<State>& samples)
     {
         belief_.set_uniform(samples.size());
@@ -178,6 +403,79 @@ public:
         sensor_->reset();
     }
 
+    /**
+     * \brief Writes the particles, their weights and occlusions and the
+     *        position in the noise streams, see Tracker::snapshot()
+     */
+    void snapshot(Snapshot& snapshot) const
+    {
+        snapshot.write<std::uint64_t>(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            snapshot.write_matrix(belief_.location(i));
+        }
+        snapshot.write_matrix(belief_.log_prob_mass());
+        snapshot.write_matrix(indices_);
+        snapshot.write(frame_);
+        snapshot.write(resampling_count_);
+
+        sensor_->snapshot(snapshot, indices_);
+    }
+
+    /**
+     * \brief Continues from the particles written by snapshot(). The
+     *        following steps draw the same noise as those of the filter
+     *        which wrote the snapshot.
+     *
+     * \throws InvalidSnapshotException if the particles exceed the states
+     *         the sensor evaluates or refer to occlusions it did not restore
+     */
+    void restore(Snapshot::Reader& reader)
+    {
+        const std::uint64_t count = reader.read<std::uint64_t>();
+        if (count > std::uint64_t(sensor_->max_states()))
+        {
+            throw InvalidSnapshotException(
+                std::to_string(count) + " particles exceed the " +
+                std::to_string(sensor_->max_states()) +
+                " states of the sensor");
+        }
+        belief_.set_uniform(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            reader.read_matrix(belief_.location(i));
+        }
+        reader.read_matrix(weights_);
+        reader.read_matrix(indices_);
+        if (std::uint64_t(weights_.size()) != count ||
+            std::uint64_t(indices_.size()) != count)
+        {
+            throw InvalidSnapshotException("the particle count does not match");
+        }
+        belief_.log_unnormalized_prob_mass(weights_);
+        frame_ = reader.read<std::uint64_t>();
+        resampling_count_ = reader.read<std::uint64_t>();
+
+        loglikes_ = RealArray::Zero(count);
+        noises_ = std::vector<Noise>(
+            count, Noise::Zero(transition_->noise_dimension()));
+        old_particles_ = belief_.locations();
+
+        // without occlusions the particles start off from the initial ones
+        const int occlusion_count = sensor_->restore(reader);
+        if (occlusion_count == 0)
+        {
+            indices_.setZero();
+        }
+        else if (count > 0 && (indices_.minCoeff() < 0 ||
+                               indices_.maxCoeff() >= occlusion_count))
+        {
+            throw InvalidSnapshotException(
+                "the particles refer to occlusions outside of the " +
+                std::to_string(occlusion_count) + " restored ones");
+        }
+    }
+
     std::shared_ptr<Sensor> sensor()
     {
         return sensor_;
@@ -188,6 +486,142 @@ public:
         return transition_;
     }
 
+private:
+    /**
+     * \brief Draws \a sample_count ancestor indices into ancestors_
+     *        according to the resampling scheme.
+     *
+     * The uniforms of the O(N) schemes are drawn from the Philox counters
+     * (i / 4, 2^32 - 1, n) where n counts the resampling steps. The second
+     * word never occurs as particle index of the noise streams.
+     */
+    void sample_ancestors(const size_t& sample_count)
+    {
+        ancestors_.resize(sample_count);
+
+        if (resampling_scheme_ == ResamplingScheme::Multinomial)
+        {
+            for (size_t i = 0; i < sample_count; i++)
+            {
+                int index;
+                belief_.sample(index);
+                ancestors_[i] = index;
+            }
+            return;
+        }
+
+        weights_.resize(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            weights_[i] = belief_.prob_mass(i);
+        }
+
+        const int uniform_count =
+            resampling_scheme_ == ResamplingScheme::Stratified ? sample_count
+                                                               : 1;
+        uniforms_.resize(uniform_count + 3);
+        for (int i = 0; i < uniform_count; i += 4)
+        {
+            Philox::uniform(Philox::Counter{{std::uint32_t(i / 4),
+                                             0xFFFFFFFFu,
+                                             std::uint32_t(resampling_count_),
+                                             std::uint32_t(resampling_count_ >>
+                                                           32)}},
+                            noise_key_,
+                            &uniforms_[i]);
+        }
+        ++resampling_count_;
+
+        switch (resampling_scheme_)
+        {
+            case ResamplingScheme::Systematic:
+                systematic_resampling(weights_, uniforms_[0], ancestors_);
+                break;
+            case ResamplingScheme::Stratified:
+                stratified_resampling(weights_, uniforms_, ancestors_);
+                break;
+            case ResamplingScheme::Residual:
+                residual_resampling(
+                    weights_, uniforms_[0], residuals_, ancestors_);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /**
+     * \brief Samples the noise of \a block and propagates the particles with
+     *        the BatchTransition, in batches of a fixed number of particles.
+     *
+     * The batches do not depend on the thread count, hence neither do the
+     * results.
+     */
+    void propagate_batches(const std::vector<int>& block, const Input& input)
+    {
+        const int count = belief_.size();
+        const int batch_size = 256;
+        const int batch_count = (count + batch_size - 1) / batch_size;
+
+        batch_states_.resize(transition_->state_dimension(), count);
+        batch_noises_.resize(transition_->noise_dimension(), count);
+        batch_predictions_.resize(transition_->state_dimension(), count);
+
+        thread_pool_->parallel_for(
+            batch_count,
+            [&](int i_batch, int)
+            {
+                const int begin = i_batch * batch_size;
+                const int size = std::min(batch_size, count - begin);
+
+                for (int i_sampl = begin; i_sampl < begin + size; i_sampl++)
+                {
+                    sample_noise(i_sampl, block);
+                    batch_states_.col(i_sampl) = old_particles_[i_sampl];
+                    batch_noises_.col(i_sampl) = noises_[i_sampl];
+                }
+
+                batch_transition_->states(
+                    batch_states_.middleCols(begin, size),
+                    batch_noises_.middleCols(begin, size),
+                    input,
+                    batch_predictions_.middleCols(begin, size));
+
+                for (int i_sampl = begin; i_sampl < begin + size; i_sampl++)
+                {
+                    belief_.location(i_sampl) = batch_predictions_.col(i_sampl);
+                }
+            });
+    }
+
+    /**
+     * \brief Draws the noise dimensions of \a block of particle \a i_sampl.
+     *
+     * Noise dimension d of particle i in frame f is the (d mod 4)-th
+     * variate of the Philox counter (d / 4, i, f).
+     */
+    void sample_noise(int i_sampl, const std::vector<int>& block)
+    {
+        Noise& noise = noises_[i_sampl];
+
+        int group = -1;
+        fl::Real normals[4];
+        for (size_t i = 0; i < block.size(); i++)
+        {
+            const int dimension = block[i];
+            if (dimension / 4 != group)
+            {
+                group = dimension / 4;
+                Philox::gaussian(Philox::Counter{{std::uint32_t(group),
+                                                  std::uint32_t(i_sampl),
+                                                  std::uint32_t(frame_),
+                                                  std::uint32_t(frame_ >> 32)}},
+                                 noise_key_,
+                                 normals);
+            }
+            noise(dimension) = noise_scale_ * normals[dimension % 4];
+        }
+    }
+
 private:
     /// member variables *******************************************************
     Belief belief_;
@@ -196,16 +630,52 @@ private:
     std::vector<Noise> noises_;
     StateArray old_particles_;
     RealArray loglikes_;
+    RealArray new_loglikes_;
+    RealArray delta_loglikes_;
+
+    // resampling buffers
+    IntArray ancestors_;
+    RealArray weights_;
+    RealArray residuals_;
+    RealArray uniforms_;
+    StateArray next_particles_;
+    IntArray next_indices_;
+    std::vector<Noise> next_noises_;
+    StateArray next_old_particles_;
+    RealArray next_loglikes_;
 
     // models
     std::shared_ptr<Sensor> sensor_;
     std::shared_ptr<Transition> transition_;
+    std::shared_ptr<BatchTransition> batch_transition_;
+
+    // [dimension x particle] buffers of the batched propagation
+    Matrix batch_states_;
+    Matrix batch_noises_;
+    Matrix batch_predictions_;
 
     // parameters
     std::vector<std::vector<int>> sampling_blocks_;
     fl::Real max_kl_divergence_;
+    ResamplingScheme resampling_scheme_;
+
+    // adaptive particle count
+    bool kld_sampling_enabled_;
+    KldSampling kld_sampling_;
+    std::vector<std::uint64_t> bins_;
+
+    // parallel sampling and propagation
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    // timings and counters of the filter steps, may be null
+    std::shared_ptr<Instrumentation> instrumentation_;
+
+    // counter based noise streams
+    Philox::Key noise_key_;
+    std::uint64_t frame_;
+    std::uint64_t resampling_count_;
 
-    // distribution for sampling
-    fl::Gaussian<Eigen::Matrix<fl::Real, 1, 1>> unit_gaussian_;
+    // square root of the time scale of the steps, see time_scale()
+    fl::Real noise_scale_;
 };
 }
@@ -0,0 +1,132 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rao_blackwell_coordinate_particle_filter_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+#include <dbot/model/kinect_image_model.hpp>
+#include <dbot/builder/object_transition_builder.hpp>
+#include <dbot/filter/rao_blackwell_coordinate_particle_filter.hpp>
+
+/**
+ * \brief Runs full filter steps on a static synthetic scene, one sampling
+ *        block per part. The states are of fixed size unless \a Objects is
+ *        Eigen::Dynamic.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, number of
+ * particles, latitude bands of each sphere, number of parts
+ */
+template <int Objects>
+static void BM_RaoBlackwellCoordinateParticleFilter_Filter(
+    benchmark::State& state)
+{
+    typedef osr::FreeFloatingRigidBodiesState<Objects> State;
+    typedef dbot::ObjectTransitionBuilder<State> TransitionBuilder;
+    typedef typename TransitionBuilder::Model Transition;
+    typedef dbot::RbSensor<State> Sensor;
+    typedef dbot::KinectImageModel<fl::Real, State, Objects> CpuSensor;
+    typedef dbot::RaoBlackwellCoordinateParticleFilter<Transition, Sensor>
+        Filter;
+
+    const int downsampling = state.range(0);
+    const int particle_count = state.range(1);
+    const int rings = state.range(2);
+    const int part_count = state.range(3);
+
+    auto loader =
+        std::make_shared<dbot::SyntheticObjectLoader>(part_count, rings);
+    dbot::ObjectModel object_model(loader, false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(part_count);
+    dbot::SyntheticCameraDataProvider camera(
+        downsampling, object_model, poses);
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    typename TransitionBuilder::Parameters transition_parameters;
+    transition_parameters.linear_sigma_x = 0.002;
+    transition_parameters.linear_sigma_y = 0.002;
+    transition_parameters.linear_sigma_z = 0.002;
+    transition_parameters.angular_sigma_x = 0.01;
+    transition_parameters.angular_sigma_y = 0.01;
+    transition_parameters.angular_sigma_z = 0.01;
+    transition_parameters.velocity_factor = 0.8;
+    transition_parameters.part_count = part_count;
+    auto transition = TransitionBuilder(transition_parameters).build();
+
+    auto sensor = std::make_shared<CpuSensor>(
+        camera.camera_matrix(),
+        n_rows,
+        n_cols,
+        std::make_shared<dbot::RigidBodyRenderer>(object_model.flat_mesh()),
+        std::make_shared<dbot::KinectPixelModel>(),
+        std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+        0.1,
+        0.033);
+    for (int part = 0; part < part_count; ++part)
+    {
+        sensor->integrated_poses().component(part).affine(poses[part]);
+    }
+
+    // 6 noise dimensions per part
+    std::vector<std::vector<int>> sampling_blocks(part_count);
+    for (int part = 0; part < part_count; ++part)
+    {
+        for (int k = 0; k < 6; ++k)
+        {
+            sampling_blocks[part].push_back(part * 6 + k);
+        }
+    }
+
+    Filter filter(transition, sensor, sampling_blocks);
+
+    State zero(part_count);
+    zero.setZero();
+    filter.set_particles(std::vector<State>(particle_count, zero));
+
+    const auto observation = camera.depth_image_view();
+    const typename Filter::Input input = Filter::Input::Zero(1);
+    for (auto _ : state)
+    {
+        filter.filter(observation, input);
+    }
+
+    state.SetItemsProcessed(state.iterations() * particle_count);
+}
+
+BENCHMARK_TEMPLATE(BM_RaoBlackwellCoordinateParticleFilter_Filter,
+                   Eigen::Dynamic)
+    ->ArgNames({"downsampling", "particles", "rings", "parts"})
+    ->Args({4, 200, 16, 1})
+    ->Args({4, 1000, 16, 1})
+    ->Args({2, 200, 16, 1})
+    ->Args({4, 200, 64, 1})
+    ->Args({4, 200, 16, 4})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_RaoBlackwellCoordinateParticleFilter_Filter, 1)
+    ->ArgNames({"downsampling", "particles", "rings", "parts"})
+    ->Args({4, 200, 16, 1})
+    ->Args({4, 1000, 16, 1})
+    ->Unit(benchmark::kMillisecond);
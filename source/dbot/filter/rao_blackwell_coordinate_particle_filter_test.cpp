@@ -0,0 +1,139 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rao_blackwell_coordinate_particle_filter_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+#include <fl/model/transition/interface/transition_function.hpp>
+#include <dbot/filter/rao_blackwell_coordinate_particle_filter.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef Eigen::VectorXd Noise;
+typedef Eigen::VectorXd Input;
+typedef fl::TransitionFunction<State, Noise, Input> Transition;
+typedef dbot::RbSensor<State> Sensor;
+typedef dbot::RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
+
+class StaticTransition : public Transition
+{
+public:
+    State state(const State& state,
+                const Noise& noise,
+                const Input& input) const override
+    {
+        return state;
+    }
+    int state_dimension() const override { return State(1).size(); }
+    int noise_dimension() const override { return 1; }
+    int input_dimension() const override { return 1; }
+};
+
+/**
+ * \brief Sensor restoring a given number of occlusions and evaluating at most
+ *        a given number of states
+ */
+class LimitedSensor : public Sensor
+{
+public:
+    LimitedSensor(int restored_count, int max_states)
+        : Sensor(0.033),
+          restored_count_(restored_count),
+          max_states_(max_states)
+    {
+    }
+
+    using Sensor::loglikes;
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update) override
+    {
+        return RealArray::Zero(deviations.size());
+    }
+
+    void set_observation(const Observation& image) override {}
+    void reset() override {}
+
+    int restore(dbot::Snapshot::Reader& reader) override
+    {
+        reader.read<std::uint8_t>();
+        return restored_count_;
+    }
+
+    int max_states() const override { return max_states_; }
+
+private:
+    int restored_count_;
+    int max_states_;
+};
+
+/**
+ * \brief Snapshot of \a indices.size() particles in the layout written by
+ *        RaoBlackwellCoordinateParticleFilter::snapshot()
+ */
+static dbot::Snapshot filter_snapshot(const std::vector<int>& indices)
+{
+    const int count = indices.size();
+    Eigen::Array<int, -1, 1> index_array(count);
+    for (int i = 0; i < count; ++i) index_array[i] = indices[i];
+
+    dbot::Snapshot snapshot;
+    snapshot.write<std::uint64_t>(count);
+    for (int i = 0; i < count; ++i) snapshot.write_matrix(State(1));
+    snapshot.write_matrix(Eigen::Array<fl::Real, -1, 1>::Zero(count));
+    snapshot.write_matrix(index_array);
+    snapshot.write<std::uint64_t>(0);
+    snapshot.write<std::uint64_t>(0);
+    snapshot.write<std::uint8_t>(0);
+    return snapshot;
+}
+
+static void restore(const dbot::Snapshot& snapshot,
+                    int restored_count,
+                    int max_states)
+{
+    Filter filter(std::make_shared<StaticTransition>(),
+                  std::make_shared<LimitedSensor>(restored_count, max_states),
+                  std::vector<std::vector<int>>{{0}});
+    dbot::Snapshot::Reader reader(snapshot);
+    filter.restore(reader);
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests, restore_checks_the_indices)
+{
+    const dbot::Snapshot snapshot = filter_snapshot({0, 2, 2, 1});
+
+    EXPECT_NO_THROW(restore(snapshot, 3, 4));
+    EXPECT_NO_THROW(restore(snapshot, 4, 100));
+
+    // without occlusions the particles start from the initial ones
+    EXPECT_NO_THROW(restore(snapshot, 0, 4));
+
+    // index 2 refers to a map the sensor did not restore
+    EXPECT_THROW(restore(snapshot, 2, 4), dbot::InvalidSnapshotException);
+
+    // the sensor evaluates fewer states than there are particles
+    EXPECT_THROW(restore(snapshot, 3, 3), dbot::InvalidSnapshotException);
+
+    EXPECT_THROW(restore(filter_snapshot({0, -1}), 3, 4),
+                 dbot::InvalidSnapshotException);
+}
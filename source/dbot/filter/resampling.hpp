@@ -0,0 +1,149 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampling.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <fl/util/types.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Resampling schemes of the particle filters.
+ *
+ * Multinomial draws each ancestor independently. Systematic and stratified
+ * resampling place the draws on an evenly spaced grid with a single or one
+ * offset per draw respectively. Residual resampling copies each particle
+ * floor(N w_i) times and distributes the remaining draws systematically.
+ * All but multinomial resampling run in O(N) and have a lower variance.
+ */
+enum class ResamplingScheme
+{
+    Multinomial,
+    Systematic,
+    Stratified,
+    Residual
+};
+
+namespace internal
+{
+/**
+ * \brief Walks the cumulative \a weights along the sorted positions
+ *        position(i) in [0, total weight) and assigns the ancestors
+ *        \a ancestors[begin + i]
+ */
+template <typename Position>
+void sorted_positions_resampling(const Eigen::Array<fl::Real, -1, 1>& weights,
+                                 const Position& position,
+                                 const int begin,
+                                 const int count,
+                                 Eigen::Array<int, -1, 1>& ancestors)
+{
+    const int last = int(weights.size()) - 1;
+
+    int ancestor = 0;
+    fl::Real cumulative = weights[0];
+    for (int i = 0; i < count; ++i)
+    {
+        const fl::Real x = position(i);
+        while (x >= cumulative && ancestor < last)
+        {
+            cumulative += weights[++ancestor];
+        }
+        ancestors[begin + i] = ancestor;
+    }
+}
+}
+
+/**
+ * \brief Systematic resampling of ancestors.size() ancestors from the
+ *        unnormalized \a weights using the single uniform \a u in [0, 1)
+ */
+inline void systematic_resampling(const Eigen::Array<fl::Real, -1, 1>& weights,
+                                  const fl::Real u,
+                                  Eigen::Array<int, -1, 1>& ancestors)
+{
+    const int count = ancestors.size();
+    const fl::Real step = weights.sum() / count;
+
+    internal::sorted_positions_resampling(
+        weights, [&](int i) { return (i + u) * step; }, 0, count, ancestors);
+}
+
+/**
+ * \brief Stratified resampling of ancestors.size() ancestors from the
+ *        unnormalized \a weights using one uniform in [0, 1) per ancestor
+ */
+inline void stratified_resampling(const Eigen::Array<fl::Real, -1, 1>& weights,
+                                  const Eigen::Array<fl::Real, -1, 1>& uniforms,
+                                  Eigen::Array<int, -1, 1>& ancestors)
+{
+    const int count = ancestors.size();
+    const fl::Real step = weights.sum() / count;
+
+    internal::sorted_positions_resampling(
+        weights,
+        [&](int i) { return (i + uniforms[i]) * step; },
+        0,
+        count,
+        ancestors);
+}
+
+/**
+ * \brief Residual resampling of ancestors.size() ancestors from the
+ *        unnormalized \a weights. The residuals are resampled systematically
+ *        using the uniform \a u in [0, 1). \a residuals is a buffer for the
+ *        residual weights.
+ */
+inline void residual_resampling(const Eigen::Array<fl::Real, -1, 1>& weights,
+                                const fl::Real u,
+                                Eigen::Array<fl::Real, -1, 1>& residuals,
+                                Eigen::Array<int, -1, 1>& ancestors)
+{
+    const int count = ancestors.size();
+    const fl::Real scale = count / weights.sum();
+
+    residuals.resize(weights.size());
+
+    int copied = 0;
+    for (int i = 0; i < weights.size(); ++i)
+    {
+        const fl::Real expected = weights[i] * scale;
+        const int copies = std::min(int(expected), count - copied);
+
+        for (int k = 0; k < copies; ++k) ancestors[copied++] = i;
+        residuals[i] = expected - copies;
+    }
+
+    const int remaining = count - copied;
+    if (remaining == 0) return;
+
+    const fl::Real step = residuals.sum() / remaining;
+    internal::sorted_positions_resampling(
+        residuals,
+        [&](int i) { return (i + u) * step; },
+        copied,
+        remaining,
+        ancestors);
+}
+}
@@ -0,0 +1,109 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampling_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/filter/resampling.hpp>
+
+typedef Eigen::Array<fl::Real, -1, 1> RealArray;
+typedef Eigen::Array<int, -1, 1> IntArray;
+
+static IntArray copies(const IntArray& ancestors, int particles)
+{
+    IntArray counts = IntArray::Zero(particles);
+    for (int i = 0; i < ancestors.size(); ++i) counts[ancestors[i]]++;
+    return counts;
+}
+
+/**
+ * Low variance schemes copy each particle either floor(N w) or ceil(N w)
+ * times and return sorted ancestors
+ */
+static void expect_low_variance(const RealArray& weights,
+                                const IntArray& ancestors)
+{
+    const int count = ancestors.size();
+    const RealArray expected = weights / weights.sum() * count;
+    const IntArray counts = copies(ancestors, weights.size());
+
+    for (int i = 0; i < weights.size(); ++i)
+    {
+        EXPECT_GE(counts[i], std::floor(expected[i]) - 1e-9);
+        EXPECT_LE(counts[i], std::ceil(expected[i]) + 1e-9);
+    }
+
+    for (int i = 1; i < count; ++i)
+    {
+        EXPECT_LE(ancestors[i - 1], ancestors[i]);
+    }
+}
+
+TEST(ResamplingTests, systematic)
+{
+    RealArray weights(5);
+    weights << 0.1, 2.0, 0.0, 1.3, 0.6;
+
+    for (double u : {0.0, 0.25, 0.5, 0.999})
+    {
+        IntArray ancestors(16);
+        dbot::systematic_resampling(weights, u, ancestors);
+        expect_low_variance(weights, ancestors);
+        EXPECT_EQ(copies(ancestors, 5)[2], 0);
+    }
+}
+
+TEST(ResamplingTests, stratified_within_strata)
+{
+    RealArray weights = RealArray::Ones(8);
+    RealArray uniforms(8);
+    uniforms << 0.9, 0.1, 0.5, 0.3, 0.7, 0.2, 0.0, 0.99;
+
+    IntArray ancestors(8);
+    dbot::stratified_resampling(weights, uniforms, ancestors);
+
+    // uniform weights put one draw into each particle
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(ancestors[i], i);
+}
+
+TEST(ResamplingTests, residual)
+{
+    RealArray weights(4);
+    weights << 0.45, 0.3, 0.05, 0.2;
+
+    IntArray ancestors(10);
+    RealArray residuals;
+    dbot::residual_resampling(weights, 0.3, residuals, ancestors);
+
+    const IntArray counts = copies(ancestors, 4);
+    EXPECT_GE(counts[0], 4);
+    EXPECT_GE(counts[1], 3);
+    EXPECT_GE(counts[3], 2);
+    EXPECT_EQ(counts.sum(), 10);
+}
+
+TEST(ResamplingTests, changes_particle_count)
+{
+    RealArray weights = RealArray::Ones(3);
+
+    IntArray ancestors(7);
+    dbot::systematic_resampling(weights, 0.5, ancestors);
+    expect_low_variance(weights, ancestors);
+}
@@ -0,0 +1,69 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flat_mesh.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <dbot/flat_mesh.hpp>
+
+namespace dbot
+{
+FlatMesh::FlatMesh(const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+                   const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    flatten(vertices, indices);
+}
+
+FlatMesh::FlatMesh(const std::vector<std::vector<Eigen::Vector3f>>& vertices,
+                   const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    flatten(vertices, indices);
+}
+
+template <typename Vertex>
+void FlatMesh::flatten(const std::vector<std::vector<Vertex>>& vertices,
+                       const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    vertex_offsets_.assign(1, 0);
+    triangle_offsets_.assign(1, 0);
+    for (size_t part = 0; part < vertices.size(); part++)
+    {
+        vertex_offsets_.push_back(vertex_offsets_.back() +
+                                  vertices[part].size());
+        triangle_offsets_.push_back(triangle_offsets_.back() +
+                                    indices[part].size());
+    }
+
+    vertices_.reserve(3 * count_vertices());
+    indices_.reserve(3 * count_triangles());
+    for (size_t part = 0; part < vertices.size(); part++)
+    {
+        for (const auto& vertex : vertices[part])
+        {
+            for (int k = 0; k < 3; k++) vertices_.push_back(float(vertex(k)));
+        }
+
+        const std::uint32_t offset = vertex_offsets_[part];
+        for (const auto& triangle : indices[part])
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                indices_.push_back(offset + std::uint32_t(triangle[k]));
+            }
+        }
+    }
+}
+}
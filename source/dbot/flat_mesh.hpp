@@ -0,0 +1,84 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flat_mesh.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Meshes of all parts of an object in two contiguous buffers.
+ *
+ * The vertex buffer holds the x, y, z coordinates of the vertices of part 0,
+ * followed by those of part 1 and so on. The index buffer holds three vertex
+ * indices per triangle, again part after part. The indices refer to the whole
+ * vertex buffer, hence both buffers can be uploaded to OpenGL as they are and
+ * each part is drawn from its range of triangles.
+ */
+class FlatMesh
+{
+public:
+    FlatMesh(const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+             const std::vector<std::vector<std::vector<int>>>& indices);
+
+    FlatMesh(const std::vector<std::vector<Eigen::Vector3f>>& vertices,
+             const std::vector<std::vector<std::vector<int>>>& indices);
+
+    int count_parts() const { return int(vertex_offsets_.size()) - 1; }
+    int count_vertices() const { return vertex_offsets_.back(); }
+    int count_triangles() const { return triangle_offsets_.back(); }
+
+    /** \brief The vertices of part \a part are [vertex_begin, vertex_end) */
+    int vertex_begin(int part) const { return vertex_offsets_[part]; }
+    int vertex_end(int part) const { return vertex_offsets_[part + 1]; }
+
+    /** \brief The triangles of part \a part are [triangle_begin, triangle_end) */
+    int triangle_begin(int part) const { return triangle_offsets_[part]; }
+    int triangle_end(int part) const { return triangle_offsets_[part + 1]; }
+
+    const std::vector<float>& vertex_buffer() const { return vertices_; }
+    const std::vector<std::uint32_t>& index_buffer() const { return indices_; }
+
+    Eigen::Map<const Eigen::Vector3f> vertex(int index) const
+    {
+        return Eigen::Map<const Eigen::Vector3f>(&vertices_[3 * index]);
+    }
+
+    /** \return the three vertex indices of the triangle */
+    const std::uint32_t* triangle(int index) const
+    {
+        return &indices_[3 * index];
+    }
+
+private:
+    template <typename Vertex>
+    void flatten(const std::vector<std::vector<Vertex>>& vertices,
+                 const std::vector<std::vector<std::vector<int>>>& indices);
+
+private:
+    std::vector<float> vertices_;
+    std::vector<std::uint32_t> indices_;
+    std::vector<int> vertex_offsets_;
+    std::vector<int> triangle_offsets_;
+};
+}
@@ -0,0 +1,72 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flat_mesh_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <dbot/flat_mesh.hpp>
+
+using dbot::FlatMesh;
+
+TEST(FlatMeshTests, indices_refer_to_the_whole_vertex_buffer)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+
+    vertices[0] = {Eigen::Vector3d(0, 0, 0),
+                   Eigen::Vector3d(1, 0, 0),
+                   Eigen::Vector3d(0, 1, 0)};
+    indices[0] = {{0, 1, 2}};
+
+    vertices[1] = {Eigen::Vector3d(0, 0, 1),
+                   Eigen::Vector3d(1, 0, 1),
+                   Eigen::Vector3d(0, 1, 1),
+                   Eigen::Vector3d(1, 1, 1)};
+    indices[1] = {{0, 1, 2}, {1, 3, 2}};
+
+    FlatMesh mesh(vertices, indices);
+
+    EXPECT_EQ(mesh.count_parts(), 2);
+    EXPECT_EQ(mesh.count_vertices(), 7);
+    EXPECT_EQ(mesh.count_triangles(), 3);
+    EXPECT_EQ(mesh.vertex_buffer().size(), 21u);
+    EXPECT_EQ(mesh.index_buffer().size(), 9u);
+
+    EXPECT_EQ(mesh.vertex_begin(1), 3);
+    EXPECT_EQ(mesh.vertex_end(1), 7);
+    EXPECT_EQ(mesh.triangle_begin(1), 1);
+    EXPECT_EQ(mesh.triangle_end(1), 3);
+
+    for (int part = 0; part < mesh.count_parts(); part++)
+    {
+        for (int t = mesh.triangle_begin(part); t < mesh.triangle_end(part);
+             t++)
+        {
+            const auto& triangle = indices[part][t - mesh.triangle_begin(part)];
+            for (int k = 0; k < 3; k++)
+            {
+                const Eigen::Vector3f vertex =
+                    mesh.vertex(mesh.triangle(t)[k]);
+                EXPECT_TRUE(vertex.isApprox(
+                    vertices[part][triangle[k]].cast<float>()));
+            }
+        }
+    }
+}
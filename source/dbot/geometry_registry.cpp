@@ -0,0 +1,257 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file geometry_registry.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cstring>
+
+#include <dbot/geometry_registry.hpp>
+
+namespace dbot
+{
+namespace
+{
+const std::uint64_t fnv_offset_basis = 14695981039346656037ull;
+const std::uint64_t fnv_prime = 1099511628211ull;
+
+void fnv1a(const void* data, size_t size, std::uint64_t& hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+}
+}
+
+GeometryRegistry& GeometryRegistry::instance()
+{
+    static GeometryRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<ObjectModel> GeometryRegistry::object_model(
+    const ObjectResourceIdentifier& ori,
+    bool center,
+    const std::function<std::shared_ptr<ObjectModel>()>& load)
+{
+    std::string key = center ? "centered" : "uncentered";
+    for (int i = 0; i < ori.count_meshes(); i++)
+    {
+        key += "\n" + ori.mesh_path(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto object_model = find(object_models_, key);
+        if (object_model) return object_model;
+    }
+
+    // loading takes long, the other entries stay accessible meanwhile
+    auto object_model = load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insert(object_models_, key, object_model, object_model);
+}
+
+std::shared_ptr<const FlatMesh> GeometryRegistry::flat_mesh(
+    const std::shared_ptr<const FlatMesh>& mesh)
+{
+    if (!mesh) return mesh;
+
+    const std::uint64_t mesh_hash = hash(*mesh);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = meshes_.equal_range(mesh_hash);
+    for (auto it = range.first; it != range.second;)
+    {
+        auto registered = it->second.lock();
+        if (!registered)
+        {
+            it = meshes_.erase(it);
+            continue;
+        }
+        if (registered == mesh || equal(*registered, *mesh)) return registered;
+        ++it;
+    }
+
+    // the expired meshes of other hashes are removed along the way
+    for (auto it = meshes_.begin(); it != meshes_.end();)
+    {
+        it = it->second.expired() ? meshes_.erase(it) : std::next(it);
+    }
+    meshes_.insert(std::make_pair(mesh_hash, mesh));
+
+    return mesh;
+}
+
+std::shared_ptr<const FlatMesh> GeometryRegistry::flat_mesh(
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    return flat_mesh(std::make_shared<FlatMesh>(vertices, indices));
+}
+
+auto GeometryRegistry::normals(const std::shared_ptr<const FlatMesh>& mesh,
+                               const std::function<void(Normals&)>& compute)
+    -> std::shared_ptr<const Normals>
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto normals = find(normals_, mesh.get());
+        if (normals) return normals;
+    }
+
+    auto normals = std::make_shared<Normals>();
+    compute(*normals);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insert(normals_,
+                  mesh.get(),
+                  std::shared_ptr<const Normals>(normals),
+                  mesh);
+}
+
+std::shared_ptr<const MeshLevels> GeometryRegistry::mesh_levels(
+    const ObjectModel& model,
+    int level_count)
+{
+    const std::shared_ptr<const FlatMesh>& mesh = model.flat_mesh();
+    const auto key = std::make_pair(mesh.get(), level_count);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto levels = find(mesh_levels_, key);
+        if (levels) return levels;
+    }
+
+    std::shared_ptr<const MeshLevels> levels = std::make_shared<MeshLevels>(
+        model.vertices(), model.triangle_indices(), level_count);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insert(mesh_levels_, key, levels, mesh);
+}
+
+int GeometryRegistry::count_object_models() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int count = 0;
+    for (const auto& entry : object_models_)
+    {
+        if (!entry.second.expired()) count++;
+    }
+    return count;
+}
+
+int GeometryRegistry::count_meshes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int count = 0;
+    for (const auto& entry : meshes_)
+    {
+        if (!entry.second.expired()) count++;
+    }
+    return count;
+}
+
+std::uint64_t GeometryRegistry::hash(const FlatMesh& mesh)
+{
+    std::uint64_t hash = fnv_offset_basis;
+
+    const int part_count = mesh.count_parts();
+    fnv1a(&part_count, sizeof(part_count), hash);
+    for (int part = 0; part < part_count; part++)
+    {
+        const int offsets[2] = {mesh.vertex_end(part), mesh.triangle_end(part)};
+        fnv1a(offsets, sizeof(offsets), hash);
+    }
+
+    const auto& vertices = mesh.vertex_buffer();
+    const auto& indices = mesh.index_buffer();
+    fnv1a(vertices.data(), vertices.size() * sizeof(float), hash);
+    fnv1a(indices.data(), indices.size() * sizeof(std::uint32_t), hash);
+
+    return hash;
+}
+
+bool GeometryRegistry::equal(const FlatMesh& a, const FlatMesh& b)
+{
+    if (a.count_parts() != b.count_parts()) return false;
+
+    for (int part = 0; part < a.count_parts(); part++)
+    {
+        if (a.vertex_end(part) != b.vertex_end(part) ||
+            a.triangle_end(part) != b.triangle_end(part))
+        {
+            return false;
+        }
+    }
+
+    // bitwise, NaN coordinates of equal meshes compare equal as well
+    const auto& va = a.vertex_buffer();
+    const auto& vb = b.vertex_buffer();
+    return va.size() == vb.size() &&
+           std::memcmp(va.data(), vb.data(), va.size() * sizeof(float)) == 0 &&
+           a.index_buffer() == b.index_buffer();
+}
+
+template <typename Key, typename Value>
+std::shared_ptr<Value> GeometryRegistry::find(
+    std::map<Key, Entry<Value>>& map,
+    const Key& key)
+{
+    auto it = map.find(key);
+    if (it == map.end() || it->second.expired()) return nullptr;
+
+    return it->second.value.lock();
+}
+
+template <typename Key, typename Value>
+std::shared_ptr<Value> GeometryRegistry::insert(
+    std::map<Key, Entry<Value>>& map,
+    const Key& key,
+    const std::shared_ptr<Value>& value,
+    const std::shared_ptr<const void>& anchor)
+{
+    // a value is not registered without its anchor, e.g. a model which
+    // failed to load or the levels of a model without mesh
+    if (!value || !anchor) return value;
+
+    auto registered = find(map, key);
+    if (registered) return registered;
+
+    prune(map);
+
+    Entry<Value>& entry = map[key];
+    entry.value = value;
+    entry.anchor = anchor;
+
+    return value;
+}
+
+template <typename Key, typename Value>
+void GeometryRegistry::prune(std::map<Key, Entry<Value>>& map)
+{
+    for (auto it = map.begin(); it != map.end();)
+    {
+        it = it->second.expired() ? map.erase(it) : std::next(it);
+    }
+}
+}
@@ -0,0 +1,151 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file geometry_registry.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/flat_mesh.hpp>
+#include <dbot/mesh_levels.hpp>
+#include <dbot/object_model.hpp>
+#include <dbot/object_resource_identifier.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Process-wide registry of the geometry derived from the object
+ *        meshes, shared by trackers of copies of the same object.
+ *
+ * The registry only keeps weak references. Every entry lives as long as a
+ * tracker holds it and is created again once all of them are gone. Entries
+ * are immutable after their creation, hence the trackers may use them
+ * concurrently. All functions are thread safe. The creation of an entry runs
+ * without holding the lock, two threads creating the same entry both create
+ * it and the first one registered is returned to both.
+ */
+class GeometryRegistry
+{
+public:
+    typedef std::vector<Eigen::Vector3d> Normals;
+
+public:
+    /** \return the registry shared by all trackers of the process */
+    static GeometryRegistry& instance();
+
+    /**
+     * \return the object model of the meshes of \a ori, which is loaded by
+     *         \a load unless a model of the same meshes and centering is
+     *         alive. The model must not be reloaded.
+     */
+    std::shared_ptr<ObjectModel> object_model(
+        const ObjectResourceIdentifier& ori,
+        bool center,
+        const std::function<std::shared_ptr<ObjectModel>()>& load);
+
+    /**
+     * \return a registered mesh of the same content as \a mesh, or \a mesh
+     *         itself, which is registered then
+     */
+    std::shared_ptr<const FlatMesh> flat_mesh(
+        const std::shared_ptr<const FlatMesh>& mesh);
+
+    /** \brief Flattens the mesh and shares it, see flat_mesh() above */
+    std::shared_ptr<const FlatMesh> flat_mesh(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices);
+
+    /**
+     * \return the triangle normals of \a mesh, which are computed by
+     *         \a compute unless they are alive
+     */
+    std::shared_ptr<const Normals> normals(
+        const std::shared_ptr<const FlatMesh>& mesh,
+        const std::function<void(Normals&)>& compute);
+
+    /**
+     * \return the levels of detail of \a model with at most \a level_count
+     *         levels, see MeshLevels
+     */
+    std::shared_ptr<const MeshLevels> mesh_levels(const ObjectModel& model,
+                                                  int level_count);
+
+    /** \return the number of alive object models and meshes */
+    int count_object_models() const;
+    int count_meshes() const;
+
+    /** \return the 64 bit FNV-1a hash of the buffers and parts of \a mesh */
+    static std::uint64_t hash(const FlatMesh& mesh);
+
+    /** \return whether both meshes have the same buffers and parts */
+    static bool equal(const FlatMesh& a, const FlatMesh& b);
+
+private:
+    GeometryRegistry() = default;
+
+    /**
+     * \brief An entry of a registered value, which expires with its anchor
+     *        if the key refers to the anchor by address
+     */
+    template <typename Value>
+    struct Entry
+    {
+        std::weak_ptr<Value> value;
+        std::weak_ptr<const void> anchor;
+
+        bool expired() const { return value.expired() || anchor.expired(); }
+    };
+
+    /** \return the value of the key if it is alive, null otherwise */
+    template <typename Key, typename Value>
+    std::shared_ptr<Value> find(std::map<Key, Entry<Value>>& map,
+                                const Key& key);
+
+    /**
+     * \return the value registered for the key, which is \a value unless
+     *         another thread registered one in the meantime
+     */
+    template <typename Key, typename Value>
+    std::shared_ptr<Value> insert(std::map<Key, Entry<Value>>& map,
+                                  const Key& key,
+                                  const std::shared_ptr<Value>& value,
+                                  const std::shared_ptr<const void>& anchor);
+
+    /** \brief Removes the expired entries */
+    template <typename Key, typename Value>
+    static void prune(std::map<Key, Entry<Value>>& map);
+
+private:
+    mutable std::mutex mutex_;
+
+    std::map<std::string, Entry<ObjectModel>> object_models_;
+    std::multimap<std::uint64_t, std::weak_ptr<const FlatMesh>> meshes_;
+    std::map<const FlatMesh*, Entry<const Normals>> normals_;
+    std::map<std::pair<const FlatMesh*, int>, Entry<const MeshLevels>>
+        mesh_levels_;
+};
+}
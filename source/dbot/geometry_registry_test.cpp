@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file geometry_registry_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <dbot/geometry_registry.hpp>
+
+using dbot::FlatMesh;
+using dbot::GeometryRegistry;
+using dbot::ObjectModel;
+
+class TriangleLoader : public dbot::ObjectModelLoader
+{
+public:
+    explicit TriangleLoader(double z) : z_(z) {}
+
+    void load(std::vector<std::vector<Eigen::Vector3d>>& vertices,
+              std::vector<std::vector<std::vector<int>>>& indices) const
+    {
+        vertices.assign(1,
+                        {Eigen::Vector3d(0, 0, z_),
+                         Eigen::Vector3d(1, 0, z_),
+                         Eigen::Vector3d(0, 1, z_)});
+        indices.assign(1, {{0, 1, 2}});
+    }
+
+private:
+    double z_;
+};
+
+static std::shared_ptr<FlatMesh> make_triangle(double z)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices;
+    std::vector<std::vector<std::vector<int>>> indices;
+    TriangleLoader(z).load(vertices, indices);
+
+    return std::make_shared<FlatMesh>(vertices, indices);
+}
+
+TEST(GeometryRegistryTests, meshes_of_equal_content_are_shared)
+{
+    auto& registry = GeometryRegistry::instance();
+
+    auto mesh = registry.flat_mesh(make_triangle(1));
+    auto copy = registry.flat_mesh(make_triangle(1));
+    auto other = registry.flat_mesh(make_triangle(2));
+
+    EXPECT_EQ(mesh, copy);
+    EXPECT_NE(mesh, other);
+    EXPECT_TRUE(GeometryRegistry::equal(*mesh, *make_triangle(1)));
+    EXPECT_EQ(GeometryRegistry::hash(*mesh),
+              GeometryRegistry::hash(*make_triangle(1)));
+}
+
+TEST(GeometryRegistryTests, entries_expire_with_their_last_user)
+{
+    auto& registry = GeometryRegistry::instance();
+    const int count = registry.count_meshes();
+
+    auto mesh = registry.flat_mesh(make_triangle(3));
+    EXPECT_EQ(registry.count_meshes(), count + 1);
+
+    mesh.reset();
+    EXPECT_EQ(registry.count_meshes(), count);
+
+    // the next mesh of the same content takes the place of the expired one
+    auto fresh = make_triangle(3);
+    EXPECT_EQ(registry.flat_mesh(fresh), fresh);
+    EXPECT_EQ(registry.count_meshes(), count + 1);
+}
+
+TEST(GeometryRegistryTests, normals_are_computed_once_per_mesh)
+{
+    auto& registry = GeometryRegistry::instance();
+    auto mesh = registry.flat_mesh(make_triangle(4));
+
+    int computations = 0;
+    auto compute = [&](GeometryRegistry::Normals& normals)
+    {
+        computations++;
+        normals.assign(1, Eigen::Vector3d::UnitZ());
+    };
+
+    auto normals = registry.normals(mesh, compute);
+    auto shared = registry.normals(mesh, compute);
+    EXPECT_EQ(normals, shared);
+    EXPECT_EQ(computations, 1);
+
+    normals.reset();
+    shared.reset();
+    registry.normals(mesh, compute);
+    EXPECT_EQ(computations, 2);
+}
+
+TEST(GeometryRegistryTests, object_models_are_loaded_once)
+{
+    auto& registry = GeometryRegistry::instance();
+    dbot::ObjectResourceIdentifier ori("/objects", "triangle", {"a.obj"});
+
+    int loads = 0;
+    auto load = [&]()
+    {
+        loads++;
+        return std::make_shared<ObjectModel>(
+            std::make_shared<TriangleLoader>(5), true);
+    };
+
+    auto model = registry.object_model(ori, true, load);
+    auto copy = registry.object_model(ori, true, load);
+    auto uncentered = registry.object_model(ori, false, load);
+
+    EXPECT_EQ(model, copy);
+    EXPECT_NE(model, uncentered);
+    EXPECT_EQ(loads, 2);
+
+    // equal meshes are shared across models as well
+    EXPECT_EQ(model->flat_mesh(), registry.flat_mesh(model->flat_mesh()));
+
+    auto levels = registry.mesh_levels(*model, 2);
+    EXPECT_EQ(levels, registry.mesh_levels(*copy, 2));
+    EXPECT_NE(levels, registry.mesh_levels(*model, 3));
+}
@@ -0,0 +1,382 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_evaluation_service.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <dbot/gpu/batch_evaluation_service.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+namespace dbot
+{
+BatchEvaluationService::BatchEvaluationService(
+    const float camera_matrix[9],
+    const int nr_rows,
+    const int nr_cols,
+    const float initial_occlusion_prob,
+    const float p_occluded_visible,
+    const float p_occluded_occluded,
+    const float tail_weight,
+    const float model_sigma,
+    const float sigma_factor,
+    const float max_depth,
+    const float exponential_rate)
+    : nr_rows_(nr_rows),
+      nr_cols_(nr_cols),
+      initial_occlusion_prob_(initial_occlusion_prob),
+      p_occluded_visible_(p_occluded_visible),
+      p_occluded_occluded_(p_occluded_occluded),
+      tail_weight_(tail_weight),
+      model_sigma_(model_sigma),
+      sigma_factor_(sigma_factor),
+      max_depth_(max_depth),
+      exponential_rate_(exponential_rate),
+      round_(0),
+      nr_objects_(0),
+      nr_slots_(0),
+      configured_(false),
+      observations_changed_(false)
+{
+    std::copy(camera_matrix, camera_matrix + 9, camera_matrix_);
+}
+
+BatchEvaluationService::~BatchEvaluationService()
+{
+    rasterizer_.reset();
+    evaluator_.reset();
+}
+
+int BatchEvaluationService::add_client(
+    const std::vector<std::vector<float>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices,
+    const int max_nr_poses)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Client client;
+    client.active = true;
+    client.vertices = vertices;
+    client.indices = indices;
+    client.first_object = 0;
+    client.observation_index = 0;
+    client.max_nr_poses = max_nr_poses;
+    client.first_slot = 0;
+    client.observation_time = 0;
+    client.occlusion_time = 0;
+    client.observation_set = false;
+    client.submitted = false;
+    clients_.push_back(client);
+
+    configured_ = false;
+
+    return clients_.size() - 1;
+}
+
+void BatchEvaluationService::remove_client(const int client)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    clients_[client].active = false;
+    clients_[client].submitted = false;
+    configured_ = false;
+
+    // the remaining clients may have been waiting for this one
+    bool any_submitted = false;
+    for (const auto& c : clients_) any_submitted |= c.submitted;
+
+    if (any_submitted && round_complete())
+    {
+        run_round();
+        ++round_;
+        round_done_.notify_all();
+    }
+}
+
+void BatchEvaluationService::set_observation(const int client,
+                                             const float* observation,
+                                             const double observation_time)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Client& c = clients_[client];
+    c.observation.assign(observation, observation + nr_rows_ * nr_cols_);
+    c.observation_time = observation_time;
+    c.observation_set = true;
+    observations_changed_ = true;
+}
+
+void BatchEvaluationService::reset(const int client)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Client& c = clients_[client];
+    c.occlusion_time = 0;
+
+    // an unconfigured service initializes all occlusions on the next round
+    if (!configured_) return;
+
+    const int array_size = nr_rows_ * nr_cols_ * c.max_nr_poses;
+    std::vector<float> occlusion_probabilities(array_size,
+                                               initial_occlusion_prob_);
+
+    cudaSetDevice(evaluator_->device());
+    evaluator_->set_occlusion_probabilities(
+        occlusion_probabilities.data(), array_size, c.first_slot);
+}
+
+void BatchEvaluationService::evaluate(const int client,
+                                      const std::vector<float>& default_poses,
+                                      const float* deltas,
+                                      const int* occlusion_indices,
+                                      const int nr_poses,
+                                      const bool update_occlusions,
+                                      float* log_likelihoods)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Client& c = clients_[client];
+    if (!c.active || !c.observation_set)
+    {
+        std::cout << "CUDA: observations of client " << client << " not set"
+                  << std::endl;
+        exit(-1);
+    }
+    if (nr_poses > c.max_nr_poses)
+    {
+        std::cout << "CUDA: " << nr_poses << " poses exceed the maximum of "
+                  << c.max_nr_poses << " poses of client " << client
+                  << std::endl;
+        exit(-1);
+    }
+
+    c.default_poses = &default_poses;
+    c.deltas = deltas;
+    c.occlusion_indices = occlusion_indices;
+    c.nr_poses = nr_poses;
+    c.update_occlusions = update_occlusions;
+    c.log_likelihoods = log_likelihoods;
+    c.submitted = true;
+
+    const unsigned long round = round_;
+    if (round_complete())
+    {
+        run_round();
+        ++round_;
+        round_done_.notify_all();
+    }
+    else
+    {
+        round_done_.wait(lock, [&] { return round_ != round; });
+    }
+}
+
+int BatchEvaluationService::client_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int count = 0;
+    for (const auto& c : clients_) count += c.active;
+    return count;
+}
+
+bool BatchEvaluationService::round_complete() const
+{
+    for (const auto& c : clients_)
+    {
+        if (c.active && !c.submitted) return false;
+    }
+    return true;
+}
+
+void BatchEvaluationService::configure()
+{
+    // the memory of the previous clients is released before allocating anew
+    rasterizer_.reset();
+    evaluator_.reset();
+
+    std::vector<std::vector<float>> vertices;
+    std::vector<std::vector<std::vector<int>>> indices;
+    int nr_observations = 0;
+
+    nr_objects_ = 0;
+    nr_slots_ = 0;
+    for (auto& c : clients_)
+    {
+        if (!c.active) continue;
+
+        c.first_object = nr_objects_;
+        c.first_slot = nr_slots_;
+        c.observation_index = nr_observations++;
+        c.occlusion_time = 0;
+
+        vertices.insert(vertices.end(), c.vertices.begin(), c.vertices.end());
+        indices.insert(indices.end(), c.indices.begin(), c.indices.end());
+        nr_objects_ += c.vertices.size();
+        nr_slots_ += c.max_nr_poses;
+    }
+
+    evaluator_ = std::make_shared<CudaEvaluator>(nr_rows_, nr_cols_);
+    evaluator_->init(initial_occlusion_prob_,
+                     p_occluded_occluded_,
+                     p_occluded_visible_,
+                     tail_weight_,
+                     model_sigma_,
+                     sigma_factor_,
+                     max_depth_,
+                     exponential_rate_);
+    evaluator_->set_max_nr_observations(nr_observations);
+
+    // without a texture the poses only have to fit into the grid
+    const int max_grid_width =
+        evaluator_->get_device_properties().maxGridSize[0];
+    const int nr_poses_per_row =
+        std::max(1, std::min(nr_slots_, max_grid_width));
+    const int nr_poses_per_column =
+        (nr_slots_ + nr_poses_per_row - 1) / nr_poses_per_row;
+    evaluator_->allocate_memory_for_max_poses(
+        nr_slots_, nr_poses_per_row, nr_poses_per_column);
+
+    rasterizer_ = std::make_shared<CudaRasterizer>(
+        vertices, indices, camera_matrix_, nr_rows_, nr_cols_, 0.4, 4);
+    rasterizer_->allocate_memory_for_max_poses(nr_slots_);
+
+    observations_.assign(nr_observations * nr_rows_ * nr_cols_, 0);
+    observations_changed_ = true;
+    configured_ = true;
+}
+
+void BatchEvaluationService::run_round()
+{
+    if (!configured_) configure();
+
+    cudaSetDevice(evaluator_->device());
+
+    const int nr_pixels = nr_rows_ * nr_cols_;
+
+    int nr_poses = 0;
+    bool any_update = false;
+    for (const auto& c : clients_)
+    {
+        if (!c.active) continue;
+        nr_poses += c.nr_poses;
+        any_update |= c.update_occlusions;
+    }
+
+    // the poses of a client render only its own objects, the other objects
+    // keep a zero delta
+    default_poses_.assign(nr_objects_ * 12, 0);
+    deltas_.assign(nr_poses * nr_objects_ * 12, 0);
+    occlusion_indices_.resize(nr_poses);
+    object_ranges_.resize(nr_poses);
+    pose_parameters_.resize(nr_poses);
+
+    int first_pose = 0;
+    for (auto& c : clients_)
+    {
+        if (!c.active) continue;
+
+        const int nr_client_floats = c.vertices.size() * 12;
+        std::copy(c.default_poses->begin(),
+                  c.default_poses->begin() + nr_client_floats,
+                  &default_poses_[c.first_object * 12]);
+
+        if (c.observation_set)
+        {
+            std::copy(c.observation.begin(),
+                      c.observation.end(),
+                      &observations_[c.observation_index * nr_pixels]);
+        }
+
+        CudaRasterizer::ObjectRange objects;
+        objects.first = c.first_object;
+        objects.count = c.vertices.size();
+
+        CudaEvaluator::PoseParameters parameters;
+        parameters.observation = c.observation_index;
+        evaluator_->get_occlusion_transition(c.observation_time -
+                                                 c.occlusion_time,
+                                             parameters.occlusion_scale,
+                                             parameters.occlusion_offset);
+        if (c.update_occlusions) c.occlusion_time = c.observation_time;
+
+        for (int i = 0; i < c.nr_poses; ++i)
+        {
+            const int pose = first_pose + i;
+
+            std::copy(c.deltas + i * nr_client_floats,
+                      c.deltas + (i + 1) * nr_client_floats,
+                      &deltas_[(pose * nr_objects_ + c.first_object) * 12]);
+
+            occlusion_indices_[pose] = c.first_slot + c.occlusion_indices[i];
+            object_ranges_[pose] = objects;
+            parameters.occlusion_slot = c.first_slot + i;
+            pose_parameters_[pose] = parameters;
+        }
+
+        first_pose += c.nr_poses;
+    }
+
+    if (observations_changed_)
+    {
+        evaluator_->set_observations(
+            observations_.data(), 0, observations_.size() / nr_pixels);
+        observations_changed_ = false;
+    }
+
+    log_likelihoods_.assign(nr_poses, 0);
+    if (nr_poses > 0)
+    {
+        rasterizer_->render(default_poses_,
+                            deltas_.data(),
+                            nr_poses,
+                            evaluator_->stream(),
+                            object_ranges_.data());
+        evaluator_->set_depth_images(rasterizer_->get_depth_images());
+        evaluator_->set_number_of_poses(nr_poses);
+        evaluator_->set_occlusion_indices(occlusion_indices_.data(), nr_poses);
+        evaluator_->set_pose_parameters(pose_parameters_.data(), nr_poses);
+        evaluator_->weigh_poses_async(any_update);
+
+        // clients which did not update keep their previous occlusions
+        if (any_update)
+        {
+            for (const auto& c : clients_)
+            {
+                if (!c.active || c.update_occlusions) continue;
+                evaluator_->preserve_occlusion_probabilities(c.first_slot,
+                                                             c.max_nr_poses);
+            }
+        }
+
+        evaluator_->wait_for_log_likelihoods(log_likelihoods_);
+    }
+
+    first_pose = 0;
+    for (auto& c : clients_)
+    {
+        if (!c.active) continue;
+
+        std::copy(log_likelihoods_.begin() + first_pose,
+                  log_likelihoods_.begin() + first_pose + c.nr_poses,
+                  c.log_likelihoods);
+        first_pose += c.nr_poses;
+        c.submitted = false;
+    }
+}
+}
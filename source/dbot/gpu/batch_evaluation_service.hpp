@@ -0,0 +1,202 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_evaluation_service.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <condition_variable>
+
+#include <dbot/gpu/cuda_rasterizer.hpp>
+#include <dbot/gpu/cuda_likelihood_evaluator.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Evaluates the poses of several trackers on one GPU in a single
+ * render and weighting step per round.
+ *
+ * Each tracker registers as a client with its meshes and maximum number of
+ * poses. A call of evaluate() submits the poses of one client and blocks until
+ * every registered client has submitted its poses of the round. The last
+ * client to submit renders the poses of all clients with one CudaRasterizer,
+ * weighs them against the observation of their client with one CudaEvaluator
+ * launch and scatters the log likelihoods back.
+ *
+ * Every client has its own observation, occlusion slots and time since its
+ * last occlusion update. The rasterizer launches only the triangles of the
+ * client's own objects for its poses, hence a round costs the sum over the
+ * clients of their poses times their triangles. All
+ * clients share the camera and the sensor parameters. The CUDA constants of
+ * the sensor parameters are per device, hence only one service or model with
+ * a given sensor configuration may run per device.
+ *
+ * Clients have to evaluate from different threads. Adding or removing a client
+ * resets the occlusions of all clients.
+ */
+class BatchEvaluationService
+{
+public:
+    /**
+     * \brief constructor, see KinectImageModelGPU for the parameters
+     */
+    BatchEvaluationService(const float camera_matrix[9],
+                           const int nr_rows,
+                           const int nr_cols,
+                           const float initial_occlusion_prob = 0.1f,
+                           const float p_occluded_visible = 0.1f,
+                           const float p_occluded_occluded = 0.7f,
+                           const float tail_weight = 0.01f,
+                           const float model_sigma = 0.003f,
+                           const float sigma_factor = 0.0014247f,
+                           const float max_depth = 6.0f,
+                           const float exponential_rate = 0.693147f);
+
+    ~BatchEvaluationService();
+
+    /**
+     * \brief Registers a client
+     *
+     * \param [in] vertices [object_nr][3 * vertex_nr + 0 - 2] = {x, y, z}
+     * \param [in] indices [object_nr][triangle_nr][0 - 2] = {index}
+     * \param [in] max_nr_poses the maximum number of poses of one evaluation
+     * \return the id of the client
+     */
+    int add_client(const std::vector<std::vector<float>>& vertices,
+                   const std::vector<std::vector<std::vector<int>>>& indices,
+                   const int max_nr_poses);
+
+    /** \brief Unregisters a client, pending rounds no longer wait for it */
+    void remove_client(const int client);
+
+    /**
+     * \brief Sets the observation compared to the poses of the client in its
+     * next evaluations
+     *
+     * \param [in] client the id of the client
+     * \param [in] observation nr_rows x nr_cols depths in row major order
+     * \param [in] observation_time the time at which it was captured
+     */
+    void set_observation(const int client,
+                         const float* observation,
+                         const double observation_time);
+
+    /** \brief Resets the occlusions of the client to the initial ones */
+    void reset(const int client);
+
+    /**
+     * \brief Evaluates the poses of the client together with the poses of the
+     * other clients, see CudaRasterizer::render() and
+     * KinectImageModelGPU::loglikes()
+     *
+     * \param [in] client the id of the client
+     * \param [in] default_poses [object_nr][0 - 11] of the client's objects
+     * \param [in] deltas [pose_nr][object_nr][0 - 11] of the client's objects
+     * \param [in] occlusion_indices [pose_nr] = {occlusion slot of the client}
+     * \param [in] nr_poses the number of poses
+     * \param [in] update_occlusions whether the occlusions of the client are
+     * updated, which places the occlusions of pose i in slot i
+     * \param [out] log_likelihoods [pose_nr] = {log likelihood}
+     */
+    void evaluate(const int client,
+                  const std::vector<float>& default_poses,
+                  const float* deltas,
+                  const int* occlusion_indices,
+                  const int nr_poses,
+                  const bool update_occlusions,
+                  float* log_likelihoods);
+
+    /** \return the number of registered clients */
+    int client_count() const;
+
+private:
+    struct Client
+    {
+        bool active;
+
+        // meshes and their objects in the union of all meshes
+        std::vector<std::vector<float>> vertices;
+        std::vector<std::vector<std::vector<int>>> indices;
+        int first_object;
+
+        // occlusion slots [first_slot, first_slot + max_nr_poses)
+        int max_nr_poses;
+        int first_slot;
+
+        // observation image in the packed observations
+        std::vector<float> observation;
+        int observation_index;
+        bool observation_set;
+        double observation_time;
+        double occlusion_time;
+
+        // submission of the current round
+        bool submitted;
+        const std::vector<float>* default_poses;
+        const float* deltas;
+        const int* occlusion_indices;
+        int nr_poses;
+        bool update_occlusions;
+        float* log_likelihoods;
+    };
+
+    /** \brief Recreates the rasterizer and evaluator for the clients */
+    void configure();
+
+    /** \brief Evaluates the submissions of all active clients */
+    void run_round();
+
+    bool round_complete() const;
+
+    int nr_rows_;
+    int nr_cols_;
+    float camera_matrix_[9];
+    float initial_occlusion_prob_;
+    float p_occluded_visible_;
+    float p_occluded_occluded_;
+    float tail_weight_;
+    float model_sigma_;
+    float sigma_factor_;
+    float max_depth_;
+    float exponential_rate_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable round_done_;
+    unsigned long round_;
+
+    std::vector<Client> clients_;
+    int nr_objects_;
+    int nr_slots_;
+    bool configured_;
+    bool observations_changed_;
+
+    std::shared_ptr<CudaEvaluator> evaluator_;
+    std::shared_ptr<CudaRasterizer> rasterizer_;
+
+    // staging of the packed round
+    std::vector<float> default_poses_;
+    std::vector<float> deltas_;
+    std::vector<int> occlusion_indices_;
+    std::vector<CudaRasterizer::ObjectRange> object_ranges_;
+    std::vector<CudaEvaluator::PoseParameters> pose_parameters_;
+    std::vector<float> observations_;
+    std::vector<float> log_likelihoods_;
+};
+}
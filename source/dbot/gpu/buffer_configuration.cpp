@@ -34,7 +34,9 @@ BufferConfiguration::BufferConfiguration(boost::shared_ptr<ObjectRasterizer> ras
     evaluator_(evaluator),
     max_nr_poses_(max_nr_poses),
     nr_cols_(nr_cols),
-    nr_rows_(nr_rows)
+    nr_rows_(nr_rows),
+    tile_cols_(nr_cols),
+    tile_rows_(nr_rows)
 {
     max_texture_size_opengl_ = rasterizer_->get_max_texture_size();
     cuda_device_properties_ = evaluator_->get_device_properties();
@@ -59,13 +61,13 @@ bool BufferConfiguration::allocate_memory(const int max_nr_poses,
     if (constrained_by_texture_size) {
         if (adapt_to_constraints_) {
             issue_message(WARNING, "maximum number of poses (at resolution "
-                          + STR(nr_rows_) + " x " + STR(nr_cols_) + ")",
+                          + STR(tile_rows_) + " x " + STR(tile_cols_) + ")",
                           "maximum texture size", STR(max_nr_poses_),
                           STR(tmp_max_nr_poses_1));
             max_nr_poses_ = tmp_max_nr_poses_1;
         } else {
             issue_message(ERROR, "maximum number of poses (at resolution "
-                          + STR(nr_rows_) + " x " + STR(nr_cols_) + ")",
+                          + STR(tile_rows_) + " x " + STR(tile_cols_) + ")",
                         "maximum texture size", STR(max_nr_poses));
             return false;
         }
@@ -113,6 +115,8 @@ bool BufferConfiguration::set_resolution(const int nr_rows, const int nr_cols,
 
     nr_rows_ = nr_rows;
     nr_cols_ = nr_cols;
+    tile_rows_ = nr_rows;
+    tile_cols_ = nr_cols;
 
     evaluator_->set_resolution(nr_rows, nr_cols);
     rasterizer_->set_resolution(nr_rows, nr_cols);
@@ -123,6 +127,21 @@ bool BufferConfiguration::set_resolution(const int nr_rows, const int nr_cols,
     return successfully_allocated_memory;
 }
 
+bool BufferConfiguration::set_tile_resolution(const int nr_rows, const int nr_cols,
+                                              int& new_max_nr_poses) {
+
+    tile_rows_ = std::min(nr_rows, nr_rows_);
+    tile_cols_ = std::min(nr_cols, nr_cols_);
+
+    evaluator_->set_tile_resolution(tile_rows_, tile_cols_);
+    rasterizer_->set_resolution(tile_rows_, tile_cols_);
+
+    bool successfully_allocated_memory = allocate_memory(max_nr_poses_,
+                                                         new_max_nr_poses);
+
+    return successfully_allocated_memory;
+}
+
 
 bool BufferConfiguration::set_nr_of_poses(const int nr_poses,
                                           int& new_nr_poses) {
@@ -201,9 +220,9 @@ void BufferConfiguration::compute_grid_layout(const int nr_poses,
                                  cuda_device_properties_.maxTexture2D[1]),
                                  cuda_device_properties_.maxGridSize[1]);
 
-    nr_poses_per_row = floor(max_texture_size_x / nr_cols_);
-    nr_poses_per_col = std::min(floor(max_texture_size_y / nr_rows_),
-                           ceil(nr_poses / (float) nr_poses_per_row));
+    dbot::GpuMemoryPlanner::grid_layout(nr_poses, tile_rows_, tile_cols_,
+                                        max_texture_size_x, max_texture_size_y,
+                                        nr_poses_per_row, nr_poses_per_col);
 }
 
 
@@ -213,7 +232,9 @@ bool BufferConfiguration::check_against_global_memory_constraint(const int nr_po
                                                                  int& new_nr_poses_per_col) {
 
     int constant_need_rasterizer, per_pose_need_rasterizer;
-    rasterizer_->get_memory_need_parameters(nr_rows_, nr_cols_,
+    // the rasterizer only renders the tiles, whereas the occlusions are kept
+    // for the whole image
+    rasterizer_->get_memory_need_parameters(tile_rows_, tile_cols_,
                                             constant_need_rasterizer,
                                             per_pose_need_rasterizer);
 
@@ -251,6 +272,31 @@ bool BufferConfiguration::check_against_thread_constraint(const int nr_threads,
 
 
 
+dbot::GpuMemoryPlanner::Device BufferConfiguration::planner_device(
+    const int max_texture_size_opengl) {
+
+    int device;
+    cudaDeviceProp properties;
+    cudaGetDevice(&device);
+    cudaGetDeviceProperties(&properties, device);
+
+    size_t free_memory, total_memory;
+    cudaMemGetInfo(&free_memory, &total_memory);
+
+    dbot::GpuMemoryPlanner::Device planner_device;
+    planner_device.memory = free_memory;
+    planner_device.max_texture_width =
+        std::min(std::min(max_texture_size_opengl, properties.maxTexture2D[0]),
+                 properties.maxGridSize[0]);
+    planner_device.max_texture_height =
+        std::min(std::min(max_texture_size_opengl, properties.maxTexture2D[1]),
+                 properties.maxGridSize[1]);
+
+    return planner_device;
+}
+
+
+
 void BufferConfiguration::issue_message(const BufferConfiguration::message_type foo,
                                         const std::string problem_quantity,
                                         const std::string constraint,
@@ -23,6 +23,7 @@
 
 #include <dbot/gpu/object_rasterizer.hpp>
 #include <dbot/gpu/cuda_likelihood_evaluator.hpp>
+#include <dbot/gpu_memory_planner.hpp>
 #include "boost/shared_ptr.hpp"
 
 /**
@@ -75,6 +76,20 @@ public:
   bool set_resolution(const int nr_rows, const int nr_cols,
                        int& new_max_nr_poses);
 
+  /**
+   * \brief Set the size of the tiles the poses are rendered into. Tiles
+   * smaller than the resolution only cover a region of interest of the image,
+   * which fits more poses into the texture and reduces the fill rate. Setting
+   * the resolution resets the tiles to the full image.
+   * \param [in] nr_rows the number of rows of a tile
+   * \param [in] nr_cols the number of columns of a tile
+   * \param new_max_nr_poses [out] the reduced maximum number of poses, see
+   * set_resolution()
+   * \return whether resetting the tile resolution was successful or not
+   */
+  bool set_tile_resolution(const int nr_rows, const int nr_cols,
+                           int& new_max_nr_poses);
+
   /**
    * \brief Set the number of poses to be evaluated in the next frame
    * \param [in] nr_poses the number of poses that you want to evaluate in
@@ -106,6 +121,15 @@ public:
    */
   void set_adapt_to_constraints(bool should_adapt);
 
+  /**
+   * \brief The free memory and the texture limits of the current CUDA device
+   * for planning the poses of several models, see dbot::GpuMemoryPlanner.
+   * \param [in] max_texture_size_opengl the largest texture of OpenGL, see
+   * ObjectRasterizer::get_max_texture_size()
+   */
+  static dbot::GpuMemoryPlanner::Device planner_device(
+      const int max_texture_size_opengl);
+
 private:
 
   enum message_type {WARNING, ERROR};
@@ -137,6 +161,8 @@ private:
   int max_nr_poses_per_col_;
   int nr_cols_;
   int nr_rows_;
+  int tile_cols_;
+  int tile_rows_;
   int nr_threads_;
 
   bool adapt_to_constraints_;
@@ -32,6 +32,12 @@
 #define VECTOR_DIM 3
 #define MATRIX_DIM 9
 
+// rounds of pixels between the checks for hopeless poses, see evaluate_kernel
+#define REJECTION_INTERVAL 32
+
+// pixels per block whose covered pixels are compacted at a time, see evaluate_kernel
+#define COMPACTION_CAPACITY 2048
+
 #include <dbot/gpu/cuda_likelihood_evaluator.hpp>
 #include <GL/glut.h>
 #include <fl/util/profiling.hpp>
@@ -39,9 +45,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
+#include <algorithm>
 
 
 #include <cuda.h>
+#include <cuda_fp16.h>
 #include "cuda_gl_interop.h"
 #include <math.h>
 #include <math_constants.h>
@@ -52,12 +60,6 @@ using namespace std;
 // ====================== CUDA CONSTANT VALUES ======================= //
 
 
-// used in propagateOcclusion
-__constant__ float g_p_occluded_occluded;
-__constant__ float g_one_div_c_minus_one;
-__constant__ float g_log_c;
-
-
 // used in prob
 __constant__ float g_one_minus_tail_weight;
 __constant__ float g_model_sigma;
@@ -92,22 +94,48 @@ texture<float, cudaTextureType2D, cudaReadModeElementType> texture_reference;
 // ======================= helper functions for compare (observation model)  ======================= //
 
 
-__device__ float propagate_occlusion(float initial_p_source, float time) {
-    if (isnan(time)) {
-        return initial_p_source;
-    }
-    float pow_c_time = __expf(time * g_log_c);
-    return 1 - (pow_c_time * (1 - initial_p_source) + (1. - g_p_occluded_occluded) * (pow_c_time - 1.) * g_one_div_c_minus_one);
+// the occlusion process is affine in the occlusion probability for a given time delta, see
+// CudaEvaluator::weigh_poses() for the coefficients
+__device__ float propagate_occlusion(float initial_p_source, float scale, float offset) {
+    return scale * initial_p_source + offset;
+}
+
+
+
+// the occlusion probabilities in the storage formats of dbot::OcclusionPrecision, see
+// CudaEvaluator::set_occlusion_precision()
+__device__ float read_occlusion(const float* occlusion_probs, int index) {
+    return occlusion_probs[index];
 }
 
+__device__ float read_occlusion(const __half* occlusion_probs, int index) {
+    return __half2float(occlusion_probs[index]);
+}
+
+__device__ float read_occlusion(const unsigned char* occlusion_probs, int index) {
+    return dbot::decode_occlusion_logit8(occlusion_probs[index]);
+}
+
+__device__ void write_occlusion(float* occlusion_probs, int index, float value, float dither) {
+    occlusion_probs[index] = value;
+}
+
+__device__ void write_occlusion(__half* occlusion_probs, int index, float value, float dither) {
+    occlusion_probs[index] = __float2half_rn(value);
+}
+
+__device__ void write_occlusion(unsigned char* occlusion_probs, int index, float value, float dither) {
+    occlusion_probs[index] = dbot::encode_occlusion_logit8(value, dither);
+}
 
 
-__device__ float prob(float observation, float prediction, bool occluded)
+
+// sigma and its inverse only depend on the observation, see observation_terms_kernel
+__device__ float prob(float observation, float prediction, bool occluded, float sigma, float one_div_sigma)
 {
     // todo: if the prediction is infinite, the prob should not depend on occlusion. it does not matter
     // for the algorithm right now, but it should be changed
 
-    float sigma = g_model_sigma + g_sigma_factor * observation * observation;
     float sigma_sq = sigma * sigma;
 
     if(!occluded)
@@ -117,8 +145,8 @@ __device__ float prob(float observation, float prediction, bool occluded)
         else {
             float pred_minus_obs = prediction - observation;
             return g_tail_weight_div_max_depth
-                    + __fdividef(g_one_minus_tail_weight * __expf(- __fdividef(pred_minus_obs * pred_minus_obs, (2 * sigma_sq)))
-                    * g_one_div_sqrt_of_two_pi, sigma);
+                    + g_one_minus_tail_weight * __expf(- __fdividef(pred_minus_obs * pred_minus_obs, (2 * sigma_sq)))
+                    * g_one_div_sqrt_of_two_pi * one_div_sigma;
         }
     }
     else
@@ -132,7 +160,7 @@ __device__ float prob(float observation, float prediction, bool occluded)
             return g_tail_weight_div_max_depth +
                     g_one_minus_tail_weight * g_exponential_rate *
                     __expf(0.5 * g_exponential_rate * (2 * (prediction - observation) + g_exponential_rate * sigma_sq))
-                    * __fdividef((1 + erff(__fdividef((prediction - observation + g_exponential_rate * sigma_sq) * g_one_div_sqrt_of_two, sigma))),
+                    * __fdividef((1 + erff((prediction - observation + g_exponential_rate * sigma_sq) * g_one_div_sqrt_of_two * one_div_sigma)),
                     (2 * (__expf(prediction * g_exponential_rate) - 1)));
     }
 }
@@ -146,101 +174,337 @@ __device__ float prob(float observation, float prediction, bool occluded)
 
 
 
-__global__ void evaluate_kernel(float *observations, float* old_occlusion_probs, float* new_occlusion_probs, int* occlusion_image_indices, int nr_pixels,
-                                 float *d_log_likelihoods, float delta_time, int n_poses, int n_rows, int n_cols, bool update_occlusions) {
-    int block_id = blockIdx.x + blockIdx.y * gridDim.x;
-    if (block_id < n_poses) {
+// the reductions and the pixel compaction below use warp shuffles and votes, see DBOT_CUDA_ARCH
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ < 300
+#error "the likelihood kernels need compute capability 3.0 or newer"
+#endif
 
-        int pixel_nr = threadIdx.x;
+// sum over the 32 lanes of a warp, the result is returned to lane 0
+__device__ float warp_reduce_sum(float value) {
+    for (int offset = 16; offset > 0; offset /= 2) {
+#if CUDART_VERSION >= 9000
+        value += __shfl_down_sync(0xffffffff, value, offset);
+#else
+        value += __shfl_down(value, offset);
+#endif
+    }
+    return value;
+}
 
-        // OpenGL contructs the texture so that the left lower edge is (0,0), but our observations texture
-        // has its (0,0) in the upper left corner, so we need to reverse the reads from the OpenGL texture.
-        float texture_array_index_x = blockIdx.x * n_cols + pixel_nr % n_cols;
 
-        float texture_array_index_y = gridDim.y * n_rows - 1 - (blockIdx.y * n_rows + __fdividef(pixel_nr, n_cols));
 
-        float depth;
-        float observed_depth;
-        float occlusion_prob = g_initial_occlusion_prob;
-        float local_sum_of_likelihoods = 0;
-        float p_obsIpred_vis, p_obsIpred_occl, p_obsIinf;
+// sum over the threads of each pose of a block, the result is returned to the first thread of each
+// pose. blockDim.x has to be a multiple of the warp size such that no warp spans two poses. The
+// summation order is fixed, hence the result is deterministic.
+__device__ float pose_reduce_sum(float value) {
+    __shared__ float warp_sums[32];
 
-        __shared__ float log_likelihoods;
-        __shared__ int occlusion_image_index;
+    const int warps_per_pose = blockDim.x / 32;
+    const int lane = threadIdx.x % 32;
+    const int warp_in_pose = threadIdx.x / 32;
+    const int first_warp = threadIdx.y * warps_per_pose;
 
-        if (threadIdx.x == 0) {
-            log_likelihoods = 0;
-            occlusion_image_index = occlusion_image_indices[block_id];
-        }
+    value = warp_reduce_sum(value);
+    if (lane == 0) warp_sums[first_warp + warp_in_pose] = value;
 
-        __syncthreads();
+    __syncthreads();
 
-        float* occlusion_probs = old_occlusion_probs;
-        int occlusion_pixel_index= occlusion_image_index * nr_pixels + pixel_nr;
+    value = 0;
+    if (warp_in_pose == 0) {
+        if (lane < warps_per_pose) value = warp_sums[first_warp + lane];
+        value = warp_reduce_sum(value);
+    }
 
-        if (update_occlusions) {
-            // copy occlusion probabilities from the old particles
-            int index_from_occlusion = occlusion_image_indices[block_id] * nr_pixels;
-            int index_to_occlusion = block_id * nr_pixels;
+    return value;
+}
 
-            while (pixel_nr < nr_pixels) {
-                new_occlusion_probs[index_to_occlusion + pixel_nr] = old_occlusion_probs[index_from_occlusion + pixel_nr];
-                pixel_nr += blockDim.x;
-            }
 
-            // change occlusion prob array to the new one and change the global index
-            occlusion_probs = new_occlusion_probs;
-            // reset pixel_nr for following loop
-            pixel_nr = threadIdx.x;
 
-            occlusion_pixel_index= block_id * nr_pixels + pixel_nr;
-        }
+// floats mapped to unsigned ints of the same order, such that the best log likelihood can be found
+// with atomicMax. The key 0 is below all floats and decodes into NaN.
+__device__ unsigned int order_preserving_key(float value) {
+    unsigned int bits = __float_as_uint(value);
+    return (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+}
+
+__device__ float from_order_preserving_key(unsigned int key) {
+    return __uint_as_float((key & 0x80000000) ? key & 0x7fffffff : ~key);
+}
+
 
 
-        while (pixel_nr < nr_pixels ) {
+// Per pixel of nr_observations images the terms of the pixel model which only depend on the observed
+// depth y, {y, sigma, 1 / sigma, log p(y | no intersection)}, and the bitset of the valid depths, one
+// word per 32 pixels. Each warp covers the 32 pixels of a word, the blocks consist of whole warps.
+__global__ void observation_terms_kernel(const float* observations, float4* observation_terms,
+                                         unsigned int* observation_masks, int nr_pixels, int nr_words,
+                                         int nr_observations) {
+    int index = blockIdx.x * blockDim.x + threadIdx.x;
+    int observation = index / (nr_words * 32);
+    int pixel_nr = index % (nr_words * 32);
 
-            depth = tex2D(texture_reference, texture_array_index_x, texture_array_index_y);
-            observed_depth = observations[pixel_nr];
+    bool valid = false;
+    if (observation < nr_observations && pixel_nr < nr_pixels) {
+        int offset = observation * nr_pixels + pixel_nr;
+        float observed_depth = observations[offset];
+        valid = !isnan(observed_depth);
 
-            occlusion_prob = propagate_occlusion(occlusion_probs[occlusion_pixel_index], delta_time);
-            if (update_occlusions) occlusion_probs[occlusion_pixel_index] = occlusion_prob;
+        float sigma = g_model_sigma + g_sigma_factor * observed_depth * observed_depth;
+        float one_div_sigma = __fdividef(1.0f, sigma);
+        float p_obsIinf = prob(observed_depth, CUDART_INF_F, true, sigma, one_div_sigma);
+        observation_terms[offset] = make_float4(observed_depth, sigma, one_div_sigma, __logf(p_obsIinf));
+    }
+
+#if CUDART_VERSION >= 9000
+    unsigned int mask = __ballot_sync(0xffffffff, valid);
+#else
+    unsigned int mask = __ballot(valid);
+#endif
+    if (threadIdx.x % 32 == 0 && observation < nr_observations) {
+        observation_masks[observation * nr_words + pixel_nr / 32] = mask;
+    }
+}
+
+
+
+// log likelihood ratio of a covered pixel w.r.t. the prob of observation given no intersection and its
+// occlusion probability given the observation, whose terms are precomputed by observation_terms_kernel
+__device__ float pixel_log_likelihood(float4 observation_terms, float depth, float occlusion_prob,
+                                      const float* likelihood_table_data,
+                                      const dbot::KinectPixelTable& likelihood_table,
+                                      float& new_occlusion_prob) {
+    const float observed_depth = observation_terms.x;
+    float p_obsIpred_vis, p_obsIpred_occl;
+    float log_likelihood;
+
+    float visible_ratio, occluded_ratio;
+    if (likelihood_table_data != NULL &&
+        dbot::kinect_pixel_table_lookup(likelihood_table, likelihood_table_data, depth, observed_depth,
+                                        visible_ratio, occluded_ratio)) {
+        // tabulated likelihood ratios w.r.t. the prob of observation given no intersection
+        p_obsIpred_vis = visible_ratio * (1 - occlusion_prob);
+        p_obsIpred_occl = occluded_ratio * occlusion_prob;
 
+        log_likelihood = __logf(p_obsIpred_vis + p_obsIpred_occl);
+    } else {
+        const float sigma = observation_terms.y;
+        const float one_div_sigma = observation_terms.z;
+
+        // prob of observation given prediction, knowing that the object is not occluded
+        p_obsIpred_vis = prob(observed_depth, depth, false, sigma, one_div_sigma) * (1 - occlusion_prob);
+        // prob of observation given prediction, knowing that the object is occluded
+        p_obsIpred_occl = prob(observed_depth, depth, true, sigma, one_div_sigma) * occlusion_prob;
 
-            if (depth != 0 && !isnan(observed_depth)) {
+        // minus the log prob of observation given no intersection
+        log_likelihood = __logf(p_obsIpred_vis + p_obsIpred_occl) - observation_terms.w;
+    }
 
-                // prob of observation given prediction, knowing that the object is not occluded
-                p_obsIpred_vis = prob(observed_depth, depth, false) * (1 - occlusion_prob);
-                // prob of observation given prediction, knowing that the object is occluded
-                p_obsIpred_occl = prob(observed_depth, depth, true) * occlusion_prob;
-                // prob of observation given no intersection
-                p_obsIinf = prob(observed_depth, CUDART_INF_F, true);
+    // we update the occlusion probability with the observations
+    new_occlusion_prob = 1 - __fdividef(p_obsIpred_vis, (p_obsIpred_vis + p_obsIpred_occl));
+
+    return log_likelihood;
+}
 
-                local_sum_of_likelihoods += __logf(__fdividef((p_obsIpred_vis + p_obsIpred_occl), p_obsIinf));
 
 
-                if(update_occlusions) {
-                    // we update the occlusion probability with the observations
-                    occlusion_probs[occlusion_pixel_index] = 1 - __fdividef(p_obsIpred_vis, (p_obsIpred_vis + p_obsIpred_occl));
+// Each block evaluates blockDim.y poses with blockDim.x threads each. The poses are arranged in the
+// OpenGL texture in rows of n_poses_per_row tiles of n_tile_rows x n_tile_cols pixels, where the upper
+// left pixel of each tile is the image pixel (tile_row_offset, tile_col_offset). Image pixels outside
+// of the tiles are not covered by the object. Alternatively, depth_images provides the rendered depths
+// directly in device memory, [pose][pixel] in the layout of the observations. If pose_parameters is
+// given, every pose selects its observation image, occlusion slot and occlusion transition.
+//
+// The threads of a pose process the image in rounds of blockDim.x consecutive pixels. The rounds are
+// visited with a stride of round_step, which has to be coprime to their number. If best_log_likelihoods
+// is given, a pose is rejected once even max_log_ratio on each pixel it may still cover would leave it
+// more than rejection_margin below the best pose of its observation found so far. Its remaining pixels
+// are then skipped like pixels outside of the object and it receives this bound as log likelihood.
+//
+// The object typically covers a small part of the tile. The rounds are therefore taken in groups which
+// fit into COMPACTION_CAPACITY pixels per block. The threads first read the depths of a group and
+// compact the covered pixels with a valid observation into a list per pose in shared memory. The list
+// is in the order of the visited pixels, such that the results are deterministic. Then all threads of
+// the pose evaluate the listed pixels. The occlusions of the other pixels are only read if they are updated, which propagates them.
+//
+// The occlusion probabilities are stored as Occlusion, i.e. float, __half or the 8 bit logit codes, and
+// converted when they are read and written. The 8 bit codes are dithered with dither_seed.
+//
+// The observations are read as their precomputed terms and the validity of a pixel from the bitset of
+// its observation, see observation_terms_kernel.
+template <typename Occlusion>
+__global__ void evaluate_kernel(const float4* observation_terms, const unsigned int* observation_masks,
+                                 const unsigned char* old_occlusion_data,
+                                 unsigned char* new_occlusion_data, int* occlusion_image_indices, int nr_pixels,
+                                 float *d_log_likelihoods, float occlusion_scale, float occlusion_offset, int n_poses, int n_rows, int n_cols,
+                                 int n_tile_rows, int n_tile_cols, int tile_row_offset, int tile_col_offset,
+                                 int n_poses_per_row, int n_poses_per_column, bool update_occlusions,
+                                 const float* likelihood_table_data, const dbot::KinectPixelTable likelihood_table,
+                                 const float* depth_images, const CudaEvaluator::PoseParameters* pose_parameters,
+                                 int round_step, unsigned int* best_log_likelihoods, float rejection_margin,
+                                 float max_log_ratio, unsigned int dither_seed) {
+    // NaN, i.e. not rejected, or the bound of each pose of the block
+    __shared__ float rejection_bounds[32];
+
+    // covered pixels of the current group of rounds and their depths, consecutive per pose
+    __shared__ int active_pixels[COMPACTION_CAPACITY];
+    __shared__ float active_depths[COMPACTION_CAPACITY];
+
+    // number of covered pixels of each warp in the current round
+    __shared__ int warp_counts[32];
+
+    const Occlusion* old_occlusion_probs = (const Occlusion*) old_occlusion_data;
+    Occlusion* new_occlusion_probs = (Occlusion*) new_occlusion_data;
+
+    int block_id = blockIdx.x + blockIdx.y * gridDim.x;
+    int pose_id = block_id * blockDim.y + threadIdx.y;
+    bool valid_pose = pose_id < n_poses;
+
+    float local_sum_of_likelihoods = 0;
+
+    // pixels this thread visited which the object may cover
+    float local_candidates = 0;
+
+    if (threadIdx.x == 0) rejection_bounds[threadIdx.y] = CUDART_NAN_F;
+
+    // OpenGL contructs the texture so that the left lower edge is (0,0), but our observations texture
+    // has its (0,0) in the upper left corner, so we need to reverse the reads from the OpenGL texture.
+    int pose_x = (pose_id % n_poses_per_row) * n_tile_cols;
+    int pose_y = n_poses_per_column * n_tile_rows - 1 - (pose_id / n_poses_per_row) * n_tile_rows;
+
+    int observation = 0;
+    int occlusion_slot = pose_id;
+    if (valid_pose && pose_parameters != NULL) {
+        CudaEvaluator::PoseParameters parameters = pose_parameters[pose_id];
+        observation = parameters.observation;
+        observation_terms += parameters.observation * nr_pixels;
+        observation_masks += parameters.observation * ((nr_pixels + 31) / 32);
+        occlusion_slot = parameters.occlusion_slot;
+        occlusion_scale = parameters.occlusion_scale;
+        occlusion_offset = parameters.occlusion_offset;
+    }
+
+    const int occlusion_image = valid_pose ? occlusion_image_indices[pose_id] : 0;
+    const float candidate_count = depth_images != NULL ? nr_pixels : n_tile_rows * n_tile_cols;
+
+    const int warps_per_pose = blockDim.x / 32;
+    const int lane = threadIdx.x % 32;
+    const int warp_in_pose = threadIdx.x / 32;
+    const int first_warp = threadIdx.y * warps_per_pose;
+
+    const int rounds_per_group = max(1, COMPACTION_CAPACITY / int(blockDim.x * blockDim.y));
+    int* pose_pixels = active_pixels + threadIdx.y * rounds_per_group * blockDim.x;
+    float* pose_depths = active_depths + threadIdx.y * rounds_per_group * blockDim.x;
+
+    __syncthreads();
+
+    // the poses of a block take the same rounds and all threads take part in the reductions
+    const int nr_rounds = (nr_pixels + blockDim.x - 1) / blockDim.x;
+    for (int group = 0; group < nr_rounds; group += rounds_per_group) {
+
+        if (best_log_likelihoods != NULL && group > 0 &&
+            group / REJECTION_INTERVAL != (group - rounds_per_group) / REJECTION_INTERVAL) {
+            float sum = pose_reduce_sum(local_sum_of_likelihoods);
+            __syncthreads();
+            float candidates = pose_reduce_sum(local_candidates);
+
+            if (valid_pose && threadIdx.x == 0 && isnan(rejection_bounds[threadIdx.y])) {
+                float best = from_order_preserving_key(
+                    ((volatile unsigned int*) best_log_likelihoods)[observation]);
+                float bound = sum + (candidate_count - candidates) * max_log_ratio;
+                if (bound < best - rejection_margin) rejection_bounds[threadIdx.y] = bound;
+            }
+            __syncthreads();
+        }
+
+        bool rejected = !isnan(rejection_bounds[threadIdx.y]);
+
+        // compact the covered pixels of the group -------------------------------------------------
+        int nr_active = 0;
+        const int group_end = min(group + rounds_per_group, nr_rounds);
+        for (int round = group; round < group_end; round++) {
+            int pixel_nr = (round * round_step) % nr_rounds * blockDim.x + threadIdx.x;
+
+            float depth = 0;
+            bool active = false;
+            if (valid_pose && pixel_nr < nr_pixels) {
+                int tile_row = pixel_nr / n_cols - tile_row_offset;
+                int tile_col = pixel_nr % n_cols - tile_col_offset;
+
+                if (depth_images != NULL) {
+                    local_candidates += 1;
+                    if (!rejected) depth = depth_images[pose_id * nr_pixels + pixel_nr];
+                } else if (tile_row >= 0 && tile_row < n_tile_rows && tile_col >= 0 && tile_col < n_tile_cols) {
+                    local_candidates += 1;
+                    if (!rejected) depth = tex2D(texture_reference, pose_x + tile_col, pose_y - tile_row);
+                }
+                active = depth != 0 && (observation_masks[pixel_nr / 32] >> (pixel_nr % 32) & 1u);
+
+                // the occlusions of the ancestor are read through the occlusion index and, when
+                // updating, the results are written once into the other buffer of the ping-pong pair
+                if (!active && update_occlusions) {
+                    float occlusion_prob = propagate_occlusion(
+                        read_occlusion(old_occlusion_probs, occlusion_image * nr_pixels + pixel_nr),
+                        occlusion_scale, occlusion_offset);
+                    write_occlusion(new_occlusion_probs, occlusion_slot * nr_pixels + pixel_nr, occlusion_prob,
+                                    dbot::occlusion_dither(pixel_nr, dither_seed));
                 }
             }
 
-            pixel_nr += blockDim.x;
-            occlusion_pixel_index += blockDim.x;
-            texture_array_index_x = blockIdx.x * n_cols + pixel_nr % n_cols;
-            texture_array_index_y = gridDim.y * n_rows - (blockIdx.y * n_rows + (pixel_nr / n_cols) + 1);
+#if CUDART_VERSION >= 9000
+            unsigned int mask = __ballot_sync(0xffffffff, active);
+#else
+            unsigned int mask = __ballot(active);
+#endif
+            if (lane == 0) warp_counts[first_warp + warp_in_pose] = __popc(mask);
+            __syncthreads();
+
+            int index = nr_active + __popc(mask & ((1u << lane) - 1));
+            for (int warp = 0; warp < warps_per_pose; warp++) {
+                if (warp < warp_in_pose) index += warp_counts[first_warp + warp];
+                nr_active += warp_counts[first_warp + warp];
+            }
+            if (active) {
+                pose_pixels[index] = pixel_nr;
+                pose_depths[index] = depth;
+            }
+            __syncthreads();
         }
 
-        atomicAdd(&log_likelihoods, local_sum_of_likelihoods);
+        // evaluate them ----------------------------------------------------------------------------
+        for (int i = threadIdx.x; i < nr_active; i += blockDim.x) {
+            int pixel_nr = pose_pixels[i];
 
-        __syncthreads();
+            float occlusion_prob = propagate_occlusion(
+                read_occlusion(old_occlusion_probs, occlusion_image * nr_pixels + pixel_nr),
+                occlusion_scale, occlusion_offset);
 
-        if (threadIdx.x == 0) {
-            d_log_likelihoods[block_id] = log_likelihoods;
+            float new_occlusion_prob;
+            local_sum_of_likelihoods += pixel_log_likelihood(observation_terms[pixel_nr], pose_depths[i], occlusion_prob,
+                                                             likelihood_table_data, likelihood_table,
+                                                             new_occlusion_prob);
+
+            if (update_occlusions) {
+                write_occlusion(new_occlusion_probs, occlusion_slot * nr_pixels + pixel_nr, new_occlusion_prob,
+                                dbot::occlusion_dither(pixel_nr, dither_seed));
+            }
         }
-    } else {
+
+        // the lists are overwritten by the next group
         __syncthreads();
     }
 
+    // all threads of the block take part in the reduction, including those of missing poses
+    float log_likelihood = pose_reduce_sum(local_sum_of_likelihoods);
+
+    if (valid_pose && threadIdx.x == 0) {
+        float bound = rejection_bounds[threadIdx.y];
+        if (!isnan(bound)) {
+            log_likelihood = bound;
+        } else if (best_log_likelihoods != NULL) {
+            atomicMax(&best_log_likelihoods[observation], order_preserving_key(log_likelihood));
+        }
+        d_log_likelihoods[pose_id] = log_likelihood;
+    }
 }
 
 
@@ -256,22 +520,36 @@ __global__ void evaluate_kernel(float *observations, float* old_occlusion_probs,
 
 
 CudaEvaluator::CudaEvaluator(const int nr_rows,
-                       const int nr_cols) :
+                       const int nr_cols,
+                       const int device) :
 
     nr_rows_(nr_rows),
-    nr_cols_(nr_cols)
+    nr_cols_(nr_cols),
+    tile_rows_(nr_rows),
+    tile_cols_(nr_cols),
+    tile_row_offset_(0),
+    tile_col_offset_(0)
 {
 
     cudaDeviceProp  props;
     int device_number;
 
-    memset( &props, 0, sizeof( cudaDeviceProp ) );
-    props.major = 2;
-    props.minor = 0;
-    cudaChooseDevice( &device_number, &props );
-    #ifdef DEBUG
-        check_cuda_error("No device with compute capability > 2.0 found");
-    #endif
+    if (device >= 0) {
+        device_number = device;
+        cudaSetDevice(device_number);
+        #ifdef DEBUG
+            check_cuda_error("cudaSetDevice");
+        #endif
+    } else {
+        memset( &props, 0, sizeof( cudaDeviceProp ) );
+        props.major = 2;
+        props.minor = 0;
+        cudaChooseDevice( &device_number, &props );
+        #ifdef DEBUG
+            check_cuda_error("No device with compute capability > 2.0 found");
+        #endif
+    }
+    device_ = device_number;
 
     /* tell CUDA which device we will be using for graphic interop.
      * Requires that the CUDA device be specified by
@@ -282,7 +560,7 @@ CudaEvaluator::CudaEvaluator(const int nr_rows,
         check_cuda_error("cudaGLsetGLDevice");
     #endif
 
-    cudaGetDeviceProperties(&props, device_number);     // we will run the program only on one graphics card, the first one we can find = 0
+    cudaGetDeviceProperties(&props, device_number);
 
     cuda_device_properties_ = props;
 
@@ -300,8 +578,44 @@ CudaEvaluator::CudaEvaluator(const int nr_rows,
     d_occlusion_probs_ = NULL;
     d_occlusion_probs_copy_ = NULL;
     d_observations_ = NULL;
+    d_observation_terms_ = NULL;
+    d_observation_masks_ = NULL;
     d_log_likelihoods_ = NULL;
     d_occlusion_indices_ = NULL;
+    d_likelihood_table_ = NULL;
+    d_depth_images_ = NULL;
+
+    h_observations_ = NULL;
+    h_occlusion_indices_ = NULL;
+    h_log_likelihoods_ = NULL;
+    nr_weighted_poses_ = 0;
+
+    d_pose_parameters_ = NULL;
+    h_pose_parameters_ = NULL;
+    pose_parameters_set_ = false;
+    max_nr_observations_ = 1;
+
+    d_best_log_likelihoods_ = NULL;
+    rejection_margin_ = 0;
+    max_log_ratio_ = 0;
+
+    h_depth_readback_ = NULL;
+    h_occlusion_readback_ = NULL;
+    readback_pending_ = false;
+
+    occlusion_precision_ = dbot::OcclusionPrecision::Single;
+    occlusion_bytes_ = sizeof(float);
+    occlusion_seed_ = 0;
+
+    cudaStreamCreate(&stream_);
+    cudaEventCreateWithFlags(&observations_uploaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&occlusion_indices_uploaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&log_likelihoods_downloaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&readback_downloaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&pose_parameters_uploaded_, cudaEventDisableTiming);
+    #ifdef DEBUG
+        check_cuda_error("cudaStreamCreate / cudaEventCreate");
+    #endif
 
     set_nr_threads(DEFAULT_NR_THREADS);
 }
@@ -321,7 +635,11 @@ void CudaEvaluator::init(const float initial_occlusion_prob, const float p_occlu
     float one_div_c_minus_one = 1.0f / (c - 1.0f);
     float one_div_sqrt_of_two = 1.0f / sqrt(2);
     float one_div_sqrt_of_two_pi = 1.0f / sqrt(2 * M_PI);
-    float log_c = log(c);
+
+    // the occlusion transition coefficients are computed on the host once per weighting
+    p_occluded_occluded_ = p_occluded_occluded;
+    one_div_c_minus_one_ = one_div_c_minus_one;
+    log_c_ = log(c);
 
 
 
@@ -331,11 +649,6 @@ void CudaEvaluator::init(const float initial_occlusion_prob, const float p_occlu
         check_cuda_error("cudaMemcpyToSymbol initial_occlusion_prob -> g_initial_occlusion_prob");
     #endif
 
-    cudaMemcpyToSymbol(g_one_div_c_minus_one, &one_div_c_minus_one, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol one_div_c_minus_one -> g_one_div_c_minus_one");
-    #endif
-
     cudaMemcpyToSymbol(g_one_div_sqrt_of_two, &one_div_sqrt_of_two, sizeof(float), 0, cudaMemcpyHostToDevice);
     #ifdef DEBUG
         check_cuda_error("cudaMemcpyToSymbol one_div_sqrt_of_two -> g_one_div_sqrt_of_two");
@@ -346,16 +659,6 @@ void CudaEvaluator::init(const float initial_occlusion_prob, const float p_occlu
         check_cuda_error("cudaMemcpyToSymbol one_div_sqrt_of_two_pi -> g_one_div_sqrt_of_two_pi");
     #endif
 
-    cudaMemcpyToSymbol(g_log_c, &log_c, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol log_c -> g_log_c");
-    #endif
-
-    cudaMemcpyToSymbol(g_p_occluded_occluded, &p_occluded_occluded, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol p_occluded_occluded -> g_p_occluded_occluded");
-    #endif
-
     cudaMemcpyToSymbol(g_one_minus_tail_weight, &one_minus_tail_weight, sizeof(float), 0, cudaMemcpyHostToDevice);
     #ifdef DEBUG
         check_cuda_error("cudaMemcpyToSymbol one_minus_tail_weight -> g_one_minus_tail_weight");
@@ -390,6 +693,13 @@ void CudaEvaluator::init(const float initial_occlusion_prob, const float p_occlu
 
 
 void CudaEvaluator::weigh_poses(const bool update_occlusions, vector<float> &log_likelihoods) {
+    weigh_poses_async(update_occlusions);
+    wait_for_log_likelihoods(log_likelihoods);
+}
+
+
+
+void CudaEvaluator::weigh_poses_async(const bool update_occlusions) {
     if (observations_set_ && occlusion_indices_set_
             && memory_allocated_ && number_of_poses_set_ && constants_initialized_
             && texture_array_mapped_) {
@@ -397,37 +707,81 @@ void CudaEvaluator::weigh_poses(const bool update_occlusions, vector<float> &log
         double delta_time = observation_time_ - occlusion_time_;
         if(update_occlusions) occlusion_time_ = observation_time_;
 
+        // all pixels share the same time delta, hence the transition is computed once
+        float occlusion_scale, occlusion_offset;
+        get_occlusion_transition(delta_time, occlusion_scale, occlusion_offset);
 
-        evaluate_kernel <<< grid_dimension_, nr_threads_ >>> (d_observations_, d_occlusion_probs_, d_occlusion_probs_copy_, d_occlusion_indices_, nr_cols_ * nr_rows_,
-                                               d_log_likelihoods_, delta_time, nr_poses_, nr_rows_, nr_cols_, update_occlusions);
-        #ifdef DEBUG
-            check_cuda_error("compare kernel call");
-        #endif
 
-        cudaDeviceSynchronize();
+        // each pose gets a whole number of warps. Small images, which need fewer threads than
+        // configured, are evaluated with several poses per block.
+        int warp_size = cuda_device_properties_.warpSize;
+        int nr_pixels = nr_cols_ * nr_rows_;
+        int threads_per_pose = (min(nr_threads_, nr_pixels) + warp_size - 1) / warp_size * warp_size;
+        int poses_per_block = max(1, nr_threads_ / threads_per_pose);
+
+        dim3 grid_dimension = grid_dimension_;
+        if (poses_per_block > 1) {
+            int nr_blocks = (nr_poses_ + poses_per_block - 1) / poses_per_block;
+            int nr_blocks_per_row = min(nr_blocks, nr_poses_per_row_);
+            grid_dimension = dim3(nr_blocks_per_row, (nr_blocks + nr_blocks_per_row - 1) / nr_blocks_per_row);
+        }
+
+        // a bounded evaluation visits the rounds of pixels in a scattered order, such that the first
+        // rounds sample the whole object
+        int nr_rounds = (nr_pixels + threads_per_pose - 1) / threads_per_pose;
+        bool bounded = rejection_margin_ > 0;
+        int round_step = bounded ? coprime_step(nr_rounds) : 1;
+        if (bounded) {
+            cudaMemsetAsync(d_best_log_likelihoods_, 0, max_nr_observations_ * sizeof(unsigned int), stream_);
+            #ifdef DEBUG
+                check_cuda_error("cudaMemsetAsync d_best_log_likelihoods");
+            #endif
+        }
+
+        // all instances take the occlusion probabilities as bytes
+        auto kernel = &evaluate_kernel<float>;
+        if (occlusion_precision_ == dbot::OcclusionPrecision::Half) {
+            kernel = &evaluate_kernel<__half>;
+        } else if (occlusion_precision_ == dbot::OcclusionPrecision::Logit8) {
+            kernel = &evaluate_kernel<unsigned char>;
+        }
+
+        kernel <<< grid_dimension, dim3(threads_per_pose, poses_per_block), 0, stream_ >>> (
+                (const float4*) d_observation_terms_, d_observation_masks_,
+                d_occlusion_probs_, d_occlusion_probs_copy_, d_occlusion_indices_, nr_pixels,
+                d_log_likelihoods_, occlusion_scale, occlusion_offset, nr_poses_, nr_rows_, nr_cols_,
+                tile_rows_, tile_cols_, tile_row_offset_, tile_col_offset_,
+                nr_poses_per_row_, nr_poses_per_column_, update_occlusions,
+                d_likelihood_table_, likelihood_table_, d_depth_images_,
+                pose_parameters_set_ ? d_pose_parameters_ : NULL,
+                round_step, bounded ? d_best_log_likelihoods_ : NULL, rejection_margin_,
+                max_log_ratio_, occlusion_seed_);
         #ifdef DEBUG
-            check_cuda_error("cudaDeviceSynchronize compare_multiple");
+            check_cuda_error("compare kernel call");
         #endif
 
         // switch to new / copied occlusion probabilities
         if (update_occlusions) {
-            float *tmp_pointer;
+            unsigned char *tmp_pointer;
             tmp_pointer = d_occlusion_probs_;
             d_occlusion_probs_ = d_occlusion_probs_copy_;
             d_occlusion_probs_copy_ = tmp_pointer;
+            ++occlusion_seed_;
         }
 
 
-        cudaMemcpy(&log_likelihoods[0], d_log_likelihoods_, nr_poses_ * sizeof(float), cudaMemcpyDeviceToHost);
+        // the kernel is ordered before the readback on the stream, the
+        // staging buffer is not read by the host before the event completed
+        cudaMemcpyAsync(h_log_likelihoods_, d_log_likelihoods_, nr_poses_ * sizeof(float),
+                        cudaMemcpyDeviceToHost, stream_);
         #ifdef DEBUG
-            check_cuda_error("cudaMemcpy d_log_likelihoods -> log_likelihoods");
+            check_cuda_error("cudaMemcpyAsync d_log_likelihoods -> h_log_likelihoods");
         #endif
 
-        cudaDeviceSynchronize();
-        #ifdef DEBUG
-            check_cuda_error("cudaDeviceSynchronize compare");
-        #endif
+        cudaEventRecord(log_likelihoods_downloaded_, stream_);
+        nr_weighted_poses_ = nr_poses_;
     } else {
+        nr_weighted_poses_ = 0;
         std::cout << "WARNING (CUDA): It seems you forgot to do one of the following: set observation image, set occlusion"
                   << " indices, set number of poses, allocate memory, map texture to texture array or inisitialize constants." << std::endl;
     }
@@ -440,6 +794,25 @@ void CudaEvaluator::weigh_poses(const bool update_occlusions, vector<float> &log
 
 
 
+void CudaEvaluator::wait_for_log_likelihoods(vector<float> &log_likelihoods) {
+    cudaEventSynchronize(log_likelihoods_downloaded_);
+    #ifdef DEBUG
+        check_cuda_error("cudaEventSynchronize log_likelihoods_downloaded");
+    #endif
+
+    if (log_likelihoods.size() < size_t(nr_weighted_poses_)) {
+        log_likelihoods.resize(nr_weighted_poses_);
+    }
+    std::copy(h_log_likelihoods_, h_log_likelihoods_ + nr_weighted_poses_,
+              log_likelihoods.begin());
+}
+
+
+
+
+
+
+
 // ===================================================================================== //
 // =============================== CUDA EVALUATOR SETTERS ================================= //
 // ===================================================================================== //
@@ -457,11 +830,13 @@ void CudaEvaluator::set_nr_threads(const int nr_threads) {
 
 
 
-void CudaEvaluator::set_observations(const float* observations, const float observation_time) {
+void CudaEvaluator::set_observations(const float* observations, const float observation_time,
+                                     const int nr_observations) {
 
-    if (nr_rows_ * nr_cols_ > observations_size_) {
+    int size = nr_rows_ * nr_cols_ * nr_observations;
+    if (size > observations_size_) {
         std::cout << "ERROR (CUDA) in set_observations: You exceeded "
-                  << "(" << nr_rows_ * nr_cols_ << ")"
+                  << "(" << size << ")"
                   << "the memory space that was allocated for the observation "
                   << "values (" << observations_size_ << ")." << std::endl;
         exit(-1);
@@ -469,13 +844,26 @@ void CudaEvaluator::set_observations(const float* observations, const float obse
 
     observation_time_ = observation_time;
 
-    cudaMemcpy(d_observations_, observations, nr_cols_ * nr_rows_ * sizeof(float), cudaMemcpyHostToDevice);
+    // the staging buffer may still be read by the previous upload
+    cudaEventSynchronize(observations_uploaded_);
+    std::copy(observations, observations + size, h_observations_);
+
+    cudaMemcpyAsync(d_observations_, h_observations_, size * sizeof(float),
+                    cudaMemcpyHostToDevice, stream_);
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpy observations -> d_observations_");
+        check_cuda_error("cudaMemcpyAsync observations -> d_observations_");
     #endif
-    cudaDeviceSynchronize();
+    cudaEventRecord(observations_uploaded_, stream_);
+
+    // the terms are ordered before the next weighting on the stream
+    int nr_pixels = nr_rows_ * nr_cols_;
+    int nr_words = observation_mask_words();
+    int nr_threads = nr_observations * nr_words * 32;
+    observation_terms_kernel <<< (nr_threads + 255) / 256, 256, 0, stream_ >>> (
+            d_observations_, (float4*) d_observation_terms_, d_observation_masks_, nr_pixels, nr_words,
+            nr_observations);
     #ifdef DEBUG
-        check_cuda_error("cudaDeviceSynchronize set_observations");
+        check_cuda_error("observation_terms_kernel call");
     #endif
 
     observations_set_ = true;
@@ -483,6 +871,44 @@ void CudaEvaluator::set_observations(const float* observations, const float obse
 
 
 
+void CudaEvaluator::set_max_nr_observations(const int nr_observations) {
+
+    max_nr_observations_ = max(1, nr_observations);
+}
+
+
+
+void CudaEvaluator::set_pose_parameters(const PoseParameters* parameters,
+                                        const int array_size) {
+
+    if (parameters == NULL) {
+        pose_parameters_set_ = false;
+        return;
+    }
+
+    if (array_size > max_nr_poses_) {
+        std::cout << "ERROR (CUDA): The amount of pose parameters sent to "
+                  << "the GPU (" << array_size << ") exceeds the amount of "
+                  << "maximum poses (" << max_nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    cudaEventSynchronize(pose_parameters_uploaded_);
+    std::copy(parameters, parameters + array_size, h_pose_parameters_);
+
+    cudaMemcpyAsync(d_pose_parameters_, h_pose_parameters_,
+                    array_size * sizeof(PoseParameters), cudaMemcpyHostToDevice, stream_);
+
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyAsync pose_parameters -> d_pose_parameters");
+    #endif
+    cudaEventRecord(pose_parameters_uploaded_, stream_);
+
+    pose_parameters_set_ = true;
+}
+
+
+
 void CudaEvaluator::set_occlusion_indices(const int* occlusion_indices,
                                           const int array_size) {
 
@@ -493,16 +919,16 @@ void CudaEvaluator::set_occlusion_indices(const int* occlusion_indices,
         exit(-1);
     }
 
-    cudaMemcpy(d_occlusion_indices_, occlusion_indices,
-               array_size * sizeof(int), cudaMemcpyHostToDevice);
+    cudaEventSynchronize(occlusion_indices_uploaded_);
+    std::copy(occlusion_indices, occlusion_indices + array_size, h_occlusion_indices_);
+
+    cudaMemcpyAsync(d_occlusion_indices_, h_occlusion_indices_,
+                    array_size * sizeof(int), cudaMemcpyHostToDevice, stream_);
 
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpy occlusion_indices -> d_occlusion_indices");
-    #endif
-    cudaDeviceSynchronize();
-    #ifdef DEBUG
-        check_cuda_error("cudaDeviceSynchronize set_occlusion_indices");
+        check_cuda_error("cudaMemcpyAsync occlusion_indices -> d_occlusion_indices");
     #endif
+    cudaEventRecord(occlusion_indices_uploaded_, stream_);
 
     occlusion_indices_set_ = true;
 }
@@ -513,13 +939,31 @@ void CudaEvaluator::set_resolution(const int nr_rows, const int nr_cols) {
     nr_rows_ = nr_rows;
     nr_cols_ = nr_cols;
 
+    set_tile_resolution(nr_rows, nr_cols);
+    set_tile_offset(0, 0);
+}
+
+
+void CudaEvaluator::set_tile_resolution(const int nr_rows, const int nr_cols) {
+
+    tile_rows_ = nr_rows;
+    tile_cols_ = nr_cols;
+}
+
+
+void CudaEvaluator::set_tile_offset(const int row_offset, const int col_offset) {
+
+    tile_row_offset_ = row_offset;
+    tile_col_offset_ = col_offset;
 }
 
 
 void CudaEvaluator::set_occlusion_probabilities(const float* occlusion_probabilities,
-                                                const int array_size) {
+                                                const int array_size,
+                                                const int first_slot) {
 
-    if (array_size > occlusion_probs_size_) {
+    int offset = first_slot * nr_rows_ * nr_cols_;
+    if (offset + array_size > occlusion_probs_size_) {
         std::cout << "ERROR (CUDA) in set_occlusion_probabilities: You exceeded "
                   << "(" << array_size << ")"
                   << "the memory space that was allocated for the occlusion "
@@ -527,22 +971,77 @@ void CudaEvaluator::set_occlusion_probabilities(const float* occlusion_probabili
         exit(-1);
     }
 
-    cudaMemcpy(d_occlusion_probs_, occlusion_probabilities,
-               array_size * sizeof(float), cudaMemcpyHostToDevice);
+    std::vector<unsigned char> encoded(array_size * occlusion_bytes_);
+    dbot::encode_occlusions(occlusion_precision_, occlusion_probabilities, array_size,
+                            encoded.data(), occlusion_seed_);
+
+    // pageable memory, the copy is ordered after the pending work on the
+    // stream and has completed when this function returns
+    cudaMemcpyAsync(d_occlusion_probs_ + offset * occlusion_bytes_, encoded.data(),
+                    encoded.size(), cudaMemcpyHostToDevice, stream_);
 
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpy occlusion_probabilities -> d_occlusion_probs_");
+        check_cuda_error("cudaMemcpyAsync occlusion_probabilities -> d_occlusion_probs_");
     #endif
-    cudaDeviceSynchronize();
+    cudaStreamSynchronize(stream_);
     #ifdef DEBUG
-        check_cuda_error("cudaDeviceSynchronize set_occlusion_probabilities");
+        check_cuda_error("cudaStreamSynchronize set_occlusion_probabilities");
     #endif
 }
 
 
+void CudaEvaluator::set_likelihood_table(const dbot::KinectPixelTable& table,
+                                         const float* data,
+                                         const int size) {
+    cudaFree(d_likelihood_table_);
+    d_likelihood_table_ = NULL;
+
+    if (data == NULL) return;
+
+    likelihood_table_ = table;
+    allocate(d_likelihood_table_, size * sizeof(float));
+    cudaMemcpy(d_likelihood_table_, data, size * sizeof(float), cudaMemcpyHostToDevice);
+
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy likelihood table -> d_likelihood_table_");
+    #endif
+}
+
+
+void CudaEvaluator::set_occlusion_precision(const dbot::OcclusionPrecision precision) {
+    occlusion_precision_ = precision;
+    occlusion_bytes_ = dbot::occlusion_bytes(precision);
+}
+
+
+void CudaEvaluator::set_rejection_margin(const float margin,
+                                         const float max_log_ratio) {
+    rejection_margin_ = margin;
+    max_log_ratio_ = max_log_ratio;
+}
+
+
+int CudaEvaluator::coprime_step(const int nr_rounds) {
+    // the rounds are visited close to the golden ratio apart
+    int step = max(1, int(nr_rounds * 0.618f));
+    while (step > 1) {
+        int a = nr_rounds, b = step;
+        while (b != 0) {
+            int r = a % b;
+            a = b;
+            b = r;
+        }
+        if (a == 1) break;
+        --step;
+    }
+    return step;
+}
+
+
 void CudaEvaluator::map_texture_to_texture_array(const cudaArray_t texture_array) {
 
     d_texture_array_ = texture_array;
+    d_depth_images_ = NULL;
     cudaBindTextureToArray(texture_reference, d_texture_array_);
 
     #ifdef DEBUG
@@ -553,6 +1052,13 @@ void CudaEvaluator::map_texture_to_texture_array(const cudaArray_t texture_array
 }
 
 
+void CudaEvaluator::set_depth_images(const float* depth_images) {
+
+    d_depth_images_ = depth_images;
+    texture_array_mapped_ = true;
+}
+
+
 void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
                                                   int nr_poses_per_row,
                                                   int nr_poses_per_col) {
@@ -586,21 +1092,43 @@ void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
         max_nr_poses_per_column_ = nr_poses_per_col;
 
         grid_dimension_ = dim3(nr_poses_per_row, nr_poses_per_col);
+        nr_poses_per_row_ = nr_poses_per_row;
+        nr_poses_per_column_ = nr_poses_per_col;
 
 
         // reallocate arrays
         allocate(d_log_likelihoods_, sizeof(float) * max_nr_poses_);
         allocate(d_occlusion_indices_, sizeof(int) * max_nr_poses_);
         occlusion_probs_size_ = nr_rows_ * nr_cols_ * max_nr_poses_;
-        allocate(d_occlusion_probs_, occlusion_probs_size_ * sizeof(float));
-        allocate(d_occlusion_probs_copy_, occlusion_probs_size_ * sizeof(float));
-        observations_size_ = nr_rows_ * nr_cols_;
+        allocate(d_occlusion_probs_, occlusion_probs_size_ * occlusion_bytes_);
+        allocate(d_occlusion_probs_copy_, occlusion_probs_size_ * occlusion_bytes_);
+        observations_size_ = nr_rows_ * nr_cols_ * max_nr_observations_;
         allocate(d_observations_, observations_size_ * sizeof(float));
+        allocate(d_observation_terms_, observations_size_ * 4 * sizeof(float));
+        allocate(d_observation_masks_,
+                 observation_mask_words() * max_nr_observations_ * sizeof(unsigned int));
+        allocate(d_pose_parameters_, sizeof(PoseParameters) * max_nr_poses_);
+        allocate(d_best_log_likelihoods_, sizeof(unsigned int) * max_nr_observations_);
+
+        // no transfer may use the staging buffers while reallocating them
+        cudaStreamSynchronize(stream_);
+        allocate_host(h_observations_, observations_size_ * sizeof(float));
+        allocate_host(h_occlusion_indices_, sizeof(int) * max_nr_poses_);
+        allocate_host(h_log_likelihoods_, sizeof(float) * max_nr_poses_);
+        allocate_host(h_pose_parameters_, sizeof(PoseParameters) * max_nr_poses_);
+        allocate_host(h_depth_readback_, nr_rows_ * nr_cols_ * sizeof(float));
+        allocate_host(h_occlusion_readback_, nr_rows_ * nr_cols_ * occlusion_bytes_);
+        nr_weighted_poses_ = 0;
+        pose_parameters_set_ = false;
+        readback_pending_ = false;
 
         vector<float> initial_occlusion_probs (nr_rows_ * nr_cols_ * max_nr_poses_,
                                                occlusion_prob_default_);
+        vector<unsigned char> initial_occlusion_data (occlusion_probs_size_ * occlusion_bytes_);
+        dbot::encode_occlusions(occlusion_precision_, &initial_occlusion_probs[0], occlusion_probs_size_,
+                                &initial_occlusion_data[0], occlusion_seed_);
 
-        cudaMemcpy(d_occlusion_probs_, &initial_occlusion_probs[0], occlusion_probs_size_ * sizeof(float), cudaMemcpyHostToDevice);
+        cudaMemcpy(d_occlusion_probs_, &initial_occlusion_data[0], initial_occlusion_data.size(), cudaMemcpyHostToDevice);
         #ifdef DEBUG
             check_cuda_error("cudaMemcpy occlusion_prob_default_ -> d_occlusion_probs_");
         #endif
@@ -640,6 +1168,8 @@ void CudaEvaluator::set_number_of_poses(int nr_poses) {
                                    (int) ceil(nr_poses / (float) nr_poses_per_row));
 
         grid_dimension_ = dim3(nr_poses_per_row, nr_poses_per_column);
+        nr_poses_per_row_ = nr_poses_per_row;
+        nr_poses_per_column_ = nr_poses_per_column;
 
         number_of_poses_set_ = true;
     } else {
@@ -678,25 +1208,33 @@ cudaDeviceProp CudaEvaluator::get_device_properties() {
 
 void CudaEvaluator::get_memory_need_parameters(int nr_rows, int nr_cols,
                                 int& constant_need, int& per_pose_need) {
-    constant_need = nr_rows * nr_cols * sizeof(float);
-    per_pose_need = (3 + 2 * nr_rows * nr_cols) * sizeof(float);
+    // planned ahead by dbot::GpuMemoryPlanner, which has to match
+    // the observations, their terms and their valid masks
+    constant_need = max_nr_observations_ * (5 * nr_rows * nr_cols * sizeof(float) +
+                                            (nr_rows * nr_cols + 31) / 32 * sizeof(unsigned int));
+    per_pose_need = 3 * sizeof(float) + 2 * nr_rows * nr_cols * occlusion_bytes_ + sizeof(PoseParameters);
+}
+
+cudaStream_t CudaEvaluator::stream() {
+    return stream_;
 }
 
 vector<float> CudaEvaluator::get_occlusion_probabilities(int state_id) {
     if (memory_allocated_) {
-        float* occlusion_probabilities = (float*) malloc(nr_rows_ * nr_cols_ * sizeof(float));
-        int offset = state_id * nr_rows_ * nr_cols_;
-        cudaMemcpy(occlusion_probabilities, d_occlusion_probs_ + offset, nr_rows_ * nr_cols_ * sizeof(float), cudaMemcpyDeviceToHost);
+        int nr_pixels = nr_rows_ * nr_cols_;
+        vector<unsigned char> occlusion_data(nr_pixels * occlusion_bytes_);
+        int offset = state_id * nr_pixels * occlusion_bytes_;
+        cudaMemcpyAsync(&occlusion_data[0], d_occlusion_probs_ + offset, occlusion_data.size(),
+                        cudaMemcpyDeviceToHost, stream_);
+        cudaStreamSynchronize(stream_);
 
         #ifdef DEBUG
             check_cuda_error("cudaMemcpy d_occlusion_probabilities -> occlusion_probabilities");
         #endif
 
-        vector<float> occlusion_probabilities_vector;
-        for (int i = 0; i < nr_rows_ * nr_cols_; i++) {
-            occlusion_probabilities_vector.push_back(occlusion_probabilities[i]);
-        }
-        free(occlusion_probabilities);
+        vector<float> occlusion_probabilities_vector(nr_pixels);
+        dbot::decode_occlusions(occlusion_precision_, &occlusion_data[0], nr_pixels,
+                                &occlusion_probabilities_vector[0]);
         return occlusion_probabilities_vector;
     } else {
         std::cout << "WARNING (CUDA): It seems you forgot to call "
@@ -710,6 +1248,200 @@ vector<float> CudaEvaluator::get_occlusion_probabilities(int state_id) {
 
 
 
+vector<unsigned char> CudaEvaluator::get_encoded_occlusions(int nr_states) {
+    int size = nr_states * nr_rows_ * nr_cols_;
+    if (size > occlusion_probs_size_) {
+        std::cout << "ERROR (CUDA) in get_encoded_occlusions: The states "
+                  << "exceed the allocated occlusion probabilities." << std::endl;
+        exit(-1);
+    }
+
+    vector<unsigned char> encoded(size * occlusion_bytes_);
+    if (size > 0) {
+        cudaMemcpyAsync(&encoded[0], d_occlusion_probs_, encoded.size(),
+                        cudaMemcpyDeviceToHost, stream_);
+        cudaStreamSynchronize(stream_);
+    }
+
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy d_occlusion_probs_ -> encoded");
+    #endif
+
+    return encoded;
+}
+
+
+void CudaEvaluator::set_encoded_occlusions(const vector<unsigned char>& encoded) {
+    if (encoded.size() > size_t(occlusion_probs_size_) * occlusion_bytes_) {
+        std::cout << "ERROR (CUDA) in set_encoded_occlusions: The states "
+                  << "exceed the allocated occlusion probabilities." << std::endl;
+        exit(-1);
+    }
+
+    if (!encoded.empty()) {
+        cudaMemcpyAsync(d_occlusion_probs_, &encoded[0], encoded.size(),
+                        cudaMemcpyHostToDevice, stream_);
+        cudaStreamSynchronize(stream_);
+    }
+
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy encoded -> d_occlusion_probs_");
+    #endif
+}
+
+
+float CudaEvaluator::get_occlusion_time() {
+    return occlusion_time_;
+}
+
+
+void CudaEvaluator::set_occlusion_time(const float occlusion_time) {
+    occlusion_time_ = occlusion_time;
+}
+
+
+
+
+void CudaEvaluator::copy_occlusion_probabilities(int state_id,
+                                                 const CudaEvaluator& source,
+                                                 int source_state_id) {
+    int nr_pixels = nr_rows_ * nr_cols_;
+    if ((state_id + 1) * nr_pixels > occlusion_probs_size_ ||
+        (source_state_id + 1) * nr_pixels > source.occlusion_probs_size_) {
+        std::cout << "ERROR (CUDA) in copy_occlusion_probabilities: The state "
+                  << "exceeds the allocated occlusion probabilities." << std::endl;
+        exit(-1);
+    }
+    if (source.occlusion_precision_ != occlusion_precision_) {
+        std::cout << "ERROR (CUDA) in copy_occlusion_probabilities: The source "
+                  << "stores the occlusion probabilities in another precision." << std::endl;
+        exit(-1);
+    }
+
+    cudaMemcpyPeerAsync(d_occlusion_probs_ + state_id * nr_pixels * occlusion_bytes_, device_,
+                        source.d_occlusion_probs_ + source_state_id * nr_pixels * occlusion_bytes_, source.device_,
+                        nr_pixels * occlusion_bytes_, stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyPeerAsync source occlusion probabilities -> d_occlusion_probs_");
+    #endif
+}
+
+void CudaEvaluator::request_readback(int state_id) {
+    if (!memory_allocated_ || !texture_array_mapped_ || state_id >= nr_poses_) {
+        std::cout << "WARNING (CUDA): It seems you forgot to weigh the poses before "
+                  << "calling request_readback or the state exceeds the poses." << std::endl;
+        return;
+    }
+
+    int nr_pixels = nr_rows_ * nr_cols_;
+    readback_from_texture_ = d_depth_images_ == NULL;
+
+    // the depths are copied as they are stored and only rearranged by poll_readback
+    if (readback_from_texture_) {
+        // bottom row of the tile of the pose, see evaluate_kernel
+        int pose_x = (state_id % nr_poses_per_row_) * tile_cols_;
+        int pose_y = (nr_poses_per_column_ - 1 - state_id / nr_poses_per_row_) * tile_rows_;
+
+        cudaMemcpy2DFromArrayAsync(h_depth_readback_, tile_cols_ * sizeof(float), d_texture_array_,
+                                   pose_x * sizeof(float), pose_y, tile_cols_ * sizeof(float), tile_rows_,
+                                   cudaMemcpyDeviceToHost, stream_);
+        #ifdef DEBUG
+            check_cuda_error("cudaMemcpy2DFromArrayAsync texture_array -> h_depth_readback");
+        #endif
+
+        readback_rows_ = tile_rows_;
+        readback_cols_ = tile_cols_;
+        readback_row_offset_ = tile_row_offset_;
+        readback_col_offset_ = tile_col_offset_;
+    } else {
+        cudaMemcpyAsync(h_depth_readback_, d_depth_images_ + state_id * nr_pixels, nr_pixels * sizeof(float),
+                        cudaMemcpyDeviceToHost, stream_);
+        #ifdef DEBUG
+            check_cuda_error("cudaMemcpyAsync d_depth_images -> h_depth_readback");
+        #endif
+    }
+
+    cudaMemcpyAsync(h_occlusion_readback_, d_occlusion_probs_ + state_id * nr_pixels * occlusion_bytes_,
+                    nr_pixels * occlusion_bytes_, cudaMemcpyDeviceToHost, stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyAsync d_occlusion_probs -> h_occlusion_readback");
+    #endif
+
+    cudaEventRecord(readback_downloaded_, stream_);
+    readback_pending_ = true;
+}
+
+bool CudaEvaluator::poll_readback(float* depth_image, float* occlusion_probabilities) {
+    if (!readback_pending_) return false;
+
+    cudaError_t status = cudaEventQuery(readback_downloaded_);
+    if (status == cudaErrorNotReady) {
+        // not an error, but it must not be reported by the next check_cuda_error
+        cudaGetLastError();
+        return false;
+    }
+    #ifdef DEBUG
+        check_cuda_error("cudaEventQuery readback_downloaded");
+    #endif
+    readback_pending_ = false;
+
+    int nr_pixels = nr_rows_ * nr_cols_;
+    if (depth_image != NULL) {
+        if (readback_from_texture_) {
+            std::fill(depth_image, depth_image + nr_pixels, 0.f);
+            for (int row = 0; row < readback_rows_; row++) {
+                const float* tile_row = h_depth_readback_ + (readback_rows_ - 1 - row) * readback_cols_;
+                std::copy(tile_row, tile_row + readback_cols_,
+                          depth_image + (readback_row_offset_ + row) * nr_cols_ + readback_col_offset_);
+            }
+        } else {
+            std::copy(h_depth_readback_, h_depth_readback_ + nr_pixels, depth_image);
+        }
+    }
+    if (occlusion_probabilities != NULL) {
+        dbot::decode_occlusions(occlusion_precision_, h_occlusion_readback_, nr_pixels, occlusion_probabilities);
+    }
+
+    return true;
+}
+
+void CudaEvaluator::preserve_occlusion_probabilities(const int first_slot,
+                                                     const int nr_slots) {
+    int nr_pixels = nr_rows_ * nr_cols_;
+    if (nr_slots <= 0) return;
+    if ((first_slot + nr_slots) * nr_pixels > occlusion_probs_size_) {
+        std::cout << "ERROR (CUDA) in preserve_occlusion_probabilities: The slots "
+                  << "exceed the allocated occlusion probabilities." << std::endl;
+        exit(-1);
+    }
+
+    // after an update the probabilities read by the step are in the copy
+    int offset = first_slot * nr_pixels * occlusion_bytes_;
+    cudaMemcpyAsync(d_occlusion_probs_ + offset, d_occlusion_probs_copy_ + offset,
+                    nr_slots * nr_pixels * occlusion_bytes_, cudaMemcpyDeviceToDevice, stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyAsync d_occlusion_probs_copy -> d_occlusion_probs");
+    #endif
+}
+
+void CudaEvaluator::get_occlusion_transition(const double delta_time,
+                                             float& scale, float& offset) const {
+    // p -> c^t p + 1 - c^t - (1 - p_oo)(c^t - 1)/(c - 1)
+    scale = 1;
+    offset = 0;
+    if (!isnan(delta_time)) {
+        scale = exp(delta_time * log_c_);
+        offset = 1 - scale - (1 - p_occluded_occluded_) * (scale - 1) * one_div_c_minus_one_;
+    }
+}
+
+int CudaEvaluator::device() const {
+    return device_;
+}
+
+
+
+
 // ===================================================================================== //
 // ========================== CUDA EVALUATOR HELPER FUNCTIONS ============================= //
 // ===================================================================================== //
@@ -726,6 +1458,14 @@ template <typename T> void CudaEvaluator::allocate(T * &pointer, size_t size) {
 }
 
 
+template <typename T> void CudaEvaluator::allocate_host(T * &pointer, size_t size) {
+    cudaFreeHost(pointer);
+    cudaHostAlloc((void **) &pointer, size, cudaHostAllocDefault);
+#ifdef DEBUG
+    check_cuda_error("cudaHostAlloc failed");
+#endif
+}
+
 
 void CudaEvaluator::check_cuda_error(const char *msg)
 {
@@ -745,11 +1485,34 @@ void CudaEvaluator::check_cuda_error(const char *msg)
 
 
 CudaEvaluator::~CudaEvaluator() {
+    cudaSetDevice(device_);
     cudaFree(d_occlusion_probs_);
     cudaFree(d_occlusion_probs_copy_);
     cudaFree(d_observations_);
+    cudaFree(d_observation_terms_);
+    cudaFree(d_observation_masks_);
     cudaFree(d_log_likelihoods_);
     cudaFree(d_occlusion_indices_);
+    cudaFree(d_likelihood_table_);
+    cudaFree(d_best_log_likelihoods_);
+    cudaFree(d_pose_parameters_);
+    cudaFreeHost(h_observations_);
+    cudaFreeHost(h_occlusion_indices_);
+    cudaFreeHost(h_log_likelihoods_);
+    cudaFreeHost(h_pose_parameters_);
+    cudaFreeHost(h_depth_readback_);
+    cudaFreeHost(h_occlusion_readback_);
+    cudaEventDestroy(observations_uploaded_);
+    cudaEventDestroy(occlusion_indices_uploaded_);
+    cudaEventDestroy(log_likelihoods_downloaded_);
+    cudaEventDestroy(readback_downloaded_);
+    cudaEventDestroy(pose_parameters_uploaded_);
+    cudaStreamDestroy(stream_);
+}
+
+
+void CudaEvaluator::reset_device(const int device) {
+    cudaSetDevice(device);
     cudaDeviceReset();
 }
 
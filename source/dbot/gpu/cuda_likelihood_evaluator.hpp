@@ -32,6 +32,9 @@
 #include <curand_kernel.h>
 #include <vector>
 
+#include <dbot/model/kinect_pixel_table.hpp>
+#include <dbot/model/occlusion_encoding.hpp>
+
 /**
  * \brief This class provides a parallel implementation of the weighting step on
  *        the GPU.
@@ -40,20 +43,43 @@
  * init -> allocate_memory_for_max_poses -> set_number_of_poses       }
  *                                       -> set_occlusion_indices     } -> weigh_poses
  *                                       -> set_observations          }
- * map_texture_to_texture_array    ---------------------------------  }
+ * map_texture_to_texture_array / set_depth_images ----------------  }
  *
  * allocate_memory_for_max_poses -> set_occlusion_probabilities
  *                               -> get_occlusion_probabilities
  *
+ * weigh_poses -> request_readback -> poll_readback (in a later frame)
+ *
  * Make sure to
  *  always render the poses first with opengl, then map the texture into CUDA,
  *  update the observation image with set_observations() and update the
  * occlusion indices (after resampling)
  *  before you call the weigh_poses() function.
+ *
+ * All transfers and kernels are issued asynchronously on a single CUDA stream
+ * through pinned host staging buffers. Uploads hence return immediately and
+ * overlap with the OpenGL rendering of the poses. Map the OpenGL texture on
+ * stream() to order it with respect to the weighting kernel.
  */
 class CudaEvaluator
 {
 public:
+    /**
+     * \brief Per-pose parameters of a weighting step which evaluates the
+     * poses of several independent filters together, see
+     * set_pose_parameters()
+     */
+    struct PoseParameters
+    {
+        /// index of the observation image the pose is compared to
+        int observation;
+        /// slot the updated occlusion probabilities of the pose are written to
+        int occlusion_slot;
+        /// occlusion transition p -> scale * p + offset since the last update
+        float occlusion_scale;
+        float occlusion_offset;
+    };
+
     /**
      * \brief Constructor which takes the resolution of the camera image
      *
@@ -61,15 +87,30 @@ public:
      *     The number of rows in each camera image
      * \param [in] nr_cols
      *     The number of columns in each camera image
+     * \param [in] device
+     *     The CUDA device to run on. It becomes the current device and has to
+     *     be current whenever a member function is called. A negative value
+     *     selects the first device of compute capability 2.0 or higher.
      */
     CudaEvaluator(const int nr_rows,
-                  const int nr_cols);
+                  const int nr_cols,
+                  const int device = -1);
 
     /**
-     * \brief Destructor which frees the memory used on the GPU
+     * \brief Destructor which frees the memory, the stream and the events of
+     *        this evaluator. Other evaluators and rasterizers on the device
+     *        keep running, the device is not reset.
      */
     virtual ~CudaEvaluator();
 
+    /**
+     * \brief Destroys all allocations and the state of the process on the
+     *        device, e.g. before exiting for leak checkers and profilers.
+     *        No evaluator, rasterizer or other CUDA object of the process may
+     *        be in use on the device anymore.
+     */
+    static void reset_device(const int device);
+
     /**
      * \brief This function has to be called once in the beginning, before
      *        calling the allocate_memory_for_max_poses() function.
@@ -120,6 +161,24 @@ public:
     void weigh_poses(const bool update_occlusions,
                      std::vector<float>& log_likelihoods);
 
+    /**
+     * \brief Enqueues the weighting of the rendered poses and the readback of
+     *        the log likelihoods without waiting for them
+     *
+     * \param [in] update_occlusions
+     *     Update whether or not to update the occlusion probabilities during
+     *     this weighting
+     */
+    void weigh_poses_async(const bool update_occlusions);
+
+    /**
+     * \brief Waits for the last weigh_poses_async() call to complete
+     *
+     * \param [out] log_likelihoods
+     *     The computed likelihoods for each pose
+     */
+    void wait_for_log_likelihoods(std::vector<float>& log_likelihoods);
+
     // setters
 
     /**
@@ -132,14 +191,57 @@ public:
     void set_nr_threads(const int nr_threads);
 
     /**
-     * \brief Copies the observation image from the camera to the GPU for comparison
+     * \brief Copies the observation image from the camera to the GPU for comparison.
+     *        The terms of the pixel model which only depend on the observed depths and the
+     *        mask of the valid depths are computed once per image on the GPU.
      *
      * \param [in] observations a pointer to the observation values
      * \param [in] observation_time the time at which this observation was
      * captured
+     * \param [in] nr_observations the number of consecutive images, at most
+     * the number passed to set_max_nr_observations()
      */
     void set_observations(const float* observations,
-                          const float observation_time);
+                          const float observation_time,
+                          const int nr_observations = 1);
+
+    /**
+     * \brief Sets the maximum number of observation images compared in one
+     * weighting step, 1 by default.
+     * Be sure to call allocate_memory_for_max_poses afterwards.
+     */
+    void set_max_nr_observations(const int nr_observations);
+
+    /**
+     * \brief Sets the observation image, the occlusion slot and the occlusion
+     * transition of every pose of the next weighting steps. This evaluates
+     * the poses of independent filters in one step, each in its own range of
+     * occlusion slots and with its own time delta.
+     *
+     * \param [in] parameters [state_nr] = {parameters}, NULL switches back to
+     * the first observation image, the slot of the state and the time delta
+     * of the observations
+     * \param [in] array_size the number of values contained in parameters
+     */
+    void set_pose_parameters(const PoseParameters* parameters,
+                             const int array_size);
+
+    /**
+     * \brief Undoes the update of the last weighting step for the occlusion
+     * slots [first_slot, first_slot + nr_slots), such that these slots hold
+     * the probabilities from before the step. The copy is issued on stream().
+     */
+    void preserve_occlusion_probabilities(const int first_slot,
+                                          const int nr_slots);
+
+    /**
+     * \brief Computes the affine transition p -> scale * p + offset of the
+     * occlusion probabilities over delta_time. A NaN time delta yields the
+     * identity.
+     */
+    void get_occlusion_transition(const double delta_time,
+                                  float& scale,
+                                  float& offset) const;
 
     /**
      * \brief Sets the indices to the occlusion array for every state
@@ -160,15 +262,71 @@ public:
      */
     void set_resolution(const int nr_rows, const int nr_cols);
 
+    /**
+     * \brief Sets the size of the region of interest which is rendered per
+     * pose, its tiles are arranged in the OpenGL texture. Pixels outside of
+     * the region are treated as not covered by the object. Defaults to the
+     * resolution of the images.
+     * Be sure to call allocate_memory_for_max_poses afterwards.
+     * \param [in] nr_rows the number of rows of a tile
+     * \param [in] nr_cols the number of columns of a tile
+     */
+    void set_tile_resolution(const int nr_rows, const int nr_cols);
+
+    /**
+     * \brief Sets the image pixel which corresponds to the upper left pixel of
+     * the tiles rendered in the next call to weigh_poses()
+     */
+    void set_tile_offset(const int row_offset, const int col_offset);
+
     /**
     * \brief Sets the occlusion probabilities for all pixels for all states
     * \param [in] occlusion_probabilities a 1D-array of occlusion probabilities
     * which should contain array_size values.
     * \param [in] array_size the number of values contained in
     * occlusion_probabilities
+    * \param [in] first_slot the state whose probabilities are overwritten
+    * first
     */
     void set_occlusion_probabilities(const float* occlusion_probabilities,
-                                     const int array_size);
+                                     const int array_size,
+                                     const int first_slot = 0);
+
+    /**
+     * \brief Replaces the exact pixel model by lookup tables of the
+     * likelihood ratios, see KinectPixelModel::approximate()
+     *
+     * \param [in] table the layout of the tables
+     * \param [in] data the concatenated tables, NULL switches back to the
+     * exact model
+     * \param [in] size the number of values contained in data
+     */
+    void set_likelihood_table(const dbot::KinectPixelTable& table,
+                              const float* data,
+                              const int size);
+
+    /**
+     * \brief Stops evaluating a pose once even \a max_log_ratio on each of
+     * its remaining pixels would leave it more than \a margin below the best
+     * pose of its observation, see KinectImageModel::rejection_margin()
+     *
+     * \param [in] margin the margin in log likelihood, 0 evaluates all pixels
+     * \param [in] max_log_ratio upper bound of the per-pixel log likelihood
+     * ratios, see KinectPixelModel::max_log_likelihood_ratio()
+     */
+    void set_rejection_margin(const float margin, const float max_log_ratio);
+
+    /**
+     * \brief Sets the storage format of the occlusion probabilities, see
+     * dbot::OcclusionPrecision. Single by default. Half and Logit8 reduce the
+     * per-pose memory need and thereby raise the number of poses which fit
+     * into the GPU memory. The probabilities are converted by the weighting
+     * kernel and by the transfers from and to the host.
+     * Be sure to call allocate_memory_for_max_poses afterwards.
+     */
+    void set_occlusion_precision(const dbot::OcclusionPrecision precision);
+
+    dbot::OcclusionPrecision get_occlusion_precision() const { return occlusion_precision_; }
 
     /**
      * \brief Maps the texture array to an actual texture reference
@@ -177,6 +335,15 @@ public:
      */
     void map_texture_to_texture_array(const cudaArray_t texture_array);
 
+    /**
+     * \brief Uses depth images in device memory instead of the OpenGL texture
+     *
+     * \param [in] depth_images device pointer, [pose_nr][pixel_nr] = {depth}
+     * in the layout of the observations. The images have to be written on the
+     * stream of the evaluator or before the next call to weigh_poses().
+     */
+    void set_depth_images(const float* depth_images);
+
     /**
      * \brief Allocates the maximum amount of memory that will ever be needed by CUDA
      * during runtime
@@ -254,14 +421,96 @@ public:
      */
     std::vector<float> get_occlusion_probabilities(int state_id);
 
+    /**
+     * \brief Gets the encoded occlusion probabilities of the first nr_states
+     * states, e.g. to snapshot them without the loss of decoding them
+     *
+     * \param [in] nr_states the number of states
+     * \return the occlusion probabilities in the occlusion precision
+     */
+    std::vector<unsigned char> get_encoded_occlusions(int nr_states);
+
+    /**
+     * \brief Overwrites the first states by occlusion probabilities of
+     * get_encoded_occlusions() in the same precision
+     */
+    void set_encoded_occlusions(const std::vector<unsigned char>& encoded);
+
+    /**
+     * \brief The observation time the occlusion probabilities have been
+     * updated at last
+     */
+    float get_occlusion_time();
+    void set_occlusion_time(const float occlusion_time);
+
+    /**
+     * \brief Copies the occlusion probabilities of a state of another
+     * evaluator, which may run on a different device, into the slot state_id
+     * read by the next weighting step. The copy is issued on stream().
+     *
+     * \param [in] state_id the slot of this evaluator to overwrite
+     * \param [in] source the evaluator holding the occlusion probabilities,
+     * in the same precision as this one
+     * \param [in] source_state_id the state of the source to copy
+     */
+    void copy_occlusion_probabilities(int state_id,
+                                      const CudaEvaluator& source,
+                                      int source_state_id);
+
+    /**
+     * \brief Enqueues the download of the depth image and the occlusion
+     * probabilities of a state of the last weighting step into pinned host
+     * memory without waiting for it. The depth image is read from the mapped
+     * texture array or the depth images set before, hence the texture has to
+     * stay mapped until this call returned. A new request supersedes a
+     * pending one.
+     *
+     * \param [in] state_id the index into the state array
+     */
+    void request_readback(int state_id);
+
+    /**
+     * \brief Collects the last request_readback() if it has completed. This
+     * never waits for the device.
+     *
+     * \param [out] depth_image nr_rows x nr_cols depths in row major order,
+     * pixels outside of the rendered tile are 0. May be NULL.
+     * \param [out] occlusion_probabilities nr_rows x nr_cols occlusion
+     * probabilities in row major order. May be NULL.
+     * \return whether a completed readback was copied into the buffers
+     */
+    bool poll_readback(float* depth_image, float* occlusion_probabilities);
+
+    /** \return the CUDA device of this evaluator */
+    int device() const;
+
+    /**
+     * \brief Gets the stream all transfers and kernels are issued on
+     */
+    cudaStream_t stream();
+
 private:
     static const int DEFAULT_NR_THREADS = 128;
 
-    // device pointers to arrays stored in global memory on the GPU
-    float* d_occlusion_probs_;
-    float* d_occlusion_probs_copy_;
+    /** \return the largest step below 0.618 \a nr_rounds coprime to it */
+    static int coprime_step(const int nr_rounds);
+
+    /** \return the number of 32 bit words of the valid mask of an image */
+    int observation_mask_words() const { return (nr_rows_ * nr_cols_ + 31) / 32; }
+
+    // device pointers to arrays stored in global memory on the GPU. The
+    // occlusion probabilities are encoded in occlusion_precision_.
+    unsigned char* d_occlusion_probs_;
+    unsigned char* d_occlusion_probs_copy_;
     float* d_observations_;
     float* d_log_likelihoods_;
+
+    // per observed pixel the terms of the pixel model which only depend on
+    // the observation, four floats each, and the bitset of the valid
+    // observations of observation_mask_words() words per image, see
+    // set_observations()
+    float* d_observation_terms_;
+    unsigned int* d_observation_masks_;
     int* d_occlusion_indices_;  // this contains, for each pose, the index into
                                 // the occlusion probabilities array, which
                                 // contains the occlusion probabilities for that
@@ -270,20 +519,85 @@ private:
     int occlusion_probs_size_;
     int observations_size_;
 
+    // storage format of the occlusion probabilities and the dither seed of
+    // the next update, see set_occlusion_precision()
+    dbot::OcclusionPrecision occlusion_precision_;
+    int occlusion_bytes_;
+    unsigned int occlusion_seed_;
+
+    // stream of all transfers and kernels
+    cudaStream_t stream_;
+
+    // pinned host staging buffers of the asynchronous transfers
+    float* h_observations_;
+    int* h_occlusion_indices_;
+    float* h_log_likelihoods_;
+
+    // completion of the transfers reading from or writing to the staging
+    // buffers
+    cudaEvent_t observations_uploaded_;
+    cudaEvent_t occlusion_indices_uploaded_;
+    cudaEvent_t log_likelihoods_downloaded_;
+
+    // number of poses of the pending log likelihood readback
+    int nr_weighted_poses_;
+
+    // per-pose parameters, NULL if all poses belong to the same filter
+    PoseParameters* d_pose_parameters_;
+    PoseParameters* h_pose_parameters_;
+    cudaEvent_t pose_parameters_uploaded_;
+    bool pose_parameters_set_;
+    int max_nr_observations_;
+
+    // pinned buffers of the asynchronous depth and occlusion readback. The
+    // depths of a texture tile are stored bottom up as in OpenGL.
+    float* h_depth_readback_;
+    unsigned char* h_occlusion_readback_;
+    cudaEvent_t readback_downloaded_;
+    bool readback_pending_;
+    bool readback_from_texture_;
+    int readback_rows_;
+    int readback_cols_;
+    int readback_row_offset_;
+    int readback_col_offset_;
+
+    // tabulated pixel model, NULL if evaluated exactly
+    float* d_likelihood_table_;
+    dbot::KinectPixelTable likelihood_table_;
+
+    // bounded evaluation, see set_rejection_margin(). The best log
+    // likelihood of each observation in the current launch in the encoding
+    // of evaluate_kernel.
+    unsigned int* d_best_log_likelihoods_;
+    float rejection_margin_;
+    float max_log_ratio_;
+
     // for OpenGL interop
     cudaArray_t d_texture_array_;
 
+    // depth images rendered by CUDA, NULL if read from the texture
+    const float* d_depth_images_;
+
     // resolution
     int nr_cols_;
     int nr_rows_;
 
+    // region of interest rendered per pose, see set_tile_resolution()
+    int tile_rows_;
+    int tile_cols_;
+    int tile_row_offset_;
+    int tile_col_offset_;
+
     // maximum number of poses and their arrangement in the OpenGL texture
     int max_nr_poses_;
     int max_nr_poses_per_row_;
     int max_nr_poses_per_column_;
 
-    // actual number of poses for the current frame
+    // actual number of poses for the current frame and their arrangement
+    // in the OpenGL texture
     int nr_poses_;
+    int nr_poses_per_row_;
+    int nr_poses_per_column_;
 
     // block and grid arrangement of the CUDA kernels
     int nr_threads_;
@@ -297,7 +611,13 @@ private:
     float occlusion_time_;
     float observation_time_;
 
-    // CUDA device properties
+    // occlusion process parameters
+    float p_occluded_occluded_;
+    float one_div_c_minus_one_;
+    float log_c_;
+
+    // CUDA device and its properties
+    int device_;
     cudaDeviceProp cuda_device_properties_;
 
     // bool to ensure correct usage of public functions
@@ -307,5 +627,7 @@ private:
     // helper functions
     template <typename T>
     void allocate(T*& pointer, size_t size);
+    template <typename T>
+    void allocate_host(T*& pointer, size_t size);
     void check_cuda_error(const char* msg);
 };
@@ -0,0 +1,136 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cuda_likelihood_evaluator_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/gpu/cuda_rasterizer.hpp>
+#include <dbot/gpu/cuda_likelihood_evaluator.hpp>
+
+/**
+ * \brief Weighs poses jittered around the pose of the scene. The depth images
+ *        are rendered once by the CudaRasterizer, hence only the evaluation
+ *        is timed.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, number of poses,
+ * latitude bands of the sphere
+ */
+static void BM_CudaEvaluator_WeighPoses(benchmark::State& state)
+{
+    const int downsampling = state.range(0);
+    const int pose_count = state.range(1);
+    const int rings = state.range(2);
+
+    auto loader = std::make_shared<dbot::SyntheticObjectLoader>(1, rings);
+    dbot::ObjectModel object_model(loader, false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(1);
+    dbot::SyntheticCameraDataProvider camera(
+        downsampling, object_model, poses);
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    std::vector<std::vector<float>> vertices(1);
+    for (const auto& vertex : object_model.vertices()[0])
+    {
+        for (int k = 0; k < 3; ++k) vertices[0].push_back(vertex(k));
+    }
+
+    float camera_matrix[9];
+    Eigen::Map<Eigen::Matrix<float, 3, 3, Eigen::RowMajor>> camera_map(
+        camera_matrix);
+    camera_map = camera.camera_matrix().cast<float>();
+
+    CudaRasterizer rasterizer(vertices,
+                              object_model.triangle_indices(),
+                              camera_matrix,
+                              n_rows,
+                              n_cols,
+                              0.4,
+                              4);
+    rasterizer.allocate_memory_for_max_poses(pose_count);
+
+    CudaEvaluator evaluator(n_rows, n_cols);
+    evaluator.init(
+        0.1f, 0.7f, 0.1f, 0.01f, 0.003f, 0.0014247f, 6.0f, -std::log(0.5f));
+
+    // without a texture the poses only have to fit into the grid
+    const int max_grid_width =
+        evaluator.get_device_properties().maxGridSize[0];
+    const int poses_per_row =
+        std::max(1, std::min(pose_count, max_grid_width));
+    evaluator.allocate_memory_for_max_poses(
+        pose_count,
+        poses_per_row,
+        (pose_count + poses_per_row - 1) / poses_per_row);
+
+    std::vector<float> occlusions(n_rows * n_cols * pose_count, 0.1f);
+    evaluator.set_occlusion_probabilities(occlusions.data(),
+                                          occlusions.size());
+    std::vector<int> occlusion_indices(pose_count);
+    for (int i = 0; i < pose_count; ++i) occlusion_indices[i] = i;
+    evaluator.set_occlusion_indices(occlusion_indices.data(), pose_count);
+
+    const auto observation = camera.depth_image_view();
+    evaluator.set_observations(observation.data(), 0.033f);
+
+    // default pose of the part followed by the jittered deltas, each the
+    // first three rows of a homogeneous transformation in row major order
+    typedef Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> PoseMap;
+    std::vector<float> default_pose(12);
+    PoseMap(default_pose.data()) =
+        poses[0].matrix().topRows<3>().cast<float>();
+
+    std::mt19937 generator(0);
+    std::normal_distribution<float> noise(0.f, 0.005f);
+    std::vector<float> deltas(12 * pose_count);
+    for (int i = 0; i < pose_count; ++i)
+    {
+        PoseMap delta(&deltas[12 * i]);
+        delta.leftCols<3>().setIdentity();
+        delta.col(3) << noise(generator), noise(generator), noise(generator);
+    }
+
+    rasterizer.render(
+        default_pose, deltas.data(), pose_count, evaluator.stream());
+    evaluator.set_depth_images(rasterizer.get_depth_images());
+    evaluator.set_number_of_poses(pose_count);
+
+    std::vector<float> log_likelihoods(pose_count);
+    for (auto _ : state)
+    {
+        evaluator.weigh_poses(false, log_likelihoods);
+        benchmark::DoNotOptimize(log_likelihoods.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * pose_count);
+}
+
+BENCHMARK(BM_CudaEvaluator_WeighPoses)
+    ->ArgNames({"downsampling", "poses", "rings"})
+    ->Args({1, 100, 16})
+    ->Args({1, 1000, 16})
+    ->Args({2, 1000, 16})
+    ->Args({4, 1000, 16})
+    ->Args({4, 5000, 16})
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,404 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cuda_rasterizer.cu
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#define DEBUG
+
+#include <dbot/gpu/cuda_rasterizer.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+#include <cuda.h>
+#include <math.h>
+
+using namespace std;
+
+// depth of pixels which are not covered by any triangle, larger than the bit
+// pattern of any positive float
+#define EMPTY_DEPTH 0xFFFFFFFFu
+
+#define NR_THREADS 128
+
+
+// ************************************************************************************** //
+// ================================== CUDA KERNELS ====================================== //
+// ************************************************************************************** //
+
+
+// model_poses[pose][object] = default_poses[object] * deltas[pose][object], all 3 x 4 row major
+__global__ void compose_poses_kernel(const float* poses, float* model_poses, int nr_objects, int nr_poses) {
+    int index = blockIdx.x * blockDim.x + threadIdx.x;
+    if (index >= nr_poses * nr_objects) return;
+
+    const float* a = poses + (index % nr_objects) * 12;
+    const float* b = poses + (nr_objects + index) * 12;
+    float* c = model_poses + index * 12;
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+            float value = col == 3 ? a[row * 4 + 3] : 0;
+            for (int k = 0; k < 3; k++) {
+                value += a[row * 4 + k] * b[k * 4 + col];
+            }
+            c[row * 4 + col] = value;
+        }
+    }
+}
+
+
+
+// each thread rasterizes triangle blockIdx.x * blockDim.x + threadIdx.x of the range of pose blockIdx.y,
+// triangle_ranges[pose] = {first triangle, triangle count}, NULL selects all triangles
+__global__ void rasterize_kernel(const float* vertices, const int* triangles, const int* triangle_objects,
+                                 int nr_triangles, const int* triangle_ranges,
+                                 const float* model_poses, int nr_objects,
+                                 float fx, float fy, float cx, float cy, float near_plane, float far_plane,
+                                 int n_rows, int n_cols, unsigned int* depth_images) {
+    int triangle = blockIdx.x * blockDim.x + threadIdx.x;
+    int pose = blockIdx.y;
+    if (triangle_ranges != NULL) {
+        if (triangle >= triangle_ranges[2 * pose + 1]) return;
+        triangle += triangle_ranges[2 * pose];
+    } else if (triangle >= nr_triangles) {
+        return;
+    }
+
+    const float* m = model_poses + (pose * nr_objects + triangle_objects[triangle]) * 12;
+
+    // transform into the camera frame and project
+    float u[3], v[3], inverse_z[3];
+    for (int i = 0; i < 3; i++) {
+        const float* p = vertices + 3 * triangles[3 * triangle + i];
+
+        float x = m[0] * p[0] + m[1] * p[1] + m[2]  * p[2] + m[3];
+        float y = m[4] * p[0] + m[5] * p[1] + m[6]  * p[2] + m[7];
+        float z = m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11];
+
+        if (z < near_plane) return;
+
+        inverse_z[i] = 1.0f / z;
+        u[i] = fx * x * inverse_z[i] + cx;
+        v[i] = fy * y * inverse_z[i] + cy;
+    }
+
+    float area = (u[1] - u[0]) * (v[2] - v[0]) - (u[2] - u[0]) * (v[1] - v[0]);
+    if (fabsf(area) < 1e-12f) return;
+    float inverse_area = 1.0f / area;
+
+    // pixel centers have integer coordinates
+    int col_begin = max(0, (int) ceilf(fminf(u[0], fminf(u[1], u[2]))));
+    int col_end = min(n_cols - 1, (int) floorf(fmaxf(u[0], fmaxf(u[1], u[2]))));
+    int row_begin = max(0, (int) ceilf(fminf(v[0], fminf(v[1], v[2]))));
+    int row_end = min(n_rows - 1, (int) floorf(fmaxf(v[0], fmaxf(v[1], v[2]))));
+
+    unsigned int* depth_image = depth_images + pose * n_rows * n_cols;
+
+    for (int row = row_begin; row <= row_end; row++) {
+        for (int col = col_begin; col <= col_end; col++) {
+            // barycentric coordinates
+            float b0 = ((u[1] - col) * (v[2] - row) - (u[2] - col) * (v[1] - row)) * inverse_area;
+            float b1 = ((u[2] - col) * (v[0] - row) - (u[0] - col) * (v[2] - row)) * inverse_area;
+            float b2 = 1.0f - b0 - b1;
+            if (b0 < 0 || b1 < 0 || b2 < 0) continue;
+
+            // the inverse depth is linear in image space
+            float depth = 1.0f / (b0 * inverse_z[0] + b1 * inverse_z[1] + b2 * inverse_z[2]);
+            if (depth > far_plane) continue;
+
+            // positive floats are ordered like their bit patterns
+            atomicMin(depth_image + row * n_cols + col, __float_as_uint(depth));
+        }
+    }
+}
+
+
+
+__global__ void finalize_depth_kernel(unsigned int* depth_images, int size) {
+    int index = blockIdx.x * blockDim.x + threadIdx.x;
+    if (index < size && depth_images[index] == EMPTY_DEPTH) {
+        depth_images[index] = __float_as_uint(0.0f);
+    }
+}
+
+
+
+// ************************************************************************************** //
+// ============================ CUDA RASTERIZER MEMBER FUNCTIONS ========================= //
+// ************************************************************************************** //
+
+
+CudaRasterizer::CudaRasterizer(const std::vector<std::vector<float> >& vertices,
+                               const std::vector<std::vector<std::vector<int> > >& indices,
+                               const float camera_matrix[9],
+                               const int nr_rows,
+                               const int nr_cols,
+                               const float near_plane,
+                               const float far_plane) :
+    nr_rows_(nr_rows),
+    nr_cols_(nr_cols),
+    focal_length_x_(camera_matrix[0]),
+    focal_length_y_(camera_matrix[4]),
+    principal_point_x_(camera_matrix[2]),
+    principal_point_y_(camera_matrix[5]),
+    near_plane_(near_plane),
+    far_plane_(far_plane),
+    nr_objects_(vertices.size()),
+    max_nr_poses_(0),
+    nr_poses_(0),
+    d_poses_(NULL),
+    d_model_poses_(NULL),
+    h_poses_(NULL),
+    d_triangle_ranges_(NULL),
+    h_triangle_ranges_(NULL),
+    d_depth_images_(NULL)
+{
+    cudaGetDevice(&device_);
+
+    // concatenate the meshes of all objects
+    vector<float> vertices_list;
+    vector<int> triangles_list;
+    vector<int> triangle_objects;
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        first_triangles_.push_back(triangle_objects.size());
+        int vertex_offset = vertices_list.size() / 3;
+        vertices_list.insert(vertices_list.end(), vertices[i].begin(), vertices[i].end());
+
+        for (size_t j = 0; j < indices[i].size(); j++) {
+            for (size_t k = 0; k < 3; k++) {
+                triangles_list.push_back(indices[i][j][k] + vertex_offset);
+            }
+            triangle_objects.push_back(i);
+        }
+    }
+
+    nr_vertices_ = vertices_list.size() / 3;
+    nr_triangles_ = triangle_objects.size();
+    first_triangles_.push_back(nr_triangles_);
+
+    cudaMalloc((void **) &d_vertices_, vertices_list.size() * sizeof(float));
+    cudaMalloc((void **) &d_triangles_, triangles_list.size() * sizeof(int));
+    cudaMalloc((void **) &d_triangle_objects_, triangle_objects.size() * sizeof(int));
+    #ifdef DEBUG
+        check_cuda_error("cudaMalloc meshes");
+    #endif
+
+    cudaMemcpy(d_vertices_, &vertices_list[0], vertices_list.size() * sizeof(float), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_triangles_, &triangles_list[0], triangles_list.size() * sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_triangle_objects_, &triangle_objects[0], triangle_objects.size() * sizeof(int),
+               cudaMemcpyHostToDevice);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy meshes");
+    #endif
+
+    cudaEventCreateWithFlags(&poses_uploaded_, cudaEventDisableTiming);
+}
+
+
+
+void CudaRasterizer::allocate_memory_for_max_poses(int nr_poses) {
+    cudaDeviceProp props;
+    int device;
+    cudaGetDevice(&device);
+    cudaGetDeviceProperties(&props, device);
+
+    // the poses are distributed over the y dimension of the grid
+    if (nr_poses > props.maxGridSize[1]) {
+        std::cout << "ERROR (CUDA): The CUDA rasterizer supports at most "
+                  << props.maxGridSize[1] << " poses (" << nr_poses << " requested)." << std::endl;
+        exit(-1);
+    }
+
+    // no pending upload may read the staging buffer while reallocating it
+    cudaEventSynchronize(poses_uploaded_);
+
+    max_nr_poses_ = nr_poses;
+
+    cudaFree(d_poses_);
+    cudaFree(d_model_poses_);
+    cudaFree(d_depth_images_);
+    cudaFreeHost(h_poses_);
+    cudaFree(d_triangle_ranges_);
+    cudaFreeHost(h_triangle_ranges_);
+
+    cudaMalloc((void **) &d_poses_, (max_nr_poses_ + 1) * nr_objects_ * 12 * sizeof(float));
+    cudaMalloc((void **) &d_model_poses_, max_nr_poses_ * nr_objects_ * 12 * sizeof(float));
+    cudaMalloc((void **) &d_depth_images_, max_nr_poses_ * nr_rows_ * nr_cols_ * sizeof(float));
+    cudaHostAlloc((void **) &h_poses_, (max_nr_poses_ + 1) * nr_objects_ * 12 * sizeof(float),
+                  cudaHostAllocDefault);
+    cudaMalloc((void **) &d_triangle_ranges_, max_nr_poses_ * 2 * sizeof(int));
+    cudaHostAlloc((void **) &h_triangle_ranges_, max_nr_poses_ * 2 * sizeof(int), cudaHostAllocDefault);
+    #ifdef DEBUG
+        check_cuda_error("allocate_memory_for_max_poses");
+    #endif
+}
+
+
+
+void CudaRasterizer::render(const std::vector<float>& default_poses,
+                            const float* deltas,
+                            const int nr_poses,
+                            cudaStream_t stream,
+                            const ObjectRange* object_ranges) {
+    if (nr_poses > max_nr_poses_) {
+        std::cout << "ERROR (CUDA): You tried to render more poses ("
+                  << nr_poses << ") than specified by max_poses ("
+                  << max_nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+    if (default_poses.size() != size_t(nr_objects_ * 12)) {
+        std::cout << "ERROR (CUDA): Expected " << nr_objects_ << " default poses." << std::endl;
+        exit(-1);
+    }
+
+    nr_poses_ = nr_poses;
+    if (nr_poses_ == 0) return;
+
+    int nr_pose_values = (nr_poses_ + 1) * nr_objects_ * 12;
+    int nr_pixels = nr_poses_ * nr_rows_ * nr_cols_;
+
+    // the staging buffer may still be read by the previous upload
+    cudaEventSynchronize(poses_uploaded_);
+    std::copy(default_poses.begin(), default_poses.end(), h_poses_);
+    std::copy(deltas, deltas + nr_poses_ * nr_objects_ * 12, h_poses_ + nr_objects_ * 12);
+
+    cudaMemcpyAsync(d_poses_, h_poses_, nr_pose_values * sizeof(float), cudaMemcpyHostToDevice, stream);
+
+    // the grid covers the largest range, the threads beyond the range of a pose return
+    int nr_launched_triangles = nr_triangles_;
+    const int* triangle_ranges = NULL;
+    if (object_ranges != NULL) {
+        nr_launched_triangles = 0;
+        for (int i = 0; i < nr_poses_; i++) {
+            const ObjectRange& range = object_ranges[i];
+            if (range.first < 0 || range.count < 0 || range.first + range.count > nr_objects_) {
+                std::cout << "ERROR (CUDA): The objects [" << range.first << ", "
+                          << range.first + range.count << ") of pose " << i
+                          << " exceed the " << nr_objects_ << " objects." << std::endl;
+                exit(-1);
+            }
+            const int first = first_triangles_[range.first];
+            h_triangle_ranges_[2 * i] = first;
+            h_triangle_ranges_[2 * i + 1] = first_triangles_[range.first + range.count] - first;
+            nr_launched_triangles = max(nr_launched_triangles, h_triangle_ranges_[2 * i + 1]);
+        }
+        cudaMemcpyAsync(d_triangle_ranges_, h_triangle_ranges_, nr_poses_ * 2 * sizeof(int),
+                        cudaMemcpyHostToDevice, stream);
+        triangle_ranges = d_triangle_ranges_;
+    }
+    cudaEventRecord(poses_uploaded_, stream);
+
+    compose_poses_kernel <<< (nr_poses_ * nr_objects_ + NR_THREADS - 1) / NR_THREADS, NR_THREADS, 0, stream >>> (
+        d_poses_, d_model_poses_, nr_objects_, nr_poses_);
+    #ifdef DEBUG
+        check_cuda_error("compose poses kernel call");
+    #endif
+
+    unsigned int* depth_images = (unsigned int*) d_depth_images_;
+    cudaMemsetAsync(depth_images, 0xFF, nr_pixels * sizeof(float), stream);
+
+    if (nr_launched_triangles > 0) {
+        dim3 grid_dimension((nr_launched_triangles + NR_THREADS - 1) / NR_THREADS, nr_poses_);
+        rasterize_kernel <<< grid_dimension, NR_THREADS, 0, stream >>> (
+            d_vertices_, d_triangles_, d_triangle_objects_, nr_triangles_, triangle_ranges,
+            d_model_poses_, nr_objects_,
+            focal_length_x_, focal_length_y_, principal_point_x_, principal_point_y_, near_plane_, far_plane_,
+            nr_rows_, nr_cols_, depth_images);
+        #ifdef DEBUG
+            check_cuda_error("rasterize kernel call");
+        #endif
+    }
+
+    finalize_depth_kernel <<< (nr_pixels + NR_THREADS - 1) / NR_THREADS, NR_THREADS, 0, stream >>> (
+        depth_images, nr_pixels);
+    #ifdef DEBUG
+        check_cuda_error("finalize depth kernel call");
+    #endif
+}
+
+
+
+const float* CudaRasterizer::get_depth_images() const {
+    return d_depth_images_;
+}
+
+
+
+vector<vector<float> > CudaRasterizer::get_depth_values(int nr_poses) {
+    if (nr_poses > nr_poses_) {
+        std::cout << "ERROR (CUDA): You tried to read back the depth values "
+                  << "of more poses than you previously rendered." << std::endl;
+        exit(-1);
+    }
+
+    cudaDeviceSynchronize();
+
+    int nr_pixels = nr_rows_ * nr_cols_;
+    vector<vector<float> > depth_values(nr_poses, vector<float>(nr_pixels));
+    for (int i = 0; i < nr_poses; i++) {
+        cudaMemcpy(&depth_values[i][0], d_depth_images_ + i * nr_pixels, nr_pixels * sizeof(float),
+                   cudaMemcpyDeviceToHost);
+    }
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy d_depth_images -> depth_values");
+    #endif
+
+    return depth_values;
+}
+
+
+
+void CudaRasterizer::get_memory_need_parameters(int nr_rows, int nr_cols,
+                                                int& constant_need, int& per_pose_need) {
+    // planned ahead by dbot::GpuMemoryPlanner, which has to match
+    constant_need = (3 * nr_vertices_ + 4 * nr_triangles_ + 12 * nr_objects_) * sizeof(float);
+    per_pose_need = (nr_rows * nr_cols + 2 * 12 * nr_objects_) * sizeof(float) + 2 * sizeof(int);
+}
+
+
+
+void CudaRasterizer::check_cuda_error(const char *msg)
+{
+    cudaError_t err = cudaGetLastError();
+    if( cudaSuccess != err)
+    {
+        fprintf(stderr, "Cuda error: %s: %s.\n", msg, cudaGetErrorString( err) );
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+CudaRasterizer::~CudaRasterizer() {
+    cudaSetDevice(device_);
+    cudaEventSynchronize(poses_uploaded_);
+    cudaEventDestroy(poses_uploaded_);
+
+    cudaFree(d_vertices_);
+    cudaFree(d_triangles_);
+    cudaFree(d_triangle_objects_);
+    cudaFree(d_poses_);
+    cudaFree(d_model_poses_);
+    cudaFree(d_depth_images_);
+    cudaFreeHost(h_poses_);
+    cudaFree(d_triangle_ranges_);
+    cudaFreeHost(h_triangle_ranges_);
+}
@@ -0,0 +1,168 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cuda_rasterizer.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cuda_runtime.h>
+
+/**
+ * \brief Renders the depth images of object meshes in many poses with CUDA.
+ *
+ * This is a drop-in replacement of the ObjectRasterizer for the likelihood
+ * evaluation which requires neither an OpenGL context nor any interop. The
+ * depth images are written into device memory, one image per pose in row
+ * major order with the first row at the top, which is the layout of the
+ * observations. Pixels not covered by any object have a depth of 0.
+ *
+ * Each thread rasterizes one triangle of one pose and resolves the visibility
+ * with an atomic minimum on the depth. A pose may be restricted to a range of
+ * objects, in which case only the triangles of those objects are launched
+ * for it and the other objects are absent from its image. As in the OpenGL
+ * pipeline, the depth
+ * is the z coordinate in the camera frame and back faces are not culled.
+ * Triangles crossing the near plane are dropped instead of being clipped.
+ *
+ * All work is issued asynchronously on the stream passed to render(). The
+ * rasterizer lives on the device which is current during construction, and
+ * that device has to be current whenever a member function is called.
+ */
+class CudaRasterizer
+{
+public:
+    /** \brief Objects [first, first + count) rendered in one pose */
+    struct ObjectRange
+    {
+        int first;
+        int count;
+    };
+
+    /**
+     * \brief constructor which uploads the object meshes
+     *
+     * \param [in] vertices [object_nr][3 * vertex_nr + 0 - 2] = {x, y, z}
+     * \param [in] indices [object_nr][triangle_nr][0 - 2] = {index}. For each
+     * object, the indices should be in the range of [0, nr_vertices - 1].
+     * \param [in] camera_matrix the intrinsic camera matrix in row major order
+     * \param [in] nr_rows the number of rows in one sensor image
+     * \param [in] nr_cols the number of columns in one sensor image
+     * \param [in] near_plane everything closer than the near plane will not
+     * be rendered
+     * \param [in] far_plane everything further away than the far plane will
+     * not be rendered
+     */
+    CudaRasterizer(const std::vector<std::vector<float> >& vertices,
+                   const std::vector<std::vector<std::vector<int> > >& indices,
+                   const float camera_matrix[9],
+                   const int nr_rows,
+                   const int nr_cols,
+                   const float near_plane = 0.4,
+                   const float far_plane = 4);
+
+    /** \brief destructor which frees the device memory */
+    ~CudaRasterizer();
+
+    /**
+     * \brief allocates the depth images and pose buffers of the maximum number
+     * of poses that will be rendered in one call
+     */
+    void allocate_memory_for_max_poses(int nr_poses);
+
+    /**
+     * \brief renders the objects in poses given relative to default poses,
+     * see ObjectRasterizer::render()
+     *
+     * \param [in] default_poses [object_nr][0 - 11] = {first three rows of
+     * the homogeneous transformation of that object in row major order}
+     * \param [in] deltas [pose_nr][object_nr][0 - 11] = {first three rows of
+     * the homogeneous relative transformation in row major order}
+     * \param [in] nr_poses the number of poses to render
+     * \param [in] stream the stream on which the rendering is issued
+     * \param [in] object_ranges [pose_nr] = {objects rendered in that pose},
+     * NULL renders all objects in every pose
+     */
+    void render(const std::vector<float>& default_poses,
+                const float* deltas,
+                const int nr_poses,
+                cudaStream_t stream,
+                const ObjectRange* object_ranges = NULL);
+
+    /**
+     * \brief returns the device pointer to the depth images of the last
+     * render() call, [pose_nr][pixel_nr] = {depth}. The images are complete
+     * once the work on the rendering stream has completed.
+     */
+    const float* get_depth_images() const;
+
+    /**
+     * \brief copies the depth images of the first nr_poses poses to the host.
+     * This synchronizes with the device and should only be used for debugging.
+     */
+    std::vector<std::vector<float> > get_depth_values(int nr_poses);
+
+    /**
+     * \brief returns the constant and per-pose memory needs of the rasterizer
+     * (in bytes)
+     */
+    void get_memory_need_parameters(int nr_rows, int nr_cols,
+                                    int& constant_need, int& per_pose_need);
+
+private:
+    int device_;
+
+    // resolution and camera
+    int nr_rows_;
+    int nr_cols_;
+    float focal_length_x_;
+    float focal_length_y_;
+    float principal_point_x_;
+    float principal_point_y_;
+    float near_plane_;
+    float far_plane_;
+
+    // meshes, the triangles reference the vertices of all objects and the
+    // triangles of object i are [first_triangles_[i], first_triangles_[i + 1])
+    int nr_objects_;
+    int nr_vertices_;
+    int nr_triangles_;
+    std::vector<int> first_triangles_;
+    float* d_vertices_;
+    int* d_triangles_;
+    int* d_triangle_objects_;
+
+    // default poses followed by the deltas of all poses, the composed poses
+    // and the pinned host staging buffer of the upload
+    int max_nr_poses_;
+    int nr_poses_;
+    float* d_poses_;
+    float* d_model_poses_;
+    float* h_poses_;
+    cudaEvent_t poses_uploaded_;
+
+    // first triangle and triangle count of each pose, uploaded along with
+    // the poses
+    int* d_triangle_ranges_;
+    int* h_triangle_ranges_;
+
+    // depth images of all poses, accumulated as the bit patterns of the
+    // positive depths
+    float* d_depth_images_;
+
+    void check_cuda_error(const char* msg);
+};
@@ -0,0 +1,369 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gl_likelihood_evaluator.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <GL/glew.h>
+#include <dbot/default_shader_provider.hpp>
+#include <dbot/gpu/shader.hpp>
+#include <dbot/gpu/gl_likelihood_evaluator.hpp>
+
+using namespace std;
+
+// guaranteed number of work groups per dimension of a dispatch
+static const int MAX_NR_WORK_GROUPS = 65535;
+
+GLLikelihoodEvaluator::GLLikelihoodEvaluator(const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
+                                             const int nr_rows,
+                                             const int nr_cols) :
+    nr_rows_(nr_rows),
+    nr_cols_(nr_cols),
+    max_nr_poses_(0),
+    nr_poses_(0),
+    nr_poses_per_row_(0),
+    nr_poses_per_column_(0),
+    max_nr_poses_per_row_(0),
+    max_nr_poses_per_column_(0),
+    observation_time_(0),
+    occlusion_time_(0),
+    constants_initialized_(false),
+    memory_allocated_(false),
+    number_of_poses_set_(false),
+    observations_set_(false),
+    occlusion_indices_set_(false)
+{
+    // compute shaders are core since OpenGL 4.3
+    if (!GLEW_VERSION_4_3 && !GLEW_ARB_compute_shader) {
+        std::cout << "ERROR (OPENGL): The OpenGL context does not support compute shaders, "
+                  << "which are required to weigh the poses without CUDA." << std::endl;
+        exit(-1);
+    }
+
+    std::string compute_shader = shader_provider && shader_provider->has_compute_shader()
+                                 ? shader_provider->compute_shader()
+                                 : dbot::DefaultShaderProvider().compute_shader();
+
+    program_ = LoadComputeShader(compute_shader);
+
+    depths_ID_ = glGetUniformLocation(program_, "depths");
+    nr_rows_ID_ = glGetUniformLocation(program_, "nr_rows");
+    nr_cols_ID_ = glGetUniformLocation(program_, "nr_cols");
+    nr_poses_ID_ = glGetUniformLocation(program_, "nr_poses");
+    nr_poses_per_row_ID_ = glGetUniformLocation(program_, "nr_poses_per_row");
+    nr_poses_per_column_ID_ = glGetUniformLocation(program_, "nr_poses_per_column");
+    update_occlusions_ID_ = glGetUniformLocation(program_, "update_occlusions");
+    occlusion_scale_ID_ = glGetUniformLocation(program_, "occlusion_scale");
+    occlusion_offset_ID_ = glGetUniformLocation(program_, "occlusion_offset");
+
+    glGenBuffers(1, &observations_buffer_);
+    glGenBuffers(1, &occlusion_indices_buffer_);
+    glGenBuffers(1, &occlusions_buffer_);
+    glGenBuffers(1, &new_occlusions_buffer_);
+    glGenBuffers(1, &log_likelihoods_buffer_);
+
+    // the observations never change their size
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, observations_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, nr_rows_ * nr_cols_ * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    check_GL_errors("compute shader initialization");
+}
+
+
+void GLLikelihoodEvaluator::init(const float initial_occlusion_prob, const float p_occluded_occluded, const float p_occluded_visible,
+                                 const float tail_weight, const float model_sigma, const float sigma_factor, const float max_depth, const float exponential_rate) {
+
+    occlusion_time_ = 0;
+    occlusion_prob_default_ = initial_occlusion_prob;
+
+    // the occlusion transition coefficients are computed on the host once per weighting
+    float c = p_occluded_occluded - p_occluded_visible;
+    p_occluded_occluded_ = p_occluded_occluded;
+    one_div_c_minus_one_ = 1.0f / (c - 1.0f);
+    log_c_ = log(c);
+
+    GLint previous_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glUseProgram(program_);
+
+    glUniform1f(glGetUniformLocation(program_, "model_sigma"), model_sigma);
+    glUniform1f(glGetUniformLocation(program_, "sigma_factor"), sigma_factor);
+    glUniform1f(glGetUniformLocation(program_, "tail_weight_div_max_depth"), tail_weight / max_depth);
+    glUniform1f(glGetUniformLocation(program_, "one_minus_tail_weight"), 1.0f - tail_weight);
+    glUniform1f(glGetUniformLocation(program_, "exponential_rate"), exponential_rate);
+    glUniform1i(nr_rows_ID_, nr_rows_);
+    glUniform1i(nr_cols_ID_, nr_cols_);
+
+    glUseProgram(previous_program);
+    check_GL_errors("compute shader constants");
+
+    constants_initialized_ = true;
+}
+
+
+void GLLikelihoodEvaluator::allocate_memory_for_max_poses(int nr_poses,
+                                                          int nr_poses_per_row,
+                                                          int nr_poses_per_col) {
+    if (!constants_initialized_) {
+        std::cout << "WARNING (OPENGL): It seems you forgot to call init before "
+                  << "allocate_memory_for_max_poses." << std::endl;
+    }
+
+    if (nr_poses_per_row * nr_poses_per_col < nr_poses) {
+        std::cout << "ERROR (OPENGL): The arrangement of " << nr_poses_per_row << " x "
+                  << nr_poses_per_col << " poses cannot hold " << nr_poses << " poses." << std::endl;
+        exit(-1);
+    }
+
+    max_nr_poses_ = nr_poses;
+    max_nr_poses_per_row_ = nr_poses_per_row;
+    max_nr_poses_per_column_ = nr_poses_per_col;
+    nr_poses_ = nr_poses;
+    nr_poses_per_row_ = nr_poses_per_row;
+    nr_poses_per_column_ = nr_poses_per_col;
+
+    GLsizeiptr occlusions_size = GLsizeiptr(max_nr_poses_) * nr_rows_ * nr_cols_ * sizeof(float);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, occlusion_indices_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, max_nr_poses_ * sizeof(int), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, occlusions_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, occlusions_size, NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, new_occlusions_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, occlusions_size, NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, log_likelihoods_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, max_nr_poses_ * sizeof(float), NULL, GL_STREAM_READ);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    GLenum error = glGetError();
+    if (error == GL_OUT_OF_MEMORY) {
+        std::cout << "ERROR (OPENGL): Not enough memory to allocate " << nr_poses
+                  << " poses for the compute shader." << std::endl;
+        exit(-1);
+    }
+
+    // the occlusion probabilities of all poses start at the default
+    std::vector<float> occlusion_probabilities(max_nr_poses_ * nr_rows_ * nr_cols_,
+                                               occlusion_prob_default_);
+    set_occlusion_probabilities(occlusion_probabilities.data(), occlusion_probabilities.size());
+
+    memory_allocated_ = true;
+    number_of_poses_set_ = true;
+    occlusion_indices_set_ = false;
+}
+
+
+void GLLikelihoodEvaluator::set_number_of_poses(int nr_poses) {
+    if (max_nr_poses_ == 0) {
+        std::cout << "WARNING (OPENGL): It seems you forgot to call "
+                  << "allocate_memory_for_max_poses before calling "
+                  << "set_number_of_poses." << std::endl;
+        return;
+    }
+
+    if (nr_poses > max_nr_poses_) {
+        std::cout << "ERROR (OPENGL): You tried to evaluate more poses ("
+                  << nr_poses << ") than specified by max_poses ("
+                  << max_nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    // the rasterizer arranges the poses the same way
+    nr_poses_ = nr_poses;
+    nr_poses_per_row_ = min(max_nr_poses_per_row_, nr_poses);
+    nr_poses_per_column_ = min(max_nr_poses_per_column_,
+                               (int) ceil(nr_poses / (float) max(nr_poses_per_row_, 1)));
+
+    number_of_poses_set_ = true;
+}
+
+
+void GLLikelihoodEvaluator::set_observations(const float* observations, const float observation_time) {
+    observation_time_ = observation_time;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, observations_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, nr_rows_ * nr_cols_ * sizeof(float), observations);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    observations_set_ = true;
+}
+
+
+void GLLikelihoodEvaluator::set_occlusion_indices(const int* occlusion_indices, const int array_size) {
+    if (array_size > max_nr_poses_) {
+        std::cout << "ERROR (OPENGL) in set_occlusion_indices: You exceeded "
+                  << "(" << array_size << ")"
+                  << "the memory space that was allocated for the occlusion "
+                  << "indices (" << max_nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, occlusion_indices_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, array_size * sizeof(int), occlusion_indices);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    occlusion_indices_set_ = true;
+}
+
+
+void GLLikelihoodEvaluator::set_occlusion_probabilities(const float* occlusion_probabilities,
+                                                        const int array_size) {
+    if (array_size > max_nr_poses_ * nr_rows_ * nr_cols_) {
+        std::cout << "ERROR (OPENGL) in set_occlusion_probabilities: You exceeded "
+                  << "(" << array_size << ")"
+                  << "the memory space that was allocated for the occlusion "
+                  << "probabilities (" << max_nr_poses_ * nr_rows_ * nr_cols_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, occlusions_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, array_size * sizeof(float), occlusion_probabilities);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+
+vector<float> GLLikelihoodEvaluator::get_occlusion_probabilities(int state_id) {
+    if (!memory_allocated_) {
+        std::cout << "WARNING (OPENGL): It seems you forgot to call "
+                  << "allocate_memory_for_max_poses before calling "
+                  << "get_occlusion_probabilities." << std::endl;
+        return vector<float>();
+    }
+
+    int nr_pixels = nr_rows_ * nr_cols_;
+    vector<float> occlusion_probabilities(nr_pixels);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, occlusions_buffer_);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, GLintptr(state_id) * nr_pixels * sizeof(float),
+                       nr_pixels * sizeof(float), &occlusion_probabilities[0]);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return occlusion_probabilities;
+}
+
+
+void GLLikelihoodEvaluator::weigh_poses(const GLuint depth_texture,
+                                        const bool update_occlusions,
+                                        vector<float>& log_likelihoods) {
+    if (!(observations_set_ && occlusion_indices_set_ && memory_allocated_
+          && number_of_poses_set_ && constants_initialized_)) {
+        std::cout << "WARNING (OPENGL): It seems you forgot to do one of the following: set observation image, set occlusion"
+                  << " indices, set number of poses, allocate memory or inisitialize constants." << std::endl;
+        return;
+    }
+
+    double delta_time = observation_time_ - occlusion_time_;
+    if (update_occlusions) occlusion_time_ = observation_time_;
+
+    // all pixels share the same time delta, hence the transition is computed once
+    float occlusion_scale, occlusion_offset;
+    get_occlusion_transition(delta_time, occlusion_scale, occlusion_offset);
+
+    // the rasterizer keeps its program in use between the render calls
+    GLint previous_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glUseProgram(program_);
+
+    glUniform1i(nr_poses_ID_, nr_poses_);
+    glUniform1i(nr_poses_per_row_ID_, nr_poses_per_row_);
+    glUniform1i(nr_poses_per_column_ID_, nr_poses_per_column_);
+    glUniform1i(update_occlusions_ID_, update_occlusions);
+    glUniform1f(occlusion_scale_ID_, occlusion_scale);
+    glUniform1f(occlusion_offset_ID_, occlusion_offset);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depth_texture);
+    glUniform1i(depths_ID_, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, observations_buffer_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, occlusion_indices_buffer_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, occlusions_buffer_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, new_occlusions_buffer_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, log_likelihoods_buffer_);
+
+    // one work group per pose, the groups beyond the last pose return at once
+    int nr_groups_x = min(nr_poses_, MAX_NR_WORK_GROUPS);
+    int nr_groups_y = (nr_poses_ + nr_groups_x - 1) / max(nr_groups_x, 1);
+    if (nr_poses_ > 0) glDispatchCompute(nr_groups_x, nr_groups_y, 1);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(previous_program);
+
+    // switch to new occlusion probabilities
+    if (update_occlusions) std::swap(occlusions_buffer_, new_occlusions_buffer_);
+
+    // the download and the next dispatch wait for this dispatch
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    if (log_likelihoods.size() < size_t(nr_poses_)) {
+        log_likelihoods.resize(nr_poses_);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, log_likelihoods_buffer_);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, nr_poses_ * sizeof(float), &log_likelihoods[0]);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    #ifdef DEBUG
+        check_GL_errors("compute shader weighting");
+    #endif
+}
+
+
+void GLLikelihoodEvaluator::get_memory_need_parameters(int nr_rows, int nr_cols,
+                                                       int& constant_need, int& per_pose_need) {
+    constant_need = nr_rows * nr_cols * sizeof(float);
+    per_pose_need = 2 * sizeof(float) + 2 * nr_rows * nr_cols * sizeof(float);
+}
+
+
+void GLLikelihoodEvaluator::get_occlusion_transition(const double delta_time,
+                                                     float& scale, float& offset) const {
+    // p -> c^t p + 1 - c^t - (1 - p_oo)(c^t - 1)/(c - 1), see CudaEvaluator
+    scale = 1;
+    offset = 0;
+    if (!std::isnan(delta_time)) {
+        scale = exp(delta_time * log_c_);
+        offset = 1 - scale - (1 - p_occluded_occluded_) * (scale - 1) * one_div_c_minus_one_;
+    }
+}
+
+
+void GLLikelihoodEvaluator::check_GL_errors(const char *label) {
+    GLenum errCode;
+    const GLubyte *errStr;
+    if ((errCode = glGetError()) != GL_NO_ERROR) {
+        errStr = gluErrorString(errCode);
+        printf("OpenGL ERROR: ");
+        printf("%s", (char*)errStr);
+        printf("(Label: ");
+        printf("%s", label);
+        printf(")\n.");
+    }
+}
+
+
+GLLikelihoodEvaluator::~GLLikelihoodEvaluator() {
+    glDeleteBuffers(1, &observations_buffer_);
+    glDeleteBuffers(1, &occlusion_indices_buffer_);
+    glDeleteBuffers(1, &occlusions_buffer_);
+    glDeleteBuffers(1, &new_occlusions_buffer_);
+    glDeleteBuffers(1, &log_likelihoods_buffer_);
+    glDeleteProgram(program_);
+}
@@ -0,0 +1,182 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gl_likelihood_evaluator.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "GL/glew.h"
+
+#include <dbot/gpu/shader_provider.hpp>
+
+/**
+ * \brief Weighs the poses rendered by the ObjectRasterizer with OpenGL
+ *        compute shaders, the counterpart of the CudaEvaluator for GPUs
+ *        without CUDA.
+ *
+ * The compute shader reads the framebuffer texture of the rasterizer
+ * directly, there is no mapping of the texture between two APIs. It
+ * evaluates the same pixel model and occlusion process as the CUDA kernel,
+ * without the tiles, the likelihood table, the rejection and the reduced
+ * precisions of the occlusion probabilities.
+ *
+ * The functions have to be called in the same order as those of the
+ * CudaEvaluator:
+ * init -> allocate_memory_for_max_poses -> set_number_of_poses   }
+ *                                       -> set_occlusion_indices } -> weigh_poses
+ *                                       -> set_observations      }
+ *
+ * All functions issue OpenGL commands, the context of the rasterizer has to
+ * be current, see ObjectRasterizer::make_current().
+ */
+class GLLikelihoodEvaluator
+{
+public:
+    /**
+     * \brief Constructor which compiles the compute shader
+     *
+     * \param [in] shader_provider
+     *     Provides the compute shader, the shader of the
+     *     DefaultShaderProvider is used if it has none
+     * \param [in] nr_rows
+     *     The number of rows in each camera image
+     * \param [in] nr_cols
+     *     The number of columns in each camera image
+     */
+    GLLikelihoodEvaluator(const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
+                          const int nr_rows,
+                          const int nr_cols);
+
+    /** \brief Destructor which deletes the buffers and the program */
+    ~GLLikelihoodEvaluator();
+
+    /**
+     * \brief Sets the constants of the pixel model and the occlusion
+     *        process, see CudaEvaluator::init()
+     */
+    void init(const float initial_occlusion_prob,
+              const float p_occluded_occluded,
+              const float p_occluded_visible,
+              const float tail_weight,
+              const float model_sigma,
+              const float sigma_factor,
+              const float max_depth,
+              const float exponential_rate);
+
+    /**
+     * \brief Allocates the buffers for nr_poses poses, which are arranged in
+     *        the texture of the rasterizer in rows of nr_poses_per_row poses
+     */
+    void allocate_memory_for_max_poses(int nr_poses,
+                                       int nr_poses_per_row,
+                                       int nr_poses_per_col);
+
+    /** \brief Sets the number of poses weighed by the next weigh_poses() */
+    void set_number_of_poses(int nr_poses);
+
+    /**
+     * \brief Uploads the observed depths of all pixels, NaN where the sensor
+     *        has no measurement
+     * \param [in] observation_time the time of the observation in seconds,
+     *        which determines the occlusion transition since the last update
+     */
+    void set_observations(const float* observations, const float observation_time);
+
+    /**
+     * \brief Sets for each pose the occlusion slot of its ancestor, whose
+     *        occlusion probabilities it continues
+     */
+    void set_occlusion_indices(const int* occlusion_indices, const int array_size);
+
+    /** \brief Sets the occlusion probabilities of the first slots */
+    void set_occlusion_probabilities(const float* occlusion_probabilities,
+                                     const int array_size);
+
+    /** \return the occlusion probabilities of all pixels of the slot state_id */
+    std::vector<float> get_occlusion_probabilities(int state_id);
+
+    /**
+     * \brief Weighs the poses rendered into depth_texture and downloads
+     *        their log likelihoods. This waits for the GPU.
+     * \param [in] depth_texture the framebuffer texture of the rasterizer,
+     *        see ObjectRasterizer::get_framebuffer_texture()
+     * \param [in] update_occlusions whether the occlusion probabilities of
+     *        pose i are updated and stored in slot i
+     * \param [out] log_likelihoods [pose_nr] = {log likelihood ratio}
+     */
+    void weigh_poses(const GLuint depth_texture,
+                     const bool update_occlusions,
+                     std::vector<float>& log_likelihoods);
+
+    /**
+     * \brief returns the constant and per-pose memory needs of the buffers
+     *        (in bytes), see ObjectRasterizer::get_memory_need_parameters()
+     */
+    void get_memory_need_parameters(int nr_rows, int nr_cols,
+                                    int& constant_need, int& per_pose_need);
+
+private:
+    void get_occlusion_transition(const double delta_time,
+                                  float& scale, float& offset) const;
+
+    void check_GL_errors(const char *label);
+
+    // resolution of the images
+    int nr_rows_;
+    int nr_cols_;
+
+    // arrangement of the poses in the texture
+    int max_nr_poses_;
+    int nr_poses_;
+    int nr_poses_per_row_;
+    int nr_poses_per_column_;
+    int max_nr_poses_per_row_;
+    int max_nr_poses_per_column_;
+
+    // constants of the occlusion process
+    float occlusion_prob_default_;
+    float p_occluded_occluded_;
+    float one_div_c_minus_one_;
+    float log_c_;
+    double observation_time_;
+    double occlusion_time_;
+
+    // compute program and the locations of its uniforms
+    GLuint program_;
+    GLint depths_ID_;
+    GLint nr_rows_ID_;
+    GLint nr_cols_ID_;
+    GLint nr_poses_ID_;
+    GLint nr_poses_per_row_ID_;
+    GLint nr_poses_per_column_ID_;
+    GLint update_occlusions_ID_;
+    GLint occlusion_scale_ID_;
+    GLint occlusion_offset_ID_;
+
+    // shader storage buffers, the occlusions are swapped on every update
+    GLuint observations_buffer_;
+    GLuint occlusion_indices_buffer_;
+    GLuint occlusions_buffer_;
+    GLuint new_occlusions_buffer_;
+    GLuint log_likelihoods_buffer_;
+
+    // booleans to ensure correct usage of function calls
+    bool constants_initialized_, memory_allocated_, number_of_poses_set_,
+         observations_set_, occlusion_indices_set_;
+};
@@ -0,0 +1,212 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_batched.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <dbot/traits.hpp>
+#include <dbot/model/rao_blackwell_sensor.hpp>
+#include <dbot/gpu/batch_evaluation_service.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Kinect image model which evaluates its states in the rounds of a
+ * BatchEvaluationService shared with the models of other trackers.
+ *
+ * The model evaluates the same likelihood as KinectImageModelCuda. loglikes()
+ * blocks until all clients of the service have submitted their states, hence
+ * every tracker sharing the service has to run in its own thread.
+ */
+template <typename State>
+class KinectImageModelBatched : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+
+    /**
+     * \brief constructor which registers the model as a client of the service
+     *
+     * \param [in] service the service shared with other models
+     * \param [in] max_sample_count the maximum number of states of one
+     * evaluation
+     * \param [in] vertices_double [object_nr][vertex_nr] = {x, y, z}
+     * \param [in] indices [object_nr][triangle_nr][0 - 2] = {index}
+     * \param [in] delta_time the time between two observations
+     */
+    KinectImageModelBatched(
+        const std::shared_ptr<BatchEvaluationService>& service,
+        const int max_sample_count,
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices_double,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const double delta_time = 0.033)
+        : Base(delta_time),
+          service_(service),
+          nr_max_poses_(max_sample_count),
+          nr_objects_(vertices_double.size()),
+          observation_time_(0)
+    {
+        this->default_poses_.recount(nr_objects_);
+        this->default_poses_.setZero();
+
+        std::vector<std::vector<float>> vertices(nr_objects_);
+        for (int i = 0; i < nr_objects_; ++i)
+        {
+            for (const auto& vertex : vertices_double[i])
+            {
+                vertices[i].push_back(vertex(0));
+                vertices[i].push_back(vertex(1));
+                vertices[i].push_back(vertex(2));
+            }
+        }
+
+        client_ = service_->add_client(vertices, indices, nr_max_poses_);
+    }
+
+    /** \brief destructor, the service no longer waits for this model */
+    virtual ~KinectImageModelBatched() noexcept
+    {
+        service_->remove_client(client_);
+    }
+
+    /**
+     * \brief computes the loglikelihoods for the given states, see
+     * KinectImageModelGPU::loglikes()
+     */
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& occlusion_indices,
+                       const bool& update_occlusions = false)
+    {
+        const int nr_poses = deltas.size();
+
+        occlusion_indices_.assign(occlusion_indices.data(),
+                                  occlusion_indices.data() + nr_poses);
+
+        packed_default_poses_.resize(nr_objects_ * 12);
+        for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+        {
+            Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                &packed_default_poses_[i_obj * 12]);
+            pose = this->default_poses_.component(i_obj)
+                       .homogeneous()
+                       .template topRows<3>()
+                       .template cast<float>();
+        }
+
+        pose_deltas_.resize(nr_poses * nr_objects_ * 12);
+        for (int i_state = 0; i_state < nr_poses; ++i_state)
+        {
+            for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+            {
+                auto delta = deltas[i_state].component(i_obj);
+
+                Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                    &pose_deltas_[(i_state * nr_objects_ + i_obj) * 12]);
+                pose.leftCols<3>() =
+                    delta.orientation().rotation_matrix().template cast<float>();
+                pose.col(3) = delta.position().template cast<float>();
+            }
+        }
+
+        flog_likelihoods_.resize(nr_poses);
+        service_->evaluate(client_,
+                           packed_default_poses_,
+                           pose_deltas_.data(),
+                           occlusion_indices_.data(),
+                           nr_poses,
+                           update_occlusions,
+                           flog_likelihoods_.data());
+
+        if (update_occlusions)
+        {
+            for (int i_state = 0; i_state < occlusion_indices.size(); ++i_state)
+            {
+                occlusion_indices[i_state] = i_state;
+            }
+        }
+
+        RealArray log_likelihoods(nr_poses);
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            log_likelihoods[i] = flog_likelihoods_[i];
+        }
+
+        return log_likelihoods;
+    }
+
+    /**
+     * \brief Sets the observation image that should be used for comparison in
+     * the next evaluation step
+     */
+    void set_observation(const Observation& image)
+    {
+        measurement_.assign(image.data(), image.data() + image.size());
+
+        set_observation(
+            DepthImageView(measurement_.data(), int(measurement_.size()), 1));
+    }
+
+    /**
+     * \brief Passes the depths of the view to the service without converting
+     * them
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        observation_time_ += this->delta_time_;
+
+        service_->set_observation(client_, image.data(), observation_time_);
+    }
+
+    /** \brief Resets the occlusion probabilities and observation time */
+    virtual void reset()
+    {
+        service_->reset(client_);
+        observation_time_ = 0;
+    }
+
+    int max_states() const { return nr_max_poses_; }
+
+    const BatchEvaluationService* batch_service() const
+    {
+        return service_.get();
+    }
+
+private:
+    std::shared_ptr<BatchEvaluationService> service_;
+    int client_;
+    int nr_max_poses_;
+    int nr_objects_;
+    double observation_time_;
+
+    // staging of the per call inputs
+    std::vector<int> occlusion_indices_;
+    std::vector<float> packed_default_poses_;
+    std::vector<float> pose_deltas_;
+    std::vector<float> flog_likelihoods_;
+    std::vector<float> measurement_;
+};
+}
@@ -0,0 +1,418 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_cuda.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <dbot/traits.hpp>
+#include <dbot/model/rao_blackwell_sensor.hpp>
+#include <dbot/model/kinect_pixel_model.hpp>
+#include <dbot/gpu/cuda_rasterizer.hpp>
+#include <dbot/gpu/cuda_likelihood_evaluator.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Kinect image model which renders the poses with the CudaRasterizer.
+ *
+ * The model evaluates the same likelihood as KinectImageModelGPU but neither
+ * creates an OpenGL context nor a window. The depth images are rendered into
+ * device memory and weighted on a single CUDA stream, which makes the model
+ * usable on headless machines.
+ */
+template <typename State>
+class KinectImageModelCuda : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+
+    typedef double Scalar;
+    typedef Eigen::Matrix<Scalar, 3, 3> CameraMatrix;
+
+    /**
+     * \brief constructor, see KinectImageModelGPU for the parameters
+     */
+    KinectImageModelCuda(
+        const CameraMatrix& camera_matrix,
+        const int nr_rows,
+        const int nr_cols,
+        const int max_sample_count,
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices_double,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const Scalar initial_occlusion_prob = 0.1,
+        const double delta_time = 0.033,
+        const float p_occluded_visible = 0.1f,
+        const float p_occluded_occluded = 0.7f,
+        const float tail_weight = 0.01f,
+        const float model_sigma = 0.003f,
+        const float sigma_factor = 0.0014247f,
+        const float max_depth = 6.0f,
+        const float exponential_rate = -std::log(0.5f),
+        const float max_approximation_error = 0.f,
+        const OcclusionPrecision occlusion_precision =
+            OcclusionPrecision::Single)
+        : Base(delta_time),
+          nr_rows_(nr_rows),
+          nr_cols_(nr_cols),
+          nr_max_poses_(max_sample_count),
+          nr_objects_(vertices_double.size()),
+          initial_occlusion_prob_(initial_occlusion_prob),
+          observation_time_(0),
+          observations_set_(false)
+    {
+        this->default_poses_.recount(nr_objects_);
+        this->default_poses_.setZero();
+
+        std::vector<std::vector<float>> vertices(nr_objects_);
+        for (int i = 0; i < nr_objects_; ++i)
+        {
+            for (const auto& vertex : vertices_double[i])
+            {
+                vertices[i].push_back(vertex(0));
+                vertices[i].push_back(vertex(1));
+                vertices[i].push_back(vertex(2));
+            }
+        }
+
+        float camera[9];
+        Eigen::Map<Eigen::Matrix<float, 3, 3, Eigen::RowMajor>> camera_map(
+            camera);
+        camera_map = camera_matrix.cast<float>();
+
+        rasterizer_ = std::make_shared<CudaRasterizer>(
+            vertices, indices, camera, nr_rows_, nr_cols_, 0.4, 4);
+        rasterizer_->allocate_memory_for_max_poses(nr_max_poses_);
+
+        cuda_ = std::make_shared<CudaEvaluator>(nr_rows_, nr_cols_);
+        cuda_->init(initial_occlusion_prob_,
+                    p_occluded_occluded,
+                    p_occluded_visible,
+                    tail_weight,
+                    model_sigma,
+                    sigma_factor,
+                    max_depth,
+                    exponential_rate);
+
+        KinectPixelModel pixel_model(tail_weight,
+                                     model_sigma,
+                                     sigma_factor,
+                                     -std::log(0.5) / exponential_rate,
+                                     max_depth);
+        if (max_approximation_error > 0)
+        {
+            pixel_model.approximate(max_approximation_error);
+
+            const auto& approximation = *pixel_model.approximation();
+            cuda_->set_likelihood_table(approximation.table,
+                                        approximation.data.data(),
+                                        approximation.data.size());
+        }
+
+        // nothing closer than the near plane of the rasterizer is rendered
+        max_log_ratio_ = pixel_model.max_log_likelihood_ratio(0.4);
+
+        cuda_->set_occlusion_precision(occlusion_precision);
+
+        // without a texture the poses only have to fit into the grid
+        const int max_grid_width =
+            cuda_->get_device_properties().maxGridSize[0];
+        const int nr_poses_per_row =
+            std::max(1, std::min(nr_max_poses_, max_grid_width));
+        const int nr_poses_per_column =
+            (nr_max_poses_ + nr_poses_per_row - 1) / nr_poses_per_row;
+        cuda_->allocate_memory_for_max_poses(
+            nr_max_poses_, nr_poses_per_row, nr_poses_per_column);
+
+        reset();
+    }
+
+    /**
+     * \brief computes the loglikelihoods for the given states, see
+     * KinectImageModelGPU::loglikes()
+     */
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& occlusion_indices,
+                       const bool& update_occlusions = false)
+    {
+        if (!observations_set_)
+        {
+            std::cout << "CUDA: observations not set" << std::endl;
+            exit(-1);
+        }
+
+        const int nr_poses = deltas.size();
+        if (nr_poses > nr_max_poses_)
+        {
+            std::cout << "CUDA: " << nr_poses << " poses exceed the maximum "
+                      << "of " << nr_max_poses_ << " poses" << std::endl;
+            exit(-1);
+        }
+
+        occlusion_indices_.assign(occlusion_indices.data(),
+                                  occlusion_indices.data() + nr_poses);
+        cuda_->set_occlusion_indices(occlusion_indices_.data(), nr_poses);
+
+        std::vector<float> default_poses(nr_objects_ * 12);
+        for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+        {
+            Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                &default_poses[i_obj * 12]);
+            pose = this->default_poses_.component(i_obj)
+                       .homogeneous()
+                       .template topRows<3>()
+                       .template cast<float>();
+        }
+
+        pose_deltas_.resize(nr_poses * nr_objects_ * 12);
+        for (int i_state = 0; i_state < nr_poses; ++i_state)
+        {
+            for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+            {
+                auto delta = deltas[i_state].component(i_obj);
+
+                Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                    &pose_deltas_[(i_state * nr_objects_ + i_obj) * 12]);
+                pose.leftCols<3>() =
+                    delta.orientation().rotation_matrix().template cast<float>();
+                pose.col(3) = delta.position().template cast<float>();
+            }
+        }
+
+        rasterizer_->render(
+            default_poses, pose_deltas_.data(), nr_poses, cuda_->stream());
+        cuda_->set_depth_images(rasterizer_->get_depth_images());
+        cuda_->set_number_of_poses(nr_poses);
+
+        std::vector<float> flog_likelihoods(nr_poses, 0);
+        cuda_->weigh_poses(update_occlusions, flog_likelihoods);
+
+        if (update_occlusions)
+        {
+            for (int i_state = 0; i_state < occlusion_indices.size(); ++i_state)
+            {
+                occlusion_indices[i_state] = i_state;
+            }
+        }
+
+        RealArray log_likelihoods(nr_poses);
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            log_likelihoods[i] = flog_likelihoods[i];
+        }
+
+        return log_likelihoods;
+    }
+
+    /**
+     * \brief Stops evaluating hopeless poses, see
+     * KinectImageModel::rejection_margin(). The bound of a pose covers the
+     * full image.
+     */
+    void rejection_margin(float margin)
+    {
+        cuda_->set_rejection_margin(margin, max_log_ratio_);
+    }
+
+    /**
+     * \brief Sets the observation image that should be used for comparison in
+     * the next evaluation step
+     */
+    void set_observation(const Observation& image)
+    {
+        set_observation(DepthImageView::copy(image, nr_rows_, nr_cols_));
+    }
+
+    /**
+     * \brief Uploads the depths of the view without converting them
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        observation_time_ += this->delta_time_;
+
+        cuda_->set_observations(image.data(), observation_time_);
+        observations_set_ = true;
+    }
+
+    /** \brief Resets the occlusion probabilities and observation time */
+    virtual void reset()
+    {
+        const int array_size = nr_rows_ * nr_cols_ * nr_max_poses_;
+        std::vector<float> occlusion_probabilities(array_size,
+                                                   initial_occlusion_prob_);
+
+        cuda_->set_occlusion_probabilities(occlusion_probabilities.data(),
+                                           array_size);
+
+        observation_time_ = 0;
+    }
+
+    /**
+     * \brief Writes the encoded occlusion probabilities of the states up to
+     *        the largest of \a indices and the observation time
+     */
+    void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        const int count =
+            indices.size() > 0 ? std::min(indices.maxCoeff() + 1, nr_max_poses_)
+                               : 0;
+
+        snapshot.write<std::uint8_t>(this->DeviceOcclusions);
+        snapshot.write(observation_time_);
+        snapshot.write(cuda_->get_occlusion_time());
+        snapshot.write<std::uint8_t>(
+            std::uint8_t(cuda_->get_occlusion_precision()));
+        snapshot.write<std::uint32_t>(nr_rows_);
+        snapshot.write<std::uint32_t>(nr_cols_);
+        snapshot.write<std::uint64_t>(count);
+        snapshot.write_vector(cuda_->get_encoded_occlusions(count));
+    }
+
+    int restore(Snapshot::Reader& reader)
+    {
+        if (reader.read<std::uint8_t>() != this->DeviceOcclusions)
+        {
+            throw InvalidSnapshotException(
+                "the snapshot holds no device occlusions");
+        }
+        const double observation_time = reader.read<double>();
+        const float occlusion_time = reader.read<float>();
+        const OcclusionPrecision precision = cuda_->get_occlusion_precision();
+        if (reader.read<std::uint8_t>() != std::uint8_t(precision))
+        {
+            throw InvalidSnapshotException(
+                "the occlusion precision does not match");
+        }
+        if (reader.read<std::uint32_t>() != std::uint32_t(nr_rows_) ||
+            reader.read<std::uint32_t>() != std::uint32_t(nr_cols_))
+        {
+            throw InvalidSnapshotException("the resolution does not match");
+        }
+        const std::uint64_t count = reader.read<std::uint64_t>();
+        std::vector<unsigned char> encoded;
+        reader.read_vector(encoded);
+        if (count > std::uint64_t(nr_max_poses_) ||
+            encoded.size() != count * nr_rows_ * nr_cols_ *
+                                  occlusion_bytes(precision))
+        {
+            throw InvalidSnapshotException(
+                "the occlusions do not fit the states");
+        }
+
+        // the slots beyond the snapshot hold the initial occlusions
+        reset();
+        if (count == 0) return 0;
+
+        cuda_->set_encoded_occlusions(encoded);
+        cuda_->set_occlusion_time(occlusion_time);
+        observation_time_ = observation_time;
+        return int(count);
+    }
+
+    int max_states() const { return nr_max_poses_; }
+
+    /**
+     * \return the occlusion probabilities of all pixels of the state \a index
+     */
+    Observation get_occlusions(int index) const
+    {
+        std::vector<float> occlusion_probs =
+            cuda_->get_occlusion_probabilities(index);
+
+        return Eigen::Map<Eigen::MatrixXf>(
+                   occlusion_probs.data(), nr_rows_, nr_cols_)
+            .cast<fl::Real>();
+    }
+
+    /**
+     * \brief Enqueues the download of the depth image and the occlusion
+     * probabilities of the state \a index of the last loglikes() call, see
+     * KinectImageModelGPU::request_readback()
+     */
+    void request_readback(int index) { cuda_->request_readback(index); }
+
+    /**
+     * \brief Copies the last requested readback into the given buffers if it
+     * has arrived, see KinectImageModelGPU::poll_readback()
+     */
+    bool poll_readback(Observation& depth_image, Observation& occlusions)
+    {
+        readback_depth_.resize(nr_rows_ * nr_cols_);
+        readback_occlusions_.resize(nr_rows_ * nr_cols_);
+
+        if (!cuda_->poll_readback(readback_depth_.data(),
+                                  readback_occlusions_.data()))
+        {
+            return false;
+        }
+
+        depth_image.resize(nr_rows_, nr_cols_);
+        occlusions.resize(nr_rows_, nr_cols_);
+        for (int i = 0; i < nr_rows_ * nr_cols_; ++i)
+        {
+            depth_image(i) = readback_depth_[i];
+            occlusions(i) = readback_occlusions_[i];
+        }
+
+        return true;
+    }
+
+    /**
+     * \return the depth images of the poses rendered in the last call of
+     * loglikes()
+     */
+    std::vector<std::vector<float>> get_range_image(int nr_poses)
+    {
+        return rasterizer_->get_depth_values(nr_poses);
+    }
+
+private:
+    int nr_rows_;
+    int nr_cols_;
+    int nr_max_poses_;
+    int nr_objects_;
+    float initial_occlusion_prob_;
+    double observation_time_;
+    bool observations_set_;
+
+    // upper bound of the per-pixel log likelihood ratios
+    float max_log_ratio_;
+
+    std::shared_ptr<CudaEvaluator> cuda_;
+    std::shared_ptr<CudaRasterizer> rasterizer_;
+
+    // staging of the per call inputs
+    std::vector<int> occlusion_indices_;
+    std::vector<float> pose_deltas_;
+
+    // host copies of the last collected readback
+    std::vector<float> readback_depth_;
+    std::vector<float> readback_occlusions_;
+};
+}
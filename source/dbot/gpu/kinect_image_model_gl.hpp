@@ -0,0 +1,329 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_gl.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <dbot/flat_mesh.hpp>
+#include <dbot/mesh_levels.hpp>
+#include <dbot/model/rao_blackwell_sensor.hpp>
+#include <dbot/model/distinct_particles.hpp>
+#include <dbot/gpu/object_rasterizer.hpp>
+#include <dbot/gpu/gl_likelihood_evaluator.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Kinect image model which renders the poses with the
+ * ObjectRasterizer and weighs them with the compute shader of the
+ * GLLikelihoodEvaluator.
+ *
+ * The model evaluates the same likelihood as KinectImageModelGPU with
+ * OpenGL alone, hence it runs on GPUs of any vendor and the rendered depths
+ * are never mapped into CUDA. The poses are rendered into full images.
+ * There is no tabulated pixel model, rejection or reduced precision of the
+ * occlusion probabilities.
+ */
+template <typename State>
+class KinectImageModelGL : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+
+    typedef double Scalar;
+    typedef Eigen::Matrix<Scalar, 3, 3> CameraMatrix;
+
+    /**
+     * \brief constructor, see KinectImageModelGPU for the parameters. The
+     * compute shader is taken from \a shader_provider if it provides one.
+     */
+    KinectImageModelGL(
+        const CameraMatrix& camera_matrix,
+        const int nr_rows,
+        const int nr_cols,
+        const int max_sample_count,
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices_double,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const std::shared_ptr<ShaderProvider>& shader_provider,
+        const Scalar initial_occlusion_prob = 0.1,
+        const double delta_time = 0.033,
+        const float p_occluded_visible = 0.1f,
+        const float p_occluded_occluded = 0.7f,
+        const float tail_weight = 0.01f,
+        const float model_sigma = 0.003f,
+        const float sigma_factor = 0.0014247f,
+        const float max_depth = 6.0f,
+        const float exponential_rate = -std::log(0.5f))
+        : Base(delta_time),
+          nr_rows_(nr_rows),
+          nr_cols_(nr_cols),
+          nr_max_poses_(max_sample_count),
+          nr_objects_(vertices_double.size()),
+          initial_occlusion_prob_(initial_occlusion_prob),
+          observation_time_(0),
+          observations_set_(false)
+    {
+        this->default_poses_.recount(nr_objects_);
+        this->default_poses_.setZero();
+
+        opengl_ = std::make_shared<ObjectRasterizer>(
+            std::make_shared<FlatMesh>(vertices_double, indices),
+            shader_provider,
+            camera_matrix.cast<float>(),
+            nr_rows_,
+            nr_cols_,
+            0.4,
+            4);
+
+        // the compute shader runs in the context of the rasterizer
+        gl_ = std::make_shared<GLLikelihoodEvaluator>(
+            shader_provider, nr_rows_, nr_cols_);
+        gl_->init(initial_occlusion_prob_,
+                  p_occluded_occluded,
+                  p_occluded_visible,
+                  tail_weight,
+                  model_sigma,
+                  sigma_factor,
+                  max_depth,
+                  exponential_rate);
+
+        // the poses are arranged in rows which fit into the texture
+        const int max_texture_size = opengl_->get_max_texture_size();
+        const int nr_poses_per_row = std::max(
+            1, std::min(nr_max_poses_, max_texture_size / nr_cols_));
+        const int nr_poses_per_column =
+            (nr_max_poses_ + nr_poses_per_row - 1) / nr_poses_per_row;
+        if (nr_poses_per_column * nr_rows_ > max_texture_size)
+        {
+            std::cout << "ERROR (OPENGL): " << nr_max_poses_ << " poses at "
+                      << "resolution " << nr_rows_ << " x " << nr_cols_
+                      << " exceed the maximum texture size of "
+                      << max_texture_size << std::endl;
+            exit(-1);
+        }
+
+        opengl_->allocate_textures_for_max_poses(
+            nr_max_poses_, nr_poses_per_row, nr_poses_per_column);
+        gl_->allocate_memory_for_max_poses(
+            nr_max_poses_, nr_poses_per_row, nr_poses_per_column);
+
+        reset();
+    }
+
+    /**
+     * \brief computes the loglikelihoods for the given states, see
+     * KinectImageModelGPU::loglikes()
+     */
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& occlusion_indices,
+                       const bool& update_occlusions = false)
+    {
+        Instrumentation* instrumentation = this->instrumentation_.get();
+
+        if (!observations_set_)
+        {
+            std::cout << "OPENGL: observations not set" << std::endl;
+            exit(-1);
+        }
+
+        // copies of the same particle are rendered and weighted once
+        distinct_.find(deltas, occlusion_indices);
+
+        const int nr_poses = distinct_.count();
+        if (nr_poses > nr_max_poses_)
+        {
+            std::cout << "OPENGL: " << nr_poses << " poses exceed the maximum "
+                      << "of " << nr_max_poses_ << " poses" << std::endl;
+            exit(-1);
+        }
+
+        occlusion_indices_.resize(nr_poses);
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            occlusion_indices_[i] =
+                occlusion_indices[distinct_.representative(i)];
+        }
+
+        // the poses are composed of the default poses and the deltas
+        // by the vertex shader
+        std::vector<Eigen::Matrix4f> default_poses(nr_objects_);
+        for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+        {
+            default_poses[i_obj] = this->default_poses_.component(i_obj)
+                                       .homogeneous()
+                                       .template cast<float>();
+        }
+
+        pose_deltas_.resize(nr_poses * nr_objects_ * 12);
+        for (int i_state = 0; i_state < nr_poses; ++i_state)
+        {
+            for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+            {
+                auto delta =
+                    deltas[distinct_.representative(i_state)].component(i_obj);
+
+                Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                    &pose_deltas_[(i_state * nr_objects_ + i_obj) * 12]);
+                pose.leftCols<3>() =
+                    delta.orientation().rotation_matrix().template cast<float>();
+                pose.col(3) = delta.position().template cast<float>();
+            }
+        }
+
+        {
+            ScopedStageTimer timer(instrumentation, Stage::Render);
+            opengl_->render(default_poses, pose_deltas_.data(), nr_poses);
+        }
+
+        gl_->set_occlusion_indices(occlusion_indices_.data(), nr_poses);
+        gl_->set_number_of_poses(nr_poses);
+
+        std::vector<float> flog_likelihoods(nr_poses, 0);
+        gl_->weigh_poses(opengl_->get_framebuffer_texture(),
+                         update_occlusions,
+                         flog_likelihoods);
+        if (instrumentation && instrumentation->recording())
+        {
+            instrumentation->add_pixels(std::uint64_t(nr_poses) * nr_rows_ *
+                                        nr_cols_);
+        }
+
+        // the occlusions of the distinct poses are stored in their order,
+        // the copies refer to the occlusions of their representative
+        if (update_occlusions)
+        {
+            for (int i_state = 0; i_state < occlusion_indices.size(); ++i_state)
+            {
+                occlusion_indices[i_state] = distinct_.distinct_of(i_state);
+            }
+        }
+
+        RealArray log_likelihoods(deltas.size());
+        for (int i = 0; i < deltas.size(); ++i)
+        {
+            log_likelihoods[i] = flog_likelihoods[distinct_.distinct_of(i)];
+        }
+
+        return log_likelihoods;
+    }
+
+    /**
+     * \brief Sets the observation image that should be used for comparison in
+     * the next evaluation step
+     */
+    void set_observation(const Observation& image)
+    {
+        set_observation(DepthImageView::copy(image, nr_rows_, nr_cols_));
+    }
+
+    /**
+     * \brief Uploads the depths of the view without converting them
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        observation_time_ += this->delta_time_;
+
+        opengl_->make_current();
+        gl_->set_observations(image.data(), observation_time_);
+        observations_set_ = true;
+    }
+
+    /**
+     * \brief Renders the objects at the coarsest of the given levels of detail
+     * whose error projected at the default poses stays below \a tolerance
+     * pixels, see ObjectRasterizer::set_levels_of_detail()
+     */
+    void levels_of_detail(const std::shared_ptr<const MeshLevels>& levels,
+                          double tolerance)
+    {
+        opengl_->set_levels_of_detail(levels, tolerance);
+    }
+
+    /** \brief Resets the occlusion probabilities and observation time */
+    virtual void reset()
+    {
+        const int array_size = nr_rows_ * nr_cols_ * nr_max_poses_;
+        std::vector<float> occlusion_probabilities(array_size,
+                                                   initial_occlusion_prob_);
+
+        opengl_->make_current();
+        gl_->set_occlusion_probabilities(occlusion_probabilities.data(),
+                                         array_size);
+
+        observation_time_ = 0;
+    }
+
+    int max_states() const { return nr_max_poses_; }
+
+    /**
+     * \return the occlusion probabilities of all pixels of the state \a index.
+     * This waits for the GPU.
+     */
+    Observation get_occlusions(int index) const
+    {
+        opengl_->make_current();
+        std::vector<float> occlusion_probs =
+            gl_->get_occlusion_probabilities(index);
+
+        return Eigen::Map<Eigen::MatrixXf>(
+                   occlusion_probs.data(), nr_rows_, nr_cols_)
+            .cast<fl::Real>();
+    }
+
+    /**
+     * \return the depth images of the poses rendered in the last call of
+     * loglikes(). This waits for the GPU.
+     */
+    std::vector<std::vector<float>> get_range_image()
+    {
+        opengl_->make_current();
+        return opengl_->get_depth_values(distinct_.count());
+    }
+
+private:
+    int nr_rows_;
+    int nr_cols_;
+    int nr_max_poses_;
+    int nr_objects_;
+    float initial_occlusion_prob_;
+    double observation_time_;
+    bool observations_set_;
+
+    // the evaluator deletes its buffers before the rasterizer destroys the
+    // context
+    std::shared_ptr<ObjectRasterizer> opengl_;
+    std::shared_ptr<GLLikelihoodEvaluator> gl_;
+
+    // staging of the per call inputs
+    DistinctParticles distinct_;
+    std::vector<int> occlusion_indices_;
+    std::vector<float> pose_deltas_;
+};
+}
@@ -29,13 +29,13 @@
 
 #pragma once
 
-#define PROFILING_ACTIVE
 //#define OPTIMIZE_NR_THREADS
 
 #include <vector>
 #include "boost/shared_ptr.hpp"
 #include "boost/filesystem.hpp"
 #include "Eigen/Core"
+#include "Eigen/Geometry"
 
 #include <osr/pose_vector.hpp>
 #include <dbot/model/rao_blackwell_sensor.hpp>
@@ -45,14 +45,18 @@
 #include <dbot/gpu/object_rasterizer.hpp>
 #include <dbot/gpu/cuda_likelihood_evaluator.hpp>
 #include <dbot/gpu/buffer_configuration.hpp>
+#include <dbot/model/kinect_pixel_model.hpp>
+#include <dbot/model/distinct_particles.hpp>
 
 #include <limits>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sstream>
 #include <iostream>
 #include <cuda_gl_interop.h>
 
 #include <dbot/helper_functions.hpp>
+#include <dbot/launch_tuning_cache.hpp>
 #include <fl/util/profiling.hpp>
 
 
@@ -156,6 +160,16 @@ public:
      * \param [in] exponential_rate the rate of the exponential distribution
      * that
      * models the probability of a measurement coming from an unknown object
+     * \param [in] max_approximation_error bound of the per-pixel log
+     * likelihood error of the tabulated pixel model, see
+     * KinectPixelModel::approximate(). 0 evaluates the model exactly.
+     * \param [in] tile_rows the number of rows of the region of interest each
+     * pose is rendered into. The region is placed around the projected
+     * bounding boxes of the objects in all poses of a loglikes() call. 0
+     * renders the full image.
+     * \param [in] tile_cols the number of columns of the region of interest
+     * \param [in] occlusion_precision the storage format of the occlusion
+     * probabilities, see CudaEvaluator::set_occlusion_precision()
      */
     KinectImageModelGPU(
         const CameraMatrix& camera_matrix,
@@ -175,12 +189,17 @@ public:
         const float model_sigma = 0.003f,
         const float sigma_factor = 0.0014247f,
         const float max_depth = 6.0f,
-        const float exponential_rate = -log(0.5f))
+        const float exponential_rate = -log(0.5f),
+        const float max_approximation_error = 0.f,
+        const int tile_rows = 0,
+        const int tile_cols = 0,
+        const OcclusionPrecision occlusion_precision =
+            OcclusionPrecision::Single)
         : camera_matrix_(camera_matrix),
           nr_rows_(nr_rows),
           nr_cols_(nr_cols),
           nr_max_poses_(max_sample_count),
-          indices_(indices),
+          requested_nr_max_poses_(max_sample_count),
           optimize_nr_threads_(optimize_nr_threads),
           initial_occlusion_prob_(initial_occlusion_prob),
           tail_weight_(tail_weight),
@@ -189,8 +208,11 @@ public:
           max_depth_(max_depth),
           exponential_rate_(exponential_rate),
           nr_poses_(max_sample_count),
+          tile_rows_(nr_rows),
+          tile_cols_(nr_cols),
           observations_set_(false),
           resource_registered_(false),
+          tile_overflow_reported_(false),
           observation_time_(0),
           Traits::Base(delta_time)
     {
@@ -199,33 +221,43 @@ public:
         this->default_poses_.recount(vertices_double.size());
         this->default_poses_.setZero();
 
-        // convert doubles to floats
-        vertices_.resize(vertices_double.size());
-        for (size_t object_index = 0; object_index < vertices_.size();
+        // the corners of the bounding boxes of the objects bound their
+        // projections
+        bounding_box_corners_.resize(vertices_double.size());
+        for (size_t object_index = 0; object_index < vertices_double.size();
              object_index++)
         {
-            vertices_[object_index].resize(
-                vertices_double[object_index].size());
-            for (size_t vertex_index = 0;
-                 vertex_index < vertices_[object_index].size();
-                 vertex_index++)
-                vertices_[object_index][vertex_index] =
-                    vertices_double[object_index][vertex_index].cast<float>();
+            Eigen::AlignedBox3d box;
+            for (const auto& vertex : vertices_double[object_index])
+            {
+                box.extend(vertex);
+            }
+            for (int i = 0; i < 8 && !box.isEmpty(); i++)
+            {
+                bounding_box_corners_[object_index].push_back(
+                    box.corner(Eigen::AlignedBox3d::CornerType(i)));
+            }
         }
 
-        // initialize opengl and cuda
+        // initialize opengl and cuda on the same GPU
+        int cuda_device = 0;
+        cudaGetDevice(&cuda_device);
+
         opengl_ = boost::shared_ptr<ObjectRasterizer>(
-            new ObjectRasterizer(vertices_,
-                                 indices_,
+            new ObjectRasterizer(
+                                 std::make_shared<FlatMesh>(vertices_double,
+                                                            indices),
                                  shader_provider,
                                  camera_matrix_.cast<float>(),
                                  nr_rows_,
                                  nr_cols_,
                                  0.4,
-                                 4));
+                                 4,
+                                 cuda_device));
 
 
-        cuda_ = boost::shared_ptr<CudaEvaluator>(new CudaEvaluator(nr_rows_, nr_cols_));
+        cuda_ = boost::shared_ptr<CudaEvaluator>(
+            new CudaEvaluator(nr_rows_, nr_cols_, cuda_device));
 
         cuda_->init(initial_occlusion_prob_,
                     p_occluded_occluded,
@@ -236,6 +268,28 @@ public:
                     max_depth_,
                     exponential_rate_);
 
+        KinectPixelModel pixel_model(tail_weight_,
+                                     model_sigma_,
+                                     sigma_factor_,
+                                     -log(0.5) / exponential_rate_,
+                                     max_depth_);
+        if (max_approximation_error > 0)
+        {
+            pixel_model.approximate(max_approximation_error);
+
+            const auto& approximation = *pixel_model.approximation();
+            cuda_->set_likelihood_table(approximation.table,
+                                        approximation.data.data(),
+                                        approximation.data.size());
+        }
+
+        // nothing closer than the near plane of the rasterizer is rendered
+        max_log_ratio_ = pixel_model.max_log_likelihood_ratio(0.4);
+
+        // the buffer configuration fits the poses with the memory need of
+        // this precision
+        cuda_->set_occlusion_precision(occlusion_precision);
+
         bufferConfig_ = boost::shared_ptr<BufferConfiguration>(
                             new BufferConfiguration(opengl_, cuda_,
                                 nr_max_poses_, nr_rows_, nr_cols_));
@@ -248,7 +302,7 @@ public:
         if (bufferConfig_->allocate_memory(nr_max_poses_, tmp_max_nr_poses)) {
                 nr_max_poses_ = tmp_max_nr_poses;
         } else {
-            exit(-1);
+            throw_allocation_failure(nr_rows_, nr_cols_);
         }
 
 
@@ -256,7 +310,26 @@ public:
         if (bufferConfig_->set_resolution(nr_rows_, nr_cols_, tmp_max_nr_poses)) {
             nr_max_poses_ = tmp_max_nr_poses;
         } else {
-            exit(-1);
+            throw_allocation_failure(nr_rows_, nr_cols_);
+        }
+
+        // smaller tiles only render the region of interest, placed by
+        // update_tile_offset() in every evaluation
+        if (tile_rows > 0 && tile_cols > 0 &&
+            (tile_rows < nr_rows_ || tile_cols < nr_cols_))
+        {
+            tile_rows_ = std::min(tile_rows, nr_rows_);
+            tile_cols_ = std::min(tile_cols, nr_cols_);
+
+            if (bufferConfig_->set_tile_resolution(
+                    tile_rows_, tile_cols_, tmp_max_nr_poses))
+            {
+                nr_max_poses_ = tmp_max_nr_poses;
+            }
+            else
+            {
+                throw_allocation_failure(tile_rows_, tile_cols_);
+            }
         }
 
         register_resource();
@@ -269,37 +342,11 @@ public:
 
         occlusion_probs_.resize(nr_rows_ * nr_cols_);
 
-#ifdef PROFILING_ACTIVE
-        for (int i = 0; i < NR_SUBTASKS_TO_MEASURE; i++)
-        {
-            time_[i] = 0;
-        }
-        strings_for_subtasks_[SET_OCCLUSION_INDICES] =
-            "Setting occlusion indices";
-        strings_for_subtasks_[CONVERTING_STATE_FORMAT] =
-            "Converting state format";
-        strings_for_subtasks_[RENDERING] = "Rendering step";
-        strings_for_subtasks_[MAPPING] =
-            "Mapping the texture from OpenGL to CUDA";
-        strings_for_subtasks_[WEIGHTING] = "Weighting step";
-        strings_for_subtasks_[UNMAPPING] =
-            "Unmapping the texture and reconverting the likelihoods";
-#endif
-
-        optimize_nr_threads_ = false;
+        set_optimization_of_thread_nr(false);
 
 #ifdef OPTIMIZE_NR_THREADS
         set_optimization_of_thread_nr(true);
 #endif
-        if (optimize_nr_threads_)
-        {
-            max_nr_threads_ = cuda_->get_max_nr_threads();
-            warp_size_ = cuda_->get_warp_size();
-            nr_threads_ = warp_size_;
-            best_time_ = std::numeric_limits<double>::infinity();
-            best_nr_threads_ = nr_threads_;
-            average_time_ = 0;
-        }
 
         optimization_runs_ = 0;
     }
@@ -324,12 +371,7 @@ public:
                        IntArray& occlusion_indices,
                        const bool& update_occlusions = false)
     {
-#ifdef PROFILING_ACTIVE
-        if (!optimize_nr_threads_ && optimization_runs_ != count_)
-        {
-            time_before_ = dbot::hf::get_wall_time();
-        }
-#endif
+        Instrumentation* instrumentation = this->instrumentation_.get();
 
         if (!observations_set_)
         {
@@ -337,7 +379,10 @@ public:
             exit(-1);
         }
 
-        nr_poses_ = deltas.size();
+        // copies of the same particle are rendered and weighted once
+        distinct_.find(deltas, occlusion_indices);
+
+        nr_poses_ = distinct_.count();
         std::vector<float> flog_likelihoods(nr_poses_, 0);
 
         int tmp_nr_poses;
@@ -348,65 +393,63 @@ public:
         }
 
 
-        // transform occlusion indices from size_t to int
-        std::vector<int> occlusion_indices_transformed(occlusion_indices.size(),
-                                                       0);
-        for (size_t i = 0; i < occlusion_indices.size(); i++)
+        // transform occlusion indices of the distinct poses from size_t to
+        // int
+        std::vector<int> occlusion_indices_transformed(nr_poses_, 0);
+        for (size_t i = 0; i < size_t(nr_poses_); i++)
         {
-            occlusion_indices_transformed[i] = (int)occlusion_indices[i];
+            occlusion_indices_transformed[i] =
+                (int)occlusion_indices[distinct_.representative(i)];
         }
 
         // copy occlusion indices to GPU
         cuda_->set_occlusion_indices(occlusion_indices_transformed.data(),
-                                     occlusion_indices.size());
+                                     nr_poses_);
 
-#ifdef PROFILING_ACTIVE
-        store_time(SET_OCCLUSION_INDICES);
-#endif
-
-        int nr_objects = vertices_.size();
+        int nr_objects = bounding_box_corners_.size();
 
-        std::vector<std::vector<Eigen::Matrix4f>> poses(
-            nr_poses_, std::vector<Eigen::Matrix4f>(nr_objects));
+        // the poses are composed of the default poses and the deltas
+        // by the vertex shader
+        std::vector<Eigen::Matrix4f> default_poses(nr_objects);
+        for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
+        {
+            default_poses[i_obj] = this->default_poses_.component(i_obj)
+                                       .homogeneous()
+                                       .template cast<float>();
+        }
 
+        pose_deltas_.resize(nr_poses_ * nr_objects * 12);
         for (size_t i_state = 0; i_state < size_t(nr_poses_); i_state++)
         {
             for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
             {
-                auto pose_0 = this->default_poses_.component(i_obj);
-                auto delta = deltas[i_state].component(i_obj);
-
-                osr::PoseVector pose;
-
-                /// \todo: this should be done through the the apply_delta
-                /// function
-                pose.position() = pose_0.orientation().rotation_matrix()
-                        * delta.position() + pose_0.position();
-                pose.orientation() = pose_0.orientation() * delta.orientation();
-
-                poses[i_state][i_obj] = pose.homogeneous().cast<float>();
+                auto delta =
+                    deltas[distinct_.representative(i_state)].component(i_obj);
+
+                Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                    &pose_deltas_[(i_state * nr_objects + i_obj) * 12]);
+                pose.leftCols<3>() =
+                    delta.orientation().rotation_matrix().template cast<float>();
+                pose.col(3) = delta.position().template cast<float>();
             }
         }
 
-#ifdef PROFILING_ACTIVE
-        store_time(CONVERTING_STATE_FORMAT);
-#endif
-
-        opengl_->render(poses);
+        update_tile_offset(deltas);
 
+        // the wall times of the host, rendering and weighing may partially
+        // overlap with the following stages on the device
+        {
+            ScopedStageTimer timer(instrumentation, Stage::Render);
+            opengl_->render(default_poses, pose_deltas_.data(), nr_poses_);
+        }
 
-#ifdef PROFILING_ACTIVE
-        store_time(RENDERING);
-#endif
-
-        cudaGraphicsMapResources(1, &texture_resource_, 0);
-        cudaGraphicsSubResourceGetMappedArray(
-            &texture_array_, texture_resource_, 0, 0);
-        cuda_->map_texture_to_texture_array(texture_array_);
-
-#ifdef PROFILING_ACTIVE
-        store_time(MAPPING);
-#endif
+        {
+            ScopedStageTimer timer(instrumentation, Stage::Map);
+            cudaGraphicsMapResources(1, &texture_resource_, cuda_->stream());
+            cudaGraphicsSubResourceGetMappedArray(
+                &texture_array_, texture_resource_, 0, 0);
+            cuda_->map_texture_to_texture_array(texture_array_);
+        }
 
         if (optimize_nr_threads_)
         {
@@ -425,15 +468,36 @@ public:
             }
             else
             {
-                nr_threads_ = best_nr_threads_;
+                // the last setting tried is still configured
+                int tmp_nr_threads;
+                if (bufferConfig_->set_number_of_threads(best_nr_threads_,
+                                                         tmp_nr_threads)) {
+                    nr_threads_ = tmp_nr_threads;
+                } else {
+                    exit(-1);
+                }
+
                 optimize_nr_threads_ = false;
                 std::cout << std::endl
                           << "Best #threads: " << nr_threads_ << std::endl
                           << std::endl;
+
+                if (launch_tuning_)
+                {
+                    LaunchTuningCache::Launch launch;
+                    launch.nr_threads = nr_threads_;
+                    launch.max_nr_poses = nr_max_poses_;
+                    launch_tuning_->store(launch_key(), launch);
+                }
             }
         }
 
         cuda_->weigh_poses(update_occlusions, flog_likelihoods);
+        if (instrumentation && instrumentation->recording())
+        {
+            instrumentation->add_pixels(std::uint64_t(nr_poses_) * tile_rows_ *
+                                        tile_cols_);
+        }
 
         if (optimize_nr_threads_)
         {
@@ -459,27 +523,24 @@ public:
             }
         }
 
-#ifdef PROFILING_ACTIVE
-        store_time(WEIGHTING);
-#endif
-
-        cudaGraphicsUnmapResources(1, &texture_resource_, 0);
+        {
+            ScopedStageTimer timer(instrumentation, Stage::Map);
+            cudaGraphicsUnmapResources(1, &texture_resource_, cuda_->stream());
+        }
 
+        // the occlusions of the distinct poses are stored in their order,
+        // the copies refer to the occlusions of their representative
         if (update_occlusions)
         {
             for (size_t i_state = 0; i_state < occlusion_indices.size();
                  i_state++)
-                occlusion_indices[i_state] = i_state;
+                occlusion_indices[i_state] = distinct_.distinct_of(i_state);
         }
 
         // convert
-        RealArray log_likelihoods(flog_likelihoods.size());
-        for (size_t i = 0; i < flog_likelihoods.size(); i++)
-            log_likelihoods[i] = flog_likelihoods[i];
-
-#ifdef PROFILING_ACTIVE
-        store_time(UNMAPPING);
-#endif
+        RealArray log_likelihoods(deltas.size());
+        for (size_t i = 0; i < size_t(deltas.size()); i++)
+            log_likelihoods[i] = flog_likelihoods[distinct_.distinct_of(i)];
 
         count_++;
         return log_likelihoods;
@@ -493,19 +554,41 @@ public:
      */
     void set_observation(const Observation& image)
     {
-        std::vector<float> std_measurement(image.size());
-
-        for (int i = 0; i < image.size(); ++i)
-        {
-            std_measurement[i] = image(i);
-        }
+        set_observation(DepthImageView::copy(image, nr_rows_, nr_cols_));
+    }
 
+    /**
+     * \brief Uploads the depths of the view without converting them
+     */
+    void set_observation(const DepthImageView& image)
+    {
         observation_time_ += this->delta_time_;
 
-        cuda_->set_observations(std_measurement.data(), observation_time_);
+        cuda_->set_observations(image.data(), observation_time_);
         observations_set_ = true;
     }
 
+    /**
+     * \brief Renders the objects at the coarsest of the given levels of detail
+     * whose error projected at the default poses stays below \a tolerance
+     * pixels, see ObjectRasterizer::set_levels_of_detail()
+     */
+    void levels_of_detail(const std::shared_ptr<const MeshLevels>& levels,
+                          double tolerance)
+    {
+        opengl_->set_levels_of_detail(levels, tolerance);
+    }
+
+    /**
+     * \brief Stops evaluating hopeless poses, see
+     * KinectImageModel::rejection_margin(). The bound of a pose covers all
+     * pixels of its tile, hence the rejection is effective with small tiles.
+     */
+    void rejection_margin(float margin)
+    {
+        cuda_->set_rejection_margin(margin, max_log_ratio_);
+    }
+
     /** \brief Resets the occlusion probabilities and observation time */
     virtual void reset()
     {
@@ -522,62 +605,212 @@ public:
         observation_time_ = 0;
     }
 
+    /**
+     * \brief Writes the encoded occlusion probabilities of the states up to
+     *        the largest of \a indices and the observation time
+     */
+    void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        const int count =
+            indices.size() > 0 ? std::min(indices.maxCoeff() + 1, nr_max_poses_)
+                               : 0;
+
+        snapshot.write<std::uint8_t>(this->DeviceOcclusions);
+        snapshot.write(observation_time_);
+        snapshot.write(cuda_->get_occlusion_time());
+        snapshot.write<std::uint8_t>(
+            std::uint8_t(cuda_->get_occlusion_precision()));
+        snapshot.write<std::uint32_t>(nr_rows_);
+        snapshot.write<std::uint32_t>(nr_cols_);
+        snapshot.write<std::uint64_t>(count);
+        snapshot.write_vector(cuda_->get_encoded_occlusions(count));
+    }
+
+    int restore(Snapshot::Reader& reader)
+    {
+        if (reader.read<std::uint8_t>() != this->DeviceOcclusions)
+        {
+            throw InvalidSnapshotException(
+                "the snapshot holds no device occlusions");
+        }
+        const double observation_time = reader.read<double>();
+        const float occlusion_time = reader.read<float>();
+        const OcclusionPrecision precision = cuda_->get_occlusion_precision();
+        if (reader.read<std::uint8_t>() != std::uint8_t(precision))
+        {
+            throw InvalidSnapshotException(
+                "the occlusion precision does not match");
+        }
+        if (reader.read<std::uint32_t>() != std::uint32_t(nr_rows_) ||
+            reader.read<std::uint32_t>() != std::uint32_t(nr_cols_))
+        {
+            throw InvalidSnapshotException("the resolution does not match");
+        }
+        const std::uint64_t count = reader.read<std::uint64_t>();
+        std::vector<unsigned char> encoded;
+        reader.read_vector(encoded);
+        if (count > std::uint64_t(nr_max_poses_) ||
+            encoded.size() != count * nr_rows_ * nr_cols_ *
+                                  occlusion_bytes(precision))
+        {
+            throw InvalidSnapshotException(
+                "the occlusions do not fit the states");
+        }
+
+        // the slots beyond the snapshot hold the initial occlusions
+        reset();
+        if (count == 0) return 0;
+
+        cuda_->set_encoded_occlusions(encoded);
+        cuda_->set_occlusion_time(occlusion_time);
+        observation_time_ = observation_time;
+        return int(count);
+    }
+
+    int max_states() const { return nr_max_poses_; }
+
     /** activates automatic optimization of the number of threads */
     void set_optimization_of_thread_nr(bool shouldOptimize)
     {
         optimize_nr_threads_ = shouldOptimize;
+
+        if (optimize_nr_threads_)
+        {
+            max_nr_threads_ = cuda_->get_max_nr_threads();
+            warp_size_ = cuda_->get_warp_size();
+            nr_threads_ = warp_size_;
+            best_time_ = std::numeric_limits<double>::infinity();
+            best_nr_threads_ = nr_threads_;
+            average_time_ = 0;
+        }
+    }
+
+    /**
+     * \brief Takes the number of threads tuned for this GPU, driver and
+     * resolution from \a cache. If the cache holds none, the number of
+     * threads is optimized during the first loglikes() calls and stored in
+     * \a cache once the optimization has finished.
+     *
+     * nullptr leaves the optimization as it is.
+     */
+    void launch_tuning(const std::shared_ptr<LaunchTuningCache>& cache)
+    {
+        launch_tuning_ = cache;
+        if (!launch_tuning_) return;
+
+        // the buffers adapt to the same poses unless the free memory changed
+        LaunchTuningCache::Launch launch;
+        if (launch_tuning_->find(launch_key(), launch) &&
+            launch.max_nr_poses == nr_max_poses_)
+        {
+            int tmp_nr_threads;
+            if (bufferConfig_->set_number_of_threads(launch.nr_threads,
+                                                     tmp_nr_threads)) {
+                nr_threads_ = tmp_nr_threads;
+            } else {
+                exit(-1);
+            }
+
+            optimize_nr_threads_ = false;
+        }
+        else if (!optimize_nr_threads_)
+        {
+            set_optimization_of_thread_nr(true);
+        }
     }
 
 
     /**
      * \brief Returns the occlusion probabilities for each pixel for a given state
      *
+     * This synchronizes with the GPU, use request_readback() in every frame.
+     *
      * \param [in] index the index into the state array of the state you are
      * interested in
      * \return an Eigen Matrix containing the occlusion probabilities for each
      * pixel for the given state
      */
-    const Eigen::Map<Observation> get_occlusions(size_t index) const
+    Observation get_occlusions(size_t index) const
     {
         std::vector<float> occlusion_probs =
             cuda_->get_occlusion_probabilities((int)index);
 
-        // convert values to doubles and put them into an Eigen Matrix
-        std::vector<double> occlusion_probs_double(occlusion_probs.begin(),
-                                                   occlusion_probs.end());
-        Eigen::Map<Observation> occlusion_probs_matrix(
-            &occlusion_probs_double[0], nr_rows_, nr_cols_);
+        return Eigen::Map<Eigen::MatrixXf>(
+                   occlusion_probs.data(), nr_rows_, nr_cols_)
+            .cast<Scalar>();
+    }
+
+    /**
+     * \brief Enqueues the download of the rendered depth image and the
+     * occlusion probabilities of the state \a index of the last loglikes()
+     * call, e.g. of the best particle. The download overlaps with the next
+     * evaluation and is collected with poll_readback(), typically one frame
+     * later. A new request supersedes a pending one.
+     */
+    void request_readback(int index)
+    {
+        cudaGraphicsMapResources(1, &texture_resource_, cuda_->stream());
+        cudaGraphicsSubResourceGetMappedArray(
+            &texture_array_, texture_resource_, 0, 0);
+        cuda_->map_texture_to_texture_array(texture_array_);
+
+        cuda_->request_readback(index);
 
-        return occlusion_probs_matrix;
+        cudaGraphicsUnmapResources(1, &texture_resource_, cuda_->stream());
+    }
+
+    /**
+     * \brief Copies the last requested readback into the given buffers if it
+     * has arrived. This never waits for the GPU.
+     *
+     * \param [out] depth_image the depths of all pixels, 0 where the objects
+     * were not rendered. Only resized if its size does not match.
+     * \param [out] occlusions the occlusion probabilities of all pixels
+     * \return whether the buffers have been updated
+     */
+    bool poll_readback(Observation& depth_image, Observation& occlusions)
+    {
+        readback_depth_.resize(nr_rows_ * nr_cols_);
+        readback_occlusions_.resize(nr_rows_ * nr_cols_);
+
+        if (!cuda_->poll_readback(readback_depth_.data(),
+                                  readback_occlusions_.data()))
+        {
+            return false;
+        }
+
+        depth_image.resize(nr_rows_, nr_cols_);
+        occlusions.resize(nr_rows_, nr_cols_);
+        for (int i = 0; i < nr_rows_ * nr_cols_; ++i)
+        {
+            depth_image(i) = readback_depth_[i];
+            occlusions(i) = readback_occlusions_[i];
+        }
+
+        return true;
     }
 
     /**
      * \brief Returns the depth values of the rendered states
      *
+     * This synchronizes with the GPU, use request_readback() in every frame.
+     *
      * \return an Eigen Matrix containing the depth values per pixel, stored in
-     * a 1D array denoting the respective pose
+     * a 1D array denoting the respective pose. The images cover the tiles of
+     * the last evaluation.
       */
-    std::vector<Eigen::Map<Observation>> get_range_image()
+    std::vector<Observation> get_range_image()
     {
         std::vector<std::vector<float>> depth_values_raw =
             opengl_->get_depth_values(nr_poses_);
 
-        // convert depth values to doubles
-        std::vector<std::vector<double>> depth_values_raw_double;
-        for (int i = 0; i < depth_values_raw.size(); i++)
+        std::vector<Observation> depth_values;
+        for (size_t i = 0; i < depth_values_raw.size(); i++)
         {
-            depth_values_raw_double.push_back(std::vector<double>(
-                depth_values_raw[i].begin(), depth_values_raw[i].end()));
-        }
-
-        // map values into an Eigen Matrix
-        std::vector<Eigen::Map<Observation>> depth_values;
-
-        for (int i = 0; i < depth_values_raw.size(); i++)
-        {
-            Eigen::Map<Observation> tmp(
-                &depth_values_raw_double[i][0], nr_rows_, nr_cols_);
-            depth_values.push_back(tmp);
+            depth_values.push_back(
+                Eigen::Map<Eigen::MatrixXf>(
+                    depth_values_raw[i].data(), tile_rows_, tile_cols_)
+                    .cast<Scalar>());
         }
 
         return depth_values;
@@ -586,86 +819,141 @@ public:
 
 
 
-    /** \brief The destructor. If profiling is activated, the time measurements are
-     * processed and printed out here */
+    /** \brief The destructor. Timings of the evaluation are reported
+     * through the instrumentation, see RbSensor::instrumentation() */
     virtual ~KinectImageModelGPU() noexcept
     {
-
         unregister_resource();
+    }
+
+private:
+    /** \return the setup the number of threads is tuned for */
+    LaunchTuningCache::Key launch_key()
+    {
+        LaunchTuningCache::Key key;
+        key.device = cuda_->get_device_properties().name;
+        cudaDriverGetVersion(&key.driver_version);
+        key.rows = nr_rows_;
+        key.cols = nr_cols_;
+        key.tile_rows = tile_rows_;
+        key.tile_cols = tile_cols_;
+        key.poses = requested_nr_max_poses_;
+        return key;
+    }
 
-#ifdef PROFILING_ACTIVE
+    const Eigen::Matrix3d camera_matrix_;
+    int nr_rows_;
+    int nr_cols_;
+    int nr_max_poses_;
+    // before adapting to the constraints of the GPU
+    int requested_nr_max_poses_;
 
-        count_ -= optimization_runs_;
-        if (count_ > 0)
+    /**
+     * \brief Places the tiles such that they contain the projected bounding
+     * boxes of all objects in the first nr_poses_ states. If the projections
+     * do not fit, the tiles are centered on them and the pixels outside of
+     * the tiles are evaluated as not covered by the objects.
+     */
+    void update_tile_offset(const StateArray& deltas)
+    {
+        if (tile_rows_ == nr_rows_ && tile_cols_ == nr_cols_) return;
+
+        double u_min = std::numeric_limits<double>::infinity();
+        double v_min = u_min;
+        double u_max = -u_min;
+        double v_max = -u_min;
+        bool behind_camera = false;
+
+        for (int i_state = 0; i_state < nr_poses_ && !behind_camera; i_state++)
         {
-            std::cout << std::endl
-                      << "Time measurements for the different steps of the "
-                         "evaluation process averaged over "
-                      << count_ << " evaluation calls:" << std::endl
-                      << std::endl;
-
-            double total_time_per_evaluation = 0;
-            for (int i = 0; i < NR_SUBTASKS_TO_MEASURE; i++)
+            for (size_t i_obj = 0; i_obj < bounding_box_corners_.size();
+                 i_obj++)
             {
-                total_time_per_evaluation += time_[i];
-            }
-            total_time_per_evaluation /= count_;
+                auto delta = deltas[i_state].component(i_obj);
+                auto pose = this->default_poses_.component(i_obj);
 
-            for (int i = 0; i < NR_SUBTASKS_TO_MEASURE; i++)
-            {
-                std::cout << strings_for_subtasks_[i] << ": \t"
-                          << time_[i] / count_ << " s \t "
-                          << std::setprecision(1)
-                          << time_[i] / count_ * 100 / total_time_per_evaluation
-                          << " %" << std::setprecision(9) << std::endl;
-            }
-            std::cout << "Total time per evaluation call: "
-                      << total_time_per_evaluation << std::endl;
+                // pose of the object composed as in the vertex shader
+                Eigen::Matrix3d rotation =
+                    pose.orientation().rotation_matrix() *
+                    delta.orientation().rotation_matrix();
+                Eigen::Vector3d translation =
+                    pose.orientation().rotation_matrix() * delta.position() +
+                    pose.position();
 
-            if (optimization_runs_ > 0)
-            {
-                std::cout << std::endl
-                          << "The best number of threads for this setup was "
-                             "estimated to be "
-                          << nr_threads_ << std::endl;
+                for (const auto& corner : bounding_box_corners_[i_obj])
+                {
+                    Eigen::Vector3d p = rotation * corner + translation;
+                    if (p(2) <= 0)
+                    {
+                        behind_camera = true;
+                        break;
+                    }
+
+                    Eigen::Vector3d uv = camera_matrix_ * (p / p(2));
+                    u_min = std::min(u_min, uv(0));
+                    u_max = std::max(u_max, uv(0));
+                    v_min = std::min(v_min, uv(1));
+                    v_max = std::max(v_max, uv(1));
+                }
             }
         }
-        else
+
+        int row_offset = 0;
+        int col_offset = 0;
+        if (!behind_camera && u_min <= u_max)
         {
-            std::cout << "No measurement for the different steps of the "
-                         "evaluation was taken. "
-                      << "Most likely, you need to deactivate the optimization "
-                         "for #threads or"
-                      << " let the program run for a longer period of time."
-                      << std::endl;
-
-            if (optimize_nr_threads_ == true)
+            bool fits =
+                place_tile(v_min, v_max, tile_rows_, nr_rows_, row_offset);
+            fits &= place_tile(u_min, u_max, tile_cols_, nr_cols_, col_offset);
+
+            if (!fits && !tile_overflow_reported_)
             {
-                std::cout << std::endl
-                          << "The best #threads could not be computed, because "
-                             "the runtime of the program was too short."
-                          << " Please allow the program to run a bit longer to "
-                             "find the best #threads."
-                          << std::endl;
+                std::cout << "WARNING (GPU): The projected objects exceed the "
+                          << tile_rows_ << " x " << tile_cols_ << " tiles, "
+                          << "the likelihood of pixels outside of the tiles "
+                          << "is neglected." << std::endl;
+                tile_overflow_reported_ = true;
             }
         }
-#endif
+
+        opengl_->set_tile_offset(row_offset, col_offset);
+        cuda_->set_tile_offset(row_offset, col_offset);
     }
 
-private:
-    const Eigen::Matrix3d camera_matrix_;
-    int nr_rows_;
-    int nr_cols_;
-    int nr_max_poses_;
+    /**
+     * \brief Computes the offset of a tile of tile_size pixels which contains
+     * the pixels covering [min, max], within an image of image_size pixels.
+     * \return whether the tile contains all of these pixels
+     */
+    static bool place_tile(double min,
+                           double max,
+                           int tile_size,
+                           int image_size,
+                           int& offset)
+    {
+        // pixel centers have integer coordinates
+        double first = std::floor(std::max(min, -1.0));
+        double last = std::ceil(std::min(max, double(image_size)));
+        int span = int(last - first) + 1;
 
-    void store_time(int task)
+        offset = int(first) - (tile_size - span) / 2;
+        offset = std::max(0, std::min(offset, image_size - tile_size));
+
+        return span <= tile_size;
+    }
+
+    /**
+     * \brief Fails the construction of a model which does not fit on the
+     *        device, instead of exiting the process
+     */
+    void throw_allocation_failure(int tile_rows, int tile_cols) const
     {
-        if (!optimize_nr_threads_ && optimization_runs_ != count_)
-        {
-            time_after_ = dbot::hf::get_wall_time();
-            time_[task] += time_after_ - time_before_;
-            time_before_ = time_after_;
-        }
+        std::ostringstream report;
+        report << "KinectImageModelGPU: " << nr_max_poses_ << " poses of "
+               << tile_rows << " x " << tile_cols << " pixels of an image of "
+               << nr_rows_ << " x " << nr_cols_
+               << " pixels do not fit on the device, see GpuMemoryPlanner";
+        throw GpuMemoryPlanException(report.str());
     }
 
     void check_cuda_error(const char* msg)
@@ -705,8 +993,11 @@ private:
 
     // OpenGL handle and input
     boost::shared_ptr<ObjectRasterizer> opengl_;
-    std::vector<std::vector<Eigen::Vector3f>> vertices_;
-    std::vector<std::vector<std::vector<int>>> indices_;
+
+    // relative transformations of all poses and objects passed to the
+    // rasterizer, see ObjectRasterizer::render()
+    std::vector<float> pose_deltas_;
+    DistinctParticles distinct_;
     std::string vertex_shader_path_;
     std::string fragment_shader_path_;
 
@@ -726,8 +1017,20 @@ private:
     float exponential_rate_;
     std::vector<float> occlusion_probs_;
 
+    // upper bound of the per-pixel log likelihood ratios
+    float max_log_ratio_;
+
+    // host copies of the last collected readback, see poll_readback()
+    std::vector<float> readback_depth_;
+    std::vector<float> readback_occlusions_;
+
+    // corners of the bounding box of each object
+    std::vector<std::vector<Eigen::Vector3d>> bounding_box_corners_;
+
     // amount of poses and pose distribution in the OpenGL texture
     int nr_poses_;
+    int tile_rows_;
+    int tile_cols_;
     int nr_poses_per_row_;
     int nr_poses_per_column_;
 
@@ -737,22 +1040,9 @@ private:
     cudaArray_t texture_array_;
 
     // booleans to ensure correct usage of function calls
-    bool observations_set_, resource_registered_;
+    bool observations_set_, resource_registered_, tile_overflow_reported_;
 
-    // used for time observations
-    static const int NR_SUBTASKS_TO_MEASURE = 6;
-    enum subtasks_to_measure
-    {
-        SET_OCCLUSION_INDICES,
-        CONVERTING_STATE_FORMAT,
-        RENDERING,
-        MAPPING,
-        WEIGHTING,
-        UNMAPPING
-    };
-    double time_[NR_SUBTASKS_TO_MEASURE];
-    std::string strings_for_subtasks_[NR_SUBTASKS_TO_MEASURE];
-    double time_before_, time_after_;
+    // number of loglikes() calls
     int count_;
 
     // variables for the optimization runs
@@ -770,5 +1060,8 @@ private:
 
     // optional flag for optimizing the #threads
     bool optimize_nr_threads_;
+
+    // tuned numbers of threads of earlier runs, may be empty
+    std::shared_ptr<LaunchTuningCache> launch_tuning_;
 };
 }
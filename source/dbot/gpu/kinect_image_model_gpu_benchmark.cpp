@@ -0,0 +1,100 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_gpu_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/default_shader_provider.hpp>
+#include <dbot/gpu/kinect_image_model_gpu.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModelGPU<State> Sensor;
+
+/**
+ * \brief Renders and evaluates jittered particles of a synthetic scene
+ *        without updating the occlusions.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, number of
+ * particles, latitude bands of each sphere, number of parts
+ */
+static void BM_KinectImageModelGPU_Loglikes(benchmark::State& state)
+{
+    const int downsampling = state.range(0);
+    const int particle_count = state.range(1);
+    const int rings = state.range(2);
+    const int part_count = state.range(3);
+
+    auto loader =
+        std::make_shared<dbot::SyntheticObjectLoader>(part_count, rings);
+    dbot::ObjectModel object_model(loader, false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(part_count);
+    dbot::SyntheticCameraDataProvider camera(
+        downsampling, object_model, poses);
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    Sensor sensor(camera.camera_matrix(),
+                  n_rows,
+                  n_cols,
+                  particle_count,
+                  object_model.vertices(),
+                  object_model.triangle_indices(),
+                  std::make_shared<dbot::DefaultShaderProvider>());
+    for (int part = 0; part < part_count; ++part)
+    {
+        sensor.integrated_poses().component(part).affine(poses[part]);
+    }
+    sensor.set_observation(camera.depth_image_view());
+
+    std::mt19937 generator(0);
+    std::normal_distribution<double> noise(0., 0.005);
+    Sensor::StateArray deltas(particle_count);
+    for (int i = 0; i < particle_count; ++i)
+    {
+        deltas[i].recount(part_count);
+        deltas[i].setZero();
+        for (int part = 0; part < part_count; ++part)
+        {
+            deltas[i].component(part).position() = Eigen::Vector3d(
+                noise(generator), noise(generator), noise(generator));
+        }
+    }
+    Sensor::IntArray indices = Sensor::IntArray::Zero(particle_count);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sensor.loglikes(deltas, indices, false));
+    }
+
+    state.SetItemsProcessed(state.iterations() * particle_count);
+}
+
+BENCHMARK(BM_KinectImageModelGPU_Loglikes)
+    ->ArgNames({"downsampling", "particles", "rings", "parts"})
+    ->Args({1, 200, 16, 1})
+    ->Args({1, 1000, 16, 1})
+    ->Args({2, 1000, 16, 1})
+    ->Args({2, 1000, 64, 1})
+    ->Args({2, 1000, 16, 4})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,503 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_multi_gpu.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <dbot/traits.hpp>
+#include <dbot/model/rao_blackwell_sensor.hpp>
+#include <dbot/model/kinect_pixel_model.hpp>
+#include <dbot/gpu/cuda_rasterizer.hpp>
+#include <dbot/gpu/cuda_likelihood_evaluator.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Kinect image model which distributes the states over several GPUs.
+ *
+ * Every device renders its share of the states with its own CudaRasterizer
+ * and weighs them with its own CudaEvaluator, see KinectImageModelCuda. All
+ * devices are issued before any of them is waited for, so they run
+ * concurrently.
+ *
+ * The occlusion probabilities of a state remain on the device which
+ * evaluated it. A state is preferably evaluated on the device holding the
+ * occlusions of its ancestor. States exceeding the even share of a device
+ * are moved to the least loaded device, which first copies the occlusions of
+ * the ancestor from its owner. Each evaluator therefore provides twice the
+ * share in occlusion slots, the upper half receiving these copies.
+ */
+template <typename State>
+class KinectImageModelMultiGPU : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+
+    typedef double Scalar;
+    typedef Eigen::Matrix<Scalar, 3, 3> CameraMatrix;
+
+    /**
+     * \brief constructor, see KinectImageModelGPU for the parameters
+     *
+     * \param [in] devices the CUDA devices to distribute the states over. If
+     * empty, all devices are used.
+     */
+    KinectImageModelMultiGPU(
+        const CameraMatrix& camera_matrix,
+        const int nr_rows,
+        const int nr_cols,
+        const int max_sample_count,
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices_double,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const std::vector<int>& devices = std::vector<int>(),
+        const Scalar initial_occlusion_prob = 0.1,
+        const double delta_time = 0.033,
+        const float p_occluded_visible = 0.1f,
+        const float p_occluded_occluded = 0.7f,
+        const float tail_weight = 0.01f,
+        const float model_sigma = 0.003f,
+        const float sigma_factor = 0.0014247f,
+        const float max_depth = 6.0f,
+        const float exponential_rate = -std::log(0.5f),
+        const float max_approximation_error = 0.f,
+        const OcclusionPrecision occlusion_precision =
+            OcclusionPrecision::Single)
+        : Base(delta_time),
+          nr_rows_(nr_rows),
+          nr_cols_(nr_cols),
+          nr_max_poses_(max_sample_count),
+          nr_objects_(vertices_double.size()),
+          initial_occlusion_prob_(initial_occlusion_prob),
+          observation_time_(0),
+          observations_set_(false)
+    {
+        this->default_poses_.recount(nr_objects_);
+        this->default_poses_.setZero();
+
+        std::vector<int> device_list = devices;
+        if (device_list.empty())
+        {
+            int device_count = 0;
+            cudaGetDeviceCount(&device_count);
+            for (int i = 0; i < device_count; ++i) device_list.push_back(i);
+        }
+        if (device_list.empty())
+        {
+            std::cout << "CUDA: no device found" << std::endl;
+            exit(-1);
+        }
+
+        std::vector<std::vector<float>> vertices(nr_objects_);
+        for (int i = 0; i < nr_objects_; ++i)
+        {
+            for (const auto& vertex : vertices_double[i])
+            {
+                vertices[i].push_back(vertex(0));
+                vertices[i].push_back(vertex(1));
+                vertices[i].push_back(vertex(2));
+            }
+        }
+
+        float camera[9];
+        Eigen::Map<Eigen::Matrix<float, 3, 3, Eigen::RowMajor>> camera_map(
+            camera);
+        camera_map = camera_matrix.cast<float>();
+
+        std::shared_ptr<KinectPixelModel> pixel_model;
+        if (max_approximation_error > 0)
+        {
+            pixel_model = std::make_shared<KinectPixelModel>(
+                tail_weight,
+                model_sigma,
+                sigma_factor,
+                -std::log(0.5) / exponential_rate,
+                max_depth);
+            pixel_model->approximate(max_approximation_error);
+        }
+
+        const int nr_devices = device_list.size();
+        share_ = (nr_max_poses_ + nr_devices - 1) / nr_devices;
+
+        partitions_.resize(device_list.size());
+        for (size_t p = 0; p < partitions_.size(); ++p)
+        {
+            Partition& partition = partitions_[p];
+            partition.device = device_list[p];
+
+            partition.evaluator = std::make_shared<CudaEvaluator>(
+                nr_rows_, nr_cols_, partition.device);
+            partition.evaluator->init(initial_occlusion_prob_,
+                                      p_occluded_occluded,
+                                      p_occluded_visible,
+                                      tail_weight,
+                                      model_sigma,
+                                      sigma_factor,
+                                      max_depth,
+                                      exponential_rate);
+
+            if (pixel_model)
+            {
+                const auto& approximation = *pixel_model->approximation();
+                partition.evaluator->set_likelihood_table(
+                    approximation.table,
+                    approximation.data.data(),
+                    approximation.data.size());
+            }
+
+            partition.evaluator->set_occlusion_precision(
+                occlusion_precision);
+
+            // the upper half of the slots receives the occlusions of
+            // ancestors owned by other devices
+            const int nr_slots = 2 * share_;
+            const int max_grid_width = partition.evaluator
+                                           ->get_device_properties()
+                                           .maxGridSize[0];
+            const int nr_poses_per_row =
+                std::max(1, std::min(nr_slots, max_grid_width));
+            partition.evaluator->allocate_memory_for_max_poses(
+                nr_slots,
+                nr_poses_per_row,
+                (nr_slots + nr_poses_per_row - 1) / nr_poses_per_row);
+
+            partition.rasterizer = std::make_shared<CudaRasterizer>(
+                vertices, indices, camera, nr_rows_, nr_cols_, 0.4, 4);
+            partition.rasterizer->allocate_memory_for_max_poses(share_);
+
+            // direct copies between the devices where supported
+            for (size_t q = 0; q < partitions_.size(); ++q)
+            {
+                int can_access = 0;
+                cudaDeviceCanAccessPeer(
+                    &can_access, partition.device, device_list[q]);
+                if (q != p && can_access)
+                {
+                    cudaDeviceEnablePeerAccess(device_list[q], 0);
+                }
+            }
+            cudaGetLastError();
+        }
+
+        reset();
+    }
+
+    /**
+     * \brief computes the loglikelihoods for the given states, see
+     * KinectImageModelGPU::loglikes()
+     */
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& occlusion_indices,
+                       const bool& update_occlusions = false)
+    {
+        if (!observations_set_)
+        {
+            std::cout << "CUDA: observations not set" << std::endl;
+            exit(-1);
+        }
+
+        const int nr_poses = deltas.size();
+        if (nr_poses > nr_max_poses_)
+        {
+            std::cout << "CUDA: " << nr_poses << " poses exceed the maximum "
+                      << "of " << nr_max_poses_ << " poses" << std::endl;
+            exit(-1);
+        }
+
+        distribute(occlusion_indices, nr_poses);
+
+        std::vector<float> default_poses(nr_objects_ * 12);
+        for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+        {
+            Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                &default_poses[i_obj * 12]);
+            pose = this->default_poses_.component(i_obj)
+                       .homogeneous()
+                       .template topRows<3>()
+                       .template cast<float>();
+        }
+
+        // all copies of occlusions have to be issued before any evaluator
+        // switches to its updated occlusions
+        for (auto& partition : partitions_)
+        {
+            cudaSetDevice(partition.device);
+            for (const auto& import : partition.imports)
+            {
+                partition.evaluator->copy_occlusion_probabilities(
+                    import.slot,
+                    *partitions_[import.owner].evaluator,
+                    import.owner_slot);
+            }
+        }
+
+        for (auto& partition : partitions_)
+        {
+            const int nr_local_poses = partition.states.size();
+            if (nr_local_poses == 0) continue;
+
+            cudaSetDevice(partition.device);
+
+            partition.evaluator->set_occlusion_indices(
+                partition.occlusion_indices.data(), nr_local_poses);
+
+            partition.pose_deltas.resize(nr_local_poses * nr_objects_ * 12);
+            for (int i = 0; i < nr_local_poses; ++i)
+            {
+                for (int i_obj = 0; i_obj < nr_objects_; ++i_obj)
+                {
+                    auto delta = deltas[partition.states[i]].component(i_obj);
+                    float* data =
+                        &partition.pose_deltas[(i * nr_objects_ + i_obj) * 12];
+
+                    Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>>
+                        pose(data);
+                    pose.leftCols<3>() = delta.orientation()
+                                             .rotation_matrix()
+                                             .template cast<float>();
+                    pose.col(3) = delta.position().template cast<float>();
+                }
+            }
+
+            partition.rasterizer->render(default_poses,
+                                         partition.pose_deltas.data(),
+                                         nr_local_poses,
+                                         partition.evaluator->stream());
+            partition.evaluator->set_depth_images(
+                partition.rasterizer->get_depth_images());
+            partition.evaluator->set_number_of_poses(nr_local_poses);
+            partition.evaluator->weigh_poses_async(update_occlusions);
+        }
+
+        RealArray log_likelihoods(nr_poses);
+        for (size_t p = 0; p < partitions_.size(); ++p)
+        {
+            Partition& partition = partitions_[p];
+            if (partition.states.empty()) continue;
+
+            cudaSetDevice(partition.device);
+            partition.evaluator->wait_for_log_likelihoods(
+                partition.log_likelihoods);
+
+            for (size_t i = 0; i < partition.states.size(); ++i)
+            {
+                const int state = partition.states[i];
+                log_likelihoods[state] = partition.log_likelihoods[i];
+
+                if (update_occlusions)
+                {
+                    occlusion_owner_[state] = p;
+                    occlusion_slot_[state] = i;
+                }
+            }
+        }
+
+        if (update_occlusions)
+        {
+            for (int i_state = 0; i_state < occlusion_indices.size(); ++i_state)
+            {
+                occlusion_indices[i_state] = i_state;
+            }
+        }
+
+        return log_likelihoods;
+    }
+
+    /**
+     * \brief Sets the observation image that should be used for comparison in
+     * the next evaluation step
+     */
+    void set_observation(const Observation& image)
+    {
+        set_observation(DepthImageView::copy(image, nr_rows_, nr_cols_));
+    }
+
+    /**
+     * \brief Uploads the depths of the view without converting them
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        observation_time_ += this->delta_time_;
+
+        for (auto& partition : partitions_)
+        {
+            cudaSetDevice(partition.device);
+            partition.evaluator->set_observations(image.data(),
+                                                  observation_time_);
+        }
+        observations_set_ = true;
+    }
+
+    /** \brief Resets the occlusion probabilities and observation time */
+    virtual void reset()
+    {
+        const int array_size = nr_rows_ * nr_cols_ * 2 * share_;
+        std::vector<float> occlusion_probabilities(array_size,
+                                                   initial_occlusion_prob_);
+
+        for (auto& partition : partitions_)
+        {
+            cudaSetDevice(partition.device);
+            partition.evaluator->set_occlusion_probabilities(
+                occlusion_probabilities.data(), array_size);
+        }
+
+        // every slot holds the initial occlusions
+        occlusion_owner_.assign(nr_max_poses_, -1);
+        occlusion_slot_.assign(nr_max_poses_, 0);
+
+        observation_time_ = 0;
+    }
+
+    int max_states() const { return nr_max_poses_; }
+
+    /**
+     * \return the occlusion probabilities of all pixels of the state \a index
+     * of the last update
+     */
+    Observation get_occlusions(int index) const
+    {
+        const int owner = std::max(0, occlusion_owner_[index]);
+        const Partition& partition = partitions_[owner];
+
+        cudaSetDevice(partition.device);
+        std::vector<float> occlusion_probs =
+            partition.evaluator->get_occlusion_probabilities(
+                occlusion_slot_[index]);
+
+        return Eigen::Map<Eigen::MatrixXf>(
+                   occlusion_probs.data(), nr_rows_, nr_cols_)
+            .cast<fl::Real>();
+    }
+
+    /** \return the number of devices the states are distributed over */
+    int device_count() const { return partitions_.size(); }
+
+private:
+    struct Import
+    {
+        int slot;
+        int owner;
+        int owner_slot;
+    };
+
+    struct Partition
+    {
+        int device;
+        std::shared_ptr<CudaEvaluator> evaluator;
+        std::shared_ptr<CudaRasterizer> rasterizer;
+
+        // states evaluated on this device and the slots of their ancestors
+        std::vector<int> states;
+        std::vector<int> occlusion_indices;
+        std::vector<Import> imports;
+
+        std::vector<float> pose_deltas;
+        std::vector<float> log_likelihoods;
+    };
+
+    /**
+     * \brief Assigns the states to the devices and determines the slots of
+     * the occlusions of their ancestors
+     */
+    void distribute(const IntArray& occlusion_indices, const int nr_poses)
+    {
+        const int nr_partitions = partitions_.size();
+        const int share = (nr_poses + nr_partitions - 1) / nr_partitions;
+
+        for (auto& partition : partitions_)
+        {
+            partition.states.clear();
+            partition.occlusion_indices.clear();
+            partition.imports.clear();
+        }
+
+        // slot of each ancestor already copied to a device
+        import_slots_.assign(nr_partitions * nr_max_poses_, -1);
+
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            const int ancestor = occlusion_indices[i];
+            const int owner = occlusion_owner_[ancestor];
+            const int owner_slot = occlusion_slot_[ancestor];
+
+            int p = owner;
+            if (p < 0 || int(partitions_[p].states.size()) >= share)
+            {
+                p = 0;
+                for (int q = 1; q < nr_partitions; ++q)
+                {
+                    if (partitions_[q].states.size() <
+                        partitions_[p].states.size())
+                    {
+                        p = q;
+                    }
+                }
+            }
+
+            Partition& partition = partitions_[p];
+            partition.states.push_back(i);
+
+            if (owner < 0 || owner == p)
+            {
+                partition.occlusion_indices.push_back(owner_slot);
+                continue;
+            }
+
+            int& slot = import_slots_[p * nr_max_poses_ + ancestor];
+            if (slot < 0)
+            {
+                slot = share_ + partition.imports.size();
+                partition.imports.push_back(
+                    Import{slot, owner, owner_slot});
+            }
+            partition.occlusion_indices.push_back(slot);
+        }
+    }
+
+private:
+    int nr_rows_;
+    int nr_cols_;
+    int nr_max_poses_;
+    int nr_objects_;
+    float initial_occlusion_prob_;
+    double observation_time_;
+    bool observations_set_;
+
+    // maximum number of states per device
+    int share_;
+    std::vector<Partition> partitions_;
+
+    // device and slot of the occlusions of each state of the last update,
+    // owner -1 denotes the initial occlusions
+    std::vector<int> occlusion_owner_;
+    std::vector<int> occlusion_slot_;
+    std::vector<int> import_slots_;
+};
+}
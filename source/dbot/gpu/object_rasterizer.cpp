@@ -17,16 +17,74 @@
  * \date November 2015
  */
 
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
 #include <Eigen/Geometry> // there is a clash with Success enum and in X.h
 #include <GL/glew.h>
+#ifdef DBOT_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
 #include <GL/glx.h>
+#endif
 #include <dbot/helper_functions.hpp>
+#include <dbot/geometry_registry.hpp>
 #include <dbot/gpu/shader.hpp>
 #include <dbot/gpu/object_rasterizer.hpp>
 
 using namespace std;
 using namespace Eigen;
 
+/* The buffers are deleted by the last rasterizer holding them, with a context of their share group
+ * current. They keep the mesh and the levels alive, hence the addresses identify them as long as the
+ * buffers exist. */
+struct SharedMeshBuffers {
+    SharedMeshBuffers(const std::shared_ptr<const dbot::FlatMesh>& mesh,
+                      const std::shared_ptr<const dbot::MeshLevels>& levels,
+                      const vector<float>& vertices,
+                      const vector<uint>& indices) :
+        mesh(mesh),
+        levels(levels)
+    {
+        glGenBuffers(1, &vertex_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+        glGenBuffers(1, &index_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), indices.data(), GL_STATIC_DRAW);
+    }
+
+    ~SharedMeshBuffers() {
+        glDeleteBuffers(1, &vertex_buffer);
+        glDeleteBuffers(1, &index_buffer);
+    }
+
+    std::shared_ptr<const dbot::FlatMesh> mesh;
+    std::shared_ptr<const dbot::MeshLevels> levels;
+    GLuint vertex_buffer;
+    GLuint index_buffer;
+};
+
+#ifdef DBOT_USE_EGL
+namespace {
+/* The contexts on one EGL display form a share group. EGL initializes a display once, the display is
+ * terminated with the last context on it. */
+struct EGLDisplayUsers {
+    EGLDisplayUsers() : nr_unshared_contexts(0) {}
+
+    std::vector<EGLContext> contexts;   // the share group
+    int nr_unshared_contexts;
+    std::map<std::pair<const void*, const void*>, std::weak_ptr<SharedMeshBuffers> > mesh_buffers;
+};
+
+std::mutex egl_displays_mutex;
+std::map<EGLDisplay, EGLDisplayUsers> egl_displays;
+}
+#endif
+
 ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f> > vertices,
                                    const std::vector<std::vector<std::vector<int> > > indices,
                                    const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
@@ -34,16 +92,44 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
                                    const int nr_rows,
                                    const int nr_cols,
                                    const float near_plane,
-                                   const float far_plane) :
+                                   const float far_plane,
+                                   const int cuda_device) :
+
+    ObjectRasterizer(std::make_shared<dbot::FlatMesh>(vertices, indices),
+                     shader_provider,
+                     camera_matrix,
+                     nr_rows,
+                     nr_cols,
+                     near_plane,
+                     far_plane,
+                     cuda_device)
+{
+}
+
+
+ObjectRasterizer::ObjectRasterizer(const std::shared_ptr<const dbot::FlatMesh>& mesh,
+                                   const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
+                                   const Eigen::Matrix3f camera_matrix,
+                                   const int nr_rows,
+                                   const int nr_cols,
+                                   const float near_plane,
+                                   const float far_plane,
+                                   const int cuda_device) :
 
     nr_rows_(nr_rows),
     nr_cols_(nr_cols),
     near_plane_(near_plane),
-    far_plane_(far_plane)
+    far_plane_(far_plane),
+    camera_matrix_(camera_matrix),
+    tile_row_offset_(0),
+    tile_col_offset_(0)
 {
 
     // ========== CREATE WINDOWLESS OPENGL CONTEXT =========== //
 
+#ifdef DBOT_USE_EGL
+    create_egl_context(cuda_device);
+#else
 
     typedef GLXContext (*glXCreateContextAttribsARBProc)(Display*, GLXFBConfig, GLXContext, Bool, const int*);
     typedef Bool (*glXMakeContextCurrentARBProc)(Display*, GLXDrawable, GLXDrawable, GLXContext);
@@ -107,15 +193,18 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
     XSync(dpy_, False);
 
     /* try to make it the current context */
+    drawable_ = pbuf;
     if ( !glXMakeContextCurrent(dpy_, pbuf, pbuf, ctx_) ){
            /* some drivers do not support context without default framebuffer, so fallback on
             * using the default window.
             */
-           if ( !glXMakeContextCurrent(dpy_, DefaultRootWindow(dpy_), DefaultRootWindow(dpy_), ctx_) ){
+           drawable_ = DefaultRootWindow(dpy_);
+           if ( !glXMakeContextCurrent(dpy_, drawable_, drawable_, ctx_) ){
                    fprintf(stderr, "failed to make current\n");
                    exit(1);
            }
     }
+#endif
 
     /* try it out */
     printf("vendor: %s\n", (const char*)glGetString(GL_VENDOR));
@@ -125,7 +214,12 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
     // Initialize GLEW
 
     glewExperimental = true; // Needed for core profile
-    if (glewInit() != GLEW_OK) {
+    GLenum glew_status = glewInit();
+#if defined(DBOT_USE_EGL) && defined(GLEW_ERROR_NO_GLX_DISPLAY)
+    // GLEW built for GLX fails to load the GLX extensions without a display, which are not needed here
+    if (glew_status == GLEW_ERROR_NO_GLX_DISPLAY) glew_status = GLEW_OK;
+#endif
+    if (glew_status != GLEW_OK) {
         fprintf(stderr, "Failed to initialize GLEW\n");
         exit(EXIT_FAILURE);
     }
@@ -161,33 +255,24 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
 
 
 
-    // ========== CHANGE VERTICES AND INDICES FORMATS SO THAT OPENGL CAN READ THEM =========== //
+    // ========== THE BUFFERS OF THE MESH ARE UPLOADED AS THEY ARE =========== //
 
+    // identical meshes of different trackers are uploaded once
+    mesh_ = dbot::GeometryRegistry::instance().flat_mesh(mesh);
+    vertex_buffer_size_ = mesh_->vertex_buffer().size() * sizeof(float);
+    index_buffer_size_ = mesh_->index_buffer().size() * sizeof(uint);
 
-    std::vector<int> vertices_per_object;
-
-    for (size_t i = 0; i < vertices.size(); i++) {        // each i equals one object
+    start_position_.push_back(0);
+    for (int i = 0; i < mesh_->count_parts(); i++) {    // each i equals one object
         object_numbers_.push_back(i);
-        vertices_per_object.push_back(vertices[i].size());
-        for (size_t j = 0; j < vertices[i].size(); j++) { // each j equals one vertex in that object
-            for (int k = 0; k < vertices[i][j].size(); k++) {  // each k equals one dimension of that vertex
-                vertices_list_.push_back(vertices[i][j][k]);
-            }
-        }
+        indices_per_object_.push_back((mesh_->triangle_end(i) - mesh_->triangle_begin(i)) * 3);
+        start_position_.push_back(mesh_->triangle_end(i) * 3);
     }
 
-    start_position_.push_back(0);
-    int vertex_count = 0;
-    for (size_t i = 0; i < indices.size(); i++) {         // each i equals one object
-        indices_per_object_.push_back(indices[i].size() * 3);
-        start_position_.push_back(start_position_[i] + indices_per_object_[i]);
-        for (size_t j = 0; j < indices[i].size(); j++) {         // each j equals one triangle in that object
-            for (size_t k = 0; k < indices[i][j].size(); k++) {   // each k equals one index for a vertex in that triangle
-                indices_list_.push_back(indices[i][j][k] + vertex_count);
-            }
-        }
-        vertex_count += vertices_per_object[i];
-    }
+    level_tolerance_ = 1;
+    level_ = 0;
+    level_indices_per_object_.assign(1, indices_per_object_);
+    level_start_position_.assign(1, start_position_);
 
 
     // ==================== CREATE AND FILL VAO, VBO & element array ==================== //
@@ -196,30 +281,14 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
     glGenVertexArrays(1, &vertex_array_);
     glBindVertexArray(vertex_array_);
 
-    // creating a vertex buffer object (VBO) and filling it with vertices
-    glGenBuffers(1, &vertex_buffer_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
-    glBufferData(GL_ARRAY_BUFFER, vertices_list_.size() * sizeof(float), &vertices_list_[0], GL_STATIC_DRAW);
-
-    // create and fill index buffer with indices_
-    glGenBuffers(1, &index_buffer_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_list_.size() * sizeof(uint), &indices_list_[0], GL_STATIC_DRAW);
+    // creating the vertex buffer object (VBO) and the index buffer, unless another context of the share
+    // group has uploaded the mesh already
+    mesh_buffers_ = acquire_mesh_buffers(nullptr, mesh_->vertex_buffer(), mesh_->index_buffer());
 
 
     // ============== TELL OPENGL WHERE TO LOOK FOR VERTICES ============== //
 
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
+    bind_mesh_buffers();
 
 
     // ======================= CREATE PBO ======================= //
@@ -257,6 +326,34 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
     model_view_matrix_ID_ = glGetUniformLocation(shader_ID_, "MV");
     projection_matrix_ID_ = glGetUniformLocation(shader_ID_, "P");
 
+    view_matrix_ID_ = glGetUniformLocation(shader_ID_, "V");
+    poses_ID_ = glGetUniformLocation(shader_ID_, "poses");
+    object_index_ID_ = glGetUniformLocation(shader_ID_, "object_index");
+    nr_objects_ID_ = glGetUniformLocation(shader_ID_, "nr_objects");
+    nr_poses_per_row_ID_ = glGetUniformLocation(shader_ID_, "nr_poses_per_row");
+    nr_poses_per_column_ID_ = glGetUniformLocation(shader_ID_, "nr_poses_per_column");
+    tile_scale_ID_ = glGetUniformLocation(shader_ID_, "tile_scale");
+
+    // shaders which do not read their poses from the pose buffer are rendered pose by pose
+    instanced_ = poses_ID_ != -1;
+    if (!instanced_) {
+        std::cout << "WARNING (OPENGL): The shader does not read the poses from "
+                  << "the pose buffer, the poses are rendered one by one." << std::endl;
+    }
+
+
+    // ================= CREATE POSE BUFFER ================= //
+
+    // the poses are stored in a texture buffer which is sampled by the vertex shader
+    glGenBuffers(1, &pose_buffer_);
+    glGenTextures(1, &pose_texture_);
+
+    // the poses are placed into their tiles by the vertex shader, hence the triangles have to be
+    // clipped to the tile boundaries
+    if (instanced_) {
+        for (int i = 0; i < 4; i++) glEnable(GL_CLIP_DISTANCE0 + i);
+    }
+
     /* The view matrix is constant throughout this class since we are not changing the camera position.
        If you are looking to pass a different camera matrix for each render call, move this function
        into the render call and change it to accept the camera position and rotation as parameter
@@ -275,35 +372,69 @@ ObjectRasterizer::ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f
 
     // ========== INITIALIZE & SET DEFAULTS FOR MEASURING EXECUTION TIMES =========== //
 
-#ifdef PROFILING_ACTIVE
     // generate query objects needed for timing OpenGL commands
-    glGenQueries(NR_SUBROUTINES_TO_MEASURE, time_query_);
-
-    nr_calls_ = 0;
-    time_measurement_ = vector<double> (NR_SUBROUTINES_TO_MEASURE, 0);
-    initial_run_ = true;
+    glGenQueries(NR_TIMED_FRAMES_IN_FLIGHT * NR_TIMESTAMPS, &time_query_[0][0]);
+    time_query_frame_ = 0;
 
     strings_for_subroutines.push_back("ATTACH_TEXTURE");
     strings_for_subroutines.push_back("CLEAR_SCREEN");
     strings_for_subroutines.push_back("RENDER");
     strings_for_subroutines.push_back("DETACH_TEXTURE");
 
-    check_GL_errors("Generating time queries");
+    reset_times();
+
+#ifdef PROFILING_ACTIVE
+    timing_enabled_ = true;
+#else
+    timing_enabled_ = false;
 #endif
+
+    check_GL_errors("Generating time queries");
 }
 
 
 
-void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > states,
+void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> >& states,
                               std::vector<std::vector<float> >& depth_values) {
     render(states);
     depth_values = get_depth_values(states.size());
 }
 
 
-void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > states) {
+void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> >& states) {
+
+    int nr_objects = indices_per_object_.size();
+
+    // the states are deltas of identity default poses
+    pose_data_.resize(states.size() * nr_objects * 12);
+    for (size_t i = 0; i < states.size(); i++) {
+        for (int k = 0; k < nr_objects; k++) {
+            Map<Matrix<float, 3, 4, RowMajor> > delta(&pose_data_[(i * nr_objects + k) * 12]);
+            delta = states[i][k].topRows<3>();
+        }
+    }
+
+    render(vector<Matrix4f>(nr_objects, Matrix4f::Identity()), pose_data_.data(), states.size());
+}
+
+
+void ObjectRasterizer::render(const std::vector<Eigen::Matrix4f>& default_poses,
+                              const float* deltas,
+                              const int nr_poses) {
+
+    make_current();
+
+    // all poses are drawn at the level of detail selected at the default poses
+    if (levels_) {
+        vector<Vector3d> positions(default_poses.size());
+        for (size_t i = 0; i < default_poses.size(); i++) {
+            positions[i] = default_poses[i].topRightCorner<3, 1>().cast<double>();
+        }
+        double focal_length = max(camera_matrix_(0, 0), camera_matrix_(1, 1));
+        set_level(levels_->select(positions, focal_length, level_tolerance_));
+    }
 
-    nr_poses_ = states.size();
+    nr_poses_ = nr_poses;
     if (nr_poses_ > max_nr_poses_) {
         std::cout << "ERROR (OPENGL): You tried to evaluate more poses ("
                   << nr_poses_ << ") than specified by max_poses ("
@@ -313,10 +444,7 @@ void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > s
 
     int nr_poses_per_col = ceil(nr_poses_ / (float) max_nr_poses_per_row_);
 
-#ifdef PROFILING_ACTIVE
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[ATTACH_TEXTURE]);
-    nr_calls_++;
-#endif
+    record_timestamp(ATTACH_TEXTURE);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER,        // 1. fbo target: GL_FRAMEBUFFER
                            GL_COLOR_ATTACHMENT0,  // 2. attachment point
@@ -326,27 +454,97 @@ void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > s
 #ifdef DEBUG
     check_GL_errors("attaching texture to framebuffer");
 #endif
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[CLEAR_SCREEN]);
-#endif
+    record_timestamp(CLEAR_SCREEN);
 
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
 #ifdef DEBUG
     check_GL_errors("clearing framebuffer");
 #endif
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[RENDER]);
-#endif
+    record_timestamp(RENDER);
 
     glUniformMatrix4fv(projection_matrix_ID_, 1, GL_FALSE, projection_matrix_.data());
 
-    Matrix4f model_view_matrix;
+    if (instanced_) {
+        int nr_objects = default_poses.size();
+
+        // the default poses are followed by the deltas of all poses
+        vector<float> default_pose_data(nr_objects * 12);
+        for (int k = 0; k < nr_objects; k++) {
+            Map<Matrix<float, 3, 4, RowMajor> > pose(&default_pose_data[k * 12]);
+            pose = default_poses[k].topRows<3>();
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, pose_buffer_);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, default_pose_data.size() * sizeof(float), &default_pose_data[0]);
+        glBufferSubData(GL_TEXTURE_BUFFER, default_pose_data.size() * sizeof(float),
+                        nr_poses_ * nr_objects * 12 * sizeof(float), deltas);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        #ifdef DEBUG
+            check_GL_errors("uploading poses");
+        #endif
+
+        render_instanced(nr_poses_per_col);
+    } else {
+        render_per_pose(default_poses, deltas, nr_poses_per_col);
+    }
+
+
+    record_timestamp(DETACH_TEXTURE);
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER,        // 1. fbo target: GL_FRAMEBUFFER
+                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
+                           GL_TEXTURE_2D,         // 3. tex target: GL_TEXTURE_2D
+                           0,     // 4. tex ID
+                           0);
+
+#ifdef DEBUG
+    check_GL_errors("detaching texture from framebuffer");
+#endif
+
+    record_timestamp(NR_SUBROUTINES_TO_MEASURE);
+
+
+}
+
+
+void ObjectRasterizer::render_instanced(const int nr_poses_per_col) {
+
+    glUniformMatrix4fv(view_matrix_ID_, 1, GL_FALSE, view_matrix_.data());
+    glUniform1i(nr_objects_ID_, indices_per_object_.size());
+    glUniform1i(nr_poses_per_row_ID_, max_nr_poses_per_row_);
+    glUniform1i(nr_poses_per_column_ID_, nr_poses_per_col);
+    glUniform2f(tile_scale_ID_, 1.0f / max_nr_poses_per_row_, 1.0f / max_nr_poses_per_column_);
 
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, pose_texture_);
+    glUniform1i(poses_ID_, 0);
+
+    // the vertex shader places each instance into its tile of the texture
+    glViewport(0, 0, max_nr_poses_per_row_ * nr_cols_, max_nr_poses_per_column_ * nr_rows_);
+
+    for (size_t k = 0; k < object_numbers_.size(); k++) {
+        int index = object_numbers_[k];
+
+        glUniform1i(object_index_ID_, index);
+        glDrawElementsInstanced(GL_TRIANGLES, indices_per_object_[index], GL_UNSIGNED_INT,
+                                (void*) (start_position_[index] * sizeof(uint)), nr_poses_);
+        #ifdef DEBUG
+            check_GL_errors("instanced render call");
+        #endif
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+
+void ObjectRasterizer::render_per_pose(const std::vector<Eigen::Matrix4f>& default_poses,
+                                       const float* deltas,
+                                       const int nr_poses_per_col) {
+
+    int nr_objects = default_poses.size();
+    Matrix4f model_view_matrix;
+    Matrix4f delta = Matrix4f::Identity();
 
     for (int i = 0; i < nr_poses_per_col ; i++) {
         for (int j = 0; j < max_nr_poses_per_row_ && i * max_nr_poses_per_row_ + j < nr_poses_; j++) {
@@ -357,8 +555,11 @@ void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > s
             #endif
             for (size_t k = 0; k < object_numbers_.size(); k++) {
                 int index = object_numbers_[k];
+                int pose_nr = max_nr_poses_per_row_ * i + j;
 
-                model_view_matrix = view_matrix_ * states[max_nr_poses_per_row_ * i + j][index];
+                delta.topRows<3>() = Map<const Matrix<float, 3, 4, RowMajor> >(
+                    deltas + (pose_nr * nr_objects + index) * 12);
+                model_view_matrix = view_matrix_ * default_poses[index] * delta;
                 glUniformMatrix4fv(model_view_matrix_ID_, 1, GL_FALSE, model_view_matrix.data());
 
                 glDrawElements(GL_TRIANGLES, indices_per_object_[index], GL_UNSIGNED_INT, (void*) (start_position_[index] * sizeof(uint)));
@@ -368,36 +569,122 @@ void ObjectRasterizer::render(const std::vector<std::vector<Eigen::Matrix4f> > s
             }
         }
     }
+}
 
 
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[DETACH_TEXTURE]);
-#endif
+void ObjectRasterizer::set_objects(vector<int> object_numbers) {
+    object_numbers_ = object_numbers;
+}
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER,        // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,         // 3. tex target: GL_TEXTURE_2D
-                           0,     // 4. tex ID
-                           0);
+
+void ObjectRasterizer::set_levels_of_detail(const std::shared_ptr<const dbot::MeshLevels>& levels,
+                                            const double tolerance) {
+    make_current();
+
+    levels_ = levels;
+    level_tolerance_ = tolerance;
+    level_indices_per_object_.resize(1);
+    level_start_position_.resize(1);
+
+    // the levels follow the full meshes in the buffers
+    vector<float> vertices_list = mesh_->vertex_buffer();
+    vector<uint> indices_list = mesh_->index_buffer();
+
+    for (int level = 1; levels_ && level < levels_->count_levels(); level++) {
+        dbot::FlatMesh level_mesh(levels_->vertices(level), levels_->triangle_indices(level));
+
+        const uint vertex_count = vertices_list.size() / 3;
+        const int index_count = indices_list.size();
+        vertices_list.insert(vertices_list.end(), level_mesh.vertex_buffer().begin(), level_mesh.vertex_buffer().end());
+        for (size_t i = 0; i < level_mesh.index_buffer().size(); i++) {
+            indices_list.push_back(level_mesh.index_buffer()[i] + vertex_count);
+        }
+
+        vector<int> indices_per_object;
+        vector<int> start_position(1, index_count);
+        for (int i = 0; i < level_mesh.count_parts(); i++) {
+            indices_per_object.push_back((level_mesh.triangle_end(i) - level_mesh.triangle_begin(i)) * 3);
+            start_position.push_back(index_count + level_mesh.triangle_end(i) * 3);
+        }
+
+        level_indices_per_object_.push_back(indices_per_object);
+        level_start_position_.push_back(start_position);
+    }
+
+    vertex_buffer_size_ = vertices_list.size() * sizeof(float);
+    index_buffer_size_ = indices_list.size() * sizeof(uint);
+
+    // the buffers of the full mesh are released once no rasterizer draws from them anymore
+    mesh_buffers_ = acquire_mesh_buffers(levels_, vertices_list, indices_list);
+    bind_mesh_buffers();
 
 #ifdef DEBUG
-    check_GL_errors("detaching texture from framebuffer");
+    check_GL_errors("uploading the levels of detail");
 #endif
 
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    store_time_measurements();
+    set_level(0);
+}
+
+
+std::shared_ptr<SharedMeshBuffers> ObjectRasterizer::acquire_mesh_buffers(const std::shared_ptr<const dbot::MeshLevels>& levels,
+                                                                          const vector<float>& vertices,
+                                                                          const vector<uint>& indices) {
+#ifdef DBOT_USE_EGL
+    if (egl_shares_objects_) {
+        std::lock_guard<std::mutex> lock(egl_displays_mutex);
+
+        auto& mesh_buffers = egl_displays[egl_display_].mesh_buffers;
+        const auto key = std::make_pair((const void*) mesh_.get(), (const void*) levels.get());
+
+        auto buffers = mesh_buffers[key].lock();
+        if (buffers) return buffers;
+
+        for (auto it = mesh_buffers.begin(); it != mesh_buffers.end();) {
+            it = it->second.expired() && it->first != key ? mesh_buffers.erase(it) : std::next(it);
+        }
+
+        // the other contexts see the contents of the buffers once the upload has finished
+        buffers = std::make_shared<SharedMeshBuffers>(mesh_, levels, vertices, indices);
+        glFinish();
+        mesh_buffers[key] = buffers;
+
+        return buffers;
+    }
 #endif
 
+    return std::make_shared<SharedMeshBuffers>(mesh_, levels, vertices, indices);
+}
+
+
+void ObjectRasterizer::bind_mesh_buffers() {
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh_buffers_->index_buffer);
 
+    // 1rst attribute buffer : vertices
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh_buffers_->vertex_buffer);
+    glVertexAttribPointer(
+        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
+        3,                  // size
+        GL_FLOAT,           // type
+        GL_FALSE,           // normalized?
+        0,                  // stride
+        (void*)0            // array buffer offset
+    );
 }
 
 
-void ObjectRasterizer::set_objects(vector<int> object_numbers) {
-    object_numbers_ = object_numbers;
+int ObjectRasterizer::get_level() const {
+    return level_;
+}
+
+
+void ObjectRasterizer::set_level(const int level) {
+    if (level == level_) return;
+
+    level_ = level;
+    indices_per_object_ = level_indices_per_object_[level];
+    start_position_ = level_start_position_[level];
 }
 
 
@@ -411,6 +698,17 @@ void ObjectRasterizer::set_resolution(const int nr_rows, const int nr_cols) {
     nr_rows_ = nr_rows;
     nr_cols_ = nr_cols;
 
+    setup_projection_matrix(camera_matrix_);
+}
+
+
+void ObjectRasterizer::set_tile_offset(const int row_offset, const int col_offset) {
+    if (row_offset == tile_row_offset_ && col_offset == tile_col_offset_) return;
+
+    tile_row_offset_ = row_offset;
+    tile_col_offset_ = col_offset;
+
+    setup_projection_matrix(camera_matrix_);
 }
 
 void ObjectRasterizer::allocate_textures_for_max_poses(int nr_poses,
@@ -429,12 +727,44 @@ void ObjectRasterizer::allocate_textures_for_max_poses(int nr_poses,
     max_nr_poses_per_row_ = nr_poses_per_row;
     max_nr_poses_per_column_ = nr_poses_per_col;
 
+    // every pose takes three texels per object
+    GLint max_texture_buffer_size;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texture_buffer_size);
+    if (instanced_ &&
+        (max_nr_poses_ + 1) * (long) indices_per_object_.size() * 3 > max_texture_buffer_size) {
+        std::cout << "WARNING (OPENGL): Exceeding maximum texture buffer size with "
+                  << nr_poses << " poses, the poses are rendered one by one." << std::endl;
+        instanced_ = false;
+        for (int i = 0; i < 4; i++) glDisable(GL_CLIP_DISTANCE0 + i);
+    }
+
     reallocate_buffers();
 
 }
 
 
 
+void ObjectRasterizer::make_current() {
+
+#ifdef DBOT_USE_EGL
+    if (eglGetCurrentContext() == egl_context_) return;
+
+    if ( !eglMakeCurrent(egl_display_, egl_surface_, egl_surface_, egl_context_) ){
+           fprintf(stderr, "failed to make current\n");
+           exit(1);
+    }
+#else
+    if (glXGetCurrentContext() == ctx_) return;
+
+    if ( !glXMakeContextCurrent(dpy_, drawable_, drawable_, ctx_) ){
+           fprintf(stderr, "failed to make current\n");
+           exit(1);
+    }
+#endif
+}
+
+
+
 GLuint ObjectRasterizer::get_framebuffer_texture() {
     return framebuffer_texture_for_all_poses_;
 }
@@ -443,6 +773,8 @@ GLuint ObjectRasterizer::get_framebuffer_texture() {
 
 vector<vector<float> > ObjectRasterizer::get_depth_values(int nr_poses) {
 
+    make_current();
+
     if (nr_poses > nr_poses_) {
         std::cout << "ERROR (OPENGL): You tried to read back the depth values "
                   << "of more poses than you previously rendered." << std::endl;
@@ -468,7 +800,8 @@ vector<vector<float> > ObjectRasterizer::get_depth_values(int nr_poses) {
 
 
     if (pixel_depth != (GLfloat*) NULL) {
-        int current_nr_poses_per_col = (nr_poses / max_nr_poses_per_row_) + 1;
+        // the tiles are laid out for the number of rendered poses, see render()
+        int current_nr_poses_per_col = ceil(nr_poses_ / (float) max_nr_poses_per_row_);
         int total_nr_pixels = nr_rows_ * nr_cols_ * max_nr_poses_per_row_ * current_nr_poses_per_col;
         vector<float> depth_image(total_nr_pixels, numeric_limits<float>::max());
 
@@ -538,9 +871,10 @@ int ObjectRasterizer::get_max_texture_size() {
 
 void ObjectRasterizer::get_memory_need_parameters(int nr_rows, int nr_cols,
                                 int& constant_need, int& per_pose_need) {
-    constant_need = vertices_list_.size() * sizeof(float)
-                    + indices_list_.size() * sizeof(uint);
-    per_pose_need = nr_rows * nr_cols * (8 + sizeof(float));
+    // planned ahead by dbot::GpuMemoryPlanner, which has to match
+    constant_need = vertex_buffer_size_ + index_buffer_size_;
+    per_pose_need = nr_rows * nr_cols * (8 + sizeof(float))
+                    + indices_per_object_.size() * 12 * sizeof(float);
 }
 
 
@@ -561,6 +895,17 @@ void ObjectRasterizer::reallocate_buffers() {
     glBufferData(GL_PIXEL_PACK_BUFFER, max_nr_poses_per_row_* nr_cols_ * max_nr_poses_per_column_ * nr_rows_ *  sizeof(GLfloat), NULL, GL_STREAM_READ);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
+    // ======================= REALLOCATE POSE BUFFER ======================= //
+
+    // default poses and the deltas of all poses
+    glBindBuffer(GL_TEXTURE_BUFFER, pose_buffer_);
+    glBufferData(GL_TEXTURE_BUFFER, (max_nr_poses_ + 1) * indices_per_object_.size() * 12 * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, pose_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, pose_buffer_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
     // ======================= DETACH TEXTURES FROM FRAMEBUFFER ======================= //
 
     glFramebufferRenderbuffer(GL_FRAMEBUFFER,      // 1. fbo target: GL_FRAMEBUFFER
@@ -618,8 +963,11 @@ void ObjectRasterizer::setup_projection_matrix(const Eigen::Matrix3f camera_matr
 
     Eigen::Matrix3f camera_matrix_inverse = camera_matrix.inverse();
 
-    Vector3f boundaries_min = camera_matrix_inverse * Vector3f(-0.5, -0.5, 1);
-    Vector3f boundaries_max = camera_matrix_inverse * Vector3f(float(nr_cols_)-0.5, float(nr_rows_)-0.5, 1);
+    // each pose is rendered into a tile which covers nr_rows_ x nr_cols_ pixels of the camera image,
+    // starting at the tile offset
+    Vector3f boundaries_min = camera_matrix_inverse * Vector3f(tile_col_offset_ - 0.5, tile_row_offset_ - 0.5, 1);
+    Vector3f boundaries_max = camera_matrix_inverse * Vector3f(float(tile_col_offset_ + nr_cols_) - 0.5,
+                                                               float(tile_row_offset_ + nr_rows_) - 0.5, 1);
 
     float near = near_plane_;
     float far = far_plane_;
@@ -649,38 +997,90 @@ Matrix4f ObjectRasterizer::get_projection_matrix(float n, float f, float l, floa
     return projection_matrix;
 }
 
-void ObjectRasterizer::store_time_measurements() {
-#ifdef PROFILING_ACTIVE
+void ObjectRasterizer::set_timing_enabled(bool enabled) {
+    timing_enabled_ = enabled;
+}
 
-    // retrieve times from OpenGL and store them
-    for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE; i++) {
-        GLint available = 0;
-        double time_elapsed_s;
-        unsigned int time_elapsed_ns;
 
-        while (!available) {
-            glGetQueryObjectiv(time_query_[i], GL_QUERY_RESULT_AVAILABLE, &available);
-        }
-        glGetQueryObjectuiv(time_query_[i], GL_QUERY_RESULT, &time_elapsed_ns);
-        time_elapsed_s = time_elapsed_ns / (double) 1e9;
-        time_measurement_[i] += time_elapsed_s;
+bool ObjectRasterizer::timing_enabled() const {
+    return timing_enabled_;
+}
+
 
+vector<double> ObjectRasterizer::get_average_times() const {
+    vector<double> average_times(NR_SUBROUTINES_TO_MEASURE, 0);
+    for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE && nr_calls_ > 0; i++) {
+        average_times[i] = time_measurement_[i] / nr_calls_;
     }
+    return average_times;
+}
+
+
+vector<double> ObjectRasterizer::get_last_times() const {
+    return last_time_measurement_;
+}
+
+
+int ObjectRasterizer::get_nr_timed_frames() const {
+    return nr_calls_;
+}
 
-    // the first run should not count. Reset all the counters.
-    if (initial_run_) {
-        initial_run_ = false;
-        for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE; i++) {
-            time_measurement_[i] = 0;
-        }
 
-        nr_calls_ = 0;
+void ObjectRasterizer::reset_times() {
+    nr_calls_ = 0;
+    time_measurement_ = vector<double> (NR_SUBROUTINES_TO_MEASURE, 0);
+    last_time_measurement_ = vector<double> (NR_SUBROUTINES_TO_MEASURE, 0);
+
+    // results of queries issued before the reset are discarded as well
+    for (int i = 0; i < NR_TIMED_FRAMES_IN_FLIGHT; i++) {
+        time_query_pending_[i] = false;
     }
-#endif
 }
 
 
-string ObjectRasterizer::get_text_for_enum( int enumVal ) {
+void ObjectRasterizer::record_timestamp(int subroutine) {
+    if (!timing_enabled_) return;
+
+    int frame_slot = time_query_frame_ % NR_TIMED_FRAMES_IN_FLIGHT;
+
+    // the first timestamp of a frame reuses the slot of an older frame, whose results are collected first
+    if (subroutine == 0 && time_query_pending_[frame_slot]) {
+        store_time_measurements(frame_slot);
+    }
+
+    glQueryCounter(time_query_[frame_slot][subroutine], GL_TIMESTAMP);
+
+    if (subroutine == NR_SUBROUTINES_TO_MEASURE) {
+        time_query_pending_[frame_slot] = true;
+        time_query_frame_++;
+    }
+}
+
+
+void ObjectRasterizer::store_time_measurements(int frame_slot) {
+    time_query_pending_[frame_slot] = false;
+
+    // never wait for the GPU. The frame is dropped if its results are still not available.
+    GLint available = 0;
+    glGetQueryObjectiv(time_query_[frame_slot][NR_SUBROUTINES_TO_MEASURE], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 timestamps[NR_TIMESTAMPS];
+    for (int i = 0; i < NR_TIMESTAMPS; i++) {
+        glGetQueryObjectui64v(time_query_[frame_slot][i], GL_QUERY_RESULT, &timestamps[i]);
+    }
+
+    for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE; i++) {
+        double time_elapsed_s = (timestamps[i + 1] - timestamps[i]) / (double) 1e9;
+        last_time_measurement_[i] = time_elapsed_s;
+        time_measurement_[i] += time_elapsed_s;
+    }
+
+    nr_calls_++;
+}
+
+
+string ObjectRasterizer::get_text_for_enum( int enumVal ) const {
     return strings_for_subroutines[enumVal];
 }
 
@@ -738,15 +1138,15 @@ ObjectRasterizer::~ObjectRasterizer()
     if (nr_calls_ != 0) {
         cout << endl << "Time measurements for the different steps of the rendering process averaged over " << nr_calls_ << " render calls:" << endl << endl;
 
+        vector<double> average_times = get_average_times();
         double total_time_per_render = 0;
 
         for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE; i++) {
-            total_time_per_render += time_measurement_[i];
+            total_time_per_render += average_times[i];
         }
-        total_time_per_render /= nr_calls_;
 
         for (int i = 0; i < NR_SUBROUTINES_TO_MEASURE; i++) {
-            double time_per_subroutine = time_measurement_[i] / nr_calls_;
+            double time_per_subroutine = average_times[i];
 
                 cout << get_text_for_enum(i) << ":     "
                      << "\t " << time_per_subroutine << " s \t " << setprecision(1)
@@ -758,22 +1158,148 @@ ObjectRasterizer::~ObjectRasterizer()
         cout << "The render() function was never called, so there are no time measurements of it available." << endl;
     }
 
-    glDeleteQueries(NR_SUBROUTINES_TO_MEASURE, time_query_);
 #endif
 
+    make_current();
+
+    glDeleteQueries(NR_TIMED_FRAMES_IN_FLIGHT * NR_TIMESTAMPS, &time_query_[0][0]);
+
     glDisableVertexAttribArray(0);
     glDeleteVertexArrays(1, &vertex_array_);
 
-    glDeleteBuffers(1, &vertex_buffer_);
-    glDeleteBuffers(1, &index_buffer_);
+    mesh_buffers_.reset();
     glDeleteBuffers(1, &result_buffer_);
+    glDeleteBuffers(1, &pose_buffer_);
+    glDeleteTextures(1, &pose_texture_);
 
     glDeleteFramebuffers(1, &framebuffer_);
     glDeleteTextures(1, &framebuffer_texture_for_all_poses_);
     glDeleteRenderbuffers(1, &texture_for_z_testing);
 
     glDeleteProgram(shader_ID_);
+#ifdef DBOT_USE_EGL
+    eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    std::lock_guard<std::mutex> lock(egl_displays_mutex);
+    if (egl_surface_ != EGL_NO_SURFACE) eglDestroySurface(egl_display_, egl_surface_);
+    eglDestroyContext(egl_display_, egl_context_);
+
+    // the display is shared by the rasterizers on the same GPU
+    EGLDisplayUsers& users = egl_displays[egl_display_];
+    if (egl_shares_objects_) {
+        users.contexts.erase(std::remove(users.contexts.begin(), users.contexts.end(), egl_context_),
+                             users.contexts.end());
+    } else {
+        users.nr_unshared_contexts--;
+    }
+    if (users.contexts.empty() && users.nr_unshared_contexts == 0) {
+        egl_displays.erase(egl_display_);
+        eglTerminate(egl_display_);
+    }
+#else
     glXDestroyContext(dpy_, ctx_);
+#endif
 
 }
 
+
+#ifdef DBOT_USE_EGL
+void ObjectRasterizer::create_egl_context(const int cuda_device) {
+
+    PFNEGLQUERYDEVICESEXTPROC eglQueryDevicesEXT =
+        (PFNEGLQUERYDEVICESEXTPROC) eglGetProcAddress("eglQueryDevicesEXT");
+    PFNEGLQUERYDEVICEATTRIBEXTPROC eglQueryDeviceAttribEXT =
+        (PFNEGLQUERYDEVICEATTRIBEXTPROC) eglGetProcAddress("eglQueryDeviceAttribEXT");
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    /* pick the EGL device backing the CUDA device, which keeps the interop on one GPU */
+    egl_display_ = EGL_NO_DISPLAY;
+    if (eglQueryDevicesEXT && eglGetPlatformDisplayEXT) {
+        const int max_nr_devices = 16;
+        EGLDeviceEXT devices[max_nr_devices];
+        EGLint nr_devices = 0;
+        eglQueryDevicesEXT(max_nr_devices, devices, &nr_devices);
+
+        int selected_device = 0;
+        for (int i = 0; cuda_device >= 0 && eglQueryDeviceAttribEXT && i < nr_devices; i++) {
+            EGLAttrib device_of_egl_device;
+            if (eglQueryDeviceAttribEXT(devices[i], EGL_CUDA_DEVICE_NV, &device_of_egl_device) &&
+                device_of_egl_device == cuda_device) {
+                selected_device = i;
+                break;
+            }
+        }
+
+        if (nr_devices > 0) {
+            egl_display_ = eglGetPlatformDisplayEXT(EGL_PLATFORM_DEVICE_EXT, devices[selected_device], 0);
+        }
+    }
+    if (egl_display_ == EGL_NO_DISPLAY) {
+        egl_display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    std::lock_guard<std::mutex> lock(egl_displays_mutex);
+    EGLDisplayUsers& users = egl_displays[egl_display_];
+
+    EGLint major, minor;
+    if ( !eglInitialize(egl_display_, &major, &minor) ){
+           fprintf(stderr, "Failed to initialize EGL\n");
+           exit(1);
+    }
+
+    /* any config is usable since we render into our own framebuffer */
+    static const EGLint config_attribs[] = {
+           EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+           EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+           EGL_NONE
+    };
+    EGLConfig config;
+    EGLint nr_configs = 0;
+    if ( !eglChooseConfig(egl_display_, config_attribs, &config, 1, &nr_configs) || nr_configs < 1 ){
+           fprintf(stderr, "Failed to get EGLConfig\n");
+           exit(1);
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint context_attribs[] = {
+           EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+           EGL_CONTEXT_MINOR_VERSION_KHR, 2,
+           EGL_NONE
+    };
+    /* join the share group of the display, a context which cannot share keeps its own objects */
+    egl_context_ = EGL_NO_CONTEXT;
+    egl_shares_objects_ = false;
+    if (!users.contexts.empty()) {
+           egl_context_ = eglCreateContext(egl_display_, config, users.contexts.front(), context_attribs);
+           egl_shares_objects_ = egl_context_ != EGL_NO_CONTEXT;
+    }
+    if (egl_context_ == EGL_NO_CONTEXT) {
+           egl_context_ = eglCreateContext(egl_display_, config, EGL_NO_CONTEXT, context_attribs);
+           egl_shares_objects_ = users.contexts.empty();
+    }
+    if (egl_context_ == EGL_NO_CONTEXT) {
+           fprintf(stderr, "Failed to create opengl context\n");
+           exit(1);
+    }
+    if (egl_shares_objects_) users.contexts.push_back(egl_context_);
+    else users.nr_unshared_contexts++;
+
+    /* try a surfaceless context first, some drivers require a pbuffer */
+    egl_surface_ = EGL_NO_SURFACE;
+    if ( !eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context_) ){
+           const EGLint pbuffer_attribs[] = {
+                  EGL_WIDTH, nr_cols_,
+                  EGL_HEIGHT, nr_rows_,
+                  EGL_NONE
+           };
+           egl_surface_ = eglCreatePbufferSurface(egl_display_, config, pbuffer_attribs);
+           if ( !eglMakeCurrent(egl_display_, egl_surface_, egl_surface_, egl_context_) ){
+                   fprintf(stderr, "failed to make current\n");
+                   exit(1);
+           }
+    }
+}
+#endif
+
@@ -22,11 +22,20 @@
 #include <vector>
 #include <Eigen/Dense>
 #include "GL/glew.h"
+#ifdef DBOT_USE_EGL
+#include <EGL/egl.h>
+#else
 #include <GL/glx.h>
+#endif
 
+#include <dbot/flat_mesh.hpp>
+#include <dbot/mesh_levels.hpp>
 #include <dbot/gpu/shader_provider.hpp>
 #include <memory>
 
+// vertex and index buffers of a mesh and its levels of detail, see object_rasterizer.cpp
+struct SharedMeshBuffers;
+
  /**
  * \brief renders the objects using openGL rasterization.
  * The objects that should be rendered have to be passed in the constructor and can then be rendered
@@ -37,6 +46,10 @@
 class ObjectRasterizer
 {
 public:
+    // phases of a render call whose GPU execution times can be measured
+    static const int NR_SUBROUTINES_TO_MEASURE = 4;
+    enum subroutines_to_measure { ATTACH_TEXTURE, CLEAR_SCREEN, RENDER, DETACH_TEXTURE};
+
     /**
      * \brief constructor which takes the vertices and indices that describe the objects as input. The paths to the
      * shader files and the instrinsic camera matrix also have to be passed here.
@@ -54,6 +67,11 @@ public:
      * be similar to the minimal distance up to which the sensor can see objects.
      * \param [in]  far_plane everything further away than the far plane will not be rendered. This should
      * be similar to the maximum distance up to which the sensor can see objects.
+     * \param [in]  cuda_device the CUDA device that will read the rendered depth values. If compiled with
+     * DBOT_USE_EGL, the context is created without any display on the GPU of this device, or on the first
+     * GPU if negative. The GLX context always uses the GPU of the X display. The EGL contexts of all
+     * rasterizers on the same GPU share their objects, rasterizers of the same mesh draw from the same
+     * vertex and index buffers.
      */
     ObjectRasterizer(const std::vector<std::vector<Eigen::Vector3f> > vertices,
                      const std::vector<std::vector<std::vector<int> > > indices,
@@ -62,7 +80,21 @@ public:
                      const int nr_rows,
                      const int nr_cols,
                      const float near_plane = 0.4,
-                     const float far_plane = 4);
+                     const float far_plane = 4,
+                     const int cuda_device = -1);
+
+    /**
+     * \brief constructor which uploads the buffers of the shared mesh as they are, each object being one
+     * part of the mesh. See the constructor above for the remaining parameters.
+     */
+    ObjectRasterizer(const std::shared_ptr<const dbot::FlatMesh>& mesh,
+                     const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
+                     const Eigen::Matrix3f camera_matrix,
+                     const int nr_rows,
+                     const int nr_cols,
+                     const float near_plane = 0.4,
+                     const float far_plane = 4,
+                     const int cuda_device = -1);
 
     /** destructor which deletes the buffers and programs used by openGL */
     ~ObjectRasterizer();
@@ -77,7 +109,7 @@ public:
      * and the translation for each object per pose.
      * \param [out] depth_values [pose_nr][0 - nr_pixels] = {depth value of that pixel}
      */
-    void render(const std::vector<std::vector<Eigen::Matrix4f> > states,
+    void render(const std::vector<std::vector<Eigen::Matrix4f> >& states,
                 std::vector<std::vector<float> >& depth_values);
 
     /**
@@ -87,7 +119,22 @@ public:
      * \param [in]  states [pose_nr][object_nr][0 - 6] = {qw, qx, qy, qz, tx, ty, tz}. This should contain the quaternion
      * and the translation for each object per pose.
      */
-    void render(const std::vector<std::vector<Eigen::Matrix4f> > states);
+    void render(const std::vector<std::vector<Eigen::Matrix4f> >& states);
+
+    /**
+     * \brief render the objects in poses given relative to default poses into a texture that can then be
+     * accessed by CUDA.
+     * All poses are uploaded into one buffer and each object is drawn once for all poses by an instanced
+     * draw call. The poses are composed in the vertex shader, the pose of object k in pose i is
+     * default_poses[k] * delta_i_k.
+     * \param [in]  default_poses [object_nr] = {homogeneous transformation of that object}
+     * \param [in]  deltas [pose_nr][object_nr][0 - 11] = {first three rows of the homogeneous relative
+     * transformation in row major order}. This should contain 12 * nr_poses * nr_objects values.
+     * \param [in]  nr_poses the number of poses to render
+     */
+    void render(const std::vector<Eigen::Matrix4f>& default_poses,
+                const float* deltas,
+                const int nr_poses);
 
     /**
      * \brief sets the objects that should be rendered.
@@ -98,13 +145,36 @@ public:
      */
     void set_objects(std::vector<int> object_numbers);
 
+    /**
+     * \brief uploads the levels of detail of the object meshes.
+     * Every following render() call with default poses draws all objects at the coarsest level whose
+     * error projected at the default poses stays below the tolerance.
+     * \param [in]  levels the levels of detail, the first of which has to be the meshes passed in the
+     * constructor. A null pointer removes all levels beyond the full meshes.
+     * \param [in]  tolerance the largest projected error of a selected level in pixels
+     */
+    void set_levels_of_detail(const std::shared_ptr<const dbot::MeshLevels>& levels,
+                              const double tolerance);
+
+    /** \return the level of detail drawn by the last render call, 0 is the full mesh */
+    int get_level() const;
+
     /**
      * \brief set a new resolution.
+     * The resolution is the size of the tile each pose is rendered into. If it is smaller than the camera image,
+     * the tiles only cover the region of interest starting at the tile offset, see set_tile_offset().
      * \param [in]  nr_rows the height of the image
      * \param [in]  nr_cols the width of the image
      */
     void set_resolution(const int nr_rows, const int nr_cols);
 
+    /**
+     * \brief sets the pixel of the camera image which is rendered into the upper left pixel of each tile.
+     * \param [in]  row_offset the image row of the first tile row
+     * \param [in]  col_offset the image column of the first tile column
+     */
+    void set_tile_offset(const int row_offset, const int col_offset);
+
     /**
      * \brief allocates memory on the GPU.
      * Use this function to allocate memory for the maximum number of poses that you will need throughout the filtering.
@@ -131,6 +201,13 @@ public:
      */
     std::vector<std::vector<float> > get_depth_values(int nr_poses);
 
+    /**
+     * \brief makes the OpenGL context of this rasterizer current in the calling thread.
+     * The context is made current on construction. Rendering calls it again, such that
+     * several rasterizers can be used alternately by one thread.
+     */
+    void make_current();
+
     /**
      * \brief returns the constant and per-pose memory needs that OpenGL will have (in bytes)
      * \param [in] nr_rows the vertical resolution per pose rendering
@@ -149,10 +226,51 @@ public:
      */
     int get_max_texture_size();
 
+    /**
+     * \brief enables or disables measuring the GPU execution time of the render phases.
+     * The phases are delimited by timestamp queries which are read back a few frames later without
+     * synchronizing with the GPU. Disabled timing issues no queries at all. Timing is enabled by
+     * default if compiled with PROFILING_ACTIVE.
+     */
+    void set_timing_enabled(bool enabled);
+
+    /** \return whether the render phases are currently timed */
+    bool timing_enabled() const;
+
+    /**
+     * \brief returns the GPU execution times of the render phases averaged over all timed frames
+     * \return [subroutine] = {time in seconds}, indexed by subroutines_to_measure
+     */
+    std::vector<double> get_average_times() const;
+
+    /**
+     * \brief returns the GPU execution times of the render phases of the most recent timed frame
+     * whose results are available
+     * \return [subroutine] = {time in seconds}, indexed by subroutines_to_measure
+     */
+    std::vector<double> get_last_times() const;
+
+    /** \return the number of frames which contributed to get_average_times() */
+    int get_nr_timed_frames() const;
+
+    /** \return the name of the given render phase */
+    std::string get_text_for_enum(int enumVal) const;
+
+    /** \brief discards all time measurements */
+    void reset_times();
+
 private:
     // OpenGL context variables
+#ifdef DBOT_USE_EGL
+    EGLDisplay egl_display_;
+    EGLContext egl_context_;
+    EGLSurface egl_surface_;
+    bool egl_shares_objects_;   // whether the context is in the share group of its display
+#else
     Display* dpy_;
     GLXContext ctx_;
+    GLXDrawable drawable_;
+#endif
 
 
     // GPU constraints
@@ -165,6 +283,11 @@ private:
     // values initialized in constructor. Cannot be changed afterwards.
     float near_plane_;
     float far_plane_;
+    Eigen::Matrix3f camera_matrix_;
+
+    // image pixel rendered into the upper left pixel of each tile
+    int tile_row_offset_;
+    int tile_col_offset_;
 
     // number of poses in the current render call
     int nr_poses_;
@@ -174,24 +297,38 @@ private:
     int max_nr_poses_per_row_;
     int max_nr_poses_per_column_;
 
-    // needed for OpenGL time measurement
-    static const int NR_SUBROUTINES_TO_MEASURE = 4;
-    GLuint time_query_[NR_SUBROUTINES_TO_MEASURE];
-    enum subroutines_to_measure { ATTACH_TEXTURE, CLEAR_SCREEN, RENDER, DETACH_TEXTURE};
+    // needed for OpenGL time measurement. Each frame records a timestamp before every phase and after
+    // the last one. The queries of a frame are read back when its slot in the ring is reused.
+    static const int NR_TIMED_FRAMES_IN_FLIGHT = 4;
+    static const int NR_TIMESTAMPS = NR_SUBROUTINES_TO_MEASURE + 1;
+    GLuint time_query_[NR_TIMED_FRAMES_IN_FLIGHT][NR_TIMESTAMPS];
+    bool time_query_pending_[NR_TIMED_FRAMES_IN_FLIGHT];
+    int time_query_frame_;
+    bool timing_enabled_;
     std::vector<std::string> strings_for_subroutines;
     std::vector<double> time_measurement_;
+    std::vector<double> last_time_measurement_;
     int nr_calls_;
-    bool initial_run_;  // the first run should not count
 
-    // lists of all vertices and indices of all objects
-    std::vector<float> vertices_list_;
-    std::vector<uint> indices_list_;
+    // meshes of all objects and the sizes of the vertex and index buffers, which also contain the levels
+    // of detail
+    std::shared_ptr<const dbot::FlatMesh> mesh_;
+    size_t vertex_buffer_size_;
+    size_t index_buffer_size_;
     std::vector<int> indices_per_object_;
     std::vector<int> start_position_;
 
     // contains a list of object indices which should be rendered
     std::vector<int> object_numbers_;
 
+    // levels of detail and the index ranges of all objects on each level. indices_per_object_ and
+    // start_position_ hold the ranges of the selected level.
+    std::shared_ptr<const dbot::MeshLevels> levels_;
+    double level_tolerance_;
+    int level_;
+    std::vector<std::vector<int> > level_indices_per_object_;
+    std::vector<std::vector<int> > level_start_position_;
+
     // matrices to transform vertices into image space
     Eigen::Matrix4f projection_matrix_;
     Eigen::Matrix4f view_matrix_;
@@ -201,10 +338,27 @@ private:
     GLuint model_view_matrix_ID_;    // ID to which we pass the modelview matrix
     GLuint projection_matrix_ID_;    // ID to which we pass the projection matrix
 
+    // uniform IDs of the instanced shader. Shaders which do not read the poses from the pose buffer
+    // are rendered pose by pose.
+    bool instanced_;
+    GLint view_matrix_ID_;
+    GLint poses_ID_;
+    GLint object_index_ID_;
+    GLint nr_objects_ID_;
+    GLint nr_poses_per_row_ID_;
+    GLint nr_poses_per_column_ID_;
+    GLint tile_scale_ID_;
+
+    // texture buffer holding the default poses followed by the pose deltas as 3 x 4 row major
+    // matrices, one RGBA texel per row
+    GLuint pose_buffer_;
+    GLuint pose_texture_;
+    std::vector<float> pose_data_;
+
     // VAO, VBO and element arrays are needed to store the object meshes
     GLuint vertex_array_;   // The vertex array contains the vertex and index buffers
-    GLuint vertex_buffer_;    // contains the vertices of the object meshes passed in the constructor
-    GLuint index_buffer_;     // contains the indices of the object meshes passed in the constructor
+    std::shared_ptr<SharedMeshBuffers> mesh_buffers_;   // the vertices and indices of the object meshes
+                                                        // passed in the constructor and their levels
 
     // PBO for copying results to CPU for debugging
     GLuint result_buffer_;
@@ -220,14 +374,37 @@ private:
 
     void reallocate_buffers();
 
+    // selects the index ranges drawn for each object
+    void set_level(const int level);
+
+    // returns the buffers of the mesh and the given levels from the share group of the context, or
+    // uploads the given vertices and indices
+    std::shared_ptr<SharedMeshBuffers> acquire_mesh_buffers(const std::shared_ptr<const dbot::MeshLevels>& levels,
+                                                            const std::vector<float>& vertices,
+                                                            const std::vector<uint>& indices);
+
+    // points the vertex array at the mesh buffers
+    void bind_mesh_buffers();
+
+#ifdef DBOT_USE_EGL
+    // creates a context without display on the EGL device of the given CUDA device
+    void create_egl_context(const int cuda_device);
+#endif
+
+    // draw calls of the instanced and the pose by pose path
+    void render_instanced(const int nr_poses_per_col);
+    void render_per_pose(const std::vector<Eigen::Matrix4f>& default_poses,
+                         const float* deltas,
+                         const int nr_poses_per_col);
+
     // set up view- and projection-matrix
     void setup_view_matrix();
     void setup_projection_matrix(const Eigen::Matrix3f camera_matrix);
     Eigen::Matrix4f get_projection_matrix(float n, float f, float l, float r, float t, float b);
 
     // functions for time measurement
-    void store_time_measurements();
-    std::string get_text_for_enum( int enumVal );
+    void record_timestamp(int subroutine);
+    void store_time_measurements(int frame_slot);
 
     // functions for error checking
     void check_GL_errors(const char *label);
@@ -0,0 +1,117 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_gpu.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <dbot/gpu/rigid_body_renderer_gpu.hpp>
+
+#include <limits>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include <dbot/gpu/object_rasterizer.hpp>
+
+namespace dbot
+{
+RigidBodyRendererGPU::RigidBodyRendererGPU(
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices,
+    const std::shared_ptr<ShaderProvider>& shader_provider,
+    Matrix camera_matrix,
+    int n_rows,
+    int n_cols,
+    int max_nr_poses)
+    : RigidBodyRenderer(vertices, indices, camera_matrix, n_rows, n_cols),
+      max_nr_poses_(max_nr_poses)
+{
+    std::vector<std::vector<Eigen::Vector3f>> float_vertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        for (const auto& vertex : vertices[i])
+        {
+            float_vertices[i].push_back(vertex.cast<float>());
+        }
+    }
+
+    rasterizer_ =
+        std::make_shared<ObjectRasterizer>(float_vertices,
+                                           indices,
+                                           shader_provider,
+                                           camera_matrix.cast<float>(),
+                                           n_rows,
+                                           n_cols);
+
+    const int max_texture_size = rasterizer_->get_max_texture_size();
+    const int nr_poses_per_row =
+        std::max(1, std::min(max_nr_poses_, max_texture_size / n_cols));
+    const int nr_poses_per_col =
+        (max_nr_poses_ + nr_poses_per_row - 1) / nr_poses_per_row;
+
+    if (nr_poses_per_col * n_rows > max_texture_size)
+    {
+        std::cout << "ERROR (OPENGL): " << max_nr_poses_ << " poses of "
+                  << n_rows << " x " << n_cols << " pixels exceed the maximum "
+                  << "texture size of " << max_texture_size << "." << std::endl;
+        exit(-1);
+    }
+
+    rasterizer_->allocate_textures_for_max_poses(
+        max_nr_poses_, nr_poses_per_row, nr_poses_per_col);
+}
+
+RigidBodyRendererGPU::~RigidBodyRendererGPU() {}
+
+void RigidBodyRendererGPU::Render(
+    const std::vector<std::vector<Affine>>& poses,
+    std::vector<std::vector<float>>& depth_images)
+{
+    depth_images.resize(poses.size());
+
+    for (int first = 0; first < int(poses.size()); first += max_nr_poses_)
+    {
+        const int nr_poses = std::min(max_nr_poses_, int(poses.size()) - first);
+
+        pass_poses_.resize(nr_poses);
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            const auto& parts = poses[first + i];
+
+            pass_poses_[i].resize(parts.size());
+            for (size_t k = 0; k < parts.size(); ++k)
+            {
+                pass_poses_[i][k] = parts[k].matrix().cast<float>();
+            }
+        }
+
+        rasterizer_->render(pass_poses_);
+        auto depth_values = rasterizer_->get_depth_values(nr_poses);
+
+        // the rasterizer leaves pixels without any part at 0
+        for (int i = 0; i < nr_poses; ++i)
+        {
+            auto& depth_image = depth_images[first + i];
+            depth_image.swap(depth_values[i]);
+
+            for (auto& depth : depth_image)
+            {
+                if (depth == 0) depth = std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+}
+}
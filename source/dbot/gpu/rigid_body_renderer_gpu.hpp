@@ -0,0 +1,84 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_gpu.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/rigid_body_renderer.hpp>
+#include <dbot/gpu/shader_provider.hpp>
+
+class ObjectRasterizer;
+
+namespace dbot
+{
+/**
+ * \brief Rigid body renderer which renders batches of poses with the
+ * ObjectRasterizer.
+ *
+ * All poses of a batch are rendered in one OpenGL pass into the tiles of one
+ * texture and read back at once. Single poses are still rendered by the CPU
+ * implementation of RigidBodyRenderer. The OpenGL context belongs to the
+ * thread constructing the renderer, hence batches have to be rendered by that
+ * thread.
+ */
+class RigidBodyRendererGPU : public RigidBodyRenderer
+{
+public:
+    /**
+     * \param vertices [part_nr][vertex_nr] = {x, y, z}
+     * \param indices [part_nr][triangle_nr][0 - 2] = {index}
+     * \param shader_provider the shaders of the rasterizer
+     * \param camera_matrix the intrinsic camera matrix
+     * \param n_rows the vertical resolution of the depth images
+     * \param n_cols the horizontal resolution of the depth images
+     * \param max_nr_poses the number of poses rendered in one pass. Larger
+     * batches are rendered in several passes.
+     */
+    RigidBodyRendererGPU(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const std::shared_ptr<ShaderProvider>& shader_provider,
+        Matrix camera_matrix,
+        int n_rows,
+        int n_cols,
+        int max_nr_poses);
+
+    virtual ~RigidBodyRendererGPU();
+
+    using RigidBodyRenderer::Render;
+
+    /**
+     * \brief Renders the poses in batches of at most max_nr_poses poses, see
+     * RigidBodyRenderer::Render()
+     */
+    void Render(const std::vector<std::vector<Affine>>& poses,
+                std::vector<std::vector<float>>& depth_images) override;
+
+private:
+    int max_nr_poses_;
+    std::shared_ptr<ObjectRasterizer> rasterizer_;
+
+    // poses of the current pass in the camera frame
+    std::vector<std::vector<Eigen::Matrix4f>> pass_poses_;
+};
+}
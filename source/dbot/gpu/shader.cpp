@@ -52,6 +52,18 @@ GLuint LoadShaders(const std::shared_ptr<dbot::ShaderProvider>& shaderProvider)
     return theProgram;
 }
 
+GLuint LoadComputeShader(const std::string& computeShader)
+{
+    std::vector<GLuint> shaderList(
+        1, CreateShader(GL_COMPUTE_SHADER, computeShader));
+
+    GLuint theProgram = CreateProgram(shaderList);
+
+    std::for_each(shaderList.begin(), shaderList.end(), glDeleteShader);
+
+    return theProgram;
+}
+
 // source:
 // http://www.arcsynthesis.org/gltut/Basics/Tut01%20Making%20Shaders.html, Jason
 // L. McKesson, 2012
@@ -86,6 +98,9 @@ GLuint CreateShader(GLenum eShaderType, const std::string& shaderCode)
             case GL_FRAGMENT_SHADER:
                 strShaderType = "fragment";
                 break;
+            case GL_COMPUTE_SHADER:
+                strShaderType = "compute";
+                break;
         }
 
         fprintf(stderr,
@@ -27,5 +27,6 @@
 #include <dbot/gpu/shader_provider.hpp>
 
 GLuint LoadShaders(const std::shared_ptr<dbot::ShaderProvider> &shaderProvider);
+GLuint LoadComputeShader(const std::string& computeShader);
 GLuint CreateShader(GLenum eShaderType, const std::string& shaderCode);
 GLuint CreateProgram(const std::vector<GLuint> &shaderList);
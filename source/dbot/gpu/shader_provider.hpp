@@ -55,5 +55,18 @@ public:
      *        shader definition
      */
     virtual bool has_geometry_shader() const = 0;
+
+    /**
+     * \brief Returns the compute shader source code which weighs the
+     *        rendered depths, see GLLikelihoodEvaluator. Empty selects the
+     *        default compute shader.
+     */
+    virtual std::string compute_shader() const { return ""; }
+
+    /**
+     * \brief Returns whether the current shader provider provides a compute
+     *        shader definition
+     */
+    virtual bool has_compute_shader() const { return false; }
 };
 }
@@ -0,0 +1,278 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_memory_planner.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <limits>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include <dbot/gpu_memory_planner.hpp>
+
+namespace dbot
+{
+namespace
+{
+/** \return the rows and columns of a tile of \a request */
+void tile_size(const GpuMemoryPlanner::Request& request, int& rows, int& cols)
+{
+    rows = request.tile_rows > 0 ? std::min(request.tile_rows, request.n_rows)
+                                 : request.n_rows;
+    cols = request.tile_cols > 0 ? std::min(request.tile_cols, request.n_cols)
+                                 : request.n_cols;
+}
+
+double megabytes(std::uint64_t bytes) { return bytes / double(1 << 20); }
+}
+
+GpuMemoryPlanner::GpuMemoryPlanner(const Device& device) : device_(device) {}
+
+auto GpuMemoryPlanner::plan(const std::vector<Request>& requests) const
+    -> Plan
+{
+    Plan plan;
+    plan.allocations.resize(requests.size());
+    plan.available_bytes =
+        device_.memory > device_.reserve ? device_.memory - device_.reserve
+                                         : 0;
+
+    // the needs and the largest texture of each request
+    std::vector<int> max_poses(requests.size());
+    std::vector<int> min_poses(requests.size());
+    std::uint64_t constant_bytes = 0;
+    bool texture_exceeded = false;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const Request& request = requests[i];
+        Allocation& allocation = plan.allocations[i];
+
+        std::uint64_t renderer_constant, renderer_pose;
+        renderer_need(request, renderer_constant, renderer_pose);
+
+        // the occlusions are kept for the whole image
+        std::uint64_t evaluator_constant, evaluator_pose;
+        evaluator_need(request.n_rows,
+                       request.n_cols,
+                       request.observation_count,
+                       request.occlusion_bytes,
+                       evaluator_constant,
+                       evaluator_pose);
+
+        allocation.constant_bytes = renderer_constant + evaluator_constant;
+        allocation.pose_bytes = renderer_pose + evaluator_pose;
+        constant_bytes += allocation.constant_bytes;
+
+        if (request.renderer == Renderer::OpenGL)
+        {
+            int tile_rows, tile_cols;
+            tile_size(request, tile_rows, tile_cols);
+            allocation.max_texture_poses =
+                tile_rows > 0 && tile_cols > 0
+                    ? (device_.max_texture_width / tile_cols) *
+                          (device_.max_texture_height / tile_rows)
+                    : 0;
+        }
+        else
+        {
+            // without a texture the poses only have to fit into the grid
+            allocation.max_texture_poses = std::numeric_limits<int>::max();
+        }
+
+        max_poses[i] =
+            std::min(request.max_poses, allocation.max_texture_poses);
+        min_poses[i] =
+            std::max(1, std::min(request.min_poses, request.max_poses));
+        texture_exceeded |= max_poses[i] < min_poses[i];
+    }
+
+    // the memory left to the poses and the poses of fraction f of the
+    // largest pose counts
+    const std::uint64_t pose_memory =
+        plan.available_bytes > constant_bytes
+            ? plan.available_bytes - constant_bytes
+            : 0;
+    auto pose_bytes = [&](double f, bool apply)
+    {
+        std::uint64_t bytes = 0;
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            const int poses = std::max(min_poses[i], int(f * max_poses[i]));
+            bytes += plan.allocations[i].pose_bytes * std::uint64_t(poses);
+            if (apply) plan.allocations[i].poses = poses;
+        }
+        return bytes;
+    };
+
+    bool memory_exceeded = false;
+    if (!texture_exceeded)
+    {
+        if (pose_bytes(1., false) <= pose_memory)
+        {
+            pose_bytes(1., true);
+        }
+        else if (pose_bytes(0., false) > pose_memory)
+        {
+            memory_exceeded = true;
+            pose_bytes(0., true);
+        }
+        else
+        {
+            double feasible = 0.;
+            double infeasible = 1.;
+            for (int i = 0; i < 40; ++i)
+            {
+                const double f = 0.5 * (feasible + infeasible);
+                if (pose_bytes(f, false) <= pose_memory)
+                {
+                    feasible = f;
+                }
+                else
+                {
+                    infeasible = f;
+                }
+            }
+            pose_bytes(feasible, true);
+        }
+    }
+
+    // layouts and the report
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const Request& request = requests[i];
+        Allocation& allocation = plan.allocations[i];
+
+        if (request.renderer == Renderer::OpenGL)
+        {
+            int tile_rows, tile_cols;
+            tile_size(request, tile_rows, tile_cols);
+            grid_layout(std::max(1, allocation.poses),
+                        tile_rows,
+                        tile_cols,
+                        device_.max_texture_width,
+                        device_.max_texture_height,
+                        allocation.poses_per_row,
+                        allocation.poses_per_column);
+        }
+        else
+        {
+            allocation.poses_per_row = std::max(1, allocation.poses);
+            allocation.poses_per_column = 1;
+        }
+        plan.bytes += allocation.bytes();
+
+        report << (request.name.empty() ? "tracker " + std::to_string(i)
+                                        : request.name)
+               << ": " << request.n_rows << " x " << request.n_cols
+               << " pixels, " << allocation.poses << " of "
+               << request.max_poses << " poses";
+        if (max_poses[i] < min_poses[i])
+        {
+            report << ", the texture fits only "
+                   << allocation.max_texture_poses << " of at least "
+                   << min_poses[i] << " poses";
+        }
+        else
+        {
+            report << " in a grid of " << allocation.poses_per_row << " x "
+                   << allocation.poses_per_column;
+        }
+        report << ", " << megabytes(allocation.constant_bytes) << " MB + "
+               << allocation.pose_bytes / 1024. << " KB per pose = "
+               << megabytes(allocation.bytes()) << " MB\n";
+    }
+    report << "total: " << megabytes(plan.bytes) << " MB of "
+           << megabytes(plan.available_bytes) << " MB available";
+    if (memory_exceeded)
+    {
+        report << ", the minimum pose counts exceed the memory";
+    }
+    plan.report = report.str();
+
+    if (texture_exceeded || memory_exceeded)
+    {
+        throw GpuMemoryPlanException(plan.report);
+    }
+
+    return plan;
+}
+
+void GpuMemoryPlanner::renderer_need(const Request& request,
+                                     std::uint64_t& constant_need,
+                                     std::uint64_t& pose_need)
+{
+    int tile_rows, tile_cols;
+    tile_size(request, tile_rows, tile_cols);
+    const std::uint64_t pixels = std::uint64_t(tile_rows) * tile_cols;
+    const std::uint64_t parts = request.part_count;
+
+    if (request.renderer == Renderer::OpenGL)
+    {
+        // vertex and index buffers, a depth texture, a depth buffer and the
+        // pixel buffer per tile and the poses
+        constant_need =
+            (3 * request.vertex_count + 3 * request.triangle_count) *
+            sizeof(float);
+        pose_need = pixels * (8 + sizeof(float)) + parts * 12 * sizeof(float);
+    }
+    else
+    {
+        // vertices, triangles with their objects and the default poses, the
+        // depths, deltas, composed poses and triangle range of each pose
+        constant_need = (3 * request.vertex_count + 4 * request.triangle_count +
+                         12 * parts) *
+                        sizeof(float);
+        pose_need =
+            (pixels + 2 * 12 * parts) * sizeof(float) + 2 * sizeof(int);
+    }
+}
+
+void GpuMemoryPlanner::evaluator_need(int n_rows,
+                                      int n_cols,
+                                      int observation_count,
+                                      int occlusion_bytes,
+                                      std::uint64_t& constant_need,
+                                      std::uint64_t& pose_need)
+{
+    const std::uint64_t pixels = std::uint64_t(n_rows) * n_cols;
+
+    // the observations, their terms and their valid masks
+    constant_need = std::uint64_t(observation_count) *
+                    (5 * pixels * sizeof(float) +
+                     (pixels + 31) / 32 * sizeof(std::uint32_t));
+
+    // likelihoods, indices, the ping-pong pair of occlusions and the
+    // CudaEvaluator::PoseParameters
+    pose_need = 3 * sizeof(float) + 2 * pixels * occlusion_bytes +
+                2 * sizeof(int) + 2 * sizeof(float);
+}
+
+void GpuMemoryPlanner::grid_layout(int poses,
+                                   int tile_rows,
+                                   int tile_cols,
+                                   int max_width,
+                                   int max_height,
+                                   int& poses_per_row,
+                                   int& poses_per_column)
+{
+    poses_per_row = std::max(1, max_width / tile_cols);
+    poses_per_column = std::min(max_height / tile_rows,
+                                (poses + poses_per_row - 1) / poses_per_row);
+}
+}
@@ -0,0 +1,209 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_memory_planner.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <fl/exception/exception.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Thrown by GpuMemoryPlanner::plan() if the trackers do not fit on
+ *        the GPU, the report lists the needs of each tracker
+ */
+class GpuMemoryPlanException : public fl::Exception
+{
+public:
+    explicit GpuMemoryPlanException(const std::string& report)
+        : Exception(), report_(report)
+    {
+        info("Report", report);
+    }
+
+    virtual std::string name() const noexcept
+    {
+        return "dbot::GpuMemoryPlanException";
+    }
+
+    const std::string& report() const { return report_; }
+
+private:
+    std::string report_;
+};
+
+/**
+ * \brief Plans the number of poses of several GPU image models sharing a
+ *        device before any of them allocates memory.
+ *
+ * Each image model renders its poses into a texture of a grid of tiles and
+ * keeps the occlusions of each pose in device memory, see
+ * BufferConfiguration. The planner computes the needs of all models with
+ * the formulas of their renderers and evaluators, fits the grid of each
+ * model into the largest texture and distributes the device memory among
+ * the models. If the requested poses do not fit, every model is reduced by
+ * the same fraction down to its minimum. Models started with the planned
+ * pose counts then neither adapt nor fail within their constructors.
+ */
+class GpuMemoryPlanner
+{
+public:
+    /** \brief Renderer of the poses of an image model */
+    enum class Renderer
+    {
+        /// ObjectRasterizer, see KinectImageModelGPU
+        OpenGL,
+        /// CudaRasterizer, see KinectImageModelCuda
+        Cuda
+    };
+
+    struct Device
+    {
+        /// memory available to the trackers in bytes, e.g. the free memory
+        /// of the device
+        std::uint64_t memory = 0;
+
+        /// memory left to the drivers and other allocations in bytes
+        std::uint64_t reserve = 64 << 20;
+
+        /// largest texture width and height, the smaller of the limits of
+        /// OpenGL and CUDA and of the kernel grid
+        int max_texture_width = 0;
+        int max_texture_height = 0;
+    };
+
+    /** \brief The image model of a tracker to be started */
+    struct Request
+    {
+        /// name of the tracker in the report
+        std::string name;
+
+        Renderer renderer = Renderer::OpenGL;
+
+        /// image resolution and size of the tiles the poses are rendered
+        /// into, 0 renders the full image
+        int n_rows = 0;
+        int n_cols = 0;
+        int tile_rows = 0;
+        int tile_cols = 0;
+
+        /// the model gets at least min_poses and at most max_poses
+        int max_poses = 0;
+        int min_poses = 1;
+
+        /// the meshes of all parts
+        int part_count = 1;
+        std::uint64_t vertex_count = 0;
+        std::uint64_t triangle_count = 0;
+
+        /// bytes per occlusion probability, see OcclusionPrecision
+        int occlusion_bytes = 4;
+
+        /// observation images kept on the device, see CudaEvaluator
+        int observation_count = 1;
+    };
+
+    /** \brief Planned configuration of the image model of a request */
+    struct Allocation
+    {
+        int poses = 0;
+
+        /// grid of the tiles in the texture
+        int poses_per_row = 0;
+        int poses_per_column = 0;
+
+        /// poses the texture fits at most
+        int max_texture_poses = 0;
+
+        std::uint64_t constant_bytes = 0;
+        std::uint64_t pose_bytes = 0;
+
+        std::uint64_t bytes() const
+        {
+            return constant_bytes + pose_bytes * std::uint64_t(poses);
+        }
+    };
+
+    struct Plan
+    {
+        std::vector<Allocation> allocations;
+
+        /// memory of all allocations and the memory available to them
+        std::uint64_t bytes = 0;
+        std::uint64_t available_bytes = 0;
+
+        /// one line per request and a summary
+        std::string report;
+    };
+
+public:
+    explicit GpuMemoryPlanner(const Device& device);
+
+    /**
+     * \brief Plans the largest pose counts of the \a requests which fit on
+     *        the device together
+     *
+     * \throws GpuMemoryPlanException if the minimum pose counts do not fit
+     *         into the texture or memory
+     */
+    Plan plan(const std::vector<Request>& requests) const;
+
+    const Device& device() const { return device_; }
+
+    /**
+     * \brief Memory the renderer of \a request needs in bytes independent
+     *        of the poses and per pose, the one of
+     *        ObjectRasterizer::get_memory_need_parameters() and
+     *        CudaRasterizer::get_memory_need_parameters()
+     */
+    static void renderer_need(const Request& request,
+                              std::uint64_t& constant_need,
+                              std::uint64_t& pose_need);
+
+    /**
+     * \brief Memory of CudaEvaluator::get_memory_need_parameters() for
+     *        \a observation_count images of n_rows x n_cols pixels
+     */
+    static void evaluator_need(int n_rows,
+                               int n_cols,
+                               int observation_count,
+                               int occlusion_bytes,
+                               std::uint64_t& constant_need,
+                               std::uint64_t& pose_need);
+
+    /**
+     * \brief Grid of \a poses tiles in a texture of at most
+     *        \a max_width x \a max_height, the one of
+     *        BufferConfiguration::compute_grid_layout()
+     */
+    static void grid_layout(int poses,
+                            int tile_rows,
+                            int tile_cols,
+                            int max_width,
+                            int max_height,
+                            int& poses_per_row,
+                            int& poses_per_column);
+
+private:
+    Device device_;
+};
+}
@@ -0,0 +1,114 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_memory_planner_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/gpu_memory_planner.hpp>
+
+using dbot::GpuMemoryPlanner;
+
+static GpuMemoryPlanner::Request request(const std::string& name,
+                                         int max_poses)
+{
+    GpuMemoryPlanner::Request request;
+    request.name = name;
+    request.n_rows = 60;
+    request.n_cols = 80;
+    request.max_poses = max_poses;
+    request.vertex_count = 1000;
+    request.triangle_count = 2000;
+    return request;
+}
+
+static GpuMemoryPlanner::Device device(std::uint64_t memory)
+{
+    GpuMemoryPlanner::Device device;
+    device.memory = memory;
+    device.reserve = 0;
+    device.max_texture_width = 8192;
+    device.max_texture_height = 8192;
+    return device;
+}
+
+TEST(GpuMemoryPlannerTests, requested_poses_fit_as_requested)
+{
+    GpuMemoryPlanner planner(device(std::uint64_t(1) << 30));
+    auto plan = planner.plan({request("a", 100), request("b", 300)});
+
+    ASSERT_EQ(plan.allocations.size(), 2u);
+    EXPECT_EQ(plan.allocations[0].poses, 100);
+    EXPECT_EQ(plan.allocations[1].poses, 300);
+
+    // 8192 / 80 tiles per row
+    EXPECT_EQ(plan.allocations[1].poses_per_row, 102);
+    EXPECT_EQ(plan.allocations[1].poses_per_column, 3);
+    EXPECT_EQ(plan.bytes,
+              plan.allocations[0].bytes() + plan.allocations[1].bytes());
+    EXPECT_LE(plan.bytes, plan.available_bytes);
+}
+
+TEST(GpuMemoryPlannerTests, poses_are_reduced_by_the_same_fraction)
+{
+    auto requests = std::vector<GpuMemoryPlanner::Request>{
+        request("a", 1000), request("b", 3000)};
+
+    // room for half of the poses
+    std::uint64_t constant, pose, half = 0;
+    for (const auto& r : requests)
+    {
+        std::uint64_t renderer_constant, renderer_pose;
+        GpuMemoryPlanner::renderer_need(r, renderer_constant, renderer_pose);
+        GpuMemoryPlanner::evaluator_need(
+            r.n_rows, r.n_cols, 1, 4, constant, pose);
+        half += renderer_constant + constant +
+                (renderer_pose + pose) * r.max_poses / 2;
+    }
+
+    GpuMemoryPlanner planner(device(half));
+    auto plan = planner.plan(requests);
+
+    EXPECT_NEAR(plan.allocations[0].poses, 500, 1);
+    EXPECT_NEAR(plan.allocations[1].poses, 1500, 1);
+    EXPECT_LE(plan.bytes, plan.available_bytes);
+}
+
+TEST(GpuMemoryPlannerTests, failing_minimum_throws_with_report)
+{
+    auto requests = std::vector<GpuMemoryPlanner::Request>{
+        request("left", 1000), request("right", 1000)};
+    requests[1].min_poses = 1000;
+
+    GpuMemoryPlanner planner(device(std::uint64_t(16) << 20));
+    try
+    {
+        planner.plan(requests);
+        FAIL();
+    }
+    catch (const dbot::GpuMemoryPlanException& e)
+    {
+        EXPECT_NE(e.report().find("left"), std::string::npos);
+        EXPECT_NE(e.report().find("right"), std::string::npos);
+        EXPECT_NE(e.report().find("exceed the memory"), std::string::npos);
+    }
+
+    // the texture of 8192 x 8192 only fits 102 x 136 full images
+    requests[1].max_poses = requests[1].min_poses = 20000;
+    GpuMemoryPlanner large(device(std::uint64_t(1) << 40));
+    EXPECT_THROW(large.plan(requests), dbot::GpuMemoryPlanException);
+}
@@ -0,0 +1,128 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file hash_index.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace dbot
+{
+/**
+ * \brief Map of 64 bit hashes to non-negative indices which is cleared and
+ *        filled again in every frame.
+ *
+ * The entries are stored in a single open addressing table. Unlike an
+ * std::unordered_map, clear() keeps the table, hence an index which is
+ * filled with about as many entries in every frame stops allocating after
+ * the first frames.
+ */
+class HashIndex
+{
+public:
+    HashIndex() : size_(0), mask_(0) {}
+
+    /** \brief Removes all entries and keeps the memory */
+    void clear()
+    {
+        for (Entry& entry : table_) entry.value = -1;
+        size_ = 0;
+    }
+
+    /** \brief Grows the table to hold \a count entries without growing */
+    void reserve(int count)
+    {
+        if (2 * count > int(table_.size())) rehash(2 * count);
+    }
+
+    /** \return the index stored for \a key, or -1 */
+    int find(std::uint64_t key) const
+    {
+        if (table_.empty()) return -1;
+
+        for (std::size_t slot = key & mask_;; slot = (slot + 1) & mask_)
+        {
+            const Entry& entry = table_[slot];
+            if (entry.value < 0) return -1;
+            if (entry.key == key) return entry.value;
+        }
+    }
+
+    /**
+     * \brief Stores \a value for \a key unless the key is present already
+     * \return whether \a value has been stored
+     */
+    bool insert(std::uint64_t key, int value)
+    {
+        // the table is at most half full
+        if (2 * (size_ + 1) > int(table_.size())) rehash(2 * (size_ + 1));
+
+        for (std::size_t slot = key & mask_;; slot = (slot + 1) & mask_)
+        {
+            Entry& entry = table_[slot];
+            if (entry.value < 0)
+            {
+                entry.key = key;
+                entry.value = value;
+                ++size_;
+                return true;
+            }
+            if (entry.key == key) return false;
+        }
+    }
+
+    int size() const { return size_; }
+
+    void swap(HashIndex& other)
+    {
+        table_.swap(other.table_);
+        std::swap(size_, other.size_);
+        std::swap(mask_, other.mask_);
+    }
+
+private:
+    struct Entry
+    {
+        std::uint64_t key;
+        int value;
+    };
+
+    void rehash(int min_slots)
+    {
+        std::size_t slots = 16;
+        while (slots < std::size_t(min_slots)) slots *= 2;
+
+        std::vector<Entry> table(slots, Entry{0, -1});
+        table.swap(table_);
+        mask_ = slots - 1;
+        size_ = 0;
+
+        for (const Entry& entry : table)
+        {
+            if (entry.value >= 0) insert(entry.key, entry.value);
+        }
+    }
+
+private:
+    std::vector<Entry> table_;
+    int size_;
+    std::size_t mask_;
+};
+}
@@ -0,0 +1,315 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file instrumentation.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <functional>
+
+namespace dbot
+{
+/**
+ * \brief Stages of a filter step which are timed separately
+ */
+enum class Stage : int
+{
+    Propagate = 0, ///< sampling the noise and applying the transition
+    Render,        ///< rendering the predicted depths
+    Map,           ///< handing the rendered depths over to the evaluation
+    Weigh,         ///< evaluating the likelihoods of the particles
+    Resample,      ///< drawing the next generation of particles
+    Refine,        ///< aligning the mean pose with the observation
+    Count
+};
+
+/**
+ * \brief Timings and counters of a single filter step
+ */
+struct FrameStatistics
+{
+    FrameStatistics() { clear(); }
+
+    void clear()
+    {
+        frame = 0;
+        seconds = 0.;
+        delta_time = 0.;
+        dropped_frames = 0;
+        stage_seconds.fill(0.);
+        pixels_evaluated = 0;
+        renders_reused = 0;
+        reuse_validations = 0;
+        reuse_depth_error = 0.;
+        reuse_coverage_error = 0.;
+        resample_count = 0;
+        effective_sample_size = 0.;
+    }
+
+    /** \return the wall time in seconds spent in \a stage */
+    double stage(Stage stage) const { return stage_seconds[int(stage)]; }
+
+    /// index of the step, counting from zero once instrumentation is enabled
+    std::uint64_t frame;
+
+    /// wall time of the whole step, including the time outside of the stages
+    double seconds;
+
+    /// time in seconds since the previous frame given by the time stamps of
+    /// Tracker::track(), 0 for steps without a time stamp
+    double delta_time;
+
+    /// number of frames dropped in favor of this one, see
+    /// Tracker::track_latest()
+    std::uint64_t dropped_frames;
+
+    /// wall time of each Stage, a nested stage is not part of the outer one
+    std::array<double, int(Stage::Count)> stage_seconds;
+
+    /// number of predicted pixels compared with the observation
+    std::uint64_t pixels_evaluated;
+
+    /// number of renderings replaced by warping the rendering of the
+    /// ancestor, see DepthReuse
+    std::uint64_t renders_reused;
+
+    /// number of warped renderings which have been rendered as well, the
+    /// mean absolute depth difference in meters of their common pixels and
+    /// the mean fraction of pixels covered by only one of the two
+    std::uint64_t reuse_validations;
+    double reuse_depth_error;
+    double reuse_coverage_error;
+
+    /// number of resampling steps of the particle filter
+    int resample_count;
+
+    /// 1 / sum w_i^2 of the normalized particle weights at the end of the
+    /// step, 0 for filters without particles
+    double effective_sample_size;
+};
+
+/**
+ * \brief Collects the FrameStatistics of the filter steps of a tracker.
+ *
+ * Instrumentation is disabled by default. Disabled, the stages are not timed
+ * and the only cost is a single check per stage. The statistics of the
+ * last step are published to last_frame() and to the callback, if any.
+ *
+ * The recording functions are called by the tracking thread only.
+ * enable(), last_frame() and the callback setter may be called from any
+ * thread.
+ */
+class Instrumentation
+{
+public:
+    typedef std::function<void(const FrameStatistics&)> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    Instrumentation() : enabled_(false), recording_(false), frame_(0) {}
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void enable(bool enabled)
+    {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Sets the function receiving the statistics of each step. The
+     *        callback runs on the tracking thread before the step returns.
+     */
+    void callback(const Callback& callback)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = callback;
+    }
+
+    /**
+     * \brief Copies the statistics of the last completed step
+     * \return false if no step has been recorded yet
+     */
+    bool last_frame(FrameStatistics& statistics) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frame_ == 0) return false;
+
+        statistics = last_;
+        return true;
+    }
+
+    /// recording, tracking thread only ****************************************
+
+    /**
+     * \return true if the current step is recorded. Stages outside of
+     *         begin_frame() and end_frame() are not recorded.
+     */
+    bool recording() const { return recording_; }
+
+    void begin_frame()
+    {
+        recording_ = enabled();
+        if (!recording_) return;
+
+        current_.clear();
+        current_.frame = frame_;
+        frame_start_ = Clock::now();
+    }
+
+    void end_frame()
+    {
+        if (!recording_) return;
+        recording_ = false;
+
+        current_.seconds = seconds_since(frame_start_);
+
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last_ = current_;
+            ++frame_;
+            callback = callback_;
+        }
+
+        if (callback) callback(current_);
+    }
+
+    void add_seconds(Stage stage, double seconds)
+    {
+        current_.stage_seconds[int(stage)] += seconds;
+    }
+
+    void add_pixels(std::uint64_t pixels)
+    {
+        current_.pixels_evaluated += pixels;
+    }
+
+    void add_reused_renders(std::uint64_t count)
+    {
+        current_.renders_reused += count;
+    }
+
+    /**
+     * \brief Adds \a count validations of warped renderings given the sums
+     *        of their depth and coverage errors
+     */
+    void add_reuse_validations(std::uint64_t count,
+                               double depth_error_sum,
+                               double coverage_error_sum)
+    {
+        if (count == 0) return;
+
+        const double total = double(current_.reuse_validations + count);
+        current_.reuse_depth_error +=
+            (depth_error_sum -
+             count * current_.reuse_depth_error) / total;
+        current_.reuse_coverage_error +=
+            (coverage_error_sum -
+             count * current_.reuse_coverage_error) / total;
+        current_.reuse_validations += count;
+    }
+
+    /**
+     * \brief Records the time since the previous frame and the number of
+     *        frames dropped before this one
+     */
+    void frame_timing(double delta_time, std::uint64_t dropped_frames)
+    {
+        current_.delta_time = delta_time;
+        current_.dropped_frames = dropped_frames;
+    }
+
+    void count_resample() { ++current_.resample_count; }
+
+    void effective_sample_size(double size)
+    {
+        current_.effective_sample_size = size;
+    }
+
+    /** \return the sum of the seconds of all stages of the current step */
+    double stage_seconds() const
+    {
+        double seconds = 0.;
+        for (double stage : current_.stage_seconds) seconds += stage;
+        return seconds;
+    }
+
+    static double seconds_since(const Clock::time_point& start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+private:
+    std::atomic<bool> enabled_;
+    bool recording_;
+
+    FrameStatistics current_;
+    Clock::time_point frame_start_;
+
+    mutable std::mutex mutex_;
+    FrameStatistics last_;
+    std::uint64_t frame_;
+    Callback callback_;
+};
+
+/**
+ * \brief Adds the wall time of its scope to a Stage of the current step.
+ *
+ * Timers nest: the time of the inner timers is subtracted from the outer
+ * one, such that the stages of a step never add up to more than the step.
+ * Does nothing if \a instrumentation is null or not recording.
+ */
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer(Instrumentation* instrumentation, Stage stage)
+        : instrumentation_(instrumentation && instrumentation->recording()
+                               ? instrumentation
+                               : nullptr),
+          stage_(stage)
+    {
+        if (!instrumentation_) return;
+
+        nested_start_ = instrumentation_->stage_seconds();
+        start_ = Instrumentation::Clock::now();
+    }
+
+    ~ScopedStageTimer()
+    {
+        if (!instrumentation_) return;
+
+        const double nested =
+            instrumentation_->stage_seconds() - nested_start_;
+        instrumentation_->add_seconds(
+            stage_, Instrumentation::seconds_since(start_) - nested);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    Instrumentation* instrumentation_;
+    Stage stage_;
+    double nested_start_;
+    Instrumentation::Clock::time_point start_;
+};
+}
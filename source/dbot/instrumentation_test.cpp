@@ -0,0 +1,95 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file instrumentation_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <dbot/instrumentation.hpp>
+
+using dbot::Stage;
+using dbot::FrameStatistics;
+using dbot::Instrumentation;
+using dbot::ScopedStageTimer;
+
+static void sleep_ms(int milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+TEST(InstrumentationTests, records_nothing_while_disabled)
+{
+    Instrumentation instrumentation;
+
+    instrumentation.begin_frame();
+    EXPECT_FALSE(instrumentation.recording());
+    {
+        ScopedStageTimer timer(&instrumentation, Stage::Render);
+    }
+    instrumentation.end_frame();
+
+    FrameStatistics statistics;
+    EXPECT_FALSE(instrumentation.last_frame(statistics));
+
+    // timers without instrumentation are allowed
+    ScopedStageTimer timer(nullptr, Stage::Weigh);
+}
+
+TEST(InstrumentationTests, nested_stages_are_exclusive)
+{
+    Instrumentation instrumentation;
+    instrumentation.enable(true);
+
+    int calls = 0;
+    instrumentation.callback([&](const FrameStatistics&) { ++calls; });
+
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        instrumentation.begin_frame();
+        {
+            ScopedStageTimer weigh(&instrumentation, Stage::Weigh);
+            sleep_ms(2);
+            {
+                ScopedStageTimer render(&instrumentation, Stage::Render);
+                sleep_ms(30);
+            }
+            instrumentation.add_pixels(100);
+        }
+        instrumentation.count_resample();
+        instrumentation.effective_sample_size(42.);
+        instrumentation.end_frame();
+    }
+
+    FrameStatistics statistics;
+    ASSERT_TRUE(instrumentation.last_frame(statistics));
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(statistics.frame, 1u);
+    EXPECT_EQ(statistics.pixels_evaluated, 100u);
+    EXPECT_EQ(statistics.resample_count, 1);
+    EXPECT_DOUBLE_EQ(statistics.effective_sample_size, 42.);
+
+    EXPECT_GE(statistics.stage(Stage::Render), 0.03);
+    EXPECT_GE(statistics.stage(Stage::Weigh), 0.002);
+    EXPECT_LT(statistics.stage(Stage::Weigh),
+              statistics.stage(Stage::Render));
+    EXPECT_EQ(statistics.stage(Stage::Propagate), 0.);
+    EXPECT_GE(statistics.seconds,
+              statistics.stage(Stage::Render) + statistics.stage(Stage::Weigh));
+}
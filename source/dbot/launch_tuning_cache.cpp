@@ -0,0 +1,103 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file launch_tuning_cache.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include <dbot/replace_file.hpp>
+#include <dbot/launch_tuning_cache.hpp>
+
+namespace dbot
+{
+namespace
+{
+const char file_header[] = "# dbot launch tuning 1";
+}
+
+LaunchTuningCache::LaunchTuningCache(const std::string& path) : path_(path)
+{
+    read(path_, launches_);
+}
+
+bool LaunchTuningCache::find(const Key& key, Launch& launch) const
+{
+    auto entry = launches_.find(encode(key));
+    if (entry == launches_.end()) return false;
+
+    launch = entry->second;
+    return true;
+}
+
+bool LaunchTuningCache::store(const Key& key, const Launch& launch)
+{
+    // configurations stored by other trackers since the construction
+    read(path_, launches_);
+    launches_[encode(key)] = launch;
+
+    // trackers finishing their tuning at the same time replace the file
+    // one after the other, each with the entries it has read
+    std::ostringstream content;
+    content << file_header << "\n";
+    for (const auto& entry : launches_)
+    {
+        content << entry.first << "\t" << entry.second.nr_threads << "\t"
+                << entry.second.max_nr_poses << "\n";
+    }
+
+    const std::string data = content.str();
+    return replace_file(path_, {{data.data(), data.size()}});
+}
+
+std::string LaunchTuningCache::encode(const Key& key)
+{
+    // device names contain spaces but no tabs
+    std::ostringstream stream;
+    stream << key.device << "\t" << key.driver_version << "\t" << key.rows
+           << "\t" << key.cols << "\t" << key.tile_rows << "\t"
+           << key.tile_cols << "\t" << key.poses;
+    return stream.str();
+}
+
+void LaunchTuningCache::read(const std::string& path,
+                             std::map<std::string, Launch>& launches)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line) || line != file_header) return;
+
+    // the key is formed by the first 7 fields, malformed lines are skipped
+    while (std::getline(file, line))
+    {
+        std::size_t end = std::string::npos;
+        for (int field = 0; field < 7; ++field)
+        {
+            end = line.find('\t', end + 1);
+            if (end == std::string::npos) break;
+        }
+        if (end == std::string::npos) continue;
+
+        Launch launch;
+        std::istringstream values(line.substr(end + 1));
+        if (values >> launch.nr_threads >> launch.max_nr_poses)
+        {
+            launches[line.substr(0, end)] = launch;
+        }
+    }
+}
+}
@@ -0,0 +1,96 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file launch_tuning_cache.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief Launch configurations of the GPU image models which have been tuned
+ *        in earlier runs, stored in a text file.
+ *
+ * A configuration applies to a GPU model and driver version, an image and
+ * tile resolution and a maximum number of poses. Trackers started with the
+ * same setup take the stored configuration instead of tuning it again, see
+ * KinectImageModelGPU::launch_tuning().
+ *
+ * The file is read once on construction. Storing a configuration merges it
+ * with the current content of the file, such that trackers running
+ * concurrently do not drop each others configurations. Failures, e.g. due to
+ * a read only directory, are ignored since the cache is optional.
+ */
+class LaunchTuningCache
+{
+public:
+    struct Key
+    {
+        /// name of the GPU model
+        std::string device;
+        int driver_version = 0;
+        int rows = 0;
+        int cols = 0;
+        int tile_rows = 0;
+        int tile_cols = 0;
+        /// maximum number of poses requested from the image model
+        int poses = 0;
+    };
+
+    struct Launch
+    {
+        /// threads per block of the weighting kernel
+        int nr_threads = 0;
+
+        /// maximum number of poses after adapting the buffers to the
+        /// constraints of the GPU. A configuration is only applied while the
+        /// buffers adapt to the same number of poses.
+        int max_nr_poses = 0;
+    };
+
+public:
+    /** \brief Loads the configurations of \a path if it exists */
+    explicit LaunchTuningCache(const std::string& path);
+
+    /** \return whether a configuration of \a key is stored */
+    bool find(const Key& key, Launch& launch) const;
+
+    /**
+     * \brief Stores the configuration of \a key and writes the file
+     *
+     * \return whether the file has been written
+     */
+    bool store(const Key& key, const Launch& launch);
+
+    int size() const { return launches_.size(); }
+    const std::string& path() const { return path_; }
+
+private:
+    static std::string encode(const Key& key);
+
+    /** \brief Adds the configurations of the file to launches */
+    static void read(const std::string& path,
+                     std::map<std::string, Launch>& launches);
+
+private:
+    std::string path_;
+    std::map<std::string, Launch> launches_;
+};
+}
@@ -0,0 +1,146 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file launch_tuning_cache_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <dbot/launch_tuning_cache.hpp>
+
+using dbot::LaunchTuningCache;
+
+class LaunchTuningCacheTests : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = "/tmp/dbot_launch_tuning_cache_test_" +
+                std::to_string(::getpid()) + ".txt";
+
+        key_.device = "GeForce GTX 1080";
+        key_.driver_version = 9010;
+        key_.rows = 60;
+        key_.cols = 80;
+        key_.tile_rows = 60;
+        key_.tile_cols = 80;
+        key_.poses = 200;
+    }
+
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    std::string path_;
+    LaunchTuningCache::Key key_;
+};
+
+TEST_F(LaunchTuningCacheTests, round_trip)
+{
+    LaunchTuningCache cache(path_);
+    LaunchTuningCache::Launch launch;
+    EXPECT_FALSE(cache.find(key_, launch));
+
+    launch.nr_threads = 96;
+    launch.max_nr_poses = 192;
+    ASSERT_TRUE(cache.store(key_, launch));
+
+    LaunchTuningCache::Launch loaded;
+    ASSERT_TRUE(LaunchTuningCache(path_).find(key_, loaded));
+    EXPECT_EQ(loaded.nr_threads, 96);
+    EXPECT_EQ(loaded.max_nr_poses, 192);
+
+    // any other device, driver or resolution is tuned separately
+    LaunchTuningCache::Key other = key_;
+    other.driver_version = 9020;
+    EXPECT_FALSE(LaunchTuningCache(path_).find(other, loaded));
+    other = key_;
+    other.tile_cols = 40;
+    EXPECT_FALSE(LaunchTuningCache(path_).find(other, loaded));
+}
+
+TEST_F(LaunchTuningCacheTests, stores_merge_with_the_file)
+{
+    LaunchTuningCache first(path_);
+    LaunchTuningCache second(path_);
+
+    LaunchTuningCache::Launch launch;
+    launch.nr_threads = 64;
+    ASSERT_TRUE(first.store(key_, launch));
+
+    LaunchTuningCache::Key other = key_;
+    other.poses = 400;
+    launch.nr_threads = 128;
+    ASSERT_TRUE(second.store(other, launch));
+
+    LaunchTuningCache cache(path_);
+    EXPECT_EQ(cache.size(), 2);
+    ASSERT_TRUE(cache.find(key_, launch));
+    EXPECT_EQ(launch.nr_threads, 64);
+}
+
+TEST_F(LaunchTuningCacheTests, foreign_files_are_ignored)
+{
+    std::ofstream(path_) << "some other content\n";
+    EXPECT_EQ(LaunchTuningCache(path_).size(), 0);
+
+    std::ofstream(path_) << "# dbot launch tuning 1\n"
+                         << "truncated\t1\t2\n";
+    EXPECT_EQ(LaunchTuningCache(path_).size(), 0);
+
+    // unwritable locations are not an error of the tracker
+    LaunchTuningCache cache("/nonexistent/directory/tuning.txt");
+    EXPECT_FALSE(cache.store(key_, LaunchTuningCache::Launch()));
+}
+
+TEST_F(LaunchTuningCacheTests, concurrent_stores_succeed)
+{
+    const int thread_count = 4;
+    const int stores_per_thread = 10;
+
+    // trackers of one process finishing their tuning together
+    std::vector<int> failures(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            LaunchTuningCache cache(path_);
+            LaunchTuningCache::Key key = key_;
+            key.poses = 100 * (t + 1);
+            LaunchTuningCache::Launch launch;
+            launch.nr_threads = 32 * (t + 1);
+            for (int i = 0; i < stores_per_thread; ++i)
+            {
+                if (!cache.store(key, launch)) ++failures[t];
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < thread_count; ++t) EXPECT_EQ(failures[t], 0);
+
+    // the file is complete, though entries may be lost to a concurrent
+    // writer which had not read them yet
+    LaunchTuningCache cache(path_);
+    EXPECT_GE(cache.size(), 1);
+    EXPECT_LE(cache.size(), thread_count);
+}
@@ -0,0 +1,270 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <Eigen/Geometry>
+
+#include <dbot/mesh_cache.hpp>
+#include <dbot/replace_file.hpp>
+
+namespace dbot
+{
+namespace
+{
+const char cache_magic[8] = {'D', 'B', 'O', 'T', 'M', 'S', 'H', '\0'};
+const std::uint32_t cache_version = 1;
+
+/**
+ * \brief Layout of a cache file: the header is followed by the center, the
+ *        vertices, the triangle indices and the triangle normals. All fields
+ *        are 4 byte aligned.
+ */
+struct CacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t vertex_count;
+    std::uint32_t triangle_count;
+    std::uint32_t reserved;
+    std::uint64_t source_size;
+    std::uint64_t source_hash;
+};
+
+std::size_t cache_size(std::uint64_t vertex_count,
+                       std::uint64_t triangle_count)
+{
+    return sizeof(CacheHeader) +
+           sizeof(float) * 3 * (1 + vertex_count + triangle_count) +
+           sizeof(std::uint32_t) * 3 * triangle_count;
+}
+
+const CacheHeader& header(const void* data)
+{
+    return *static_cast<const CacheHeader*>(data);
+}
+
+const float* center_data(const void* data)
+{
+    return reinterpret_cast<const float*>(static_cast<const char*>(data) +
+                                          sizeof(CacheHeader));
+}
+
+/** \brief Maps the whole file read-only, returns null on failure */
+void* map_file(const std::string& path, std::size_t& size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat status;
+    void* data = nullptr;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        size = std::size_t(status.st_size);
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) data = nullptr;
+    }
+    ::close(fd);
+
+    return data;
+}
+}
+
+MappedMesh::MappedMesh(void* data, std::size_t size) : data_(data), size_(size)
+{
+}
+
+MappedMesh::~MappedMesh()
+{
+    ::munmap(data_, size_);
+}
+
+std::uint32_t MappedMesh::vertex_count() const
+{
+    return header(data_).vertex_count;
+}
+
+std::uint32_t MappedMesh::triangle_count() const
+{
+    return header(data_).triangle_count;
+}
+
+const float* MappedMesh::vertices() const
+{
+    return center_data(data_) + 3;
+}
+
+const std::uint32_t* MappedMesh::indices() const
+{
+    return reinterpret_cast<const std::uint32_t*>(vertices() +
+                                                  3 * vertex_count());
+}
+
+const float* MappedMesh::normals() const
+{
+    return reinterpret_cast<const float*>(indices() + 3 * triangle_count());
+}
+
+Eigen::Vector3f MappedMesh::center() const
+{
+    return Eigen::Map<const Eigen::Vector3f>(center_data(data_));
+}
+
+void MappedMesh::copy_to(
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<std::vector<int>>& triangle_indices) const
+{
+    const float* v = this->vertices();
+    vertices.resize(vertex_count());
+    for (std::uint32_t i = 0; i < vertex_count(); ++i, v += 3)
+    {
+        vertices[i] = Eigen::Vector3d(v[0], v[1], v[2]);
+    }
+
+    const std::uint32_t* t = indices();
+    triangle_indices.resize(triangle_count());
+    for (std::uint32_t i = 0; i < triangle_count(); ++i, t += 3)
+    {
+        triangle_indices[i] = {int(t[0]), int(t[1]), int(t[2])};
+    }
+}
+
+std::string MeshCache::cache_path(const std::string& mesh_path)
+{
+    return mesh_path + ".dbotmesh";
+}
+
+bool MeshCache::hash_file(const std::string& path,
+                          std::uint64_t& hash,
+                          std::uint64_t& size)
+{
+    std::size_t mapped_size = 0;
+    void* data = map_file(path, mapped_size);
+    if (!data) return false;
+
+    // FNV-1a
+    hash = 14695981039346656037ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < mapped_size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    size = mapped_size;
+
+    ::munmap(data, mapped_size);
+    return true;
+}
+
+std::shared_ptr<MappedMesh> MeshCache::load(const std::string& mesh_path)
+{
+    std::uint64_t source_hash, source_size;
+    if (!hash_file(mesh_path, source_hash, source_size)) return nullptr;
+
+    std::size_t size = 0;
+    void* data = map_file(cache_path(mesh_path), size);
+    if (!data) return nullptr;
+
+    auto mesh = std::make_shared<MappedMesh>(data, size);
+    if (size < sizeof(CacheHeader)) return nullptr;
+
+    const CacheHeader& h = header(data);
+    if (std::memcmp(h.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+        h.version != cache_version || h.source_size != source_size ||
+        h.source_hash != source_hash ||
+        size != cache_size(h.vertex_count, h.triangle_count))
+    {
+        return nullptr;
+    }
+
+    // reject corrupted indices instead of reading out of bounds later
+    const std::uint32_t* indices = mesh->indices();
+    for (std::uint64_t i = 0; i < 3 * std::uint64_t(h.triangle_count); ++i)
+    {
+        if (indices[i] >= h.vertex_count) return nullptr;
+    }
+
+    return mesh;
+}
+
+bool MeshCache::store(const std::string& mesh_path,
+                      const std::vector<Eigen::Vector3d>& vertices,
+                      const std::vector<std::vector<int>>& triangle_indices)
+{
+    CacheHeader h;
+    std::memcpy(h.magic, cache_magic, sizeof(cache_magic));
+    h.version = cache_version;
+    h.vertex_count = std::uint32_t(vertices.size());
+    h.triangle_count = std::uint32_t(triangle_indices.size());
+    h.reserved = 0;
+    if (!hash_file(mesh_path, h.source_hash, h.source_size)) return false;
+
+    std::vector<float> center_and_vertices(3 * (1 + vertices.size()));
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        center += vertices[i];
+        for (int k = 0; k < 3; ++k)
+        {
+            center_and_vertices[3 * (i + 1) + k] = float(vertices[i](k));
+        }
+    }
+    if (!vertices.empty()) center /= double(vertices.size());
+    for (int k = 0; k < 3; ++k) center_and_vertices[k] = float(center(k));
+
+    std::vector<std::uint32_t> indices(3 * triangle_indices.size());
+    std::vector<float> normals(3 * triangle_indices.size());
+    for (size_t i = 0; i < triangle_indices.size(); ++i)
+    {
+        const auto& triangle = triangle_indices[i];
+        if (triangle.size() != 3) return false;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (triangle[k] < 0 || size_t(triangle[k]) >= vertices.size())
+            {
+                return false;
+            }
+            indices[3 * i + k] = std::uint32_t(triangle[k]);
+        }
+
+        // same orientation as the normals of the RigidBodyRenderer
+        const Eigen::Vector3d normal =
+            ((vertices[triangle[1]] - vertices[triangle[0]])
+                 .cross(vertices[triangle[2]] - vertices[triangle[1]]))
+                .normalized();
+        for (int k = 0; k < 3; ++k) normals[3 * i + k] = float(normal(k));
+    }
+
+    // several threads may store the same mesh at once, concurrently
+    // starting trackers never map a partially written cache
+    return replace_file(
+        cache_path(mesh_path),
+        {{&h, sizeof(h)},
+         {center_and_vertices.data(),
+          sizeof(float) * center_and_vertices.size()},
+         {indices.data(), sizeof(std::uint32_t) * indices.size()},
+         {normals.data(), sizeof(float) * normals.size()}});
+}
+}
@@ -0,0 +1,108 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <Eigen/Core>
+
+namespace dbot
+{
+/**
+ * \brief Read-only mesh mapped from a binary cache file.
+ *
+ * Vertices and per-triangle normals are stored as consecutive float
+ * triplets, triangles as consecutive uint32 index triplets. The memory
+ * remains mapped for the lifetime of the object.
+ */
+class MappedMesh
+{
+public:
+    MappedMesh(void* data, std::size_t size);
+    ~MappedMesh();
+
+    MappedMesh(const MappedMesh&) = delete;
+    MappedMesh& operator=(const MappedMesh&) = delete;
+
+    std::uint32_t vertex_count() const;
+    std::uint32_t triangle_count() const;
+
+    const float* vertices() const;
+    const std::uint32_t* indices() const;
+    const float* normals() const;
+
+    /** \return the mean of the vertices */
+    Eigen::Vector3f center() const;
+
+    /**
+     * \brief Copies the mesh into the layout of ObjectModelLoader
+     */
+    void copy_to(std::vector<Eigen::Vector3d>& vertices,
+                 std::vector<std::vector<int>>& triangle_indices) const;
+
+private:
+    void* data_;
+    std::size_t size_;
+};
+
+/**
+ * \brief Binary cache of parsed meshes stored next to the mesh file.
+ *
+ * A cache file records the size and a hash of the content of the mesh file it
+ * has been created from. It is only used while both still match, hence an
+ * edited mesh file is parsed again and its cache rewritten.
+ */
+class MeshCache
+{
+public:
+    /** \return the path of the cache file of the mesh file */
+    static std::string cache_path(const std::string& mesh_path);
+
+    /**
+     * \return the 64 bit FNV-1a hash of the content of the file and its size
+     *         in bytes, or false if the file cannot be read
+     */
+    static bool hash_file(const std::string& path,
+                          std::uint64_t& hash,
+                          std::uint64_t& size);
+
+    /**
+     * \brief Maps the cache of the mesh file
+     *
+     * \return the mapped mesh or null if there is no valid cache for the
+     *         current content of the mesh file
+     */
+    static std::shared_ptr<MappedMesh> load(const std::string& mesh_path);
+
+    /**
+     * \brief Writes the cache of the mesh file. Failures, e.g. due to a read
+     *        only directory, are ignored since the cache is optional.
+     *
+     * \return whether the cache has been written
+     */
+    static bool store(const std::string& mesh_path,
+                      const std::vector<Eigen::Vector3d>& vertices,
+                      const std::vector<std::vector<int>>& triangle_indices);
+};
+}
@@ -0,0 +1,120 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <dbot/mesh_cache.hpp>
+
+using dbot::MeshCache;
+
+class MeshCacheTests : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mesh_path_ = "/tmp/dbot_mesh_cache_test_" + std::to_string(::getpid()) +
+                     ".obj";
+        write_mesh("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+
+        vertices_ = {Eigen::Vector3d(0, 0, 0),
+                     Eigen::Vector3d(1, 0, 0),
+                     Eigen::Vector3d(0, 1, 0)};
+        triangle_indices_ = {{0, 1, 2}};
+    }
+
+    void TearDown() override
+    {
+        std::remove(MeshCache::cache_path(mesh_path_).c_str());
+        std::remove(mesh_path_.c_str());
+    }
+
+    void write_mesh(const std::string& content)
+    {
+        std::ofstream(mesh_path_) << content;
+    }
+
+    std::string mesh_path_;
+    std::vector<Eigen::Vector3d> vertices_;
+    std::vector<std::vector<int>> triangle_indices_;
+};
+
+TEST_F(MeshCacheTests, round_trip)
+{
+    EXPECT_FALSE(MeshCache::load(mesh_path_));
+    ASSERT_TRUE(MeshCache::store(mesh_path_, vertices_, triangle_indices_));
+
+    auto mesh = MeshCache::load(mesh_path_);
+    ASSERT_TRUE(mesh);
+    EXPECT_EQ(mesh->vertex_count(), 3);
+    EXPECT_EQ(mesh->triangle_count(), 1);
+    EXPECT_TRUE(mesh->center().isApprox(Eigen::Vector3f(1, 1, 0) / 3.f));
+    EXPECT_FLOAT_EQ(mesh->normals()[2], 1.f);
+
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangle_indices;
+    mesh->copy_to(vertices, triangle_indices);
+    EXPECT_EQ(vertices, vertices_);
+    EXPECT_EQ(triangle_indices, triangle_indices_);
+}
+
+TEST_F(MeshCacheTests, edited_mesh_invalidates_cache)
+{
+    ASSERT_TRUE(MeshCache::store(mesh_path_, vertices_, triangle_indices_));
+
+    // same size, different content
+    write_mesh("v 0 0 0\nv 2 0 0\nv 0 1 0\nf 1 2 3\n");
+    EXPECT_FALSE(MeshCache::load(mesh_path_));
+}
+
+TEST_F(MeshCacheTests, concurrent_stores_of_the_same_mesh_succeed)
+{
+    const int thread_count = 4;
+    const int stores_per_thread = 10;
+
+    std::vector<int> failures(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < stores_per_thread; ++i)
+            {
+                if (!MeshCache::store(
+                        mesh_path_, vertices_, triangle_indices_))
+                {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < thread_count; ++t) EXPECT_EQ(failures[t], 0);
+
+    auto mesh = MeshCache::load(mesh_path_);
+    ASSERT_TRUE(mesh);
+    EXPECT_EQ(mesh->triangle_count(), 1);
+}
@@ -0,0 +1,284 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_levels.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <set>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include <dbot/mesh_levels.hpp>
+
+namespace dbot
+{
+namespace
+{
+// cell coordinates are packed into 21 bits per axis
+const std::int64_t max_cells_per_axis = std::int64_t(1) << 21;
+
+// cell size of the first decimated level relative to the extent of a part
+const double first_cell_fraction = 1.0 / 64.0;
+
+/**
+ * \brief Same test as the normal computation of the RigidBodyRenderer which
+ *        rejects triangles whose three cross products disagree
+ */
+bool is_regular(const Eigen::Vector3d& a,
+                const Eigen::Vector3d& b,
+                const Eigen::Vector3d& c)
+{
+    const Eigen::Vector3d* v[3] = {&a, &b, &c};
+    Eigen::Vector3d normals[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const Eigen::Vector3d cross =
+            (*v[(i + 1) % 3] - *v[i]).cross(*v[(i + 2) % 3] - *v[(i + 1) % 3]);
+        if (cross.squaredNorm() == 0.) return false;
+        normals[i] = cross.normalized();
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!normals[i].isApprox(normals[(i + 1) % 3])) return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Mean of the vertices of a cluster in float precision, in which the
+ *        renderers store the meshes, such that the test of is_regular() holds
+ *        for the rendered triangles as well
+ */
+Eigen::Vector3d cluster_vertex(const std::vector<Eigen::Vector3d>& sums,
+                               const std::vector<int>& counts,
+                               int cluster)
+{
+    return (sums[cluster] / counts[cluster]).cast<float>().cast<double>();
+}
+
+double extent(const std::vector<Eigen::Vector3d>& vertices)
+{
+    Eigen::AlignedBox3d box;
+    for (const auto& vertex : vertices) box.extend(vertex);
+
+    return box.isEmpty() ? 0. : box.sizes().maxCoeff();
+}
+}
+
+MeshLevels::MeshLevels(const Vertices& vertices,
+                       const TriangleIndices& triangle_indices,
+                       int max_level_count,
+                       int min_triangle_count)
+    : vertices_(1, vertices),
+      triangle_indices_(1, triangle_indices),
+      errors_(1, std::vector<double>(vertices.size(), 0.)),
+      radii_(vertices.size(), 0.)
+{
+    std::vector<double> extents(vertices.size());
+    for (size_t part = 0; part < vertices.size(); ++part)
+    {
+        extents[part] = extent(vertices[part]);
+        for (const auto& vertex : vertices[part])
+        {
+            radii_[part] = std::max(radii_[part], vertex.norm());
+        }
+    }
+
+    double cell_fraction = first_cell_fraction;
+    for (int level = 1; level < max_level_count; ++level)
+    {
+        Vertices level_vertices = vertices_.back();
+        TriangleIndices level_indices = triangle_indices_.back();
+        std::vector<double> level_errors = errors_.back();
+
+        bool decimated = false;
+        for (size_t part = 0; part < vertices.size(); ++part)
+        {
+            if (int(level_indices[part].size()) <= min_triangle_count ||
+                extents[part] == 0.)
+            {
+                continue;
+            }
+
+            // decimating the full mesh avoids accumulating the errors of the
+            // intermediate levels
+            const double cell_size = cell_fraction * extents[part];
+            std::vector<Eigen::Vector3d> part_vertices;
+            std::vector<std::vector<int>> part_indices;
+            decimate(vertices[part],
+                     triangle_indices[part],
+                     cell_size,
+                     part_vertices,
+                     part_indices);
+
+            // a part must not vanish entirely
+            if (part_indices.empty() ||
+                part_indices.size() >= level_indices[part].size())
+            {
+                continue;
+            }
+
+            level_vertices[part].swap(part_vertices);
+            level_indices[part].swap(part_indices);
+            level_errors[part] = std::sqrt(3.) * cell_size;
+            decimated = true;
+        }
+
+        if (!decimated) break;
+
+        vertices_.push_back(std::move(level_vertices));
+        triangle_indices_.push_back(std::move(level_indices));
+        errors_.push_back(std::move(level_errors));
+        cell_fraction *= 2.;
+    }
+}
+
+int MeshLevels::count_levels() const
+{
+    return vertices_.size();
+}
+
+auto MeshLevels::vertices(int level) const -> const Vertices &
+{
+    return vertices_[level];
+}
+
+auto MeshLevels::triangle_indices(int level) const -> const TriangleIndices &
+{
+    return triangle_indices_[level];
+}
+
+double MeshLevels::error(int level, int part) const
+{
+    return errors_[level][part];
+}
+
+int MeshLevels::select(const std::vector<Eigen::Vector3d>& positions,
+                       double focal_length,
+                       double tolerance) const
+{
+    for (int level = count_levels() - 1; level > 0; --level)
+    {
+        bool accurate = true;
+        for (size_t part = 0; part < radii_.size() && accurate; ++part)
+        {
+            // the error is largest at the point of the part closest to the
+            // camera
+            const double depth = positions[part](2) - radii_[part];
+            accurate = depth > 0. &&
+                       focal_length * errors_[level][part] <= tolerance * depth;
+        }
+
+        if (accurate) return level;
+    }
+
+    return 0;
+}
+
+void MeshLevels::decimate(const std::vector<Eigen::Vector3d>& vertices,
+                          const std::vector<std::vector<int>>& triangle_indices,
+                          double cell_size,
+                          std::vector<Eigen::Vector3d>& decimated_vertices,
+                          std::vector<std::vector<int>>& decimated_indices)
+{
+    decimated_vertices.clear();
+    decimated_indices.clear();
+
+    Eigen::AlignedBox3d box;
+    for (const auto& vertex : vertices) box.extend(vertex);
+
+    if (box.isEmpty() || !(cell_size > 0.) ||
+        box.sizes().maxCoeff() / cell_size >= double(max_cells_per_axis - 1))
+    {
+        decimated_vertices = vertices;
+        decimated_indices = triangle_indices;
+        return;
+    }
+
+    // assign each vertex to the cluster of its cell --------------------------
+    std::unordered_map<std::int64_t, int> cells;
+    std::vector<int> cluster_of_vertex(vertices.size());
+    std::vector<Eigen::Vector3d> sums;
+    std::vector<int> counts;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Eigen::Vector3d cell =
+            ((vertices[i] - box.min()) / cell_size).array().floor();
+        const std::int64_t key =
+            (std::int64_t(cell(0)) * max_cells_per_axis + std::int64_t(cell(1))) *
+                max_cells_per_axis +
+            std::int64_t(cell(2));
+
+        auto inserted = cells.insert(std::make_pair(key, int(sums.size())));
+        if (inserted.second)
+        {
+            sums.push_back(Eigen::Vector3d::Zero());
+            counts.push_back(0);
+        }
+
+        const int cluster = inserted.first->second;
+        cluster_of_vertex[i] = cluster;
+        sums[cluster] += vertices[i];
+        counts[cluster]++;
+    }
+
+    // keep the triangles between distinct clusters once ----------------------
+    std::set<std::array<int, 3>> kept;
+    std::vector<int> new_index(sums.size(), -1);
+    for (const auto& triangle : triangle_indices)
+    {
+        std::array<int, 3> clusters = {cluster_of_vertex[triangle[0]],
+                                       cluster_of_vertex[triangle[1]],
+                                       cluster_of_vertex[triangle[2]]};
+        if (clusters[0] == clusters[1] || clusters[1] == clusters[2] ||
+            clusters[2] == clusters[0])
+        {
+            continue;
+        }
+
+        // rotating the smallest index to the front preserves the orientation
+        std::rotate(clusters.begin(),
+                    std::min_element(clusters.begin(), clusters.end()),
+                    clusters.end());
+        if (!kept.insert(clusters).second) continue;
+
+        if (!is_regular(cluster_vertex(sums, counts, clusters[0]),
+                        cluster_vertex(sums, counts, clusters[1]),
+                        cluster_vertex(sums, counts, clusters[2])))
+        {
+            continue;
+        }
+
+        std::vector<int> decimated_triangle(3);
+        for (int k = 0; k < 3; ++k)
+        {
+            int& index = new_index[clusters[k]];
+            if (index < 0)
+            {
+                index = decimated_vertices.size();
+                decimated_vertices.push_back(
+                    cluster_vertex(sums, counts, clusters[k]));
+            }
+            decimated_triangle[k] = index;
+        }
+        decimated_indices.push_back(decimated_triangle);
+    }
+}
+}
@@ -0,0 +1,92 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_levels.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Levels of detail of the meshes of all parts of an object.
+ *
+ * Level 0 is the full mesh, each further level is decimated by clustering the
+ * vertices on a grid of twice the cell size of the previous level. A vertex
+ * moves by less than the diagonal of a cell, which bounds the geometric error
+ * of a level. Triangles collapsing to a line or a point are dropped. The
+ * remaining triangles keep their orientation.
+ */
+class MeshLevels
+{
+public:
+    typedef std::vector<std::vector<Eigen::Vector3d>> Vertices;
+    typedef std::vector<std::vector<std::vector<int>>> TriangleIndices;
+
+public:
+    /**
+     * \param max_level_count  Maximum number of levels including the full
+     *                         mesh
+     * \param min_triangle_count  Parts with at most this many triangles are
+     *                            not decimated any further
+     */
+    MeshLevels(const Vertices& vertices,
+               const TriangleIndices& triangle_indices,
+               int max_level_count = 4,
+               int min_triangle_count = 32);
+
+    int count_levels() const;
+
+    const Vertices& vertices(int level) const;
+    const TriangleIndices& triangle_indices(int level) const;
+
+    /** \return the bound of the displacement of the surface of the part */
+    double error(int level, int part) const;
+
+    /**
+     * \brief Selects the coarsest level whose error, projected by the focal
+     *        length at the given positions of the parts in the camera frame,
+     *        stays below \a tolerance pixels for all parts
+     */
+    int select(const std::vector<Eigen::Vector3d>& positions,
+               double focal_length,
+               double tolerance) const;
+
+    /**
+     * \brief Clusters the vertices on a grid of the given cell size and
+     *        keeps the triangles connecting three distinct clusters
+     */
+    static void decimate(const std::vector<Eigen::Vector3d>& vertices,
+                         const std::vector<std::vector<int>>& triangle_indices,
+                         double cell_size,
+                         std::vector<Eigen::Vector3d>& decimated_vertices,
+                         std::vector<std::vector<int>>& decimated_indices);
+
+private:
+    std::vector<Vertices> vertices_;
+    std::vector<TriangleIndices> triangle_indices_;
+
+    // [level][part]
+    std::vector<std::vector<double>> errors_;
+
+    // distance of the vertex furthest from the origin of each part
+    std::vector<double> radii_;
+};
+}
@@ -0,0 +1,125 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_levels_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <dbot/mesh_levels.hpp>
+
+using dbot::MeshLevels;
+
+/**
+ * \brief Latitude longitude tessellation of a sphere of radius 5 cm with
+ *        outward facing triangles
+ */
+static void make_sphere(int rings,
+                        int segments,
+                        std::vector<Eigen::Vector3d>& vertices,
+                        std::vector<std::vector<int>>& indices)
+{
+    const double radius = 0.05;
+    for (int i = 0; i <= rings; ++i)
+    {
+        const double theta = M_PI * i / rings;
+        for (int j = 0; j < segments; ++j)
+        {
+            const double phi = 2. * M_PI * j / segments;
+            vertices.push_back(radius * Eigen::Vector3d(std::sin(theta) *
+                                                            std::cos(phi),
+                                                        std::sin(theta) *
+                                                            std::sin(phi),
+                                                        std::cos(theta)));
+        }
+    }
+
+    for (int i = 0; i < rings; ++i)
+    {
+        for (int j = 0; j < segments; ++j)
+        {
+            const int a = i * segments + j;
+            const int b = i * segments + (j + 1) % segments;
+            const int c = a + segments;
+            const int d = b + segments;
+            if (i > 0) indices.push_back({a, c, b});
+            if (i < rings - 1) indices.push_back({b, c, d});
+        }
+    }
+}
+
+TEST(MeshLevelsTests, levels_get_coarser)
+{
+    MeshLevels::Vertices vertices(1);
+    MeshLevels::TriangleIndices indices(1);
+    make_sphere(64, 128, vertices[0], indices[0]);
+
+    MeshLevels levels(vertices, indices, 4, 32);
+    ASSERT_EQ(levels.count_levels(), 4);
+
+    for (int level = 1; level < levels.count_levels(); ++level)
+    {
+        const auto& coarse = levels.triangle_indices(level)[0];
+        EXPECT_LT(coarse.size(), levels.triangle_indices(level - 1)[0].size());
+        EXPECT_GT(levels.error(level, 0), levels.error(level - 1, 0));
+
+        // decimated vertices stay close to the surface and the triangles
+        // keep facing outwards
+        const auto& coarse_vertices = levels.vertices(level)[0];
+        for (const auto& vertex : coarse_vertices)
+        {
+            EXPECT_LT(std::fabs(vertex.norm() - 0.05), levels.error(level, 0));
+        }
+        for (const auto& triangle : coarse)
+        {
+            const Eigen::Vector3d& v0 = coarse_vertices[triangle[0]];
+            const Eigen::Vector3d& v1 = coarse_vertices[triangle[1]];
+            const Eigen::Vector3d& v2 = coarse_vertices[triangle[2]];
+            EXPECT_GT((v1 - v0).cross(v2 - v1).dot(v0 + v1 + v2), 0.);
+        }
+    }
+}
+
+TEST(MeshLevelsTests, selection_depends_on_projected_size)
+{
+    MeshLevels::Vertices vertices(1);
+    MeshLevels::TriangleIndices indices(1);
+    make_sphere(32, 64, vertices[0], indices[0]);
+
+    MeshLevels levels(vertices, indices, 4, 32);
+    ASSERT_GT(levels.count_levels(), 1);
+
+    const double focal_length = 500;
+    std::vector<Eigen::Vector3d> near = {Eigen::Vector3d(0, 0, 0.3)};
+    std::vector<Eigen::Vector3d> far = {Eigen::Vector3d(0, 0, 100.)};
+    std::vector<Eigen::Vector3d> behind = {Eigen::Vector3d(0, 0, -1.)};
+
+    EXPECT_EQ(levels.select(near, focal_length, 1.), 0);
+    EXPECT_EQ(levels.select(far, focal_length, 1.), levels.count_levels() - 1);
+    EXPECT_EQ(levels.select(behind, focal_length, 1.), 0);
+
+    for (int level = 1; level < levels.count_levels(); ++level)
+    {
+        // the selected level is the coarsest one below the tolerance
+        const double depth =
+            focal_length * levels.error(level, 0) / 1. + 0.05 + 1e-9;
+        std::vector<Eigen::Vector3d> position = {Eigen::Vector3d(0, 0, depth)};
+        EXPECT_EQ(levels.select(position, focal_length, 1.), level);
+    }
+}
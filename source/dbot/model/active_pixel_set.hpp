@@ -0,0 +1,164 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file active_pixel_set.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace dbot
+{
+/**
+ * \brief Pixels of an image which carry information about the object pose.
+ *
+ * A pixel is active if it lies within a margin of the rendered silhouette of
+ * the object in its current pose, measured as the maximum of the row and the
+ * column distance. In addition, one out of every background_stride pixels
+ * away from the silhouette is sampled. The background sample changes with
+ * every update, such that all background pixels are visited over
+ * background_stride updates.
+ *
+ * Inactive pixels of an observation are set to NaN, which the filters treat
+ * as missing measurements.
+ */
+class ActivePixelSet
+{
+public:
+    /**
+     * \param n_rows the vertical resolution of the image
+     * \param n_cols the horizontal resolution of the image
+     * \param margin the dilation of the silhouette in pixels
+     * \param background_stride one out of background_stride background
+     * pixels is active, 0 samples no background at all
+     */
+    ActivePixelSet(int n_rows, int n_cols, int margin, int background_stride)
+        : n_rows_(n_rows),
+          n_cols_(n_cols),
+          margin_(margin),
+          background_stride_(background_stride),
+          update_count_(0),
+          active_(n_rows * n_cols, 1)
+    {
+    }
+
+    /**
+     * \brief Selects the active pixels from the silhouette of the object
+     *
+     * \param depth the rendered depth of the object in row major order. The
+     * silhouette consists of the finite depths.
+     */
+    void update(const std::vector<float>& depth)
+    {
+        const int pixel_count = n_rows_ * n_cols_;
+
+        // dilate the silhouette within each row, then within each column
+        std::vector<unsigned char>& rows = dilation_;
+        rows.assign(pixel_count, 0);
+        for (int row = 0; row < n_rows_; ++row)
+        {
+            const float* depth_row = &depth[row * n_cols_];
+            dilate(
+                [&](int col) { return std::isfinite(depth_row[col]); },
+                [&](int col) { rows[row * n_cols_ + col] = 1; },
+                n_cols_);
+        }
+
+        active_.assign(pixel_count, 0);
+        for (int col = 0; col < n_cols_; ++col)
+        {
+            dilate([&](int row) { return rows[row * n_cols_ + col] != 0; },
+                   [&](int row) { active_[row * n_cols_ + col] = 1; },
+                   n_rows_);
+        }
+
+        if (background_stride_ > 0)
+        {
+            const uint32_t phase = update_count_ % background_stride_;
+            for (int i = 0; i < pixel_count; ++i)
+            {
+                // scatters the sample over the image
+                const uint32_t hash = (uint32_t(i) * 2654435761u) >> 16;
+                if (hash % background_stride_ == phase) active_[i] = 1;
+            }
+        }
+
+        ++update_count_;
+    }
+
+    /**
+     * \brief Sets the inactive pixels of the observation to NaN
+     */
+    template <typename Obsrv>
+    void mask(Obsrv& obsrv) const
+    {
+        for (int i = 0; i < int(active_.size()); ++i)
+        {
+            if (!active_[i])
+            {
+                obsrv(i) = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+
+    /** \return whether the pixel is active */
+    bool active(int pixel) const { return active_[pixel] != 0; }
+
+    /** \return the number of active pixels */
+    int count() const
+    {
+        return std::count(active_.begin(), active_.end(), 1);
+    }
+
+private:
+    /**
+     * \brief Marks all positions of a line within the margin of an inside
+     * position
+     */
+    template <typename Inside, typename Mark>
+    void dilate(const Inside& inside, const Mark& mark, int length) const
+    {
+        // distance to the previous inside position, taking both directions
+        int last = -std::numeric_limits<int>::max() / 2;
+        for (int i = 0; i < length; ++i)
+        {
+            if (inside(i)) last = i;
+            if (i - last <= margin_) mark(i);
+        }
+
+        last = std::numeric_limits<int>::max() / 2;
+        for (int i = length - 1; i >= 0; --i)
+        {
+            if (inside(i)) last = i;
+            if (last - i <= margin_) mark(i);
+        }
+    }
+
+    int n_rows_;
+    int n_cols_;
+    int margin_;
+    int background_stride_;
+    unsigned long update_count_;
+
+    std::vector<unsigned char> active_;
+    std::vector<unsigned char> dilation_;
+};
+}
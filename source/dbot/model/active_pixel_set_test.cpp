@@ -0,0 +1,90 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file active_pixel_set_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/active_pixel_set.hpp>
+
+namespace
+{
+const int ROWS = 20;
+const int COLS = 30;
+
+std::vector<float> silhouette(int row, int col)
+{
+    std::vector<float> depth(ROWS * COLS,
+                             std::numeric_limits<float>::infinity());
+    depth[row * COLS + col] = 1.f;
+    return depth;
+}
+}
+
+TEST(ActivePixelSetTests, dilates_the_silhouette)
+{
+    dbot::ActivePixelSet pixels(ROWS, COLS, 2, 0);
+    pixels.update(silhouette(10, 15));
+
+    EXPECT_EQ(pixels.count(), 5 * 5);
+    EXPECT_TRUE(pixels.active(8 * COLS + 13));
+    EXPECT_TRUE(pixels.active(12 * COLS + 17));
+    EXPECT_FALSE(pixels.active(7 * COLS + 15));
+    EXPECT_FALSE(pixels.active(10 * COLS + 18));
+}
+
+TEST(ActivePixelSetTests, dilation_is_clipped_at_the_border)
+{
+    dbot::ActivePixelSet pixels(ROWS, COLS, 2, 0);
+    pixels.update(silhouette(0, 0));
+
+    EXPECT_EQ(pixels.count(), 3 * 3);
+}
+
+TEST(ActivePixelSetTests, background_sample_covers_the_image)
+{
+    const int stride = 4;
+    dbot::ActivePixelSet pixels(ROWS, COLS, 0, stride);
+
+    std::vector<int> visits(ROWS * COLS, 0);
+    for (int update = 0; update < stride; ++update)
+    {
+        pixels.update(silhouette(0, 0));
+        for (int i = 1; i < ROWS * COLS; ++i) visits[i] += pixels.active(i);
+        EXPECT_LT(pixels.count(), ROWS * COLS / 2);
+    }
+
+    for (int i = 1; i < ROWS * COLS; ++i) EXPECT_EQ(visits[i], 1);
+}
+
+TEST(ActivePixelSetTests, masks_inactive_pixels)
+{
+    dbot::ActivePixelSet pixels(ROWS, COLS, 1, 0);
+    pixels.update(silhouette(5, 5));
+
+    Eigen::VectorXd obsrv = Eigen::VectorXd::Ones(ROWS * COLS);
+    pixels.mask(obsrv);
+
+    EXPECT_EQ(obsrv(5 * COLS + 6), 1.);
+    EXPECT_TRUE(std::isnan(obsrv(0)));
+}
@@ -0,0 +1,97 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_transition.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <fl/util/types.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Transition which propagates many states in one call.
+ *
+ * The states and noises are the columns of the matrices, hence the
+ * propagation of all particles can run as matrix products instead of one
+ * virtual state() call with temporaries per particle. The
+ * RaoBlackwellCoordinateParticleFilter uses this interface if its transition
+ * implements it.
+ */
+template <typename State, typename Noise, typename Input>
+class BatchTransition
+{
+public:
+    typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+public:
+    virtual ~BatchTransition() noexcept {}
+
+    /**
+     * \brief Computes the successors of the states given the noises,
+     *        column by column the same as state() of the transition
+     *
+     * \param states       [state dimension x count] prior states
+     * \param noises       [noise dimension x count] noise of each state
+     * \param predictions  [state dimension x count] successors, may not
+     *                     alias the states or noises
+     */
+    virtual void states(const Eigen::Ref<const Matrix>& states,
+                        const Eigen::Ref<const Matrix>& noises,
+                        const Input& input,
+                        Eigen::Ref<Matrix> predictions) const = 0;
+};
+
+/**
+ * \brief Linear transition x' = A x + B w + C u which propagates batches of
+ *        states as two matrix products
+ */
+template <typename State, typename Noise, typename Input>
+class LinearBatchTransition
+    : public fl::LinearTransition<State, Noise, Input>,
+      public BatchTransition<State, Noise, Input>
+{
+public:
+    typedef fl::LinearTransition<State, Noise, Input> Base;
+    typedef typename BatchTransition<State, Noise, Input>::Matrix Matrix;
+
+public:
+    LinearBatchTransition(int state_dim, int noise_dim, int input_dim)
+        : Base(state_dim, noise_dim, input_dim)
+    {
+    }
+
+    void states(const Eigen::Ref<const Matrix>& states,
+                const Eigen::Ref<const Matrix>& noises,
+                const Input& input,
+                Eigen::Ref<Matrix> predictions) const override
+    {
+        predictions.noalias() = this->dynamics_matrix() * states;
+        predictions.noalias() += this->noise_matrix() * noises;
+
+        if (input.size() > 0)
+        {
+            const Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> offset =
+                this->input_matrix() * input;
+            predictions.colwise() += offset;
+        }
+    }
+};
+}
@@ -0,0 +1,90 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_transition_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/builder/object_transition_builder.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef dbot::ObjectTransitionBuilder<State> TransitionBuilder;
+typedef TransitionBuilder::DerivedModel Transition;
+typedef Transition::Matrix Matrix;
+
+static Transition create_transition(int part_count)
+{
+    TransitionBuilder::Parameters parameters;
+    parameters.linear_sigma_x = 0.002;
+    parameters.linear_sigma_y = 0.003;
+    parameters.linear_sigma_z = 0.004;
+    parameters.angular_sigma_x = 0.01;
+    parameters.angular_sigma_y = 0.02;
+    parameters.angular_sigma_z = 0.03;
+    parameters.velocity_factor = 0.8;
+    parameters.part_count = part_count;
+
+    return TransitionBuilder(parameters).build_model();
+}
+
+TEST(BatchTransitionTests, batch_equals_state_by_state)
+{
+    const int part_count = 2;
+    const int count = 37;
+    Transition transition = create_transition(part_count);
+    const Transition::Input input = Transition::Input::Zero(1);
+
+    Matrix states = Matrix::Random(transition.state_dimension(), count);
+    Matrix noises = Matrix::Random(transition.noise_dimension(), count);
+    Matrix predictions(transition.state_dimension(), count);
+
+    transition.states(states, noises, input, predictions);
+
+    for (int i = 0; i < count; ++i)
+    {
+        State state = states.col(i);
+        Transition::Noise noise = noises.col(i);
+
+        State expected = transition.state(state, noise, input);
+        EXPECT_TRUE(predictions.col(i).isApprox(expected, 1e-12));
+    }
+}
+
+TEST(BatchTransitionTests, batches_of_columns_are_independent)
+{
+    Transition transition = create_transition(1);
+    const Transition::Input input = Transition::Input::Zero(1);
+
+    Matrix states = Matrix::Random(transition.state_dimension(), 10);
+    Matrix noises = Matrix::Random(transition.noise_dimension(), 10);
+    Matrix all(transition.state_dimension(), 10);
+    Matrix parts(transition.state_dimension(), 10);
+
+    transition.states(states, noises, input, all);
+    transition.states(states.leftCols(4),
+                      noises.leftCols(4),
+                      input,
+                      parts.leftCols(4));
+    transition.states(states.rightCols(6),
+                      noises.rightCols(6),
+                      input,
+                      parts.rightCols(6));
+
+    EXPECT_TRUE(all.isApprox(parts, 1e-12));
+}
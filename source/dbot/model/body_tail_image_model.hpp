@@ -0,0 +1,164 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file body_tail_image_model.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/depth_pixel_model.hpp>
+
+namespace fl
+{
+/**
+ * \brief Image level evaluation of the body-tail pixel model of the
+ * GaussianTracker for all pixels and sigma points at once.
+ *
+ * Per pixel, the observation is the mixture of the DepthPixelModel body and
+ * a uniform tail on [tail_min, tail_max] with the weight tail_weight, as in
+ * BodyTailSensor<DepthPixelModel, UniformSensor>. Instead of conditioning a
+ * copy of the pixel model on each pixel and evaluating it through the
+ * sensor interfaces one scalar at a time, the rendering of each sigma point
+ * is looked up once and all pixels are evaluated in a few dense sweeps.
+ * The results equal those of the pixel models.
+ *
+ * The model shares the sigma point renderings with the pixel model it is
+ * created from.
+ */
+template <typename State>
+class BodyTailImageModel
+{
+public:
+    typedef DepthPixelModel<State> BodyModel;
+
+public:
+    BodyTailImageModel(const BodyModel& body,
+                       Real tail_min,
+                       Real tail_max,
+                       Real tail_weight)
+        : body_(body),
+          tail_min_(tail_min),
+          tail_max_(tail_max),
+          tail_weight_(tail_weight)
+    {
+    }
+
+    /**
+     * \brief Log densities of all pixels of \a obsrv_image for each of the
+     * \a states, log((1 - w) p_body + w p_tail) into log_probs(pixel, j)
+     */
+    void log_probabilities(const Eigen::VectorXd& obsrv_image,
+                           const std::vector<State>& states,
+                           Eigen::MatrixXd& log_probs) const
+    {
+        body_.log_probabilities(obsrv_image, states, log_probs);
+
+        const Eigen::ArrayXd tail = tail_weight_ * tail_densities(obsrv_image);
+        const Real body_weight = Real(1) - tail_weight_;
+
+        for (int j = 0; j < log_probs.cols(); ++j)
+        {
+            const Eigen::ArrayXd body =
+                log_probs.col(j).array().unaryExpr(
+                    [](Real x) { return std::exp(x); });
+
+            log_probs.col(j) = (body_weight * body + tail).unaryExpr(
+                [](Real x) { return std::log(x); });
+        }
+    }
+
+    /**
+     * \brief Means and variances of the observations of all pixels for each
+     * of the \a states, the moments of the body-tail mixture of each pixel
+     * into means(pixel, j) and variances(pixel, j)
+     */
+    void moments(const std::vector<State>& states,
+                 Eigen::MatrixXd& means,
+                 Eigen::MatrixXd& variances) const
+    {
+        const Real body_weight = Real(1) - tail_weight_;
+        const Real tail_mean = (tail_min_ + tail_max_) / 2;
+        const Real tail_width = tail_max_ - tail_min_;
+        const Real tail_second_moment =
+            tail_width * tail_width / 12 + tail_mean * tail_mean;
+
+        Eigen::ArrayXd mean, sigma;
+        for (size_t j = 0; j < states.size(); ++j)
+        {
+            body_.moments(states[j], mean, sigma);
+
+            if (j == 0)
+            {
+                means.resize(mean.size(), states.size());
+                variances.resize(mean.size(), states.size());
+            }
+
+            const Eigen::ArrayXd mixture_mean =
+                body_weight * mean + tail_weight_ * tail_mean;
+
+            means.col(j) = mixture_mean;
+            variances.col(j) =
+                body_weight * (sigma * sigma + mean * mean) +
+                tail_weight_ * tail_second_moment -
+                mixture_mean * mixture_mean;
+        }
+    }
+
+    /**
+     * \brief Body depths of all pixels for each of the \a states, see
+     * DepthPixelModel::observations()
+     */
+    void body_observations(const std::vector<State>& states,
+                           const Eigen::MatrixXd& noises,
+                           Eigen::MatrixXd& obsrvs) const
+    {
+        body_.observations(states, noises, obsrvs);
+    }
+
+    /**
+     * \brief Tail depths of all pixels for the standard uniform \a noises
+     */
+    Eigen::MatrixXd tail_observations(const Eigen::MatrixXd& noises) const
+    {
+        return (tail_min_ + (tail_max_ - tail_min_) * noises.array()).matrix();
+    }
+
+    const BodyModel& body_model() const { return body_; }
+    Real tail_weight() const { return tail_weight_; }
+
+private:
+    /** \return the uniform tail density of each pixel of \a obsrv_image */
+    Eigen::ArrayXd tail_densities(const Eigen::VectorXd& obsrv_image) const
+    {
+        const Eigen::ArrayXd y = obsrv_image.array();
+        const Eigen::ArrayXd inside =
+            ((y >= tail_min_) && (y <= tail_max_)).template cast<Real>();
+
+        return inside / (tail_max_ - tail_min_);
+    }
+
+private:
+    BodyModel body_;
+    Real tail_min_;
+    Real tail_max_;
+    Real tail_weight_;
+};
+}
@@ -0,0 +1,110 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file body_tail_image_model_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/model/body_tail_image_model.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef fl::DepthPixelModel<State> PixelModel;
+typedef fl::BodyTailImageModel<State> ImageModel;
+
+TEST(BodyTailImageModelTests, image_sweeps_equal_the_pixel_models)
+{
+    const int n_rows = 24;
+    const int n_cols = 32;
+    Eigen::Matrix3d camera;
+    camera << 36, 0, 16, 0, 36, 12, 0, 0, 1;
+
+    dbot::SyntheticObjectLoader loader(1, 8);
+    std::vector<std::vector<Eigen::Vector3d>> vertices;
+    std::vector<std::vector<std::vector<int>>> indices;
+    loader.load(vertices, indices);
+    auto renderer = std::make_shared<dbot::RigidBodyRenderer>(
+        vertices, indices, camera, n_rows, n_cols);
+
+    PixelModel pixel_model(renderer, 1.5, 0.001, 0.5, 12);
+    State nominal(1);
+    nominal.component(0).position() = Eigen::Vector3d(0, 0, 0.8);
+    pixel_model.nominal_pose(nominal);
+
+    std::vector<State> states(3, State(1));
+    states[1].component(0).position() = Eigen::Vector3d(0.01, 0, 0);
+    states[2].component(0).position() = Eigen::Vector3d(0, -0.02, 0.01);
+
+    const int pixels = n_rows * n_cols;
+    Eigen::VectorXd image(pixels);
+    Eigen::MatrixXd noises(pixels, states.size());
+    for (int i = 0; i < pixels; ++i)
+    {
+        image(i) = 0.75 + 0.8 * (i % 7) / 7.;
+        for (int j = 0; j < noises.cols(); ++j)
+        {
+            noises(i, j) = std::sin(i + 3. * j);
+        }
+    }
+
+    const double tail_weight = 0.01;
+    ImageModel image_model(pixel_model, 0., 1.4, tail_weight);
+
+    Eigen::MatrixXd obsrvs, log_probs, means, variances;
+    image_model.body_observations(states, noises, obsrvs);
+    image_model.log_probabilities(image, states, log_probs);
+    image_model.moments(states, means, variances);
+
+    int covered = 0;
+    for (int j = 0; j < int(states.size()); ++j)
+    {
+        for (int i = 0; i < pixels; ++i)
+        {
+            fl::Vector1d y, noise;
+            y(0) = image(i);
+            noise(0) = noises(i, j);
+
+            EXPECT_EQ(obsrvs(i, j),
+                      pixel_model.observation(states[j], noise, i)(0));
+
+            const double tail = image(i) <= 1.4 ? 1 / 1.4 : 0.;
+            const double p =
+                (1 - tail_weight) * pixel_model.probability(y, states[j], i) +
+                tail_weight * tail;
+            EXPECT_EQ(log_probs(i, j), std::log(p));
+
+            // the mean of the body without noise
+            fl::Vector1d zero = fl::Vector1d::Zero();
+            const double body_mean =
+                pixel_model.observation(states[j], zero, i)(0);
+            EXPECT_NEAR(means(i, j),
+                        (1 - tail_weight) * body_mean + tail_weight * 0.7,
+                        1e-12);
+            EXPECT_GT(variances(i, j), 0);
+
+            if (body_mean < 1.5) ++covered;
+        }
+    }
+
+    // the object is in view
+    EXPECT_GT(covered, 0);
+}
@@ -29,10 +29,10 @@
 
 #pragma once
 
-#include <mutex>
+#include <cmath>
 #include <cstdlib>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 #include <Eigen/Dense>
 
@@ -45,11 +45,18 @@
 #include <fl/model/sensor/interface/sensor_function.hpp>
 
 #include <dbot/rigid_body_renderer.hpp>
-
-#include <osr/pose_hashing.hpp>
+#include <dbot/model/sigma_point_render_store.hpp>
 
 namespace fl
 {
+/**
+ * \brief Depth of a single pixel given the state of the object.
+ *
+ * The filter conditions the model on a pixel by setting its id. The overloads
+ * taking the pixel explicitly do not touch any state of the model except for
+ * the shared sigma point renderings, which are rendered under a lock, hence
+ * they may be evaluated concurrently for different pixels.
+ */
 template <typename State_>
 class DepthPixelModel
     : public SensorFunction<Vector1d, State_, Vector1d>,
@@ -61,10 +68,7 @@ public:
     typedef Vector1d Noise;
     typedef State_ State;
 
-    typedef std::unordered_map<State, State, osr::PoseHash<State>> PoseCacheMap;
-
-    typedef std::unordered_map<State, Eigen::VectorXd, osr::PoseHash<State>>
-        RenderCacheMap;
+    typedef dbot::SigmaPointRenderStore<State> RenderStore;
 
 public:
     DepthPixelModel(
@@ -73,21 +77,21 @@ public:
         Real fg_sigma,
         Real bg_sigma,
         int state_dim = DimensionOf<State>::Value)
-        : state_dim_(state_dim), renderer_(renderer), id_(0)
+        : state_dim_(state_dim),
+          fg_sigma_(fg_sigma),
+          bg_sigma_(bg_sigma),
+          renderer_(renderer),
+          id_(0)
     {
-        mutex = std::make_shared<std::mutex>();
-        render_cache_ = std::make_shared<RenderCacheMap>();
-        poses_cache_ = std::make_shared<PoseCacheMap>();
-
-        // setup backgroud density
-        auto bg_mean = Obsrv(1);
-
-        bg_mean(0) =
+        // the unscented transform renders 2 * state_dim + 1 distinct states.
+        // The store has room for as many mispredicted batch renderings, and
+        // predicted sigma points match the ones of the filter up to rounding
+        render_store_ =
+            std::make_shared<RenderStore>(2 * (2 * state_dim_ + 1), 1e-9);
+
+        // the background is infinitely far away for a negative depth
+        bg_mean_ =
             bg_depth < 0. ? std::numeric_limits<Real>::infinity() : bg_depth;
-        bg_density_.mean(bg_mean);
-        bg_density_.square_root(bg_density_.square_root() * bg_sigma);
-
-        fg_density_.square_root(fg_density_.square_root() * fg_sigma);
     }
 
     DepthPixelModel(const DepthPixelModel& other)
@@ -95,44 +99,174 @@ public:
         state_dim_ = other.state_dim_;
         renderer_ = other.renderer_;
         id_ = other.id_;
-        bg_density_ = other.bg_density_;
-        fg_density_ = other.fg_density_;
-        mutex = other.mutex;
+        bg_mean_ = other.bg_mean_;
+        bg_sigma_ = other.bg_sigma_;
+        fg_sigma_ = other.fg_sigma_;
         nominal_pose_ = other.nominal_pose_;
-        render_cache_ = other.render_cache_;
-        poses_cache_ = other.poses_cache_;
+        render_store_ = other.render_store_;
     }
 
     virtual ~DepthPixelModel() noexcept {}
     Real log_probability(const Obsrv& obsrv, const State& state) const override
     {
-        return density(state).log_probability(obsrv);
+        return log_probability(obsrv, state, id_);
     }
 
     Real probability(const Obsrv& obsrv, const State& state) const override
     {
-        return density(state).probability(obsrv);
+        return probability(obsrv, state, id_);
     }
 
     Obsrv observation(const State& state, const Noise& noise) const override
     {
-        Obsrv y = density(state).map_standard_normal(noise);
+        return observation(state, noise, id_);
+    }
+
+    /**
+     * \brief Log density of the depth \a obsrv of the given pixel
+     */
+    Real log_probability(const Obsrv& obsrv,
+                         const State& state,
+                         int pixel) const
+    {
+        Real mean, sigma;
+        moments(state, pixel, mean, sigma);
+
+        const Real z = (obsrv(0) - mean) / sigma;
+        return -0.5 * z * z - std::log(sigma) - 0.5 * std::log(2. * M_PI);
+    }
+
+    /**
+     * \brief Density of the depth \a obsrv of the given pixel
+     */
+    Real probability(const Obsrv& obsrv, const State& state, int pixel) const
+    {
+        return std::exp(log_probability(obsrv, state, pixel));
+    }
+
+    /**
+     * \brief Depth of the given pixel for the standard normal \a noise
+     */
+    Obsrv observation(const State& state, const Noise& noise, int pixel) const
+    {
+        Real mean, sigma;
+        moments(state, pixel, mean, sigma);
+
+        Obsrv y;
+        y(0) = mean + sigma * noise(0);
         return y;
     }
 
+    /**
+     * \brief Depths of all pixels for each of the \a states in one sweep per
+     * state. Column j of \a obsrvs holds the image of states[j] for the
+     * standard normal noises of the pixels in column j of \a noises. The
+     * depths equal those of observation() for each pixel.
+     */
+    void observations(const std::vector<State>& states,
+                      const Eigen::MatrixXd& noises,
+                      Eigen::MatrixXd& obsrvs) const
+    {
+        obsrvs.resize(noises.rows(), states.size());
+
+        Eigen::ArrayXd mean, sigma;
+        for (size_t j = 0; j < states.size(); ++j)
+        {
+            moments(states[j], mean, sigma);
+            obsrvs.col(j) = mean + sigma * noises.col(j).array();
+        }
+    }
+
+    /**
+     * \brief Log densities of all pixels of \a obsrv_image for each of the
+     * \a states, log_probs(pixel, j) equals log_probability() of the pixel
+     * given states[j]
+     */
+    void log_probabilities(const Eigen::VectorXd& obsrv_image,
+                           const std::vector<State>& states,
+                           Eigen::MatrixXd& log_probs) const
+    {
+        log_probs.resize(obsrv_image.size(), states.size());
+
+        const Real half_log_2_pi = 0.5 * std::log(2. * M_PI);
+        const Real fg_log_sigma = std::log(fg_sigma_);
+        const Real bg_log_sigma = std::log(bg_sigma_);
+
+        Eigen::ArrayXd mean, sigma;
+        for (size_t j = 0; j < states.size(); ++j)
+        {
+            moments(states[j], mean, sigma);
+
+            const Eigen::ArrayXd z = (obsrv_image.array() - mean) / sigma;
+            const int size = sigma.size();
+            const Eigen::ArrayXd log_sigma = (sigma == fg_sigma_).select(
+                Eigen::ArrayXd::Constant(size, fg_log_sigma),
+                Eigen::ArrayXd::Constant(size, bg_log_sigma));
+
+            log_probs.col(j) = -0.5 * z * z - log_sigma - half_log_2_pi;
+        }
+    }
+
+    /**
+     * \brief Means and standard deviations of the depths of all pixels given
+     * \a state, see moments() of a single pixel
+     */
+    void moments(const State& state,
+                 Eigen::ArrayXd& mean,
+                 Eigen::ArrayXd& sigma) const
+    {
+        const Eigen::ArrayXd depth = image(state).array();
+        const auto background =
+            depth == std::numeric_limits<Real>::infinity();
+
+        const int size = depth.size();
+        mean = background.select(Eigen::ArrayXd::Constant(size, bg_mean_),
+                                 depth);
+        sigma = background.select(Eigen::ArrayXd::Constant(size, bg_sigma_),
+                                  Eigen::ArrayXd::Constant(size, fg_sigma_));
+    }
+
     virtual int obsrv_dimension() const { return 1; }
     virtual int noise_dimension() const { return 1; }
     virtual int state_dimension() const { return state_dim_; }
     virtual int id() const { return id_; }
     virtual void id(int new_id) { id_ = new_id; }
+    /**
+     * \brief Sets the pose the states are relative to and discards the
+     * renderings of the previous update
+     */
     void nominal_pose(const State& p)
     {
-        std::lock_guard<std::mutex> lock(*mutex);
-
-        render_cache_->clear();
+        render_store_->clear();
         nominal_pose_ = p;
     }
 
+    /**
+     * \brief Renders the sigma points of the next update in one batch of the
+     * renderer. The remaining states are rendered on their first lookup.
+     */
+    void render_sigma_points(const std::vector<State>& sigma_points)
+    {
+        render_store_->render(
+            sigma_points,
+            [this](const std::vector<State>& states,
+                   Eigen::VectorXd* obsrv_images) {
+                batch_poses_.resize(states.size());
+                for (size_t i = 0; i < states.size(); ++i)
+                {
+                    batch_poses_[i] = {
+                        absolute_pose(states[i]).component(0).affine()};
+                }
+
+                renderer_->Render(batch_poses_, batch_renderings_);
+
+                for (size_t i = 0; i < states.size(); ++i)
+                {
+                    convert(batch_renderings_[i], obsrv_images[i]);
+                }
+            });
+    }
+
     virtual std::string name() const { return "DepthPixelModel"; }
     virtual std::string description() const
     {
@@ -143,10 +277,14 @@ private:
     /** \cond internal */
     void map(const State& pose, Eigen::VectorXd& obsrv_image) const
     {
-        renderer_->set_poses({pose.component(0).affine()});
-        renderer_->Render(depth_rendering_);
+        const auto& part = pose.component(0);
+
+        std::vector<float> depth_rendering;
+        renderer_->Render({part.orientation().rotation_matrix()},
+                          {part.position()},
+                          depth_rendering);
 
-        convert(depth_rendering_, obsrv_image);
+        convert(depth_rendering, obsrv_image);
     }
 
     void convert(const std::vector<float>& depth,
@@ -168,72 +306,79 @@ private:
         }
     }
 
-    const Gaussian<Obsrv>& density(const State& state) const
+    /**
+     * \brief Mean and standard deviation of the depth of the given pixel.
+     * Pixels not covered by the object observe the background.
+     */
+    void moments(const State& state, int pixel, Real& mean, Real& sigma) const
     {
-        Obsrv y = depth(state);
+        mean = depth(state, pixel);
+        sigma = fg_sigma_;
 
-        if (std::isinf(y(0)))
+        if (std::isinf(mean))
         {
-            return bg_density_;
+            mean = bg_mean_;
+            sigma = bg_sigma_;
         }
-
-        fg_density_.mean(y);
-        return fg_density_;
     }
 
-    Obsrv depth(const State& current_state) const
+    State absolute_pose(const State& current_state) const
     {
-        RenderCacheMap& render_cache_ = *this->render_cache_;
-        PoseCacheMap& poses_cache_ = *this->poses_cache_;
-
-        if (render_cache_.find(current_state) == render_cache_.end())
-        {
-            State current_pose = current_state;
-
-
-            /// \todo: this transformation should not be done in here
-
-            current_pose.component(0).position() =
-                nominal_pose_.component(0).orientation().rotation_matrix() *
-                    current_state.component(0).position() +
-                nominal_pose_.component(0).position();
-
-            current_pose.component(0).orientation() =
-                nominal_pose_.component(0).orientation() *
-                current_state.component(0).orientation();
+        State current_pose = current_state;
 
+        /// \todo: this transformation should not be done in here
 
+        current_pose.component(0).position() =
+            nominal_pose_.component(0).orientation().rotation_matrix() *
+                current_state.component(0).position() +
+            nominal_pose_.component(0).position();
 
-            std::lock_guard<std::mutex> lock(*mutex);
-            map(current_pose, render_cache_[current_state]);
-            poses_cache_[current_state] = current_pose;
-        }
+        current_pose.component(0).orientation() =
+            nominal_pose_.component(0).orientation() *
+            current_state.component(0).orientation();
 
-        assert(render_cache_.find(current_state) != render_cache_.end());
+        return current_pose;
+    }
 
-        Obsrv depth;
-        depth(0) = render_cache_[current_state](id_);
+    const Eigen::VectorXd& image(const State& current_state) const
+    {
+        return render_store_->image(
+            current_state,
+            [this](const State& state, Eigen::VectorXd& obsrv_image) {
+                map(absolute_pose(state), obsrv_image);
+            });
+    }
 
-        return depth;
+    Real depth(const State& current_state, int pixel) const
+    {
+        return render_store_->depth(
+            current_state,
+            [this](const State& state, Eigen::VectorXd& obsrv_image) {
+                map(absolute_pose(state), obsrv_image);
+            },
+            pixel);
     }
     /** \endcond */
 
 private:
     int state_dim_;
 
-    mutable Gaussian<Obsrv> fg_density_;
-    mutable Gaussian<Obsrv> bg_density_;
+    // the depth is normal around the rendered or the background depth
+    Real fg_sigma_;
+    Real bg_mean_;
+    Real bg_sigma_;
 
-    mutable std::shared_ptr<std::mutex> mutex;
-    mutable std::vector<float> depth_rendering_;
     std::shared_ptr<dbot::RigidBodyRenderer> renderer_;
 
+    // staging of the batch renderings
+    std::vector<std::vector<dbot::RigidBodyRenderer::Affine>> batch_poses_;
+    std::vector<std::vector<float>> batch_renderings_;
+
 private:
     int id_;
     mutable State nominal_pose_;
 
-public:
-    mutable std::shared_ptr<RenderCacheMap> render_cache_;
-    mutable std::shared_ptr<PoseCacheMap> poses_cache_;
+    // renderings of the sigma points, shared by the models of all pixels
+    std::shared_ptr<RenderStore> render_store_;
 };
 }
@@ -0,0 +1,259 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_reuse.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Parameters of reusing the renderings of the previous frame.
+ *
+ * Between two frames most particles move by far less than a pixel. If the
+ * pose of a particle is within the given distance of the pose its ancestor
+ * has been rendered at, the rendering of the ancestor is warped to the new
+ * pose instead of rendering the particle. The warped depths are
+ * approximate: surfaces which only become visible at the new pose are
+ * missing and the silhouette moves in whole pixels.
+ */
+struct DepthReuse
+{
+    /// warps the renderings of the ancestors whenever possible
+    bool enabled = false;
+
+    /// largest translation of the object origin in meters and rotation in
+    /// radians relative to the rendered pose of the ancestor
+    double max_translation = 0.001;
+    double max_rotation = 0.002;
+
+    /// every validation_interval-th warped rendering of a thread is also
+    /// rendered to measure the approximation error, 0 never renders them
+    int validation_interval = 0;
+};
+
+/**
+ * \brief Reprojects the depths rendered at one pose to a nearby pose
+ */
+class DepthWarp
+{
+public:
+    /** \brief The depths of the covered pixels rendered at a pose */
+    struct Rendering
+    {
+        bool valid = false;
+        Eigen::Matrix3d rotation;
+        Eigen::Vector3d translation;
+        std::vector<int> intersect_indices;
+        std::vector<float> depth;
+    };
+
+    /** \brief Memory reused between calls of warp() */
+    struct Buffer
+    {
+        std::vector<Eigen::Vector3f> targets;
+        std::vector<float> roi_depth;
+    };
+
+public:
+    /**
+     * \return whether the pose is close enough to the pose of \a rendering
+     *         to warp it, see DepthReuse
+     */
+    static bool close(const Rendering& rendering,
+                      const Eigen::Matrix3d& rotation,
+                      const Eigen::Vector3d& translation,
+                      const DepthReuse& reuse)
+    {
+        if (!rendering.valid) return false;
+        if ((translation - rendering.translation).norm() >
+            reuse.max_translation)
+        {
+            return false;
+        }
+
+        const Eigen::AngleAxisd delta(rotation *
+                                      rendering.rotation.transpose());
+        return std::fabs(delta.angle()) <= reuse.max_rotation;
+    }
+
+    /**
+     * \brief Moves the surface points of \a source rigidly to the given pose
+     *        and projects them into the covered pixels in row major order.
+     *
+     * The nearest point is kept when several project into the same pixel.
+     * Pixels left uncovered between two covered neighbours in a row or a
+     * column are interpolated, other pixels uncovered by the motion stay
+     * uncovered.
+     */
+    static void warp(const Rendering& source,
+                     const Eigen::Matrix3d& rotation,
+                     const Eigen::Vector3d& translation,
+                     const Eigen::Matrix3d& camera_matrix,
+                     int n_rows,
+                     int n_cols,
+                     std::vector<int>& intersect_indices,
+                     std::vector<float>& depth,
+                     Buffer& buffer)
+    {
+        intersect_indices.clear();
+        depth.clear();
+
+        // the pixel (col, row) at depth z moves to z H (col, row, 1) + h
+        const Eigen::Matrix3d delta_rotation =
+            rotation * source.rotation.transpose();
+        const Eigen::Vector3d delta_translation =
+            translation - delta_rotation * source.translation;
+        const Eigen::Matrix3d H =
+            camera_matrix * delta_rotation * camera_matrix.inverse();
+        const Eigen::Vector3d h = camera_matrix * delta_translation;
+
+        int min_row = std::numeric_limits<int>::max();
+        int max_row = -std::numeric_limits<int>::max();
+        int min_col = std::numeric_limits<int>::max();
+        int max_col = -std::numeric_limits<int>::max();
+
+        buffer.targets.clear();
+        for (size_t i = 0; i < source.intersect_indices.size(); i++)
+        {
+            const int pixel = source.intersect_indices[i];
+            const Eigen::Vector3d point =
+                source.depth[i] *
+                    (H * Eigen::Vector3d(pixel % n_cols, pixel / n_cols, 1)) +
+                h;
+            if (point(2) < 0.001) continue;
+
+            const int col = int(std::lround(point(0) / point(2)));
+            const int row = int(std::lround(point(1) / point(2)));
+            if (row < 0 || row >= n_rows || col < 0 || col >= n_cols) continue;
+
+            buffer.targets.push_back(
+                Eigen::Vector3f(float(col), float(row), float(point(2))));
+            min_row = std::min(min_row, row);
+            max_row = std::max(max_row, row);
+            min_col = std::min(min_col, col);
+            max_col = std::max(max_col, col);
+        }
+
+        if (buffer.targets.empty()) return;
+
+        const int roi_rows = max_row - min_row + 1;
+        const int roi_cols = max_col - min_col + 1;
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        std::vector<float>& roi = buffer.roi_depth;
+        roi.assign(roi_rows * roi_cols, infinity);
+        for (const Eigen::Vector3f& target : buffer.targets)
+        {
+            float& pixel_depth = roi[(int(target(1)) - min_row) * roi_cols +
+                                     int(target(0)) - min_col];
+            pixel_depth = std::min(pixel_depth, target(2));
+        }
+
+        // close the cracks between points which moved apart
+        for (int row = 0; row < roi_rows; row++)
+        {
+            for (int col = 0; col < roi_cols; col++)
+            {
+                float& pixel_depth = roi[row * roi_cols + col];
+                if (pixel_depth != infinity) continue;
+
+                if (col > 0 && col + 1 < roi_cols &&
+                    roi[row * roi_cols + col - 1] != infinity &&
+                    roi[row * roi_cols + col + 1] != infinity)
+                {
+                    pixel_depth = 0.5f * (roi[row * roi_cols + col - 1] +
+                                          roi[row * roi_cols + col + 1]);
+                }
+                else if (row > 0 && row + 1 < roi_rows &&
+                         roi[(row - 1) * roi_cols + col] != infinity &&
+                         roi[(row + 1) * roi_cols + col] != infinity)
+                {
+                    pixel_depth = 0.5f * (roi[(row - 1) * roi_cols + col] +
+                                          roi[(row + 1) * roi_cols + col]);
+                }
+            }
+        }
+
+        for (int row = 0; row < roi_rows; row++)
+        {
+            for (int col = 0; col < roi_cols; col++)
+            {
+                const float pixel_depth = roi[row * roi_cols + col];
+                if (pixel_depth == infinity) continue;
+
+                intersect_indices.push_back((row + min_row) * n_cols + col +
+                                            min_col);
+                depth.push_back(pixel_depth);
+            }
+        }
+    }
+
+    /**
+     * \brief Compares two renderings given in row major order
+     *
+     * \param [out] depth_error     mean absolute depth difference in meters
+     *                              of the pixels covered by both
+     * \param [out] coverage_error  fraction of the covered pixels which are
+     *                              covered by only one of them
+     */
+    static void compare(const std::vector<int>& indices_a,
+                        const std::vector<float>& depth_a,
+                        const std::vector<int>& indices_b,
+                        const std::vector<float>& depth_b,
+                        double& depth_error,
+                        double& coverage_error)
+    {
+        double difference = 0;
+        int common = 0;
+        int exclusive = 0;
+
+        size_t a = 0, b = 0;
+        while (a < indices_a.size() || b < indices_b.size())
+        {
+            if (b == indices_b.size() ||
+                (a < indices_a.size() && indices_a[a] < indices_b[b]))
+            {
+                exclusive++;
+                a++;
+            }
+            else if (a == indices_a.size() || indices_b[b] < indices_a[a])
+            {
+                exclusive++;
+                b++;
+            }
+            else
+            {
+                difference += std::fabs(double(depth_a[a++]) - depth_b[b++]);
+                common++;
+            }
+        }
+
+        depth_error = common > 0 ? difference / common : 0;
+        coverage_error =
+            common + exclusive > 0 ? double(exclusive) / (common + exclusive)
+                                   : 0;
+    }
+};
+}
@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_reuse_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/model/depth_reuse.hpp>
+
+using dbot::DepthReuse;
+using dbot::DepthWarp;
+
+static const int n_rows = 30;
+static const int n_cols = 40;
+
+static Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 50, 0, 20, 0, 50, 15, 0, 0, 1;
+    return camera_matrix;
+}
+
+/// a fronto-parallel square of 10 x 8 pixels at depth 2
+static DepthWarp::Rendering create_square()
+{
+    DepthWarp::Rendering rendering;
+    rendering.valid = true;
+    rendering.rotation.setIdentity();
+    rendering.translation = Eigen::Vector3d(0, 0, 2);
+    for (int row = 10; row < 18; row++)
+    {
+        for (int col = 15; col < 25; col++)
+        {
+            rendering.intersect_indices.push_back(row * n_cols + col);
+            rendering.depth.push_back(2.f);
+        }
+    }
+    return rendering;
+}
+
+TEST(DepthReuseTests, warp_to_the_same_pose_is_identity)
+{
+    const DepthWarp::Rendering square = create_square();
+
+    std::vector<int> indices;
+    std::vector<float> depth;
+    DepthWarp::Buffer buffer;
+    DepthWarp::warp(square,
+                    square.rotation,
+                    square.translation,
+                    camera_matrix(),
+                    n_rows,
+                    n_cols,
+                    indices,
+                    depth,
+                    buffer);
+
+    EXPECT_EQ(indices, square.intersect_indices);
+    ASSERT_EQ(depth.size(), square.depth.size());
+    for (size_t i = 0; i < depth.size(); i++)
+    {
+        EXPECT_NEAR(depth[i], square.depth[i], 1e-6);
+    }
+}
+
+TEST(DepthReuseTests, translation_moves_the_pixels)
+{
+    const DepthWarp::Rendering square = create_square();
+
+    // one pixel to the right and 1 cm further away
+    const Eigen::Vector3d translation =
+        square.translation + Eigen::Vector3d(2. / 50., 0, 0.01);
+
+    std::vector<int> indices;
+    std::vector<float> depth;
+    DepthWarp::Buffer buffer;
+    DepthWarp::warp(square,
+                    square.rotation,
+                    translation,
+                    camera_matrix(),
+                    n_rows,
+                    n_cols,
+                    indices,
+                    depth,
+                    buffer);
+
+    ASSERT_FALSE(indices.empty());
+    EXPECT_EQ(indices.front(), 10 * n_cols + 16);
+    EXPECT_EQ(indices.back(), 17 * n_cols + 25);
+    for (float d : depth) EXPECT_NEAR(d, 2.01f, 1e-5);
+
+    // the rendering at the exact pose differs in coverage only
+    double depth_error, coverage_error;
+    DepthWarp::compare(square.intersect_indices,
+                       square.depth,
+                       indices,
+                       depth,
+                       depth_error,
+                       coverage_error);
+    EXPECT_NEAR(depth_error, 0.01, 1e-5);
+    EXPECT_GT(coverage_error, 0.);
+    EXPECT_LT(coverage_error, 0.3);
+}
+
+TEST(DepthReuseTests, only_close_poses_are_reused)
+{
+    const DepthWarp::Rendering square = create_square();
+    DepthReuse reuse;
+
+    const Eigen::Matrix3d small_rotation =
+        Eigen::AngleAxisd(0.001, Eigen::Vector3d::UnitY()).toRotationMatrix();
+    const Eigen::Matrix3d large_rotation =
+        Eigen::AngleAxisd(0.01, Eigen::Vector3d::UnitY()).toRotationMatrix();
+    const Eigen::Vector3d step(0.0005, 0, 0);
+
+    EXPECT_TRUE(DepthWarp::close(
+        square, small_rotation, square.translation + step, reuse));
+    EXPECT_FALSE(DepthWarp::close(
+        square, large_rotation, square.translation, reuse));
+    EXPECT_FALSE(DepthWarp::close(
+        square, square.rotation, square.translation + 4 * step, reuse));
+
+    DepthWarp::Rendering invalid = square;
+    invalid.valid = false;
+    EXPECT_FALSE(
+        DepthWarp::close(invalid, square.rotation, square.translation, reuse));
+}
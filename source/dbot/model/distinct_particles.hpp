@@ -0,0 +1,149 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file distinct_particles.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <dbot/hash_index.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Groups the particles of a loglikes() call which yield the same
+ *        likelihood and the same occlusion update.
+ *
+ * Two particles are identical if their deltas are equal and they descend from
+ * the same occlusion map. After resampling, many particles are copies of one
+ * ancestor until the transition moves them, and blocks of the state which
+ * are not sampled in the current step do not move at all. Rendering and
+ * evaluating one representative per group suffices.
+ *
+ * The deltas are hashed bitwise and compared exactly, hence particles are
+ * only merged if their results would be identical. The buffers are kept
+ * between calls.
+ */
+class DistinctParticles
+{
+public:
+    /**
+     * \param deltas  Array of states with a size() and coefficient access
+     * \param ancestors  Occlusion map index of each particle
+     */
+    template <typename StateArray, typename IntArray>
+    void find(const StateArray& deltas, const IntArray& ancestors)
+    {
+        const int particle_count = deltas.size();
+
+        distinct_of_.resize(particle_count);
+        representatives_.clear();
+        next_.clear();
+        groups_.clear();
+        groups_.reserve(particle_count);
+
+        for (int i = 0; i < particle_count; ++i)
+        {
+            const std::uint64_t key = hash(deltas[i], ancestors[i]);
+
+            int distinct = groups_.find(key);
+            if (distinct < 0)
+            {
+                distinct_of_[i] = add(i);
+                groups_.insert(key, distinct_of_[i]);
+                continue;
+            }
+
+            // particles with colliding hashes are chained
+            int last = distinct;
+            for (; distinct >= 0; distinct = next_[distinct])
+            {
+                const int j = representatives_[distinct];
+                if (ancestors[j] == ancestors[i] && deltas[j] == deltas[i])
+                {
+                    break;
+                }
+                last = distinct;
+            }
+
+            if (distinct < 0)
+            {
+                distinct = add(i);
+                next_[last] = distinct;
+            }
+            distinct_of_[i] = distinct;
+        }
+    }
+
+    int count() const { return representatives_.size(); }
+
+    /** \return whether each particle is its own representative */
+    bool all_distinct() const
+    {
+        return representatives_.size() == distinct_of_.size();
+    }
+
+    /** \return the particle evaluated for the group \a distinct */
+    int representative(int distinct) const
+    {
+        return representatives_[distinct];
+    }
+
+    /** \return the group of particle \a particle */
+    int distinct_of(int particle) const { return distinct_of_[particle]; }
+
+private:
+    int add(int particle)
+    {
+        representatives_.push_back(particle);
+        next_.push_back(-1);
+        return representatives_.size() - 1;
+    }
+
+    template <typename State>
+    static std::uint64_t hash(const State& delta, int ancestor)
+    {
+        // FNV-1a
+        std::uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const void* data, std::size_t size)
+        {
+            const unsigned char* bytes =
+                static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                h = (h ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+
+        mix(&ancestor, sizeof(ancestor));
+        for (int i = 0; i < int(delta.size()); ++i)
+        {
+            const auto coefficient = delta(i);
+            mix(&coefficient, sizeof(coefficient));
+        }
+        return h;
+    }
+
+private:
+    std::vector<int> distinct_of_;
+    std::vector<int> representatives_;
+    std::vector<int> next_;
+    HashIndex groups_;
+};
+}
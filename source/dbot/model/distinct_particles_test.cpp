@@ -0,0 +1,56 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file distinct_particles_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/distinct_particles.hpp>
+
+using dbot::DistinctParticles;
+
+TEST(DistinctParticlesTests, copies_of_the_same_ancestor_are_merged)
+{
+    std::vector<Eigen::VectorXd> deltas(5, Eigen::VectorXd::Zero(6));
+    std::vector<int> ancestors = {0, 0, 1, 0, 0};
+    deltas[3](2) = 1e-3;
+
+    DistinctParticles distinct;
+    distinct.find(deltas, ancestors);
+
+    // equal deltas of distinct ancestors and distinct deltas of the same
+    // ancestor are evaluated separately
+    EXPECT_EQ(distinct.count(), 3);
+    EXPECT_FALSE(distinct.all_distinct());
+
+    EXPECT_EQ(distinct.distinct_of(0), distinct.distinct_of(1));
+    EXPECT_EQ(distinct.distinct_of(0), distinct.distinct_of(4));
+    EXPECT_NE(distinct.distinct_of(0), distinct.distinct_of(2));
+    EXPECT_NE(distinct.distinct_of(0), distinct.distinct_of(3));
+
+    for (int i = 0; i < int(deltas.size()); ++i)
+    {
+        const int j = distinct.representative(distinct.distinct_of(i));
+        EXPECT_LE(j, i);
+        EXPECT_EQ(ancestors[j], ancestors[i]);
+        EXPECT_TRUE(deltas[j] == deltas[i]);
+    }
+}
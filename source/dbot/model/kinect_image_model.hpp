@@ -28,8 +28,12 @@
 
 #pragma once
 
+#include <limits>
 #include <vector>
+#include <atomic>
 #include <memory>
+#include <algorithm>
+#include <unordered_map>
 
 #include <Eigen/Core>
 
@@ -39,9 +43,14 @@
 #include <osr/free_floating_rigid_bodies_state.hpp>
 #include <dbot/model/rao_blackwell_sensor.hpp>
 
+#include <dbot/thread_pool.hpp>
 #include <dbot/rigid_body_renderer.hpp>
 #include <dbot/model/kinect_pixel_model.hpp>
 #include <dbot/model/occlusion_model.hpp>
+#include <dbot/model/occlusion_map.hpp>
+#include <dbot/model/distinct_particles.hpp>
+#include <dbot/model/part_layer_cache.hpp>
+#include <dbot/model/depth_reuse.hpp>
 
 namespace dbot
 {
@@ -72,6 +81,11 @@ struct Traits<KinectImageModel<Scalar, State, OBJECTS>>
 /**
  * \class ImageSensorCPU
  *
+ * \tparam Scalar  Precision of the pixel model evaluation. float evaluates
+ *                 twice as many pixels per SIMD instruction, the rendered
+ *                 depths are single precision either way. The particle
+ *                 states and the log likelihoods stay in fl::Real.
+ *
  * \ingroup distributions
  * \ingroup sensors
  */
@@ -97,6 +111,11 @@ public:
     typedef typename Eigen::Transform<fl::Real, 3, Eigen::Affine> Affine;
 
     // TODO: DO WE NEED ALL OF THIS IN THE CONSTRUCTOR??
+    /**
+     * \param thread_count  Number of threads evaluating the particles in
+     *                      parallel. Zero selects the number of hardware
+     *                      threads.
+     */
     KinectImageModel(
         const Eigen::Matrix3d& camera_matrix,
         const size_t& n_rows,
@@ -105,7 +124,8 @@ public:
         const PixelSensorPtr sensor,
         const OcclusionModelPtr occlusion_transition,
         const float& initial_occlusion,
-        const double& delta_time)
+        const double& delta_time,
+        const int thread_count = 1)
         : camera_matrix_(camera_matrix),
           n_rows_(n_rows),
           n_cols_(n_cols),
@@ -113,6 +133,12 @@ public:
           object_model_(object_renderer),
           sensor_(sensor),
           occlusion_transition_(occlusion_transition),
+          thread_pool_(std::make_shared<ThreadPool>(thread_count)),
+          layer_level_(-1),
+          rendering_level_(-1),
+          occlusion_precision_(OcclusionPrecision::Single),
+          rejection_margin_(0),
+          best_loglike_(0),
           observation_time_(0),
           Base(delta_time)
     {
@@ -121,6 +147,13 @@ public:
         this->default_poses_.recount(object_model_->vertices().size());
         this->default_poses_.setZero();
 
+        // the pixel and the occlusion models are conditioned on each pixel
+        // and therefore each thread requires its own copy
+        for (int i = 0; i < thread_pool_->thread_count(); ++i)
+        {
+            scratch_.push_back(Scratch(*sensor_, *occlusion_transition_));
+        }
+
         reset();
     }
 
@@ -129,106 +162,131 @@ public:
                        IntArray& indices,
                        const bool& update = false)
     {
-        std::vector<std::vector<float>> new_occlusions(deltas.size());
-        std::vector<std::vector<double>> new_occlusion_times(deltas.size());
+        RealArray log_likes;
+        loglikes(deltas, indices, update, log_likes);
+        return log_likes;
+    }
+
+    /**
+     * \brief Evaluates the particles into \a log_likes. Once the particle
+     *        count and the silhouettes settle, a call allocates no memory.
+     */
+    void loglikes(const StateArray& deltas,
+                  IntArray& indices,
+                  const bool& update,
+                  RealArray& log_likes)
+    {
+        // holds the maps of the generation before the last update, which
+        // are overwritten without reallocating their tile tables
+        std::vector<OcclusionMap>& new_occlusions = new_occlusions_;
+        if (update) new_occlusions.resize(deltas.size());
+
+        log_likes.setZero(deltas.size());
+        best_loglike_ = -std::numeric_limits<fl::Real>::infinity();
 
-        RealArray log_likes = RealArray::Zero(deltas.size());
-        for (size_t i_state = 0; i_state < size_t(deltas.size()); i_state++)
+        select_level();
+
+        // copies of the same particle are rendered and evaluated once
+        distinct_.find(deltas, indices);
+
+        // the renderings of the ancestors are warped to the poses of their
+        // descendants, see depth_reuse()
+        const int part_count = this->default_poses_.count();
+        const bool layered = part_count > 1;
+        const bool reusing = depth_reuse_.enabled && !layered;
+        if (object_model_->level() != rendering_level_)
         {
-            if (update)
-            {
-                new_occlusions[i_state] = occlusions_[indices[i_state]];
-                new_occlusion_times[i_state] =
-                    occlusion_times_[indices[i_state]];
-            }
+            rendering_slots_.clear();
+            rendering_level_ = object_model_->level();
+        }
+        if (update && reusing) new_renderings_.resize(distinct_.count());
 
-            // render the object model -----------------------------------------
-            int body_count = deltas[i_state].count();
-            std::vector<Affine> poses(body_count);
-            for (size_t i_obj = 0; i_obj < body_count; i_obj++)
-            {
-                auto pose_0 = this->default_poses_.component(i_obj);
-                auto delta = deltas[i_state].component(i_obj);
+        // the parts of multi-part objects are rendered separately such that
+        // only the parts which moved since the last call are rendered again
+        if (layered)
+        {
+            ScopedStageTimer timer(this->instrumentation_.get(),
+                                   Stage::Render);
+            render_layers(deltas);
+        }
 
-                osr::PoseVector pose;
+        const bool recording =
+            this->instrumentation_ && this->instrumentation_->recording();
+        for (Scratch& scratch : scratch_)
+        {
+            scratch.timed = recording;
+            scratch.render_seconds = 0;
+            scratch.pixels_evaluated = 0;
+            scratch.renders_reused = 0;
+            scratch.reuse_validations = 0;
+            scratch.reuse_depth_error = 0;
+            scratch.reuse_coverage_error = 0;
+        }
 
-                /// \todo: this should be done through the the apply_delta
-                /// function
-                pose.position() = pose_0.orientation().rotation_matrix()
-                        * delta.position() + pose_0.position();
-                pose.orientation() = pose_0.orientation() * delta.orientation();
+        // particles are independent of each other given the occlusions of
+        // the previous update. Each one is evaluated by a single thread in
+        // the same order as in the sequential case which keeps the results
+        // identical for any thread count
+        thread_pool_->parallel_for(
+            distinct_.count(),
+            [&](int i_distinct, int thread_index)
+            {
+                const int i_state = distinct_.representative(i_distinct);
+                log_likes[i_state] = loglike(
+                    deltas[i_state],
+                    indices[i_state],
+                    update,
+                    scratch_[thread_index],
+                    update ? &new_occlusions[i_state] : nullptr,
+                    layered ? &part_layers_[i_distinct * part_count]
+                            : nullptr,
+                    reusing,
+                    update && reusing ? &new_renderings_[i_distinct]
+                                      : nullptr);
+            });
+
+        if (recording) report(distinct_.count());
+
+        // the copies share the result of their representative. Their
+        // occlusion maps share its tiles until one of them is written.
+        for (int i_state = 0; i_state < int(deltas.size()); i_state++)
+        {
+            const int representative =
+                distinct_.representative(distinct_.distinct_of(i_state));
+            if (representative == i_state) continue;
 
-                poses[i_obj] = pose.affine();
-            }
-            object_model_->set_poses(poses);
-            std::vector<int> intersect_indices;
-            std::vector<float> predictions;
-            object_model_->Render(camera_matrix_,
-                                  n_rows_,
-                                  n_cols_,
-                                  intersect_indices,
-                                  predictions);
-
-            // compute likelihoods ---------------------------------------------
-            for (size_t i = 0; i < size_t(predictions.size()); i++)
+            log_likes[i_state] = log_likes[representative];
+            if (update)
             {
-                if (isnan(observations_[intersect_indices[i]]))
-                {
-                    log_likes[i_state] += log(1.);
-                }
-                else
-                {
-                    double delta_time = observation_time_ -
-                                        occlusion_times_[indices[i_state]]
-                                                        [intersect_indices[i]];
-
-                    occlusion_transition_->Condition(
-                        delta_time,
-                        occlusions_[indices[i_state]][intersect_indices[i]]);
-
-                    float occlusion =
-                        occlusion_transition_->MapStandardGaussian();
-
-                    sensor_->Condition(predictions[i], false);
-                    float p_obsIpred_vis =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        (1.0 - occlusion);
-
-                    sensor_->Condition(predictions[i], true);
-                    float p_obsIpred_occl =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        occlusion;
-
-                    sensor_->Condition(
-                        std::numeric_limits<float>::infinity(), true);
-                    float p_obsIinf = sensor_->Probability(
-                        observations_[intersect_indices[i]]);
-
-                    log_likes[i_state] +=
-                        log((p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf);
-
-                    // we update the occlusion with the observations
-                    if (update)
-                    {
-                        new_occlusions[i_state][intersect_indices[i]] =
-                            p_obsIpred_occl /
-                            (p_obsIpred_vis + p_obsIpred_occl);
-                        new_occlusion_times[i_state][intersect_indices[i]] =
-                            observation_time_;
-                    }
-                }
+                new_occlusions[i_state] = new_occlusions[representative];
             }
         }
+
         if (update)
         {
-            occlusions_ = new_occlusions;
-            occlusion_times_ = new_occlusion_times;
+            occlusions_.swap(new_occlusions);
             for (size_t i_state = 0; i_state < indices.size(); i_state++)
                 indices[i_state] = i_state;
+
+            // the copies of a particle share the rendering of the
+            // representative
+            if (reusing)
+            {
+                rendering_slots_.resize(deltas.size());
+                for (size_t i_state = 0; i_state < deltas.size(); i_state++)
+                {
+                    rendering_slots_[i_state] = distinct_.distinct_of(i_state);
+                }
+                renderings_.swap(new_renderings_);
+            }
+            else
+            {
+                rendering_slots_.clear();
+            }
+
+            // the tiles of the dropped generation return to the pools
+            for (OcclusionMap& map : new_occlusions) map.clear_tiles();
         }
-        return log_likes;
     }
 
     void set_observation(const Observation& image)
@@ -236,38 +294,667 @@ public:
         assert(image.rows() == image.size());
         assert(image.cols() == 1);
 
-        std::vector<float> std_measurement(image.size());        
-
+        observation_buffer_.resize(image.size());
         for (int i = 0; i < image.size(); ++i)
         {
-            std_measurement[i] = image(i, 0);
+            observation_buffer_[i] = image(i, 0);
         }
 
-        set_observation(std_measurement, this->delta_time_);
+        set_observation(DepthImageView(
+            observation_buffer_.data(), int(n_rows_), int(n_cols_)));
+    }
+
+    /**
+     * \brief Evaluates the particles against the depths of the view without
+     *        copying them
+     *
+     * The terms of the pixel model which only depend on the observation
+     * are computed once here for all particles.
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        assert(image.size() == n_rows_ * n_cols_);
+
+        observation_ = image;
+        observation_time_ += this->delta_time_;
+        sensor_->observation_terms(
+            observation_.data(), observation_.size(), observation_terms_);
     }
 
     virtual void reset()
     {
         occlusions_.resize(1);
-        occlusions_[0] =
-            std::vector<float>(n_rows_ * n_cols_, initial_occlusion_);
-        occlusion_times_.resize(1);
-        occlusion_times_[0] = std::vector<double>(n_rows_ * n_cols_, 0);
+        occlusions_[0] = OcclusionMap(
+            n_rows_, n_cols_, initial_occlusion_, 0, occlusion_precision_);
         observation_time_ = 0;
+        rendering_slots_.clear();
+    }
+
+    /**
+     * \brief Writes the occlusion maps up to the largest of \a indices and
+     *        the observation time. Tiles shared by several maps are written
+     *        once.
+     */
+    void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        const int count =
+            indices.size() > 0
+                ? std::min<int>(indices.maxCoeff() + 1, occlusions_.size())
+                : 0;
+
+        snapshot.write<std::uint8_t>(this->OcclusionMaps);
+        snapshot.write(observation_time_);
+        snapshot.write<std::uint8_t>(std::uint8_t(occlusion_precision_));
+        snapshot.write<std::uint32_t>(n_rows_);
+        snapshot.write<std::uint32_t>(n_cols_);
+        snapshot.write<std::uint64_t>(count);
+
+        // each tile is a zero for the initial occlusion or the number of
+        // a tile, the tiles are numbered in the order they first appear
+        std::unordered_map<const OcclusionMap::Tile*, std::uint64_t> numbers;
+        for (int i = 0; i < count; ++i)
+        {
+            snapshot.write(occlusions_[i].initial_time());
+            for (const auto& tile : occlusions_[i].tiles())
+            {
+                if (!tile)
+                {
+                    snapshot.write<std::uint64_t>(0);
+                    continue;
+                }
+
+                auto number = numbers.emplace(tile.get(), numbers.size() + 1);
+                snapshot.write<std::uint64_t>(number.first->second);
+                if (number.second)
+                {
+                    snapshot.write(tile->time);
+                    snapshot.write_vector(tile->occlusions);
+                }
+            }
+        }
+    }
+
+    int restore(Snapshot::Reader& reader)
+    {
+        if (reader.read<std::uint8_t>() != this->OcclusionMaps)
+        {
+            throw InvalidSnapshotException(
+                "the snapshot holds no occlusion maps");
+        }
+        const double observation_time = reader.read<double>();
+        if (reader.read<std::uint8_t>() != std::uint8_t(occlusion_precision_))
+        {
+            throw InvalidSnapshotException(
+                "the occlusion precision does not match");
+        }
+        if (reader.read<std::uint32_t>() != std::uint32_t(n_rows_) ||
+            reader.read<std::uint32_t>() != std::uint32_t(n_cols_))
+        {
+            throw InvalidSnapshotException("the resolution does not match");
+        }
+        const std::uint64_t count = reader.read<std::uint64_t>();
+
+        std::vector<OcclusionMap> occlusions;
+        std::vector<std::shared_ptr<OcclusionMap::Tile>> tiles;
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            occlusions.push_back(OcclusionMap(n_rows_,
+                                              n_cols_,
+                                              initial_occlusion_,
+                                              reader.read<double>(),
+                                              occlusion_precision_));
+            OcclusionMap& map = occlusions.back();
+            const std::size_t tile_bytes =
+                OcclusionMap::TILE_PIXELS *
+                dbot::occlusion_bytes(occlusion_precision_);
+
+            for (int j = 0; j < int(map.tiles().size()); ++j)
+            {
+                const std::uint64_t number = reader.read<std::uint64_t>();
+                if (number == 0) continue;
+                if (number == tiles.size() + 1)
+                {
+                    const double time = reader.read<double>();
+                    tiles.push_back(
+                        std::make_shared<OcclusionMap::Tile>(tile_bytes, time));
+                    reader.read_vector(tiles.back()->occlusions);
+                    if (tiles.back()->occlusions.size() != tile_bytes)
+                    {
+                        throw InvalidSnapshotException(
+                            "the occlusion tile size does not match");
+                    }
+                }
+                else if (number > tiles.size())
+                {
+                    throw InvalidSnapshotException(
+                        "the occlusion tiles are out of order");
+                }
+                map.tile(j, tiles[number - 1]);
+            }
+        }
+
+        if (occlusions.empty())
+        {
+            reset();
+            return 0;
+        }
+
+        occlusions_.swap(occlusions);
+        observation_time_ = observation_time;
+        rendering_slots_.clear();
+        return int(occlusions_.size());
     }
 
     // TODO: TYPES
     const std::vector<float> Occlusions(size_t index) const
     {
-        return occlusions_[index];
+        return occlusions_[index].dense_occlusions();
     }
 
+    /**
+     * \brief Stops evaluating a particle once it is hopeless, i.e. once even
+     *        the largest possible log ratio on each of its remaining pixels
+     *        would leave it more than \a margin below the best particle
+     *        evaluated so far in the same call.
+     *
+     * A rejected particle receives this upper bound as its log likelihood,
+     * its weight relative to the best particle is thus overestimated and
+     * below exp(-margin). When updating, the occlusions of its remaining
+     * pixels are kept like those of pixels it does not cover.
+     *
+     * The pixels are evaluated in blocks, each of them sampling the whole
+     * silhouette, such that hopeless particles are recognized early. The
+     * non-rejected particles are evaluated exactly, which particles are
+     * rejected depends on the order in which the threads finish them. A
+     * margin of zero evaluates all pixels.
+     */
+    void rejection_margin(fl::Real margin) { rejection_margin_ = margin; }
+
+    fl::Real rejection_margin() const { return rejection_margin_; }
+
+    /**
+     * \brief Stores the occlusion probabilities of the particles in
+     *        \a precision, see OcclusionPrecision. The maps of the particles
+     *        are reset to the initial occlusion.
+     */
+    void occlusion_precision(OcclusionPrecision precision)
+    {
+        occlusion_precision_ = precision;
+        new_occlusions_.clear();
+        reset();
+    }
+
+    OcclusionPrecision occlusion_precision() const
+    {
+        return occlusion_precision_;
+    }
+
+    /**
+     * \brief Warps the rendering of the ancestor of a particle to the pose of
+     *        the particle instead of rendering it, if the two poses are
+     *        within the distance given by \a reuse.
+     *
+     * The warped rendering is stored with the pose it has been rendered at,
+     * hence a chain of descendants is warped from the same rendering until
+     * one of them leaves that distance and is rendered again. Only objects
+     * of a single part are warped, the parts of multi-part objects are
+     * reused exactly by their layer cache.
+     */
+    void depth_reuse(const DepthReuse& reuse)
+    {
+        depth_reuse_ = reuse;
+        rendering_slots_.clear();
+    }
+
+    const DepthReuse& depth_reuse() const { return depth_reuse_; }
+
 private:
+    /**
+     * \brief Selects the level of detail of the renderer by the projected
+     *        size of the object at the default poses, such that all particles
+     *        are evaluated against the same mesh
+     */
+    void select_level()
+    {
+        if (object_model_->count_levels() == 1) return;
+
+        std::vector<Eigen::Vector3d>& positions = level_positions_;
+        positions.resize(this->default_poses_.count());
+        for (size_t i_obj = 0; i_obj < positions.size(); i_obj++)
+        {
+            positions[i_obj] = this->default_poses_.component(i_obj).position();
+        }
+
+        object_model_->select_level(positions, camera_matrix_);
+    }
+
+    /**
+     * \brief Finds the depth layers of the parts of all distinct particles
+     *        in part_layers_ and renders those which are not cached
+     */
+    void render_layers(const StateArray& deltas)
+    {
+        if (object_model_->level() != layer_level_)
+        {
+            layers_.clear();
+            layer_level_ = object_model_->level();
+        }
+        layers_.next_generation();
+
+        const int part_count = this->default_poses_.count();
+        part_layers_.resize(distinct_.count() * part_count);
+        missing_layers_.clear();
+
+        Scratch& scratch = scratch_[0];
+        for (int i_distinct = 0; i_distinct < distinct_.count(); i_distinct++)
+        {
+            compose_poses(deltas[distinct_.representative(i_distinct)],
+                          scratch.rotations,
+                          scratch.translations);
+
+            for (int i_obj = 0; i_obj < part_count; i_obj++)
+            {
+                bool missing;
+                const int layer = layers_.find(i_obj,
+                                               scratch.rotations[i_obj],
+                                               scratch.translations[i_obj],
+                                               missing);
+                part_layers_[i_distinct * part_count + i_obj] = layer;
+                if (missing) missing_layers_.push_back(layer);
+            }
+        }
+
+        thread_pool_->parallel_for(
+            missing_layers_.size(),
+            [&](int i, int thread_index)
+            {
+                PartLayerCache::Layer& layer =
+                    layers_.layer(missing_layers_[i]);
+                Scratch& scratch = scratch_[thread_index];
+
+                // only the pose of the rendered part is read
+                scratch.rotations.resize(part_count);
+                scratch.translations.resize(part_count);
+                scratch.rotations[layer.part] = layer.rotation;
+                scratch.translations[layer.part] = layer.translation;
+
+                object_model_->Render(layer.part,
+                                      scratch.rotations,
+                                      scratch.translations,
+                                      camera_matrix_,
+                                      n_rows_,
+                                      n_cols_,
+                                      layer.intersect_indices,
+                                      layer.depth,
+                                      scratch.render_buffer);
+            });
+    }
+
+    /**
+     * \brief Reports the rendering time and the evaluated pixels of the
+     *        threads of the last parallel evaluation of \a count particles.
+     *        The threads render concurrently, hence the wall time of
+     *        rendering is estimated as the rendering time per thread.
+     */
+    void report(int count)
+    {
+        double render_seconds = 0;
+        std::uint64_t pixels = 0;
+        std::uint64_t reused = 0;
+        std::uint64_t validations = 0;
+        double depth_error = 0;
+        double coverage_error = 0;
+        for (const Scratch& scratch : scratch_)
+        {
+            render_seconds += scratch.render_seconds;
+            pixels += scratch.pixels_evaluated;
+            reused += scratch.renders_reused;
+            validations += scratch.reuse_validations;
+            depth_error += scratch.reuse_depth_error;
+            coverage_error += scratch.reuse_coverage_error;
+        }
+
+        const int threads =
+            std::max(1, std::min(count, thread_pool_->thread_count()));
+        this->instrumentation_->add_seconds(Stage::Render,
+                                            render_seconds / threads);
+        this->instrumentation_->add_pixels(pixels);
+        this->instrumentation_->add_reused_renders(reused);
+        this->instrumentation_->add_reuse_validations(
+            validations, depth_error, coverage_error);
+    }
+
+    /**
+     * \brief Composes the default poses with \a delta into the poses of the
+     *        parts in the camera frame
+     */
+    void compose_poses(const State& delta,
+                       std::vector<Eigen::Matrix3d>& rotations,
+                       std::vector<Eigen::Vector3d>& translations) const
+    {
+        int body_count = delta.count();
+        rotations.resize(body_count);
+        translations.resize(body_count);
+        for (size_t i_obj = 0; i_obj < body_count; i_obj++)
+        {
+            auto pose_0 = this->default_poses_.component(i_obj);
+            auto delta_i = delta.component(i_obj);
+
+            osr::PoseVector pose;
+
+            /// \todo: this should be done through the the apply_delta
+            /// function
+            pose.position() = pose_0.orientation().rotation_matrix() *
+                                  delta_i.position() +
+                              pose_0.position();
+            pose.orientation() = pose_0.orientation() * delta_i.orientation();
+
+            Affine affine = pose.affine();
+            rotations[i_obj] = affine.rotation();
+            translations[i_obj] = affine.translation();
+        }
+    }
+
+    /**
+     * \brief Per-thread buffers and model copies used while evaluating a
+     *        single particle
+     */
+    struct Scratch
+    {
+        Scratch(const KinectPixelModel& sensor,
+                const OcclusionModel& occlusion_transition)
+            : sensor(sensor), occlusion_transition(occlusion_transition)
+        {
+        }
+
+        KinectPixelModel sensor;
+        OcclusionModel occlusion_transition;
+        std::vector<Eigen::Matrix3d> rotations;
+        std::vector<Eigen::Vector3d> translations;
+        std::vector<int> intersect_indices;
+        std::vector<float> predictions;
+        RigidBodyRenderer::Buffer render_buffer;
+
+        // intermediate results of compositing the part layers
+        std::vector<int> composite_indices;
+        std::vector<float> composite_depth;
+
+        // valid pixels passed to the batch pixel model
+        std::vector<int> pixels;
+        std::vector<float> valid_predictions;
+        std::vector<float> valid_observations;
+        std::vector<float> valid_sigmas;
+        std::vector<float> valid_log_p_infinities;
+        std::vector<float> occlusions;
+
+        // tiles of the updated occlusion maps
+        OcclusionMap::TilePool tiles;
+
+        // warping the renderings of the ancestors, the validation renders
+        // are counted across calls
+        DepthWarp::Buffer warp_buffer;
+        std::vector<int> exact_indices;
+        std::vector<float> exact_depth;
+        std::uint64_t reuse_count = 0;
+
+        // instrumentation of the current loglikes() call
+        bool timed = false;
+        double render_seconds = 0;
+        std::uint64_t pixels_evaluated = 0;
+        std::uint64_t renders_reused = 0;
+        std::uint64_t reuse_validations = 0;
+        double reuse_depth_error = 0;
+        double reuse_coverage_error = 0;
+    };
+
+    /**
+     * \brief Evaluates the log likelihood of a single particle. When
+     *        \a update is set, the updated occlusions of the particle are
+     *        written into \a new_occlusions which starts off as a shallow
+     *        copy of the ancestor map. If \a part_layers is given, the
+     *        particle is composited from these layers of layers_ instead of
+     *        being rendered. If \a reusing, the rendering of the ancestor
+     *        may be warped instead, see depth_reuse(), and the rendering of
+     *        the particle is stored in \a new_rendering when updating.
+     */
+    fl::Real loglike(const State& delta,
+                   const int ancestor,
+                   const bool update,
+                   Scratch& scratch,
+                   OcclusionMap* new_occlusions,
+                   const int* part_layers,
+                   const bool reusing,
+                   DepthWarp::Rendering* new_rendering) const
+    {
+        const OcclusionMap& occlusions = occlusions_[ancestor];
+
+        if (update)
+        {
+            *new_occlusions = occlusions;
+        }
+
+        // render the object model -----------------------------------------
+        std::vector<int>& intersect_indices = scratch.intersect_indices;
+        std::vector<float>& predictions = scratch.predictions;
+        if (part_layers)
+        {
+            layers_.composite(part_layers,
+                              delta.count(),
+                              intersect_indices,
+                              predictions,
+                              scratch.composite_indices,
+                              scratch.composite_depth);
+        }
+        else
+        {
+            Instrumentation::Clock::time_point start;
+            if (scratch.timed) start = Instrumentation::Clock::now();
+            compose_poses(delta, scratch.rotations, scratch.translations);
+
+            const DepthWarp::Rendering* source =
+                reusing ? reusable_rendering(ancestor, scratch) : nullptr;
+            bool validate = false;
+            if (source)
+            {
+                DepthWarp::warp(*source,
+                                scratch.rotations[0],
+                                scratch.translations[0],
+                                camera_matrix_,
+                                n_rows_,
+                                n_cols_,
+                                intersect_indices,
+                                predictions,
+                                scratch.warp_buffer);
+                scratch.renders_reused++;
+                scratch.reuse_count++;
+
+                const int interval = depth_reuse_.validation_interval;
+                validate =
+                    interval > 0 && scratch.reuse_count % interval == 0;
+            }
+
+            // a validated particle is evaluated with the warped depths
+            std::vector<int>& rendered_indices =
+                validate ? scratch.exact_indices : intersect_indices;
+            std::vector<float>& rendered_depth =
+                validate ? scratch.exact_depth : predictions;
+            if (!source || validate)
+            {
+                object_model_->Render(scratch.rotations,
+                                      scratch.translations,
+                                      camera_matrix_,
+                                      n_rows_,
+                                      n_cols_,
+                                      rendered_indices,
+                                      rendered_depth,
+                                      scratch.render_buffer);
+            }
+
+            if (validate)
+            {
+                double depth_error, coverage_error;
+                DepthWarp::compare(intersect_indices,
+                                   predictions,
+                                   rendered_indices,
+                                   rendered_depth,
+                                   depth_error,
+                                   coverage_error);
+                scratch.reuse_validations++;
+                scratch.reuse_depth_error += depth_error;
+                scratch.reuse_coverage_error += coverage_error;
+            }
+
+            // warped renderings are passed on unchanged such that the
+            // warping errors do not accumulate over the frames
+            if (new_rendering && source && !validate)
+            {
+                *new_rendering = *source;
+            }
+            else if (new_rendering)
+            {
+                new_rendering->valid = true;
+                new_rendering->rotation = scratch.rotations[0];
+                new_rendering->translation = scratch.translations[0];
+                new_rendering->intersect_indices = rendered_indices;
+                new_rendering->depth = rendered_depth;
+            }
+
+            if (scratch.timed)
+            {
+                scratch.render_seconds += Instrumentation::seconds_since(start);
+            }
+        }
+
+        // gather the valid pixels and their predicted occlusions ---------
+        OcclusionModel& occlusion_transition = scratch.occlusion_transition;
+
+        scratch.pixels.clear();
+        scratch.valid_predictions.clear();
+        scratch.valid_observations.clear();
+        scratch.valid_sigmas.clear();
+        scratch.valid_log_p_infinities.clear();
+        scratch.occlusions.clear();
+
+        // a bounded evaluation visits every stride-th pixel first
+        const bool bounded = rejection_margin_ > 0;
+        const int size = predictions.size();
+        const int stride = bounded ? int(rejection_stride) : 1;
+        float min_prediction = std::numeric_limits<float>::infinity();
+        for (int phase = 0; phase < stride; phase++)
+        {
+            for (int i = phase; i < size; i += stride)
+            {
+                const int pixel = intersect_indices[i];
+                if (!observation_terms_.valid[pixel]) continue;
+
+                const OcclusionModel::Transition& transition =
+                    occlusion_transition.transition(observation_time_ -
+                                                    occlusions.time(pixel));
+
+                scratch.pixels.push_back(pixel);
+                scratch.valid_predictions.push_back(predictions[i]);
+                scratch.valid_observations.push_back(observation_(pixel));
+                scratch.valid_sigmas.push_back(observation_terms_.sigma[pixel]);
+                scratch.valid_log_p_infinities.push_back(
+                    observation_terms_.log_p_infinity[pixel]);
+                scratch.occlusions.push_back(
+                    transition(occlusions.occlusion(pixel)));
+                min_prediction = std::min(min_prediction, predictions[i]);
+            }
+        }
+
+        // compute likelihoods ---------------------------------------------
+        const int count = scratch.pixels.size();
+        const int block = bounded ? int(rejection_block) : count;
+        const fl::Real max_ratio =
+            bounded ? scratch.sensor.max_log_likelihood_ratio(min_prediction)
+                    : 0;
+
+        fl::Real log_like = 0;
+        int evaluated = 0;
+        bool rejected = false;
+        while (evaluated < count && !rejected)
+        {
+            const int block_size = std::min(block, count - evaluated);
+            log_like += scratch.sensor.template log_likelihood_ratio<Scalar>(
+                scratch.valid_predictions.data() + evaluated,
+                scratch.valid_observations.data() + evaluated,
+                scratch.valid_sigmas.data() + evaluated,
+                scratch.valid_log_p_infinities.data() + evaluated,
+                scratch.occlusions.data() + evaluated,
+                block_size,
+                update ? scratch.occlusions.data() + evaluated : nullptr);
+            evaluated += block_size;
+
+            if (bounded && evaluated < count)
+            {
+                const fl::Real bound =
+                    log_like + (count - evaluated) * max_ratio;
+                if (bound < best_loglike_ - rejection_margin_)
+                {
+                    log_like = bound;
+                    rejected = true;
+                }
+            }
+        }
+        scratch.pixels_evaluated += evaluated;
+
+        if (bounded && !rejected)
+        {
+            fl::Real best = best_loglike_;
+            while (log_like > best &&
+                   !best_loglike_.compare_exchange_weak(best, log_like))
+            {
+            }
+        }
+
+        // we update the occlusion with the observations
+        if (update)
+        {
+            for (int i = 0; i < evaluated; i++)
+            {
+                const int pixel = scratch.pixels[i];
+                new_occlusions->set(
+                    pixel,
+                    scratch.occlusions[i],
+                    observation_time_,
+                    occlusion_transition.transition(
+                        observation_time_ - new_occlusions->time(pixel)),
+                    &scratch.tiles);
+            }
+        }
+
+        return log_like;
+    }
+
+    /**
+     * \return the rendering of the ancestor if the pose of the particle in
+     *         \a scratch is close enough to warp it, nullptr otherwise
+     */
+    const DepthWarp::Rendering* reusable_rendering(const int ancestor,
+                                                   const Scratch& scratch) const
+    {
+        if (ancestor >= int(rendering_slots_.size())) return nullptr;
+
+        const DepthWarp::Rendering& rendering =
+            renderings_[rendering_slots_[ancestor]];
+        return DepthWarp::close(rendering,
+                                scratch.rotations[0],
+                                scratch.translations[0],
+                                depth_reuse_)
+                   ? &rendering
+                   : nullptr;
+    }
+
     void set_observation(const std::vector<float>& observations,
                          const Scalar& delta_time)
     {
-        observations_ = observations;
+        observation_buffer_ = observations;
+        observation_ = DepthImageView(
+            observation_buffer_.data(), int(n_rows_), int(n_cols_));
         observation_time_ += delta_time;
+        sensor_->observation_terms(
+            observation_.data(), observation_.size(), observation_terms_);
     }
 
     // TODO: WE PROBABLY DONT NEED ALL OF THIS
@@ -282,12 +969,48 @@ private:
     PixelSensorPtr sensor_;
     OcclusionModelPtr occlusion_transition_;
 
-    // occlusion parameters
-    std::vector<std::vector<float>> occlusions_;
-    std::vector<std::vector<double>> occlusion_times_;
-
-    // observed data
-    std::vector<float> observations_;
+    // parallel evaluation
+    std::shared_ptr<ThreadPool> thread_pool_;
+    std::vector<Scratch> scratch_;
+    DistinctParticles distinct_;
+
+    // depth layers of the parts and the layers of each distinct particle
+    // [distinct_nr * part_count + part_nr] of the current call
+    PartLayerCache layers_;
+    int layer_level_;
+    std::vector<int> part_layers_;
+    std::vector<int> missing_layers_;
+
+    // renderings of the distinct particles of the last update and the
+    // rendering of each particle, see depth_reuse()
+    DepthReuse depth_reuse_;
+    int rendering_level_;
+    std::vector<DepthWarp::Rendering> renderings_;
+    std::vector<DepthWarp::Rendering> new_renderings_;
+    std::vector<int> rendering_slots_;
+
+    // occlusion probabilities and update times of each particle
+    std::vector<OcclusionMap> occlusions_;
+    std::vector<OcclusionMap> new_occlusions_;
+    OcclusionPrecision occlusion_precision_;
+
+    // buffer of select_level()
+    std::vector<Eigen::Vector3d> level_positions_;
+
+    // bounded evaluation, see rejection_margin(). The best log likelihood
+    // of the current call is shared by the threads.
+    enum : int
+    {
+        rejection_block = 512,
+        rejection_stride = 16
+    };
+    fl::Real rejection_margin_;
+    mutable std::atomic<fl::Real> best_loglike_;
+
+    // observed data, the buffer holds observations converted to float
+    DepthImageView observation_;
+    std::vector<float> observation_buffer_;
+    KinectPixelModel::ObservationTerms observation_terms_;
     double observation_time_;
 };
 }
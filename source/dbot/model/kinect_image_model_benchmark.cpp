@@ -0,0 +1,115 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+#include <dbot/model/kinect_image_model.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+
+/**
+ * \brief Evaluates jittered particles of a synthetic scene without updating
+ *        the occlusions, with the pixel model evaluated in \a Scalar.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, number of
+ * particles, latitude bands of each sphere, number of parts, rejection
+ * margin, see KinectImageModel::rejection_margin()
+ */
+template <typename Scalar>
+static void BM_KinectImageModel_Loglikes(benchmark::State& state)
+{
+    typedef dbot::KinectImageModel<Scalar, State> Sensor;
+
+    const int downsampling = state.range(0);
+    const int particle_count = state.range(1);
+    const int rings = state.range(2);
+    const int part_count = state.range(3);
+    const int margin = state.range(4);
+
+    auto loader =
+        std::make_shared<dbot::SyntheticObjectLoader>(part_count, rings);
+    dbot::ObjectModel object_model(loader, false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(part_count);
+    dbot::SyntheticCameraDataProvider camera(
+        downsampling, object_model, poses);
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    Sensor sensor(camera.camera_matrix(),
+                  n_rows,
+                  n_cols,
+                  std::make_shared<dbot::RigidBodyRenderer>(
+                      object_model.flat_mesh()),
+                  std::make_shared<dbot::KinectPixelModel>(),
+                  std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                  0.1,
+                  0.033);
+    sensor.rejection_margin(margin);
+    for (int part = 0; part < part_count; ++part)
+    {
+        sensor.integrated_poses().component(part).affine(poses[part]);
+    }
+    sensor.set_observation(camera.depth_image_view());
+
+    std::mt19937 generator(0);
+    std::normal_distribution<double> noise(0., 0.005);
+    typename Sensor::StateArray deltas(particle_count);
+    for (int i = 0; i < particle_count; ++i)
+    {
+        deltas[i].recount(part_count);
+        deltas[i].setZero();
+        for (int part = 0; part < part_count; ++part)
+        {
+            deltas[i].component(part).position() = Eigen::Vector3d(
+                noise(generator), noise(generator), noise(generator));
+        }
+    }
+    typename Sensor::IntArray indices =
+        Sensor::IntArray::Zero(particle_count);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sensor.loglikes(deltas, indices, false));
+    }
+
+    state.SetItemsProcessed(state.iterations() * particle_count);
+}
+
+BENCHMARK_TEMPLATE(BM_KinectImageModel_Loglikes, double)
+    ->ArgNames({"downsampling", "particles", "rings", "parts", "margin"})
+    ->Args({2, 200, 16, 1, 0})
+    ->Args({2, 200, 64, 1, 0})
+    ->Args({4, 200, 16, 1, 0})
+    ->Args({4, 1000, 16, 1, 0})
+    ->Args({4, 200, 16, 4, 0})
+    ->Args({2, 200, 16, 1, 20})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_KinectImageModel_Loglikes, float)
+    ->ArgNames({"downsampling", "particles", "rings", "parts", "margin"})
+    ->Args({2, 200, 16, 1, 0})
+    ->Args({4, 1000, 16, 1, 0})
+    ->Unit(benchmark::kMillisecond);
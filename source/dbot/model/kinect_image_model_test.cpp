@@ -0,0 +1,133 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+#include <dbot/model/kinect_image_model.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Sensor;
+
+/**
+ * \brief Log likelihoods and occlusions of a few updating frames of jittered,
+ *        resampled particles evaluated with \a thread_count threads
+ */
+static void evaluate(int part_count,
+                     int thread_count,
+                     std::vector<Sensor::RealArray>& log_likes,
+                     std::vector<std::vector<float>>& occlusions)
+{
+    const int downsampling = 8;
+    const int particle_count = 40;
+
+    auto loader = std::make_shared<dbot::SyntheticObjectLoader>(part_count, 8);
+    dbot::ObjectModel object_model(loader, false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(part_count);
+    dbot::SyntheticCameraDataProvider camera(
+        downsampling, object_model, poses);
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    Sensor sensor(camera.camera_matrix(),
+                  n_rows,
+                  n_cols,
+                  std::make_shared<dbot::RigidBodyRenderer>(
+                      object_model.flat_mesh()),
+                  std::make_shared<dbot::KinectPixelModel>(),
+                  std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                  0.1,
+                  0.033,
+                  thread_count);
+    for (int part = 0; part < part_count; ++part)
+    {
+        sensor.integrated_poses().component(part).affine(poses[part]);
+    }
+
+    std::mt19937 generator(0);
+    std::normal_distribution<double> noise(0., 0.005);
+    Sensor::StateArray deltas(particle_count);
+    Sensor::IntArray indices = Sensor::IntArray::Zero(particle_count);
+
+    log_likes.clear();
+    occlusions.clear();
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        for (int i = 0; i < particle_count; ++i)
+        {
+            deltas[i].recount(part_count);
+            deltas[i].setZero();
+            for (int part = 0; part < part_count; ++part)
+            {
+                deltas[i].component(part).position() = Eigen::Vector3d(
+                    noise(generator), noise(generator), noise(generator));
+            }
+        }
+
+        sensor.set_observation(camera.depth_image_view());
+        log_likes.push_back(sensor.loglikes(deltas, indices, true));
+        for (int i = 0; i < particle_count; ++i)
+        {
+            occlusions.push_back(sensor.Occlusions(i));
+        }
+
+        // resampled ancestors, some of them shared
+        for (int i = 0; i < particle_count; ++i)
+        {
+            indices[i] = (i * 7 + frame) % particle_count / 2;
+        }
+    }
+}
+
+TEST(KinectImageModelTests, results_do_not_depend_on_the_thread_count)
+{
+    for (int part_count : {1, 2})
+    {
+        std::vector<Sensor::RealArray> serial_log_likes, parallel_log_likes;
+        std::vector<std::vector<float>> serial_occlusions,
+            parallel_occlusions;
+        evaluate(part_count, 1, serial_log_likes, serial_occlusions);
+        evaluate(part_count, 4, parallel_log_likes, parallel_occlusions);
+
+        ASSERT_EQ(serial_log_likes.size(), parallel_log_likes.size());
+        for (size_t frame = 0; frame < serial_log_likes.size(); ++frame)
+        {
+            const auto& serial = serial_log_likes[frame];
+            const auto& parallel = parallel_log_likes[frame];
+            ASSERT_EQ(serial.size(), parallel.size());
+            for (int i = 0; i < serial.size(); ++i)
+            {
+                // bit for bit
+                EXPECT_EQ(serial[i], parallel[i]) << "particle " << i;
+            }
+
+            // the particles are distinguishable
+            EXPECT_NE(serial.maxCoeff(), serial.minCoeff());
+        }
+
+        EXPECT_EQ(serial_occlusions, parallel_occlusions);
+    }
+}
@@ -29,9 +29,16 @@
 #pragma once
 
 #include <cmath>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <exception>
 #include <Eigen/Dense>
 #include <iostream>
 
+#include <dbot/model/kinect_pixel_table.hpp>
+
 namespace dbot
 {
 // Forward declarations
@@ -51,6 +58,19 @@ struct Traits<KinectPixelModel>
 };
 }
 
+/**
+ * \brief Represents an exception thrown if the tabulated approximation of the
+ *        pixel model cannot meet the requested error bound
+ */
+class UnreachableApproximationErrorException : public std::exception
+{
+    const char* what() const noexcept
+    {
+        return "The requested approximation error of the Kinect pixel model "
+               "cannot be reached with single precision tables.";
+    }
+};
+
 /**
  * \class KinectSensor
  *
@@ -65,6 +85,34 @@ public:
     typedef typename internal::Traits<KinectPixelModel>::Observation
         Observation;
 
+    /**
+     * \brief Tabulated likelihood ratios, see KinectPixelTable
+     */
+    struct Approximation
+    {
+        KinectPixelTable table;
+        std::vector<float> data;
+
+        /// estimated bound of the deviation of a per-pixel log ratio from
+        /// the exact model
+        Scalar max_error;
+    };
+
+    /**
+     * \brief Terms of the batch kernel which only depend on the observed
+     *        depths, computed once per image by observation_terms()
+     */
+    struct ObservationTerms
+    {
+        /// 1 for the valid depths, 0 for the missing ones whose other
+        /// terms are undefined
+        std::vector<std::uint8_t> valid;
+        /// standard deviation of the visible depth distribution
+        std::vector<float> sigma;
+        /// \f$\log p(y|\infty)\f$
+        std::vector<float> log_p_infinity;
+    };
+
     KinectPixelModel(Scalar tail_weight = 0.01,
                                 Scalar model_sigma = 0.003,
                                 Scalar sigma_factor = 0.00142478,
@@ -137,10 +185,590 @@ public:
         occlusion_ = occlusion;
     }
 
+    /**
+     * \brief Evaluates \a count pixels at once and returns the sum of the
+     *        per-pixel log ratios
+     *
+     * \f$ \log \frac{p(y|\hat y, visible)(1-o) + p(y|\hat y, occluded)o}
+     *                  {p(y|\infty)} \f$
+     *
+     * where the observations \f$y\f$ must be valid depths. If
+     * \a posterior_occlusions is given, the occlusion probabilities
+     * conditioned on the observations are written into it. It may alias
+     * \a occlusions.
+     *
+     * The pixels are processed in fixed size chunks which Eigen evaluates
+     * with SIMD instructions. Instead of erf, the kernel uses the rational
+     * approximation of Abramowitz and Stegun (7.1.26) of its complement with
+     * an absolute error below 1.5e-7.
+     *
+     * The kernel computes in \a Real, single precision evaluates twice as
+     * many pixels per instruction. The sums of the chunks are accumulated
+     * in double precision either way.
+     *
+     * If an approximation has been set up, the likelihood ratios are looked
+     * up instead, see approximate().
+     */
+    template <typename Real = Scalar>
+    Scalar log_likelihood_ratio(const float* predictions,
+                                const float* observations,
+                                const float* occlusions,
+                                const int count,
+                                float* posterior_occlusions = nullptr) const
+    {
+        return batch_log_likelihood_ratio<Real>(predictions,
+                                                observations,
+                                                nullptr,
+                                                nullptr,
+                                                occlusions,
+                                                count,
+                                                posterior_occlusions);
+    }
+
+    /**
+     * \brief Same as log_likelihood_ratio() given the \a sigmas and the
+     *        \a log_p_infinities of the observations from their
+     *        ObservationTerms, which saves an exponential per pixel
+     */
+    template <typename Real = Scalar>
+    Scalar log_likelihood_ratio(const float* predictions,
+                                const float* observations,
+                                const float* sigmas,
+                                const float* log_p_infinities,
+                                const float* occlusions,
+                                const int count,
+                                float* posterior_occlusions = nullptr) const
+    {
+        return batch_log_likelihood_ratio<Real>(predictions,
+                                                observations,
+                                                sigmas,
+                                                log_p_infinities,
+                                                occlusions,
+                                                count,
+                                                posterior_occlusions);
+    }
+
+    /**
+     * \brief Computes the ObservationTerms of \a count observed depths,
+     *        where NaN marks a missing depth
+     */
+    void observation_terms(const float* observations,
+                           const int count,
+                           ObservationTerms& terms) const
+    {
+        typedef Eigen::Map<const Eigen::ArrayXf> ConstMap;
+
+        terms.valid.resize(count);
+        terms.sigma.resize(count);
+        terms.log_p_infinity.resize(count);
+
+        const ConstMap y(observations, count);
+        Eigen::Map<Eigen::ArrayXf> sigma(terms.sigma.data(), count);
+        Eigen::Map<Eigen::ArrayXf> log_p_infinity(terms.log_p_infinity.data(),
+                                                  count);
+
+        sigma = (model_sigma_ + sigma_factor_ * y.cast<Scalar>().square())
+                    .template cast<float>();
+        log_p_infinity =
+            (tail_weight_ / max_depth_ +
+             (1 - tail_weight_) * lambda_ *
+                 (0.5 * lambda_ *
+                  (lambda_ * sigma.cast<Scalar>().square() -
+                   2 * y.cast<Scalar>()))
+                     .exp())
+                .log()
+                .template cast<float>();
+
+        for (int i = 0; i < count; ++i)
+        {
+            terms.valid[i] = !std::isnan(observations[i]);
+        }
+    }
+
+    /**
+     * \brief Upper bound of the per-pixel log ratios of
+     *        log_likelihood_ratio() for predictions of at least
+     *        \a min_prediction and any observation or occlusion
+     *
+     * The likelihood at infinity is at least the tail. The visible density
+     * is at most the one of the narrowest Gaussian, the occluded one at most
+     * the one of the truncated exponential at zero depth
+     * \f$\lambda / (1 - e^{-\lambda \hat y})  \le 1 / \hat y + \lambda\f$.
+     * The error of an approximation is added.
+     */
+    Scalar max_log_likelihood_ratio(Scalar min_prediction) const
+    {
+        const Scalar tail = tail_weight_ / max_depth_;
+        const Scalar body = 1 - tail_weight_;
+
+        const Scalar visible = 1 / (std::sqrt(2 * M_PI) * model_sigma_);
+        const Scalar occluded =
+            1 / std::max(min_prediction, Scalar(1e-6)) + lambda_;
+
+        Scalar bound =
+            std::log((tail + body * std::max(visible, occluded)) / tail);
+        if (approximation_) bound += approximation_->max_error;
+
+        return bound;
+    }
+
+    /**
+     * \brief Replaces the transcendental functions of the batch kernel by
+     *        lookup tables of the likelihood ratios
+     *
+     * Each factor of KinectPixelTable is sampled finely enough for its
+     * relative interpolation error at the cell midpoints to stay within a
+     * share of \a max_error. Combined with the cut off tails this bounds the
+     * absolute error of the per-pixel log ratio terms by \a max_error for any
+     * occlusion probability, since each term is a log of a convex combination
+     * of the two ratios. Observations or predictions outside of
+     * [\a min_depth, max_depth] are evaluated exactly.
+     *
+     * A \a max_error of zero switches back to the exact kernel.
+     *
+     * \throws UnreachableApproximationErrorException
+     */
+    void approximate(Scalar max_error, Scalar min_depth = 0.2)
+    {
+        approximation_.reset();
+        if (max_error <= 0) return;
+
+        approximation_ = tabulate(max_error, min_depth);
+    }
+
+    /**
+     * \return The current approximation or null if the model is evaluated
+     *         exactly. Copies of the model share the tables.
+     */
+    const std::shared_ptr<const Approximation>& approximation() const
+    {
+        return approximation_;
+    }
+
+private:
+    enum : int
+    {
+        max_table_cells = 1 << 16
+    };
+
+    /**
+     * \brief Kernel of log_likelihood_ratio(), which computes the
+     *        observation terms itself if \a sigmas is null
+     */
+    template <typename Real>
+    Scalar batch_log_likelihood_ratio(const float* predictions,
+                                      const float* observations,
+                                      const float* sigmas,
+                                      const float* log_p_infinities,
+                                      const float* occlusions,
+                                      const int count,
+                                      float* posterior_occlusions) const
+    {
+        if (approximation_)
+        {
+            return approximate_log_likelihood_ratio(predictions,
+                                                    observations,
+                                                    occlusions,
+                                                    count,
+                                                    posterior_occlusions);
+        }
+
+        typedef ChunkOf<Real> Chunk;
+        typedef Eigen::Map<const Eigen::ArrayXf> ConstMap;
+
+        const Real tail = tail_weight_ / max_depth_;
+        const Real body = 1 - tail_weight_;
+        const Real lambda = lambda_;
+        const Real model_sigma = model_sigma_;
+        const Real sigma_factor = sigma_factor_;
+        const Real sqrt_2_pi = std::sqrt(2 * M_PI);
+        const Real sqrt_2 = std::sqrt(2.);
+
+        Scalar log_likelihood = 0;
+        for (int begin = 0; begin < count; begin += 64)
+        {
+            const int size = std::min(64, count - begin);
+
+            const Chunk y = ConstMap(observations + begin, size).cast<Real>();
+            const Chunk y_hat =
+                ConstMap(predictions + begin, size).cast<Real>();
+            const Chunk o = ConstMap(occlusions + begin, size).cast<Real>();
+
+            const Chunk sigma =
+                sigmas ? Chunk(ConstMap(sigmas + begin, size).cast<Real>())
+                       : Chunk(model_sigma + sigma_factor * y.square());
+            const Chunk lambda_var = lambda * sigma.square();
+            const Chunk diff = y_hat - y;
+
+            const Chunk p_visible =
+                tail +
+                body * (-diff.square() / (2 * sigma.square())).exp() /
+                    (sqrt_2_pi * sigma);
+
+            const Chunk p_occluded =
+                tail +
+                body * lambda *
+                    (Real(0.5) * lambda * (2 * diff + lambda_var)).exp() *
+                    one_plus_erf<Real>((diff + lambda_var) / (sqrt_2 * sigma)) /
+                    (2 * ((lambda * y_hat).exp() - 1));
+
+            const Chunk visible = p_visible * (1 - o);
+            const Chunk occluded = p_occluded * o;
+
+            if (log_p_infinities)
+            {
+                log_likelihood +=
+                    (visible + occluded).log().sum() -
+                    ConstMap(log_p_infinities + begin, size)
+                        .template cast<Scalar>()
+                        .sum();
+            }
+            else
+            {
+                const Chunk p_infinity =
+                    tail +
+                    body * lambda *
+                        (Real(0.5) * lambda * (lambda_var - 2 * y)).exp();
+                log_likelihood +=
+                    ((visible + occluded) / p_infinity).log().sum();
+            }
+
+            if (posterior_occlusions)
+            {
+                Eigen::Map<Eigen::ArrayXf>(posterior_occlusions + begin, size) =
+                    (occluded / (visible + occluded)).template cast<float>();
+            }
+        }
+
+        return log_likelihood;
+    }
+
+    /**
+     * \brief Evaluates the ratios \f$p(y|\hat y, visible)/p(y|\infty)\f$ and
+     *        \f$p(y|\hat y, occluded)/p(y|\infty)\f$ exactly
+     */
+    void likelihood_ratios(Scalar prediction,
+                           Scalar observation,
+                           Scalar& visible_ratio,
+                           Scalar& occluded_ratio) const
+    {
+        const Scalar tail = tail_weight_ / max_depth_;
+        const Scalar body = 1 - tail_weight_;
+        const Scalar sigma =
+            model_sigma_ + sigma_factor_ * observation * observation;
+        const Scalar lambda_var = lambda_ * sigma * sigma;
+        const Scalar diff = prediction - observation;
+
+        const Scalar p_visible =
+            tail +
+            body * std::exp(-diff * diff / (2 * sigma * sigma)) /
+                (std::sqrt(2 * M_PI) * sigma);
+
+        // 1 + erf(x) = erfc(-x) avoids the cancellation for x << 0
+        const Scalar p_occluded =
+            tail +
+            body * lambda_ * std::exp(0.5 * lambda_ * (2 * diff + lambda_var)) *
+                std::erfc(-(diff + lambda_var) / (std::sqrt(2.) * sigma)) /
+                (2 * (std::exp(prediction * lambda_) - 1));
+
+        const Scalar p_infinity =
+            tail +
+            body * lambda_ *
+                std::exp(0.5 * lambda_ * (lambda_var - 2 * observation));
+
+        visible_ratio = p_visible / p_infinity;
+        occluded_ratio = p_occluded / p_infinity;
+    }
+
+    Scalar approximate_log_likelihood_ratio(const float* predictions,
+                                            const float* observations,
+                                            const float* occlusions,
+                                            const int count,
+                                            float* posterior_occlusions) const
+    {
+        const KinectPixelTable& table = approximation_->table;
+        const float* data = approximation_->data.data();
+
+        Scalar log_likelihood = 0;
+        Chunk mixture(64);
+        for (int begin = 0; begin < count; begin += 64)
+        {
+            const int size = std::min(64, count - begin);
+            mixture.resize(size);
+
+            for (int i = 0; i < size; ++i)
+            {
+                const int pixel = begin + i;
+                Scalar visible, occluded;
+
+                float visible_ratio, occluded_ratio;
+                if (kinect_pixel_table_lookup(table,
+                                              data,
+                                              predictions[pixel],
+                                              observations[pixel],
+                                              visible_ratio,
+                                              occluded_ratio))
+                {
+                    visible = visible_ratio;
+                    occluded = occluded_ratio;
+                }
+                else
+                {
+                    likelihood_ratios(predictions[pixel],
+                                      observations[pixel],
+                                      visible,
+                                      occluded);
+                }
+
+                const Scalar o = occlusions[pixel];
+                visible *= 1 - o;
+                occluded *= o;
+                mixture[i] = visible + occluded;
+
+                if (posterior_occlusions)
+                {
+                    posterior_occlusions[pixel] = occluded / mixture[i];
+                }
+            }
+
+            log_likelihood += mixture.log().sum();
+        }
+
+        return log_likelihood;
+    }
+
+    /**
+     * \return Largest relative error of the linear interpolant of \a f
+     *         between \a cells + 1 single precision samples in
+     *         [\a begin, \a end], measured at the cell midpoints and
+     *         scaled by \a weight
+     */
+    template <typename Function, typename Weight>
+    static Scalar interpolation_error(const Function& f,
+                                      const Weight& weight,
+                                      Scalar begin,
+                                      Scalar end,
+                                      int cells)
+    {
+        const Scalar step = (end - begin) / cells;
+
+        Scalar error = 0;
+        for (int i = 0; i < cells; ++i)
+        {
+            const Scalar x = begin + (i + 0.5) * step;
+            const Scalar approx =
+                0.5 * (float(f(x - 0.5 * step)) + float(f(x + 0.5 * step)));
+
+            error = std::max(error, weight(x) * std::fabs(approx / f(x) - 1));
+        }
+
+        return error;
+    }
+
+    /**
+     * \brief Appends \a cells + 1 uniform samples of \a f in
+     *        [\a begin, \a end] at the given \a stride to \a data
+     */
+    template <typename Function>
+    static void sample(const Function& f,
+                       Scalar begin,
+                       Scalar end,
+                       int cells,
+                       int stride,
+                       float* data)
+    {
+        for (int i = 0; i <= cells; ++i)
+        {
+            data[i * stride] = f(begin + i * (end - begin) / cells);
+        }
+    }
+
+    /**
+     * \return Smallest power of two number of cells for which the
+     *         interpolation error of \a f stays within \a budget
+     */
+    template <typename Function, typename Weight>
+    static int resolution(const Function& f,
+                          const Weight& weight,
+                          Scalar begin,
+                          Scalar end,
+                          Scalar budget,
+                          Scalar& error)
+    {
+        for (int cells = 16; cells <= max_table_cells; cells *= 2)
+        {
+            error = interpolation_error(f, weight, begin, end, cells);
+            if (error <= budget) return cells;
+        }
+
+        throw UnreachableApproximationErrorException();
+    }
+
+    std::shared_ptr<Approximation> tabulate(Scalar max_error,
+                                            Scalar min_depth) const
+    {
+        const Scalar tail = tail_weight_ / max_depth_;
+        const Scalar body = 1 - tail_weight_;
+
+        auto sigma = [&](Scalar y)
+        {
+            return model_sigma_ + sigma_factor_ * y * y;
+        };
+        auto p_infinity = [&](Scalar y)
+        {
+            const Scalar lambda_sigma = lambda_ * sigma(y);
+            return tail +
+                   body * lambda_ * std::exp(-lambda_ * y +
+                                             0.5 * lambda_sigma * lambda_sigma);
+        };
+        auto a = [&](Scalar y) { return tail / p_infinity(y); };
+        auto b = [&](Scalar y) { return 1 - tail / p_infinity(y); };
+        auto c = [&](Scalar y)
+        {
+            return body / (std::sqrt(2 * M_PI) * sigma(y) * p_infinity(y));
+        };
+        auto g = [&](Scalar y_hat)
+        {
+            return 1 / (1 - std::exp(-lambda_ * y_hat));
+        };
+        auto gauss = [](Scalar u) { return std::exp(-0.5 * u * u); };
+        auto cdf = [](Scalar v) { return 0.5 * std::erfc(-v / std::sqrt(2.)); };
+        auto one = [](Scalar) { return Scalar(1); };
+
+        // largest weights of the gaussian and the cdf relative to the tail
+        // weight term a
+        Scalar visible_ratio = 0;
+        Scalar occluded_ratio = 0;
+        for (int i = 0; i <= 1024; ++i)
+        {
+            const Scalar y = min_depth + i * (max_depth_ - min_depth) / 1024;
+            visible_ratio = std::max(visible_ratio, c(y) / a(y));
+            occluded_ratio =
+                std::max(occluded_ratio, b(y) * g(min_depth) / a(y));
+        }
+
+        // the error of a product sums up the errors of its factors while the
+        // error of the sum with a is at most the larger one. Errors of the
+        // gaussian and the cdf are scaled by their share of the sum
+        auto visible_weight = [&](Scalar u)
+        {
+            const Scalar x = visible_ratio * gauss(u);
+            return x / (1 + x);
+        };
+        auto occluded_weight = [&](Scalar v)
+        {
+            const Scalar x = occluded_ratio * cdf(v);
+            return x / (1 + x);
+        };
+
+        // beyond the limit the tails are dropped
+        const Scalar budget = max_error / 4;
+        const Scalar limit =
+            std::sqrt(2 * std::log(std::max(visible_ratio, occluded_ratio) /
+                                   (0.1 * max_error)));
+
+        Scalar error_a, error_b, error_c, error_g, error_gauss, error_cdf;
+        const Scalar begin = min_depth;
+        const Scalar end = max_depth_;
+        const int depth_cells =
+            std::max(resolution(a, one, begin, end, budget, error_a),
+                     std::max(resolution(b, one, begin, end, budget, error_b),
+                              resolution(c, one, begin, end, budget, error_c)));
+        const int prediction_cells =
+            resolution(g, one, begin, end, budget, error_g);
+        const int gauss_cells =
+            resolution(gauss, visible_weight, 0, limit, budget, error_gauss);
+        const int cdf_cells =
+            resolution(cdf, occluded_weight, -limit, limit, budget, error_cdf);
+
+        // errors at the common depth table resolution
+        error_a = interpolation_error(a, one, begin, end, depth_cells);
+        error_b = interpolation_error(b, one, begin, end, depth_cells);
+        error_c = interpolation_error(c, one, begin, end, depth_cells);
+
+        auto approximation = std::make_shared<Approximation>();
+        KinectPixelTable& table = approximation->table;
+        std::vector<float>& data = approximation->data;
+
+        table.model_sigma = model_sigma_;
+        table.sigma_factor = sigma_factor_;
+        table.lambda = lambda_;
+        table.min_depth = min_depth;
+        table.max_depth = max_depth_;
+
+        table.depth_offset = 0;
+        table.depth_size = depth_cells + 1;
+        table.depth_scale = depth_cells / (max_depth_ - min_depth);
+
+        table.prediction_offset = table.depth_offset + 3 * table.depth_size;
+        table.prediction_size = prediction_cells + 1;
+        table.prediction_scale = prediction_cells / (max_depth_ - min_depth);
+
+        table.gauss_offset = table.prediction_offset + table.prediction_size;
+        table.gauss_size = gauss_cells + 1;
+        table.gauss_limit = limit;
+        table.gauss_scale = gauss_cells / limit;
+
+        table.cdf_offset = table.gauss_offset + table.gauss_size;
+        table.cdf_size = cdf_cells + 1;
+        table.cdf_limit = limit;
+        table.cdf_scale = cdf_cells / (2 * limit);
+
+        data.resize(table.cdf_offset + table.cdf_size);
+        float* depth_table = data.data() + table.depth_offset;
+        sample(a, begin, end, depth_cells, 3, depth_table);
+        sample(b, begin, end, depth_cells, 3, depth_table + 1);
+        sample(c, begin, end, depth_cells, 3, depth_table + 2);
+        sample(g,
+               begin,
+               end,
+               prediction_cells,
+               1,
+               data.data() + table.prediction_offset);
+        sample(
+            gauss, 0, limit, gauss_cells, 1, data.data() + table.gauss_offset);
+        sample(
+            cdf, -limit, limit, cdf_cells, 1, data.data() + table.cdf_offset);
+
+        approximation->max_error =
+            std::max(std::max(error_a, error_c) + error_gauss,
+                     std::max(error_a, error_b + error_g) + error_cdf) +
+            0.1 * max_error;
+
+        return approximation;
+    }
+
+    /* fixed capacity array of the batch kernel pixels */
+    template <typename Real>
+    using ChunkOf =
+        Eigen::Array<Real, Eigen::Dynamic, 1, Eigen::ColMajor, 64, 1>;
+    typedef ChunkOf<Scalar> Chunk;
+
+    /**
+     * \return 1 + erf(x), accurate also in the tail towards -inf where the
+     *         sum cancels
+     */
+    template <typename Real>
+    static ChunkOf<Real> one_plus_erf(const ChunkOf<Real>& x)
+    {
+        const ChunkOf<Real> t = 1 / (1 + Real(0.3275911) * x.abs());
+        const ChunkOf<Real> erfc_abs =
+            t *
+            (Real(0.254829592) +
+             t * (Real(-0.284496736) +
+                  t * (Real(1.421413741) +
+                       t * (Real(-1.453152027) + t * Real(1.061405429))))) *
+            (-x.square()).exp();
+
+        return (x < 0).select(erfc_abs, 2 - erfc_abs);
+    }
+
 private:
     const Scalar lambda_, tail_weight_, model_sigma_, sigma_factor_, max_depth_;
 
     Scalar prediction_;
     bool occlusion_;
+
+    std::shared_ptr<const Approximation> approximation_;
 };
 }
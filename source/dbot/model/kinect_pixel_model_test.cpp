@@ -0,0 +1,295 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_model_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include <dbot/traits.hpp>
+#include <dbot/model/kinect_pixel_model.hpp>
+
+using dbot::KinectPixelModel;
+
+/**
+ * \return log((p(y|y_hat, visible)(1-o) + p(y|y_hat, occluded)o) / p(y|inf))
+ *         evaluated through the scalar distribution interface
+ */
+static double exact_log_ratio(KinectPixelModel& model,
+                              double prediction,
+                              double observation,
+                              double occlusion)
+{
+    model.Condition(prediction, false);
+    const double visible = model.Probability(observation);
+    model.Condition(prediction, true);
+    const double occluded = model.Probability(observation);
+    model.Condition(std::numeric_limits<double>::infinity(), true);
+    const double infinity = model.Probability(observation);
+
+    return std::log((visible * (1 - occlusion) + occluded * occlusion) /
+                    infinity);
+}
+
+class KinectPixelModelApproximationTests : public testing::TestWithParam<double>
+{
+protected:
+    void SetUp()
+    {
+        // observations around the predictions, far in front of them and
+        // beyond the tabulated range
+        for (double y = 0.25; y < 6.5; y += 0.0173)
+        {
+            for (double d = -0.05; d < 0.05; d += 0.00037)
+            {
+                predictions.push_back(y + d);
+                observations.push_back(y);
+            }
+
+            for (double y_hat = y; y_hat < 6; y_hat += 0.0931)
+            {
+                predictions.push_back(y_hat);
+                observations.push_back(y);
+            }
+        }
+
+        for (size_t i = 0; i < predictions.size(); ++i)
+        {
+            occlusions.push_back((i % 5) / 4.);
+        }
+    }
+
+    std::vector<float> predictions;
+    std::vector<float> observations;
+    std::vector<float> occlusions;
+};
+
+TEST_P(KinectPixelModelApproximationTests, log_ratios_within_error_bound)
+{
+    const double max_error = GetParam();
+
+    KinectPixelModel exact;
+    KinectPixelModel model;
+    model.approximate(max_error);
+
+    ASSERT_TRUE(bool(model.approximation()));
+    EXPECT_LE(model.approximation()->max_error, max_error);
+
+    double largest_error = 0;
+    for (size_t i = 0; i < predictions.size(); ++i)
+    {
+        const double error = std::fabs(
+            model.log_likelihood_ratio(
+                &predictions[i], &observations[i], &occlusions[i], 1) -
+            exact_log_ratio(
+                exact, predictions[i], observations[i], occlusions[i]));
+
+        largest_error = std::max(largest_error, error);
+    }
+
+    EXPECT_LE(largest_error, max_error);
+}
+
+TEST_P(KinectPixelModelApproximationTests, posterior_occlusions)
+{
+    KinectPixelModel exact;
+    KinectPixelModel model;
+    model.approximate(GetParam());
+
+    const int count = predictions.size();
+    std::vector<float> exact_posteriors(count);
+    std::vector<float> posteriors(count);
+
+    exact.log_likelihood_ratio(predictions.data(),
+                               observations.data(),
+                               occlusions.data(),
+                               count,
+                               exact_posteriors.data());
+    model.log_likelihood_ratio(predictions.data(),
+                               observations.data(),
+                               occlusions.data(),
+                               count,
+                               posteriors.data());
+
+    // the posterior is a ratio of the mixture components which are both
+    // within the relative error bound
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_NEAR(posteriors[i], exact_posteriors[i], 2 * GetParam());
+    }
+}
+
+TEST_P(KinectPixelModelApproximationTests, log_ratios_below_upper_bound)
+{
+    KinectPixelModel exact;
+    KinectPixelModel model;
+    model.approximate(GetParam());
+
+    const float min_prediction =
+        *std::min_element(predictions.begin(), predictions.end());
+
+    for (const KinectPixelModel* m : {&exact, &model})
+    {
+        const double bound = m->max_log_likelihood_ratio(min_prediction);
+        for (size_t i = 0; i < predictions.size(); ++i)
+        {
+            EXPECT_LE(m->log_likelihood_ratio(
+                          &predictions[i], &observations[i], &occlusions[i], 1),
+                      bound);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(ErrorBounds,
+                        KinectPixelModelApproximationTests,
+                        testing::Values(1e-2, 1e-3, 1e-4));
+
+TEST(KinectPixelModelTests, exact_by_default)
+{
+    KinectPixelModel model;
+    EXPECT_FALSE(bool(model.approximation()));
+
+    model.approximate(1e-3);
+    model.approximate(0);
+    EXPECT_FALSE(bool(model.approximation()));
+}
+
+TEST(KinectPixelModelTests, batch_matches_scalar_model)
+{
+    KinectPixelModel exact;
+    KinectPixelModel model;
+
+    const float predictions[] = {0.5f, 1.0f, 1.2f, 2.0f, 3.0f};
+    const float observations[] = {0.5f, 0.98f, 1.3f, 0.7f, 3.01f};
+    const float occlusions[] = {0.1f, 0.5f, 0.3f, 0.9f, 0.0f};
+
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_NEAR(model.log_likelihood_ratio(
+                        &predictions[i], &observations[i], &occlusions[i], 1),
+                    exact_log_ratio(
+                        exact, predictions[i], observations[i], occlusions[i]),
+                    1e-4);
+    }
+}
+
+TEST(KinectPixelModelTests, single_precision_matches_double_precision)
+{
+    KinectPixelModel model;
+
+    std::vector<float> predictions, observations, occlusions;
+    for (double y = 0.3; y < 6.; y += 0.0731)
+    {
+        for (double y_hat = 0.3; y_hat < 6.; y_hat += 0.0113)
+        {
+            predictions.push_back(y_hat);
+            observations.push_back(y);
+            occlusions.push_back((predictions.size() % 5) / 4.);
+        }
+    }
+    const int count = predictions.size();
+
+    std::vector<float> posterior_double(count), posterior_single(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const double log_ratio = model.log_likelihood_ratio<double>(
+            &predictions[i], &observations[i], &occlusions[i], 1);
+        EXPECT_NEAR(model.log_likelihood_ratio<float>(
+                        &predictions[i], &observations[i], &occlusions[i], 1),
+                    log_ratio,
+                    1e-4 * std::max(1., std::abs(log_ratio)));
+    }
+
+    // the sums are accumulated in double precision
+    const double sum =
+        model.log_likelihood_ratio<double>(predictions.data(),
+                                           observations.data(),
+                                           occlusions.data(),
+                                           count,
+                                           posterior_double.data());
+    EXPECT_NEAR(model.log_likelihood_ratio<float>(predictions.data(),
+                                                  observations.data(),
+                                                  occlusions.data(),
+                                                  count,
+                                                  posterior_single.data()),
+                sum,
+                1e-5 * std::abs(sum));
+
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_NEAR(posterior_single[i], posterior_double[i], 1e-4);
+    }
+}
+
+TEST(KinectPixelModelTests, copies_share_approximation)
+{
+    KinectPixelModel model;
+    model.approximate(1e-3);
+
+    KinectPixelModel copy = model;
+    EXPECT_EQ(copy.approximation().get(), model.approximation().get());
+}
+
+TEST(KinectPixelModelTests, observation_terms_match_the_batch_kernel)
+{
+    KinectPixelModel model;
+
+    std::vector<float> predictions, observations, occlusions;
+    for (double y = 0.3; y < 6.; y += 0.0731)
+    {
+        for (double y_hat = 0.3; y_hat < 6.; y_hat += 0.0113)
+        {
+            predictions.push_back(y_hat);
+            observations.push_back(y);
+            occlusions.push_back((predictions.size() % 5) / 4.);
+        }
+    }
+    const int count = predictions.size();
+
+    KinectPixelModel::ObservationTerms terms;
+    model.observation_terms(observations.data(), count, terms);
+
+    std::vector<float> posterior(count), posterior_terms(count);
+    const double sum = model.log_likelihood_ratio(predictions.data(),
+                                                  observations.data(),
+                                                  occlusions.data(),
+                                                  count,
+                                                  posterior.data());
+    EXPECT_NEAR(model.log_likelihood_ratio(predictions.data(),
+                                           observations.data(),
+                                           terms.sigma.data(),
+                                           terms.log_p_infinity.data(),
+                                           occlusions.data(),
+                                           count,
+                                           posterior_terms.data()),
+                sum,
+                1e-5 * std::abs(sum));
+
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_NEAR(posterior_terms[i], posterior[i], 1e-4);
+    }
+
+    const float missing[] = {1.f, std::numeric_limits<float>::quiet_NaN()};
+    model.observation_terms(missing, 2, terms);
+    EXPECT_EQ(terms.valid[0], 1);
+    EXPECT_EQ(terms.valid[1], 0);
+}
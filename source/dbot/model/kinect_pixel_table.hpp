@@ -0,0 +1,175 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_table.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+/*
+ * This header is shared between the host code and the CUDA kernels and must
+ * therefore not depend on anything but plain C++.
+ */
+#ifdef __CUDACC__
+#define DBOT_HOST_DEVICE __host__ __device__
+#else
+#define DBOT_HOST_DEVICE
+#endif
+
+namespace dbot
+{
+/**
+ * \brief Layout of the tabulated Kinect pixel model
+ *
+ * With \f$\sigma = \sigma_m + \sigma_f y^2\f$, \f$u = (\hat y - y)/\sigma\f$
+ * and \f$p_\infty\f$ being the likelihood of an observation of an infinitely
+ * distant object, the likelihood ratios of the visible and the occluded case
+ * factorize into
+ *
+ * \f$ r_{vis} = a(y) + c(y) e^{-u^2/2} \f$ and
+ * \f$ r_{occ} = a(y) + b(y) g(\hat y) \Phi(u + \lambda \sigma) \f$
+ *
+ * where \f$\Phi\f$ is the standard normal CDF and
+ * \f$ g(\hat y) = e^{\lambda \hat y} / (e^{\lambda \hat y} - 1) \f$.
+ *
+ * Each factor is stored as a piecewise linear function sampled on a uniform
+ * grid. All tables are concatenated in a single float array and addressed by
+ * the offsets below. The depth table interleaves a, b and c.
+ */
+struct KinectPixelTable
+{
+    /* model parameters required to compute u */
+    float model_sigma;
+    float sigma_factor;
+    float lambda;
+
+    /* observation and prediction range covered by the tables */
+    float min_depth;
+    float max_depth;
+
+    /* a, b and c over the observed depth */
+    int depth_offset;
+    int depth_size;
+    float depth_scale;
+
+    /* g over the predicted depth */
+    int prediction_offset;
+    int prediction_size;
+    float prediction_scale;
+
+    /* exp(-u^2/2) over |u| in [0, gauss_limit] */
+    int gauss_offset;
+    int gauss_size;
+    float gauss_limit;
+    float gauss_scale;
+
+    /* standard normal cdf over [-cdf_limit, cdf_limit] */
+    int cdf_offset;
+    int cdf_size;
+    float cdf_limit;
+    float cdf_scale;
+};
+
+/**
+ * \brief Linear interpolation of the table \a values at the fractional node
+ *        index \a x which must lie within [0, size - 1]
+ */
+DBOT_HOST_DEVICE inline float kinect_pixel_table_interpolate(
+    const float* values,
+    const int stride,
+    const int size,
+    const float x)
+{
+    int i = int(x);
+    if (i > size - 2) i = size - 2;
+
+    const float w = x - float(i);
+    const float v0 = values[i * stride];
+    const float v1 = values[(i + 1) * stride];
+
+    return v0 + w * (v1 - v0);
+}
+
+/**
+ * \brief Looks up the likelihood ratios
+ *        \f$ p(y|\hat y, visible) / p(y|\infty) \f$ and
+ *        \f$ p(y|\hat y, occluded) / p(y|\infty) \f$
+ *
+ * \return false if the observation or the prediction lies outside of the
+ *         tabulated range, in which case the caller has to resort to the
+ *         exact model
+ */
+DBOT_HOST_DEVICE inline bool kinect_pixel_table_lookup(
+    const KinectPixelTable& table,
+    const float* data,
+    const float prediction,
+    const float observation,
+    float& visible_ratio,
+    float& occluded_ratio)
+{
+    if (!(observation >= table.min_depth && observation <= table.max_depth &&
+          prediction >= table.min_depth && prediction <= table.max_depth))
+    {
+        return false;
+    }
+
+    const float sigma =
+        table.model_sigma + table.sigma_factor * observation * observation;
+    const float u = (prediction - observation) / sigma;
+
+    const float* depth_table = data + table.depth_offset;
+    const float x_depth = (observation - table.min_depth) * table.depth_scale;
+    const float a = kinect_pixel_table_interpolate(
+        depth_table, 3, table.depth_size, x_depth);
+    const float b = kinect_pixel_table_interpolate(
+        depth_table + 1, 3, table.depth_size, x_depth);
+    const float c = kinect_pixel_table_interpolate(
+        depth_table + 2, 3, table.depth_size, x_depth);
+
+    const float g = kinect_pixel_table_interpolate(
+        data + table.prediction_offset,
+        1,
+        table.prediction_size,
+        (prediction - table.min_depth) * table.prediction_scale);
+
+    // beyond the limits the gaussian and the cdf are saturated
+    const float abs_u = u < 0 ? -u : u;
+    float gauss = 0;
+    if (abs_u < table.gauss_limit)
+    {
+        gauss = kinect_pixel_table_interpolate(data + table.gauss_offset,
+                                               1,
+                                               table.gauss_size,
+                                               abs_u * table.gauss_scale);
+    }
+
+    const float v = u + table.lambda * sigma;
+    float cdf = v < 0 ? 0 : 1;
+    if (v > -table.cdf_limit && v < table.cdf_limit)
+    {
+        cdf = kinect_pixel_table_interpolate(
+            data + table.cdf_offset,
+            1,
+            table.cdf_size,
+            (v + table.cdf_limit) * table.cdf_scale);
+    }
+
+    visible_ratio = a + c * gauss;
+    occluded_ratio = a + b * g * cdf;
+
+    return true;
+}
+}
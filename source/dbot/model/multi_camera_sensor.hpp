@@ -0,0 +1,317 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file multi_camera_sensor.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <dbot/thread_pool.hpp>
+#include <dbot/model/rao_blackwell_sensor.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Rao-Blackwellized sensor observing the object with several depth
+ *        cameras at once.
+ *
+ * Each camera is observed by its own sensor. The cameras are assumed to be
+ * independent given the state, hence the log likelihood of a particle is the
+ * sum of its log likelihoods in all cameras. Each sensor tracks the
+ * occlusions of its own camera, all of them are resampled with the same
+ * ancestors.
+ *
+ * The states are expressed in the frame of the reference camera. The poses
+ * of a camera are obtained from those in the reference frame through its
+ * extrinsic transform. The deltas of the particles are local to the default
+ * poses and therefore the same in all cameras.
+ *
+ * The observation of all cameras is a single image which is the
+ * concatenation of the row major images of the cameras in their order.
+ *
+ * The cameras are evaluated concurrently if \a parallel is set, each one by
+ * its own thread. Sensors bound to the calling thread, such as the OpenGL
+ * based ones, have to be evaluated sequentially.
+ */
+template <typename State>
+class MultiCameraSensor : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef typename Base::PoseArray PoseArray;
+
+    struct Camera
+    {
+        /// sensor of the camera at its resolution
+        std::shared_ptr<Base> sensor;
+
+        /// transform of points in the reference frame into the camera frame
+        Eigen::Affine3d extrinsic;
+
+        int n_rows;
+        int n_cols;
+    };
+
+public:
+    /**
+     * \param cameras  the cameras, the first of them is usually the reference
+     *                 with an identity extrinsic
+     * \param parallel whether the cameras are evaluated concurrently
+     */
+    MultiCameraSensor(const std::vector<Camera>& cameras,
+                      fl::Real delta_time,
+                      bool parallel = true)
+        : Base(delta_time),
+          cameras_(cameras),
+          thread_pool_(
+              std::make_shared<ThreadPool>(parallel ? int(cameras.size()) : 1)),
+          indices_(cameras.size()),
+          loglikes_(cameras.size())
+    {
+        assert(!cameras_.empty());
+
+        // the default poses of the reference frame
+        this->default_poses_ = cameras_[0].sensor->integrated_poses();
+        const Eigen::Affine3d reference = cameras_[0].extrinsic.inverse();
+        for (int i = 0; i < this->default_poses_.count(); ++i)
+        {
+            this->default_poses_.component(i).affine(
+                reference * this->default_poses_.component(i).affine());
+        }
+    }
+
+    virtual ~MultiCameraSensor() noexcept {}
+
+    int count_cameras() const { return cameras_.size(); }
+
+    const Camera& camera(int index) const { return cameras_[index]; }
+
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        RealArray loglikes;
+        this->loglikes(deviations, indices, update, loglikes);
+        return loglikes;
+    }
+
+    void loglikes(const StateArray& deviations,
+                  IntArray& indices,
+                  const bool& update,
+                  RealArray& loglikes)
+    {
+        for (size_t i = 0; i < cameras_.size(); ++i)
+        {
+            transform_poses(cameras_[i],
+                            cameras_[i].sensor->integrated_poses());
+
+            // all sensors start from the same ancestors and update their
+            // indices independently
+            indices_[i] = indices;
+        }
+
+        thread_pool_->parallel_for(
+            cameras_.size(),
+            [&](int i, int)
+            {
+                cameras_[i].sensor->loglikes(
+                    deviations, indices_[i], update, loglikes_[i]);
+            });
+
+        loglikes = loglikes_[0];
+        for (size_t i = 1; i < cameras_.size(); ++i) loglikes += loglikes_[i];
+
+        indices = indices_[0];
+    }
+
+    /**
+     * \brief Sets the concatenated images of all cameras
+     */
+    void set_observation(const Observation& image)
+    {
+        assert(image.size() == pixel_count());
+
+        int offset = 0;
+        for (const Camera& camera : cameras_)
+        {
+            const int size = camera.n_rows * camera.n_cols;
+            camera.sensor->set_observation(
+                Observation(image.middleRows(offset, size)));
+            offset += size;
+        }
+    }
+
+    /**
+     * \brief Sets the concatenated images of all cameras. The views of the
+     *        cameras point into \a image which is kept alive until the next
+     *        observation.
+     */
+    void set_observation(const DepthImageView& image)
+    {
+        assert(image.size() == pixel_count());
+
+        observation_ = image;
+        int offset = 0;
+        for (const Camera& camera : cameras_)
+        {
+            camera.sensor->set_observation(DepthImageView(
+                image.data() + offset, camera.n_rows, camera.n_cols));
+            offset += camera.n_rows * camera.n_cols;
+        }
+    }
+
+    /**
+     * \brief Sets the image of each camera separately. The views have to
+     *        stay valid until the next observation.
+     */
+    void set_observations(const std::vector<DepthImageView>& images)
+    {
+        assert(images.size() == cameras_.size());
+
+        observation_ = DepthImageView();
+        for (size_t i = 0; i < cameras_.size(); ++i)
+        {
+            cameras_[i].sensor->set_observation(images[i]);
+        }
+    }
+
+    void reset()
+    {
+        for (const Camera& camera : cameras_) camera.sensor->reset();
+    }
+
+    /** \brief Writes the occlusions of all cameras */
+    void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        for (const Camera& camera : cameras_)
+        {
+            camera.sensor->snapshot(snapshot, indices);
+        }
+    }
+
+    int restore(Snapshot::Reader& reader)
+    {
+        int restored = std::numeric_limits<int>::max();
+        for (const Camera& camera : cameras_)
+        {
+            restored = std::min(restored, camera.sensor->restore(reader));
+        }
+
+        // the cameras restart together from the initial occlusions
+        if (restored > 0) return restored;
+        reset();
+        return 0;
+    }
+
+    int max_states() const
+    {
+        int states = std::numeric_limits<int>::max();
+        for (const Camera& camera : cameras_)
+        {
+            states = std::min(states, camera.sensor->max_states());
+        }
+        return states;
+    }
+
+    const BatchEvaluationService* batch_service() const
+    {
+        for (const Camera& camera : cameras_)
+        {
+            if (camera.sensor->batch_service())
+            {
+                return camera.sensor->batch_service();
+            }
+        }
+        return nullptr;
+    }
+
+    using Base::delta_time;
+    void delta_time(fl::Real delta_time)
+    {
+        Base::delta_time(delta_time);
+        for (const Camera& camera : cameras_)
+        {
+            camera.sensor->delta_time(delta_time);
+        }
+    }
+
+    /**
+     * \brief Sets the instrumentation of the cameras if they are evaluated
+     *        sequentially. Concurrent cameras do not report their stages,
+     *        which are then accounted as Stage::Weigh by the filter.
+     */
+    void instrumentation(
+        const std::shared_ptr<Instrumentation>& instrumentation)
+    {
+        Base::instrumentation(instrumentation);
+        if (thread_pool_->thread_count() > 1) return;
+
+        for (const Camera& camera : cameras_)
+        {
+            camera.sensor->instrumentation(instrumentation);
+        }
+    }
+
+    /** \return the number of pixels of the concatenated image */
+    int pixel_count() const
+    {
+        int count = 0;
+        for (const Camera& camera : cameras_)
+        {
+            count += camera.n_rows * camera.n_cols;
+        }
+        return count;
+    }
+
+private:
+    /**
+     * \brief Expresses the default poses of the reference frame in the frame
+     *        of \a camera
+     */
+    void transform_poses(const Camera& camera, PoseArray& poses) const
+    {
+        poses = this->default_poses_;
+        for (int i = 0; i < poses.count(); ++i)
+        {
+            poses.component(i).affine(camera.extrinsic *
+                                      poses.component(i).affine());
+        }
+    }
+
+private:
+    std::vector<Camera> cameras_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    // indices and log likelihoods of each camera in the current call
+    std::vector<IntArray> indices_;
+    std::vector<RealArray> loglikes_;
+
+    // the concatenated observation, if set as a single view
+    DepthImageView observation_;
+};
+}
@@ -0,0 +1,112 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file multi_camera_sensor_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <dbot/model/multi_camera_sensor.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef dbot::RbSensor<State> Sensor;
+typedef dbot::MultiCameraSensor<State> MultiCamera;
+
+/**
+ * \brief Returns a constant log likelihood and records its observation
+ */
+class ConstantSensor : public Sensor
+{
+public:
+    ConstantSensor(fl::Real loglike)
+        : Sensor(0.03), loglike(loglike), updates(0)
+    {
+        this->default_poses_.recount(1);
+        this->default_poses_.setZero();
+    }
+
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        if (update)
+        {
+            ++updates;
+            ancestors = indices;
+            for (int i = 0; i < indices.size(); ++i) indices[i] = i;
+        }
+        return RealArray::Constant(deviations.size(), loglike);
+    }
+
+    void set_observation(const Observation& image) { observation = image; }
+    void reset() {}
+
+    fl::Real loglike;
+    int updates;
+    IntArray ancestors;
+    Observation observation;
+};
+
+static MultiCamera::Camera camera(const std::shared_ptr<Sensor>& sensor,
+                                  int n_rows,
+                                  int n_cols)
+{
+    MultiCamera::Camera camera;
+    camera.sensor = sensor;
+    camera.extrinsic = Eigen::Affine3d::Identity();
+    camera.n_rows = n_rows;
+    camera.n_cols = n_cols;
+    return camera;
+}
+
+TEST(MultiCameraSensorTests, sums_the_log_likelihoods_of_all_cameras)
+{
+    auto first = std::make_shared<ConstantSensor>(-1.0);
+    auto second = std::make_shared<ConstantSensor>(-2.5);
+    MultiCamera sensor({camera(first, 2, 3), camera(second, 1, 2)}, 0.03);
+
+    EXPECT_EQ(sensor.pixel_count(), 8);
+
+    Sensor::Observation image(8, 1);
+    for (int i = 0; i < 8; ++i) image(i, 0) = i;
+    sensor.set_observation(image);
+    ASSERT_EQ(first->observation.rows(), 6);
+    ASSERT_EQ(second->observation.rows(), 2);
+    EXPECT_EQ(second->observation(0, 0), 6);
+
+    Sensor::StateArray states(3);
+    for (int i = 0; i < states.size(); ++i)
+    {
+        states[i].recount(1);
+        states[i].setZero();
+    }
+    Sensor::IntArray indices(3);
+    indices << 2, 0, 0;
+
+    Sensor::RealArray loglikes = sensor.loglikes(states, indices, true);
+    ASSERT_EQ(loglikes.size(), 3);
+    EXPECT_DOUBLE_EQ(loglikes[1], -3.5);
+
+    // the occlusions of both cameras are resampled with the same ancestors
+    EXPECT_EQ(first->updates, 1);
+    EXPECT_EQ(second->updates, 1);
+    EXPECT_TRUE((first->ancestors == second->ancestors).all());
+    EXPECT_EQ(first->ancestors[0], 2);
+    EXPECT_EQ(indices[0], 0);
+}
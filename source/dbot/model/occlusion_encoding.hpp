@@ -0,0 +1,249 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_encoding.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+/*
+ * This header is shared between the host code and the CUDA kernels and must
+ * therefore not depend on anything but plain C++.
+ */
+#ifdef __CUDACC__
+#define DBOT_HOST_DEVICE __host__ __device__
+#else
+#define DBOT_HOST_DEVICE
+#endif
+
+#include <math.h>
+#include <string.h>
+
+namespace dbot
+{
+/**
+ * \brief Storage format of the occlusion probabilities of the particles.
+ *
+ * Single stores 32 bit floats. Half stores IEEE half precision floats, the
+ * relative error is below 2^-11. Logit8 stores the logit of the probability
+ * in 8 bits with a resolution of 1/16 on [-7.97, 7.97], i.e. probabilities
+ * are kept within [3.5e-4, 1 - 3.5e-4] and the error of probabilities around
+ * 0.5 is below 0.008.
+ *
+ * The 8 bit codes are rounded stochastically with a dither which depends on
+ * the pixel and the time of the update. Rounding to the nearest code would
+ * freeze probabilities which the occlusion transition moves by less than half
+ * a code per frame. The dither is deterministic, such that the results do not
+ * depend on the evaluation order.
+ */
+enum class OcclusionPrecision
+{
+    Single,
+    Half,
+    Logit8
+};
+
+/** \return the bytes of a single occlusion probability in \a precision */
+DBOT_HOST_DEVICE inline int occlusion_bytes(OcclusionPrecision precision)
+{
+    return precision == OcclusionPrecision::Single
+               ? 4
+               : precision == OcclusionPrecision::Half ? 2 : 1;
+}
+
+/** \return a uniform dither in [0, 1) of \a pixel for \a seed */
+DBOT_HOST_DEVICE inline float occlusion_dither(unsigned int pixel,
+                                               unsigned int seed)
+{
+    unsigned int x = pixel * 0x9e3779b9u ^ seed;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+
+    return (x >> 8) * (1.f / 16777216.f);
+}
+
+DBOT_HOST_DEVICE inline float decode_occlusion_logit8(unsigned char code)
+{
+    const float logit = (float(code) - 127.5f) * (1.f / 16.f);
+    return 1.f / (1.f + expf(-logit));
+}
+
+/**
+ * \brief Encodes \a occlusion into the code below or above its logit with
+ *        the probabilities which make the expected logit exact
+ *
+ * \param dither  uniform in [0, 1), 0.5 rounds to the nearest code
+ */
+DBOT_HOST_DEVICE inline unsigned char encode_occlusion_logit8(float occlusion,
+                                                              float dither)
+{
+    // the clamped probability keeps the logit finite
+    occlusion = fminf(fmaxf(occlusion, 1e-6f), 1.f - 1e-6f);
+
+    const float code =
+        floorf(16.f * logf(occlusion / (1.f - occlusion)) + 127.5f + dither);
+
+    return (unsigned char)(fminf(fmaxf(code, 0.f), 255.f));
+}
+
+/**
+ * \brief Rounds \a occlusion in [0, 1] to the nearest half precision float
+ *        and returns its bits. The CUDA kernels use the intrinsics instead.
+ */
+inline unsigned short encode_occlusion_half(float occlusion)
+{
+    if (!(occlusion > 0)) return 0;
+
+    unsigned int bits;
+    memcpy(&bits, &occlusion, sizeof(bits));
+
+    const int exponent = int(bits >> 23) - 127 + 15;
+    unsigned int mantissa = (bits & 0x7fffff) | 0x800000;
+
+    // subnormal halfs have no implicit bit
+    const int shift = exponent > 0 ? 13 : 14 - exponent;
+    if (shift > 24) return 0;
+
+    unsigned int half = mantissa >> shift;
+    const unsigned int rest = mantissa & ((1u << shift) - 1);
+    const unsigned int halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1))) ++half;
+
+    // the implicit bit is replaced by the exponent, a carry of the rounding
+    // increments it
+    if (exponent > 0) half += (unsigned int)(exponent - 1) << 10;
+
+    return (unsigned short)(half < 0x7c00 ? half : 0x7bff);
+}
+
+inline float decode_occlusion_half(unsigned short half)
+{
+    const unsigned int exponent = (half >> 10) & 0x1f;
+    const unsigned int mantissa = half & 0x3ff;
+
+    if (exponent == 0) return mantissa * (1.f / 16777216.f);
+
+    const unsigned int bits = (exponent - 15 + 127) << 23 | mantissa << 13;
+    float occlusion;
+    memcpy(&occlusion, &bits, sizeof(occlusion));
+    return occlusion;
+}
+
+/**
+ * \brief Probabilities of all Logit8 codes, the host code decodes through
+ *        this table
+ */
+inline const float* occlusion_logit8_table()
+{
+    struct Table
+    {
+        Table()
+        {
+            for (int code = 0; code < 256; ++code)
+            {
+                values[code] = decode_occlusion_logit8(code);
+            }
+        }
+
+        float values[256];
+    };
+
+    static const Table table;
+    return table.values;
+}
+
+/** \return the probability \a index of the encoded array \a data */
+inline float load_occlusion(OcclusionPrecision precision,
+                            const unsigned char* data,
+                            int index)
+{
+    switch (precision)
+    {
+        case OcclusionPrecision::Half:
+        {
+            unsigned short half;
+            memcpy(&half, data + 2 * index, sizeof(half));
+            return decode_occlusion_half(half);
+        }
+        case OcclusionPrecision::Logit8:
+            return occlusion_logit8_table()[data[index]];
+        default:
+        {
+            float occlusion;
+            memcpy(&occlusion, data + 4 * index, sizeof(occlusion));
+            return occlusion;
+        }
+    }
+}
+
+/**
+ * \brief Stores \a occlusion as probability \a index of the encoded array
+ *        \a data, see occlusion_dither() for \a dither
+ */
+inline void store_occlusion(OcclusionPrecision precision,
+                            unsigned char* data,
+                            int index,
+                            float occlusion,
+                            float dither)
+{
+    switch (precision)
+    {
+        case OcclusionPrecision::Half:
+        {
+            const unsigned short half = encode_occlusion_half(occlusion);
+            memcpy(data + 2 * index, &half, sizeof(half));
+            break;
+        }
+        case OcclusionPrecision::Logit8:
+            data[index] = encode_occlusion_logit8(occlusion, dither);
+            break;
+        default:
+            memcpy(data + 4 * index, &occlusion, sizeof(occlusion));
+    }
+}
+
+/**
+ * \brief Encodes \a count probabilities into \a data, the dither of
+ *        probability i is occlusion_dither(i, seed)
+ */
+inline void encode_occlusions(OcclusionPrecision precision,
+                              const float* occlusions,
+                              int count,
+                              unsigned char* data,
+                              unsigned int seed = 0)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        store_occlusion(
+            precision, data, i, occlusions[i], occlusion_dither(i, seed));
+    }
+}
+
+/** \brief Decodes \a count probabilities of \a data into \a occlusions */
+inline void decode_occlusions(OcclusionPrecision precision,
+                              const unsigned char* data,
+                              int count,
+                              float* occlusions)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        occlusions[i] = load_occlusion(precision, data, i);
+    }
+}
+}
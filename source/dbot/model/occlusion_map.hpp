@@ -0,0 +1,354 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_map.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include <dbot/model/occlusion_model.hpp>
+#include <dbot/model/occlusion_encoding.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Sparse per-pixel occlusion probabilities of a single particle.
+ *
+ * The image is partitioned into square tiles. All pixels of a tile share a
+ * single update time. Writing a pixel at a later time first propagates the
+ * remaining pixels of its tile to that time, which is exact since the
+ * occlusion process is Markovian. Tiles which have never been written hold
+ * the initial occlusion probability and are not allocated at all.
+ *
+ * Copies of a map share their tiles, and a tile is only duplicated once it
+ * is written while still being referenced by another map. Duplicating the
+ * maps of resampled particles hence costs a tile pointer per tile and the
+ * memory scales with the area covered by the object silhouettes instead of
+ * the image size.
+ *
+ * Concurrent writes to distinct maps are safe even if they share tiles.
+ * Writers may pass a TilePool, the written tiles are then taken from the
+ * tiles of dropped maps instead of being allocated.
+ *
+ * The tiles store the probabilities in the OcclusionPrecision of the map.
+ * Half and Logit8 tiles take a half or a quarter of the memory of Single
+ * tiles, the probabilities are converted when they are read and written.
+ */
+class OcclusionMap
+{
+public:
+    /* tiles are TILE_SIZE x TILE_SIZE pixels */
+    enum : int
+    {
+        TILE_SHIFT = 4,
+        TILE_SIZE = 1 << TILE_SHIFT,
+        TILE_MASK = TILE_SIZE - 1,
+        TILE_PIXELS = TILE_SIZE * TILE_SIZE
+    };
+
+    struct Tile
+    {
+        /** \brief Tile of unspecified content of \a bytes bytes */
+        Tile(std::size_t bytes, double time)
+            : occlusions(bytes), time(time), pooled(false)
+        {
+        }
+
+        /** \return the number of maps referring to \a tile */
+        static long owners(const std::shared_ptr<Tile>& tile)
+        {
+            return tile.use_count() - tile->pooled;
+        }
+
+        // encoded probabilities in row major order
+        std::vector<unsigned char> occlusions;
+        double time;
+
+        // whether a TilePool holds a reference
+        bool pooled;
+    };
+
+    /**
+     * \brief Tiles which are reused once no map refers to them anymore.
+     *
+     * The pool keeps a reference to each of its tiles. A tile only
+     * referenced by the pool is free. A pool is used by a single writing
+     * thread at a time.
+     */
+    class TilePool
+    {
+    public:
+        TilePool() : cursor_(0) {}
+
+        /** \return a free tile of \a bytes bytes of unspecified content */
+        std::shared_ptr<Tile> acquire(std::size_t bytes)
+        {
+            for (std::size_t i = 0; i < tiles_.size(); ++i)
+            {
+                if (cursor_ >= tiles_.size()) cursor_ = 0;
+                const std::shared_ptr<Tile>& tile = tiles_[cursor_++];
+                if (Tile::owners(tile) == 0)
+                {
+                    tile->occlusions.resize(bytes);
+                    return tile;
+                }
+            }
+
+            // all tiles are in use, the pool is doubled such that the
+            // following calls find free tiles right away
+            cursor_ = tiles_.size();
+            const std::size_t grown = std::max<std::size_t>(64, 2 * cursor_);
+            while (tiles_.size() < grown)
+            {
+                tiles_.push_back(std::make_shared<Tile>(bytes, 0.));
+                tiles_.back()->pooled = true;
+            }
+            return tiles_[cursor_++];
+        }
+
+        /** \return the number of tiles owned by the pool */
+        int size() const { return tiles_.size(); }
+
+    private:
+        std::vector<std::shared_ptr<Tile>> tiles_;
+        std::size_t cursor_;
+    };
+
+public:
+    OcclusionMap()
+        : n_rows_(0),
+          n_cols_(0),
+          tiles_per_row_(0),
+          initial_occlusion_(0),
+          initial_time_(0),
+          precision_(OcclusionPrecision::Single)
+    {
+    }
+
+    OcclusionMap(int n_rows,
+                 int n_cols,
+                 float initial_occlusion,
+                 double initial_time = 0,
+                 OcclusionPrecision precision = OcclusionPrecision::Single)
+        : n_rows_(n_rows),
+          n_cols_(n_cols),
+          tiles_per_row_((n_cols + TILE_MASK) >> TILE_SHIFT),
+          initial_occlusion_(initial_occlusion),
+          initial_time_(initial_time),
+          precision_(precision),
+          tiles_(tiles_per_row_ * ((n_rows + TILE_MASK) >> TILE_SHIFT))
+    {
+    }
+
+    float occlusion(int pixel) const
+    {
+        int offset;
+        const std::shared_ptr<Tile>& tile = tiles_[locate(pixel, offset)];
+        return tile ? load_occlusion(precision_, tile->occlusions.data(), offset)
+                    : initial_occlusion_;
+    }
+
+    /**
+     * \return Time of the last update of the tile containing \a pixel
+     */
+    double time(int pixel) const
+    {
+        int offset;
+        const std::shared_ptr<Tile>& tile = tiles_[locate(pixel, offset)];
+        return tile ? tile->time : initial_time_;
+    }
+
+    /**
+     * \brief Sets the occlusion probability of \a pixel at \a time.
+     *
+     * \param propagation  Transition over time - time(pixel) which is
+     *                     applied to the other pixels of the tile if the
+     *                     tile has not been updated at \a time yet
+     * \param pool  source of new tiles, if null they are allocated
+     */
+    void set(int pixel,
+             float occlusion,
+             double time,
+             const OcclusionModel::Transition& propagation,
+             TilePool* pool = nullptr)
+    {
+        int offset;
+        const int index = locate(pixel, offset);
+        Tile& tile = writable_tile(index, time, propagation, pool);
+        store_occlusion(precision_,
+                        tile.occlusions.data(),
+                        offset,
+                        occlusion,
+                        occlusion_dither(index * TILE_PIXELS + offset,
+                                         dither_seed(time)));
+    }
+
+    /**
+     * \return Full image of occlusion probabilities in row major order
+     */
+    std::vector<float> dense_occlusions() const
+    {
+        std::vector<float> occlusions(n_rows_ * n_cols_);
+        for (int i = 0; i < int(occlusions.size()); ++i)
+        {
+            occlusions[i] = occlusion(i);
+        }
+        return occlusions;
+    }
+
+    /**
+     * \brief Drops all tiles, i.e. all pixels return to the initial
+     *        occlusion. The memory of the tile table is kept.
+     */
+    void clear_tiles()
+    {
+        for (auto& tile : tiles_) tile.reset();
+    }
+
+    /**
+     * \return Number of allocated tiles
+     */
+    int allocated_tiles() const
+    {
+        int count = 0;
+        for (const auto& tile : tiles_) count += bool(tile);
+        return count;
+    }
+
+    /**
+     * \return Bytes of the allocated tiles of this map, shared tiles are
+     *         included
+     */
+    std::size_t allocated_bytes() const
+    {
+        return std::size_t(allocated_tiles()) * tile_bytes();
+    }
+
+    /**
+     * \return The tiles in row major order, null tiles hold the initial
+     *         occlusion. The tiles are shared with the copies of the map.
+     */
+    const std::vector<std::shared_ptr<Tile>>& tiles() const { return tiles_; }
+
+    /**
+     * \brief Replaces the tile at \a index, e.g. by a restored one, which
+     *        has to be of the precision of the map
+     */
+    void tile(int index, const std::shared_ptr<Tile>& tile)
+    {
+        tiles_[index] = tile;
+    }
+
+    int rows() const { return n_rows_; }
+    int cols() const { return n_cols_; }
+    double initial_time() const { return initial_time_; }
+    OcclusionPrecision precision() const { return precision_; }
+
+private:
+    int locate(int pixel, int& offset) const
+    {
+        const int row = pixel / n_cols_;
+        const int col = pixel - row * n_cols_;
+
+        offset = ((row & TILE_MASK) << TILE_SHIFT) | (col & TILE_MASK);
+        return (row >> TILE_SHIFT) * tiles_per_row_ + (col >> TILE_SHIFT);
+    }
+
+    std::size_t tile_bytes() const
+    {
+        return TILE_PIXELS * occlusion_bytes(precision_);
+    }
+
+    /** \return the dither seed of the updates at \a time */
+    static unsigned int dither_seed(double time)
+    {
+        unsigned long long bits;
+        std::memcpy(&bits, &time, sizeof(bits));
+        return (unsigned int)(bits ^ (bits >> 32));
+    }
+
+    Tile& writable_tile(int index,
+                        double time,
+                        const OcclusionModel::Transition& propagation,
+                        TilePool* pool)
+    {
+        std::shared_ptr<Tile>& tile = tiles_[index];
+
+        const unsigned int seed = dither_seed(time);
+
+        if (!tile)
+        {
+            const float occlusion = propagation(initial_occlusion_);
+            tile = pool ? pool->acquire(tile_bytes())
+                        : std::make_shared<Tile>(tile_bytes(), time);
+            for (int offset = 0; offset < TILE_PIXELS; ++offset)
+            {
+                store_occlusion(
+                    precision_,
+                    tile->occlusions.data(),
+                    offset,
+                    occlusion,
+                    occlusion_dither(index * TILE_PIXELS + offset, seed));
+            }
+            tile->time = time;
+            return *tile;
+        }
+
+        if (Tile::owners(tile) > 1)
+        {
+            // shared with another map, copy on write
+            std::shared_ptr<Tile> copy =
+                pool ? pool->acquire(tile_bytes())
+                     : std::make_shared<Tile>(tile_bytes(), 0.);
+            copy->occlusions = tile->occlusions;
+            copy->time = tile->time;
+            tile.swap(copy);
+        }
+
+        if (tile->time != time)
+        {
+            unsigned char* occlusions = tile->occlusions.data();
+            for (int offset = 0; offset < TILE_PIXELS; ++offset)
+            {
+                store_occlusion(
+                    precision_,
+                    occlusions,
+                    offset,
+                    propagation(
+                        load_occlusion(precision_, occlusions, offset)),
+                    occlusion_dither(index * TILE_PIXELS + offset, seed));
+            }
+            tile->time = time;
+        }
+
+        return *tile;
+    }
+
+private:
+    int n_rows_;
+    int n_cols_;
+    int tiles_per_row_;
+    float initial_occlusion_;
+    double initial_time_;
+    OcclusionPrecision precision_;
+    std::vector<std::shared_ptr<Tile>> tiles_;
+};
+}
@@ -0,0 +1,215 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_map_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <dbot/model/occlusion_map.hpp>
+
+using dbot::OcclusionMap;
+using dbot::OcclusionModel;
+using dbot::OcclusionPrecision;
+
+TEST(OcclusionMapTests, unwritten_pixels_are_not_allocated)
+{
+    OcclusionMap map(40, 50, 0.1f);
+
+    EXPECT_EQ(map.allocated_tiles(), 0);
+    EXPECT_FLOAT_EQ(map.occlusion(40 * 50 - 1), 0.1f);
+    EXPECT_EQ(map.time(0), 0);
+}
+
+TEST(OcclusionMapTests, copies_share_tiles_until_written)
+{
+    OcclusionModel model(0.1, 0.7);
+    OcclusionMap map(32, 32, 0.1f);
+    map.set(0, 0.5f, 0, model.transition(0));
+
+    OcclusionMap copy = map;
+    copy.set(1, 0.9f, 0, model.transition(0));
+
+    EXPECT_FLOAT_EQ(map.occlusion(0), 0.5f);
+    EXPECT_FLOAT_EQ(map.occlusion(1), 0.1f);
+    EXPECT_FLOAT_EQ(copy.occlusion(0), 0.5f);
+    EXPECT_FLOAT_EQ(copy.occlusion(1), 0.9f);
+}
+
+TEST(OcclusionMapTests, tile_propagation_matches_per_pixel_times)
+{
+    const int rows = 20;
+    const int cols = 30;
+    const double delta_time = 0.033;
+
+    OcclusionModel model(0.1, 0.7);
+    OcclusionMap map(rows, cols, 0.1f);
+
+    // reference with an update time per pixel
+    std::vector<double> occlusions(rows * cols, 0.1);
+    std::vector<double> times(rows * cols, 0);
+
+    auto propagate = [&](int pixel, double time)
+    {
+        model.Condition(time - times[pixel], occlusions[pixel]);
+        return model.MapStandardGaussian();
+    };
+
+    double time = 0;
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        time += delta_time;
+
+        // a moving window of written pixels
+        for (int row = frame % 7; row < rows; row += 2)
+        {
+            for (int col = frame; col < frame + 8 && col < cols; ++col)
+            {
+                const int pixel = row * cols + col;
+
+                const double predicted = propagate(pixel, time);
+                EXPECT_NEAR(
+                    model.transition(time - map.time(pixel))(
+                        map.occlusion(pixel)),
+                    predicted,
+                    1e-5);
+
+                const double updated = 0.5 * predicted;
+                occlusions[pixel] = updated;
+                times[pixel] = time;
+
+                map.set(pixel,
+                        updated,
+                        time,
+                        model.transition(time - map.time(pixel)));
+            }
+        }
+    }
+
+    for (int pixel = 0; pixel < rows * cols; ++pixel)
+    {
+        EXPECT_NEAR(model.transition(time - map.time(pixel))(
+                        map.occlusion(pixel)),
+                    propagate(pixel, time),
+                    1e-5);
+    }
+}
+
+TEST(OcclusionMapTests, pooled_tiles_are_reused_once_dropped)
+{
+    OcclusionModel model(0.1, 0.7);
+    OcclusionMap::TilePool pool;
+
+    OcclusionMap map(64, 64, 0.1f);
+    map.set(0, 0.5f, 0, model.transition(0), &pool);
+    const int pooled = pool.size();
+
+    for (int generation = 0; generation < 10; ++generation)
+    {
+        OcclusionMap copy = map;
+        copy.set(1, 0.9f, 0, model.transition(0), &pool);
+        copy.set(2, 0.8f, 0, model.transition(0), &pool);
+
+        EXPECT_FLOAT_EQ(map.occlusion(1), generation ? 0.9f : 0.1f);
+        EXPECT_FLOAT_EQ(copy.occlusion(0), 0.5f);
+        EXPECT_FLOAT_EQ(copy.occlusion(1), 0.9f);
+        EXPECT_FLOAT_EQ(copy.occlusion(2), 0.8f);
+
+        map = copy;
+    }
+
+    // the tile of the dropped generation is taken again, no tile is added
+    EXPECT_EQ(pool.size(), pooled);
+    EXPECT_EQ(map.allocated_tiles(), 1);
+
+    map.clear_tiles();
+    EXPECT_FLOAT_EQ(map.occlusion(0), 0.1f);
+}
+
+TEST(OcclusionMapTests, encodings_round_trip)
+{
+    for (int code = 0; code < 256; ++code)
+    {
+        const float p = dbot::decode_occlusion_logit8(code);
+        for (float dither : {0.1f, 0.5f, 0.9f})
+        {
+            EXPECT_EQ(dbot::encode_occlusion_logit8(p, dither), code);
+        }
+    }
+
+    for (int i = 0; i <= 1000; ++i)
+    {
+        const float p = i / 1000.f;
+        const float half =
+            dbot::decode_occlusion_half(dbot::encode_occlusion_half(p));
+        EXPECT_NEAR(half, p, p / 2048 + 1e-7);
+
+        if (p > 0.01f && p < 0.99f)
+        {
+            const float logit8 = dbot::decode_occlusion_logit8(
+                dbot::encode_occlusion_logit8(p, 0.5f));
+            EXPECT_NEAR(logit8, p, 0.008);
+        }
+    }
+}
+
+TEST(OcclusionMapTests, quantized_maps_follow_the_transition)
+{
+    const int rows = 32;
+    const int cols = 32;
+    const double delta_time = 0.033;
+
+    OcclusionModel model(0.1, 0.7);
+    OcclusionMap single(rows, cols, 0.1f);
+    OcclusionMap half(rows, cols, 0.1f, 0, OcclusionPrecision::Half);
+    OcclusionMap logit8(rows, cols, 0.1f, 0, OcclusionPrecision::Logit8);
+
+    // the first pixel is written every frame, such that the others are
+    // propagated in small steps
+    double time = 0;
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        time += delta_time;
+        for (OcclusionMap* map : {&single, &half, &logit8})
+        {
+            map->set(0, 0.9f, time, model.transition(time - map->time(0)));
+        }
+    }
+
+    EXPECT_EQ(half.allocated_bytes(), single.allocated_bytes() / 2);
+    EXPECT_EQ(logit8.allocated_bytes(), single.allocated_bytes() / 4);
+
+    // the dithered codes drift like the probabilities on average
+    double half_error = 0;
+    double logit8_error = 0;
+    for (int pixel = 1; pixel < OcclusionMap::TILE_PIXELS; ++pixel)
+    {
+        const int index = (pixel / OcclusionMap::TILE_SIZE) * cols +
+                          pixel % OcclusionMap::TILE_SIZE;
+        half_error += half.occlusion(index) - single.occlusion(index);
+        logit8_error += logit8.occlusion(index) - single.occlusion(index);
+    }
+    half_error /= OcclusionMap::TILE_PIXELS - 1;
+    logit8_error /= OcclusionMap::TILE_PIXELS - 1;
+
+    EXPECT_GT(std::fabs(single.occlusion(1) - 0.1f), 0.05);
+    EXPECT_NEAR(half_error, 0, 1e-3);
+    EXPECT_NEAR(logit8_error, 0, 5e-3);
+    EXPECT_NEAR(half.occlusion(0), 0.9f, 1e-3);
+}
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <cmath>
+#include <iostream>
+
 // TODO: THIS IS JUST A LINEAR GAUSSIAN PROCESS WITH NO NOISE, SHOULD DISAPPEAR
 namespace dbot
 {
@@ -41,6 +44,24 @@ namespace dbot
  */
 class OcclusionModel
 {
+public:
+    /**
+     * \brief Occlusion transition over a fixed time delta. The propagated
+     *        probability is affine in the initial one,
+     *        \f$ p_t = c^t p + 1 - c^t - (1 - p_{oo})(c^t - 1)/(c - 1) \f$.
+     */
+    struct Transition
+    {
+        double operator()(double occlusion_probability) const
+        {
+            return scale * occlusion_probability + offset;
+        }
+
+        double delta_time;
+        double scale;
+        double offset;
+    };
+
 public:
     // the prob of source being object given source was object one sec ago,
     // and prob of source being object given one sec ago source was not object
@@ -49,7 +70,14 @@ public:
                                       p_occluded_visible_(p_occluded_visible),
                                       p_occluded_occluded_(p_occluded_occluded),
                                       c_(p_occluded_occluded_ - p_occluded_visible_),
-                                      log_c_(std::log(c_)) { }
+                                      log_c_(std::log(c_)),
+                                      next_cached_(0)
+    {
+        for (auto& transition : cached_transitions_)
+        {
+            transition = compute_transition(0);
+        }
+    }
 
     virtual ~OcclusionModel() noexcept {}
 
@@ -85,11 +113,65 @@ public:
         return new_occlusion_probability;
     }
 
+    /**
+     * \brief Returns the transition coefficients for \a delta_time.
+     *
+     * Occlusion maps share a handful of time stamps, so the last few
+     * transitions are cached and the exp is only evaluated for new time
+     * deltas. The cache makes this non-const, copies of the model may be
+     * used concurrently.
+     */
+    const Transition& transition(double delta_time)
+    {
+        for (const auto& transition : cached_transitions_)
+        {
+            if (transition.delta_time == delta_time) return transition;
+        }
+
+        Transition& transition = cached_transitions_[next_cached_];
+        next_cached_ = (next_cached_ + 1) % CACHED_TRANSITIONS;
+        transition = compute_transition(delta_time);
+
+        return transition;
+    }
+
+private:
+    Transition compute_transition(double delta_time) const
+    {
+        Transition transition;
+        transition.delta_time = delta_time;
+
+        if (std::fabs(c_ - 1.0) < 0.000000001)
+        {
+            transition.scale = 1;
+            transition.offset = 0;
+        }
+        else
+        {
+            const double pow_c_time = std::exp(delta_time * log_c_);
+            transition.scale = pow_c_time;
+            transition.offset = 1. - pow_c_time -
+                                (1 - p_occluded_occluded_) * (pow_c_time - 1.) /
+                                    (c_ - 1.);
+        }
+
+        return transition;
+    }
+
+private:
+    enum : int
+    {
+        CACHED_TRANSITIONS = 4
+    };
+
 private:
     // conditionals
     double occlusion_probability_, delta_time_;
     // parameters
     double p_occluded_visible_, p_occluded_occluded_, c_, log_c_;
+
+    Transition cached_transitions_[CACHED_TRANSITIONS];
+    int next_cached_;
 };
 
 }
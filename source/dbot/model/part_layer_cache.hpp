@@ -0,0 +1,256 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file part_layer_cache.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <dbot/hash_index.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Rendered depth layers of single parts of an object, addressed by the
+ *        part and its pose in the camera frame.
+ *
+ * The coordinate descent of the particle filter perturbs the parts one block
+ * at a time. The parts outside of the current block keep their poses, hence
+ * their layers are found here instead of being rendered again, and particles
+ * sharing the pose of a part share its layer. Compositing the layers of all
+ * parts of a particle by their minimum depth yields its full rendering.
+ *
+ * Layers are kept for one generation, i.e. a layer which is not used between
+ * two calls of next_generation() is dropped. Dropped layers keep their
+ * memory and are reused for the next missing ones.
+ */
+class PartLayerCache
+{
+public:
+    /** \brief Depth of the pixels covered by the part in row major order */
+    struct Layer
+    {
+        int part;
+        Eigen::Matrix3d rotation;
+        Eigen::Vector3d translation;
+        std::vector<int> intersect_indices;
+        std::vector<float> depth;
+    };
+
+public:
+    /** \brief Drops all layers, e.g. once the rendered mesh changed */
+    void clear()
+    {
+        recycle(layers_);
+        recycle(previous_layers_);
+        lookup_.clear();
+        previous_lookup_.clear();
+    }
+
+    /**
+     * \brief Starts a new generation. The layers used in the current one stay
+     *        available, all others are dropped.
+     */
+    void next_generation()
+    {
+        previous_layers_.swap(layers_);
+        previous_lookup_.swap(lookup_);
+        recycle(layers_);
+        lookup_.clear();
+    }
+
+    /**
+     * \brief Finds the layer of \a part at the given pose in the current or
+     *        in the previous generation, or adds an empty one.
+     *
+     * \param [out] missing  whether the returned layer has been added and
+     *                       has to be rendered by the caller
+     * \return the index of the layer in the current generation
+     */
+    int find(int part,
+             const Eigen::Matrix3d& rotation,
+             const Eigen::Vector3d& translation,
+             bool& missing)
+    {
+        missing = false;
+
+        const std::uint64_t key = hash(part, rotation, translation);
+
+        const int current = lookup_.find(key);
+        if (current >= 0 &&
+            matches(*layers_[current], part, rotation, translation))
+        {
+            return current;
+        }
+
+        std::shared_ptr<Layer> layer;
+        const int previous = previous_lookup_.find(key);
+        if (previous >= 0 &&
+            matches(*previous_layers_[previous], part, rotation, translation))
+        {
+            layer = previous_layers_[previous];
+        }
+        else
+        {
+            if (spare_layers_.empty())
+            {
+                layer = std::make_shared<Layer>();
+            }
+            else
+            {
+                layer = spare_layers_.back();
+                spare_layers_.pop_back();
+            }
+            layer->part = part;
+            layer->rotation = rotation;
+            layer->translation = translation;
+            missing = true;
+        }
+
+        // a colliding layer of another pose keeps its entry and the new one
+        // is merely not found by later lookups
+        const int index = layers_.size();
+        layers_.push_back(layer);
+        lookup_.insert(key, index);
+        return index;
+    }
+
+    Layer& layer(int index) { return *layers_[index]; }
+    const Layer& layer(int index) const { return *layers_[index]; }
+
+    /** \return the number of layers of the current generation */
+    int size() const { return layers_.size(); }
+
+    /**
+     * \brief Composites the given layers into the covered pixels in row
+     *        major order and their minimum depth
+     *
+     * \param buffer_indices, buffer_depth  memory of intermediate results
+     *        reused between calls
+     */
+    void composite(const int* indices,
+                   int count,
+                   std::vector<int>& intersect_indices,
+                   std::vector<float>& depth,
+                   std::vector<int>& buffer_indices,
+                   std::vector<float>& buffer_depth) const
+    {
+        intersect_indices.clear();
+        depth.clear();
+
+        for (int i = 0; i < count; ++i)
+        {
+            const Layer& layer = *layers_[indices[i]];
+
+            // merge the sorted pixel lists
+            buffer_indices.swap(intersect_indices);
+            buffer_depth.swap(depth);
+            intersect_indices.clear();
+            depth.clear();
+
+            size_t a = 0, b = 0;
+            const size_t a_end = buffer_indices.size();
+            const size_t b_end = layer.intersect_indices.size();
+            while (a < a_end || b < b_end)
+            {
+                const int pixel_a = a < a_end
+                                        ? buffer_indices[a]
+                                        : std::numeric_limits<int>::max();
+                const int pixel_b = b < b_end
+                                        ? layer.intersect_indices[b]
+                                        : std::numeric_limits<int>::max();
+
+                if (pixel_a < pixel_b)
+                {
+                    intersect_indices.push_back(pixel_a);
+                    depth.push_back(buffer_depth[a++]);
+                }
+                else if (pixel_b < pixel_a)
+                {
+                    intersect_indices.push_back(pixel_b);
+                    depth.push_back(layer.depth[b++]);
+                }
+                else
+                {
+                    intersect_indices.push_back(pixel_a);
+                    depth.push_back(
+                        std::min(buffer_depth[a++], layer.depth[b++]));
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * \brief Empties \a layers and keeps those which are not referenced by
+     *        the other generation as spare layers
+     */
+    void recycle(std::vector<std::shared_ptr<Layer>>& layers)
+    {
+        for (std::shared_ptr<Layer>& layer : layers)
+        {
+            if (layer.use_count() == 1) spare_layers_.push_back(layer);
+        }
+        layers.clear();
+    }
+
+    static bool matches(const Layer& layer,
+                        int part,
+                        const Eigen::Matrix3d& rotation,
+                        const Eigen::Vector3d& translation)
+    {
+        return layer.part == part && layer.rotation == rotation &&
+               layer.translation == translation;
+    }
+
+    static std::uint64_t hash(int part,
+                              const Eigen::Matrix3d& rotation,
+                              const Eigen::Vector3d& translation)
+    {
+        // FNV-1a
+        std::uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const void* data, std::size_t size)
+        {
+            const unsigned char* bytes =
+                static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                h = (h ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+
+        mix(&part, sizeof(part));
+        mix(rotation.data(), sizeof(double) * 9);
+        mix(translation.data(), sizeof(double) * 3);
+        return h;
+    }
+
+private:
+    std::vector<std::shared_ptr<Layer>> layers_;
+    HashIndex lookup_;
+    std::vector<std::shared_ptr<Layer>> previous_layers_;
+    HashIndex previous_lookup_;
+    std::vector<std::shared_ptr<Layer>> spare_layers_;
+};
+}
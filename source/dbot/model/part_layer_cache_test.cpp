@@ -0,0 +1,86 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file part_layer_cache_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <dbot/model/part_layer_cache.hpp>
+
+using dbot::PartLayerCache;
+
+TEST(PartLayerCacheTests, layers_are_kept_for_one_generation)
+{
+    PartLayerCache cache;
+    const Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+    const Eigen::Vector3d translation(0, 0, 1);
+
+    bool missing;
+    cache.next_generation();
+    const int a = cache.find(0, rotation, translation, missing);
+    EXPECT_TRUE(missing);
+    EXPECT_EQ(cache.find(0, rotation, translation, missing), a);
+    EXPECT_FALSE(missing);
+    cache.find(1, rotation, translation, missing);
+    EXPECT_TRUE(missing);
+    cache.layer(a).intersect_indices = {4, 5};
+
+    // used in the second generation, hence still available in the third
+    cache.next_generation();
+    const int b = cache.find(0, rotation, translation, missing);
+    EXPECT_FALSE(missing);
+    EXPECT_EQ(cache.layer(b).intersect_indices.size(), 2u);
+
+    cache.next_generation();
+    cache.find(0, rotation, translation, missing);
+    EXPECT_FALSE(missing);
+    cache.find(1, rotation, translation, missing);
+    EXPECT_TRUE(missing);
+
+    cache.find(0, rotation, Eigen::Vector3d(0, 0, 2), missing);
+    EXPECT_TRUE(missing);
+}
+
+TEST(PartLayerCacheTests, composite_takes_the_minimum_depth)
+{
+    PartLayerCache cache;
+    cache.next_generation();
+
+    bool missing;
+    int layers[2];
+    for (int part = 0; part < 2; ++part)
+    {
+        layers[part] = cache.find(part,
+                                  Eigen::Matrix3d::Identity(),
+                                  Eigen::Vector3d::Zero(),
+                                  missing);
+    }
+    cache.layer(layers[0]).intersect_indices = {1, 3, 4};
+    cache.layer(layers[0]).depth = {1.f, 2.f, 3.f};
+    cache.layer(layers[1]).intersect_indices = {0, 3, 7};
+    cache.layer(layers[1]).depth = {5.f, 1.5f, 4.f};
+
+    std::vector<int> indices, buffer_indices;
+    std::vector<float> depth, buffer_depth;
+    cache.composite(
+        layers, 2, indices, depth, buffer_indices, buffer_depth);
+
+    EXPECT_EQ(indices, std::vector<int>({0, 1, 3, 4, 7}));
+    EXPECT_EQ(depth, std::vector<float>({5.f, 1.f, 1.5f, 3.f, 4.f}));
+}
@@ -0,0 +1,242 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pyramid_sensor.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/rao_blackwell_sensor.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Rao-Blackwellized sensor evaluating the states at two resolutions.
+ *
+ * The coordinate particle filter evaluates the states once per sampling block
+ * and only keeps the likelihoods of the last block, which is evaluated with
+ * \a update set. All other blocks merely steer the sampling of the
+ * coordinates and are scored against a coarse sensor which observes the
+ * image downsampled by an integer factor. The last block is scored against
+ * the fine sensor at full resolution, hence the weights of the particles are
+ * those of the fine sensor.
+ *
+ * The coarse sensor tracks its own occlusions, which are updated along with
+ * those of the fine sensor in the last block such that both stay associated
+ * with the same particles.
+ *
+ * Both sensors are used alternately by the calling thread.
+ */
+template <typename State>
+class PyramidSensor : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef typename Base::PoseArray PoseArray;
+
+public:
+    /**
+     * \param fine the sensor at the full resolution
+     * \param coarse the sensor at the resolution downsampled by \a factor
+     * \param factor the integer downsampling factor of the coarse sensor
+     * \param n_rows the vertical resolution of the fine sensor
+     * \param n_cols the horizontal resolution of the fine sensor
+     */
+    PyramidSensor(const std::shared_ptr<Base>& fine,
+                  const std::shared_ptr<Base>& coarse,
+                  int factor,
+                  int n_rows,
+                  int n_cols,
+                  fl::Real delta_time)
+        : Base(delta_time),
+          fine_(fine),
+          coarse_(coarse),
+          factor_(factor),
+          n_rows_(n_rows),
+          n_cols_(n_cols)
+    {
+        this->default_poses_ = fine_->integrated_poses();
+    }
+
+    virtual ~PyramidSensor() noexcept {}
+
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        RealArray loglikes;
+        this->loglikes(deviations, indices, update, loglikes);
+        return loglikes;
+    }
+
+    void loglikes(const StateArray& deviations,
+                  IntArray& indices,
+                  const bool& update,
+                  RealArray& loglikes)
+    {
+        fine_->integrated_poses() = this->default_poses_;
+        coarse_->integrated_poses() = this->default_poses_;
+
+        if (!update)
+        {
+            coarse_->loglikes(deviations, indices, false, loglikes);
+            return;
+        }
+
+        // both sensors resample their occlusions with the same ancestors
+        coarse_indices_ = indices;
+        coarse_->loglikes(deviations, coarse_indices_, true, coarse_loglikes_);
+
+        fine_->loglikes(deviations, indices, true, loglikes);
+    }
+
+    void set_observation(const Observation& image)
+    {
+        fine_->set_observation(image);
+        coarse_->set_observation(downsample(image, factor_, n_rows_, n_cols_));
+    }
+
+    void set_observation(const DepthImageView& image)
+    {
+        const int coarse_rows = n_rows_ / factor_;
+        const int coarse_cols = n_cols_ / factor_;
+
+        coarse_image_.resize(coarse_rows * coarse_cols);
+        for (int row = 0; row < coarse_rows; ++row)
+        {
+            for (int col = 0; col < coarse_cols; ++col)
+            {
+                coarse_image_[row * coarse_cols + col] =
+                    image((row * n_cols_ + col) * factor_);
+            }
+        }
+
+        fine_->set_observation(image);
+        coarse_->set_observation(
+            DepthImageView(coarse_image_.data(), coarse_rows, coarse_cols));
+    }
+
+    void reset()
+    {
+        fine_->reset();
+        coarse_->reset();
+    }
+
+    /** \brief Writes the occlusions of both levels */
+    void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        fine_->snapshot(snapshot, indices);
+        coarse_->snapshot(snapshot, indices);
+    }
+
+    int restore(Snapshot::Reader& reader)
+    {
+        const int fine = fine_->restore(reader);
+        const int coarse = coarse_->restore(reader);
+
+        // the levels restart together from the initial occlusions
+        if (fine > 0 && coarse > 0) return std::min(fine, coarse);
+        reset();
+        return 0;
+    }
+
+    int max_states() const
+    {
+        return std::min(fine_->max_states(), coarse_->max_states());
+    }
+
+    const BatchEvaluationService* batch_service() const
+    {
+        return fine_->batch_service() ? fine_->batch_service()
+                                      : coarse_->batch_service();
+    }
+
+    using Base::delta_time;
+    void delta_time(fl::Real delta_time)
+    {
+        Base::delta_time(delta_time);
+        fine_->delta_time(delta_time);
+        coarse_->delta_time(delta_time);
+    }
+
+    void instrumentation(
+        const std::shared_ptr<Instrumentation>& instrumentation)
+    {
+        Base::instrumentation(instrumentation);
+        fine_->instrumentation(instrumentation);
+        coarse_->instrumentation(instrumentation);
+    }
+
+    /**
+     * \brief Selects every factor-th pixel of every factor-th row of the row
+     *        major image of size n_rows x n_cols. Unlike averaging, this
+     *        keeps missing measurements and depth discontinuities intact.
+     */
+    static Observation downsample(const Observation& image,
+                                  int factor,
+                                  int n_rows,
+                                  int n_cols)
+    {
+        const int coarse_rows = n_rows / factor;
+        const int coarse_cols = n_cols / factor;
+
+        Observation coarse_image(coarse_rows * coarse_cols, 1);
+        for (int row = 0; row < coarse_rows; ++row)
+        {
+            for (int col = 0; col < coarse_cols; ++col)
+            {
+                coarse_image(row * coarse_cols + col, 0) =
+                    image((row * n_cols + col) * factor, 0);
+            }
+        }
+
+        return coarse_image;
+    }
+
+    /**
+     * \brief Returns the camera matrix of an image downsampled by \a factor
+     *        as done by downsample()
+     */
+    static Eigen::Matrix3d downsample(const Eigen::Matrix3d& camera_matrix,
+                                      int factor)
+    {
+        Eigen::Matrix3d coarse_camera_matrix = camera_matrix;
+        coarse_camera_matrix.topRows(2) /= double(factor);
+
+        return coarse_camera_matrix;
+    }
+
+private:
+    std::shared_ptr<Base> fine_;
+    std::shared_ptr<Base> coarse_;
+    int factor_;
+    int n_rows_;
+    int n_cols_;
+    IntArray coarse_indices_;
+    RealArray coarse_loglikes_;
+    std::vector<float> coarse_image_;
+};
+}
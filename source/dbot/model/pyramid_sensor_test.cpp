@@ -0,0 +1,126 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pyramid_sensor_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <dbot/model/pyramid_sensor.hpp>
+
+typedef osr::FreeFloatingRigidBodiesState<> State;
+typedef dbot::RbSensor<State> Sensor;
+typedef dbot::PyramidSensor<State> Pyramid;
+
+/**
+ * \brief Returns a constant log likelihood and records how it was called
+ */
+class RecordingSensor : public Sensor
+{
+public:
+    RecordingSensor(fl::Real loglike)
+        : Sensor(0.03), loglike(loglike), calls(0), updates(0)
+    {
+        this->default_poses_.recount(1);
+        this->default_poses_.setZero();
+    }
+
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        ++calls;
+        if (update)
+        {
+            ++updates;
+            ancestors = indices;
+            for (int i = 0; i < indices.size(); ++i) indices[i] = i;
+        }
+        return RealArray::Constant(deviations.size(), loglike);
+    }
+
+    void set_observation(const Observation& image) { observation = image; }
+    void reset() {}
+
+    fl::Real loglike;
+    int calls;
+    int updates;
+    IntArray ancestors;
+    Observation observation;
+};
+
+TEST(PyramidSensorTests, downsampling_selects_the_top_left_pixels)
+{
+    const int rows = 4;
+    const int cols = 6;
+
+    Sensor::Observation image(rows * cols, 1);
+    for (int i = 0; i < rows * cols; ++i) image(i, 0) = i;
+    image(2 * cols + 4, 0) = std::numeric_limits<fl::Real>::quiet_NaN();
+
+    auto coarse = Pyramid::downsample(image, 2, rows, cols);
+
+    ASSERT_EQ(coarse.rows(), 6);
+    EXPECT_EQ(coarse(0, 0), 0);
+    EXPECT_EQ(coarse(1, 0), 2);
+    EXPECT_EQ(coarse(3, 0), 2 * cols);
+    EXPECT_TRUE(std::isnan(coarse(5, 0)));
+}
+
+TEST(PyramidSensorTests, camera_projects_onto_the_selected_pixels)
+{
+    Eigen::Matrix3d camera;
+    camera << 580, 0, 320, 0, 580, 240, 0, 0, 1;
+
+    const Eigen::Vector3d point(0.1, -0.05, 1.2);
+    Eigen::Vector3d fine = camera * point;
+    Eigen::Vector3d coarse = Pyramid::downsample(camera, 4) * point;
+
+    EXPECT_NEAR(coarse(0) / coarse(2) * 4, fine(0) / fine(2), 1e-9);
+    EXPECT_NEAR(coarse(1) / coarse(2) * 4, fine(1) / fine(2), 1e-9);
+}
+
+TEST(PyramidSensorTests, only_the_update_is_evaluated_at_full_resolution)
+{
+    auto fine = std::make_shared<RecordingSensor>(-1.0);
+    auto coarse = std::make_shared<RecordingSensor>(-2.0);
+    Pyramid pyramid(fine, coarse, 2, 4, 6, 0.03);
+
+    pyramid.set_observation(Sensor::Observation::Zero(24, 1));
+    EXPECT_EQ(coarse->observation.rows(), 6);
+
+    Sensor::StateArray states(3);
+    for (int i = 0; i < states.size(); ++i)
+    {
+        states[i].recount(1);
+        states[i].setZero();
+    }
+    Sensor::IntArray indices(3);
+    indices << 2, 0, 0;
+
+    EXPECT_EQ(pyramid.loglikes(states, indices, false)[0], -2.0);
+    EXPECT_EQ(fine->calls, 0);
+
+    EXPECT_EQ(pyramid.loglikes(states, indices, true)[0], -1.0);
+    EXPECT_EQ(fine->updates, 1);
+    EXPECT_EQ(coarse->updates, 1);
+    EXPECT_TRUE((fine->ancestors == coarse->ancestors).all());
+    EXPECT_EQ(indices[0], 0);
+}
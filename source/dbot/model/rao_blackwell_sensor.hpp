@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <limits>
+#include <memory>
+
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
@@ -36,8 +39,14 @@
 #include <osr/composed_vector.hpp>
 #include <osr/free_floating_rigid_bodies_state.hpp>
 
+#include <dbot/snapshot.hpp>
+#include <dbot/depth_image_view.hpp>
+#include <dbot/instrumentation.hpp>
+
 namespace dbot
 {
+class BatchEvaluationService;
+
 /// \todo this observation model is now specific to rigid body rendering,
 /// terminology should be adapted accordingly.
 template <typename State_>
@@ -65,6 +74,19 @@ public:
                                IntArray& indices,
                                const bool& update = false) = 0;
 
+    /**
+     * \brief Evaluates the log likelihoods into \a loglikes. Sensors which
+     *        keep their buffers between calls override this to evaluate
+     *        without allocating, by default the result is copied.
+     */
+    virtual void loglikes(const StateArray& deviations,
+                          IntArray& indices,
+                          const bool& update,
+                          RealArray& loglikes)
+    {
+        loglikes = this->loglikes(deviations, indices, update);
+    }
+
     // compute the loglikelihoods without keeping track of the occulsions
     virtual RealArray loglikes(const StateArray& deviations)
     {
@@ -75,10 +97,99 @@ public:
 
     /// accessors **************************************************************
     virtual void set_observation(const Observation& image) = 0;
+
+    /**
+     * \brief Sets the observation from a float view. Sensors evaluating
+     *        float depths read the view directly, the view then has to stay
+     *        valid until the next observation is set. By default, the view
+     *        is converted into an Observation.
+     */
+    virtual void set_observation(const DepthImageView& image)
+    {
+        set_observation(Observation(image.vector().cast<fl::Real>()));
+    }
     virtual PoseArray& integrated_poses() { return default_poses_; }
     virtual void reset() = 0;
 
+    /**
+     * \brief Sets the time in seconds between the previous and the next
+     *        observation passed to set_observation(), by default the one
+     *        given to the constructor. Sensors composed of other sensors
+     *        forward it to them.
+     */
+    virtual void delta_time(fl::Real delta_time) { delta_time_ = delta_time; }
+    fl::Real delta_time() const { return delta_time_; }
+
+    /**
+     * \brief Appends the occlusions of the particles referring to them by
+     *        \a indices to \a snapshot, see Tracker::snapshot(). By default
+     *        the sensor keeps no occlusions and writes none.
+     */
+    virtual void snapshot(Snapshot& snapshot, const IntArray& indices) const
+    {
+        snapshot.write<std::uint8_t>(NoOcclusions);
+    }
+
+    /**
+     * \brief Restores the occlusions written by snapshot(). By default the
+     *        sensor is reset.
+     *
+     * \return the number of restored occlusions, the particles may refer to
+     *         the indices [0, count). Zero if the snapshot holds none, the
+     *         particles then have to refer to the initial occlusions of
+     *         index 0.
+     * \throws InvalidSnapshotException if the snapshot holds occlusions of
+     *         another kind of sensor
+     */
+    virtual int restore(Snapshot::Reader& reader)
+    {
+        if (reader.read<std::uint8_t>() != NoOcclusions)
+        {
+            throw InvalidSnapshotException(
+                "the sensor cannot restore the occlusions");
+        }
+        reset();
+        return 0;
+    }
+
+    /**
+     * \return the largest number of states loglikes() evaluates in one call,
+     *         e.g. the poses the GPU memory has been allocated for
+     */
+    virtual int max_states() const { return std::numeric_limits<int>::max(); }
+
+    /**
+     * \return the service evaluating the states together with the sensors of
+     *         other trackers, whose evaluations block until all of them have
+     *         submitted their states, or null, see KinectImageModelBatched
+     */
+    virtual const BatchEvaluationService* batch_service() const
+    {
+        return nullptr;
+    }
+
+    /**
+     * \brief Sets the instrumentation the sensor reports its Render and Map
+     *        stages and the evaluated pixels to. Sensors which do not report
+     *        are accounted as Stage::Weigh by the filter.
+     */
+    virtual void instrumentation(
+        const std::shared_ptr<Instrumentation>& instrumentation)
+    {
+        instrumentation_ = instrumentation;
+    }
+
+protected:
+    /** \brief Kinds of the occlusions written by snapshot() */
+    enum OcclusionSnapshot : std::uint8_t
+    {
+        NoOcclusions,
+        OcclusionMaps,
+        DeviceOcclusions
+    };
+
 protected:
+    std::shared_ptr<Instrumentation> instrumentation_;
     fl::Real delta_time_;
     PoseArray default_poses_;
 };
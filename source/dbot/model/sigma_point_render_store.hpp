@@ -0,0 +1,250 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sigma_point_render_store.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Depth renderings of the sigma points of one filter update, stored
+ * in a flat array indexed by sigma point.
+ *
+ * The states are rendered once, either in one batch by render() before the
+ * pixels are evaluated or on the first lookup of a state. Lookups compare the
+ * state to the stored sigma points instead of hashing it. Since every pixel
+ * visits the sigma points in the same order, the sigma point following the
+ * last hit is tried first, such that the lookup of a pixel typically takes a
+ * single comparison.
+ *
+ * Stored renderings are never moved or modified until clear(), hence find()
+ * does not lock. Insertions are serialized. States beyond the capacity are
+ * rendered on every lookup. With a positive tolerance, states whose
+ * coefficients all differ by at most the tolerance share their rendering,
+ * which matches sigma points computed elsewhere up to rounding.
+ */
+template <typename State>
+class SigmaPointRenderStore
+{
+public:
+    /**
+     * \param capacity the maximum number of stored sigma points, e.g.
+     * 2 * state_dimension + 1 for the unscented transform
+     * \param tolerance the maximum coefficient difference of matching states
+     */
+    explicit SigmaPointRenderStore(int capacity, double tolerance = 0)
+        : states_(capacity),
+          renderings_(capacity),
+          tolerance_(tolerance),
+          count_(0),
+          hint_(0),
+          overflow_reported_(false)
+    {
+    }
+
+    /** \return the number of stored sigma points */
+    int size() const { return count_.load(std::memory_order_acquire); }
+
+    /** \return the maximum number of stored sigma points */
+    int capacity() const { return states_.size(); }
+
+    /**
+     * \brief Removes all sigma points. Must not run concurrently with any
+     * other member function.
+     */
+    void clear()
+    {
+        count_.store(0, std::memory_order_release);
+        hint_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * \return the index of the stored \a state or -1
+     */
+    int find(const State& state) const
+    {
+        const int count = count_.load(std::memory_order_acquire);
+        if (count == 0) return -1;
+
+        const int hint = hint_.load(std::memory_order_relaxed) % count;
+        for (int k = 0; k < count; ++k)
+        {
+            int i = hint + k;
+            if (i >= count) i -= count;
+
+            if (matches(states_[i], state))
+            {
+                hint_.store(i + 1, std::memory_order_relaxed);
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    /** \return the rendering of the sigma point \a index */
+    const Eigen::VectorXd& rendering(int index) const
+    {
+        return renderings_[index];
+    }
+
+    /**
+     * \brief Renders the given sigma points which are not stored yet in one
+     * batch. Sigma points exceeding the capacity are left to their lookup.
+     *
+     * \param states the sigma points
+     * \param render function (const std::vector<State>&, Eigen::VectorXd*)
+     * rendering the states into consecutive depth images
+     */
+    template <typename RenderBatch>
+    void render(const std::vector<State>& states, const RenderBatch& render)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        const int count = count_.load(std::memory_order_relaxed);
+
+        batch_.clear();
+        for (const auto& state : states)
+        {
+            if (count + int(batch_.size()) == capacity()) break;
+
+            bool stored = false;
+            for (int i = 0; i < count && !stored; ++i)
+            {
+                stored = matches(states_[i], state);
+            }
+            for (size_t i = 0; i < batch_.size() && !stored; ++i)
+            {
+                stored = matches(batch_[i], state);
+            }
+
+            if (!stored) batch_.push_back(state);
+        }
+
+        if (batch_.empty()) return;
+
+        // the new slots are published only once they are rendered
+        std::copy(batch_.begin(), batch_.end(), states_.begin() + count);
+        render(batch_, &renderings_[count]);
+        count_.store(count + batch_.size(), std::memory_order_release);
+    }
+
+    /**
+     * \brief Looks up the rendering of \a state and renders it if it is not
+     * stored yet
+     *
+     * \param state the sigma point
+     * \param render function (const State&, Eigen::VectorXd&) rendering a
+     * state into a depth image
+     * \param pixel the pixel of the rendering to return
+     */
+    template <typename Render>
+    double depth(const State& state, const Render& render, int pixel)
+    {
+        int index = find(state);
+        if (index < 0) index = insert(state, render);
+
+        if (index >= 0) return renderings_[index](pixel);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        render(state, overflow_rendering_);
+        return overflow_rendering_(pixel);
+    }
+
+    /**
+     * \brief Looks up the rendering of \a state like depth() and returns the
+     * whole image. The image of a state beyond the capacity is valid until
+     * the next lookup of such a state.
+     */
+    template <typename Render>
+    const Eigen::VectorXd& image(const State& state, const Render& render)
+    {
+        int index = find(state);
+        if (index < 0) index = insert(state, render);
+
+        if (index >= 0) return renderings_[index];
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        render(state, overflow_rendering_);
+        return overflow_rendering_;
+    }
+
+private:
+    bool matches(const State& a, const State& b) const
+    {
+        if (tolerance_ <= 0) return a == b;
+
+        return ((a - b).cwiseAbs().array() <= tolerance_).all();
+    }
+
+    /**
+     * \return the index of the rendering of \a state or -1 if the store is
+     * full
+     */
+    template <typename Render>
+    int insert(const State& state, const Render& render)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // another thread may have inserted the state meanwhile
+        const int count = count_.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i)
+        {
+            if (matches(states_[i], state)) return i;
+        }
+
+        if (count == capacity())
+        {
+            if (!overflow_reported_)
+            {
+                std::cout << "WARNING: more than " << capacity()
+                          << " sigma points are rendered per update, the "
+                          << "remaining ones are rendered on every lookup."
+                          << std::endl;
+                overflow_reported_ = true;
+            }
+            return -1;
+        }
+
+        states_[count] = state;
+        render(state, renderings_[count]);
+        count_.store(count + 1, std::memory_order_release);
+
+        return count;
+    }
+
+    std::vector<State> states_;
+    std::vector<Eigen::VectorXd> renderings_;
+    double tolerance_;
+    std::atomic<int> count_;
+    mutable std::atomic<int> hint_;
+
+    std::mutex mutex_;
+    std::vector<State> batch_;
+    Eigen::VectorXd overflow_rendering_;
+    bool overflow_reported_;
+};
+}
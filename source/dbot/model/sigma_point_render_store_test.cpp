@@ -0,0 +1,122 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sigma_point_render_store_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/sigma_point_render_store.hpp>
+
+typedef Eigen::Vector3d State;
+typedef dbot::SigmaPointRenderStore<State> Store;
+
+namespace
+{
+struct CountingRenderer
+{
+    int* renders;
+
+    void operator()(const State& state, Eigen::VectorXd& image) const
+    {
+        ++*renders;
+        image = Eigen::VectorXd::Constant(4, state(0) + state(1));
+    }
+
+    void operator()(const std::vector<State>& states,
+                    Eigen::VectorXd* images) const
+    {
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            (*this)(states[i], images[i]);
+        }
+    }
+};
+}
+
+TEST(SigmaPointRenderStoreTests, renders_each_state_once)
+{
+    int renders = 0;
+    CountingRenderer render{&renders};
+    Store store(3);
+
+    std::vector<State> states = {
+        State(0, 0, 0), State(1, 0, 0), State(0, 1, 0)};
+
+    for (int pixel = 0; pixel < 4; ++pixel)
+    {
+        for (const auto& state : states)
+        {
+            EXPECT_DOUBLE_EQ(store.depth(state, render, pixel),
+                             state(0) + state(1));
+        }
+    }
+
+    EXPECT_EQ(renders, 3);
+    EXPECT_EQ(store.size(), 3);
+}
+
+TEST(SigmaPointRenderStoreTests, batch_render_fills_the_store)
+{
+    int renders = 0;
+    CountingRenderer render{&renders};
+    Store store(3);
+
+    std::vector<State> states = {
+        State(0, 0, 0), State(2, 0, 0), State(0, 0, 0)};
+    store.render(states, render);
+
+    EXPECT_EQ(renders, 2);
+    EXPECT_EQ(store.find(State(2, 0, 0)), 1);
+    EXPECT_EQ(store.find(State(3, 0, 0)), -1);
+    EXPECT_DOUBLE_EQ(store.depth(State(2, 0, 0), render, 0), 2);
+    EXPECT_EQ(renders, 2);
+}
+
+TEST(SigmaPointRenderStoreTests, states_beyond_capacity_are_rendered)
+{
+    int renders = 0;
+    CountingRenderer render{&renders};
+    Store store(1);
+
+    EXPECT_DOUBLE_EQ(store.depth(State(1, 0, 0), render, 0), 1);
+    EXPECT_DOUBLE_EQ(store.depth(State(2, 0, 0), render, 0), 2);
+    EXPECT_DOUBLE_EQ(store.depth(State(2, 0, 0), render, 1), 2);
+    EXPECT_EQ(renders, 3);
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0);
+    EXPECT_DOUBLE_EQ(store.depth(State(2, 0, 0), render, 0), 2);
+    EXPECT_EQ(store.find(State(2, 0, 0)), 0);
+}
+
+TEST(SigmaPointRenderStoreTests, tolerance_matches_rounded_states)
+{
+    int renders = 0;
+    CountingRenderer render{&renders};
+    Store store(3, 1e-9);
+
+    std::vector<State> states = {State(1, 0, 0), State(1 + 1e-12, 0, 0)};
+    store.render(states, render);
+
+    EXPECT_EQ(renders, 1);
+    EXPECT_EQ(store.find(State(1, 1e-12, 0)), 0);
+    EXPECT_EQ(store.find(State(1, 1e-6, 0)), -1);
+}
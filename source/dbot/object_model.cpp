@@ -18,22 +18,43 @@
  */
 
 #include <dbot/object_model.hpp>
+#include <dbot/geometry_registry.hpp>
 
 namespace dbot
 {
 ObjectModel::ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader,
-                         bool center)
+                         bool center,
+                         const std::shared_ptr<ThreadPool>& thread_pool)
 {
-    load_from(loader, center);
+    load_from(loader, center, thread_pool);
 }
 
 void ObjectModel::load_from(const std::shared_ptr<ObjectModelLoader>& loader,
-                            bool center)
+                            bool center,
+                            const std::shared_ptr<ThreadPool>& thread_pool)
 {
     loader->load(vertices_, triangle_indices_);
-    compute_centers(centers_);
+    centers_.resize(vertices_.size());
 
-    if (center) center_vertices(centers_, vertices_);
+    if (thread_pool)
+    {
+        thread_pool->parallel_for(vertices_.size(),
+                                  [&](int part, int thread_index)
+                                  {
+                                      process_part(part, center);
+                                  });
+    }
+    else
+    {
+        for (size_t i = 0; i < vertices_.size(); i++)
+        {
+            process_part(i, center);
+        }
+    }
+
+    // models of the same meshes render from the same buffers
+    flat_mesh_ = GeometryRegistry::instance().flat_mesh(vertices_,
+                                                        triangle_indices_);
 }
 
 auto ObjectModel::vertices() const -> const Vertices &
@@ -51,35 +72,32 @@ const std::vector<Eigen::Vector3d>& ObjectModel::centers() const
     return centers_;
 }
 
+const std::shared_ptr<const FlatMesh>& ObjectModel::flat_mesh() const
+{
+    return flat_mesh_;
+}
+
 int ObjectModel::count_parts() const
 {
     return vertices_.size();
 }
 
-void ObjectModel::compute_centers(std::vector<Eigen::Vector3d>& centers)
+void ObjectModel::process_part(size_t part, bool center)
 {
-    centers.resize(vertices_.size());
-    for (size_t i = 0; i < vertices_.size(); i++)
+    std::vector<Eigen::Vector3d>& vertices = vertices_[part];
+
+    centers_[part] = Eigen::Vector3d::Zero();
+    for (size_t j = 0; j < vertices.size(); j++)
     {
-        centers[i] = Eigen::Vector3d::Zero();
-        for (size_t j = 0; j < vertices_[i].size(); j++)
-        {
-            centers[i] += vertices_[i][j];
-        }
-        centers[i] /= double(vertices_[i].size());
+        centers_[part] += vertices[j];
     }
-}
+    centers_[part] /= double(vertices.size());
 
-void ObjectModel::center_vertices(
-    const std::vector<Eigen::Vector3d>& centers,
-    std::vector<std::vector<Eigen::Vector3d>>& vertices)
-{
-    for (size_t i = 0; i < vertices.size(); i++)
+    if (!center) return;
+
+    for (size_t j = 0; j < vertices.size(); j++)
     {
-        for (size_t j = 0; j < vertices[i].size(); j++)
-        {
-            vertices[i][j] -= centers[i];
-        }
+        vertices[j] -= centers_[part];
     }
 }
 }
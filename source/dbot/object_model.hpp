@@ -26,6 +26,8 @@
 
 #include <fl/util/types.hpp>
 
+#include <dbot/flat_mesh.hpp>
+#include <dbot/thread_pool.hpp>
 #include <dbot/object_model_loader.hpp>
 
 namespace dbot
@@ -39,10 +41,17 @@ public:
 public:
     ObjectModel() = default;
 
-    ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader, bool center);
+    /**
+     * \param thread_pool  Threads centering the parts concurrently. A null
+     *                     pool processes them in the calling thread.
+     */
+    ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader,
+                bool center,
+                const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
     void load_from(const std::shared_ptr<ObjectModelLoader>& loader,
-                   bool center);
+                   bool center,
+                   const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
     const Vertices& vertices() const;
 
@@ -50,18 +59,24 @@ public:
 
     const std::vector<Eigen::Vector3d>& centers() const;
 
+    /**
+     * \brief The meshes of all parts in contiguous buffers, shared by the
+     *        renderers instead of copying vertices() and triangle_indices()
+     */
+    const std::shared_ptr<const FlatMesh>& flat_mesh() const;
+
     int count_parts() const;
 
 private:
-    void compute_centers(std::vector<Eigen::Vector3d>& centers);
-
-    void center_vertices(const std::vector<Eigen::Vector3d>& centers,
-                         std::vector<std::vector<Eigen::Vector3d>>& vertices);
+    /** \brief Computes the center of the part and centers it if requested */
+    void process_part(size_t part, bool center);
 
 private:
     std::vector<Eigen::Vector3d> centers_;
 
     std::vector<std::vector<Eigen::Vector3d>> vertices_;
     std::vector<std::vector<std::vector<int>>> triangle_indices_;
+
+    std::shared_ptr<const FlatMesh> flat_mesh_;
 };
 }
@@ -0,0 +1,130 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file philox.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace dbot
+{
+/**
+ * \brief Philox4x32-10 counter based random number generator
+ *
+ * J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw.
+ * Parallel Random Numbers: As Easy as 1, 2, 3
+ * Intl Conf for High Performance Computing, Networking, Storage and
+ * Analysis, 2011
+ *
+ * The generator is a stateless bijection of a 128 bit counter under a 64 bit
+ * key. Distinct counters yield independent random numbers, hence any number
+ * of parallel streams can be drawn without sharing state by encoding the
+ * stream and the position within the stream in the counter.
+ */
+class Philox
+{
+public:
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+public:
+    /**
+     * \return Four random 32 bit words of \a counter under \a key
+     */
+    static Counter generate(Counter counter, Key key)
+    {
+        for (int i = 0; i < 9; ++i)
+        {
+            counter = round(counter, key);
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+
+        return round(counter, key);
+    }
+
+    /**
+     * \brief Draws four standard normal variates from \a counter under
+     *        \a key using the Box-Muller transform
+     */
+    template <typename Scalar>
+    static void gaussian(const Counter& counter,
+                         const Key& key,
+                         Scalar* normals)
+    {
+        const Counter bits = generate(counter, key);
+
+        for (int i = 0; i < 4; i += 2)
+        {
+            const double radius =
+                std::sqrt(-2 * std::log(positive_uniform(bits[i])));
+            const double angle = 2 * M_PI * positive_uniform(bits[i + 1]);
+
+            normals[i] = radius * std::cos(angle);
+            normals[i + 1] = radius * std::sin(angle);
+        }
+    }
+
+    /**
+     * \brief Draws four uniform variates in [0, 1) from \a counter under
+     *        \a key
+     */
+    template <typename Scalar>
+    static void uniform(const Counter& counter,
+                        const Key& key,
+                        Scalar* uniforms)
+    {
+        const Counter bits = generate(counter, key);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            uniforms[i] = double(bits[i]) * (1.0 / 4294967296.0);
+        }
+    }
+
+    /**
+     * \return Key made of the 64 bit \a seed
+     */
+    static Key key(std::uint64_t seed)
+    {
+        return Key{{std::uint32_t(seed), std::uint32_t(seed >> 32)}};
+    }
+
+private:
+    static Counter round(const Counter& counter, const Key& key)
+    {
+        const std::uint64_t product0 = std::uint64_t(0xD2511F53u) * counter[0];
+        const std::uint64_t product1 = std::uint64_t(0xCD9E8D57u) * counter[2];
+
+        return Counter{{std::uint32_t(product1 >> 32) ^ counter[1] ^ key[0],
+                        std::uint32_t(product1),
+                        std::uint32_t(product0 >> 32) ^ counter[3] ^ key[1],
+                        std::uint32_t(product0)}};
+    }
+
+    /**
+     * \return Uniform sample in (0, 1]
+     */
+    static double positive_uniform(std::uint32_t bits)
+    {
+        return (double(bits) + 1.0) * (1.0 / 4294967296.0);
+    }
+};
+}
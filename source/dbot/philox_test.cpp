@@ -0,0 +1,72 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file philox_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/philox.hpp>
+
+using dbot::Philox;
+
+static void expect_counter_eq(const Philox::Counter& expected,
+                              const Philox::Counter& actual)
+{
+    for (int i = 0; i < 4; ++i) EXPECT_EQ(expected[i], actual[i]);
+}
+
+// known answers of the Random123 reference implementation
+TEST(PhiloxTests, known_answers)
+{
+    expect_counter_eq({{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+                      Philox::generate({{0, 0, 0, 0}}, {{0, 0}}));
+
+    expect_counter_eq(
+        {{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        Philox::generate({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+                         {{0xffffffff, 0xffffffff}}));
+
+    expect_counter_eq(
+        {{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+        Philox::generate({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+                         {{0xa4093822, 0x299f31d0}}));
+}
+
+TEST(PhiloxTests, gaussian_moments)
+{
+    const int count = 100000;
+    const Philox::Key key = Philox::key(42);
+
+    double sum = 0;
+    double sum_sq = 0;
+    for (int i = 0; i < count; i += 4)
+    {
+        double normals[4];
+        Philox::gaussian({{std::uint32_t(i), 0, 0, 0}}, key, normals);
+        for (double x : normals)
+        {
+            ASSERT_TRUE(std::isfinite(x));
+            sum += x;
+            sum_sq += x * x;
+        }
+    }
+
+    EXPECT_NEAR(sum / count, 0, 0.02);
+    EXPECT_NEAR(sum_sq / count, 1, 0.02);
+}
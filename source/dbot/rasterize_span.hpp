@@ -0,0 +1,62 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rasterize_span.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+namespace dbot
+{
+namespace internal
+{
+/**
+ * \brief Instruction sets of the span loop of the RigidBodyRenderer
+ */
+enum class SpanInstructions
+{
+    Scalar,
+    SSE2,
+    AVX
+};
+
+/**
+ * \return whether rasterize_span() can use \a instructions on this CPU with
+ *         this build
+ */
+bool span_instructions_supported(SpanInstructions instructions);
+
+/** \return the widest supported instructions, selected once per process */
+SpanInstructions best_span_instructions();
+
+/**
+ * \brief Depth tests and writes \a count consecutive pixels of a row. The
+ *        edge functions and the inverse depth are affine along the row, with
+ *        their values at the first pixel given by \a edge / \a inv_depth and
+ *        their increments per pixel by \a edge_step / \a inv_depth_step.
+ *
+ * All instruction sets evaluate the exact same expressions and yield
+ * identical results. \a instructions has to be supported.
+ */
+void rasterize_span(SpanInstructions instructions,
+                    float* depth,
+                    int count,
+                    const float edge[3],
+                    const float edge_step[3],
+                    float inv_depth,
+                    float inv_depth_step);
+}
+}
@@ -0,0 +1,76 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replace_file.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cerrno>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <dbot/replace_file.hpp>
+
+namespace dbot
+{
+namespace
+{
+/** \brief Writes all \a size bytes of \a data, returns false on failure */
+bool write_all(int fd, const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= std::size_t(written);
+    }
+    return true;
+}
+}
+
+bool replace_file(const std::string& path,
+                  const std::vector<FileChunk>& chunks)
+{
+    std::string temporary_path = path + ".XXXXXX";
+    const int fd = ::mkstemp(&temporary_path[0]);
+    if (fd < 0) return false;
+
+    // mkstemp creates the file readable by the owner only
+    bool written = ::fchmod(fd, 0644) == 0;
+    for (const FileChunk& chunk : chunks)
+    {
+        written = written && write_all(fd, chunk.data, chunk.size);
+    }
+
+    // errors of the delayed writes are reported by close
+    written = ::close(fd) == 0 && written;
+
+    if (!written || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+}
@@ -0,0 +1,50 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replace_file.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace dbot
+{
+/**
+ * \brief Contiguous bytes written by replace_file()
+ */
+struct FileChunk
+{
+    const void* data;
+    std::size_t size;
+};
+
+/**
+ * \brief Writes the chunks one after another into a temporary file next to
+ *        \a path which then replaces \a path.
+ *
+ * The temporary file is unique to the call, hence concurrent writers of the
+ * same path, whether threads or processes, never share it and the last
+ * rename wins. A reader of \a path sees either the previous or a completely
+ * written file. On failure the temporary file is removed.
+ *
+ * \return whether \a path has been replaced
+ */
+bool replace_file(const std::string& path,
+                  const std::vector<FileChunk>& chunks);
+}
@@ -0,0 +1,227 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replay_camera_data_provider.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <limits>
+#include <cassert>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dbot/replay_camera_data_provider.hpp>
+
+namespace dbot
+{
+ReplayCameraDataProvider::ReplayCameraDataProvider(
+    const std::string& path,
+    int downsampling_factor,
+    DepthPreprocessor::Pooling pooling,
+    const std::string& frame_id)
+    : frame_id_(frame_id),
+      downsampling_factor_(downsampling_factor),
+      preprocessor_(downsampling_factor),
+      mapping_size_(0),
+      frame_index_(-1)
+{
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        throw InvalidDepthRecordingException(path, "cannot open the file");
+    }
+
+    struct stat status;
+    if (::fstat(file, &status) != 0 ||
+        std::size_t(status.st_size) < sizeof(DepthRecording::Header))
+    {
+        ::close(file);
+        throw InvalidDepthRecordingException(path, "missing header");
+    }
+
+    mapping_size_ = status.st_size;
+    void* mapping =
+        ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED)
+    {
+        throw InvalidDepthRecordingException(path, "cannot map the file");
+    }
+
+    // frames are replayed in order
+    ::madvise(mapping, mapping_size_, MADV_SEQUENTIAL);
+
+    const std::size_t size = mapping_size_;
+    mapping_ = std::shared_ptr<const unsigned char>(
+        static_cast<const unsigned char*>(mapping),
+        [size](const unsigned char* data)
+        {
+            ::munmap(const_cast<unsigned char*>(data), size);
+        });
+
+    std::memcpy(&header_, mapping_.get(), sizeof(header_));
+    if (std::strncmp(header_.magic, DepthRecording::magic(), 8) != 0)
+    {
+        throw InvalidDepthRecordingException(path, "not a depth recording");
+    }
+    if (header_.version != DepthRecording::Version)
+    {
+        throw InvalidDepthRecordingException(path, "unsupported version");
+    }
+    if (DepthRecording::frame_offset(header_, header_.frame_count) >
+        mapping_size_)
+    {
+        throw InvalidDepthRecordingException(path, "truncated frames");
+    }
+
+    preprocessor_ = DepthPreprocessor(downsampling_factor,
+                                      pooling,
+                                      std::numeric_limits<float>::infinity(),
+                                      header_.depth_scale);
+}
+
+bool ReplayCameraDataProvider::next_frame()
+{
+    if (frame_index_ + 1 >= frame_count()) return false;
+
+    seek(frame_index_ + 1);
+    return true;
+}
+
+void ReplayCameraDataProvider::seek(int index)
+{
+    assert(index >= 0 && index < frame_count());
+    frame_index_ = index;
+
+    // the buffer is reused unless a view of the previous frame is alive
+    current_ = DepthImageView();
+    if (!buffer_ || buffer_.use_count() > 1)
+    {
+        buffer_ = std::make_shared<std::vector<float>>();
+    }
+
+    const std::uint16_t* raw = reinterpret_cast<const std::uint16_t*>(
+        frame(index) + sizeof(double) + DepthRecording::poses_size(header_));
+    preprocessor_.process(raw, header_.rows, header_.cols, *buffer_);
+
+    current_ = DepthImageView(buffer_->data(),
+                              header_.rows / downsampling_factor_,
+                              header_.cols / downsampling_factor_,
+                              buffer_);
+}
+
+int ReplayCameraDataProvider::frame_count() const
+{
+    return header_.frame_count;
+}
+
+int ReplayCameraDataProvider::frame_index() const
+{
+    return frame_index_;
+}
+
+double ReplayCameraDataProvider::time() const
+{
+    double time;
+    std::memcpy(&time, frame(frame_index_), sizeof(time));
+    return time;
+}
+
+auto ReplayCameraDataProvider::ground_truth() const -> std::vector<Affine>
+{
+    return poses(reinterpret_cast<const double*>(frame(frame_index_) +
+                                                 sizeof(double)));
+}
+
+auto ReplayCameraDataProvider::initial_poses() const -> std::vector<Affine>
+{
+    return poses(reinterpret_cast<const double*>(mapping_.get() +
+                                                 sizeof(header_)));
+}
+
+Eigen::MatrixXd ReplayCameraDataProvider::depth_image() const
+{
+    Eigen::MatrixXd image(current_.rows(), current_.cols());
+    for (int row = 0; row < current_.rows(); ++row)
+    {
+        for (int col = 0; col < current_.cols(); ++col)
+        {
+            image(row, col) = current_(row * current_.cols() + col);
+        }
+    }
+
+    return image;
+}
+
+Eigen::VectorXd ReplayCameraDataProvider::depth_image_vector() const
+{
+    return current_.vector().cast<double>();
+}
+
+DepthImageView ReplayCameraDataProvider::depth_image_view() const
+{
+    return current_;
+}
+
+Eigen::Matrix3d ReplayCameraDataProvider::camera_matrix() const
+{
+    Eigen::Matrix3d camera_matrix =
+        Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(
+            header_.camera_matrix);
+    camera_matrix.topRows(2) /= double(downsampling_factor_);
+
+    return camera_matrix;
+}
+
+std::string ReplayCameraDataProvider::frame_id() const
+{
+    return frame_id_;
+}
+
+int ReplayCameraDataProvider::downsampling_factor() const
+{
+    return downsampling_factor_;
+}
+
+CameraData::Resolution ReplayCameraDataProvider::native_resolution() const
+{
+    CameraData::Resolution resolution;
+    resolution.width = header_.cols;
+    resolution.height = header_.rows;
+
+    return resolution;
+}
+
+const unsigned char* ReplayCameraDataProvider::frame(int index) const
+{
+    return mapping_.get() + DepthRecording::frame_offset(header_, index);
+}
+
+auto ReplayCameraDataProvider::poses(const double* values) const
+    -> std::vector<Affine>
+{
+    std::vector<Affine> poses;
+    for (std::size_t i = 0; i < header_.part_count; ++i)
+    {
+        poses.push_back(
+            DepthRecording::decode(values + i * DepthRecording::PoseSize));
+    }
+    return poses;
+}
+}
@@ -0,0 +1,132 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replay_camera_data_provider.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <Eigen/Dense>
+
+#include <dbot/depth_recording.hpp>
+#include <dbot/depth_image_view.hpp>
+#include <dbot/depth_preprocessor.hpp>
+#include <dbot/camera_data_provider.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Camera data provider streaming the frames of a DepthRecording.
+ *
+ * The recording is memory mapped, hence frames are read on demand by the
+ * kernel and replaying is not limited by a copy of the file. Each frame is
+ * converted and downsampled by a DepthPreprocessor when it becomes the
+ * current one, exactly as the frames of a live camera.
+ *
+ * There is no current frame until next_frame() has been called once.
+ */
+class ReplayCameraDataProvider : public CameraDataProvider
+{
+public:
+    typedef DepthRecording::Affine Affine;
+
+public:
+    /**
+     * \param path the recording
+     * \param downsampling_factor the integer factor the recorded frames are
+     *        downsampled by
+     * \param pooling the downsampling of the frames, see DepthPreprocessor
+     *
+     * \throws InvalidDepthRecordingException if the file is not a valid
+     *         recording
+     */
+    ReplayCameraDataProvider(const std::string& path,
+                             int downsampling_factor,
+                             DepthPreprocessor::Pooling pooling =
+                                 DepthPreprocessor::Pooling::Subsample,
+                             const std::string& frame_id = "/replay");
+
+    /**
+     * \brief Makes the following frame the current one
+     *
+     * \return false once all frames have been replayed
+     */
+    bool next_frame();
+
+    /**
+     * \brief Makes frame \a index the current one, the following call of
+     *        next_frame() continues with frame index + 1
+     */
+    void seek(int index);
+
+    int frame_count() const;
+
+    /** \return the index of the current frame, -1 before the first one */
+    int frame_index() const;
+
+    /** \return the time stamp of the current frame in seconds */
+    double time() const;
+
+    /**
+     * \return the recorded poses of the parts at the current frame. The
+     *         poses are NaN if the ground truth is unknown.
+     */
+    std::vector<Affine> ground_truth() const;
+
+    /** \return the poses the trackers are initialized with */
+    std::vector<Affine> initial_poses() const;
+
+    /** \brief returns the current frame as an Eigen matrix */
+    Eigen::MatrixXd depth_image() const;
+
+    /** \brief returns the current frame as an Eigen vector */
+    Eigen::VectorXd depth_image_vector() const;
+
+    /**
+     * \brief returns the current frame without copying it. The view stays
+     *        valid after later calls to next_frame().
+     */
+    DepthImageView depth_image_view() const;
+
+    Eigen::Matrix3d camera_matrix() const;
+    std::string frame_id() const;
+    int downsampling_factor() const;
+    CameraData::Resolution native_resolution() const;
+
+private:
+    const unsigned char* frame(int index) const;
+    std::vector<Affine> poses(const double* values) const;
+
+private:
+    std::string frame_id_;
+    int downsampling_factor_;
+    DepthPreprocessor preprocessor_;
+
+    // the mapping is released once the provider is gone
+    std::shared_ptr<const unsigned char> mapping_;
+    std::size_t mapping_size_;
+    DepthRecording::Header header_;
+
+    int frame_index_;
+    DepthImageView current_;
+    std::shared_ptr<std::vector<float>> buffer_;
+};
+}
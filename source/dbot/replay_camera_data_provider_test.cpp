@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replay_camera_data_provider_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/depth_recording.hpp>
+#include <dbot/replay_camera_data_provider.hpp>
+
+using dbot::DepthRecording;
+using dbot::DepthRecordingWriter;
+using dbot::ReplayCameraDataProvider;
+
+typedef DepthRecording::Affine Affine;
+
+static std::string temporary_path()
+{
+    return (boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("%%%%-%%%%.dbotrec"))
+        .string();
+}
+
+static Affine pose(double x, double angle)
+{
+    Affine pose = Affine::Identity();
+    pose.rotate(Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitY()));
+    pose.translation() = Eigen::Vector3d(x, 0.1, 0.8);
+    return pose;
+}
+
+TEST(ReplayCameraDataProviderTests, replays_the_recorded_frames)
+{
+    const std::string path = temporary_path();
+
+    Eigen::Matrix3d camera;
+    camera << 580, 0, 320, 0, 580, 240, 0, 0, 1;
+    dbot::CameraData::Resolution resolution;
+    resolution.width = 4;
+    resolution.height = 2;
+
+    {
+        DepthRecordingWriter writer(
+            path, camera, resolution, {pose(0., 0.), pose(0.1, 0.)});
+
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        std::vector<float> depth = {0.5f, nan, 1.f, 1.5f, 2.f, 2.5f, 3.f, 0.f};
+        writer.write(0.5,
+                     dbot::DepthImageView(depth.data(), 2, 4),
+                     {pose(0.01, 0.1), pose(0.11, -0.1)});
+
+        std::vector<std::uint16_t> raw(8, 1234);
+        writer.write(1.0, raw.data(), {});
+        EXPECT_EQ(writer.frame_count(), 2);
+    }
+
+    ReplayCameraDataProvider replay(path, 2);
+    EXPECT_EQ(replay.frame_count(), 2);
+    EXPECT_EQ(replay.frame_index(), -1);
+    EXPECT_EQ(replay.native_resolution().width, 4);
+    EXPECT_DOUBLE_EQ(replay.camera_matrix()(0, 0), 290.);
+    EXPECT_DOUBLE_EQ(replay.camera_matrix()(2, 2), 1.);
+    ASSERT_EQ(replay.initial_poses().size(), 2u);
+    EXPECT_TRUE(replay.initial_poses()[1].isApprox(pose(0.1, 0.)));
+
+    ASSERT_TRUE(replay.next_frame());
+    EXPECT_DOUBLE_EQ(replay.time(), 0.5);
+    EXPECT_TRUE(replay.ground_truth()[1].isApprox(pose(0.11, -0.1)));
+
+    // the top left pixel of each 2 x 2 block
+    auto first = replay.depth_image_view();
+    ASSERT_EQ(first.size(), 2);
+    EXPECT_FLOAT_EQ(first(0), 0.5f);
+    EXPECT_FLOAT_EQ(first(1), 1.f);
+
+    ASSERT_TRUE(replay.next_frame());
+    EXPECT_FLOAT_EQ(replay.depth_image_view()(0), 1.234f);
+    EXPECT_TRUE(std::isnan(replay.ground_truth()[0].translation()(0)));
+
+    // views of previous frames stay valid
+    EXPECT_FLOAT_EQ(first(0), 0.5f);
+
+    EXPECT_FALSE(replay.next_frame());
+    replay.seek(0);
+    EXPECT_DOUBLE_EQ(replay.time(), 0.5);
+
+    std::remove(path.c_str());
+}
+
+TEST(ReplayCameraDataProviderTests, rejects_truncated_recordings)
+{
+    const std::string path = temporary_path();
+
+    dbot::CameraData::Resolution resolution;
+    resolution.width = 64;
+    resolution.height = 48;
+    {
+        DepthRecordingWriter writer(
+            path, Eigen::Matrix3d::Identity(), resolution, {pose(0., 0.)});
+        std::vector<std::uint16_t> raw(64 * 48, 1000);
+        writer.write(0., raw.data(), {});
+    }
+
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(content.data(), content.size() / 2);
+    }
+
+    EXPECT_THROW(ReplayCameraDataProvider(path, 1),
+                 dbot::InvalidDepthRecordingException);
+
+    std::remove(path.c_str());
+}
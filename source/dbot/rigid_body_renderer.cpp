@@ -18,21 +18,210 @@
 
 #include <iostream>
 #include <limits>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include <dbot/rigid_body_renderer.hpp>
+#include <dbot/rasterize_span.hpp>
+#include <dbot/geometry_registry.hpp>
+
+// the AVX loop is compiled for the AVX target alone and selected at runtime
+// if the CPU supports it, the rest of the library does not require AVX
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DBOT_SPAN_AVX 1
+#endif
 
 using namespace std;
 using namespace Eigen;
 
 using namespace dbot;
 
+namespace
+{
+/** \brief The scalar loop over the pixels [\a j, \a count) of a span */
+inline void rasterize_span_scalar(float* depth,
+                                  int j,
+                                  const int count,
+                                  const float edge[3],
+                                  const float edge_step[3],
+                                  const float inv_depth,
+                                  const float inv_depth_step)
+{
+    for(; j < count; j++)
+    {
+        const float x = float(j);
+        if(edge[0] + x*edge_step[0] >= 0.f &&
+           edge[1] + x*edge_step[1] >= 0.f &&
+           edge[2] + x*edge_step[2] >= 0.f)
+        {
+            const float pixel_depth = 1.f/(inv_depth + x*inv_depth_step);
+            depth[j] = pixel_depth < depth[j] ? pixel_depth : depth[j];
+        }
+    }
+}
+
+#if defined(__SSE2__)
+void rasterize_span_sse2(float* depth,
+                         const int count,
+                         const float edge[3],
+                         const float edge_step[3],
+                         const float inv_depth,
+                         const float inv_depth_step)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 lane = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+    const __m128 e0 = _mm_set1_ps(edge[0]);
+    const __m128 e1 = _mm_set1_ps(edge[1]);
+    const __m128 e2 = _mm_set1_ps(edge[2]);
+    const __m128 de0 = _mm_set1_ps(edge_step[0]);
+    const __m128 de1 = _mm_set1_ps(edge_step[1]);
+    const __m128 de2 = _mm_set1_ps(edge_step[2]);
+    const __m128 iz = _mm_set1_ps(inv_depth);
+    const __m128 diz = _mm_set1_ps(inv_depth_step);
+
+    int j = 0;
+    for(; j + 4 <= count; j += 4)
+    {
+        const __m128 x = _mm_add_ps(_mm_set1_ps(float(j)), lane);
+        const __m128 inside = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(e0, _mm_mul_ps(x, de0)), zero),
+                       _mm_cmpge_ps(_mm_add_ps(e1, _mm_mul_ps(x, de1)), zero)),
+            _mm_cmpge_ps(_mm_add_ps(e2, _mm_mul_ps(x, de2)), zero));
+
+        if(_mm_movemask_ps(inside) == 0)
+            continue;
+
+        const __m128 pixel_depth = _mm_div_ps(one, _mm_add_ps(iz, _mm_mul_ps(x, diz)));
+        const __m128 old_depth = _mm_loadu_ps(depth + j);
+        const __m128 new_depth = _mm_min_ps(pixel_depth, old_depth);
+        _mm_storeu_ps(depth + j,
+                      _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+    }
+
+    rasterize_span_scalar(depth, j, count, edge, edge_step, inv_depth, inv_depth_step);
+}
+#endif
+
+#if defined(DBOT_SPAN_AVX)
+__attribute__((target("avx")))
+void rasterize_span_avx(float* depth,
+                        const int count,
+                        const float edge[3],
+                        const float edge_step[3],
+                        const float inv_depth,
+                        const float inv_depth_step)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 lane = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+    const __m256 e0 = _mm256_set1_ps(edge[0]);
+    const __m256 e1 = _mm256_set1_ps(edge[1]);
+    const __m256 e2 = _mm256_set1_ps(edge[2]);
+    const __m256 de0 = _mm256_set1_ps(edge_step[0]);
+    const __m256 de1 = _mm256_set1_ps(edge_step[1]);
+    const __m256 de2 = _mm256_set1_ps(edge_step[2]);
+    const __m256 iz = _mm256_set1_ps(inv_depth);
+    const __m256 diz = _mm256_set1_ps(inv_depth_step);
+
+    int j = 0;
+    for(; j + 8 <= count; j += 8)
+    {
+        const __m256 x = _mm256_add_ps(_mm256_set1_ps(float(j)), lane);
+        const __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(
+                _mm256_cmp_ps(_mm256_add_ps(e0, _mm256_mul_ps(x, de0)), zero, _CMP_GE_OQ),
+                _mm256_cmp_ps(_mm256_add_ps(e1, _mm256_mul_ps(x, de1)), zero, _CMP_GE_OQ)),
+            _mm256_cmp_ps(_mm256_add_ps(e2, _mm256_mul_ps(x, de2)), zero, _CMP_GE_OQ));
+
+        if(_mm256_movemask_ps(inside) == 0)
+            continue;
+
+        const __m256 pixel_depth = _mm256_div_ps(one, _mm256_add_ps(iz, _mm256_mul_ps(x, diz)));
+        const __m256 old_depth = _mm256_loadu_ps(depth + j);
+        _mm256_storeu_ps(depth + j,
+                         _mm256_blendv_ps(old_depth, _mm256_min_ps(pixel_depth, old_depth), inside));
+    }
+
+    rasterize_span_scalar(depth, j, count, edge, edge_step, inv_depth, inv_depth_step);
+}
+#endif
+}
+
+bool dbot::internal::span_instructions_supported(SpanInstructions instructions)
+{
+    switch(instructions)
+    {
+    case SpanInstructions::Scalar:
+        return true;
+    case SpanInstructions::SSE2:
+#if defined(__SSE2__)
+        return true;
+#else
+        return false;
+#endif
+    case SpanInstructions::AVX:
+#if defined(DBOT_SPAN_AVX)
+        return __builtin_cpu_supports("avx");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+dbot::internal::SpanInstructions dbot::internal::best_span_instructions()
+{
+    static const SpanInstructions best =
+        span_instructions_supported(SpanInstructions::AVX)
+            ? SpanInstructions::AVX
+            : span_instructions_supported(SpanInstructions::SSE2)
+                  ? SpanInstructions::SSE2
+                  : SpanInstructions::Scalar;
+    return best;
+}
+
+void dbot::internal::rasterize_span(SpanInstructions instructions,
+                                    float* depth,
+                                    const int count,
+                                    const float edge[3],
+                                    const float edge_step[3],
+                                    const float inv_depth,
+                                    const float inv_depth_step)
+{
+    switch(instructions)
+    {
+#if defined(DBOT_SPAN_AVX)
+    case SpanInstructions::AVX:
+        rasterize_span_avx(depth, count, edge, edge_step, inv_depth, inv_depth_step);
+        return;
+#endif
+#if defined(__SSE2__)
+    case SpanInstructions::SSE2:
+        rasterize_span_sse2(depth, count, edge, edge_step, inv_depth, inv_depth_step);
+        return;
+#endif
+    default:
+        rasterize_span_scalar(depth, 0, count, edge, edge_step, inv_depth, inv_depth_step);
+        return;
+    }
+}
+
+
 RigidBodyRenderer::RigidBodyRenderer(
     const std::vector<std::vector<Eigen::Vector3d> >&   vertices,
-    const std::vector<std::vector<std::vector<int> > >& indices)
+    const std::vector<std::vector<std::vector<int> > >& indices,
+    const std::shared_ptr<ThreadPool>& thread_pool)
     : n_rows_(0),
       n_cols_(0),
-      vertices_(vertices),
-      indices_(indices)
+      back_face_culling_(false),
+      meshes_(1, std::make_shared<FlatMesh>(vertices, indices)),
+      level_tolerance_(1.),
+      level_(0),
+      thread_pool_(thread_pool)
 {
     camera_matrix_.setZero();
     init();
@@ -43,12 +232,49 @@ RigidBodyRenderer::RigidBodyRenderer(
     const std::vector<std::vector<std::vector<int> > >& indices,
     Matrix camera_matrix,
     int n_rows,
-    int n_cols)
+    int n_cols,
+    const std::shared_ptr<ThreadPool>& thread_pool)
+        : camera_matrix_(camera_matrix),
+          n_rows_(n_rows),
+          n_cols_(n_cols),
+          back_face_culling_(false),
+          meshes_(1, std::make_shared<FlatMesh>(vertices, indices)),
+          level_tolerance_(1.),
+          level_(0),
+          thread_pool_(thread_pool)
+{
+    init();
+}
+
+RigidBodyRenderer::RigidBodyRenderer(
+    const std::shared_ptr<const FlatMesh>& mesh,
+    const std::shared_ptr<ThreadPool>& thread_pool)
+    : n_rows_(0),
+      n_cols_(0),
+      back_face_culling_(false),
+      meshes_(1, mesh),
+      level_tolerance_(1.),
+      level_(0),
+      thread_pool_(thread_pool)
+{
+    camera_matrix_.setZero();
+    init();
+}
+
+RigidBodyRenderer::RigidBodyRenderer(
+    const std::shared_ptr<const FlatMesh>& mesh,
+    Matrix camera_matrix,
+    int n_rows,
+    int n_cols,
+    const std::shared_ptr<ThreadPool>& thread_pool)
         : camera_matrix_(camera_matrix),
           n_rows_(n_rows),
           n_cols_(n_cols),
-          vertices_(vertices),
-          indices_(indices)
+          back_face_culling_(false),
+          meshes_(1, mesh),
+          level_tolerance_(1.),
+          level_(0),
+          thread_pool_(thread_pool)
 {
     init();
 }
@@ -56,8 +282,8 @@ RigidBodyRenderer::RigidBodyRenderer(
 void RigidBodyRenderer::init()
 {
     /// initialize poses *******************************************************
-    R_.resize(vertices_.size());
-    t_.resize(vertices_.size());
+    R_.resize(meshes_[0]->count_parts());
+    t_.resize(meshes_[0]->count_parts());
 
     for(size_t i = 0; i < R_.size(); i++)
     {
@@ -66,17 +292,38 @@ void RigidBodyRenderer::init()
     }
 
     /// compute normals ********************************************************
-    normals_.clear();
-    for(size_t part_index = 0; part_index < indices_.size(); part_index++)
+    // renderers of the same mesh share the mesh and its normals
+    meshes_[0] = GeometryRegistry::instance().flat_mesh(meshes_[0]);
+    normals_.assign(1, shared_normals(meshes_[0]));
+}
+
+std::shared_ptr<const std::vector<RigidBodyRenderer::Vector>>
+RigidBodyRenderer::shared_normals(const std::shared_ptr<const FlatMesh>& mesh) const
+{
+    return GeometryRegistry::instance().normals(
+        mesh, [&](std::vector<Vector>& normals) { compute_normals(*mesh, normals); });
+}
+
+void RigidBodyRenderer::compute_normals(const FlatMesh& mesh,
+                                        std::vector<Vector>& normals) const
+{
+    normals.resize(mesh.count_triangles());
+
+    // the parts are independent of each other
+    auto compute_part_normals = [&](int part_index, int thread_index)
     {
-        vector<Vector3d> part_normals(indices_[part_index].size());
-        for(int triangle_index = 0; triangle_index < int(part_normals.size()); triangle_index++)
+        for(int triangle_index = mesh.triangle_begin(part_index); triangle_index < mesh.triangle_end(part_index); triangle_index++)
         {
+            const uint32_t* triangle = mesh.triangle(triangle_index);
+            Vector3d v[3];
+            for(int vertex_index = 0; vertex_index < 3; vertex_index++)
+                v[vertex_index] = mesh.vertex(triangle[vertex_index]).cast<double>();
+
             //compute the three cross products and make sure that they yield the same normal
             vector<Vector3d> temp_normals(3);
             for(int vertex_index = 0; vertex_index < 3; vertex_index++)
-                temp_normals[vertex_index] = ((vertices_[part_index][ indices_[part_index][triangle_index][(vertex_index+1)%3] ]-vertices_[part_index][ indices_[part_index][triangle_index][vertex_index] ]).cross(
-                        vertices_[part_index][ indices_[part_index][triangle_index][(vertex_index+2)%3] ]-vertices_[part_index][ indices_[part_index][triangle_index][(vertex_index+1)%3] ])).normalized();
+                temp_normals[vertex_index] = ((v[(vertex_index+1)%3] - v[vertex_index]).cross(
+                        v[(vertex_index+2)%3] - v[(vertex_index+1)%3])).normalized();
 
             for(int vertex_index = 0; vertex_index < 3; vertex_index++)
                 if(!temp_normals[vertex_index].isApprox(temp_normals[(vertex_index+1)%3]))
@@ -86,197 +333,360 @@ void RigidBodyRenderer::init()
                     cout << "normal 2 " << endl << temp_normals[(vertex_index+1)%3] << endl;
                     exit(-1);
                 }
-            part_normals[triangle_index] = temp_normals[0];
+            normals[triangle_index] = temp_normals[0];
         }
-        normals_.push_back(part_normals);
+    };
+
+    if(thread_pool_)
+    {
+        thread_pool_->parallel_for(mesh.count_parts(), compute_part_normals);
+        return;
+    }
+
+    for(int part_index = 0; part_index < mesh.count_parts(); part_index++)
+    {
+        compute_part_normals(part_index, 0);
     }
 }
 
 RigidBodyRenderer::~RigidBodyRenderer() {}
 
-// todo: does not handle the case properly when the depth is around zero or negative
 void RigidBodyRenderer::Render( Matrix camera_matrix,
                                 int n_rows,
                                 int n_cols,
                                 std::vector<float>& depth_image) const
 {
-    Matrix3d inv_camera_matrix = camera_matrix.inverse();
+    Render(R_, t_, camera_matrix, n_rows, n_cols, depth_image);
+}
 
-    // we project all the points into image space --------------------------------------------------------
-    vector<vector<Vector3d> > trans_vertices(vertices_.size());
-    vector<vector<Vector2d> > image_vertices(vertices_.size());
+void RigidBodyRenderer::Render(const std::vector<Matrix>& rotations,
+                               const std::vector<Vector>& translations,
+                               Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               std::vector<float>& depth_image) const
+{
+    const int part_count = active_mesh().count_parts();
+
+    Buffer buffer;
+    project(rotations, translations, camera_matrix, 0, part_count, buffer);
+
+    depth_image = vector<float>(n_rows*n_cols, numeric_limits<float>::infinity());
+
+    rasterize(rotations, camera_matrix, 0, part_count, 0, 0, n_rows, n_cols, buffer, depth_image.data());
+}
+
+void RigidBodyRenderer::Render(Matrix camera_matrix,
+                                int n_rows,
+                                int n_cols,
+                                std::vector<int> &intersect_indices,
+                                std::vector<float> &depth) const
+{
+    Render(R_, t_, camera_matrix, n_rows, n_cols, intersect_indices, depth);
+}
+
+void RigidBodyRenderer::Render(const std::vector<Matrix>& rotations,
+                               const std::vector<Vector>& translations,
+                               Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               std::vector<int> &intersect_indices,
+                               std::vector<float> &depth) const
+{
+    Buffer buffer;
+    Render(rotations, translations, camera_matrix, n_rows, n_cols, intersect_indices, depth, buffer);
+}
+
+void RigidBodyRenderer::Render(const std::vector<Matrix>& rotations,
+                               const std::vector<Vector>& translations,
+                               Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               std::vector<int>& intersect_indices,
+                               std::vector<float>& depth,
+                               Buffer& buffer) const
+{
+    render_parts(rotations, translations, camera_matrix, n_rows, n_cols,
+                 0, active_mesh().count_parts(), intersect_indices, depth, buffer);
+}
 
-    for(int part_index = 0; part_index < int(vertices_.size()); part_index++)
+void RigidBodyRenderer::Render(int part,
+                               const std::vector<Matrix>& rotations,
+                               const std::vector<Vector>& translations,
+                               Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               std::vector<int>& intersect_indices,
+                               std::vector<float>& depth,
+                               Buffer& buffer) const
+{
+    render_parts(rotations, translations, camera_matrix, n_rows, n_cols,
+                 part, part + 1, intersect_indices, depth, buffer);
+}
+
+void RigidBodyRenderer::render_parts(const std::vector<Matrix>& rotations,
+                                     const std::vector<Vector>& translations,
+                                     const Matrix& camera_matrix,
+                                     int n_rows,
+                                     int n_cols,
+                                     int first_part,
+                                     int end_part,
+                                     std::vector<int>& intersect_indices,
+                                     std::vector<float>& depth,
+                                     Buffer& buffer) const
+{
+    intersect_indices.clear();
+    depth.clear();
+
+    project(rotations, translations, camera_matrix, first_part, end_part, buffer);
+
+    // the region of interest is the bounding box of all projected vertices
+    // which lie in front of the camera. Triangles having a vertex behind the
+    // camera are discarded by the rasterizer anyway ----------------------------
+    const FlatMesh& mesh = active_mesh();
+    int min_row = numeric_limits<int>::max();
+    int max_row = -numeric_limits<int>::max();
+    int min_col = numeric_limits<int>::max();
+    int max_col = -numeric_limits<int>::max();
+    for(int point_index = mesh.vertex_begin(first_part); point_index < mesh.vertex_begin(end_part); point_index++)
     {
-        image_vertices[part_index].resize(vertices_[part_index].size());
-        trans_vertices[part_index].resize(vertices_[part_index].size());
-        for(int point_index = 0; point_index < int(vertices_[part_index].size()); point_index++)
+        if(buffer.trans_vertices[point_index](2) < 0.001)
+            continue;
+
+        const Vector2d& vertex = buffer.image_vertices[point_index];
+        min_row = std::min(min_row, int(ceil(float(vertex(1)))));
+        max_row = std::max(max_row, int(floor(float(vertex(1)))));
+        min_col = std::min(min_col, int(ceil(float(vertex(0)))));
+        max_col = std::max(max_col, int(floor(float(vertex(0)))));
+    }
+
+    min_row = min_row >= 0 ? min_row : 0;
+    max_row = max_row < n_rows ? max_row : (n_rows - 1);
+    min_col = min_col >= 0 ? min_col : 0;
+    max_col = max_col < n_cols ? max_col : (n_cols - 1);
+
+    if(max_row < min_row || max_col < min_col)
+        return;
+
+    const int roi_rows = max_row - min_row + 1;
+    const int roi_cols = max_col - min_col + 1;
+
+    // reuses the buffer memory of previous calls
+    buffer.roi_depth.assign(roi_rows*roi_cols, numeric_limits<float>::infinity());
+
+    rasterize(rotations, camera_matrix, first_part, end_part, min_row, min_col, roi_rows, roi_cols, buffer, buffer.roi_depth.data());
+
+    // compact the region of interest in row major order ------------------------
+    for(int row = 0; row < roi_rows; row++)
+    {
+        const float* roi_row = &buffer.roi_depth[row*roi_cols];
+        for(int col = 0; col < roi_cols; col++)
         {
-            trans_vertices[part_index][point_index] = R_[part_index] * vertices_[part_index][point_index] + t_[part_index];
-            image_vertices[part_index][point_index] =
-                    (camera_matrix * trans_vertices[part_index][point_index]/trans_vertices[part_index][point_index](2)).topRows(2);
+            if(roi_row[col] != numeric_limits<float>::infinity())
+            {
+                intersect_indices.push_back((row + min_row)*n_cols + col + min_col);
+                depth.push_back(roi_row[col]);
+            }
+        }
+    }
+}
 
+void RigidBodyRenderer::project(const std::vector<Matrix>& rotations,
+                                const std::vector<Vector>& translations,
+                                const Matrix& camera_matrix,
+                                int first_part,
+                                int end_part,
+                                Buffer& buffer) const
+{
+    const FlatMesh& mesh = active_mesh();
+
+    // we project all the points into image space --------------------------------------------------------
+    buffer.trans_vertices.resize(mesh.count_vertices());
+    buffer.image_vertices.resize(mesh.count_vertices());
+
+    for(int part_index = first_part; part_index < end_part; part_index++)
+    {
+        for(int point_index = mesh.vertex_begin(part_index); point_index < mesh.vertex_end(part_index); point_index++)
+        {
+            Vector3d& trans_vertex = buffer.trans_vertices[point_index];
+            trans_vertex = rotations[part_index] * mesh.vertex(point_index).cast<double>() + translations[part_index];
+            buffer.image_vertices[point_index] = (camera_matrix * trans_vertex/trans_vertex(2)).topRows(2);
         }
     }
+}
 
-    // we find the intersections with the triangles and the depths ---------------------------------------------------
-    depth_image = vector<float>(n_rows*n_cols, numeric_limits<float>::infinity());
+void RigidBodyRenderer::rasterize(const std::vector<Matrix>& rotations,
+                                  const Matrix& camera_matrix,
+                                  int first_part,
+                                  int end_part,
+                                  int roi_row,
+                                  int roi_col,
+                                  int roi_rows,
+                                  int roi_cols,
+                                  const Buffer& buffer,
+                                  float* depth_image) const
+{
+    const Matrix3d inv_camera_matrix_t = camera_matrix.inverse().transpose();
+    const internal::SpanInstructions instructions = internal::best_span_instructions();
 
-    for(int part_index = 0; part_index < int(indices_.size()); part_index++)
+    const int end_row = roi_row + roi_rows;
+    const int end_col = roi_col + roi_cols;
+
+    const FlatMesh& mesh = active_mesh();
+    const vector<Vector3d>& normals = active_normals();
+    const vector<Vector3d>& trans_vertices = buffer.trans_vertices;
+    const vector<Vector2d>& image_vertices = buffer.image_vertices;
+
+    // we find the intersections with the triangles and the depths ---------------------------------------------------
+    for(int part_index = first_part; part_index < end_part; part_index++)
     {
-        for(int triangle_index = 0; triangle_index < int(indices_[part_index].size()); triangle_index++)
+        for(int triangle_index = mesh.triangle_begin(part_index); triangle_index < mesh.triangle_end(part_index); triangle_index++)
         {
-            vector<Vector2d> vertices(3);
-            Vector2d center(Vector2d::Zero());
-
-            // find the min and max indices to be checked ------------------------------------------------------------
-            int min_row = numeric_limits<int>::max();
-            int max_row = -numeric_limits<int>::max();
-            int min_col = numeric_limits<int>::max();
-            int max_col = -numeric_limits<int>::max();
-            bool behind_camera = false;
-            for(int i = 0; i < 3; i++)
-            {
-                vertices[i] = image_vertices[part_index][indices_[part_index][triangle_index][i]];
-                center += vertices[i]/3.;
-                min_row =  ceil(float(vertices[i](1))) < min_row ?  ceil(float(vertices[i](1))) : min_row;
-                max_row = floor(float(vertices[i](1))) > max_row ? floor(float(vertices[i](1))) : max_row;
-                min_col =  ceil(float(vertices[i](0))) < min_col ?  ceil(float(vertices[i](0))) : min_col;
-                max_col = floor(float(vertices[i](0))) > max_col ? floor(float(vertices[i](0))) : max_col;
-
-                // how should this be handled properly? for now if some vertex in a triangle comes to lie behind camera
-                // we just discard that triangle.
-                if(trans_vertices[part_index][indices_[part_index][triangle_index][i]](2) < 0.001)
-                    behind_camera = true;
-            }
-            if(behind_camera)
+            const uint32_t* triangle = mesh.triangle(triangle_index);
+
+            // how should this be handled properly? for now if some vertex in a triangle comes to lie behind camera
+            // we just discard that triangle.
+            if(trans_vertices[triangle[0]](2) < 0.001 ||
+               trans_vertices[triangle[1]](2) < 0.001 ||
+               trans_vertices[triangle[2]](2) < 0.001)
                 continue;
 
+            // the plane of the triangle in the camera frame is normal.dot(x) = offset.
+            // The camera center lies behind triangles with a positive offset
+            Vector3d normal = rotations[part_index]*normals[triangle_index];
+            double offset = normal.dot(trans_vertices[triangle[0]]);
+            if(offset == 0. || (back_face_culling_ && offset > 0.))
+                continue;
 
-            // make sure all of them are inside of image -----------------------------------------------------------------
-            min_row = min_row >= 0 ? min_row : 0;
-            max_row = max_row < n_rows ? max_row : (n_rows - 1);
-            min_col = min_col >= 0 ? min_col : 0;
-            max_col = max_col < n_cols ? max_col : (n_cols - 1);
+            const Vector2d& v0 = image_vertices[triangle[0]];
+            const Vector2d& v1 = image_vertices[triangle[1]];
+            const Vector2d& v2 = image_vertices[triangle[2]];
 
+            // find the min and max indices to be checked and make sure they
+            // lie inside of the region of interest ---------------------------------------------------------------------
+            int min_row = std::max(roi_row, int(ceil(std::min(v0(1), std::min(v1(1), v2(1))))));
+            int max_row = std::min(end_row - 1, int(floor(std::max(v0(1), std::max(v1(1), v2(1))))));
+            int min_col = std::max(roi_col, int(ceil(std::min(v0(0), std::min(v1(0), v2(0))))));
+            int max_col = std::min(end_col - 1, int(floor(std::max(v0(0), std::max(v1(0), v2(0))))));
 
-            // check whether triangle is inside image ----------------------------------------------------------------------
-            if(max_row < 0 || min_row >= n_rows || max_col < 0 || min_col >= n_cols || max_row < min_row || max_col < min_col)
+            if(max_row < min_row || max_col < min_col)
                 continue;
 
-            // we find the line params of the triangle sides ---------------------------------------------------------------
-            vector<float> slopes(3);
-            vector<bool> boundary_type(3); const bool upper = true; const bool lower = false;
-
+            // edge functions e_i(col, row) = a_i*col + b_i*row + c_i of the three sides. They are all
+            // non-negative inside the triangle, including its boundary, once oriented by the sign of the area
+            const Vector2d* v[3] = {&v0, &v1, &v2};
+            double a[3], b[3], c[3];
             for(int i = 0; i < 3; i++)
             {
-                Vector2d side = vertices[(i+1)%3]-vertices[i];
-                slopes[i] = side(1)/side(0);
-
-                // we determine whether the line limits the triangle on top or on the bottom
-                if(vertices[i](1) + slopes[i]*(center(0)-vertices[i](0)) > center(1)) boundary_type[i] = upper;
-                else boundary_type[i] = lower;
+                const Vector2d& p = *v[i];
+                const Vector2d& q = *v[(i+1)%3];
+                a[i] = q(1) - p(1);
+                b[i] = p(0) - q(0);
+                // evaluated relative to the first pixel of the bounding box to retain precision in float
+                c[i] = (min_col - p(0))*a[i] + (min_row - p(1))*b[i];
             }
 
-            if(boundary_type[0] == boundary_type[1] && boundary_type[0] == boundary_type[2]) //if triangle is degenerate we continue
+            const double area = (v2(0) - v0(0))*a[0] + (v2(1) - v0(1))*b[0];
+            if(area == 0.) //if triangle is degenerate we continue
                 continue;
 
-            for(int col = min_col; col <= max_col; col++)
-            {
-                float min_row_given_col = -numeric_limits<float>::max();
-                float max_row_given_col = numeric_limits<float>::max();
+            const double orientation = area > 0. ? 1. : -1.;
 
-                // the min_row is the max lower boundary at that column, and the max_row is the min upper boundary at that column
-                for(int i = 0; i < 3; i++)
-                {
-                    if(boundary_type[i] == lower)
-                    {
-                        float lowe_Rboundary = ceil(float(vertices[i](1)  + slopes[i]*(float(col)-vertices[i](0))) );
-                        min_row_given_col = lowe_Rboundary > min_row_given_col ? lowe_Rboundary : min_row_given_col;
-                    }
-                    else
-                    {
-                        float upper_boundary = floor(float(vertices[i](1)  + slopes[i]*(float(col)-vertices[i](0)) ));
-                        max_row_given_col = upper_boundary < max_row_given_col ? upper_boundary : max_row_given_col;
-                    }
-                }
+            // the inverse depth along the ray through a pixel is affine in the pixel coordinates
+            Vector3d inv_depth = inv_camera_matrix_t*normal/offset;
+            const double inv_depth_origin = inv_depth(0)*min_col + inv_depth(1)*min_row + inv_depth(2);
 
+            float edge_step[3];
+            for(int i = 0; i < 3; i++)
+                edge_step[i] = float(orientation*a[i]);
 
-                // we push back the indices of the intersections and the corresponding depths ------------------------------------
-                Vector3d normal = R_[part_index]*normals_[part_index][triangle_index];
-                float offset = normal.dot(trans_vertices[part_index][indices_[part_index][triangle_index][0]]);
-                for(int row = int(min_row_given_col); row <= int(max_row_given_col); row++)
-                    if(row >= 0 && row < n_rows && col >= 0 && col < n_cols)
-                    {
-                        //						intersec_tindices.push_back(row*n_cols + col);
-                        // we find the intersection between the ray and the triangle --------------------------------------------
-                        Vector3d line_vector = inv_camera_matrix * Vector3d(col, row, 1); // the depth is the z component
-                        float depth = std::fabs(offset/normal.dot(line_vector));
-                        //if(depth > 0.5)
-                          depth_image[row*n_cols + col] =
-                            depth < depth_image[row*n_cols + col] ? depth : depth_image[row*n_cols + col];
-                    }
+            for(int row = min_row; row <= max_row; row++)
+            {
+                const int d_row = row - min_row;
+
+                float edge[3];
+                for(int i = 0; i < 3; i++)
+                    edge[i] = float(orientation*(c[i] + d_row*b[i]));
+
+                internal::rasterize_span(instructions,
+                                         &depth_image[(row - roi_row)*roi_cols + min_col - roi_col],
+                                         max_col - min_col + 1,
+                                         edge,
+                                         edge_step,
+                                         float(inv_depth_origin + d_row*inv_depth(1)),
+                                         float(inv_depth(0)));
             }
         }
     }
 }
 
 
-// todo: does not handle the case properly when the depth is around zero or negative
-void RigidBodyRenderer::Render(Matrix camera_matrix,
-                                int n_rows,
-                                int n_cols,
-                                std::vector<int> &intersect_indices,
-                                std::vector<float> &depth) const
+void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
 {
-    vector<float> depth_image;
-
-    Render(camera_matrix, n_rows, n_cols, depth_image);
-
-    // fill the depths into the depth vector -------------------------------
-    intersect_indices.clear();
-    depth.clear();
-    intersect_indices.resize(n_rows*n_cols);
-    depth.resize(n_rows*n_cols);
-    int count = 0;
-    for(int row = 0; row < n_rows; row++)
-    {
-        for(int col = 0; col < n_cols; col++)
-        {
-            if(depth_image[row*n_cols + col] != numeric_limits<float>::infinity())
-            {
-                intersect_indices[count] = row*n_cols + col;
-                depth[count] = depth_image[row*n_cols + col];
-                count++;
-            }
-        }
-    }
-    intersect_indices.resize(count);
-    depth.resize(count);
+    assert(!camera_matrix_.isZero());
+    assert(n_rows_ > 0);
+    assert(n_cols_ > 0);
 
+    Render(camera_matrix_, n_rows_, n_cols_, depth_image);
 }
 
-void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
+void RigidBodyRenderer::Render(const std::vector<Matrix>& rotations,
+                               const std::vector<Vector>& translations,
+                               std::vector<float>& depth_image) const
 {
     assert(!camera_matrix_.isZero());
     assert(n_rows_ > 0);
     assert(n_cols_ > 0);
 
-    Render(camera_matrix_, n_rows_, n_cols_, depth_image);
+    Render(rotations, translations, camera_matrix_, n_rows_, n_cols_, depth_image);
+}
+
+void RigidBodyRenderer::Render(const std::vector<std::vector<Affine> >& poses,
+                               std::vector<std::vector<float> >& depth_images)
+{
+    depth_images.resize(poses.size());
+
+    // every pose is rendered into its own image with its own buffers
+    auto render_pose = [&](int pose_index, int thread_index)
+    {
+        const vector<Affine>& parts = poses[pose_index];
+
+        vector<Matrix> rotations(parts.size());
+        vector<Vector> translations(parts.size());
+        for(size_t part_index = 0; part_index < parts.size(); part_index++)
+        {
+            rotations[part_index] = parts[part_index].rotation();
+            translations[part_index] = parts[part_index].translation();
+        }
+
+        Render(rotations, translations, depth_images[pose_index]);
+    };
+
+    if(thread_pool_)
+    {
+        thread_pool_->parallel_for(poses.size(), render_pose);
+        return;
+    }
+
+    for(size_t pose_index = 0; pose_index < poses.size(); pose_index++)
+    {
+        render_pose(pose_index, 0);
+    }
 }
 
 
 std::vector<std::vector<RigidBodyRenderer::Vector> >
 RigidBodyRenderer::vertices() const
 {
-    vector<vector<Vector3d> > trans_vertices(vertices_.size());
+    const FlatMesh& mesh = *meshes_[0];
+    vector<vector<Vector3d> > trans_vertices(mesh.count_parts());
 
-    for(int o = 0; o < int(vertices_.size()); o++)
+    for(int o = 0; o < mesh.count_parts(); o++)
     {
-        trans_vertices[o].resize(vertices_[o].size());
-        for(int p = 0; p < int(vertices_[o].size()); p++)
+        trans_vertices[o].resize(mesh.vertex_end(o) - mesh.vertex_begin(o));
+        for(int p = 0; p < int(trans_vertices[o].size()); p++)
         {
-            trans_vertices[o][p] = R_[o] * vertices_[o][p] + t_[o];
+            trans_vertices[o][p] = R_[o] * mesh.vertex(mesh.vertex_begin(o) + p).cast<double>() + t_[o];
         }
     }
     return trans_vertices;
@@ -301,6 +711,21 @@ void RigidBodyRenderer::set_poses(const std::vector<Affine>& poses)
      }
 }
 
+void RigidBodyRenderer::back_face_culling(bool enabled)
+{
+    back_face_culling_ = enabled;
+}
+
+bool RigidBodyRenderer::back_face_culling() const
+{
+    return back_face_culling_;
+}
+
+void RigidBodyRenderer::thread_pool(const std::shared_ptr<ThreadPool>& pool)
+{
+    thread_pool_ = pool;
+}
+
 void RigidBodyRenderer::parameters(Matrix camera_matrix, int n_rows, int n_cols)
 {
     camera_matrix_ = camera_matrix;
@@ -308,6 +733,56 @@ void RigidBodyRenderer::parameters(Matrix camera_matrix, int n_rows, int n_cols)
     n_cols_ = n_cols;
 }
 
+void RigidBodyRenderer::levels_of_detail(const std::shared_ptr<const MeshLevels>& levels,
+                                         double tolerance)
+{
+    levels_ = levels;
+    level_tolerance_ = tolerance;
+    level_ = 0;
+
+    // the full mesh and its normals are the ones set up in init()
+    meshes_.resize(1);
+    normals_.resize(1);
+    for(int level = 1; levels_ && level < levels_->count_levels(); level++)
+    {
+        meshes_.push_back(GeometryRegistry::instance().flat_mesh(levels_->vertices(level), levels_->triangle_indices(level)));
+        normals_.push_back(shared_normals(meshes_.back()));
+    }
+}
+
+int RigidBodyRenderer::select_level(const std::vector<Vector>& translations,
+                                    const Matrix& camera_matrix)
+{
+    if(!levels_)
+        return level_;
+
+    const double focal_length = std::max(camera_matrix(0, 0), camera_matrix(1, 1));
+    level_ = levels_->select(translations, focal_length, level_tolerance_);
+
+    return level_;
+}
+
+int RigidBodyRenderer::level() const
+{
+    return level_;
+}
+
+int RigidBodyRenderer::count_levels() const
+{
+    return meshes_.size();
+}
+
+const FlatMesh& RigidBodyRenderer::active_mesh() const
+{
+    return *meshes_[level_];
+}
+
+const std::vector<RigidBodyRenderer::Vector>&
+RigidBodyRenderer::active_normals() const
+{
+    return *normals_[level_];
+}
+
 
 
 // test the enchilada
@@ -20,6 +20,10 @@
 
 #include <osr/rigid_bodies_state.hpp>
 
+#include <dbot/flat_mesh.hpp>
+#include <dbot/mesh_levels.hpp>
+#include <dbot/thread_pool.hpp>
+
 namespace dbot
 {
 class RigidBodyRenderer
@@ -31,15 +35,48 @@ public:
     typedef Eigen::Matrix3d Matrix;
     typedef typename Eigen::Transform<double, 3, Eigen::Affine> Affine;
 
+    /**
+     * \brief Intermediate buffers of a render call. Callers rendering
+     *        repeatedly may keep a buffer per thread to avoid reallocating
+     *        the memory on every call.
+     */
+    struct Buffer
+    {
+        std::vector<Vector> trans_vertices;
+        std::vector<Eigen::Vector2d> image_vertices;
+        std::vector<float> roi_depth;
+    };
+
+    /**
+     * \param thread_pool  Threads computing the normals of the parts and
+     *                     rendering batches of poses, see thread_pool()
+     */
     RigidBodyRenderer(
         const std::vector<std::vector<Eigen::Vector3d>>& vertices,
-        const std::vector<std::vector<std::vector<int>>>& indices);
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
-    RigidBodyRenderer(const std::vector<std::vector<Eigen::Vector3d>>& vertices,
-                      const std::vector<std::vector<std::vector<int>>>& indices,
-                      Matrix camera_matrix,
-                      int n_rows,
-                      int n_cols);
+    RigidBodyRenderer(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        Matrix camera_matrix,
+        int n_rows,
+        int n_cols,
+        const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
+
+    /**
+     * \brief Renders the shared mesh without copying it
+     */
+    RigidBodyRenderer(
+        const std::shared_ptr<const FlatMesh>& mesh,
+        const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
+
+    RigidBodyRenderer(
+        const std::shared_ptr<const FlatMesh>& mesh,
+        Matrix camera_matrix,
+        int n_rows,
+        int n_cols,
+        const std::shared_ptr<ThreadPool>& thread_pool = nullptr);
 
     virtual ~RigidBodyRenderer();
 
@@ -56,6 +93,79 @@ public:
 
     void Render(std::vector<float>& depth_image) const;
 
+    /**
+     * \brief Renders the parts in each of the given poses with the camera
+     *        set via parameters() into one depth image per pose. Pixels not
+     *        covered by any part are infinite. The poses set via set_poses()
+     *        are not touched. The default implementation distributes the
+     *        poses over the threads of the pool set via thread_pool(),
+     *        subclasses may render them in one batch.
+     *
+     * \param poses [pose_nr][part_nr] = {pose of that part}
+     * \param depth_images [pose_nr][pixel_nr] = {depth}
+     */
+    virtual void Render(const std::vector<std::vector<Affine>>& poses,
+                        std::vector<std::vector<float>>& depth_images);
+
+    /**
+     * \brief Renders the parts at the given poses without touching the poses
+     *        set via set_poses(). Since no state of the renderer is modified,
+     *        this may be called concurrently from multiple threads.
+     */
+    void Render(const std::vector<Matrix>& rotations,
+                const std::vector<Vector>& translations,
+                Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                std::vector<int>& intersect_indices,
+                std::vector<float>& depth) const;
+
+    void Render(const std::vector<Matrix>& rotations,
+                const std::vector<Vector>& translations,
+                Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                std::vector<float>& depth_image) const;
+
+    /**
+     * \brief Renders the parts at the given poses with the camera set via
+     *        parameters(). This may be called concurrently.
+     */
+    void Render(const std::vector<Matrix>& rotations,
+                const std::vector<Vector>& translations,
+                std::vector<float>& depth_image) const;
+
+    /**
+     * \brief Renders only the bounding box of the projected object into the
+     *        region of interest buffer of \a buffer and returns the covered
+     *        pixels in row major order. The cost scales with the footprint of
+     *        the object instead of the camera resolution.
+     */
+    void Render(const std::vector<Matrix>& rotations,
+                const std::vector<Vector>& translations,
+                Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                std::vector<int>& intersect_indices,
+                std::vector<float>& depth,
+                Buffer& buffer) const;
+
+    /**
+     * \brief Renders the part \a part alone at its pose in \a rotations and
+     *        \a translations, the poses of the other parts are ignored.
+     *        Compositing the pixels of all parts by their minimum depth
+     *        yields the exact result of rendering the parts together.
+     */
+    void Render(int part,
+                const std::vector<Matrix>& rotations,
+                const std::vector<Vector>& translations,
+                Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                std::vector<int>& intersect_indices,
+                std::vector<float>& depth,
+                Buffer& buffer) const;
+
     template <typename RigidbodyState>
     void Render(const RigidbodyState& state, std::vector<float>& depth_vector)
 
@@ -128,22 +238,130 @@ public:
 
     void parameters(Matrix camera_matrix, int n_rows, int n_cols);
 
+    /**
+     * \brief Enables skipping triangles facing away from the camera. This
+     *        leaves the rendered depth unchanged for closed meshes whose
+     *        triangles are ordered counterclockwise seen from the outside.
+     */
+    void back_face_culling(bool enabled);
+    bool back_face_culling() const;
+
+    /**
+     * \brief Sets the threads rendering batches of poses, see Render(). A
+     *        null pool renders them in the calling thread.
+     */
+    void thread_pool(const std::shared_ptr<ThreadPool>& pool);
+
+    /**
+     * \brief Sets the levels of detail select_level() chooses from. The first
+     *        level must be the mesh passed to the constructor.
+     *
+     * \param tolerance  Largest projected error of a selected level in pixels
+     */
+    void levels_of_detail(const std::shared_ptr<const MeshLevels>& levels,
+                          double tolerance);
+
+    /**
+     * \brief Selects the mesh rendered by all following calls, which is the
+     *        coarsest level whose error projected at the given positions of
+     *        the parts stays below the tolerance. This must not be called
+     *        concurrently with Render().
+     *
+     * \return the selected level
+     */
+    int select_level(const std::vector<Vector>& translations,
+                     const Matrix& camera_matrix);
+
+    /** \return the currently rendered level, 0 is the full mesh */
+    int level() const;
+
+    /** \return the number of levels of detail including the full mesh */
+    int count_levels() const;
+
 private:
     /**
      * Because c++0x on gcc.4.6 does not implement delegating constructors
      */
     void init();
 
+    /**
+     * \brief Computes the normal of each triangle, the parts concurrently on
+     *        the thread pool, and exits if a triangle is degenerate
+     */
+    void compute_normals(const FlatMesh& mesh,
+                         std::vector<Vector>& normals) const;
+
+    /**
+     * \brief The normals of \a mesh, computed once for all renderers of the
+     *        mesh, see GeometryRegistry
+     */
+    std::shared_ptr<const std::vector<Vector>> shared_normals(
+        const std::shared_ptr<const FlatMesh>& mesh) const;
+
+    /** \brief The mesh of the selected level and its triangle normals */
+    const FlatMesh& active_mesh() const;
+    const std::vector<Vector>& active_normals() const;
+
+    /**
+     * \brief Renders the parts [\a first_part, \a end_part) within their
+     *        region of interest, see Render()
+     */
+    void render_parts(const std::vector<Matrix>& rotations,
+                      const std::vector<Vector>& translations,
+                      const Matrix& camera_matrix,
+                      int n_rows,
+                      int n_cols,
+                      int first_part,
+                      int end_part,
+                      std::vector<int>& intersect_indices,
+                      std::vector<float>& depth,
+                      Buffer& buffer) const;
+
+    /**
+     * \brief Transforms the vertices of the parts [\a first_part,
+     *        \a end_part) into the camera frame and projects them into the
+     *        image
+     */
+    void project(const std::vector<Matrix>& rotations,
+                 const std::vector<Vector>& translations,
+                 const Matrix& camera_matrix,
+                 int first_part,
+                 int end_part,
+                 Buffer& buffer) const;
+
+    /**
+     * \brief Rasterizes the projected triangles of the parts [\a first_part,
+     *        \a end_part) into the region of interest image \a depth_image
+     *        of size \a roi_rows x \a roi_cols starting at (\a roi_row,
+     *        \a roi_col).
+     */
+    void rasterize(const std::vector<Matrix>& rotations,
+                   const Matrix& camera_matrix,
+                   int first_part,
+                   int end_part,
+                   int roi_row,
+                   int roi_col,
+                   int roi_rows,
+                   int roi_cols,
+                   const Buffer& buffer,
+                   float* depth_image) const;
+
     // protected:
 public:
     Matrix camera_matrix_;
     int n_rows_;
     int n_cols_;
+    bool back_face_culling_;
 
-    // triangles
-    std::vector<std::vector<Vector>> vertices_;
-    std::vector<std::vector<Vector>> normals_;
-    std::vector<std::vector<std::vector<int>>> indices_;
+    // triangles and their normals [level][triangle_nr] of all levels of
+    // detail, level 0 is the full mesh
+    std::vector<std::shared_ptr<const FlatMesh>> meshes_;
+    std::vector<std::shared_ptr<const std::vector<Vector>>> normals_;
+
+    // levels of detail
+    std::shared_ptr<const MeshLevels> levels_;
+    double level_tolerance_;
+    int level_;
 
     // state
     std::vector<Matrix> R_;
@@ -151,6 +369,9 @@ public:
 
     // cached center of mass
     std::vector<Vector> coms_;
+
+    // threads rendering batches of poses
+    std::shared_ptr<ThreadPool> thread_pool_;
     std::vector<float> com_weights_;
 };
 }
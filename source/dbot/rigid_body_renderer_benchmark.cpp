@@ -0,0 +1,91 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+
+/**
+ * \brief Renders a batch of poses jittered around the pose of the scene.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, number of poses,
+ * latitude bands of the sphere
+ */
+static void BM_RigidBodyRenderer_Render(benchmark::State& state)
+{
+    const int downsampling = state.range(0);
+    const int pose_count = state.range(1);
+    const int rings = state.range(2);
+
+    auto loader = std::make_shared<dbot::SyntheticObjectLoader>(1, rings);
+    dbot::ObjectModel object_model(loader, false);
+    auto pose = dbot::SyntheticCameraDataProvider::poses(1)[0];
+    dbot::VirtualCameraDataProvider camera(downsampling, "/camera");
+    const int n_rows = camera.native_resolution().height / downsampling;
+    const int n_cols = camera.native_resolution().width / downsampling;
+
+    dbot::RigidBodyRenderer renderer(object_model.flat_mesh());
+
+    std::mt19937 generator(0);
+    std::normal_distribution<double> noise(0., 0.005);
+    std::vector<std::vector<Eigen::Matrix3d>> rotations(pose_count);
+    std::vector<std::vector<Eigen::Vector3d>> translations(pose_count);
+    for (int i = 0; i < pose_count; ++i)
+    {
+        rotations[i].push_back(pose.rotation());
+        translations[i].push_back(
+            pose.translation() +
+            Eigen::Vector3d(noise(generator), noise(generator), 0.));
+    }
+
+    std::vector<int> intersect_indices;
+    std::vector<float> depth;
+    dbot::RigidBodyRenderer::Buffer buffer;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < pose_count; ++i)
+        {
+            renderer.Render(rotations[i],
+                            translations[i],
+                            camera.camera_matrix(),
+                            n_rows,
+                            n_cols,
+                            intersect_indices,
+                            depth,
+                            buffer);
+            benchmark::DoNotOptimize(depth.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * pose_count);
+}
+
+BENCHMARK(BM_RigidBodyRenderer_Render)
+    ->ArgNames({"downsampling", "poses", "rings"})
+    ->Args({1, 100, 16})
+    ->Args({1, 100, 64})
+    ->Args({2, 100, 16})
+    ->Args({2, 100, 64})
+    ->Args({4, 100, 16})
+    ->Args({4, 1000, 16})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,337 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/rasterize_span.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+
+using dbot::RigidBodyRenderer;
+using dbot::internal::SpanInstructions;
+
+class RigidBodyRendererTests : public testing::Test
+{
+protected:
+    typedef RigidBodyRenderer::Matrix Matrix;
+    typedef RigidBodyRenderer::Vector Vector;
+
+    RigidBodyRendererTests() : n_rows_(60), n_cols_(80), generator_(0)
+    {
+        camera_matrix_ << 90, 0, 40, 0, 90, 30, 0, 0, 1;
+        dbot::SyntheticObjectLoader(2, 6).load(vertices_, indices_);
+    }
+
+    /**
+     * \brief Random poses of the parts around the optical axis, partially
+     *        leaving the image
+     */
+    void random_poses(std::vector<Matrix>& rotations,
+                      std::vector<Vector>& translations)
+    {
+        std::normal_distribution<double> normal(0., 1.);
+        std::uniform_real_distribution<double> uniform(-1., 1.);
+
+        rotations.resize(vertices_.size());
+        translations.resize(vertices_.size());
+        for (size_t part = 0; part < vertices_.size(); ++part)
+        {
+            rotations[part] =
+                Eigen::Quaterniond(normal(generator_),
+                                   normal(generator_),
+                                   normal(generator_),
+                                   normal(generator_))
+                    .normalized()
+                    .toRotationMatrix();
+            translations[part] = Vector(0.2 * uniform(generator_),
+                                        0.15 * uniform(generator_),
+                                        0.6 + 0.3 * uniform(generator_));
+        }
+    }
+
+    /**
+     * \brief Renders by intersecting the ray through each pixel with every
+     *        triangle in front of the camera. Pixels closer than \a margin
+     *        pixels to the border of any such triangle are marked in
+     *        \a ambiguous since their coverage depends on the rounding.
+     */
+    void ray_cast(const std::vector<Matrix>& rotations,
+                  const std::vector<Vector>& translations,
+                  bool back_face_culling,
+                  double margin,
+                  std::vector<double>& depth,
+                  std::vector<bool>& ambiguous) const
+    {
+        depth.assign(n_rows_ * n_cols_,
+                     std::numeric_limits<double>::infinity());
+        ambiguous.assign(n_rows_ * n_cols_, false);
+
+        const Matrix inv_camera_matrix = camera_matrix_.inverse();
+        for (size_t part = 0; part < vertices_.size(); ++part)
+        {
+            for (const auto& triangle : indices_[part])
+            {
+                Vector v[3];
+                Eigen::Vector2d p[3];
+                bool behind = false;
+                for (int k = 0; k < 3; ++k)
+                {
+                    v[k] = rotations[part] * vertices_[part][triangle[k]] +
+                           translations[part];
+                    p[k] = (camera_matrix_ * v[k] / v[k](2)).topRows(2);
+                    behind |= v[k](2) < 0.001;
+                }
+                const Vector normal = (v[1] - v[0]).cross(v[2] - v[1]);
+                if (behind || (back_face_culling && normal.dot(v[0]) > 0))
+                {
+                    continue;
+                }
+
+                for (int row = 0; row < n_rows_; ++row)
+                {
+                    for (int col = 0; col < n_cols_; ++col)
+                    {
+                        const int pixel = row * n_cols_ + col;
+                        const Eigen::Vector2d x(col, row);
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            if (distance(x, p[k], p[(k + 1) % 3]) < margin)
+                            {
+                                ambiguous[pixel] = true;
+                            }
+                        }
+
+                        // Moeller-Trumbore with the ray from the camera
+                        // center, whose direction has a z of one such that
+                        // its parameter is the depth
+                        const Vector ray = inv_camera_matrix * Vector(col, row, 1);
+                        const Vector e1 = v[1] - v[0];
+                        const Vector e2 = v[2] - v[0];
+                        const Vector h = ray.cross(e2);
+                        const double det = e1.dot(h);
+                        if (det == 0) continue;
+
+                        const Vector s = -v[0];
+                        const double u = s.dot(h) / det;
+                        const Vector q = s.cross(e1);
+                        const double w = ray.dot(q) / det;
+                        const double t = e2.dot(q) / det;
+                        if (u >= 0 && w >= 0 && u + w <= 1 && t > 0)
+                        {
+                            depth[pixel] = std::min(depth[pixel], t);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /** \return the distance of \a x to the segment from \a a to \a b */
+    static double distance(const Eigen::Vector2d& x,
+                           const Eigen::Vector2d& a,
+                           const Eigen::Vector2d& b)
+    {
+        const Eigen::Vector2d ab = b - a;
+        const double length = ab.squaredNorm();
+        const double f =
+            length > 0 ? std::max(0., std::min(1., (x - a).dot(ab) / length))
+                       : 0.;
+        return (x - a - f * ab).norm();
+    }
+
+    int n_rows_;
+    int n_cols_;
+    Matrix camera_matrix_;
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+    std::mt19937 generator_;
+};
+
+TEST_F(RigidBodyRendererTests, region_of_interest_equals_the_full_image)
+{
+    RigidBodyRenderer renderer(vertices_, indices_);
+    RigidBodyRenderer::Buffer buffer;
+
+    size_t covered = 0;
+    for (int trial = 0; trial < 50; ++trial)
+    {
+        std::vector<Matrix> rotations;
+        std::vector<Vector> translations;
+        random_poses(rotations, translations);
+
+        std::vector<float> image;
+        renderer.Render(
+            rotations, translations, camera_matrix_, n_rows_, n_cols_, image);
+
+        // the buffer is reused across the trials
+        std::vector<int> indices;
+        std::vector<float> depths;
+        renderer.Render(rotations,
+                        translations,
+                        camera_matrix_,
+                        n_rows_,
+                        n_cols_,
+                        indices,
+                        depths,
+                        buffer);
+
+        ASSERT_EQ(indices.size(), depths.size());
+        covered += indices.size();
+        std::vector<float> roi_image(n_rows_ * n_cols_,
+                                     std::numeric_limits<float>::infinity());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            // row major order without duplicates
+            if (i > 0) ASSERT_LT(indices[i - 1], indices[i]);
+            roi_image[indices[i]] = depths[i];
+        }
+
+        // bit for bit, including the uncovered pixels
+        EXPECT_EQ(roi_image, image) << "trial " << trial;
+    }
+
+    // the objects are in view most of the time
+    EXPECT_GT(covered, 50u * 100u);
+}
+
+TEST_F(RigidBodyRendererTests, equals_ray_casting)
+{
+    RigidBodyRenderer renderer(vertices_, indices_);
+
+    for (bool back_face_culling : {false, true})
+    {
+        renderer.back_face_culling(back_face_culling);
+
+        size_t covered = 0;
+        size_t ambiguous_count = 0;
+        for (int trial = 0; trial < 20; ++trial)
+        {
+            std::vector<Matrix> rotations;
+            std::vector<Vector> translations;
+            random_poses(rotations, translations);
+
+            std::vector<float> image;
+            renderer.Render(rotations,
+                            translations,
+                            camera_matrix_,
+                            n_rows_,
+                            n_cols_,
+                            image);
+
+            std::vector<double> reference;
+            std::vector<bool> ambiguous;
+            ray_cast(rotations,
+                     translations,
+                     back_face_culling,
+                     1e-3,
+                     reference,
+                     ambiguous);
+
+            for (int i = 0; i < n_rows_ * n_cols_; ++i)
+            {
+                if (ambiguous[i])
+                {
+                    ++ambiguous_count;
+                    continue;
+                }
+
+                ASSERT_EQ(std::isinf(image[i]), std::isinf(reference[i]))
+                    << "trial " << trial << ", pixel " << i;
+                if (std::isinf(reference[i])) continue;
+
+                ++covered;
+                EXPECT_NEAR(image[i], reference[i], 1e-5 * reference[i])
+                    << "trial " << trial << ", pixel " << i;
+            }
+        }
+
+        EXPECT_GT(covered, 20u * 100u);
+        EXPECT_LT(ambiguous_count, covered / 100);
+    }
+}
+
+TEST_F(RigidBodyRendererTests, span_instructions_are_identical)
+{
+    std::vector<SpanInstructions> supported;
+    for (auto instructions : {SpanInstructions::Scalar,
+                              SpanInstructions::SSE2,
+                              SpanInstructions::AVX})
+    {
+        if (dbot::internal::span_instructions_supported(instructions))
+        {
+            supported.push_back(instructions);
+        }
+    }
+    EXPECT_TRUE(dbot::internal::span_instructions_supported(
+        dbot::internal::best_span_instructions()));
+#if defined(__SSE2__)
+    EXPECT_GE(supported.size(), 2u);
+#endif
+
+    std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+    for (int trial = 0; trial < 2000; ++trial)
+    {
+        // all lengths around the vector widths, edges crossing the span and
+        // depths partially in front of the previous ones
+        const int count = trial % 41;
+        float edge[3], edge_step[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            edge_step[k] = uniform(generator_);
+            edge[k] = 10.f * uniform(generator_) - 0.5f * count * edge_step[k];
+        }
+        const float inv_depth = 1.5f + 0.5f * uniform(generator_);
+        const float inv_depth_step = 0.01f * uniform(generator_);
+
+        std::vector<float> initial(count);
+        for (auto& d : initial)
+        {
+            d = trial % 3 == 0 ? std::numeric_limits<float>::infinity()
+                               : 0.7f + 0.1f * uniform(generator_);
+        }
+
+        std::vector<float> expected = initial;
+        dbot::internal::rasterize_span(SpanInstructions::Scalar,
+                                       expected.data(),
+                                       count,
+                                       edge,
+                                       edge_step,
+                                       inv_depth,
+                                       inv_depth_step);
+        for (auto instructions : supported)
+        {
+            std::vector<float> depth = initial;
+            dbot::internal::rasterize_span(instructions,
+                                           depth.data(),
+                                           count,
+                                           edge,
+                                           edge_step,
+                                           inv_depth,
+                                           inv_depth_step);
+            ASSERT_EQ(depth, expected) << "instructions "
+                                       << int(instructions) << ", trial "
+                                       << trial;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file seq_lock.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+
+namespace dbot
+{
+/**
+ * \brief Fixed number of doubles published by one writer to any number of
+ *        readers without locking.
+ *
+ * The writer never waits for readers. A reader copies the values and
+ * retries if the writer published in the meantime, hence it only ever waits
+ * for the duration of a single publication. The values are stored as relaxed
+ * atomics, which keeps concurrent copies free of data races.
+ */
+class SeqLock
+{
+public:
+    explicit SeqLock(int size)
+        : size_(size), sequence_(0), values_(new std::atomic<double>[size])
+    {
+        for (int i = 0; i < size_; ++i)
+        {
+            values_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    int size() const { return size_; }
+
+    /**
+     * \brief Publishes values[0, size()). Writer only.
+     */
+    template <typename Values>
+    void write(const Values& values)
+    {
+        const std::uint64_t sequence =
+            sequence_.load(std::memory_order_relaxed);
+
+        // an odd sequence marks a publication in progress
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < size_; ++i)
+        {
+            values_[i].store(values[i], std::memory_order_relaxed);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * \brief Copies a consistent snapshot into values[0, size())
+     *
+     * \return the number of publications preceding the snapshot
+     */
+    template <typename Values>
+    std::uint64_t read(Values& values) const
+    {
+        while (true)
+        {
+            const std::uint64_t before =
+                sequence_.load(std::memory_order_acquire);
+
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (int i = 0; i < size_; ++i)
+            {
+                values[i] = values_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before)
+            {
+                return before / 2;
+            }
+        }
+    }
+
+private:
+    const int size_;
+    std::atomic<std::uint64_t> sequence_;
+    std::unique_ptr<std::atomic<double>[]> values_;
+};
+}
@@ -0,0 +1,72 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file seq_lock_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <dbot/seq_lock.hpp>
+
+using dbot::SeqLock;
+
+TEST(SeqLockTests, read_returns_the_last_write)
+{
+    SeqLock lock(3);
+    std::vector<double> values(3);
+
+    EXPECT_EQ(lock.read(values), 0);
+
+    lock.write(std::vector<double>{1, 2, 3});
+    EXPECT_EQ(lock.read(values), 1);
+    EXPECT_EQ(values, std::vector<double>({1, 2, 3}));
+}
+
+TEST(SeqLockTests, concurrent_reads_are_never_torn)
+{
+    const int size = 64;
+    SeqLock lock(size);
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]()
+                       {
+                           std::vector<double> values(size);
+                           for (int i = 1; i <= 20000; ++i)
+                           {
+                               values.assign(size, i);
+                               lock.write(values);
+                           }
+                           done = true;
+                       });
+
+    std::vector<double> values(size);
+    std::uint64_t last = 0;
+    while (!done)
+    {
+        const std::uint64_t sequence = lock.read(values);
+        EXPECT_GE(sequence, last);
+        last = sequence;
+
+        for (int i = 1; i < size; ++i) ASSERT_EQ(values[i], values[0]);
+        ASSERT_EQ(values[0], double(sequence));
+    }
+
+    writer.join();
+}
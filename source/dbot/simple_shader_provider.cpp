@@ -26,10 +26,12 @@ namespace dbot
 SimpleShaderProvider::SimpleShaderProvider(
     const std::string& fragment_shader_src,
     const std::string& vertex_shader_src,
-    const std::string& geometry_shader_src)
+    const std::string& geometry_shader_src,
+    const std::string& compute_shader_src)
     : fragment_shader_(fragment_shader_src),
       vertex_shader_(vertex_shader_src),
-      geometry_shader_(geometry_shader_src)
+      geometry_shader_(geometry_shader_src),
+      compute_shader_(compute_shader_src)
 {
 }
 
@@ -51,4 +53,14 @@ bool SimpleShaderProvider::has_geometry_shader() const
 {
     return !geometry_shader_.empty();
 }
+
+std::string SimpleShaderProvider::compute_shader() const
+{
+    return compute_shader_;
+}
+
+bool SimpleShaderProvider::has_compute_shader() const
+{
+    return !compute_shader_.empty();
+}
 }
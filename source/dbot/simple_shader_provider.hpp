@@ -42,10 +42,13 @@ public:
      *          Required vertex shader code
      * \param geometry_shader_src
      *          Optional geometry shader code
+     * \param compute_shader_src
+     *          Optional compute shader code
      */
     SimpleShaderProvider(const std::string& fragment_shader_src,
                          const std::string& vertex_shader_src,
-                         const std::string& geometry_shader_src = "");
+                         const std::string& geometry_shader_src = "",
+                         const std::string& compute_shader_src = "");
 
     /**
      * \brief Returns the fragment shader source code
@@ -68,9 +71,21 @@ public:
      */
     bool has_geometry_shader() const;
 
+    /**
+     * \brief Returns the compute shader source code
+     */
+    std::string compute_shader() const;
+
+    /**
+     * \brief Returns whether the current shader provider provides a compute
+     *        shader definition
+     */
+    bool has_compute_shader() const;
+
 protected:
     std::string fragment_shader_;
     std::string vertex_shader_;
     std::string geometry_shader_;
+    std::string compute_shader_;
 };
 }
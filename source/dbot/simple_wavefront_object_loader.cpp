@@ -17,13 +17,22 @@
  * \author Jan Issac (jan.issac@gmail.com)
  */
 
+#include <mutex>
+#include <utility>
+#include <exception>
+#include <algorithm>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <dbot/mesh_cache.hpp>
 #include <dbot/simple_wavefront_object_loader.hpp>
 
 namespace dbot
 {
 SimpleWavefrontObjectModelLoader::SimpleWavefrontObjectModelLoader(
-    const ObjectResourceIdentifier& ori)
-    : ori_(ori)
+    const ObjectResourceIdentifier& ori,
+    bool use_cache)
+    : ori_(ori), use_cache_(use_cache)
 {
 }
 
@@ -31,17 +40,87 @@ void SimpleWavefrontObjectModelLoader::load(
     std::vector<std::vector<Eigen::Vector3d>>& vertices,
     std::vector<std::vector<std::vector<int>>>& triangle_indices) const
 {
-    vertices.resize(ori_.count_meshes());
-    triangle_indices.resize(ori_.count_meshes());
+    const int mesh_count = ori_.count_meshes();
+    vertices.resize(mesh_count);
+    triangle_indices.resize(mesh_count);
+
+    // starting with the largest meshes keeps the loading time close to the
+    // one of the largest mesh
+    std::vector<std::pair<boost::uintmax_t, int>> order(mesh_count);
+    for (int i = 0; i < mesh_count; i++)
+    {
+        boost::system::error_code error;
+        order[i].first =
+            boost::filesystem::file_size(ori_.mesh_path(i), error);
+        if (error) order[i].first = 0;
+        order[i].second = i;
+    }
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [](const std::pair<boost::uintmax_t, int>& a,
+                        const std::pair<boost::uintmax_t, int>& b)
+                     {
+                         return a.first > b.first;
+                     });
 
-    for (size_t i = 0; i < ori_.count_meshes(); i++)
+    // exceptions must not escape the worker threads, the first one is
+    // rethrown once all meshes have been processed
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto load_mesh = [&](int k, int thread_index)
     {
-        ObjectFileReader file_reader;
-        file_reader.set_filename(ori_.mesh_path(i));
-        file_reader.Read();
+        const int i = order[k].second;
+        try
+        {
+            load(ori_.mesh_path(i), vertices[i], triangle_indices[i]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
 
-        vertices[i] = *file_reader.get_vertices();
-        triangle_indices[i] = *file_reader.get_indices();
+    if (thread_pool_)
+    {
+        thread_pool_->parallel_for(mesh_count, load_mesh);
     }
+    else
+    {
+        for (int k = 0; k < mesh_count; k++) load_mesh(k, 0);
+    }
+
+    if (error) std::rethrow_exception(error);
+}
+
+void SimpleWavefrontObjectModelLoader::thread_pool(
+    const std::shared_ptr<ThreadPool>& pool)
+{
+    thread_pool_ = pool;
+}
+
+void SimpleWavefrontObjectModelLoader::load(
+    const std::string& path,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<std::vector<int>>& triangle_indices) const
+{
+    if (use_cache_)
+    {
+        auto mesh = MeshCache::load(path);
+        if (mesh)
+        {
+            mesh->copy_to(vertices, triangle_indices);
+            return;
+        }
+    }
+
+    ObjectFileReader file_reader;
+    file_reader.set_filename(path);
+    file_reader.Read();
+
+    vertices = *file_reader.get_vertices();
+    triangle_indices = *file_reader.get_indices();
+
+    if (use_cache_) MeshCache::store(path, vertices, triangle_indices);
 }
 }
@@ -13,6 +13,9 @@
 
 #pragma once
 
+#include <memory>
+
+#include <dbot/thread_pool.hpp>
 #include <dbot/object_file_reader.hpp>
 #include <dbot/object_model_loader.hpp>
 #include <dbot/object_resource_identifier.hpp>
@@ -22,13 +25,33 @@ namespace dbot
 class SimpleWavefrontObjectModelLoader : public ObjectModelLoader
 {
 public:
-    SimpleWavefrontObjectModelLoader(const ObjectResourceIdentifier& ori);
+    /**
+     * \param use_cache  Loads the meshes from their binary caches next to the
+     *                   mesh files if these are up to date and creates or
+     *                   refreshes them otherwise, see MeshCache
+     */
+    SimpleWavefrontObjectModelLoader(const ObjectResourceIdentifier& ori,
+                                     bool use_cache = true);
 
     void load(
         std::vector<std::vector<Eigen::Vector3d>>& vertices,
         std::vector<std::vector<std::vector<int>>>& triangle_indices) const;
 
+    /**
+     * \brief Sets the threads loading the meshes concurrently, largest file
+     *        first. A null pool loads them in the calling thread.
+     */
+    void thread_pool(const std::shared_ptr<ThreadPool>& pool);
+
+private:
+    /** \brief Loads a single mesh from its cache or the mesh file */
+    void load(const std::string& path,
+              std::vector<Eigen::Vector3d>& vertices,
+              std::vector<std::vector<int>>& triangle_indices) const;
+
 private:
     ObjectResourceIdentifier ori_;
+    bool use_cache_;
+    std::shared_ptr<ThreadPool> thread_pool_;
 };
 }
@@ -0,0 +1,78 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file snapshot.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <fstream>
+#include <utility>
+#include <iterator>
+
+#include <dbot/snapshot.hpp>
+#include <dbot/replace_file.hpp>
+
+namespace dbot
+{
+Snapshot::Snapshot()
+{
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::strncpy(header.magic, magic(), 8);
+    header.version = Version;
+    write(header);
+}
+
+Snapshot::Snapshot(std::vector<unsigned char> bytes) : bytes_(std::move(bytes))
+{
+    Header header;
+    if (bytes_.size() < sizeof(header))
+    {
+        throw InvalidSnapshotException("the snapshot is truncated");
+    }
+    std::memcpy(&header, bytes_.data(), sizeof(header));
+
+    if (std::strncmp(header.magic, magic(), 8) != 0)
+    {
+        throw InvalidSnapshotException("not a snapshot");
+    }
+    if (header.version != Version)
+    {
+        throw InvalidSnapshotException("unsupported version " +
+                                       std::to_string(header.version));
+    }
+}
+
+void Snapshot::save(const std::string& path) const
+{
+    if (!replace_file(path, {{bytes_.data(), bytes_.size()}}))
+    {
+        throw InvalidSnapshotException("cannot write " + path);
+    }
+}
+
+Snapshot Snapshot::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw InvalidSnapshotException("cannot open " + path);
+    }
+
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+    return Snapshot(std::move(bytes));
+}
+}
@@ -0,0 +1,267 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file snapshot.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <Eigen/Core>
+
+#include <fl/exception/exception.hpp>
+
+namespace dbot
+{
+class InvalidSnapshotException : public fl::Exception
+{
+public:
+    explicit InvalidSnapshotException(const std::string& reason) : Exception()
+    {
+        info("Reason", reason);
+    }
+
+    virtual std::string name() const noexcept
+    {
+        return "dbot::InvalidSnapshotException";
+    }
+};
+
+/**
+ * \brief Binary state of a tracker, see Tracker::snapshot().
+ *
+ * A snapshot consists of the header followed by the fields in the order
+ * they have been written, all in host byte order. Matrices are stored as
+ * their size followed by their coefficients in column major order. The
+ * fields are not tagged, the reader has to read them in the order of the
+ * writer and checks only the sizes, names and the end of the data.
+ */
+class Snapshot
+{
+public:
+    class Reader;
+
+    enum
+    {
+        Version = 1
+    };
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+    };
+
+    static const char* magic() { return "DBOTSNP"; }
+
+public:
+    /** \brief Empty snapshot consisting of the header */
+    Snapshot();
+
+    /**
+     * \brief Snapshot of the bytes of another one, e.g. received from the
+     *        active process
+     *
+     * \throws InvalidSnapshotException if the header is invalid
+     */
+    explicit Snapshot(std::vector<unsigned char> bytes);
+
+    /**
+     * \brief Writes the snapshot into a temporary file next to \a path which
+     *        then replaces \a path, hence a reader never sees a partially
+     *        written snapshot, see replace_file()
+     *
+     * \throws InvalidSnapshotException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /** \throws InvalidSnapshotException if the file cannot be read */
+    static Snapshot load(const std::string& path);
+
+    const std::vector<unsigned char>& bytes() const { return bytes_; }
+
+    void write(const void* data, std::size_t size)
+    {
+        const unsigned char* begin = static_cast<const unsigned char*>(data);
+        bytes_.insert(bytes_.end(), begin, begin + size);
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only plain values are written as they are");
+        write(&value, sizeof(T));
+    }
+
+    void write_string(const std::string& value)
+    {
+        write<std::uint64_t>(value.size());
+        write(value.data(), value.size());
+    }
+
+    template <typename T>
+    void write_vector(const std::vector<T>& values)
+    {
+        write<std::uint64_t>(values.size());
+        write(values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename Derived>
+    void write_matrix(const Eigen::DenseBase<Derived>& matrix)
+    {
+        typedef typename Derived::Scalar Scalar;
+
+        write<std::uint8_t>(sizeof(Scalar));
+        write<std::uint64_t>(matrix.rows());
+        write<std::uint64_t>(matrix.cols());
+        for (Eigen::Index j = 0; j < matrix.cols(); ++j)
+        {
+            for (Eigen::Index i = 0; i < matrix.rows(); ++i)
+            {
+                write<Scalar>(matrix(i, j));
+            }
+        }
+    }
+
+private:
+    std::vector<unsigned char> bytes_;
+};
+
+/**
+ * \brief Reads the fields of a Snapshot in the order they have been written.
+ *        Reading past the end throws an InvalidSnapshotException.
+ */
+class Snapshot::Reader
+{
+public:
+    /** \brief Reader of the fields following the header of \a snapshot */
+    explicit Reader(const Snapshot& snapshot)
+        : bytes_(snapshot.bytes()), cursor_(sizeof(Header))
+    {
+    }
+
+    void read(void* data, std::size_t size)
+    {
+        if (size > bytes_.size() - cursor_)
+        {
+            throw InvalidSnapshotException("the snapshot is truncated");
+        }
+        std::memcpy(data, bytes_.data() + cursor_, size);
+        cursor_ += size;
+    }
+
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only plain values are read as they are");
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    std::string read_string()
+    {
+        std::string value(read_size(1), '\0');
+        read(&value[0], value.size());
+        return value;
+    }
+
+    /**
+     * \brief Reads a string and checks that it is \a expected, e.g. the name
+     *        of the tracker which wrote the following fields
+     */
+    void expect(const std::string& expected)
+    {
+        const std::string value = read_string();
+        if (value != expected)
+        {
+            throw InvalidSnapshotException("found " + value + " instead of " +
+                                           expected);
+        }
+    }
+
+    template <typename T>
+    void read_vector(std::vector<T>& values)
+    {
+        values.resize(read_size(sizeof(T)));
+        read(values.data(), values.size() * sizeof(T));
+    }
+
+    /**
+     * \brief Reads a matrix written by Snapshot::write_matrix(). Matrices of
+     *        fixed size have to match the size of the snapshot.
+     */
+    template <typename Derived>
+    void read_matrix(Eigen::PlainObjectBase<Derived>& matrix)
+    {
+        typedef typename Derived::Scalar Scalar;
+
+        if (read<std::uint8_t>() != sizeof(Scalar))
+        {
+            throw InvalidSnapshotException("the scalar type does not match");
+        }
+        const std::uint64_t rows = read<std::uint64_t>();
+        const std::uint64_t cols = read_size(rows * sizeof(Scalar));
+        if ((Derived::RowsAtCompileTime != Eigen::Dynamic &&
+             rows != std::uint64_t(Derived::RowsAtCompileTime)) ||
+            (Derived::ColsAtCompileTime != Eigen::Dynamic &&
+             cols != std::uint64_t(Derived::ColsAtCompileTime)))
+        {
+            throw InvalidSnapshotException("the matrix size does not match");
+        }
+
+        matrix.resize(rows, cols);
+        for (Eigen::Index j = 0; j < matrix.cols(); ++j)
+        {
+            for (Eigen::Index i = 0; i < matrix.rows(); ++i)
+            {
+                matrix(i, j) = read<Scalar>();
+            }
+        }
+    }
+
+    /** \return whether all fields have been read */
+    bool at_end() const { return cursor_ == bytes_.size(); }
+
+private:
+    /** \brief Reads a count of elements of \a element_size bytes each */
+    std::uint64_t read_size(std::uint64_t element_size)
+    {
+        const std::uint64_t size = read<std::uint64_t>();
+        if (element_size > 0 &&
+            size > (bytes_.size() - cursor_) / element_size)
+        {
+            throw InvalidSnapshotException("the snapshot is truncated");
+        }
+        return size;
+    }
+
+private:
+    const std::vector<unsigned char>& bytes_;
+    std::size_t cursor_;
+};
+
+static_assert(sizeof(Snapshot::Header) == 16,
+              "the snapshot header must not be padded");
+}
@@ -0,0 +1,140 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file snapshot_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/snapshot.hpp>
+
+using dbot::Snapshot;
+using dbot::InvalidSnapshotException;
+
+static Snapshot create_snapshot()
+{
+    Eigen::MatrixXd covariance(3, 2);
+    covariance << 1, 2, 3, 4, 5, 6;
+
+    Snapshot snapshot;
+    snapshot.write_string("Tracker");
+    snapshot.write<double>(0.25);
+    snapshot.write_matrix(covariance);
+    snapshot.write_matrix(Eigen::Vector3f(1.f, 2.f, 3.f));
+    snapshot.write_vector(std::vector<unsigned char>{7, 8, 9});
+    return snapshot;
+}
+
+TEST(SnapshotTests, fields_are_read_in_the_order_of_writing)
+{
+    const Snapshot snapshot(create_snapshot().bytes());
+    Snapshot::Reader reader(snapshot);
+
+    reader.expect("Tracker");
+    EXPECT_EQ(reader.read<double>(), 0.25);
+
+    Eigen::MatrixXd covariance;
+    reader.read_matrix(covariance);
+    ASSERT_EQ(covariance.rows(), 3);
+    ASSERT_EQ(covariance.cols(), 2);
+    EXPECT_EQ(covariance(2, 1), 6);
+
+    Eigen::Vector3f vector;
+    reader.read_matrix(vector);
+    EXPECT_EQ(vector(2), 3.f);
+
+    std::vector<unsigned char> bytes;
+    reader.read_vector(bytes);
+    EXPECT_EQ(bytes, (std::vector<unsigned char>{7, 8, 9}));
+    EXPECT_TRUE(reader.at_end());
+}
+
+TEST(SnapshotTests, mismatching_fields_throw)
+{
+    const Snapshot snapshot = create_snapshot();
+    {
+        Snapshot::Reader reader(snapshot);
+        EXPECT_THROW(reader.expect("GaussianTracker"),
+                     InvalidSnapshotException);
+    }
+    {
+        Snapshot::Reader reader(snapshot);
+        reader.read_string();
+        reader.read<double>();
+
+        // a matrix of fixed size has to match in size and scalar type
+        Eigen::Matrix3d fixed;
+        EXPECT_THROW(reader.read_matrix(fixed), InvalidSnapshotException);
+    }
+
+    // truncated snapshots and other files are rejected
+    std::vector<unsigned char> bytes = snapshot.bytes();
+    bytes.resize(bytes.size() - 2);
+    const Snapshot truncated(bytes);
+    Snapshot::Reader reader(truncated);
+    reader.read_string();
+    reader.read<double>();
+    Eigen::MatrixXd covariance;
+    reader.read_matrix(covariance);
+    Eigen::Vector3f vector;
+    reader.read_matrix(vector);
+    std::vector<unsigned char> tail;
+    EXPECT_THROW(reader.read_vector(tail), InvalidSnapshotException);
+
+    bytes[0] = 'X';
+    EXPECT_THROW(Snapshot snapshot(bytes), InvalidSnapshotException);
+}
+
+TEST(SnapshotTests, saved_snapshot_replaces_the_file)
+{
+    const std::string path =
+        (boost::filesystem::temp_directory_path() /
+         boost::filesystem::unique_path("dbot-%%%%-%%%%.snapshot"))
+            .string();
+    {
+        std::ofstream file(path);
+        file << "previous";
+    }
+
+    const Snapshot snapshot = create_snapshot();
+    snapshot.save(path);
+
+    EXPECT_EQ(Snapshot::load(path).bytes(), snapshot.bytes());
+
+    // no temporary file is left behind next to the snapshot
+    int files = 0;
+    const auto directory = boost::filesystem::path(path).parent_path();
+    const auto name = boost::filesystem::path(path).filename().string();
+    for (boost::filesystem::directory_iterator it(directory), end; it != end;
+         ++it)
+    {
+        files += it->path().filename().string().compare(
+                     0, name.size(), name) == 0;
+    }
+    EXPECT_EQ(files, 1);
+
+    // unwritable locations throw
+    EXPECT_THROW(snapshot.save("/nonexistent/directory/tracker.snapshot"),
+                 InvalidSnapshotException);
+
+    std::remove(path.c_str());
+    EXPECT_THROW(Snapshot::load(path), InvalidSnapshotException);
+}
@@ -0,0 +1,101 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file spsc_ring.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace dbot
+{
+/**
+ * \brief Bounded lock-free queue between exactly one producer thread and
+ *        one consumer thread.
+ *
+ * The producer only writes the tail and the consumer only writes the head,
+ * hence neither ever waits for the other. One slot is kept free to tell a
+ * full ring from an empty one.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t capacity)
+        : slots_(capacity + 1), head_(0), tail_(0)
+    {
+    }
+
+    /**
+     * \brief Appends the item unless the ring is full. Producer only.
+     * \return whether the item has been appended
+     */
+    bool try_push(T&& item)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t next = advance(tail);
+        if (next == head_.load(std::memory_order_acquire)) return false;
+
+        slots_[tail] = std::move(item);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Removes the oldest item unless the ring is empty. Consumer only.
+     * \return whether an item has been removed
+     */
+    bool try_pop(T& item)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+
+        item = std::move(slots_[head]);
+        slots_[head] = T();
+        head_.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \return the number of queued items. Exact only if called by the
+     *         producer or the consumer while the other one is idle.
+     */
+    std::size_t size() const
+    {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+        return tail >= head ? tail - head : tail + slots_.size() - head;
+    }
+
+    std::size_t capacity() const { return slots_.size() - 1; }
+
+private:
+    std::size_t advance(std::size_t index) const
+    {
+        return index + 1 == slots_.size() ? 0 : index + 1;
+    }
+
+private:
+    std::vector<T> slots_;
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+};
+}
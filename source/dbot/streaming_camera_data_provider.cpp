@@ -0,0 +1,227 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file streaming_camera_data_provider.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <chrono>
+#include <limits>
+
+#include <dbot/streaming_camera_data_provider.hpp>
+
+namespace dbot
+{
+StreamingCameraDataProvider::StreamingCameraDataProvider(
+    const std::string& frame_id,
+    const Eigen::Matrix3d& camera_matrix,
+    const CameraData::Resolution& native_resolution,
+    int downsampling_factor,
+    int capacity,
+    DepthPreprocessor::Pooling pooling)
+    : frame_id_(frame_id),
+      camera_matrix_(camera_matrix),
+      native_resolution_(native_resolution),
+      downsampling_factor_(downsampling_factor),
+      preprocessor_(downsampling_factor,
+                    pooling,
+                    std::numeric_limits<float>::infinity()),
+      incoming_(capacity),
+      prepared_(capacity),
+      buffer_pool_(std::make_shared<BufferPool>()),
+      received_(0),
+      dropped_(0),
+      prepared_count_(0),
+      shutdown_(false)
+{
+    camera_matrix_.topRows(2) /= double(downsampling_factor_);
+
+    worker_ = std::thread(&StreamingCameraDataProvider::preprocess, this);
+}
+
+StreamingCameraDataProvider::~StreamingCameraDataProvider()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    frame_incoming_.notify_all();
+
+    worker_.join();
+}
+
+bool StreamingCameraDataProvider::push(const DepthImageView& frame)
+{
+    ++received_;
+
+    DepthImageView item = frame;
+    if (!incoming_.try_push(std::move(item)))
+    {
+        ++dropped_;
+        return false;
+    }
+
+    // synchronizes with the predicate check of the sleeping worker
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    frame_incoming_.notify_one();
+
+    return true;
+}
+
+bool StreamingCameraDataProvider::next_frame(double timeout)
+{
+    DepthImageView frame;
+    if (!prepared_.try_pop(frame))
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool arrived = frame_prepared_.wait_for(
+            lock,
+            std::chrono::duration<double>(timeout),
+            [&] { return prepared_.try_pop(frame); });
+
+        if (!arrived) return false;
+    }
+
+    current_ = frame;
+    return true;
+}
+
+auto StreamingCameraDataProvider::statistics() const -> Statistics
+{
+    Statistics statistics;
+    statistics.received = received_;
+    statistics.dropped = dropped_;
+    statistics.prepared = prepared_count_;
+    statistics.queue_depth = int(incoming_.size() + prepared_.size());
+
+    return statistics;
+}
+
+void StreamingCameraDataProvider::preprocess()
+{
+    while (true)
+    {
+        DepthImageView frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            frame_incoming_.wait(
+                lock, [&] { return shutdown_ || incoming_.try_pop(frame); });
+
+            if (shutdown_) return;
+        }
+
+        const int rows = frame.rows() / downsampling_factor_;
+        const int cols = frame.cols() / downsampling_factor_;
+
+        auto buffer = free_buffer();
+        preprocessor_.process(
+            frame.data(), frame.rows(), frame.cols(), *buffer);
+
+        // releases the driver buffer
+        frame = DepthImageView();
+
+        DepthImageView prepared(buffer->data(), rows, cols, buffer);
+        if (prepared_.try_push(std::move(prepared)))
+        {
+            ++prepared_count_;
+        }
+        else
+        {
+            ++dropped_;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        frame_prepared_.notify_one();
+    }
+}
+
+auto StreamingCameraDataProvider::free_buffer()
+    -> std::shared_ptr<std::vector<float>>
+{
+    std::unique_ptr<std::vector<float>> buffer;
+    {
+        std::lock_guard<std::mutex> lock(buffer_pool_->mutex);
+        if (!buffer_pool_->buffers.empty())
+        {
+            buffer = std::move(buffer_pool_->buffers.back());
+            buffer_pool_->buffers.pop_back();
+        }
+    }
+    if (!buffer) buffer.reset(new std::vector<float>());
+
+    // the pool mutex orders the reads through the released views before
+    // the next frame is written into the buffer
+    std::weak_ptr<BufferPool> pool = buffer_pool_;
+    return std::shared_ptr<std::vector<float>>(
+        buffer.release(),
+        [pool](std::vector<float>* released)
+        {
+            std::unique_ptr<std::vector<float>> buffer(released);
+            if (auto owner = pool.lock())
+            {
+                std::lock_guard<std::mutex> lock(owner->mutex);
+                owner->buffers.push_back(std::move(buffer));
+            }
+        });
+}
+
+Eigen::MatrixXd StreamingCameraDataProvider::depth_image() const
+{
+    Eigen::MatrixXd image(current_.rows(), current_.cols());
+    for (int row = 0; row < current_.rows(); ++row)
+    {
+        for (int col = 0; col < current_.cols(); ++col)
+        {
+            image(row, col) = current_(row * current_.cols() + col);
+        }
+    }
+
+    return image;
+}
+
+Eigen::VectorXd StreamingCameraDataProvider::depth_image_vector() const
+{
+    return current_.vector().cast<double>();
+}
+
+DepthImageView StreamingCameraDataProvider::depth_image_view() const
+{
+    return current_;
+}
+
+Eigen::Matrix3d StreamingCameraDataProvider::camera_matrix() const
+{
+    return camera_matrix_;
+}
+
+std::string StreamingCameraDataProvider::frame_id() const
+{
+    return frame_id_;
+}
+
+int StreamingCameraDataProvider::downsampling_factor() const
+{
+    return downsampling_factor_;
+}
+
+CameraData::Resolution StreamingCameraDataProvider::native_resolution() const
+{
+    return native_resolution_;
+}
+}
@@ -0,0 +1,174 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file streaming_camera_data_provider.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include <Eigen/Dense>
+
+#include <dbot/spsc_ring.hpp>
+#include <dbot/depth_image_view.hpp>
+#include <dbot/depth_preprocessor.hpp>
+#include <dbot/camera_data_provider.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Camera data provider which prepares incoming frames on a separate
+ *        thread while the tracker processes the previous one.
+ *
+ * The camera driver pushes native resolution frames with push(). A
+ * preprocessing thread downsamples them with a DepthPreprocessor into float
+ * images of the resolution expected by the sensors, which the tracking
+ * thread obtains with next_frame() and depth_image_view(). Both stages are
+ * connected by bounded lock-free rings. A frame pushed while the input ring
+ * is full is dropped, so a slow tracker never stalls the driver.
+ *
+ * push() must always be called by the same thread, as must next_frame().
+ */
+class StreamingCameraDataProvider : public CameraDataProvider
+{
+public:
+    /**
+     * \brief Frame counters of the pipeline
+     */
+    struct Statistics
+    {
+        /// frames passed to push()
+        unsigned long received;
+        /// frames dropped because the input or the output ring was full
+        unsigned long dropped;
+        /// frames prepared by the preprocessing thread
+        unsigned long prepared;
+        /// frames waiting to be prepared or to be tracked
+        int queue_depth;
+    };
+
+public:
+    /**
+     * \param camera_matrix the camera matrix of the native resolution,
+     *        camera_matrix() returns it scaled to the downsampled one
+     * \param native_resolution the resolution of the pushed frames
+     * \param downsampling_factor the integer factor the frames are
+     *        downsampled by
+     * \param capacity the number of frames each ring holds
+     * \param pooling the downsampling of the frames, see DepthPreprocessor
+     */
+    StreamingCameraDataProvider(
+        const std::string& frame_id,
+        const Eigen::Matrix3d& camera_matrix,
+        const CameraData::Resolution& native_resolution,
+        int downsampling_factor,
+        int capacity = 4,
+        DepthPreprocessor::Pooling pooling =
+            DepthPreprocessor::Pooling::Subsample);
+
+    virtual ~StreamingCameraDataProvider();
+
+    /**
+     * \brief Queues a native resolution frame for preprocessing. The view
+     *        has to keep its buffer alive, e.g. through its owner, until the
+     *        frame has been prepared.
+     *
+     * \return false if the frame has been dropped
+     */
+    bool push(const DepthImageView& frame);
+
+    /**
+     * \brief Waits up to \a timeout seconds for the next prepared frame and
+     *        makes it the current one returned by depth_image_view()
+     *
+     * \return false if no frame arrived in time
+     */
+    bool next_frame(double timeout);
+
+    Statistics statistics() const;
+
+    /** \brief returns the current frame as an Eigen matrix */
+    Eigen::MatrixXd depth_image() const;
+
+    /** \brief returns the current frame as an Eigen vector */
+    Eigen::VectorXd depth_image_vector() const;
+
+    /**
+     * \brief returns the current frame without copying it. The view stays
+     *        valid after later calls to next_frame().
+     */
+    DepthImageView depth_image_view() const;
+
+    Eigen::Matrix3d camera_matrix() const;
+    std::string frame_id() const;
+    int downsampling_factor() const;
+    CameraData::Resolution native_resolution() const;
+
+private:
+    void preprocess();
+
+    /**
+     * \brief returns a buffer which is not referenced by any view. The
+     *        buffer returns to the pool once its last view is released.
+     */
+    std::shared_ptr<std::vector<float>> free_buffer();
+
+private:
+    /**
+     * \brief Buffers of prepared frames which are no longer referenced. Views
+     *        are released by any thread, possibly after the provider has
+     *        been destroyed, hence the pool is guarded by its own mutex and
+     *        the views refer to it weakly.
+     */
+    struct BufferPool
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<std::vector<float>>> buffers;
+    };
+
+    std::string frame_id_;
+    Eigen::Matrix3d camera_matrix_;
+    CameraData::Resolution native_resolution_;
+    int downsampling_factor_;
+    DepthPreprocessor preprocessor_;
+
+    SpscRing<DepthImageView> incoming_;
+    SpscRing<DepthImageView> prepared_;
+    DepthImageView current_;
+
+    // buffers of the prepared frames, reused once no view refers to them
+    std::shared_ptr<BufferPool> buffer_pool_;
+
+    std::atomic<unsigned long> received_;
+    std::atomic<unsigned long> dropped_;
+    std::atomic<unsigned long> prepared_count_;
+
+    // only used to sleep while a ring is empty
+    std::mutex mutex_;
+    std::condition_variable frame_incoming_;
+    std::condition_variable frame_prepared_;
+    bool shutdown_;
+
+    std::thread worker_;
+};
+}
@@ -0,0 +1,155 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file streaming_camera_data_provider_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dbot/spsc_ring.hpp>
+#include <dbot/streaming_camera_data_provider.hpp>
+
+using dbot::SpscRing;
+using dbot::DepthImageView;
+using dbot::StreamingCameraDataProvider;
+
+static DepthImageView make_frame(int rows, int cols, float offset)
+{
+    auto buffer = std::make_shared<std::vector<float>>(rows * cols);
+    for (int i = 0; i < rows * cols; ++i) (*buffer)[i] = offset + i + 1;
+
+    return DepthImageView(buffer->data(), rows, cols, buffer);
+}
+
+static dbot::CameraData::Resolution resolution(int rows, int cols)
+{
+    dbot::CameraData::Resolution resolution;
+    resolution.height = rows;
+    resolution.width = cols;
+    return resolution;
+}
+
+TEST(SpscRingTests, keeps_fifo_order_up_to_capacity)
+{
+    SpscRing<int> ring(2);
+
+    EXPECT_TRUE(ring.try_push(1));
+    EXPECT_TRUE(ring.try_push(2));
+    EXPECT_FALSE(ring.try_push(3));
+    EXPECT_EQ(ring.size(), 2);
+
+    int item;
+    EXPECT_TRUE(ring.try_pop(item));
+    EXPECT_EQ(item, 1);
+    EXPECT_TRUE(ring.try_push(4));
+    EXPECT_TRUE(ring.try_pop(item));
+    EXPECT_EQ(item, 2);
+    EXPECT_TRUE(ring.try_pop(item));
+    EXPECT_EQ(item, 4);
+    EXPECT_FALSE(ring.try_pop(item));
+}
+
+TEST(StreamingCameraDataProviderTests, frames_are_downsampled)
+{
+    StreamingCameraDataProvider provider(
+        "camera", Eigen::Matrix3d::Identity(), resolution(4, 6), 2);
+
+    ASSERT_TRUE(provider.push(make_frame(4, 6, 0)));
+    ASSERT_TRUE(provider.next_frame(5.0));
+
+    DepthImageView frame = provider.depth_image_view();
+    ASSERT_EQ(frame.rows(), 2);
+    ASSERT_EQ(frame.cols(), 3);
+    EXPECT_EQ(frame(0), 1);
+    EXPECT_EQ(frame(1), 3);
+    EXPECT_EQ(frame(3), 13);
+    EXPECT_DOUBLE_EQ(provider.camera_matrix()(0, 0), 0.5);
+}
+
+TEST(StreamingCameraDataProviderTests, every_frame_is_prepared_or_dropped)
+{
+    StreamingCameraDataProvider provider(
+        "camera", Eigen::Matrix3d::Identity(), resolution(8, 8), 1, 2);
+
+    const int frame_count = 50;
+    for (int i = 0; i < frame_count; ++i)
+    {
+        provider.push(make_frame(8, 8, i));
+    }
+
+    float last = -1;
+    while (provider.next_frame(0.5))
+    {
+        // frames are never reordered
+        EXPECT_GT(provider.depth_image_view()(0), last);
+        last = provider.depth_image_view()(0);
+    }
+
+    auto statistics = provider.statistics();
+    EXPECT_EQ(statistics.received, frame_count);
+    EXPECT_EQ(statistics.prepared + statistics.dropped, frame_count);
+    EXPECT_EQ(statistics.queue_depth, 0);
+}
+
+TEST(StreamingCameraDataProviderTests, views_released_elsewhere_keep_their_frame)
+{
+    std::vector<DepthImageView> views;
+    std::vector<std::thread> releasers;
+    std::vector<int> mismatches(40, 0);
+    {
+        StreamingCameraDataProvider provider(
+            "camera", Eigen::Matrix3d::Identity(), resolution(8, 8), 1, 2);
+
+        for (int i = 0; i < 40; ++i)
+        {
+            provider.push(make_frame(8, 8, 100 * i));
+            if (!provider.next_frame(5.0)) continue;
+
+            const DepthImageView view = provider.depth_image_view();
+            EXPECT_EQ(view(63), view(0) + 63);
+            views.push_back(view);
+
+            // every other frame is read and released by another thread while
+            // the following ones are prepared
+            if (views.size() == 2)
+            {
+                DepthImageView released = views[0];
+                views.erase(views.begin());
+                int& mismatch = mismatches[i];
+                releasers.emplace_back([released, &mismatch]() mutable
+                                       {
+                                           for (int k = 0; k < 64; ++k)
+                                           {
+                                               mismatch += released(k) !=
+                                                           released(0) + k;
+                                           }
+                                           released = DepthImageView();
+                                       });
+            }
+        }
+    }
+    for (std::thread& releaser : releasers) releaser.join();
+
+    for (int mismatch : mismatches) EXPECT_EQ(mismatch, 0);
+
+    // the views outlive the provider
+    ASSERT_FALSE(views.empty());
+    EXPECT_EQ(views.back()(63), views.back()(0) + 63);
+}
@@ -0,0 +1,201 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file synthetic_scene.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+
+#include <Eigen/Dense>
+
+#include <dbot/object_model.hpp>
+#include <dbot/object_model_loader.hpp>
+#include <dbot/rigid_body_renderer.hpp>
+#include <dbot/object_resource_identifier.hpp>
+#include <dbot/virtual_camera_data_provider.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Object consisting of spheres side by side along the x axis, each one
+ *        of them a part tessellated into latitude and longitude bands. A part
+ *        of \a rings bands has 2 * rings * (2 * rings - 1) triangles.
+ */
+class SyntheticObjectLoader : public ObjectModelLoader
+{
+public:
+    SyntheticObjectLoader(int part_count, int rings, double radius = 0.05)
+        : part_count_(part_count), rings_(rings), radius_(radius)
+    {
+    }
+
+    void load(std::vector<std::vector<Eigen::Vector3d>>& vertices,
+              std::vector<std::vector<std::vector<int>>>& triangle_indices)
+        const override
+    {
+        vertices.assign(part_count_, std::vector<Eigen::Vector3d>());
+        triangle_indices.assign(part_count_, std::vector<std::vector<int>>());
+
+        const int segments = 2 * rings_;
+        for (int part = 0; part < part_count_; ++part)
+        {
+            const Eigen::Vector3d center(part * 2.5 * radius_, 0., 0.);
+            for (int i = 0; i <= rings_; ++i)
+            {
+                const double theta = M_PI * i / rings_;
+                for (int j = 0; j < segments; ++j)
+                {
+                    const double phi = 2. * M_PI * j / segments;
+                    vertices[part].push_back(
+                        center + radius_ * Eigen::Vector3d(
+                                               std::sin(theta) * std::cos(phi),
+                                               std::sin(theta) * std::sin(phi),
+                                               std::cos(theta)));
+                }
+            }
+
+            // counterclockwise seen from the outside, the poles are left out
+            for (int i = 0; i < rings_; ++i)
+            {
+                for (int j = 0; j < segments; ++j)
+                {
+                    const int a = i * segments + j;
+                    const int b = i * segments + (j + 1) % segments;
+                    const int c = a + segments;
+                    const int d = b + segments;
+                    if (i > 0) triangle_indices[part].push_back({a, c, b});
+                    if (i < rings_ - 1)
+                    {
+                        triangle_indices[part].push_back({b, c, d});
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Writes the parts as wavefront files into
+     *        <package_path>/meshes, which has to exist
+     *
+     * \param package_path absolute path of the form "/path/to/package"
+     * \return the identifier of the written files
+     */
+    ObjectResourceIdentifier write(const std::string& package_path) const
+    {
+        std::vector<std::vector<Eigen::Vector3d>> vertices;
+        std::vector<std::vector<std::vector<int>>> triangle_indices;
+        load(vertices, triangle_indices);
+
+        std::vector<std::string> meshes;
+        for (int part = 0; part < part_count_; ++part)
+        {
+            meshes.push_back("part_" + std::to_string(part) + ".obj");
+
+            std::ofstream file(package_path + "/meshes/" + meshes.back());
+            if (!file)
+            {
+                throw std::runtime_error("Cannot write " + meshes.back());
+            }
+
+            file.precision(9);
+            for (const auto& vertex : vertices[part])
+            {
+                file << "v " << vertex(0) << " " << vertex(1) << " "
+                     << vertex(2) << "\n";
+            }
+            for (const auto& triangle : triangle_indices[part])
+            {
+                file << "f " << triangle[0] + 1 << " " << triangle[1] + 1 << " "
+                     << triangle[2] + 1 << "\n";
+            }
+        }
+
+        return ObjectResourceIdentifier(package_path, "meshes", meshes);
+    }
+
+private:
+    int part_count_;
+    int rings_;
+    double radius_;
+};
+
+/**
+ * \brief Virtual camera observing an object in front of a wall. The depth
+ *        image is rendered once at the resolution of the downsampling factor.
+ */
+class SyntheticCameraDataProvider : public VirtualCameraDataProvider
+{
+public:
+    /**
+     * \param poses  poses of the parts in the camera frame
+     * \param wall_depth  depth of the background in meters
+     */
+    SyntheticCameraDataProvider(
+        int downsampling_factor,
+        const ObjectModel& object_model,
+        const std::vector<RigidBodyRenderer::Affine>& poses,
+        double wall_depth = 1.5)
+        : VirtualCameraDataProvider(downsampling_factor, "/synthetic_camera")
+    {
+        const int n_rows = native_resolution_.height / downsampling_factor;
+        const int n_cols = native_resolution_.width / downsampling_factor;
+
+        RigidBodyRenderer renderer(object_model.vertices(),
+                                   object_model.triangle_indices(),
+                                   camera_matrix_,
+                                   n_rows,
+                                   n_cols);
+        renderer.set_poses(poses);
+
+        std::vector<float> depth;
+        renderer.Render(depth);
+
+        depth_image_.resize(n_rows, n_cols);
+        for (int row = 0; row < n_rows; ++row)
+        {
+            for (int col = 0; col < n_cols; ++col)
+            {
+                const float d = depth[row * n_cols + col];
+                depth_image_(row, col) = std::isfinite(d) ? d : wall_depth;
+            }
+        }
+    }
+
+    /**
+     * \brief Poses of the parts of a SyntheticObjectLoader object at
+     *        \a distance in front of the camera, centered in the image
+     */
+    static std::vector<RigidBodyRenderer::Affine> poses(int part_count,
+                                                        double radius = 0.05,
+                                                        double distance = 0.8)
+    {
+        std::vector<RigidBodyRenderer::Affine> poses(
+            part_count, RigidBodyRenderer::Affine::Identity());
+        for (auto& pose : poses)
+        {
+            pose.translation() = Eigen::Vector3d(
+                -(part_count - 1) * 1.25 * radius, 0., distance);
+        }
+        return poses;
+    }
+};
+}
@@ -0,0 +1,179 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file thread_pool.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <algorithm>
+
+#include <dbot/thread_pool.hpp>
+
+namespace dbot
+{
+namespace
+{
+// the pool whose loop the current thread is running and its worker index
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_thread_index = 0;
+
+/**
+ * \brief Marks the current thread as running a loop of \a pool and restores
+ *        the enclosing loop of another pool afterwards
+ */
+struct LoopScope
+{
+    LoopScope(const ThreadPool* pool, int thread_index)
+        : previous_pool(current_pool),
+          previous_thread_index(current_thread_index)
+    {
+        current_pool = pool;
+        current_thread_index = thread_index;
+    }
+
+    ~LoopScope()
+    {
+        current_pool = previous_pool;
+        current_thread_index = previous_thread_index;
+    }
+
+    const ThreadPool* previous_pool;
+    int previous_thread_index;
+};
+}
+
+ThreadPool::ThreadPool(int thread_count)
+    : body_(nullptr),
+      count_(0),
+      grain_size_(1),
+      next_(0),
+      pending_workers_(0),
+      generation_(0),
+      shutdown_(false)
+{
+    if (thread_count <= 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 1; i < thread_count; ++i)
+    {
+        workers_.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    job_available_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+int ThreadPool::thread_count() const
+{
+    return int(workers_.size()) + 1;
+}
+
+void ThreadPool::parallel_for(int count, const Body& body, int grain_size)
+{
+    if (count <= 0) return;
+
+    // a nested loop runs inline in the worker executing the outer one, the
+    // other workers are busy with the outer loop anyway
+    if (current_pool == this)
+    {
+        for (int i = 0; i < count; ++i) body(i, current_thread_index);
+        return;
+    }
+
+    if (workers_.empty() || count <= grain_size)
+    {
+        for (int i = 0; i < count; ++i) body(i, 0);
+        return;
+    }
+
+    // only one loop at a time may use the workers
+    std::lock_guard<std::mutex> loop_lock(loop_mutex_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        count_ = count;
+        grain_size_ = std::max(1, grain_size);
+        next_ = 0;
+        pending_workers_ = int(workers_.size());
+        ++generation_;
+    }
+    job_available_.notify_all();
+
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_done_.wait(lock, [this]() { return pending_workers_ == 0; });
+    body_ = nullptr;
+}
+
+void ThreadPool::run_chunks(int thread_index)
+{
+    LoopScope scope(this, thread_index);
+
+    while (true)
+    {
+        const int begin = next_.fetch_add(grain_size_);
+        if (begin >= count_) break;
+
+        const int end = std::min(begin + grain_size_, count_);
+        for (int i = begin; i < end; ++i)
+        {
+            (*body_)(i, thread_index);
+        }
+    }
+}
+
+void ThreadPool::work(int thread_index)
+{
+    unsigned long generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_available_.wait(lock,
+                                [this, generation]()
+                                {
+                                    return shutdown_ ||
+                                           generation_ != generation;
+                                });
+            if (shutdown_) return;
+            generation = generation_;
+        }
+
+        run_chunks(thread_index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_workers_;
+        }
+        job_done_.notify_one();
+    }
+}
+}
@@ -0,0 +1,89 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file thread_pool.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace dbot
+{
+/**
+ * \brief Fixed set of worker threads executing parallel loops.
+ *
+ * The calling thread takes part in every loop as worker 0, hence a pool with
+ * a thread count of one runs everything inline without any synchronization.
+ * Each invocation of the loop body receives the index of the worker running
+ * it which allows callers to maintain per-thread scratch buffers.
+ */
+class ThreadPool
+{
+public:
+    typedef std::function<void(int index, int thread_index)> Body;
+
+public:
+    /**
+     * \brief Creates a pool with the given total number of threads including
+     *        the calling thread. A count of zero or less selects the number of
+     *        hardware threads.
+     */
+    explicit ThreadPool(int thread_count = 0);
+
+    ~ThreadPool();
+
+    /**
+     * \brief Runs body(i, thread_index) for all i in [0, count) and blocks
+     *        until all iterations have been completed. Iterations are
+     *        distributed dynamically in chunks of \a grain_size. A loop
+     *        started from within the body of a loop of the same pool runs
+     *        inline in the calling worker.
+     */
+    void parallel_for(int count, const Body& body, int grain_size = 1);
+
+    /**
+     * \return Total number of threads, including the calling one.
+     */
+    int thread_count() const;
+
+private:
+    void work(int thread_index);
+    void run_chunks(int thread_index);
+
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::mutex loop_mutex_;
+    std::condition_variable job_available_;
+    std::condition_variable job_done_;
+
+    const Body* body_;
+    int count_;
+    int grain_size_;
+    std::atomic<int> next_;
+    int pending_workers_;
+    unsigned long generation_;
+    bool shutdown_;
+};
+}
@@ -0,0 +1,148 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file thread_pool_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include <dbot/thread_pool.hpp>
+
+using dbot::ThreadPool;
+
+/** \brief Runs a loop of \a count iterations and counts the runs per index */
+static std::vector<int> run_counts(ThreadPool& pool, int count, int grain_size)
+{
+    std::vector<std::atomic<int>> runs(count);
+    for (auto& r : runs) r = 0;
+
+    std::atomic<bool> valid_thread_index(true);
+    pool.parallel_for(count,
+                      [&](int i, int thread_index)
+                      {
+                          ++runs[i];
+                          if (thread_index < 0 ||
+                              thread_index >= pool.thread_count())
+                          {
+                              valid_thread_index = false;
+                          }
+                      },
+                      grain_size);
+    EXPECT_TRUE(valid_thread_index);
+
+    return std::vector<int>(runs.begin(), runs.end());
+}
+
+TEST(ThreadPoolTests, every_index_runs_exactly_once)
+{
+    for (int thread_count : {1, 2, 4, 7})
+    {
+        ThreadPool pool(thread_count);
+        EXPECT_EQ(pool.thread_count(), thread_count);
+
+        for (int grain_size : {1, 3, 64})
+        {
+            EXPECT_EQ(run_counts(pool, 1000, grain_size),
+                      std::vector<int>(1000, 1));
+        }
+    }
+}
+
+TEST(ThreadPoolTests, back_to_back_loops)
+{
+    ThreadPool pool(4);
+    for (int loop = 0; loop < 500; ++loop)
+    {
+        const int count = 1 + loop % 97;
+        EXPECT_EQ(run_counts(pool, count, 1 + loop % 5),
+                  std::vector<int>(count, 1));
+    }
+}
+
+TEST(ThreadPoolTests, grain_size_larger_than_count)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(run_counts(pool, 5, 100), std::vector<int>(5, 1));
+    EXPECT_EQ(run_counts(pool, 100, 100), std::vector<int>(100, 1));
+    EXPECT_EQ(run_counts(pool, 0, 100), std::vector<int>());
+}
+
+TEST(ThreadPoolTests, nested_loops_run_inline)
+{
+    const int outer = 16;
+    const int inner = 50;
+
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(outer * inner);
+    for (auto& r : runs) r = 0;
+
+    std::atomic<bool> same_thread(true);
+    pool.parallel_for(outer,
+                      [&](int i, int outer_thread)
+                      {
+                          pool.parallel_for(
+                              inner,
+                              [&](int j, int inner_thread)
+                              {
+                                  ++runs[i * inner + j];
+                                  if (inner_thread != outer_thread)
+                                  {
+                                      same_thread = false;
+                                  }
+                              });
+                      });
+
+    for (const auto& r : runs) EXPECT_EQ(r, 1);
+    EXPECT_TRUE(same_thread);
+}
+
+TEST(ThreadPoolTests, nested_loops_of_another_pool_keep_the_outer_loop)
+{
+    const int outer = 16;
+    const int inner = 50;
+
+    ThreadPool outer_pool(4);
+    ThreadPool inner_pool(3);
+    std::vector<std::atomic<int>> runs(outer * inner);
+    for (auto& r : runs) r = 0;
+
+    std::atomic<bool> same_thread(true);
+    outer_pool.parallel_for(
+        outer,
+        [&](int i, int outer_thread)
+        {
+            // a loop dispatched to the other pool
+            EXPECT_EQ(run_counts(inner_pool, 100, 1),
+                      std::vector<int>(100, 1));
+
+            // afterwards loops of the outer pool still run inline
+            outer_pool.parallel_for(inner,
+                                    [&](int j, int inner_thread)
+                                    {
+                                        ++runs[i * inner + j];
+                                        if (inner_thread != outer_thread)
+                                        {
+                                            same_thread = false;
+                                        }
+                                    });
+        });
+
+    for (const auto& r : runs) EXPECT_EQ(r, 1);
+    EXPECT_TRUE(same_thread);
+}
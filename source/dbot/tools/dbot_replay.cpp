@@ -0,0 +1,382 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file dbot_replay.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ *
+ * Runs a tracker on a DepthRecording as fast as possible and reports its
+ * throughput, its latency and its error with respect to the recorded ground
+ * truth.
+ *
+ * Usage: dbot_replay [options] <recording> <package path> <mesh directory>
+ *                    <mesh file>...
+ */
+
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include <dbot/camera_data.hpp>
+#include <dbot/instrumentation.hpp>
+#include <dbot/object_model.hpp>
+#include <dbot/object_resource_identifier.hpp>
+#include <dbot/replay_camera_data_provider.hpp>
+#include <dbot/simple_wavefront_object_loader.hpp>
+#include <dbot/tracker/tracker.hpp>
+#include <dbot/tracker/particle_tracker.hpp>
+#include <dbot/builder/rb_sensor_builder.h>
+#include <dbot/builder/particle_tracker_builder.hpp>
+#include <dbot/builder/gaussian_tracker_builder.hpp>
+
+namespace
+{
+struct Options
+{
+    std::string tracker = "particle";
+    int downsampling = 2;
+    int particles = 200;
+    int threads = 0;
+    int warmup = 0;
+    bool use_gpu = false;
+
+    std::string recording;
+    dbot::ObjectResourceIdentifier ori;
+};
+
+void usage()
+{
+    std::cerr
+        << "Usage: dbot_replay [options] <recording> <package path> "
+           "<mesh directory> <mesh file>...\n"
+           "  --tracker particle|gaussian  tracker to run (particle)\n"
+           "  --downsampling N             downsampling factor (2)\n"
+           "  --particles N                particles per frame (200)\n"
+           "  --threads N                  CPU threads, 0 for all (0)\n"
+           "  --warmup N                   frames left out of the "
+           "statistics (0)\n"
+           "  --gpu                        evaluate on the GPU\n";
+}
+
+bool parse(int argc, char** argv, Options& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (argument == "--gpu")
+        {
+            options.use_gpu = true;
+        }
+        else if (argument == "--tracker" && has_value)
+        {
+            options.tracker = argv[++i];
+        }
+        else if (argument == "--downsampling" && has_value)
+        {
+            options.downsampling = std::atoi(argv[++i]);
+        }
+        else if (argument == "--particles" && has_value)
+        {
+            options.particles = std::atoi(argv[++i]);
+        }
+        else if (argument == "--threads" && has_value)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (argument == "--warmup" && has_value)
+        {
+            options.warmup = std::atoi(argv[++i]);
+        }
+        else if (argument.compare(0, 2, "--") == 0)
+        {
+            return false;
+        }
+        else
+        {
+            positional.push_back(argument);
+        }
+    }
+
+    if (positional.size() < 4 || options.downsampling < 1 ||
+        options.particles < 1 ||
+        (options.tracker != "particle" && options.tracker != "gaussian"))
+    {
+        return false;
+    }
+
+    options.recording = positional[0];
+    options.ori = dbot::ObjectResourceIdentifier(
+        positional[1],
+        positional[2],
+        std::vector<std::string>(positional.begin() + 3, positional.end()));
+    return true;
+}
+
+template <typename State>
+typename dbot::ObjectTransitionBuilder<State>::Parameters object_transition(
+    int part_count)
+{
+    typename dbot::ObjectTransitionBuilder<State>::Parameters params;
+    params.linear_sigma_x = 0.002;
+    params.linear_sigma_y = 0.002;
+    params.linear_sigma_z = 0.002;
+    params.angular_sigma_x = 0.01;
+    params.angular_sigma_y = 0.01;
+    params.angular_sigma_z = 0.01;
+    params.velocity_factor = 0.8;
+    params.part_count = part_count;
+    return params;
+}
+
+template <typename ParticleTracker>
+std::shared_ptr<dbot::Tracker> create_particle_tracker(
+    const Options& options,
+    const std::shared_ptr<dbot::CameraData>& camera_data)
+{
+    typedef typename ParticleTracker::State State;
+
+    auto object_model = std::make_shared<dbot::ObjectModel>(
+        std::make_shared<dbot::SimpleWavefrontObjectModelLoader>(options.ori),
+        true);
+
+    auto transition_builder =
+        std::make_shared<dbot::ObjectTransitionBuilder<State>>(
+            object_transition<State>(object_model->count_parts()));
+
+    typename dbot::RbSensorBuilder<State>::Parameters sensor;
+    sensor.use_gpu = options.use_gpu;
+    sensor.occlusion.p_occluded_visible = 0.1;
+    sensor.occlusion.p_occluded_occluded = 0.7;
+    sensor.occlusion.initial_occlusion_prob = 0.1;
+    sensor.kinect.tail_weight = 0.01;
+    sensor.kinect.model_sigma = 0.003;
+    sensor.kinect.sigma_factor = 0.00142478;
+    sensor.delta_time = 0.033;
+    sensor.sample_count = options.particles;
+    sensor.use_custom_shaders = false;
+    sensor.thread_count = options.threads;
+
+    auto sensor_builder = std::make_shared<dbot::RbSensorBuilder<State>>(
+        object_model, camera_data, sensor);
+
+    typename dbot::ParticleTrackerBuilder<ParticleTracker>::Parameters params;
+    params.evaluation_count = options.particles;
+    params.moving_average_update_rate = 1.0;
+    params.max_kl_divergence = 2.0;
+    params.center_object_frame = true;
+    params.thread_count = options.threads;
+
+    return dbot::ParticleTrackerBuilder<ParticleTracker>(
+               transition_builder, sensor_builder, object_model, params)
+        .build();
+}
+
+std::shared_ptr<dbot::Tracker> create_gaussian_tracker(
+    const Options& options,
+    const std::shared_ptr<dbot::CameraData>& camera_data,
+    int part_count)
+{
+    dbot::GaussianTrackerBuilder::Parameters params;
+    params.ut_alpha = 1.0;
+    params.moving_average_update_rate = 1.0;
+    params.center_object_frame = true;
+    params.use_gpu = options.use_gpu;
+    params.thread_count = options.threads;
+    params.ori = options.ori;
+
+    params.observation.bg_depth = 7.0;
+    params.observation.fg_noise_std = 0.001;
+    params.observation.bg_noise_std = 0.5;
+    params.observation.tail_weight = 0.01;
+    params.observation.uniform_tail_min = 0.0;
+    params.observation.uniform_tail_max = 7.0;
+    params.observation.sensors = camera_data->pixels();
+
+    params.object_transition =
+        object_transition<dbot::Tracker::State>(part_count);
+
+    return dbot::GaussianTrackerBuilder(params, camera_data).build();
+}
+
+dbot::Tracker::State to_state(const std::vector<Eigen::Affine3d>& poses)
+{
+    dbot::Tracker::State state(poses.size());
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        state.component(i).affine(poses[i]);
+    }
+    return state;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.;
+
+    const size_t k = std::min(values.size() - 1,
+                              size_t(std::ceil(p * values.size())) - 1);
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+double mean(const std::vector<double>& values)
+{
+    double sum = 0.;
+    for (double value : values) sum += value;
+    return values.empty() ? 0. : sum / values.size();
+}
+
+double maximum(const std::vector<double>& values)
+{
+    return values.empty() ? 0.
+                          : *std::max_element(values.begin(), values.end());
+}
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        usage();
+        return 1;
+    }
+
+    auto replay = std::make_shared<dbot::ReplayCameraDataProvider>(
+        options.recording, options.downsampling);
+    auto camera_data = std::make_shared<dbot::CameraData>(replay);
+    const auto initial_poses = replay->initial_poses();
+
+    // single objects are tracked with particles of fixed size
+    std::shared_ptr<dbot::Tracker> tracker;
+    if (options.tracker == "gaussian")
+    {
+        tracker = create_gaussian_tracker(
+            options, camera_data, initial_poses.size());
+    }
+    else if (initial_poses.size() == 1)
+    {
+        tracker = create_particle_tracker<dbot::FixedParticleTracker<1>>(
+            options, camera_data);
+    }
+    else
+    {
+        tracker =
+            create_particle_tracker<dbot::ParticleTracker>(options, camera_data);
+    }
+    tracker->initialize({to_state(initial_poses)});
+
+    // mean time of each stage per frame, the statistics are delivered on
+    // this thread within track()
+    dbot::FrameStatistics stage_totals;
+    tracker->instrumentation()->enable(true);
+    tracker->instrumentation()->callback(
+        [&](const dbot::FrameStatistics& statistics)
+        {
+            if (replay->frame_index() < options.warmup) return;
+
+            for (int i = 0; i < int(dbot::Stage::Count); ++i)
+            {
+                stage_totals.stage_seconds[i] += statistics.stage_seconds[i];
+            }
+            stage_totals.pixels_evaluated += statistics.pixels_evaluated;
+            stage_totals.renders_reused += statistics.renders_reused;
+            stage_totals.resample_count += statistics.resample_count;
+        });
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<double> latencies;
+    std::vector<double> position_errors;
+    std::vector<double> orientation_errors;
+    while (replay->next_frame())
+    {
+        const auto image = replay->depth_image_view();
+
+        const auto start = Clock::now();
+        const auto state = tracker->track(image, replay->time());
+        const double latency =
+            std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (replay->frame_index() < options.warmup) continue;
+        latencies.push_back(latency);
+
+        const auto ground_truth = replay->ground_truth();
+        for (int i = 0; i < state.count(); ++i)
+        {
+            if (!ground_truth[i].matrix().allFinite()) continue;
+
+            const Eigen::Affine3d estimate = state.component(i).affine();
+            position_errors.push_back(
+                (estimate.translation() - ground_truth[i].translation())
+                    .norm());
+            orientation_errors.push_back(
+                Eigen::AngleAxisd(estimate.rotation().transpose() *
+                                  ground_truth[i].rotation())
+                    .angle());
+        }
+    }
+
+    double total = 0.;
+    for (double latency : latencies) total += latency;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "frames:        " << latencies.size() << "\n"
+              << "frames/s:      "
+              << (total > 0. ? latencies.size() / total : 0.) << "\n"
+              << "latency p50:   " << 1e3 * percentile(latencies, 0.5)
+              << " ms\n"
+              << "latency p99:   " << 1e3 * percentile(latencies, 0.99)
+              << " ms\n";
+
+    const char* stage_names[] = {
+        "propagate", "render", "map", "weigh", "resample", "refine"};
+    const double frames = std::max<size_t>(1, latencies.size());
+    for (int i = 0; i < int(dbot::Stage::Count); ++i)
+    {
+        std::cout << std::left << std::setw(15)
+                  << (std::string(stage_names[i]) + ":") << std::right
+                  << 1e3 * stage_totals.stage_seconds[i] / frames
+                  << " ms/frame\n";
+    }
+    std::cout << "pixels/frame:  "
+              << stage_totals.pixels_evaluated / frames << "\n"
+              << "reused/frame:  "
+              << stage_totals.renders_reused / frames << "\n"
+              << "resamples:     " << stage_totals.resample_count << "\n";
+
+    if (position_errors.empty())
+    {
+        std::cout << "pose error:    no ground truth" << std::endl;
+    }
+    else
+    {
+        std::cout << "position error mean/max:    "
+                  << 1e3 * mean(position_errors) << " / "
+                  << 1e3 * maximum(position_errors) << " mm\n"
+                  << "orientation error mean/max: "
+                  << mean(orientation_errors) * 180. / M_PI << " / "
+                  << maximum(orientation_errors) * 180. / M_PI << " deg"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -23,6 +23,9 @@
 
 #include <dbot/tracker/gaussian_tracker.hpp>
 
+#include <cmath>
+#include <vector>
+
 namespace dbot
 {
 GaussianTracker::GaussianTracker(
@@ -32,8 +35,25 @@ GaussianTracker::GaussianTracker(
     bool center_object_frame)
     : Tracker(object_model, update_rate, center_object_frame),
       filter_(filter),
-      belief_(filter_->create_belief())
+      belief_(filter_->create_belief()),
+      batch_render_sigma_points_(false),
+      ut_alpha_(1.),
+      update_count_(0)
+{
+}
+
+void GaussianTracker::batch_render_sigma_points(bool enabled, double ut_alpha)
+{
+    batch_render_sigma_points_ = enabled;
+    ut_alpha_ = ut_alpha;
+}
+
+void GaussianTracker::active_pixels(
+    const std::shared_ptr<ActivePixelSet>& active_pixels,
+    const std::shared_ptr<RigidBodyRenderer>& renderer)
 {
+    active_pixels_ = active_pixels;
+    silhouette_renderer_ = renderer;
 }
 
 auto GaussianTracker::on_initialize(
@@ -45,9 +65,39 @@ auto GaussianTracker::on_initialize(
     belief_.mean(initial_states[0]);
     belief_.covariance(initial_cov);
 
+    // the first update evaluates all pixels
+    update_count_ = 0;
+
     return belief_.mean();
 }
 
+void GaussianTracker::on_snapshot(Snapshot& snapshot) const
+{
+    snapshot.write_string("GaussianTracker");
+    snapshot.write_matrix(belief_.mean());
+    snapshot.write_matrix(belief_.covariance());
+    snapshot.write<std::int32_t>(update_count_);
+}
+
+void GaussianTracker::on_restore(Snapshot::Reader& reader)
+{
+    reader.expect("GaussianTracker");
+
+    State mean;
+    reader.read_matrix(mean);
+    auto covariance = belief_.covariance();
+    reader.read_matrix(covariance);
+    if (mean.size() != belief_.mean().size() ||
+        covariance.rows() != mean.size() || covariance.cols() != mean.size())
+    {
+        throw InvalidSnapshotException("the belief does not match");
+    }
+
+    belief_.mean(mean);
+    belief_.covariance(covariance);
+    update_count_ = reader.read<std::int32_t>();
+}
+
 auto GaussianTracker::on_track(const Obsrv& obsrv) -> State
 {
     // the following is approximately ok, but to be correct in a differential
@@ -64,8 +114,44 @@ auto GaussianTracker::on_track(const Obsrv& obsrv) -> State
     zero_pose.set_zero_pose();
     belief_.mean(zero_pose);
 
-    filter_->predict(belief_, zero_input(), belief_);
-    filter_->update(belief_, obsrv, belief_);
+    Instrumentation* instrumentation = instrumentation_.get();
+    {
+        ScopedStageTimer timer(instrumentation, Stage::Propagate);
+        filter_->predict(belief_, zero_input(), belief_);
+    }
+    if (batch_render_sigma_points_)
+    {
+        ScopedStageTimer timer(instrumentation, Stage::Render);
+        render_sigma_points(belief_);
+    }
+
+    {
+        ScopedStageTimer timer(instrumentation, Stage::Weigh);
+        if (active_pixels_ && update_count_ > 0)
+        {
+            // inactive pixels are missing measurements to the filter
+            {
+                ScopedStageTimer timer(instrumentation, Stage::Render);
+                select_active_pixels(old_pose);
+            }
+            active_obsrv_ = obsrv;
+            active_pixels_->mask(active_obsrv_);
+            filter_->update(belief_, active_obsrv_, belief_);
+            if (instrumentation->recording())
+            {
+                instrumentation->add_pixels(active_pixels_->count());
+            }
+        }
+        else
+        {
+            filter_->update(belief_, obsrv, belief_);
+            if (instrumentation->recording())
+            {
+                instrumentation->add_pixels(obsrv.size());
+            }
+        }
+    }
+    ++update_count_;
 
     State delta_mean = belief_.mean();
     State new_pose = old_pose;
@@ -75,4 +161,45 @@ auto GaussianTracker::on_track(const Obsrv& obsrv) -> State
 
     return belief_.mean();
 }
+
+void GaussianTracker::render_sigma_points(const Belief& belief)
+{
+    auto& local_sensor = filter_->sensor().local_sensor();
+
+    // The update integrates over the state joint with the noise of a single
+    // pixel. The sigma points along the noise dimensions keep the state at
+    // the mean, hence only 2 * state_dim + 1 distinct states are rendered.
+    // The sigma points are spread by sqrt(dim + lambda) with
+    // lambda = alpha^2 * (dim + kappa) - dim and kappa = 0. Mispredicted
+    // states are rendered on their first lookup.
+    const State& mean = belief.mean();
+    const int state_dim = mean.size();
+    const int dim = state_dim + local_sensor.noise_dimension();
+    const double gamma = ut_alpha_ * std::sqrt(double(dim));
+
+    const auto& square_root = belief.square_root();
+
+    std::vector<State> sigma_points(1, mean);
+    for (int i = 0; i < state_dim; ++i)
+    {
+        sigma_points.push_back(State(mean + gamma * square_root.col(i)));
+        sigma_points.push_back(State(mean - gamma * square_root.col(i)));
+    }
+
+    local_sensor.body_model().render_sigma_points(sigma_points);
+}
+
+void GaussianTracker::select_active_pixels(const State& pose)
+{
+    std::vector<RigidBodyRenderer::Matrix> rotations(pose.count());
+    std::vector<RigidBodyRenderer::Vector> translations(pose.count());
+    for (int i = 0; i < pose.count(); ++i)
+    {
+        rotations[i] = pose.component(i).orientation().rotation_matrix();
+        translations[i] = pose.component(i).position();
+    }
+
+    silhouette_renderer_->Render(rotations, translations, silhouette_);
+    active_pixels_->update(silhouette_);
+}
 }
@@ -30,7 +30,9 @@
 #pragma once
 
 #include <dbot/tracker/tracker.hpp>
+#include <dbot/rigid_body_renderer.hpp>
 #include <dbot/model/depth_pixel_model.hpp>
+#include <dbot/model/active_pixel_set.hpp>
 
 #include <fl/util/types.hpp>
 #include <fl/model/transition/linear_transition.hpp>
@@ -113,8 +115,57 @@ public:
      */
     State on_initialize(const std::vector<State>& initial_states);
 
+    /** \brief Appends the mean and the covariance of the belief */
+    void on_snapshot(Snapshot& snapshot) const;
+
+    void on_restore(Snapshot::Reader& reader);
+
+    /**
+     * \brief Enables rendering the sigma points of each update in one batch
+     *    of the renderer before the update evaluates the pixels
+     *
+     * \param enabled
+     *     Whether the sigma points are rendered in one batch
+     * \param ut_alpha
+     *     Alpha parameter of the unscented transform of the filter
+     */
+    void batch_render_sigma_points(bool enabled, double ut_alpha);
+
+    /**
+     * \brief Restricts the updates following the first one to the given
+     *    pixel set, which is selected from the silhouette of the mean pose
+     *    before every update. Null evaluates all pixels.
+     *
+     * \param active_pixels
+     *     Pixel set of the camera resolution
+     * \param renderer
+     *     Renderer of the silhouettes at the camera resolution
+     */
+    void active_pixels(const std::shared_ptr<ActivePixelSet>& active_pixels,
+                       const std::shared_ptr<RigidBodyRenderer>& renderer);
+
+private:
+    /**
+     * \brief Renders the state sigma points the unscented transform of the
+     *    update will compute from the given predicted belief
+     */
+    void render_sigma_points(const Belief& belief);
+
+    /**
+     * \brief Selects the active pixels around the given pose
+     */
+    void select_active_pixels(const State& pose);
+
 private:
     std::shared_ptr<Filter> filter_;
     Belief belief_;
+    bool batch_render_sigma_points_;
+    double ut_alpha_;
+
+    std::shared_ptr<ActivePixelSet> active_pixels_;
+    std::shared_ptr<RigidBodyRenderer> silhouette_renderer_;
+    std::vector<float> silhouette_;
+    Obsrv active_obsrv_;
+    int update_count_;
 };
 }
@@ -0,0 +1,123 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gaussian_tracker_benchmark.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include <dbot/camera_data.hpp>
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/builder/gaussian_tracker_builder.hpp>
+
+typedef dbot::GaussianTrackerBuilder Builder;
+
+/**
+ * \brief Creates an empty package directory with a meshes subdirectory
+ */
+static std::string make_package()
+{
+    char path[] = "/tmp/dbot_benchmark_XXXXXX";
+    if (!mkdtemp(path) ||
+        mkdir((std::string(path) + "/meshes").c_str(), 0755) != 0)
+    {
+        throw std::runtime_error("Cannot create a temporary directory");
+    }
+    return path;
+}
+
+/**
+ * \brief Tracks a static synthetic scene. The object is loaded from
+ *        wavefront files as in the tracking nodes.
+ *
+ * Arguments: downsampling factor of the 640 x 480 camera, latitude bands of
+ * each sphere, number of parts, number of threads rendering the sigma points
+ */
+static void BM_GaussianTracker_Track(benchmark::State& state)
+{
+    const int downsampling = state.range(0);
+    const int rings = state.range(1);
+    const int part_count = state.range(2);
+    const int thread_count = state.range(3);
+
+    dbot::SyntheticObjectLoader loader(part_count, rings);
+
+    Builder::Parameters params;
+    params.ut_alpha = 1.0;
+    params.moving_average_update_rate = 1.0;
+    params.center_object_frame = false;
+    params.thread_count = thread_count;
+    params.ori = loader.write(make_package());
+
+    params.observation.bg_depth = 7.0;
+    params.observation.fg_noise_std = 0.001;
+    params.observation.bg_noise_std = 0.5;
+    params.observation.tail_weight = 0.01;
+    params.observation.uniform_tail_min = 0.0;
+    params.observation.uniform_tail_max = 7.0;
+    params.observation.sensors = 1;
+
+    params.object_transition.linear_sigma_x = 0.002;
+    params.object_transition.linear_sigma_y = 0.002;
+    params.object_transition.linear_sigma_z = 0.002;
+    params.object_transition.angular_sigma_x = 0.01;
+    params.object_transition.angular_sigma_y = 0.01;
+    params.object_transition.angular_sigma_z = 0.01;
+    params.object_transition.velocity_factor = 0.8;
+    params.object_transition.part_count = part_count;
+
+    // the scene is rendered from the same files the tracker loads
+    dbot::ObjectModel object_model(
+        std::make_shared<dbot::SyntheticObjectLoader>(loader), false);
+    auto poses = dbot::SyntheticCameraDataProvider::poses(part_count);
+    auto camera = std::make_shared<dbot::SyntheticCameraDataProvider>(
+        downsampling, object_model, poses);
+    auto camera_data = std::make_shared<dbot::CameraData>(camera);
+
+    auto tracker = Builder(params, camera_data).build();
+
+    Builder::State initial_state(part_count);
+    for (int part = 0; part < part_count; ++part)
+    {
+        initial_state.component(part).affine(poses[part]);
+    }
+    tracker->initialize({initial_state});
+
+    const auto image = camera_data->depth_image_view();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(tracker->track(image));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GaussianTracker_Track)
+    ->ArgNames({"downsampling", "rings", "parts", "threads"})
+    ->Args({4, 16, 1, 1})
+    ->Args({2, 16, 1, 1})
+    ->Args({4, 64, 1, 1})
+    ->Args({4, 16, 4, 1})
+    ->Args({4, 16, 4, 0})
+    ->Unit(benchmark::kMillisecond);
@@ -21,11 +21,16 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 #include <dbot/tracker/particle_tracker.hpp>
 
 namespace dbot
 {
-ParticleTracker::ParticleTracker(
+template <typename FilterState>
+BasicParticleTracker<FilterState>::BasicParticleTracker(
     const std::shared_ptr<Filter>& filter,
     const std::shared_ptr<ObjectModel>& object_model,
     int evaluation_count,
@@ -33,43 +38,254 @@ ParticleTracker::ParticleTracker(
     bool center_object_frame)
     : Tracker(object_model, update_rate, center_object_frame),
       filter_(filter),
-      evaluation_count_(evaluation_count)
+      evaluation_count_(evaluation_count),
+      nominal_delta_time_(filter->sensor()->delta_time()),
+      particle_count_(0),
+      uncertainty_(0)
 {
+    filter_->instrumentation(instrumentation_);
+    initial_poses_ = filter_->sensor()->integrated_poses();
 }
 
-auto ParticleTracker::on_initialize(
-    const std::vector<State>& initial_states) -> State
+template <typename FilterState>
+auto BasicParticleTracker<FilterState>::on_initialize(
+    const std::vector<Tracker::State>& initial_states) -> Tracker::State
 {
-    filter_->set_particles(initial_states);
+    std::vector<State> states;
+    for (const auto& initial_state : initial_states)
+    {
+        states.push_back(State(initial_state));
+    }
+
+    // previous steps have moved their means into the integrated poses
+    filter_->sensor()->integrated_poses() = initial_poses_;
+    filter_->set_particles(states);
     filter_->resample(evaluation_count_ / filter_->sampling_blocks().size());
 
-    State delta_mean = filter_->belief().mean();
+    return integrate_mean();
+}
+
+template <typename FilterState>
+auto BasicParticleTracker<FilterState>::on_relocalize(
+    const Obsrv& image,
+    const std::vector<Tracker::State>& candidates,
+    int hypothesis_count) -> Tracker::State
+{
+    auto sensor = filter_->sensor();
+    sensor->integrated_poses() = initial_poses_;
+    sensor->set_observation(image);
+
+    // the sensor supports the particles of a sampling block
+    const int batch_size = std::max<int>(
+        1, evaluation_count_ / filter_->sampling_blocks().size());
+
+    const int count = candidates.size();
+    candidate_loglikes_.resize(count);
+    for (int begin = 0; begin < count; begin += batch_size)
+    {
+        const int size = std::min(batch_size, count - begin);
+        candidate_batch_.resize(size);
+        for (int i = 0; i < size; ++i)
+        {
+            candidate_batch_(i) = State(candidates[begin + i]);
+        }
+
+        // evaluates without occlusions carried over from other candidates
+        const auto loglikes = sensor->loglikes(candidate_batch_);
+        for (int i = 0; i < size; ++i)
+        {
+            candidate_loglikes_[begin + i] = loglikes(i);
+        }
+    }
 
-    for (size_t i = 0; i < filter_->belief().size(); i++)
+    hypothesis_count = std::max(1, std::min(hypothesis_count, count));
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(),
+                      order.begin() + hypothesis_count,
+                      order.end(),
+                      [this](int a, int b)
+                      {
+                          return candidate_loglikes_[a] >
+                                 candidate_loglikes_[b];
+                      });
+
+    std::vector<Tracker::State> hypotheses;
+    for (int k = 0; k < hypothesis_count; ++k)
     {
-        filter_->belief().location(i).subtract(delta_mean);
+        hypotheses.push_back(candidates[order[k]]);
     }
 
-    auto& integrated_poses = filter_->sensor()->integrated_poses();
-    integrated_poses.apply_delta(delta_mean);
+    return on_initialize(hypotheses);
+}
 
-    return integrated_poses;
+template <typename FilterState>
+auto BasicParticleTracker<FilterState>::on_track(const Obsrv& image)
+    -> Tracker::State
+{
+    filter_->filter(image, zero_input());
+    integrate_mean();
+
+    if (depth_alignment_)
+    {
+        refine(DepthImageView::copy(image,
+                                    depth_alignment_->n_rows(),
+                                    depth_alignment_->n_cols()));
+    }
+
+    return filter_->sensor()->integrated_poses();
 }
 
-auto ParticleTracker::on_track(const Obsrv& image) -> State
+template <typename FilterState>
+auto BasicParticleTracker<FilterState>::on_track(const DepthImageView& image)
+    -> Tracker::State
 {
     filter_->filter(image, zero_input());
+    integrate_mean();
+    refine(image);
+
+    return filter_->sensor()->integrated_poses();
+}
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::on_delta_time(double delta_time)
+{
+    if (!(delta_time > 0)) delta_time = nominal_delta_time_;
+
+    filter_->sensor()->delta_time(delta_time);
+    filter_->time_scale(delta_time / nominal_delta_time_);
+}
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::on_snapshot(Snapshot& snapshot) const
+{
+    snapshot.write_string("ParticleTracker");
+    snapshot.write_matrix(filter_->sensor()->integrated_poses());
+    filter_->snapshot(snapshot);
+}
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::on_restore(Snapshot::Reader& reader)
+{
+    reader.expect("ParticleTracker");
+
+    auto& integrated_poses = filter_->sensor()->integrated_poses();
+    typename Sensor::PoseArray poses;
+    reader.read_matrix(poses);
+    if (poses.size() != integrated_poses.size())
+    {
+        throw InvalidSnapshotException("the integrated poses do not match");
+    }
+    integrated_poses = poses;
+
+    filter_->restore(reader);
+    particle_count_ = filter_->belief().size();
+}
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::particle_count(int count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (count == int(filter_->belief().size())) return;
+
+    filter_->resample(count);
+    particle_count_ = count;
+}
+
+template <typename FilterState>
+int BasicParticleTracker<FilterState>::particle_count() const
+{
+    return particle_count_;
+}
+
+template <typename FilterState>
+double BasicParticleTracker<FilterState>::uncertainty() const
+{
+    return uncertainty_;
+}
+
+template <typename FilterState>
+const BatchEvaluationService*
+BasicParticleTracker<FilterState>::batch_service() const
+{
+    return filter_->sensor()->batch_service();
+}
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::depth_alignment(
+    const std::shared_ptr<DepthAlignment>& alignment)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    State delta_mean = filter_->belief().mean();
+    depth_alignment_ = alignment;
+}
 
-    for (size_t i = 0; i < filter_->belief().size(); i++)
+template <typename FilterState>
+auto BasicParticleTracker<FilterState>::integrate_mean() -> Tracker::State
+{
+    auto& belief = filter_->belief();
+    State delta_mean = belief.mean();
+
+    // weighted squared distance of the positions from the mean
+    fl::Real variance = 0;
+    const int body_count = delta_mean.count();
+    for (size_t i = 0; i < belief.size(); i++)
     {
-        filter_->belief().location(i).subtract(delta_mean);
+        State& location = belief.location(i);
+        location.subtract(delta_mean);
+
+        fl::Real distance = 0;
+        for (int j = 0; j < body_count; ++j)
+        {
+            distance +=
+                location.template segment<3>(j * State::BodySize).squaredNorm();
+        }
+        variance += belief.prob_mass(i) * distance;
     }
+    particle_count_ = belief.size();
+    uncertainty_ = body_count > 0 ? std::sqrt(variance / body_count) : 0.;
 
+    // the sensor integrates the poses of any number of parts
     auto& integrated_poses = filter_->sensor()->integrated_poses();
-    integrated_poses.apply_delta(delta_mean);
+    integrated_poses.apply_delta(Tracker::State(delta_mean));
 
     return integrated_poses;
 }
+
+template <typename FilterState>
+void BasicParticleTracker<FilterState>::refine(const DepthImageView& image)
+{
+    if (!depth_alignment_) return;
+
+    ScopedStageTimer timer(instrumentation_.get(), Stage::Refine);
+
+    // the particles are relative to the integrated poses and thus follow
+    auto& integrated_poses = filter_->sensor()->integrated_poses();
+    const int part_count = integrated_poses.count();
+    refined_rotations_.resize(part_count);
+    refined_translations_.resize(part_count);
+    for (int i = 0; i < part_count; ++i)
+    {
+        const Eigen::Affine3d pose = integrated_poses.component(i).affine();
+        refined_rotations_[i] = pose.rotation();
+        refined_translations_[i] = pose.translation();
+    }
+
+    depth_alignment_->align(image, refined_rotations_, refined_translations_);
+
+    for (int i = 0; i < part_count; ++i)
+    {
+        Eigen::Affine3d pose;
+        pose.linear() = refined_rotations_[i];
+        pose.translation() = refined_translations_[i];
+        pose.makeAffine();
+        integrated_poses.component(i).affine(pose);
+    }
+}
+
+template class BasicParticleTracker<Tracker::State>;
+template class BasicParticleTracker<osr::FreeFloatingRigidBodiesState<1>>;
+template class BasicParticleTracker<osr::FreeFloatingRigidBodiesState<2>>;
+template class BasicParticleTracker<osr::FreeFloatingRigidBodiesState<3>>;
 }
@@ -30,19 +30,37 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include <fl/model/transition/interface/transition_function.hpp>
 
+#include <osr/free_floating_rigid_bodies_state.hpp>
+
+#include <dbot/traits.hpp>
+#include <dbot/depth_alignment.hpp>
 #include <dbot/tracker/tracker.hpp>
 #include <dbot/filter/rao_blackwell_coordinate_particle_filter.hpp>
 
 namespace dbot
 {
 /**
- * \brief ParticleTracker
+ * \brief Particle tracker whose filter samples states of type \a FilterState.
+ *
+ * The states passed to and returned by the Tracker interface are always
+ * Tracker::State. A FilterState of fixed size keeps the particles, their
+ * noises and their copies within the filter buffers, hence a filter step
+ * does not allocate memory per particle. See ParticleTracker and
+ * FixedParticleTracker.
  */
-class ParticleTracker : public Tracker
+template <typename FilterState>
+class BasicParticleTracker : public Tracker
 {
 public:
+    typedef FilterState State;
+    typedef typename ObjectStateTrait<State>::Noise Noise;
+    typedef typename ObjectStateTrait<State>::Input Input;
+
     typedef fl::TransitionFunction<State, Noise, Input> Transition;
     typedef RbSensor<State> Sensor;
 
@@ -61,15 +79,14 @@ public:
      * \param update_rate
      *     Moving average update rate
      */
-    ParticleTracker(
+    BasicParticleTracker(
         const std::shared_ptr<Filter>& filter,
         const std::shared_ptr<ObjectModel>& object_model,
         int evaluation_count,
         double update_rate,
         bool center_object_frame);
-    
 
-    virtual ~ParticleTracker() { }
+    virtual ~BasicParticleTracker() { }
 
     /**
      * \brief perform a single filter step
@@ -77,7 +94,13 @@ public:
      * \param image
      *     Current observation image
      */
-    State on_track(const Obsrv& image);
+    Tracker::State on_track(const Obsrv& image);
+
+    /**
+     * \brief perform a single filter step on the float depths of the image
+     *        without converting them
+     */
+    Tracker::State on_track(const DepthImageView& image);
 
     /**
      * \brief Initializes the particle filter with the given initial states and
@@ -85,10 +108,113 @@ public:
      * @param initial_states
      * @param evaluation_count
      */
-    State on_initialize(const std::vector<State>& initial_states);
+    Tracker::State on_initialize(
+        const std::vector<Tracker::State>& initial_states);
+
+    /**
+     * \brief Scores all candidates on \a image through the sensor in batches
+     *        of the evaluation count and initializes the particle filter with
+     *        the \a hypothesis_count best ones
+     */
+    Tracker::State on_relocalize(const Obsrv& image,
+                                 const std::vector<Tracker::State>& candidates,
+                                 int hypothesis_count);
+
+    /**
+     * \brief Sets the time of the next step of the sensor and scales the
+     *        noise of the transition to it, see
+     *        RaoBlackwellCoordinateParticleFilter::time_scale(). Unknown or
+     *        non-positive times select the delta time of the sensor at
+     *        construction.
+     */
+    void on_delta_time(double delta_time);
+
+    /**
+     * \brief Appends the integrated poses of the sensor and the particles,
+     *        weights and occlusions of the filter, see
+     *        RaoBlackwellCoordinateParticleFilter::snapshot()
+     */
+    void on_snapshot(Snapshot& snapshot) const;
+
+    void on_restore(Snapshot::Reader& reader);
+
+    /**
+     * \brief Resamples the belief to \a count particles. The sensor has to
+     *        support \a count particles, see RbSensorBuilder::Parameters.
+     */
+    void particle_count(int count);
+
+    int particle_count() const;
+
+    double uncertainty() const;
+
+    const BatchEvaluationService* batch_service() const;
+
+    /**
+     * \brief Aligns the mean pose of each step with its observation, see
+     *        DepthAlignment. The particles move along with the mean. The
+     *        closer mean allows for fewer particles at the same accuracy.
+     *        Null disables the refinement.
+     */
+    void depth_alignment(const std::shared_ptr<DepthAlignment>& alignment);
+
+private:
+    /**
+     * \brief Moves the mean of the particles into the integrated poses of the
+     *        sensor
+     * \return the integrated poses
+     */
+    Tracker::State integrate_mean();
+
+    /**
+     * \brief Refines the integrated poses of the sensor by the depth
+     *        alignment on \a image, if any
+     */
+    void refine(const DepthImageView& image);
 
 private:
     std::shared_ptr<Filter> filter_;
     int evaluation_count_;
+
+    // the time the transition and the sensor have been set up for
+    fl::Real nominal_delta_time_;
+
+    // integrated poses of the sensor before the first step, the states
+    // passed to on_initialize() are relative to these
+    typename Sensor::PoseArray initial_poses_;
+
+    // buffers of on_relocalize()
+    typename Sensor::StateArray candidate_batch_;
+    std::vector<fl::Real> candidate_loglikes_;
+
+    // refinement of the mean and its buffers
+    std::shared_ptr<DepthAlignment> depth_alignment_;
+    std::vector<Eigen::Matrix3d> refined_rotations_;
+    std::vector<Eigen::Vector3d> refined_translations_;
+
+    // published at the end of each step
+    std::atomic<int> particle_count_;
+    std::atomic<double> uncertainty_;
 };
+
+/**
+ * \brief Tracks any number of parts
+ */
+typedef BasicParticleTracker<Tracker::State> ParticleTracker;
+
+/**
+ * \brief Tracks exactly \a Objects parts with particles of fixed size.
+ *        Instantiated for one to three parts.
+ */
+template <int Objects>
+using FixedParticleTracker =
+    BasicParticleTracker<osr::FreeFloatingRigidBodiesState<Objects>>;
+
+extern template class BasicParticleTracker<Tracker::State>;
+extern template class BasicParticleTracker<
+    osr::FreeFloatingRigidBodiesState<1>>;
+extern template class BasicParticleTracker<
+    osr::FreeFloatingRigidBodiesState<2>>;
+extern template class BasicParticleTracker<
+    osr::FreeFloatingRigidBodiesState<3>>;
 }
@@ -0,0 +1,169 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_candidates.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include <dbot/tracker/tracker.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Moves the object of \a state rigidly such that its first part has
+ *        the position \a position and the orientation \a orientation. The
+ *        other parts keep their poses relative to the first part.
+ */
+inline Tracker::State place_object(const Tracker::State& state,
+                                   const Eigen::Vector3d& position,
+                                   const Eigen::Quaterniond& orientation)
+{
+    Tracker::State placed = state;
+    if (state.count() == 0) return placed;
+
+    const Eigen::Vector3d anchor = state.component(0).position();
+    const Eigen::Quaterniond rotation =
+        orientation * state.component(0).orientation().quaternion().inverse();
+
+    for (int j = 0; j < state.count(); ++j)
+    {
+        placed.component(j).position() =
+            position + rotation * (state.component(j).position() - anchor);
+        placed.component(j).orientation().quaternion(
+            rotation * state.component(j).orientation().quaternion());
+    }
+
+    return placed;
+}
+
+/**
+ * \brief Candidate poses of the object of \a center for
+ *        Tracker::relocalize(), the first part is placed on a grid of
+ *        \a position_steps^3 positions spanning \a position_range meters
+ *        around its position in each direction.
+ *
+ * Each position is combined with the orientation of \a center and
+ * \a orientation_count - 1 uniformly drawn orientations, which are the same
+ * for all positions. Returns position_steps^3 * orientation_count
+ * candidates.
+ */
+inline std::vector<Tracker::State> pose_grid(const Tracker::State& center,
+                                             double position_range,
+                                             int position_steps,
+                                             int orientation_count,
+                                             unsigned int seed = 0)
+{
+    std::vector<Tracker::State> candidates;
+    if (center.count() == 0 || position_steps < 1 || orientation_count < 1)
+    {
+        return candidates;
+    }
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normal;
+
+    // normalized 4d gaussians are uniform rotations
+    std::vector<Eigen::Quaterniond> orientations(
+        1, center.component(0).orientation().quaternion());
+    while (int(orientations.size()) < orientation_count)
+    {
+        Eigen::Quaterniond q(normal(generator),
+                             normal(generator),
+                             normal(generator),
+                             normal(generator));
+        orientations.push_back(q.normalized());
+    }
+
+    const double step =
+        position_steps > 1 ? 2 * position_range / (position_steps - 1) : 0;
+    const Eigen::Vector3d origin =
+        center.component(0).position() -
+        Eigen::Vector3d::Constant(position_steps > 1 ? position_range : 0);
+
+    candidates.reserve(position_steps * position_steps * position_steps *
+                       orientation_count);
+    for (int x = 0; x < position_steps; ++x)
+    {
+        for (int y = 0; y < position_steps; ++y)
+        {
+            for (int z = 0; z < position_steps; ++z)
+            {
+                const Eigen::Vector3d position =
+                    origin + step * Eigen::Vector3d(x, y, z);
+
+                for (const auto& orientation : orientations)
+                {
+                    candidates.push_back(
+                        place_object(center, position, orientation));
+                }
+            }
+        }
+    }
+
+    return candidates;
+}
+
+/**
+ * \brief \a count candidate poses of the object of \a center for
+ *        Tracker::relocalize() with the first part uniformly drawn within
+ *        the box [min_position, max_position] of the camera frame and
+ *        uniformly drawn orientations, e.g. to search the workspace
+ */
+inline std::vector<Tracker::State> random_poses(
+    const Tracker::State& center,
+    const Eigen::Vector3d& min_position,
+    const Eigen::Vector3d& max_position,
+    int count,
+    unsigned int seed = 0)
+{
+    std::vector<Tracker::State> candidates;
+    if (center.count() == 0) return candidates;
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+
+    candidates.reserve(std::max(count, 0));
+    for (int i = 0; i < count; ++i)
+    {
+        Eigen::Vector3d position;
+        for (int k = 0; k < 3; ++k)
+        {
+            position(k) = min_position(k) + uniform(generator) *
+                                                (max_position(k) -
+                                                 min_position(k));
+        }
+
+        Eigen::Quaterniond orientation(normal(generator),
+                                       normal(generator),
+                                       normal(generator),
+                                       normal(generator));
+
+        candidates.push_back(
+            place_object(center, position, orientation.normalized()));
+    }
+
+    return candidates;
+}
+}
@@ -0,0 +1,79 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_candidates_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <dbot/tracker/pose_candidates.hpp>
+
+using dbot::Tracker;
+
+TEST(PoseCandidatesTests, grid_spans_the_range)
+{
+    Tracker::State center(2);
+    center.component(0).position() = Eigen::Vector3d(0, 0, 1);
+    center.component(1).position() = Eigen::Vector3d(0.1, 0, 1);
+
+    auto candidates = dbot::pose_grid(center, 0.05, 3, 4);
+    ASSERT_EQ(candidates.size(), 3 * 3 * 3 * 4);
+
+    // the first orientation is the one of the center
+    EXPECT_TRUE(candidates[0].component(0).position().isApprox(
+        Eigen::Vector3d(-0.05, -0.05, 0.95)));
+    EXPECT_TRUE(candidates[0].component(1).position().isApprox(
+        Eigen::Vector3d(0.05, -0.05, 0.95)));
+    EXPECT_TRUE(candidates.back().component(0).position().isApprox(
+        Eigen::Vector3d(0.05, 0.05, 1.05)));
+
+    // the parts are moved rigidly
+    for (const auto& candidate : candidates)
+    {
+        EXPECT_NEAR((candidate.component(1).position() -
+                     candidate.component(0).position()).norm(),
+                    0.1,
+                    1e-12);
+    }
+
+    EXPECT_EQ(dbot::pose_grid(center, 0.05, 1, 1).size(), 1);
+    EXPECT_TRUE(dbot::pose_grid(center, 0.05, 0, 1).empty());
+}
+
+TEST(PoseCandidatesTests, random_poses_stay_within_the_box)
+{
+    Tracker::State center(1);
+    const Eigen::Vector3d min_position(-0.3, -0.2, 0.5);
+    const Eigen::Vector3d max_position(0.3, 0.2, 1.5);
+
+    auto candidates =
+        dbot::random_poses(center, min_position, max_position, 500, 7);
+    ASSERT_EQ(candidates.size(), 500);
+
+    for (const auto& candidate : candidates)
+    {
+        const Eigen::Vector3d position = candidate.component(0).position();
+        EXPECT_TRUE((position.array() >= min_position.array()).all());
+        EXPECT_TRUE((position.array() <= max_position.array()).all());
+    }
+
+    // deterministic for a seed
+    auto again = dbot::random_poses(center, min_position, max_position, 500, 7);
+    EXPECT_EQ(again[42].component(0).position(),
+              candidates[42].component(0).position());
+}
@@ -11,6 +11,11 @@
  * file distributed with this source code.
  */
 
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <exception>
+
 #include <fl/util/profiling.hpp>
 #include <dbot/tracker/tracker.hpp>
 
@@ -22,7 +27,12 @@ Tracker::Tracker(const std::shared_ptr<ObjectModel> &object_model,
     : object_model_(object_model),
       update_rate_(update_rate),
       center_object_frame_(center_object_frame),
-      moving_average_(object_model_->count_parts())
+      moving_average_(object_model_->count_parts()),
+      instrumentation_(std::make_shared<Instrumentation>()),
+      publication_(1 + moving_average_.size()),
+      frame_time_(std::numeric_limits<double>::quiet_NaN()),
+      dropped_frames_(0),
+      reported_dropped_frames_(0)
 {
 }
 
@@ -37,6 +47,76 @@ void Tracker::initialize(const std::vector<State>& initial_states)
     }
 
     moving_average_ = to_model_coordinate_system(on_initialize(states));
+    frame_time_ = std::numeric_limits<double>::quiet_NaN();
+    publish();
+}
+
+auto Tracker::relocalize(const Obsrv& image,
+                         const std::vector<State>& candidates,
+                         int hypothesis_count) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<State> states;
+    for (const auto& candidate : candidates)
+    {
+        states.push_back(to_center_coordinate_system(candidate));
+    }
+
+    moving_average_ = to_model_coordinate_system(
+        on_relocalize(image, states, hypothesis_count));
+    frame_time_ = std::numeric_limits<double>::quiet_NaN();
+    publish();
+
+    return moving_average_;
+}
+
+Snapshot Tracker::snapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Snapshot snapshot;
+    snapshot.write<std::uint32_t>(object_model_->count_parts());
+    snapshot.write_matrix(moving_average_);
+    snapshot.write(frame_time_);
+    on_snapshot(snapshot);
+
+    return snapshot;
+}
+
+void Tracker::restore(const Snapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Snapshot::Reader reader(snapshot);
+    const std::uint32_t part_count = object_model_->count_parts();
+    if (reader.read<std::uint32_t>() != part_count)
+    {
+        throw InvalidSnapshotException("the part count does not match");
+    }
+    State moving_average;
+    reader.read_matrix(moving_average);
+    if (moving_average.size() != moving_average_.size())
+    {
+        throw InvalidSnapshotException("the moving average does not match");
+    }
+    const double frame_time = reader.read<double>();
+    on_restore(reader);
+    if (!reader.at_end())
+    {
+        throw InvalidSnapshotException("the snapshot has trailing data");
+    }
+
+    moving_average_ = moving_average;
+    frame_time_ = frame_time;
+    publish();
+}
+
+auto Tracker::on_relocalize(const Obsrv& image,
+                            const std::vector<State>& candidates,
+                            int hypothesis_count) -> State
+{
+    return on_initialize(candidates);
 }
 
 void Tracker::move_average(const Tracker::State& new_state,
@@ -72,13 +152,195 @@ auto Tracker::track(const Obsrv& image) -> State
 {
     std::lock_guard<std::mutex> lock(mutex_);
 
+    frame_time_ = std::numeric_limits<double>::quiet_NaN();
+    on_delta_time(frame_time_);
+
+    instrumentation_->begin_frame();
     move_average(to_model_coordinate_system(on_track(image)),
                  moving_average_,
                  update_rate_);
+    publish();
+    instrumentation_->end_frame();
 
     return moving_average_;
 }
 
+auto Tracker::track(const DepthImageView& image) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    frame_time_ = std::numeric_limits<double>::quiet_NaN();
+    return step(image, frame_time_);
+}
+
+auto Tracker::track(const DepthImageView& image, double time) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // NaN for the first frame of a sequence
+    const double delta_time = time - frame_time_;
+    frame_time_ = time;
+    return step(image, delta_time);
+}
+
+auto Tracker::step(const DepthImageView& image, double delta_time) -> State
+{
+    on_delta_time(delta_time);
+
+    instrumentation_->begin_frame();
+    if (instrumentation_->recording())
+    {
+        const std::uint64_t dropped = dropped_frames_;
+        instrumentation_->frame_timing(
+            std::isnan(delta_time) ? 0. : delta_time,
+            dropped - reported_dropped_frames_);
+        reported_dropped_frames_ = dropped;
+    }
+    move_average(to_model_coordinate_system(on_track(image)),
+                 moving_average_,
+                 update_rate_);
+    publish();
+    instrumentation_->end_frame();
+
+    return moving_average_;
+}
+
+auto Tracker::track_async(const Obsrv& image) -> std::future<State>
+{
+    return run_async([this, image]() { return track(image); });
+}
+
+auto Tracker::track_async(const DepthImageView& image) -> std::future<State>
+{
+    return run_async([this, image]() { return track(image); });
+}
+
+auto Tracker::track_latest(const DepthImageView& image, double time)
+    -> std::future<State>
+{
+    auto promise = std::make_shared<std::promise<State>>();
+    auto future = promise->get_future();
+
+    std::shared_ptr<PendingFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+
+        // the waiting frame is replaced, its step runs on the new one
+        if (pending_frame_)
+        {
+            pending_frame_->image = image;
+            pending_frame_->time = time;
+            pending_frame_->promises.push_back(promise);
+            ++dropped_frames_;
+            return future;
+        }
+
+        frame = std::make_shared<PendingFrame>();
+        frame->image = image;
+        frame->time = time;
+        frame->promises.push_back(promise);
+        pending_frame_ = frame;
+    }
+
+    run_async(
+        [this, frame]()
+        {
+            // once taken, the next frame waits for this step
+            DepthImageView image;
+            double time;
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                pending_frame_.reset();
+                image = frame->image;
+                time = frame->time;
+            }
+
+            try
+            {
+                const State state = track(image, time);
+                for (auto& promise : frame->promises)
+                {
+                    promise->set_value(state);
+                }
+                return state;
+            }
+            catch (...)
+            {
+                for (auto& promise : frame->promises)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+                throw;
+            }
+        });
+
+    return future;
+}
+
+auto Tracker::run_async(const std::function<State()>& step)
+    -> std::future<State>
+{
+    std::lock_guard<std::mutex> lock(async_mutex_);
+
+    auto result = std::make_shared<std::promise<State>>();
+
+    // waiting for the previous step keeps the steps in order
+    std::shared_future<void> previous = last_async_;
+    last_async_ = std::async(std::launch::async,
+                             [step, previous, result]()
+                             {
+                                 if (previous.valid()) previous.wait();
+                                 try
+                                 {
+                                     result->set_value(step());
+                                 }
+                                 catch (...)
+                                 {
+                                     result->set_exception(
+                                         std::current_exception());
+                                 }
+                             })
+                      .share();
+
+    return result->get_future();
+}
+
+bool Tracker::latest_state(State& state, double* time) const
+{
+    std::vector<double> values(publication_.size());
+    if (publication_.read(values) == 0) return false;
+
+    state = State(object_model_->count_parts());
+    for (int i = 0; i < state.size(); ++i)
+    {
+        state(i) = values[1 + i];
+    }
+
+    if (time) *time = values[0];
+
+    return true;
+}
+
+void Tracker::publish()
+{
+    publication_buffer_.resize(publication_.size());
+    publication_buffer_[0] =
+        std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    for (int i = 0; i < moving_average_.size(); ++i)
+    {
+        publication_buffer_[1 + i] = moving_average_(i);
+    }
+
+    publication_.write(publication_buffer_);
+}
+
+auto Tracker::on_track(const DepthImageView& image) -> State
+{
+    return on_track(Obsrv(image.vector().cast<fl::Real>()));
+}
+
 auto Tracker::to_center_coordinate_system(
     const Tracker::State& state) -> State
 {
@@ -25,8 +25,16 @@
 #include <string>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <future>
+#include <cstdint>
+#include <functional>
 
 #include <dbot/object_model.hpp>
+#include <dbot/seq_lock.hpp>
+#include <dbot/snapshot.hpp>
+#include <dbot/instrumentation.hpp>
+#include <dbot/depth_image_view.hpp>
 
 #include <osr/pose_vector.hpp>
 #include <osr/composed_vector.hpp>
@@ -35,6 +43,8 @@
 namespace dbot
 {
 
+class BatchEvaluationService;
+
 /**
  * \brief Abstract ObjectTracker context
  */
@@ -69,12 +79,49 @@ public:
      */
     virtual State on_track(const Obsrv& image) = 0;
 
+    /**
+     * \brief Hook function which is called when tracking a float depth
+     *        image. By default, the image is converted into an Obsrv.
+     * \return Current belief state
+     */
+    virtual State on_track(const DepthImageView& image);
+
     /**
      * \brief Hook function which is called during initialization
      * \return Initial belief state
      */
     virtual State on_initialize(const std::vector<State>& initial_states) = 0;
 
+    /**
+     * \brief Hook function which is called during relocalization. By
+     *        default, the tracker is initialized with the candidates
+     *        without scoring them.
+     * \return Belief state after relocalization
+     */
+    virtual State on_relocalize(const Obsrv& image,
+                                const std::vector<State>& candidates,
+                                int hypothesis_count);
+
+    /**
+     * \brief Hook function which is called before on_track() with the time
+     *        in seconds since the previous frame. The time is NaN if it is
+     *        unknown, the step then covers the nominal time of the models.
+     *        By default, the time is ignored.
+     */
+    virtual void on_delta_time(double delta_time) {}
+
+    /**
+     * \brief Hook function which is called by snapshot() to append the
+     *        state of the filter. By default, nothing is appended.
+     */
+    virtual void on_snapshot(Snapshot& snapshot) const {}
+
+    /**
+     * \brief Hook function which is called by restore() to read the state
+     *        appended by on_snapshot()
+     */
+    virtual void on_restore(Snapshot::Reader& reader) {}
+
     /**
      * \brief perform a single filter step
      *
@@ -83,6 +130,73 @@ public:
      */
     virtual State track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step on a float depth image, e.g. a view
+     *        of the frame obtained via CameraData::depth_image_view(). The
+     *        image is only accessed within this call.
+     *
+     * \param image
+     *     Current observation image
+     */
+    virtual State track(const DepthImageView& image);
+
+    /**
+     * \brief perform a single filter step on the float depth image taken at
+     *        \a time in seconds. The models cover the time since the frame
+     *        of the previous call, e.g. twice their nominal time after a
+     *        dropped frame, see on_delta_time(). Steps without a time stamp
+     *        and initialize() interrupt the sequence of time stamps.
+     */
+    State track(const DepthImageView& image, double time);
+
+    /**
+     * \brief Runs track() on a separate thread. Consecutive calls are
+     *        processed in the order of the calls. The image is copied. The
+     *        tracker must outlive the returned future.
+     *
+     * \return the future of the state returned by track()
+     */
+    std::future<State> track_async(const Obsrv& image);
+
+    /**
+     * \brief Runs track() on a separate thread, see track_async(). The view
+     *        has to stay valid until the future is ready, e.g. by owning its
+     *        buffer.
+     */
+    std::future<State> track_async(const DepthImageView& image);
+
+    /**
+     * \brief Runs track(image, time) on a separate thread for real-time
+     *        tracking. Unlike track_async(), at most one frame waits for the
+     *        running step: a frame which is still waiting when the next one
+     *        arrives is dropped in favor of the newer one, hence the latency
+     *        stays within about two steps if the tracker falls behind the
+     *        camera. The future of a dropped frame receives the state of the
+     *        frame which replaced it. The view has to stay valid until the
+     *        future is ready or the frame has been dropped.
+     */
+    std::future<State> track_latest(const DepthImageView& image, double time);
+
+    /**
+     * \return the number of frames dropped by track_latest() so far. May be
+     *         called from any thread.
+     */
+    std::uint64_t dropped_frames() const { return dropped_frames_; }
+
+    /**
+     * \brief Copies the last state returned by track() or initialize()
+     *        without waiting for a running filter step. May be called from
+     *        any thread at any rate.
+     *
+     * \param state
+     *     the latest state
+     * \param time
+     *     if not null, the steady clock time in seconds at which the state
+     *     has been published
+     * \return false if no state has been published yet
+     */
+    bool latest_state(State& state, double* time = nullptr) const;
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *     the number of evaluations
@@ -91,6 +205,41 @@ public:
      */
     virtual void initialize(const std::vector<State>& initial_states);
 
+    /**
+     * \brief Re-initializes the tracker from the \a hypothesis_count
+     *        candidates which explain \a image best, e.g. after the track
+     *        has been lost. Particle trackers score the candidates in
+     *        batches of their evaluation count, such that a few thousand
+     *        candidates take a few filter steps on the GPU. See pose_grid()
+     *        and random_poses() to create candidates around a detection or
+     *        over the workspace.
+     *
+     * \param candidates
+     *     poses of the object in the model coordinate system, not empty
+     * \return the state after relocalization
+     */
+    virtual State relocalize(const Obsrv& image,
+                             const std::vector<State>& candidates,
+                             int hypothesis_count);
+
+    /**
+     * \brief Writes the state of the tracker, i.e. the moving average and
+     *        the belief of the filter, e.g. every few seconds such that a
+     *        standby process takes over within a frame. Waits for a running
+     *        step.
+     */
+    Snapshot snapshot();
+
+    /**
+     * \brief Continues from the snapshot of a tracker of the same type and
+     *        configuration, e.g. after a restart of the process. Waits for a
+     *        running step.
+     *
+     * \throws InvalidSnapshotException if the snapshot does not match the
+     *         tracker, the tracker is then to be initialized
+     */
+    void restore(const Snapshot& snapshot);
+
     /**
      * \brief Transforms the given state or pose in the model coordinate system
      *        to the center coordinate system
@@ -129,11 +278,93 @@ public:
      */
     Input zero_input() const;
 
+    /**
+     * \brief Timings and counters of the filter steps. Disabled until
+     *        instrumentation()->enable(true) is called, the statistics of
+     *        each track() call are then available through
+     *        Instrumentation::last_frame() or its callback.
+     */
+    const std::shared_ptr<Instrumentation>& instrumentation() const
+    {
+        return instrumentation_;
+    }
+
+    /**
+     * \return the number of particles sampled per step, 0 for trackers
+     *         which do not sample particles. May be called from any thread.
+     */
+    virtual int particle_count() const { return 0; }
+
+    /**
+     * \brief Sets the number of particles of the following steps, e.g. to
+     *        meet a compute budget. Ignored by trackers which do not sample
+     *        particles. Waits for a running step.
+     */
+    virtual void particle_count(int count) {}
+
+    /**
+     * \return the root mean square distance in meters of the positions of
+     *         the particles of the last step from their mean, 0 for trackers
+     *         which do not sample particles. May be called from any thread.
+     */
+    virtual double uncertainty() const { return 0; }
+
+    /**
+     * \return the service shared with other trackers whose steps wait for
+     *         each other, or null, see RbSensor::batch_service()
+     */
+    virtual const BatchEvaluationService* batch_service() const
+    {
+        return nullptr;
+    }
+
+protected:
+    /**
+     * \brief Publishes moving_average_ to latest_state(). Called while
+     *        holding mutex_.
+     */
+    void publish();
+
+private:
+    /** \brief Frame of track_latest() waiting for the running step */
+    struct PendingFrame
+    {
+        DepthImageView image;
+        double time;
+        std::vector<std::shared_ptr<std::promise<State>>> promises;
+    };
+
+    /** \brief Runs the step after the previous one on a separate thread */
+    std::future<State> run_async(const std::function<State()>& step);
+
+    /** \brief Runs on_track() with the time since the previous frame */
+    State step(const DepthImageView& image, double delta_time);
+
 protected:
     std::shared_ptr<ObjectModel> object_model_;
     State moving_average_;
     double update_rate_;
     bool center_object_frame_;
     std::mutex mutex_;
+
+    // recorded around each on_track() call
+    std::shared_ptr<Instrumentation> instrumentation_;
+
+    // lock-free publication of [time, moving_average_]
+    SeqLock publication_;
+    std::vector<double> publication_buffer_;
+
+    std::mutex async_mutex_;
+    std::shared_future<void> last_async_;
+
+    // time stamp of the previous frame of track(image, time), NaN if the
+    // sequence has been interrupted
+    double frame_time_;
+
+    // frames dropped by track_latest() and their number at the last step,
+    // the pending frame is guarded by async_mutex_
+    std::shared_ptr<PendingFrame> pending_frame_;
+    std::atomic<std::uint64_t> dropped_frames_;
+    std::uint64_t reported_dropped_frames_;
 };
 }
@@ -0,0 +1,257 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_scheduler.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include <dbot/instrumentation.hpp>
+#include <dbot/tracker/tracker_scheduler.hpp>
+
+namespace dbot
+{
+TrackerScheduler::TrackerScheduler() : TrackerScheduler(Parameters()) {}
+
+TrackerScheduler::TrackerScheduler(const Parameters& params) : params_(params)
+{
+}
+
+int TrackerScheduler::add(const std::shared_ptr<Tracker>& tracker)
+{
+    // the sequential steps of such trackers would wait for each other
+    const BatchEvaluationService* service = tracker->batch_service();
+    for (const Entry& entry : entries_)
+    {
+        if (service && entry.tracker->batch_service() == service)
+        {
+            throw SharedBatchServiceException();
+        }
+    }
+
+    Entry entry;
+    entry.tracker = tracker;
+    entry.particle_seconds = -1;
+    entry.fixed_seconds = -1;
+    tracker->latest_state(entry.state);
+    tracker->instrumentation()->enable(true);
+
+    entries_.push_back(entry);
+    return entries_.size() - 1;
+}
+
+auto TrackerScheduler::track(const std::vector<DepthImageView>& images)
+    -> std::vector<Tracker::State>
+{
+    assert(images.size() == entries_.size());
+
+    const auto start = Instrumentation::Clock::now();
+
+    // skipped trackers first, then the uncertain ones
+    std::vector<int> order(entries_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [this](int a, int b)
+                     {
+                         const Entry& ea = entries_[a];
+                         const Entry& eb = entries_[b];
+                         if (ea.step.skipped != eb.step.skipped)
+                         {
+                             return ea.step.skipped > eb.step.skipped;
+                         }
+                         return weight(ea) > weight(eb);
+                     });
+
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        Entry& entry = entries_[order[k]];
+        Step& step = entry.step;
+
+        const double left =
+            params_.safety_factor *
+            (params_.frame_budget - Instrumentation::seconds_since(start));
+        const bool sampling = entry.tracker->particle_count() > 0;
+
+        step.particle_count = sampling ? plan(order, k, left) : 0;
+        step.planned_seconds = predict(entry, step.particle_count);
+
+        if (sampling && step.planned_seconds > left && k > 0)
+        {
+            // not even the minimum fits, the tracker waits for a frame
+            // with enough time left. Skipped trackers run first in the
+            // next frame, and the first one always runs.
+            step.tracked = false;
+            step.seconds = 0;
+            ++step.skipped;
+            continue;
+        }
+
+        if (sampling) entry.tracker->particle_count(step.particle_count);
+
+        const auto tracker_start = Instrumentation::Clock::now();
+        entry.state = entry.tracker->track(images[order[k]]);
+
+        FrameStatistics statistics;
+        step.seconds = entry.tracker->instrumentation()->last_frame(statistics)
+                           ? statistics.seconds
+                           : Instrumentation::seconds_since(tracker_start);
+        step.tracked = true;
+        step.skipped = 0;
+        measure(entry, step.seconds);
+    }
+
+    std::vector<Tracker::State> states;
+    for (const Entry& entry : entries_) states.push_back(entry.state);
+    return states;
+}
+
+auto TrackerScheduler::last_steps() const -> std::vector<Step>
+{
+    std::vector<Step> steps;
+    for (const Entry& entry : entries_) steps.push_back(entry.step);
+    return steps;
+}
+
+double TrackerScheduler::particle_seconds(int index) const
+{
+    return entries_[index].particle_seconds;
+}
+
+int TrackerScheduler::plan(const std::vector<int>& order,
+                           int first,
+                           double seconds) const
+{
+    // the trackers without particles and those which have not been measured
+    // yet run at fixed counts
+    std::vector<double> particle_seconds;
+    std::vector<double> weights;
+    double available = seconds;
+    for (size_t k = first; k < order.size(); ++k)
+    {
+        const Entry& entry = entries_[order[k]];
+        if (entry.tracker->particle_count() == 0)
+        {
+            available -= predict(entry, 0);
+        }
+        else if (entry.particle_seconds > 0)
+        {
+            particle_seconds.push_back(entry.particle_seconds);
+            weights.push_back(weight(entry));
+        }
+        else if (int(k) == first)
+        {
+            return params_.min_particle_count;
+        }
+    }
+
+    return allocate(particle_seconds,
+                    weights,
+                    available,
+                    params_.min_particle_count,
+                    params_.max_particle_count)[0];
+}
+
+std::vector<int> TrackerScheduler::allocate(
+    const std::vector<double>& particle_seconds,
+    const std::vector<double>& weights,
+    double seconds,
+    int min_count,
+    int max_count)
+{
+    const size_t n = particle_seconds.size();
+    std::vector<double> counts(n, min_count);
+    std::vector<bool> clamped(n, false);
+
+    // the counts beyond the bounds are clamped and the shares of the others
+    // are recomputed from the time left
+    for (size_t iteration = 0; iteration <= n; ++iteration)
+    {
+        double weight_sum = 0;
+        double left = seconds;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (clamped[i])
+            {
+                left -= counts[i] * particle_seconds[i];
+            }
+            else
+            {
+                weight_sum += weights[i];
+            }
+        }
+        if (weight_sum <= 0) break;
+
+        bool changed = false;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (clamped[i]) continue;
+
+            counts[i] = std::max(0., left) * weights[i] / weight_sum /
+                        particle_seconds[i];
+            if (counts[i] < min_count)
+            {
+                counts[i] = min_count;
+                clamped[i] = changed = true;
+            }
+            else if (counts[i] > max_count)
+            {
+                counts[i] = max_count;
+                clamped[i] = changed = true;
+            }
+        }
+        if (!changed) break;
+    }
+
+    std::vector<int> result(n);
+    for (size_t i = 0; i < n; ++i) result[i] = int(counts[i]);
+    return result;
+}
+
+double TrackerScheduler::weight(const Entry& entry) const
+{
+    return std::max(params_.min_uncertainty, entry.tracker->uncertainty());
+}
+
+double TrackerScheduler::predict(const Entry& entry, int particles) const
+{
+    if (entry.tracker->particle_count() == 0)
+    {
+        return std::max(0., entry.fixed_seconds);
+    }
+
+    return std::max(0., entry.particle_seconds) * particles;
+}
+
+void TrackerScheduler::measure(Entry& entry, double seconds)
+{
+    const double rate = params_.cost_update_rate;
+    auto update = [rate](double& average, double value)
+    {
+        average = average < 0 ? value : (1 - rate) * average + rate * value;
+    };
+
+    if (entry.step.particle_count > 0)
+    {
+        update(entry.particle_seconds, seconds / entry.step.particle_count);
+    }
+    else
+    {
+        update(entry.fixed_seconds, seconds);
+    }
+}
+}
@@ -0,0 +1,185 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_scheduler.hpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <fl/exception/exception.hpp>
+
+#include <dbot/depth_image_view.hpp>
+#include <dbot/tracker/tracker.hpp>
+
+namespace dbot
+{
+class SharedBatchServiceException : public fl::Exception
+{
+public:
+    SharedBatchServiceException() : Exception()
+    {
+        info("Reason",
+             "the tracker shares its batch service with a scheduled tracker");
+    }
+
+    virtual std::string name() const noexcept
+    {
+        return "dbot::SharedBatchServiceException";
+    }
+};
+
+/**
+ * \brief Runs the steps of several trackers within a common time budget per
+ *        frame by choosing the particle counts of the trackers.
+ *
+ * The cost of a particle is measured for each tracker from the
+ * instrumented duration of its steps. Before each step, the time left in
+ * the frame is distributed among the trackers which have not run yet in
+ * proportion to their uncertainty, such that uncertain objects receive more
+ * particles. The shares are converted into particle counts within
+ * [min_particle_count, max_particle_count].
+ *
+ * The trackers run one after another on the calling thread, each one with
+ * its own threads. A tracker whose minimum particle count does not fit into
+ * the time left is not stepped in this frame and returns its last state.
+ * Skipped trackers run first in the next frame and the first tracker of a
+ * frame always runs, thus all of them keep running if the budget is too
+ * small, at a lower rate.
+ *
+ * Trackers without particles run with a fixed cost and are never skipped.
+ *
+ * Since the trackers run one after another, trackers sharing a
+ * BatchEvaluationService cannot be scheduled together. The step of each of
+ * them waits for the others to submit their states, which would never
+ * happen. Such trackers evaluate in one round and are stepped concurrently
+ * from their own threads instead, e.g. by Tracker::track_async().
+ */
+class TrackerScheduler
+{
+public:
+    struct Parameters
+    {
+        /// time available for the steps of all trackers in seconds
+        double frame_budget = 0.033;
+
+        /// share of the time left which is planned with, the rest absorbs
+        /// the variation of the step durations
+        double safety_factor = 0.9;
+
+        int min_particle_count = 20;
+        int max_particle_count = 1000;
+
+        /// weight of the last step in the moving average of the cost
+        double cost_update_rate = 0.2;
+
+        /// uncertainty in meters below which objects are considered
+        /// equally certain
+        double min_uncertainty = 0.001;
+    };
+
+    /** \brief Outcome of the last frame of a single tracker */
+    struct Step
+    {
+        /// whether the tracker has been stepped
+        bool tracked = false;
+        int particle_count = 0;
+        double planned_seconds = 0;
+        double seconds = 0;
+
+        /// consecutive frames the tracker has been skipped
+        int skipped = 0;
+    };
+
+public:
+    TrackerScheduler();
+    explicit TrackerScheduler(const Parameters& params);
+
+    /**
+     * \brief Adds an initialized tracker. Its instrumentation is enabled.
+     * \return the index of the tracker
+     *
+     * \throws SharedBatchServiceException if the tracker shares its
+     *         Tracker::batch_service() with one of the scheduled trackers
+     */
+    int add(const std::shared_ptr<Tracker>& tracker);
+
+    int count_trackers() const { return entries_.size(); }
+
+    /**
+     * \brief Steps the trackers on their images within the frame budget
+     * \return the state of each tracker, the last one for skipped trackers
+     */
+    std::vector<Tracker::State> track(
+        const std::vector<DepthImageView>& images);
+
+    /** \return the outcome of the last frame of each tracker */
+    std::vector<Step> last_steps() const;
+
+    /** \return the estimated time of a step of tracker \a index per particle */
+    double particle_seconds(int index) const;
+
+    const Parameters& parameters() const { return params_; }
+
+    /**
+     * \brief Distributes \a seconds among trackers in proportion to their
+     *        weights. The counts are clamped to [min_count, max_count] and
+     *        the time of the clamped trackers is redistributed among the
+     *        others.
+     *
+     * \param particle_seconds  time of each tracker per particle
+     * \return the particle count of each tracker
+     */
+    static std::vector<int> allocate(
+        const std::vector<double>& particle_seconds,
+        const std::vector<double>& weights,
+        double seconds,
+        int min_count,
+        int max_count);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Tracker> tracker;
+        Tracker::State state;
+        Step step;
+
+        // moving averages of the step time per particle and of the step
+        // time of trackers without particles, negative until measured
+        double particle_seconds;
+        double fixed_seconds;
+    };
+
+    /**
+     * \brief Distributes \a seconds among the trackers in \a order starting
+     *        at \a first and returns the particle count of the first one
+     */
+    int plan(const std::vector<int>& order, int first, double seconds) const;
+
+    double weight(const Entry& entry) const;
+
+    /** \return the cost of a step with \a particles particles */
+    double predict(const Entry& entry, int particles) const;
+
+    void measure(Entry& entry, double seconds);
+
+private:
+    Parameters params_;
+    std::vector<Entry> entries_;
+};
+}
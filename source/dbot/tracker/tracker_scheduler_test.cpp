@@ -0,0 +1,206 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_scheduler_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/tracker/tracker_scheduler.hpp>
+
+using dbot::Tracker;
+using dbot::TrackerScheduler;
+
+/**
+ * \brief Tracker whose steps take a fixed time per particle
+ */
+class SleepingTracker : public Tracker
+{
+public:
+    SleepingTracker(double particle_seconds, double uncertainty)
+        : Tracker(std::make_shared<dbot::ObjectModel>(
+                      std::make_shared<dbot::SyntheticObjectLoader>(1, 4),
+                      false),
+                  1.0,
+                  false),
+          particle_seconds_(particle_seconds),
+          uncertainty_(uncertainty),
+          particle_count_(100)
+    {
+    }
+
+    State on_track(const Obsrv& image)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(
+            particle_seconds_ * particle_count_));
+        return moving_average_;
+    }
+
+    State on_initialize(const std::vector<State>& initial_states)
+    {
+        return initial_states[0];
+    }
+
+    int particle_count() const { return particle_count_; }
+    void particle_count(int count) { particle_count_ = count; }
+    double uncertainty() const { return uncertainty_; }
+
+private:
+    double particle_seconds_;
+    double uncertainty_;
+    int particle_count_;
+};
+
+static std::shared_ptr<Tracker> tracker(double particle_seconds,
+                                        double uncertainty)
+{
+    auto tracker =
+        std::make_shared<SleepingTracker>(particle_seconds, uncertainty);
+    tracker->initialize({Tracker::State(1)});
+    return tracker;
+}
+
+/**
+ * \brief Tracker evaluating in the rounds of a batch service
+ */
+class BatchedTracker : public SleepingTracker
+{
+public:
+    explicit BatchedTracker(const dbot::BatchEvaluationService* service)
+        : SleepingTracker(10e-6, 0.01), service_(service)
+    {
+    }
+
+    const dbot::BatchEvaluationService* batch_service() const
+    {
+        return service_;
+    }
+
+private:
+    const dbot::BatchEvaluationService* service_;
+};
+
+TEST(TrackerSchedulerTests, time_is_shared_by_the_weights)
+{
+    // 10 ms at 10 us per particle, a quarter and three quarters
+    auto counts = TrackerScheduler::allocate(
+        {10e-6, 10e-6}, {0.01, 0.03}, 0.01, 10, 1000);
+    EXPECT_NEAR(counts[0], 250, 1);
+    EXPECT_NEAR(counts[1], 750, 1);
+
+    // the clamped tracker leaves its time to the others
+    counts = TrackerScheduler::allocate(
+        {10e-6, 10e-6, 40e-6}, {0.01, 0.01, 0.02}, 0.01, 10, 200);
+    EXPECT_EQ(counts[0], 200);
+    EXPECT_EQ(counts[1], 200);
+    EXPECT_NEAR(counts[2], 150, 1);
+
+    // the minimum is kept even if the time does not suffice
+    counts = TrackerScheduler::allocate({1e-3}, {1}, 0.001, 10, 1000);
+    EXPECT_EQ(counts[0], 10);
+}
+
+TEST(TrackerSchedulerTests, steps_are_planned_within_the_budget)
+{
+    TrackerScheduler::Parameters params;
+    params.frame_budget = 0.06;
+    params.min_particle_count = 10;
+    TrackerScheduler scheduler(params);
+
+    scheduler.add(tracker(100e-6, 0.01));
+    scheduler.add(tracker(100e-6, 0.03));
+
+    std::vector<float> depth(4, 1.f);
+    const std::vector<dbot::DepthImageView> images(
+        2, dbot::DepthImageView(depth.data(), 2, 2));
+
+    // unmeasured trackers run with the minimum
+    scheduler.track(images);
+    EXPECT_EQ(scheduler.last_steps()[0].particle_count, 10);
+    EXPECT_GT(scheduler.particle_seconds(0), 0);
+
+    scheduler.track(images);
+    const auto steps = scheduler.last_steps();
+    ASSERT_TRUE(steps[0].tracked && steps[1].tracked);
+
+    // the uncertain tracker runs first and plans with its share only
+    EXPECT_GT(steps[1].particle_count, steps[0].particle_count / 2);
+    EXPECT_LT(steps[1].planned_seconds,
+              0.8 * params.safety_factor * params.frame_budget);
+}
+
+TEST(TrackerSchedulerTests, trackers_are_skipped_instead_of_overrunning)
+{
+    TrackerScheduler::Parameters params;
+    params.frame_budget = 0.01;
+    params.min_particle_count = 100;
+    TrackerScheduler scheduler(params);
+
+    // the minimum of a single tracker takes most of the budget
+    scheduler.add(tracker(60e-6, 0.01));
+    scheduler.add(tracker(60e-6, 0.01));
+
+    std::vector<float> depth(4, 1.f);
+    const std::vector<dbot::DepthImageView> images(
+        2, dbot::DepthImageView(depth.data(), 2, 2));
+
+    int tracked[2] = {0, 0};
+    for (int frame = 0; frame < 6; ++frame)
+    {
+        scheduler.track(images);
+
+        const auto steps = scheduler.last_steps();
+        if (frame == 0) continue;
+
+        // exactly one of them fits, they take turns
+        EXPECT_NE(steps[0].tracked, steps[1].tracked);
+        for (int i = 0; i < 2; ++i) tracked[i] += steps[i].tracked;
+    }
+
+    EXPECT_GE(tracked[0], 2);
+    EXPECT_GE(tracked[1], 2);
+}
+
+TEST(TrackerSchedulerTests, trackers_sharing_a_batch_service_are_rejected)
+{
+    // only the identity of the services matters
+    int services[2];
+    auto batched = [&](int i)
+    {
+        auto tracker = std::make_shared<BatchedTracker>(
+            reinterpret_cast<const dbot::BatchEvaluationService*>(
+                &services[i]));
+        tracker->initialize({Tracker::State(1)});
+        return tracker;
+    };
+
+    TrackerScheduler scheduler;
+    scheduler.add(tracker(10e-6, 0.01));
+    scheduler.add(tracker(10e-6, 0.01));
+    scheduler.add(batched(0));
+    scheduler.add(batched(1));
+
+    EXPECT_THROW(scheduler.add(batched(0)),
+                 dbot::SharedBatchServiceException);
+    EXPECT_EQ(scheduler.count_trackers(), 4);
+}
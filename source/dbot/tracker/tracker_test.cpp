@@ -0,0 +1,177 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_test.cpp
+ * \date October 2026
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dbot/synthetic_scene.hpp>
+#include <dbot/tracker/tracker.hpp>
+
+using dbot::Tracker;
+
+/**
+ * \brief Tracker recording the times of its steps, whose steps wait until
+ *        they are released
+ */
+class RecordingTracker : public Tracker
+{
+public:
+    RecordingTracker()
+        : Tracker(std::make_shared<dbot::ObjectModel>(
+                      std::make_shared<dbot::SyntheticObjectLoader>(1, 4),
+                      false),
+                  1.0,
+                  false),
+          started_(0)
+    {
+        release_.set_value();
+        released_ = release_.get_future().share();
+    }
+
+    using Tracker::on_track;
+
+    State on_track(const Obsrv& image) { return moving_average_; }
+
+    State on_track(const dbot::DepthImageView& image)
+    {
+        ++started_;
+        released_.wait();
+        return moving_average_;
+    }
+
+    State on_initialize(const std::vector<State>& initial_states)
+    {
+        return initial_states[0];
+    }
+
+    void on_delta_time(double delta_time)
+    {
+        delta_times_.push_back(delta_time);
+    }
+
+    /** \brief Makes the following steps wait for release() */
+    void hold()
+    {
+        release_ = std::promise<void>();
+        released_ = release_.get_future().share();
+    }
+
+    void release() { release_.set_value(); }
+
+    int started() const { return started_; }
+
+    const std::vector<double>& delta_times() const { return delta_times_; }
+
+private:
+    std::atomic<int> started_;
+    std::promise<void> release_;
+    std::shared_future<void> released_;
+    std::vector<double> delta_times_;
+};
+
+TEST(TrackerTests, steps_cover_the_time_since_the_previous_frame)
+{
+    RecordingTracker tracker;
+    tracker.initialize({Tracker::State(1)});
+
+    const std::vector<float> depths(4, 1.f);
+    const dbot::DepthImageView image(depths.data(), 2, 2);
+
+    tracker.track(image, 10.);
+    tracker.track(image, 10.033);
+    tracker.track(image, 10.1);
+    tracker.track(image);
+    tracker.track(image, 10.2);
+
+    const auto& delta_times = tracker.delta_times();
+    ASSERT_EQ(delta_times.size(), 5u);
+    EXPECT_TRUE(std::isnan(delta_times[0]));
+    EXPECT_NEAR(delta_times[1], 0.033, 1e-9);
+    EXPECT_NEAR(delta_times[2], 0.067, 1e-9);
+
+    // a step without time stamp interrupts the sequence
+    EXPECT_TRUE(std::isnan(delta_times[3]));
+    EXPECT_TRUE(std::isnan(delta_times[4]));
+}
+
+TEST(TrackerTests, latest_frame_replaces_the_waiting_one)
+{
+    RecordingTracker tracker;
+    tracker.initialize({Tracker::State(1)});
+
+    const std::vector<float> depths(4, 1.f);
+    const dbot::DepthImageView image(depths.data(), 2, 2);
+
+    tracker.hold();
+    std::vector<std::future<Tracker::State>> futures;
+    futures.push_back(tracker.track_latest(image, 1.));
+    while (tracker.started() == 0) std::this_thread::yield();
+
+    // the first frame is running, the later ones replace each other
+    for (int i = 2; i <= 5; ++i)
+    {
+        futures.push_back(tracker.track_latest(image, double(i)));
+    }
+    EXPECT_EQ(tracker.dropped_frames(), 3u);
+
+    tracker.release();
+    for (auto& future : futures) future.get();
+
+    // the newest frame ran right after the first one
+    EXPECT_EQ(tracker.started(), 2);
+    ASSERT_EQ(tracker.delta_times().size(), 2u);
+    EXPECT_DOUBLE_EQ(tracker.delta_times()[1], 4.);
+}
+
+TEST(TrackerTests, restored_tracker_continues_from_the_snapshot)
+{
+    RecordingTracker tracker;
+    Tracker::State state(1);
+    state.component(0).position() = Eigen::Vector3d(0.1, 0.2, 0.3);
+    tracker.initialize({state});
+
+    const std::vector<float> depths(4, 1.f);
+    const dbot::DepthImageView image(depths.data(), 2, 2);
+    tracker.track(image, 10.);
+    const dbot::Snapshot snapshot = tracker.snapshot();
+
+    RecordingTracker standby;
+    standby.restore(dbot::Snapshot(snapshot.bytes()));
+
+    Tracker::State restored;
+    ASSERT_TRUE(standby.latest_state(restored));
+    EXPECT_TRUE(restored.isApprox(state));
+
+    // the time stamps continue the sequence of the snapshot
+    standby.track(image, 10.05);
+    ASSERT_EQ(standby.delta_times().size(), 1u);
+    EXPECT_NEAR(standby.delta_times()[0], 0.05, 1e-9);
+
+    // a truncated snapshot is rejected
+    std::vector<unsigned char> bytes = snapshot.bytes();
+    bytes.resize(bytes.size() - 1);
+    EXPECT_THROW(standby.restore(dbot::Snapshot(bytes)),
+                 dbot::InvalidSnapshotException);
+}
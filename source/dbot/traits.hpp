@@ -39,4 +39,25 @@ typedef Eigen::Matrix<double, 0, 0> Empty;
 
 using internal::Traits;
 
+/**
+ * \brief Noise and input of the transition of a rigid bodies state. The
+ *        noise acts on the velocities, hence it has half the dimension of
+ *        the state and a fixed size for states of a fixed size.
+ */
+template <typename State>
+struct ObjectStateTrait
+{
+    enum
+    {
+        NoiseDim = State::SizeAtCompileTime != -1 ? State::SizeAtCompileTime / 2
+                                                  : Eigen::Dynamic,
+        InputDim = Eigen::Dynamic,
+        BodyCount = State::SizeAtCompileTime != -1
+                        ? State::SizeAtCompileTime / State::BodySize
+                        : Eigen::Dynamic
+    };
+
+    typedef Eigen::Matrix<typename State::Scalar, NoiseDim, 1> Noise;
+    typedef Eigen::Matrix<typename State::Scalar, InputDim, 1> Input;
+};
 }
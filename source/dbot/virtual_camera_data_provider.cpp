@@ -59,6 +59,16 @@ Eigen::VectorXd VirtualCameraDataProvider::depth_image_vector() const
     return image;
 }
 
+DepthImageView VirtualCameraDataProvider::depth_image_view() const
+{
+    typedef Eigen::Matrix<float, -1, -1, Eigen::RowMajor> RowMajorImage;
+
+    auto image = std::make_shared<RowMajorImage>(depth_image_.cast<float>());
+
+    return DepthImageView(
+        image->data(), int(image->rows()), int(image->cols()), image);
+}
+
 Eigen::Matrix3d VirtualCameraDataProvider::camera_matrix() const
 {
     return camera_matrix_;
@@ -50,6 +50,11 @@ public:
      */
     virtual Eigen::VectorXd depth_image_vector() const;
 
+    /**
+     * \brief returns the depth image converted into a float view
+     */
+    virtual DepthImageView depth_image_view() const;
+
     /**
      * \brief Obtains the camera matrix
      */
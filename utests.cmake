@@ -13,3 +13,168 @@ dbot_add_test(
     NAME    file_shader_provider_test
     SOURCES source/dbot/file_shader_provider_test.cpp
     LIBS	  ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_pixel_model_test
+    SOURCES source/dbot/model/kinect_pixel_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    occlusion_map_test
+    SOURCES source/dbot/model/occlusion_map_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    philox_test
+    SOURCES source/dbot/philox_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    resampling_test
+    SOURCES source/dbot/filter/resampling_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rao_blackwell_coordinate_particle_filter_test
+    SOURCES source/dbot/filter/rao_blackwell_coordinate_particle_filter_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    sigma_point_render_store_test
+    SOURCES source/dbot/model/sigma_point_render_store_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    active_pixel_set_test
+    SOURCES source/dbot/model/active_pixel_set_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    pyramid_sensor_test
+    SOURCES source/dbot/model/pyramid_sensor_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    streaming_camera_data_provider_test
+    SOURCES source/dbot/streaming_camera_data_provider_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    seq_lock_test
+    SOURCES source/dbot/seq_lock_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_preprocessor_test
+    SOURCES source/dbot/depth_preprocessor_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    mesh_cache_test
+    SOURCES source/dbot/mesh_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    mesh_levels_test
+    SOURCES source/dbot/mesh_levels_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    flat_mesh_test
+    SOURCES source/dbot/flat_mesh_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    distinct_particles_test
+    SOURCES source/dbot/model/distinct_particles_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    part_layer_cache_test
+    SOURCES source/dbot/model/part_layer_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    replay_camera_data_provider_test
+    SOURCES source/dbot/replay_camera_data_provider_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    instrumentation_test
+    SOURCES source/dbot/instrumentation_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    multi_camera_sensor_test
+    SOURCES source/dbot/model/multi_camera_sensor_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    tracker_scheduler_test
+    SOURCES source/dbot/tracker/tracker_scheduler_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    body_tail_image_model_test
+    SOURCES source/dbot/model/body_tail_image_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    launch_tuning_cache_test
+    SOURCES source/dbot/launch_tuning_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    pose_candidates_test
+    SOURCES source/dbot/tracker/pose_candidates_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    geometry_registry_test
+    SOURCES source/dbot/geometry_registry_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    batch_transition_test
+    SOURCES source/dbot/model/batch_transition_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_reuse_test
+    SOURCES source/dbot/model/depth_reuse_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_alignment_test
+    SOURCES source/dbot/depth_alignment_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    tracker_test
+    SOURCES source/dbot/tracker/tracker_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    gpu_memory_planner_test
+    SOURCES source/dbot/gpu_memory_planner_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    snapshot_test
+    SOURCES source/dbot/snapshot_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    thread_pool_test
+    SOURCES source/dbot/thread_pool_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_image_model_test
+    SOURCES source/dbot/model/kinect_image_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rigid_body_renderer_test
+    SOURCES source/dbot/rigid_body_renderer_test.cpp
+    LIBS    ${dbot_LIBRARIES})